@@ -34,6 +34,9 @@ def _ccv_setting_impl(repository_ctx):
     if repository_ctx.attr.have_gsl:
         defines.append("HAVE_GSL")
         linkopts += ["-lgsl", "-lgslcblas"]
+    if repository_ctx.attr.have_dlfcn:
+        defines.append("HAVE_DLFCN")
+        linkopts.append("-ldl")
     if repository_ctx.attr.have_cudnn:
         defines.append("HAVE_CUDNN")
         cuda_linkopts.append("-lcudnn")
@@ -74,6 +77,7 @@ ccv_setting = repository_rule(
         "have_tesseract": attr.bool(),
         "have_accelerate_framework": attr.bool(),
         "have_gsl": attr.bool(),
+        "have_dlfcn": attr.bool(),
         "have_cudnn": attr.bool(),
         "have_nccl": attr.bool(),
         "use_system_cub": attr.bool(),
@@ -48,7 +48,8 @@ enum {
 	CCV_32F = 0x04000,
 	CCV_64S = 0x08000,
 	CCV_64F = 0x10000,
-	CCV_16F = 0x20000, // We can still squeeze in 2 more types. (0xFF000 are for data types).
+	CCV_16F = 0x20000,
+	CCV_8S  = 0x40000, // We can still squeeze in 1 more type. (0xFF000 are for data types).
 };
 
 enum {
@@ -63,7 +64,9 @@ static const int _ccv_get_data_type_size[] = {
 	-1, 4,
 	-1, -1, -1, 8,
 	-1, -1, -1, -1, -1, -1, -1, 8,
-	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1
 };
 
 #define CCV_GET_DATA_TYPE(x) ((x) & 0xFF000)
@@ -78,6 +78,7 @@ typedef struct {
 	ccv_nnc_graph_t* graph;
 	ccv_nnc_tensor_arena_t* tensor_arena;
 	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_array_t* update_groups; // The execs that update parameters sharing the same minimizer together in the graph.
 	khash_t(stream_map)* stream_map; // Keeps track of streams on both GPU / CPU and devices so it can be used properly during execution.
 	ccv_array_t* parameters;
 	ccv_array_t* internals; // Additional symbols need to retain.
@@ -126,6 +127,7 @@ typedef struct {
 		ccv_nnc_graph_t* graph;
 		ccv_nnc_tensor_arena_t* tensor_arena;
 		ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+		ccv_array_t* update_groups;
 	} apply_gradients;
 	struct {
 		ccv_nnc_cmd_t minimizer;
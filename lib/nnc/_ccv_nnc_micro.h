@@ -156,6 +156,10 @@ typedef struct {
 	ccv_nnc_micro_loop_index_term_t end_index;
 	ccv_nnc_micro_loop_carried_t* carrieds;
 	ccv_nnc_micro_loop_statement_t* statements;
+	// Scheduling annotations, these are set by ccv_nnc_micro_program_schedule.
+	int parallel; // Iterations are independent and can be split across threads. Only the first loop of a block has it.
+	int vectorize; // The innermost loop that accesses memory with unit-stride and has independent iterations (other than reductions).
+	int tile_size; // If > 0, this loop iterates by tiles of this size, tiles of consecutive tiled loops are iterated outside of the loops within a tile.
 } ccv_nnc_micro_loop_t;
 
 // A loop block contains many loops within each other.
@@ -196,6 +200,13 @@ typedef struct {
 	ccv_nnc_micro_function_t* functions;
 } ccv_nnc_micro_program_t;
 
+// The signature of a compiled program. vars and shapes are laid out the same as the interpreter's, values are the
+// integer parameters. Parallel loops are run through parallel_for, which is ccv_nnc_parallel_for.
+typedef void(*ccv_nnc_micro_program_f)(float* const* const vars, const int* const shapes, const int* const values, void(* const parallel_for)(const int n, const int grain_size, const ccv_nnc_parallel_for_f fn, void* const context));
+
+// A parallel loop is split into tasks of at least this many iterations of its innermost loop.
+#define CCV_NNC_MICRO_PARALLEL_GRAIN (16384)
+
 // A combined op is constructed with many nested loops. These loops may have data dependencies
 // between each other, but they are ordered in topological order to make sure one is finished
 // after the another.
@@ -204,6 +215,10 @@ struct ccv_nnc_micro_combine_s {
 	ccv_nnc_micro_program_t forward;
 	ccv_nnc_micro_program_t backward;
 	ccv_array_t* equal_assertions;
+	struct {
+		ccv_nnc_micro_program_f forward;
+		ccv_nnc_micro_program_f backward;
+	} jit; // Compiled programs, these are owned by the process-wide cache.
 };
 
 typedef uint32_t(*ccv_nnc_micro_scalar_lookup_f)(const void* const context, const char* const name);
@@ -328,6 +343,9 @@ static inline ccv_nnc_micro_loop_t ccv_nnc_micro_for_in(const ccv_nnc_micro_loop
 		.carrieds = 0,
 		.statement_count = 0,
 		.statements = 0,
+		.parallel = 0,
+		.vectorize = 0,
+		.tile_size = 0,
 		.id = {
 			.type = CCV_NNC_MICRO_LOOP_ID,
 			.d = 0,
@@ -478,11 +496,18 @@ static inline ccv_nnc_micro_loop_carried_t ccv_nnc_micro_loop_carried(const uint
 
 // This method has to be mutable for efficiency reasons. Hence I kept it private.
 void ccv_nnc_micro_program_simplify(ccv_nnc_micro_program_t* const program, const ccv_nnc_micro_io_t* const inputs, const int input_size, const ccv_nnc_micro_io_t* const outputs, const int output_size, const ccv_array_t* const equal_assertions);
+// Reorder loops of a simplified program for locality, and annotate them for tiling, threads and SIMD.
+void ccv_nnc_micro_program_schedule(ccv_nnc_micro_program_t* const program);
+// Whether the index depends on any loop counter (loop_id < 0) or on a particular one.
+CCV_WARN_UNUSED(int) ccv_nnc_micro_loop_index_has_loop_id(const ccv_nnc_micro_loop_index_term_t index, const int loop_id);
 ccv_nnc_micro_loop_index_term_t ccv_nnc_micro_loop_index_deep_copy(const ccv_nnc_micro_loop_index_term_t* const term);
 void ccv_nnc_micro_loop_index_free(ccv_nnc_micro_loop_index_term_t* const term);
 void ccv_nnc_micro_loop_variable_free(ccv_nnc_micro_loop_variable_t* const var);
 void ccv_nnc_micro_loop_statement_free(ccv_nnc_micro_loop_statement_t* const statement);
 void ccv_nnc_micro_loop_statement_lvalue_free(ccv_nnc_micro_loop_statement_t* const statement);
 void ccv_nnc_micro_loops_free(ccv_nnc_micro_loop_t* const loops, const int loop_count);
+// Compute the shapes of all vars of a program into shapes (var_count * CCV_NNC_MAX_DIM_ALLOC), and allocate memory
+// for the intermediate ones. The returned pointers to each var need to be freed with ccfree.
+float** ccv_nnc_micro_program_vars_new(const ccv_nnc_micro_combine_t* const combine, const ccv_nnc_micro_program_t* const program, ccv_nnc_tensor_t* const* const inputs, const int input_size, const ccv_nnc_micro_scalar_t* const values, const int parameter_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, int* const shapes);
 
 #endif
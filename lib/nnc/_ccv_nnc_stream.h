@@ -31,6 +31,7 @@ struct ccv_nnc_stream_context_s {
 	// For scheduler
 	co_routine_t* main; // main task.
 	co_scheduler_t* scheduler;
+	int scheduler_worker_count;
 	// For neighbor discovery
 	ccv_nnc_stream_context_neighbor_discovery_f neighbor_discovery;
 	void* neighbor_discovery_context;
@@ -44,6 +45,17 @@ struct ccv_nnc_stream_context_s {
 // Return the scheduler from a stream (if not created, create one).
 CCV_WARN_UNUSED(co_scheduler_t*) ccv_nnc_stream_context_get_scheduler(ccv_nnc_stream_context_t* const stream_context);
 
+// Whether the work submitted to this stream from the current thread will be executed asynchronously (only CPU streams, on their own thread).
+int ccv_nnc_stream_context_is_async(const ccv_nnc_stream_context_t* const stream_context);
+// Submit a callback to execute in order on the stream. If the stream cannot execute asynchronously, the callback is called directly.
+void ccv_nnc_stream_context_submit(ccv_nnc_stream_context_t* const stream_context, const ccv_nnc_callback_f callback, void* const callback_context);
+// Record the status of a command executed on the stream thread, the first failure is returned by ccv_nnc_stream_context_wait.
+void ccv_nnc_stream_context_set_status(ccv_nnc_stream_context_t* const stream_context, const int status);
+// Work submitted to this CPU stream from the current thread executes directly, as if on the stream thread. The stream has to be
+// idle and not used by other threads until leave. Returns the stream entered previously, which should be passed to leave.
+CCV_WARN_UNUSED(ccv_nnc_stream_context_t*) ccv_nnc_stream_context_enter(ccv_nnc_stream_context_t* const stream_context);
+void ccv_nnc_stream_context_leave(ccv_nnc_stream_context_t* const previous);
+
 #define co_stream_await(_stream) do { if (!_co_stream_await(_self_, _stream)) { return (co_state_t){ __LINE__, 0 }; } case __LINE__: ; } while (0)
 int _co_stream_await(co_routine_t* const self, ccv_nnc_stream_context_t* const stream);
 
@@ -28,6 +28,7 @@ typedef struct {
 	int inc[CCV_NNC_MAX_DIM_ALLOC];
 	ccv_array_t* s_ref; // Reference to the tensor number in its sub graphs, Starts at 1.
 	char* name;
+	ccv_nnc_tensor_t* constant; // The data of a constant tensor symbol, owned by the graph.
 	ccv_nnc_tensor_param_t info;
 } ccv_nnc_tensor_symbol_info_t;
 
@@ -155,6 +156,7 @@ struct ccv_nnc_tensor_arena_s {
 	// ccv_tensor_multiview_t, thus, it is aligned to a 16-byte boundary).
 	ccv_array_t* tensor_metadata;
 	ccv_array_t* m_tensor_idx; // The index into multi-view tensors in tensor_metadata.
+	ccv_array_t* constants; // Copies of the constant tensor symbols bound to this arena, owned by the arena.
 };
 
 struct ccv_nnc_graph_exec_arena_s {
@@ -693,6 +693,180 @@ static void _ccv_cnnp_model_graph_exec_symbol_set(ccv_nnc_symbolic_graph_t* cons
 		_ccv_cnnp_model_graph_symbol_exec_set_for_graph_exec_arena(gradient_graph_exec_arena, parallel_count, exec_symbol, cmd, symbolic_graph);
 }
 
+typedef struct {
+	ccv_nnc_graph_exec_t exec; // The exec that updates all parameters in this group with one command.
+	int device_id;
+	int parameter_size;
+	int parameters[1]; // The indices of the parameters this exec updates.
+} ccv_cnnp_update_group_t;
+
+static int _ccv_cnnp_minimizer_can_group(const ccv_nnc_cmd_t a, const ccv_nnc_cmd_t b)
+{
+	if (a.cmd != b.cmd || a.backend != b.backend || a.algorithm != b.algorithm)
+		return 0;
+	// Only these minimizers can update multiple parameters with one command.
+	switch (a.cmd)
+	{
+		case CCV_NNC_SGD_FORWARD:
+			return memcmp(&a.info.sgd, &b.info.sgd, sizeof(a.info.sgd)) == 0;
+		case CCV_NNC_ADAM_FORWARD:
+			return memcmp(&a.info.adam, &b.info.adam, sizeof(a.info.adam)) == 0;
+		case CCV_NNC_LAMB_FORWARD:
+			return memcmp(&a.info.lamb, &b.info.lamb, sizeof(a.info.lamb)) == 0;
+		case CCV_NNC_RMSPROP_FORWARD:
+			return memcmp(&a.info.rmsprop, &b.info.rmsprop, sizeof(a.info.rmsprop)) == 0;
+	}
+	return 0;
+}
+
+static ccv_nnc_graph_exec_symbol_t _ccv_cnnp_update_node(const ccv_nnc_symbolic_graph_t* const symbolic_graph, const ccv_cnnp_compiled_data_t* const compiled_data, const int parameter_indice, const int device_id)
+{
+	if (device_id == 0)
+		return compiled_data->update_nodes[parameter_indice];
+	return ccv_nnc_graph_exec_symbol_copy(symbolic_graph, compiled_data->update_nodes[parameter_indice], device_id);
+}
+
+static int _ccv_cnnp_update_node_tensors(const ccv_nnc_symbolic_graph_t* const symbolic_graph, const ccv_nnc_tensor_arena_t* const tensor_arena, const ccv_nnc_graph_exec_symbol_t update_node, ccv_array_t* const inputs, ccv_array_t* const outputs)
+{
+	const int* input_symbols;
+	int input_size;
+	const int* output_symbols;
+	int output_size;
+	ccv_nnc_graph_exec_symbol_io(symbolic_graph, update_node, &input_symbols, &input_size, &output_symbols, &output_size);
+	int i;
+	for (i = 0; i < input_size + output_size; i++)
+	{
+		const ccv_nnc_tensor_symbol_t symbol = {
+			.d = i < input_size ? input_symbols[i] : output_symbols[i - input_size],
+			.graph = symbolic_graph,
+		};
+		ccv_nnc_tensor_t* const tensor = symbol.d >= 0 ? ccv_nnc_tensor_from_symbol(tensor_arena, symbol) : 0;
+		if (!tensor)
+			return 0;
+		if (i < input_size && inputs)
+			ccv_array_push(inputs, &tensor);
+		else if (i >= input_size && outputs)
+			ccv_array_push(outputs, &tensor);
+	}
+	return 1;
+}
+
+// The symbolic graph has one update exec per parameter, such that each parameter can have its own minimizer.
+// Once compiled, the update execs that share the same minimizer are replaced by one exec that updates all of
+// them with one command. The per parameter execs stay in the graph as no-ops, in case the minimizers diverge
+// later (see _ccv_cnnp_model_set_update_groups).
+static ccv_array_t* _ccv_cnnp_model_group_updates(const ccv_cnnp_model_t* const model, ccv_nnc_graph_t* const graph, const ccv_nnc_tensor_arena_t* const tensor_arena, ccv_nnc_graph_exec_arena_t* const graph_exec_arena)
+{
+	const ccv_cnnp_compiled_data_t* const compiled_data = model->compiled_data;
+	const ccv_nnc_symbolic_graph_t* const symbolic_graph = model->graph;
+	const int parameter_size = compiled_data->parameters->rnum;
+	const int parallel_count = ccv_max(model->parallel_count, 1);
+	const ccv_nnc_graph_exec_t destination = ccv_nnc_graph_exec_destination(graph_exec_arena);
+	ccv_array_t* const update_groups = ccv_array_new(sizeof(ccv_cnnp_update_group_t*), 0, 0);
+	ccv_array_t* const inputs = ccv_array_new(sizeof(ccv_nnc_tensor_t*), 0, 0);
+	ccv_array_t* const outputs = ccv_array_new(sizeof(ccv_nnc_tensor_t*), 0, 0);
+	ccv_nnc_graph_exec_t* const update_execs = (ccv_nnc_graph_exec_t*)ccmalloc(sizeof(ccv_nnc_graph_exec_t) * parameter_size);
+	int* const group_parameters = (int*)ccmalloc(sizeof(int) * parameter_size);
+	int i, j, k;
+	for (k = 0; k < parallel_count; k++)
+	{
+		// Only the update execs in this graph whose tensors are all allocated can be grouped.
+		for (i = 0; i < parameter_size; i++)
+		{
+			const ccv_nnc_graph_exec_symbol_t update_node = _ccv_cnnp_update_node(symbolic_graph, compiled_data, i, k);
+			update_execs[i].graph = 0;
+			if (update_node.d >= 0)
+				update_execs[i] = ccv_nnc_graph_exec_from_symbol(graph_exec_arena, update_node);
+			if (!CCV_NO_GRAPH_EXEC(update_execs[i]) && (update_execs[i].d == destination.d || !_ccv_cnnp_update_node_tensors(symbolic_graph, tensor_arena, update_node, 0, 0)))
+				update_execs[i].graph = 0;
+		}
+		for (i = 0; i < parameter_size; i++)
+		{
+			if (CCV_NO_GRAPH_EXEC(update_execs[i]))
+				continue;
+			const ccv_nnc_cmd_t minimizer = ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, _ccv_cnnp_update_node(symbolic_graph, compiled_data, i, k));
+			int group_size = 0;
+			for (j = i; j < parameter_size; j++)
+				if (!CCV_NO_GRAPH_EXEC(update_execs[j]) && _ccv_cnnp_minimizer_can_group(minimizer, ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, _ccv_cnnp_update_node(symbolic_graph, compiled_data, j, k))))
+					group_parameters[group_size++] = j;
+			if (group_size < 2)
+				continue;
+			ccv_array_clear(inputs);
+			ccv_array_clear(outputs);
+			for (j = 0; j < group_size; j++)
+				_ccv_cnnp_update_node_tensors(symbolic_graph, tensor_arena, _ccv_cnnp_update_node(symbolic_graph, compiled_data, group_parameters[j], k), inputs, outputs);
+			// Keep the backend / algorithm selected when compiling.
+			const ccv_nnc_cmd_t cmd = ccv_nnc_graph_exec_cmd(graph, update_execs[i]);
+			ccv_cnnp_update_group_t* const update_group = (ccv_cnnp_update_group_t*)ccmalloc(sizeof(ccv_cnnp_update_group_t) + sizeof(int) * (group_size - 1));
+			update_group->exec = ccv_nnc_graph_exec_new(graph, cmd, ccv_nnc_no_hint, (ccv_nnc_tensor_t**)ccv_array_get(inputs, 0), inputs->rnum, (ccv_nnc_tensor_t**)ccv_array_get(outputs, 0), outputs->rnum);
+			update_group->device_id = k;
+			update_group->parameter_size = group_size;
+			memcpy(update_group->parameters, group_parameters, sizeof(int) * group_size);
+			for (j = 0; j < group_size; j++)
+			{
+				const ccv_nnc_graph_exec_t update_exec = update_execs[group_parameters[j]];
+				ccv_nnc_graph_exec_concat(graph, update_exec, update_group->exec);
+				ccv_nnc_graph_exec_set(graph, update_exec, CMD_NOOP());
+				update_execs[group_parameters[j]].graph = 0;
+			}
+			ccv_nnc_graph_exec_concat(graph, update_group->exec, destination);
+			ccv_array_push(update_groups, &update_group);
+		}
+	}
+	ccfree(update_execs);
+	ccfree(group_parameters);
+	ccv_array_free(inputs);
+	ccv_array_free(outputs);
+	if (update_groups->rnum > 0)
+	{
+		// The graph has to be topsorted again with the new execs, which moves them around.
+		const int exec_count = ccv_nnc_graph_exec_count(graph);
+		int* const exec_cvt = (int*)ccmalloc(sizeof(int) * exec_count);
+		ccv_nnc_graph_exec_arena_topsort(graph_exec_arena, graph, exec_cvt, exec_count);
+		for (i = 0; i < update_groups->rnum; i++)
+		{
+			ccv_cnnp_update_group_t* const update_group = *(ccv_cnnp_update_group_t**)ccv_array_get(update_groups, i);
+			update_group->exec.d = exec_cvt[update_group->exec.d];
+		}
+		ccfree(exec_cvt);
+	}
+	return update_groups;
+}
+
+// After the minimizers changed, use the grouped exec if all its parameters still share the same minimizer,
+// otherwise fall back to the per parameter execs.
+static void _ccv_cnnp_model_set_update_groups(const ccv_cnnp_model_t* const model, ccv_nnc_graph_t* const graph, const ccv_nnc_graph_exec_arena_t* const graph_exec_arena, const ccv_array_t* const update_groups)
+{
+	if (!update_groups)
+		return;
+	const ccv_cnnp_compiled_data_t* const compiled_data = model->compiled_data;
+	const ccv_nnc_symbolic_graph_t* const symbolic_graph = model->graph;
+	int i, j;
+	for (i = 0; i < update_groups->rnum; i++)
+	{
+		const ccv_cnnp_update_group_t* const update_group = *(ccv_cnnp_update_group_t**)ccv_array_get(update_groups, i);
+		const ccv_nnc_cmd_t minimizer = ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, _ccv_cnnp_update_node(symbolic_graph, compiled_data, update_group->parameters[0], update_group->device_id));
+		int flag = 1;
+		for (j = 1; flag && j < update_group->parameter_size; j++)
+			flag = _ccv_cnnp_minimizer_can_group(minimizer, ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, _ccv_cnnp_update_node(symbolic_graph, compiled_data, update_group->parameters[j], update_group->device_id)));
+		ccv_nnc_graph_exec_set(graph, update_group->exec, flag ? minimizer : CMD_NOOP());
+		for (j = 0; j < update_group->parameter_size; j++)
+		{
+			const ccv_nnc_graph_exec_symbol_t update_node = _ccv_cnnp_update_node(symbolic_graph, compiled_data, update_group->parameters[j], update_group->device_id);
+			const ccv_nnc_graph_exec_t update_exec = ccv_nnc_graph_exec_from_symbol(graph_exec_arena, update_node);
+			ccv_nnc_graph_exec_set(graph, update_exec, flag ? CMD_NOOP() : ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, update_node));
+		}
+	}
+}
+
+static void _ccv_cnnp_update_groups_free(ccv_array_t* const update_groups)
+{
+	int i;
+	for (i = 0; i < update_groups->rnum; i++)
+		ccfree(*(ccv_cnnp_update_group_t**)ccv_array_get(update_groups, i));
+	ccv_array_free(update_groups);
+}
+
 static int _ccv_cnnp_set_minimizer_for_parameter(ccv_nnc_symbolic_graph_t* const graph, ccv_cnnp_compiled_data_t* const compiled_data, ccv_nnc_graph_exec_symbol_t* const update_nodes, ccv_nnc_tensor_symbol_t* const updated_parameters, ccv_nnc_tensor_symbol_map_t* const saved_aux, const int parallel_count, const ccv_nnc_cmd_t minimizer, const int saved_aux_size, const int max_saved_aux_size, const int parameter_indice)
 {
 	int this_parameter_flag = 0;
@@ -1124,6 +1298,9 @@ static void _ccv_cnnp_compiled_data_graph_free(ccv_cnnp_compiled_data_t* const c
 	if (compiled_data->graph_exec_arena)
 		ccv_nnc_graph_exec_arena_free(compiled_data->graph_exec_arena);
 	compiled_data->graph_exec_arena = 0;
+	if (compiled_data->update_groups)
+		_ccv_cnnp_update_groups_free(compiled_data->update_groups);
+	compiled_data->update_groups = 0;
 	if (compiled_data->backward.from_ops)
 		ccfree(compiled_data->backward.from_ops);
 	compiled_data->backward.from_ops = 0;
@@ -1174,6 +1351,9 @@ static void _ccv_cnnp_compiled_data_apply_gradients_free(ccv_cnnp_compiled_data_
 	if (compiled_data->apply_gradients.graph_exec_arena)
 		ccv_nnc_graph_exec_arena_free(compiled_data->apply_gradients.graph_exec_arena);
 	compiled_data->apply_gradients.graph_exec_arena = 0;
+	if (compiled_data->apply_gradients.update_groups)
+		_ccv_cnnp_update_groups_free(compiled_data->apply_gradients.update_groups);
+	compiled_data->apply_gradients.update_groups = 0;
 }
 
 // Compile the graph to run ccv_cnnp_model_fit
@@ -1218,6 +1398,7 @@ static void _ccv_cnnp_model_fit_jit(ccv_cnnp_model_t* const model, ccv_nnc_tenso
 	_ccv_cnnp_model_bind_tensors(model->graph, (ccv_nnc_tensor_symbol_t*)ccv_array_get(compiled_data->internals, 0), compiled_data->tensors.internals, internal_size, parallel_count, tensor_binds);
 	ccv_nnc_symbolic_graph_compile(model->graph, compiled_data->compile_params, (ccv_nnc_tensor_bind_t*)ccv_array_get(tensor_binds, 0), tensor_binds->rnum, 0, 0, SYMBOLIC_GRAPH_SOURCES(model->graph), SYMBOLIC_GRAPH_DESTINATIONS(model->graph), &compiled_data->graph, &compiled_data->tensor_arena, &compiled_data->graph_exec_arena);
 	ccv_array_free(tensor_binds);
+	compiled_data->update_groups = _ccv_cnnp_model_group_updates(model, compiled_data->graph, compiled_data->tensor_arena, compiled_data->graph_exec_arena);
 	if (tensors_init && parallel_count > 1)
 		_ccv_cnnp_model_copy_tensors(compiled_data->tensors_init.v, (ccv_nnc_tensor_symbol_t*)ccv_array_get(compiled_data->parameters, 0), compiled_data->tensors.parameters, compiled_data->parameters->rnum, parallel_count);
 	// If tensor is not init'ed, we need to init states first.
@@ -1591,6 +1772,126 @@ void ccv_cnnp_model_evaluate(ccv_cnnp_model_t* const model, const ccv_cnnp_evalu
 	}
 }
 
+typedef struct {
+	ccv_nnc_cmd_t cmd; // The original command.
+	ccv_nnc_graph_exec_t exec;
+	float range; // The maximum absolute value of the input activations seen so far.
+} ccv_cnnp_calibration_t;
+
+static int _ccv_cnnp_calibration_exec(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	ccv_cnnp_calibration_t* const calibration = (ccv_cnnp_calibration_t*)cmd.data;
+	const ccv_nnc_tensor_t* const a = inputs[0];
+	if (a && !CCV_IS_TENSOR_VIEW(a) && a->info.datatype == CCV_32F && CCV_TENSOR_GET_MEMORY(a->info.type) == CCV_TENSOR_CPU_MEMORY)
+	{
+		const int count = ccv_nnc_tensor_count(a->info);
+		float range = calibration->range;
+		int i;
+		for (i = 0; i < count; i++)
+			range = ccv_max(range, fabsf(a->data.f32[i]));
+		calibration->range = range;
+	}
+	return ccv_nnc_cmd_exec(calibration->cmd, hint, flags, inputs, input_size, outputs, output_size, stream_context);
+}
+
+static ccv_nnc_cmd_vtab_t ccv_cnnp_calibration_isa = {
+	.exec = _ccv_cnnp_calibration_exec
+};
+
+void ccv_cnnp_model_quantize(ccv_cnnp_model_t* const model, ccv_cnnp_dataframe_t* const dataframe, const int* const column_idxs, const int column_idx_size, const int sample_size)
+{
+	ccv_cnnp_compiled_data_t* const compiled_data = model->compiled_data;
+	assert(compiled_data);
+	assert(column_idx_size == model->input_size);
+	// Only rewrite the inference graph, it cannot be used to train any more.
+	assert(ccv_max(model->parallel_count, 1) == 1);
+	assert(compiled_data->gradient_mode == CCV_CNNP_COMPILED_DATA_GRADIENT_NONE);
+	const ccv_cnnp_evaluate_param_t params = {
+		.requires_grad = 0,
+		.is_test = 1,
+	};
+	int i;
+	const int output_size = model->output_size;
+	ccv_nnc_tensor_t** const outputs = (ccv_nnc_tensor_t**)ccmalloc(sizeof(ccv_nnc_tensor_t*) * (output_size + column_idx_size));
+	for (i = 0; i < output_size; i++)
+		outputs[i] = ccv_nnc_tensor_new(0, ccv_nnc_tensor_symbol_params(model->graph, model->outputs[i]), 0);
+	ccv_nnc_tensor_t** const inputs = outputs + output_size;
+	ccv_array_t* const calibrations = ccv_array_new(sizeof(ccv_cnnp_calibration_t), 0, 0);
+	ccv_cnnp_dataframe_iter_t* const iter = ccv_cnnp_dataframe_iter_new(dataframe, column_idxs, column_idx_size);
+	int sample_count = 0;
+	while ((sample_size <= 0 || sample_count < sample_size) && ccv_cnnp_dataframe_iter_next(iter, (void**)inputs, column_idx_size, 0) == 0)
+	{
+		if (!compiled_data->graph)
+			ccv_cnnp_model_evaluate(model, params, inputs, column_idx_size, outputs, output_size, 0, 0);
+		if (!calibrations->rnum)
+		{
+			// Now the graph is compiled, route convolution and GEMM through the calibration command to collect the activation ranges.
+			const int exec_symbol_count = ccv_nnc_graph_exec_symbol_count(model->graph);
+			for (i = 0; i < exec_symbol_count; i++)
+			{
+				const ccv_nnc_graph_exec_symbol_t symbol = {
+					.d = i,
+					.graph = model->graph
+				};
+				const ccv_nnc_cmd_t cmd = ccv_nnc_graph_exec_symbol_cmd(model->graph, symbol);
+				if (cmd.cmd != CCV_NNC_CONVOLUTION_FORWARD && cmd.cmd != CCV_NNC_GEMM_FORWARD)
+					continue;
+				const ccv_nnc_graph_exec_t exec = ccv_nnc_graph_exec_from_symbol(compiled_data->graph_exec_arena, symbol);
+				if (!exec.graph)
+					continue;
+				const ccv_cnnp_calibration_t calibration = {
+					.cmd = ccv_nnc_graph_exec_cmd(exec.graph, exec),
+					.exec = exec,
+					.range = 0,
+				};
+				ccv_array_resize(calibrations, i + 1);
+				*(ccv_cnnp_calibration_t*)ccv_array_get(calibrations, i) = calibration;
+			}
+			for (i = 0; i < calibrations->rnum; i++)
+			{
+				ccv_cnnp_calibration_t* const calibration = (ccv_cnnp_calibration_t*)ccv_array_get(calibrations, i);
+				if (!calibration->exec.graph)
+					continue;
+				ccv_nnc_cmd_t cmd = ccv_nnc_cmd(CCV_NNC_CUSTOM_FORWARD, &ccv_cnnp_calibration_isa, calibration->cmd.info, 0);
+				cmd.data = calibration;
+				ccv_nnc_graph_exec_set(calibration->exec.graph, calibration->exec, cmd);
+			}
+			if (!calibrations->rnum)
+				break; // Nothing to quantize.
+		}
+		ccv_cnnp_model_evaluate(model, params, inputs, column_idx_size, outputs, output_size, 0, 0);
+		++sample_count;
+	}
+	ccv_cnnp_dataframe_iter_free(iter);
+	for (i = 0; i < output_size; i++)
+		ccv_nnc_tensor_free(outputs[i]);
+	ccfree(outputs);
+	// Rewrite the symbolic graph with the collected ranges, it will be compiled again on next evaluation.
+	ccv_array_t* const execs = ccv_array_new(sizeof(ccv_nnc_graph_exec_symbol_t), 0, 0);
+	ccv_array_t* const ranges = ccv_array_new(sizeof(float), 0, 0);
+	for (i = 0; i < calibrations->rnum; i++)
+	{
+		const ccv_cnnp_calibration_t* const calibration = (ccv_cnnp_calibration_t*)ccv_array_get(calibrations, i);
+		if (!calibration->exec.graph)
+			continue;
+		const ccv_nnc_graph_exec_symbol_t symbol = {
+			.d = i,
+			.graph = model->graph
+		};
+		ccv_array_push(execs, &symbol);
+		ccv_array_push(ranges, &calibration->range);
+	}
+	ccv_array_free(calibrations);
+	_ccv_cnnp_compiled_data_graph_free(compiled_data);
+	// The weights are known by now, thus, they are quantized once rather than every time the model runs.
+	ccv_array_t* const tensor_binds = ccv_array_new(sizeof(ccv_nnc_tensor_bind_t), 0, 0);
+	_ccv_cnnp_model_bind_tensors(model->graph, (ccv_nnc_tensor_symbol_t*)ccv_array_get(compiled_data->parameters, 0), compiled_data->tensors.parameters, compiled_data->parameters->rnum, 1, tensor_binds);
+	ccv_nnc_symbolic_graph_quantize(model->graph, (ccv_nnc_graph_exec_symbol_t*)ccv_array_get(execs, 0), (float*)ccv_array_get(ranges, 0), execs->rnum, (ccv_nnc_tensor_bind_t*)ccv_array_get(tensor_binds, 0), tensor_binds->rnum);
+	ccv_array_free(tensor_binds);
+	ccv_array_free(execs);
+	ccv_array_free(ranges);
+}
+
 // Compile the graph to run ccv_cnnp_model_backward after ccv_cnnp_model_evaluate with requires_grad = true (MULTISTAGE_MODE).
 // Particularly, this method compiles the accumulator graph.
 static void _ccv_cnnp_model_multistage_jit_1(ccv_cnnp_model_t* const model)
@@ -1773,6 +2074,7 @@ static void _ccv_cnnp_model_multistage_jit_2(ccv_cnnp_model_t* const model)
 	}
 	ccv_nnc_symbolic_graph_compile(model->graph, compiled_data->compile_params, (ccv_nnc_tensor_bind_t*)ccv_array_get(tensor_binds, 0), tensor_binds->rnum, 0, 0, froms, from_size, (ccv_nnc_graph_exec_symbol_t*)ccv_array_get(tos, 0), tos->rnum, &compiled_data->apply_gradients.graph, &compiled_data->apply_gradients.tensor_arena, &compiled_data->apply_gradients.graph_exec_arena);
 	ccv_array_free(tos);
+	compiled_data->apply_gradients.update_groups = _ccv_cnnp_model_group_updates(model, compiled_data->apply_gradients.graph, compiled_data->apply_gradients.tensor_arena, compiled_data->apply_gradients.graph_exec_arena);
 	ccv_array_free(tensor_binds);
 	ccfree(froms);
 	const int max_saved_aux_size = compiled_data->minimize.max_saved_aux_size;
@@ -2247,6 +2549,8 @@ void ccv_cnnp_model_set_minimizer(ccv_cnnp_model_t* const model, const ccv_nnc_c
 			_ccv_cnnp_compiled_data_graph_free(compiled_data);
 		_ccv_cnnp_compiled_data_apply_gradients_free(compiled_data);
 	}
+	_ccv_cnnp_model_set_update_groups(model, compiled_data->graph, compiled_data->graph_exec_arena, compiled_data->update_groups);
+	_ccv_cnnp_model_set_update_groups(model, compiled_data->apply_gradients.graph, compiled_data->apply_gradients.graph_exec_arena, compiled_data->apply_gradients.update_groups);
 }
 
 void ccv_cnnp_model_set_compile_params(ccv_cnnp_model_t* const model, const ccv_nnc_symbolic_graph_compile_param_t compile_params)
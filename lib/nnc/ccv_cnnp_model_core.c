@@ -123,8 +123,12 @@ static ccv_cnnp_model_t* _ccv_cnnp_sequential_model_copy(const ccv_cnnp_model_t*
 		khiter_t k = kh_put(model, model_map, (uint64_t)(uintptr_t)sub_model, &ret);
 		ccv_cnnp_model_t* model_copy;
 		if (ret != 0)
-			model_copy = kh_val(model_map, k) = _ccv_cnnp_model_copy(sub_model, model_map);
-		else
+		{
+			model_copy = _ccv_cnnp_model_copy(sub_model, model_map);
+			// The copy can put more into the map and resize it, thus, the iterator has to be looked up again.
+			k = kh_get(model, model_map, (uint64_t)(uintptr_t)sub_model);
+			kh_val(model_map, k) = model_copy;
+		} else
 			model_copy = kh_val(model_map, k);
 		sequential_model->sequence[i] = model_copy;
 	}
@@ -312,8 +316,12 @@ static ccv_cnnp_model_t* _ccv_cnnp_functional_model_copy(const ccv_cnnp_model_t*
 		khiter_t k = kh_put(model, model_map, (uint64_t)(uintptr_t)sub_model, &ret);
 		ccv_cnnp_model_t* model_copy;
 		if (ret != 0)
-			model_copy = kh_val(model_map, k) = _ccv_cnnp_model_copy(sub_model, model_map);
-		else
+		{
+			model_copy = _ccv_cnnp_model_copy(sub_model, model_map);
+			// The copy can put more into the map and resize it, thus, the iterator has to be looked up again.
+			k = kh_get(model, model_map, (uint64_t)(uintptr_t)sub_model);
+			kh_val(model_map, k) = model_copy;
+		} else
 			model_copy = kh_val(model_map, k);
 		ccv_cnnp_model_io_t model_io = functional_model->sequence[i] = ccmalloc(sizeof(struct ccv_cnnp_model_io_s) + sizeof(ccv_nnc_tensor_symbol_t) * sub_model->output_size);
 		model_io->param_ref = 0;
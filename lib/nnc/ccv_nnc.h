@@ -27,6 +27,48 @@
  */
 void ccv_nnc_init(void);
 
+enum {
+	CCV_NNC_THREAD_POOL_NESTED_SERIAL = 0, /**< A parallel for called from inside of a parallel for runs serially on that thread. */
+	CCV_NNC_THREAD_POOL_NESTED_PARALLEL = 1, /**< A parallel for called from inside of a parallel for is shared with idle threads. */
+};
+
+typedef struct {
+	int thread_count; /**< The number of threads execute a parallel for, including the calling thread if it participates. 0 to use all online CPUs. */
+	int caller_participates; /**< The thread calls ccv_nnc_parallel_for executes iterations too, rather than just waits. */
+	int nested; /**< The nested parallelism policy, CCV_NNC_THREAD_POOL_NESTED_SERIAL or CCV_NNC_THREAD_POOL_NESTED_PARALLEL. */
+	int pin_cpus; /**< Pin each thread in the pool to one CPU, starting from cpu_offset. */
+	int cpu_offset; /**< The first CPU to pin to. Useful when multiple processes share one host. */
+} ccv_nnc_thread_pool_param_t;
+
+/**
+ * The default thread pool parameters: use all online CPUs, the caller participates, nested parallel for
+ * runs serially and no pinning.
+ */
+extern const ccv_nnc_thread_pool_param_t ccv_nnc_default_thread_pool_params;
+/**
+ * Configure the thread pool CPU kernels use. The pool is created with the default parameters on
+ * first use. This cannot be called while any parallel for is in flight.
+ * @param params The thread pool parameters.
+ */
+void ccv_nnc_thread_pool_configure(const ccv_nnc_thread_pool_param_t params);
+/**
+ * The number of threads (including the caller, if it participates) a parallel for can use.
+ * @return The number of threads.
+ */
+CCV_WARN_UNUSED(int) ccv_nnc_thread_pool_size(void);
+/**
+ * The function to be called for each iteration of a parallel for.
+ */
+typedef void(*ccv_nnc_parallel_for_f)(void* const context, const int idx);
+/**
+ * Run fn for each idx in [0, n) on the thread pool, returns when all iterations are done.
+ * @param n The number of iterations.
+ * @param grain_size How many consecutive iterations one thread takes at a time. 0 to let the pool decide.
+ * @param fn The function to be called for each iteration.
+ * @param context The context to be passed to the function.
+ */
+void ccv_nnc_parallel_for(const int n, const int grain_size, const ccv_nnc_parallel_for_f fn, void* const context);
+
 /** @} */
 
 /**
@@ -58,6 +100,15 @@ enum {
 	CCV_NNC_EXEC_OOM       = -3, /**< Out of memory error. */
 };
 
+// Activations a command can apply to its first output, see activation.type below.
+enum {
+	CCV_NNC_ACTIVATION_NONE    = 0, /**< No activation. */
+	CCV_NNC_ACTIVATION_RELU    = 1, /**< max(x, 0), as CCV_NNC_RELU_FORWARD. */
+	CCV_NNC_ACTIVATION_SIGMOID = 2, /**< 1 / (1 + exp(-x)), as CCV_NNC_SIGMOID_FORWARD. */
+	CCV_NNC_ACTIVATION_TANH    = 3, /**< tanh(x), as CCV_NNC_TANH_FORWARD. */
+	CCV_NNC_ACTIVATION_SWISH   = 4, /**< x / (1 + exp(-x)), as CCV_NNC_SWISH_FORWARD. */
+};
+
 /**
  * Parameters for command.
  */
@@ -97,6 +148,7 @@ typedef struct {
 			float decay; /**< [sgd.decay] This is the weight decay parameter, which represents L2 regularization after momentum applied. */
 			float momentum; /**< [sgd.momentum] For SGD, this follows http://www.cs.toronto.edu/%7Ehinton/absps/momentum.pdf. */
 			float dampening; /**< [sgd.dampening] This usually == momentum, however, it can be changed. */
+			float max_norm; /**< [sgd.max_norm] If > 0, the scaled gradients are clipped such that their L2 norm across all parameters in this command is at most this value. GPU backends reject it. */
 		} sgd;
 		struct {
 			int step; /**< [adam.step] Step t in adam optimizer. */
@@ -105,6 +157,7 @@ typedef struct {
 			float beta2; /**< [adam.beta2] The beta2 hyper-parameter in adam optimizer. */
 			float decay; /**< [adam.decay] This is the weight decay parameter, which represents L2 regularization. */
 			float epsilon; /**< [adam.epsilon] The epsilon for standard derivation. */
+			float max_norm; /**< [adam.max_norm] If > 0, the gradients are clipped such that their L2 norm across all parameters in this command is at most this value. GPU backends reject it. */
 		} adam;
 		struct {
 			int step; /**< [lamb.step] Step t in lamb optimizer. */
@@ -113,6 +166,7 @@ typedef struct {
 			float beta2; /**< [lamb.beta2] The beta2 hyper-parameter in lamb optimizer. */
 			float decay; /**< [lamb.decay] This is the weight decay parameter, which represents L2 regularization. */
 			float epsilon; /**< [lamb.epsilon] The epsilon for standard derivation. */
+			float max_norm; /**< [lamb.max_norm] If > 0, the gradients are clipped such that their L2 norm across all parameters in this command is at most this value. GPU backends reject it. */
 		} lamb;
 		struct {
 			float rate; /**< [rmsprop.rate] The learning rate. */
@@ -120,6 +174,7 @@ typedef struct {
 			float alpha; /**< [rmsprop.momentum] The alpha hyper-parameter. */
 			float momentum; /**< [rmsprop.momentum] The momentum hyper-parameter. */
 			float epsilon; /**< [rmsprop.epsilon] The epsilon for standard derivation. */
+			float max_norm; /**< [rmsprop.max_norm] If > 0, the gradients are clipped such that their L2 norm across all parameters in this command is at most this value. GPU backends reject it. */
 		} rmsprop;
 		struct {
 			int transpose_a[2]; /**< [blas.transpose_a[2]] The axis we'd like to transpose for input a. */
@@ -157,9 +212,17 @@ typedef struct {
 		} clamp;
 		struct {
 			float iou_threshold; /**< [nms.iou_threshold] Threshold between 0 to 1 for IoU threshold. */
+			int top_k; /**< [nms.top_k] If > 0, only the top_k boxes with the highest scores are considered, the rest are suppressed. */
 		} nms;
 		void* userdata;
 	};
+	struct {
+		int type; /**< [activation.type] CCV_NNC_ACTIVATION_* applied in place to the first output after the command. It is set by CCV_NNC_SIMPLIFY_OPS_FUSION on forward commands only. */
+	} activation;
+	struct {
+		uint64_t seed; /**< [rand.seed] If not 0, the key of the counter based generator for the CPU_OPT random uniform, random normal and dropout. Otherwise, the seed is derived from the tensors as the reference backends do. */
+		uint64_t offset; /**< [rand.offset] The counter of the first number drawn, only used with rand.seed. The same seed and offset give the same output, advance it (by the number of elements, for example) to draw new numbers. */
+	} rand;
 } ccv_nnc_cmd_param_t;
 
 /*
@@ -428,11 +491,36 @@ void ccv_nnc_micro_combine_free(ccv_nnc_micro_combine_t* const combine);
  */
 void ccv_nnc_micro_combine_interpret(ccv_nnc_micro_combine_t* const combine, const uint32_t cmd, ccv_nnc_tensor_t* const* const inputs, const int input_size, const ccv_nnc_micro_scalar_t* const values, const int parameter_size, ccv_nnc_tensor_t* const* const outputs, const int output_size);
 /**
- * Generate C code from the combined op.
+ * Generate C code from the combined op. The code has two functions, ccv_nnc_micro_combine_forward and
+ * ccv_nnc_micro_combine_backward, and depends on nothing but the C standard library. Loops are tiled and annotated
+ * with OpenMP SIMD pragmas where it is safe, and parallel loops run through the ccv_nnc_parallel_for passed in.
  * @param combine The combined op to generate some C code.
- * @return The generated C code string.
+ * @return The generated C code string, free it with ccfree.
  */
-char* ccv_nnc_micro_combine_c(ccv_nnc_micro_combine_t* const combine);
+CCV_WARN_UNUSED(char*) ccv_nnc_micro_combine_c(ccv_nnc_micro_combine_t* const combine);
+/**
+ * Compile the combined op into native code. The generated C code is compiled with the system C compiler (the CC
+ * environment variable, or cc, run without a shell) into a shared object and loaded back. The shared objects are
+ * cached by the hash of the generated code, in memory for the process and on disk (in CCV_NNC_MICRO_CACHE_DIR, or
+ * a per user directory under TMPDIR). Thus, the same program is only compiled once. The on-disk cache is only used
+ * if the directory belongs to the current user and is not accessible by anyone else.
+ * @param combine The combined op to compile.
+ * @return 0 if the combined op is compiled, -1 otherwise.
+ */
+CCV_WARN_UNUSED(int) ccv_nnc_micro_combine_compile(ccv_nnc_micro_combine_t* const combine);
+/**
+ * Run combined op. It runs the compiled native code if ccv_nnc_micro_combine_compile succeeded, otherwise it falls
+ * back to the interpreter. The parameters are the same as ccv_nnc_micro_combine_interpret.
+ * @param combine The op.
+ * @param cmd Choice between CMD_CUSTOM_FORWARD and CMD_CUSTOM_BACKWARD.
+ * @param inputs The input tensors.
+ * @param input_size The size of input tensors.
+ * @param values The value corresponding to the parameters when call ccv_nnc_micro_combine_new.
+ * @param parameter_size How many parameters. It must match when called ccv_nnc_micro_combine_new.
+ * @param outputs The output tensors.
+ * @param output_size The size of output tensors.
+ */
+void ccv_nnc_micro_combine_exec(ccv_nnc_micro_combine_t* const combine, const uint32_t cmd, ccv_nnc_tensor_t* const* const inputs, const int input_size, const ccv_nnc_micro_scalar_t* const values, const int parameter_size, ccv_nnc_tensor_t* const* const outputs, const int output_size);
 
 /** @} */
 
@@ -701,7 +789,7 @@ CCV_WARN_UNUSED(int) ccv_nnc_cmd_enforce_inplace(const ccv_nnc_cmd_t cmd, const
 // Control flow constructs
 // Follow heavily based along CUDA's stream / event idea.
 enum {
-	CCV_STREAM_CONTEXT_CPU = 0x1, /**< A CPU based stream context (unsupported). */
+	CCV_STREAM_CONTEXT_CPU = 0x1, /**< A CPU based stream context, commands execute in order on its own thread. */
 	CCV_STREAM_CONTEXT_GPU = 0x2, /**< A GPU based stream context. */
 };
 #define CCV_STREAM_GET_CONTEXT(type) ((type) & 0x3)
@@ -749,8 +837,19 @@ void ccv_nnc_stream_context_add_callback(ccv_nnc_stream_context_t* const stream,
  * Wait until all tasks submitted (command, graph run etc.) on the stream context
  * completed.
  * @param stream The stream context to wait.
+ * @return CCV_NNC_EXEC_SUCCESS if succeed, otherwise the status of the first command failed on a CPU stream
+ *         context since the last wait. These commands execute asynchronously, ccv_nnc_cmd_exec cannot return it.
  */
-void ccv_nnc_stream_context_wait(const ccv_nnc_stream_context_t* const stream);
+int ccv_nnc_stream_context_wait(const ccv_nnc_stream_context_t* const stream);
+/**
+ * Set how many threads the scheduler of the stream context uses to run graphs. By default (0), the graph
+ * is dispatched from the thread calls ccv_nnc_graph_run. Otherwise, exec nodes ready to run are dispatched
+ * to these threads, and the commands of independent ones execute on them in parallel. Graphs run on the same
+ * stream context are still run one after another. It cannot be changed while the stream context is running a graph.
+ * @param stream The stream context to configure.
+ * @param worker_count The number of worker threads.
+ */
+void ccv_nnc_stream_context_set_scheduler_worker_count(ccv_nnc_stream_context_t* const stream, const int worker_count);
 /**
  * The hooks to be called when a stream context is destroyed.
  * At the moment, the stream context will be destroyed at the time
@@ -1264,6 +1363,24 @@ CCV_WARN_UNUSED(ccv_nnc_tensor_symbol_t) ccv_nnc_tensor_symbol_new(ccv_nnc_symbo
  * @return A tensor symbol alias reference.
  */
 CCV_WARN_UNUSED(ccv_nnc_tensor_symbol_t) ccv_nnc_tensor_symbol_alias_new(ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_symbol_t tensor_symbol, const int ofs[CCV_NNC_MAX_DIM_ALLOC], const int inc[CCV_NNC_MAX_DIM_ALLOC], const ccv_nnc_tensor_param_t info, const char* const name);
+/**
+ * Create a constant tensor symbol. The graph keeps a copy of the tensor. When the graph is compiled, the tensor arena
+ * gets its own copy of that and binds the symbol to it (unless it is bound explicitly), thus, the compiled graph doesn't
+ * depend on the symbolic graph afterwards. Nothing should write to a constant tensor symbol. If something does, it is
+ * allocated as a regular tensor symbol instead.
+ * @param graph The symbolic graph.
+ * @param tensor The tensor that contains the value of the constant, it is copied.
+ * @param name The name of the tensor symbol, it is optional.
+ * @return A tensor symbol reference.
+ */
+CCV_WARN_UNUSED(ccv_nnc_tensor_symbol_t) ccv_nnc_tensor_symbol_constant_new(ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_t* const tensor, const char* const name);
+/**
+ * Get the value of a constant tensor symbol.
+ * @param graph The symbolic graph.
+ * @param tensor The tensor symbol reference.
+ * @return The tensor that holds the value, owned by the graph. 0 if this is not a constant tensor symbol.
+ */
+CCV_WARN_UNUSED(ccv_nnc_tensor_t*) ccv_nnc_tensor_symbol_constant(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_symbol_t tensor);
 /**
  * Manually delete a tensor symbol off the symbolic graph.
  * @param graph The symbolic graph.
@@ -1472,7 +1589,7 @@ CCV_WARN_UNUSED(ccv_nnc_graph_exec_t) ccv_nnc_graph_exec_destination(const ccv_n
  */
 void ccv_nnc_graph_exec_arena_free(ccv_nnc_graph_exec_arena_t* const graph_exec_arena);
 /**
- * Write symbolic graph to disk, along with some binding tensors.
+ * Write symbolic graph to disk, along with some binding tensors. The values of constant tensor symbols are written too.
  * @param graph The symbolic graph.
  * @param tensor_binds The binding array (pair of tensor symbol and concrete tensor).
  * @param tensor_bind_size The size of the binding array.
@@ -1480,7 +1597,7 @@ void ccv_nnc_graph_exec_arena_free(ccv_nnc_graph_exec_arena_t* const graph_exec_
  */
 void ccv_nnc_symbolic_graph_write(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_bind_t* const tensor_binds, const int tensor_bind_size, const char* const fn);
 /**
- * Read symbolic graph from disk, with some binding tensors.
+ * Read symbolic graph from disk, with some binding tensors. Constant tensor symbols get their values back.
  * @param fn The file name.
  * @param graph_ref The pointer to store symbolic graph.
  * @param tensor_binds_ref The pointer to store the binding array.
@@ -1716,6 +1833,15 @@ int ccv_nnc_tensor_arena_reinit(ccv_nnc_tensor_arena_t* const tensor_arena, cons
  * @param symbolic_graph The updated symbolic graph.
  */
 void ccv_nnc_graph_exec_reinit(ccv_nnc_graph_exec_arena_t* const graph_exec_arena, ccv_nnc_graph_t* const graph, const ccv_nnc_symbolic_graph_t* const symbolic_graph);
+/**
+ * Topsort the concrete graph again after execution nodes are added to it or connected differently, and
+ * update the graph exec arena to the new execution node assignments.
+ * @param graph_exec_arena The graph exec arena object provided mapping between symbolic and concrete graph.
+ * @param graph The concrete graph generated through compile method.
+ * @param exec_cvt The execution node assignments will change, and you can give an array to know the changes.
+ * @param exec_cvt_size The provided conversion array size, should be the number of execution nodes in the graph.
+ */
+void ccv_nnc_graph_exec_arena_topsort(ccv_nnc_graph_exec_arena_t* const graph_exec_arena, ccv_nnc_graph_t* const graph, int* const exec_cvt, const int exec_cvt_size);
 /**
  * Function prototype for tensor symbol creation callback.
  */
@@ -2298,11 +2424,35 @@ enum {
 	 */
 	CCV_NNC_SIMPLIFY_DATA_TRANSFER_OPT,
 	/**
-	 * Combine a few smaller ops into bigger one. For now, this functionality is limited. I can only address ops
-	 * that are sequential.
+	 * Combine a few smaller ops into bigger one. A pattern matches a chain of commands, each reads the first output
+	 * of the one before, and the chain is replaced by one fused command (see ccv_nnc_ops_fusion_register). Besides
+	 * softmax / sigmoid with crossentropy, it adds the bias into the convolution / GEMM, sums up chains of elementwise
+	 * additions (multiplications) with one command, and sets the activation (ReLU, sigmoid, tanh, swish) that follows
+	 * a convolution, GEMM, batch norm or elementwise command to the activation.type of that command.
 	 */
 	CCV_NNC_SIMPLIFY_OPS_FUSION,
-	// CCV_NNC_SIMPLIFY_CONSTANT_FOLDING, // This currently is not supported, because we don't have efficient way to express constant in symbolic graph.
+	/**
+	 * Fold an inference mode CCV_NNC_BATCH_NORM_FORWARD into the CCV_NNC_CONVOLUTION_FORWARD that produces its input,
+	 * by scaling the convolution weights and bias instead. The batch norm input has to be used by nothing else.
+	 */
+	CCV_NNC_SIMPLIFY_BATCH_NORM_FOLDING,
+	/**
+	 * Evaluate the commands whose inputs are all constant tensor symbols (see ccv_nnc_tensor_symbol_constant_new)
+	 * on the CPU, and turn their outputs into constant tensor symbols. Thus, anything computed only from constants
+	 * (weight transposes, scale multiplications etc.) is done once here rather than every time the graph runs.
+	 * Constant tensor symbols in the binds are not folded because they will be bound to something else. Neither are
+	 * the outputs that other commands write to as well (in-place updates for example).
+	 */
+	CCV_NNC_SIMPLIFY_CONSTANT_FOLDING,
+	/**
+	 * Pick NHWC or NCHW for the intermediate tensors such that the fewest elements go through
+	 * CCV_NNC_FORMAT_TRANSFORM. Tensors used by the same convolution, pooling, upsample or elementwise command share a
+	 * format, which has to have a backend. The format transforms in between that become copies are removed, and the
+	 * tensors that keep their formats (bound, outputs, aliased or used by other commands) get one where needed.
+	 * The given sources / destinations stay valid: they keep their formats and are not removed, and the new format
+	 * transforms are put in between them.
+	 */
+	CCV_NNC_SIMPLIFY_LAYOUT_PROPAGATION,
 };
 /**
  * Simplify a graph with given list of passes, in that particular order.
@@ -2320,6 +2470,34 @@ enum {
  * @param destination_size The size of destination node symbols array.
  */
 void ccv_nnc_symbolic_graph_simplify(ccv_nnc_symbolic_graph_t* const graph, const int* const passes, const int pass_size, const ccv_nnc_tensor_symbol_t* const binds, const int bind_size, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size);
+/**
+ * The maximum number of commands a pattern of CCV_NNC_SIMPLIFY_OPS_FUSION can match.
+ */
+#define CCV_NNC_OPS_FUSION_MAX_SEQ (4)
+/**
+ * Build the fused command for a chain of commands matched by a pattern of CCV_NNC_SIMPLIFY_OPS_FUSION.
+ * @param graph The symbolic graph.
+ * @param execs The matched execution node symbols, in the order of the pattern.
+ * @param exec_size The number of matched execution node symbols.
+ * @param cmd The fused command, it starts as the command of the first node.
+ * @param hint The hint for the fused command, it starts as the hint of the first node.
+ * @param inputs The inputs of the fused command.
+ * @param input_size The number of inputs, it starts as the capacity of inputs (all inputs of the matched nodes).
+ * @param outputs The outputs of the fused command.
+ * @param output_size The number of outputs, it starts as the capacity of outputs (all outputs of the matched nodes).
+ * @return 1 if the chain can be fused, 0 to leave it as is.
+ */
+typedef int (*ccv_nnc_ops_fusion_f)(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_t* const execs, const int exec_size, ccv_nnc_cmd_t* const cmd, ccv_nnc_hint_t* const hint, ccv_nnc_tensor_symbol_t* const inputs, int* const input_size, ccv_nnc_tensor_symbol_t* const outputs, int* const output_size);
+/**
+ * Add a pattern to CCV_NNC_SIMPLIFY_OPS_FUSION, such that backends can contribute the fused commands they have kernels
+ * for. The registered patterns are tried before the built-in ones, in the order of registration. A fused command
+ * cannot read a tensor the matched nodes write, and whatever they write but the fused command doesn't is only
+ * fused if nothing else uses it. This is not thread-safe, register before simplifying any graphs.
+ * @param ops_seq The sequence of commands to match.
+ * @param ops_seq_size The length of the sequence, at least 2 and at most CCV_NNC_OPS_FUSION_MAX_SEQ.
+ * @param fusion The function to build the fused command.
+ */
+void ccv_nnc_ops_fusion_register(const uint32_t* const ops_seq, const int ops_seq_size, const ccv_nnc_ops_fusion_f fusion);
 
 /** @} */
 
@@ -2343,9 +2521,11 @@ enum {
  * "allreducer" concept is simpler. The allreduce operation will be performed on these tensors and then
  * be used on different devices again.
  *
- * Limitations: right now, the way to reduce / allreduce tensors only supports "sum". The data parallel
- * only supports GPU, thus, the nodes will be duplicated are GPU computations and GPU memory backed
- * tensors. Also, right now, the tensors to be broadcasted / allreduced / reduced should have no aliases.
+ * Limitations: right now, the way to reduce / allreduce tensors only supports "sum". If the graph has
+ * GPU memory backed tensors, the nodes will be duplicated are GPU computations and GPU memory backed
+ * tensors. Otherwise, the CPU computations are duplicated, and each replica of the CPU memory backed
+ * tensors is tagged with its own device id (parallel has to be specified in this case). Also, right now,
+ * the tensors to be broadcasted / allreduced / reduced should have no aliases.
  *
  * @param graph The symbolic graph.
  * @param parallel Number of devices we want to run on. 0 will use all devices available. 1 will skip.
@@ -2424,6 +2604,32 @@ void ccv_nnc_symbolic_graph_memory_compression(ccv_nnc_symbolic_graph_t* const g
 
 /** @} */
 
+/**
+ * @defgroup level_3_5_quantization Quantization
+ * @{
+ */
+
+/**
+ * Rewrite convolution and GEMM nodes to run with int8 inputs. Quantize nodes are inserted before these nodes
+ * for the activations (with one scale) and the weights (with one scale per output channel), and the nodes
+ * take the quantized tensors with their scales and output dequantized results. Nodes that don't have an int8
+ * kernel (grouped convolution, batched GEMM, non-CPU tensors and such) are left untouched. This is meant for
+ * inference graphs.
+ *
+ * The weights that are constant tensor symbols, or bound in tensor_binds, are quantized once here and the results
+ * become constant tensor symbols. Other weights are quantized every time the graph runs.
+ *
+ * @param graph The symbolic graph.
+ * @param execs The convolution / GEMM execution node symbols to quantize.
+ * @param ranges The maximum absolute value of the activations for each node, for example, collected with calibration. 0 or nil means computing the scale from the activations at runtime.
+ * @param exec_size The size of execution node symbols array.
+ * @param tensor_binds The values of the weights that will be bound when the graph is compiled (pair of tensor symbol and concrete tensor).
+ * @param tensor_bind_size The size of the binding array.
+ */
+void ccv_nnc_symbolic_graph_quantize(ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_t* const execs, const float* const ranges, const int exec_size, const ccv_nnc_tensor_bind_t* const tensor_binds, const int tensor_bind_size);
+
+/** @} */
+
 /** @} */
 
 /**
@@ -3441,6 +3647,19 @@ void ccv_cnnp_model_set_data_parallel(ccv_cnnp_model_t* const model, const int p
  * @param memory_compression Whether to enable the memory compression (1 - enable, 0 - disable (default))
  */
 void ccv_cnnp_model_set_memory_compression(ccv_cnnp_model_t* const model, const int memory_compression);
+/**
+ * Quantize convolution and dense layers of the model to int8 for inference. This first evaluates the model
+ * on the samples from the dataframe to collect the range of the activations going into these layers, and
+ * then rewrites the graph to quantize the activations with these ranges and the weights per output channel
+ * (see ccv_nnc_symbolic_graph_quantize). The model has to be compiled without loss function and cannot be
+ * trained afterwards.
+ * @param model The composed model.
+ * @param dataframe The dataframe with samples for calibration.
+ * @param column_idxs The columns in the dataframe for the inputs of the model, each column is a tensor.
+ * @param column_idx_size The size of the columns array, it should match the number of inputs.
+ * @param sample_size How many samples to use for calibration. 0 means all samples in the dataframe.
+ */
+void ccv_cnnp_model_quantize(ccv_cnnp_model_t* const model, ccv_cnnp_dataframe_t* const dataframe, const int* const column_idxs, const int column_idx_size, const int sample_size);
 /**
  * Set compile parameters on the model so it compiles the graph with the said parameters.
  * @param model The composed model.
@@ -3511,7 +3730,8 @@ void ccv_cnnp_model_parameters_map(ccv_cnnp_model_t* const model, const ccv_cnnp
 /**
  * Set a new minimizer for the model. This is useful when you need to update learn rate for stochastic
  * gradient descent for example. This method can be called any time during the training process (after
- * compilation).
+ * compilation). Parameters that end up with the same minimizer are updated together with one command, thus,
+ * a max_norm on the minimizer clips the gradients of all these parameters as a whole.
  * @param model The composed model.
  * @param minimizer The wrapped command that represents a new optimization strategy.
  * @param reset Reset all previous states of minimizers. This only makes sense if both parameters and parameter_size is 0.
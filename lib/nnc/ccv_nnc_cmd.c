@@ -1,6 +1,7 @@
 #include "ccv_nnc.h"
 #include "ccv_nnc_internal.h"
 #include "ccv_nnc_easy.h"
+#include "_ccv_nnc_stream.h"
 #ifdef HAVE_CUDA
 #include "gpu/ccv_nnc_compat.h"
 #endif
@@ -598,6 +599,81 @@ int ccv_nnc_device_ids_for_io(ccv_nnc_tensor_t* const* const inputs, const int i
 	return device_id_size;
 }
 
+typedef struct {
+	ccv_nnc_cmd_t cmd;
+	ccv_nnc_hint_t hint;
+	int flags;
+	int input_size;
+	int output_size;
+	ccv_nnc_cmd_exec_f exec;
+	ccv_nnc_stream_context_t* stream_context;
+	ccv_nnc_tensor_t* tensors[1];
+} ccv_nnc_cmd_exec_async_t;
+
+static void _ccv_nnc_cmd_exec_async(void* const context)
+{
+	ccv_nnc_cmd_exec_async_t* const async = (ccv_nnc_cmd_exec_async_t*)context;
+	const int status = async->exec(async->cmd, async->hint, async->flags, async->tensors, async->input_size, async->tensors + async->input_size, async->output_size, async->stream_context);
+	ccv_nnc_stream_context_set_status(async->stream_context, status);
+	ccfree(async);
+}
+
+static void _ccv_nnc_cmd_exec_submit(const ccv_nnc_cmd_exec_f exec, const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	// The tensor headers can be freed or reused by the caller once this returns (only the memory they point to
+	// is guaranteed to be alive), therefore, copy them over alongside the command.
+	int i, j;
+	const int tensor_size = input_size + output_size;
+	size_t header_size = 0;
+	for (i = 0; i < tensor_size; i++)
+	{
+		ccv_nnc_tensor_t* const tensor = i < input_size ? inputs[i] : outputs[i - input_size];
+		if (tensor)
+			header_size += CCV_IS_TENSOR_VIEW(tensor) ? sizeof(ccv_nnc_tensor_view_t) : sizeof(ccv_nnc_tensor_t);
+	}
+	const size_t async_size = sizeof(ccv_nnc_cmd_exec_async_t) + sizeof(ccv_nnc_tensor_t*) * ccv_max(tensor_size - 1, 0);
+	ccv_nnc_cmd_exec_async_t* const async = (ccv_nnc_cmd_exec_async_t*)ccmalloc(((async_size + 15) & -16) + header_size);
+	async->cmd = cmd;
+	async->hint = hint;
+	async->flags = flags;
+	async->input_size = input_size;
+	async->output_size = output_size;
+	async->exec = exec;
+	async->stream_context = stream_context;
+	unsigned char* header = (unsigned char*)async + ((async_size + 15) & -16);
+	for (i = 0; i < tensor_size; i++)
+	{
+		ccv_nnc_tensor_t* const tensor = i < input_size ? inputs[i] : outputs[i - input_size];
+		async->tensors[i] = 0;
+		if (!tensor)
+			continue;
+		// Keep the aliasing between inputs and outputs (for in-place operations).
+		for (j = 0; !async->tensors[i] && j < i; j++)
+			if ((j < input_size ? inputs[j] : outputs[j - input_size]) == tensor)
+				async->tensors[i] = async->tensors[j];
+		if (async->tensors[i])
+			continue;
+		const size_t size = CCV_IS_TENSOR_VIEW(tensor) ? sizeof(ccv_nnc_tensor_view_t) : sizeof(ccv_nnc_tensor_t);
+		memcpy(header, tensor, size);
+		async->tensors[i] = (ccv_nnc_tensor_t*)header;
+		header += size;
+	}
+	ccv_nnc_stream_context_submit(stream_context, _ccv_nnc_cmd_exec_async, async);
+}
+
+static int _ccv_nnc_cmd_exec_activation(const int activation, ccv_nnc_tensor_t* const b, ccv_nnc_stream_context_t* const stream_context)
+{
+	static const uint32_t activation_cmds[] = {
+		[CCV_NNC_ACTIVATION_RELU] = CCV_NNC_RELU_FORWARD,
+		[CCV_NNC_ACTIVATION_SIGMOID] = CCV_NNC_SIGMOID_FORWARD,
+		[CCV_NNC_ACTIVATION_TANH] = CCV_NNC_TANH_FORWARD,
+		[CCV_NNC_ACTIVATION_SWISH] = CCV_NNC_SWISH_FORWARD,
+	};
+	assert(activation > 0 && activation < sizeof(activation_cmds) / sizeof(activation_cmds[0]));
+	ccv_nnc_tensor_t* const tensors[] = { b };
+	return ccv_nnc_cmd_exec(ccv_nnc_cmd(activation_cmds[activation], 0, ccv_nnc_cmd_auto, 0), ccv_nnc_no_hint, 0, tensors, 1, tensors, 1, stream_context);
+}
+
 int ccv_nnc_cmd_exec(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
 	// If it is no-op, return as if succeed already.
@@ -635,10 +711,23 @@ int ccv_nnc_cmd_exec(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const i
 	const ccv_nnc_cmd_backend_registry_t api_registry = init_map[cmd_idx].backends[backend_idx];
 	if (!api_registry.exec)
 		return CCV_NNC_EXEC_NO_KERNEL;
+	// If the backend doesn't apply the fused activation itself, it runs as its own command on the first output afterwards.
+	const int activation = cmd.info.activation.type != CCV_NNC_ACTIVATION_NONE && !(api_registry.activations & (1 << cmd.info.activation.type)) ? cmd.info.activation.type : CCV_NNC_ACTIVATION_NONE;
+	assert(!activation || (ccv_nnc_cmd_is_forward(cmd) && output_size > 0 && outputs[0]));
+	// On a CPU stream, the kernel executes in order on the stream's own thread. Its status is returned by ccv_nnc_stream_context_wait.
+	if (ccv_nnc_stream_context_is_async(stream_context))
+	{
+		_ccv_nnc_cmd_exec_submit(api_registry.exec, cmd, hint, flags, inputs, input_size, outputs, output_size, stream_context);
+		if (activation)
+			return _ccv_nnc_cmd_exec_activation(activation, outputs[0], stream_context);
+		return CCV_NNC_EXEC_SUCCESS;
+	}
 	// Everything is out, call the underlying implementation.
 	int ret = api_registry.exec(cmd, hint, flags, inputs, input_size, outputs, output_size, stream_context);
 	if (!stream_context)
 		ccv_nnc_stream_context_drain(stream_context);
+	if (ret == CCV_NNC_EXEC_SUCCESS && activation)
+		ret = _ccv_nnc_cmd_exec_activation(activation, outputs[0], stream_context);
 	return ret;
 }
 
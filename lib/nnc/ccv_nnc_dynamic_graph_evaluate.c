@@ -33,8 +33,8 @@ static int _ccv_cnnp_model_exec(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hi
 	{
 		old_main = stream_context->main;
 		old_scheduler = stream_context->scheduler;
-		// We cannot piggyback on old scheduler.
-		stream_context->scheduler = 0;
+		// We cannot piggyback on old scheduler. The new one runs on this thread, regardless of the worker count of the stream.
+		stream_context->scheduler = co_scheduler_new(0);
 		// We will have a new main coroutine when schedule as the root.
 		// Otherwise it will be scheduled after the existing routines all scheduled
 		// out, and that won't be right.
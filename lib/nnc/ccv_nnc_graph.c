@@ -522,7 +522,7 @@ void ccv_nnc_graph_topsort(ccv_nnc_graph_t* const graph, int* const exec_cvt, co
 		for (i = 0; i < graph->breakpoint_size; i++)
 			exec_cvt[graph->breakpoints[i].d] = -2; // Mark this as breakpoints, so we will skip the first round.
 		ccv_nnc_graph_visit_for(visit, (ccv_nnc_graph_exec_info_t*)ccv_array_get(graph->exec_info, 0), node, idx) {
-			assert(!node->pair_ref); // If node has a pair ref, we cannot fix it up.
+			assert(!node->pair_ref || !graph->pair); // If node has a pair ref to another graph, we cannot fix it up.
 			if (exec_cvt[idx] == -2) // Skip breakpoint.
 				continue;
 			// Loop over node and push to the array.
@@ -543,7 +543,7 @@ void ccv_nnc_graph_topsort(ccv_nnc_graph_t* const graph, int* const exec_cvt, co
 		graph->breakpoint_offset = exec_info->rnum;
 		visit = ccv_nnc_graph_visit_new(graph, (ccv_nnc_graph_exec_info_t*)ccv_array_get(graph->exec_info, 0), graph->exec_info->rnum, graph->breakpoints, graph->breakpoint_size, (ccv_nnc_graph_exec_t*)ccv_array_get(graph->destinations, 0), graph->destinations->rnum, 0);
 		ccv_nnc_graph_visit_for(visit, (ccv_nnc_graph_exec_info_t*)ccv_array_get(graph->exec_info, 0), node, idx) {
-			assert(!node->pair_ref); // If node has a pair ref, we cannot fix it up.
+			assert(!node->pair_ref || !graph->pair); // If node has a pair ref to another graph, we cannot fix it up.
 			// Loop over node and push to the array.
 			ccv_array_push(exec_info, node);
 			// Go to its sub-graph to fix exec_idx
@@ -564,7 +564,7 @@ void ccv_nnc_graph_topsort(ccv_nnc_graph_t* const graph, int* const exec_cvt, co
 	} else {
 		ccv_nnc_graph_visit_t* visit = ccv_nnc_graph_visit_new(graph, (ccv_nnc_graph_exec_info_t*)ccv_array_get(graph->exec_info, 0), graph->exec_info->rnum, (ccv_nnc_graph_exec_t*)ccv_array_get(graph->sources, 0), graph->sources->rnum, (ccv_nnc_graph_exec_t*)ccv_array_get(graph->destinations, 0), graph->destinations->rnum, 0);
 		ccv_nnc_graph_visit_for(visit, (ccv_nnc_graph_exec_info_t*)ccv_array_get(graph->exec_info, 0), node, idx) {
-			assert(!node->pair_ref); // If node has a pair ref, we cannot fix it up.
+			assert(!node->pair_ref || !graph->pair); // If node has a pair ref to another graph, we cannot fix it up.
 			// Loop over node and push to the array.
 			ccv_array_push(exec_info, node);
 			// Go to its sub-graph to fix exec_idx
@@ -601,6 +601,9 @@ void ccv_nnc_graph_topsort(ccv_nnc_graph_t* const graph, int* const exec_cvt, co
 		if (info->outgoings)
 			for (j = 0; j < info->outgoings->rnum; j++)
 				*(int*)ccv_array_get(info->outgoings, j) = exec_cvt[*(int*)ccv_array_get(info->outgoings, j)];
+		// The pair ref is within the same graph, fix it up as well.
+		if (info->pair_ref)
+			info->pair_ref = exec_cvt[info->pair_ref - 1] + 1;
 	}
 	graph->topsorted = 1;
 }
@@ -315,6 +315,10 @@ void ccv_nnc_print_tensor_info(const ccv_nnc_tensor_t* const tensor)
 				for (i = 0; i < len; i++)
 					PRINT(CCV_CLI_VERBOSE, " %d", (int)tensor->data.u8[i]);
 				break;
+			case CCV_8S:
+				for (i = 0; i < len; i++)
+					PRINT(CCV_CLI_VERBOSE, " %d", (int)tensor->data.i8[i]);
+				break;
 		}
 		if (ccv_nnc_tensor_count(tensor->info) > 3)
 			PRINT(CCV_CLI_VERBOSE, " ..");
@@ -387,7 +391,81 @@ static ccv_nnc_stream_context_t* _ccv_nnc_graph_neighbor_context_discovery(const
 	return 0;
 }
 
-static co_routine_t* _ccv_nnc_graph_exec_run_task(ccv_nnc_graph_t* const graph, ccv_nnc_graph_exec_info_t* const node, const ccv_nnc_graph_exec_schedule_t* const schd, const int idx, ccv_nnc_tensor_tape_t* const tensor_tape, const int flags)
+static void _ccv_nnc_graph_exec_run_cmd(ccv_nnc_graph_t* const graph, ccv_nnc_graph_exec_info_t* const node, const ccv_nnc_graph_exec_schedule_t* const schd, const int idx, ccv_nnc_tensor_t* const* const inputs, ccv_nnc_tensor_t* const* const outputs, const int flags)
+{
+	PRINT(CCV_CLI_INFO, "%s [%d]: [%d] -> [%d] (%d)\n", ccv_nnc_cmd_name(node->cmd.cmd), idx, node->input_size, node->output_size, SCHEDULE_STREAMS(*schd)[0]);
+	int i, j;
+	int flag = 0;
+	for (i = 0; i < schd->stream_size; i++)
+	{
+		ccv_nnc_stream_context_t* const stream = graph->streams[SCHEDULE_STREAMS(*schd)[i]];
+		for (j = 0; j < schd->wait_size; j++)
+		{
+			ccv_nnc_stream_context_wait_signal(stream, graph->signals[schd->waits[j]]);
+			if (!flag)
+			{
+				PRINT(CCV_CLI_INFO, "Wait: (%d, %d)", SCHEDULE_STREAMS(*schd)[i], schd->waits[j]);
+				flag = 1;
+			} else
+				PRINT(CCV_CLI_INFO, ", (%d, %d)", SCHEDULE_STREAMS(*schd)[i], schd->waits[j]);
+		}
+	}
+	if (flag)
+		PRINT(CCV_CLI_INFO, "\n");
+	for (i = 0; i < node->input_size; i++)
+	{
+		PRINT(CCV_CLI_INFO, "|-> %d. %p (%p:%d)", i + 1, inputs[i], (inputs[i] ? inputs[i]->data.u8 : 0), (inputs[i] ? CCV_TENSOR_GET_DEVICE_ID(inputs[i]->info.type) : -1));
+		if (inputs[i] && CCV_CLI_OUTPUT_LEVEL_IS(CCV_CLI_INFO))
+			ccv_nnc_print_tensor_info(inputs[i]);
+		PRINT(CCV_CLI_INFO, "\n");
+	}
+	ccv_nnc_stream_context_t* const node_stream = graph->streams[SCHEDULE_STREAMS(*schd)[0]];
+	ccv_nnc_graph_neighbor_context_discovery_t discovery_context = {
+		.graph = graph,
+		.node = schd,
+		.stream = node_stream
+	};
+	ccv_nnc_stream_context_set_neighbor_discovery(node_stream, _ccv_nnc_graph_neighbor_context_discovery, &discovery_context);
+	// If the command is executed directly on the stream, record its failure the same way the stream thread does.
+	ccv_nnc_stream_context_set_status(node_stream, ccv_nnc_cmd_exec(node->cmd, node->hint, flags, inputs, node->input_size, outputs, node->output_size, node_stream));
+	for (i = 0; i < node->output_size; i++)
+	{
+		PRINT(CCV_CLI_INFO, "|<- %d. %p (%p:%d)", i + 1, outputs[i], (outputs[i] ? outputs[i]->data.u8 : 0), (outputs[i] ? CCV_TENSOR_GET_DEVICE_ID(outputs[i]->info.type) : -1));
+		if (outputs[i] && CCV_CLI_OUTPUT_LEVEL_IS(CCV_CLI_INFO))
+			ccv_nnc_print_tensor_info(outputs[i]);
+		PRINT(CCV_CLI_INFO, "\n");
+	}
+	flag = 0;
+	for (i = 0; i < schd->stream_size; i++)
+		if (SCHEDULE_SIGNALS(*schd)[i] >= 0)
+		{
+			ccv_nnc_stream_context_t* const stream = graph->streams[SCHEDULE_STREAMS(*schd)[i]];
+			ccv_nnc_stream_context_emit_signal(stream, graph->signals[SCHEDULE_SIGNALS(*schd)[i]]);
+			if (!flag)
+			{
+				PRINT(CCV_CLI_INFO, "Emit: (%d, %d)", SCHEDULE_STREAMS(*schd)[i], SCHEDULE_SIGNALS(*schd)[i]);
+				flag = 1;
+			} else
+				PRINT(CCV_CLI_INFO, ", (%d, %d)", SCHEDULE_STREAMS(*schd)[i], SCHEDULE_SIGNALS(*schd)[i]);
+		}
+	if (flag)
+		PRINT(CCV_CLI_INFO, "\n");
+}
+
+static co_decl_task(_ccv_nnc_graph_exec_run_cmd_coro, (ccv_nnc_graph_t* const graph, ccv_nnc_graph_exec_info_t* const node, const ccv_nnc_graph_exec_schedule_t* const schd, const int idx, ccv_nnc_tensor_t* const* const inputs, ccv_nnc_tensor_t* const* const outputs, const int flags), private(
+	int i;
+)) {
+	// The streams may still run the work submitted before, from the graph begins or sub-graphs. Wait until they are idle.
+	for (CO_V(i) = 0; CO_V(i) < CO_P(schd)->stream_size; CO_V(i)++)
+		co_stream_await(CO_P(graph)->streams[SCHEDULE_STREAMS(*CO_P(schd))[CO_V(i)]]);
+	// Then run the command on this worker as if it is on the stream, this is what makes independent nodes run in parallel.
+	ccv_nnc_stream_context_t* const previous = ccv_nnc_stream_context_enter(CO_P(graph)->streams[SCHEDULE_STREAMS(*CO_P(schd))[0]]);
+	_ccv_nnc_graph_exec_run_cmd(CO_P(graph), CO_P(node), CO_P(schd), CO_P(idx), CO_P(inputs), CO_P(outputs), CO_P(flags));
+	ccv_nnc_stream_context_leave(previous);
+} co_end()
+
+// If spawn is set, the command runs in a task as well, otherwise it is executed (submitted to the stream) directly.
+static co_routine_t* _ccv_nnc_graph_exec_run_task(ccv_nnc_graph_t* const graph, ccv_nnc_graph_exec_info_t* const node, const ccv_nnc_graph_exec_schedule_t* const schd, const int idx, ccv_nnc_tensor_tape_t* const tensor_tape, const int spawn, const int flags)
 {
 	_ccv_nnc_graph_exec_unwrap_io(graph, node);
 	ccv_nnc_tensor_t** inputs = node->inputs;
@@ -408,64 +486,10 @@ static co_routine_t* _ccv_nnc_graph_exec_run_task(ccv_nnc_graph_t* const graph,
 			assert(graph->streams[SCHEDULE_STREAMS(*schd)[0]] == sub_graph->streams[0]);
 			return co_new(_ccv_nnc_graph_topsorted_run_coro, (sub_graph, idx, sub_graph->default_schedule, node, tensor_tape, graph->streams[SCHEDULE_STREAMS(*schd)[0]], flags));
 		}
-	} else {
-		PRINT(CCV_CLI_INFO, "%s [%d]: [%d] -> [%d] (%d)\n", ccv_nnc_cmd_name(node->cmd.cmd), idx, node->input_size, node->output_size, SCHEDULE_STREAMS(*schd)[0]);
-		int i, j;
-		int flag = 0;
-		for (i = 0; i < schd->stream_size; i++)
-		{
-			ccv_nnc_stream_context_t* const stream = graph->streams[SCHEDULE_STREAMS(*schd)[i]];
-			for (j = 0; j < schd->wait_size; j++)
-			{
-				ccv_nnc_stream_context_wait_signal(stream, graph->signals[schd->waits[j]]);
-				if (!flag)
-				{
-					PRINT(CCV_CLI_INFO, "Wait: (%d, %d)", SCHEDULE_STREAMS(*schd)[i], schd->waits[j]);
-					flag = 1;
-				} else
-					PRINT(CCV_CLI_INFO, ", (%d, %d)", SCHEDULE_STREAMS(*schd)[i], schd->waits[j]);
-			}
-		}
-		if (flag)
-			PRINT(CCV_CLI_INFO, "\n");
-		for (i = 0; i < node->input_size; i++)
-		{
-			PRINT(CCV_CLI_INFO, "|-> %d. %p (%p:%d)", i + 1, inputs[i], (inputs[i] ? inputs[i]->data.u8 : 0), (inputs[i] ? CCV_TENSOR_GET_DEVICE_ID(inputs[i]->info.type) : -1));
-			if (inputs[i] && CCV_CLI_OUTPUT_LEVEL_IS(CCV_CLI_INFO))
-				ccv_nnc_print_tensor_info(inputs[i]);
-			PRINT(CCV_CLI_INFO, "\n");
-		}
-		ccv_nnc_stream_context_t* const node_stream = graph->streams[SCHEDULE_STREAMS(*schd)[0]];
-		ccv_nnc_graph_neighbor_context_discovery_t discovery_context = {
-			.graph = graph,
-			.node = schd,
-			.stream = node_stream
-		};
-		ccv_nnc_stream_context_set_neighbor_discovery(node_stream, _ccv_nnc_graph_neighbor_context_discovery, &discovery_context);
-		ccv_nnc_cmd_exec(node->cmd, node->hint, flags, inputs, node->input_size, outputs, node->output_size, node_stream);
-		for (i = 0; i < node->output_size; i++)
-		{
-			PRINT(CCV_CLI_INFO, "|<- %d. %p (%p:%d)", i + 1, outputs[i], (outputs[i] ? outputs[i]->data.u8 : 0), (outputs[i] ? CCV_TENSOR_GET_DEVICE_ID(outputs[i]->info.type) : -1));
-			if (outputs[i] && CCV_CLI_OUTPUT_LEVEL_IS(CCV_CLI_INFO))
-				ccv_nnc_print_tensor_info(outputs[i]);
-			PRINT(CCV_CLI_INFO, "\n");
-		}
-		flag = 0;
-		for (i = 0; i < schd->stream_size; i++)
-			if (SCHEDULE_SIGNALS(*schd)[i] >= 0)
-			{
-				ccv_nnc_stream_context_t* const stream = graph->streams[SCHEDULE_STREAMS(*schd)[i]];
-				ccv_nnc_stream_context_emit_signal(stream, graph->signals[SCHEDULE_SIGNALS(*schd)[i]]);
-				if (!flag)
-				{
-					PRINT(CCV_CLI_INFO, "Emit: (%d, %d)", SCHEDULE_STREAMS(*schd)[i], SCHEDULE_SIGNALS(*schd)[i]);
-					flag = 1;
-				} else
-					PRINT(CCV_CLI_INFO, ", (%d, %d)", SCHEDULE_STREAMS(*schd)[i], SCHEDULE_SIGNALS(*schd)[i]);
-			}
-		if (flag)
-			PRINT(CCV_CLI_INFO, "\n");
-	}
+	} else if (spawn)
+		return co_new(_ccv_nnc_graph_exec_run_cmd_coro, (graph, node, schd, idx, inputs, outputs, flags));
+	else
+		_ccv_nnc_graph_exec_run_cmd(graph, node, schd, idx, inputs, outputs, flags);
 	return 0;
 }
 
@@ -484,31 +508,42 @@ static void _ccv_nnc_graph_mark_outgoing_streams_blocked_by_task(ccv_nnc_graph_t
 		}
 }
 
-static co_decl_task(_ccv_nnc_graph_wait_any_sub_tasks, (ccv_nnc_graph_t* const graph, co_routine_t* const* const sub_tasks, const int sub_task_size, const ccv_nnc_graph_exec_schedule_t* const schd_info, const int* const pending_nodes, const int pending_node_size), private(
+static co_decl_task(_ccv_nnc_graph_wait_any_sub_tasks, (ccv_nnc_graph_t* const graph, ccv_nnc_graph_exec_info_t* const exec_info, const ccv_nnc_graph_exec_schedule_t* const schd_info, co_routine_t** const sub_tasks, int* const sub_task_idxs, int* const sub_task_size), private(
 )) {
-	assert(CO_P(sub_task_size) > 0);
-	co_await_any(CO_P(sub_tasks), CO_P(sub_task_size));
+	assert(*CO_P(sub_task_size) > 0);
+	co_await_any(CO_P(sub_tasks), *CO_P(sub_task_size));
 	// This is not good, these local variables need to be in the private section.
 	// I got away with it because there is no yield or resume or apply or any after await above.
 	int i, j, k;
-	for (i = 0; i < CO_P(sub_task_size); i++)
+	for (i = 0, j = 0; i < *CO_P(sub_task_size); i++)
 		if (co_is_done(CO_P(sub_tasks)[i]))
 		{
-			for (j = 0; j < CO_P(pending_node_size); j++)
-			{
-				const ccv_nnc_graph_exec_schedule_t* const node = CO_P(schd_info) + CO_P(pending_nodes)[j];
-				for (k = 0; k < node->stream_size; k++)
-					if (CO_P(graph)->block_stream_tasks[SCHEDULE_STREAMS(*node)[k]] == CO_P(sub_tasks)[i])
-						CO_P(graph)->block_stream_tasks[SCHEDULE_STREAMS(*node)[k]] = 0;
-			}
+			for (k = 0; k < CO_P(graph)->stream_size; k++)
+				if (CO_P(graph)->block_stream_tasks[k] == CO_P(sub_tasks)[i])
+					CO_P(graph)->block_stream_tasks[k] = 0;
 			co_free(CO_P(sub_tasks)[i]);
+		} else { // Keep the tasks still running to wait for them later.
+			CO_P(sub_tasks)[j] = CO_P(sub_tasks)[i];
+			CO_P(sub_task_idxs)[j] = CO_P(sub_task_idxs)[i];
+			++j;
 		}
+	*CO_P(sub_task_size) = j;
+	// A stream blocked by a task that is done may also be blocked by a task still running (it was overwritten), mark these again.
+	for (i = 0; i < j; i++)
+	{
+		const ccv_nnc_graph_exec_schedule_t* const schd = CO_P(schd_info) + CO_P(sub_task_idxs)[i];
+		for (k = 0; k < schd->stream_size; k++)
+			CO_P(graph)->block_stream_tasks[SCHEDULE_STREAMS(*schd)[k]] = CO_P(sub_tasks)[i];
+		_ccv_nnc_graph_mark_outgoing_streams_blocked_by_task(CO_P(graph), CO_P(schd_info), CO_P(exec_info) + CO_P(sub_task_idxs)[i], CO_P(sub_tasks)[i]);
+	}
 } co_end()
 
 static co_decl_task(_ccv_nnc_graph_exec_run_loop, (ccv_nnc_graph_t* const graph, ccv_nnc_graph_exec_info_t* const exec_info, const ccv_nnc_graph_exec_schedule_t* const schd_info, const int* const psort, const int start_index, const int exec_info_size, ccv_nnc_tensor_tape_t* const tensor_tape, const int flags), private(
 	int i, p, q;
+	int spawn;
 	int sub_task_size;
 	co_routine_t** sub_tasks;
+	int* sub_task_idxs;
 	int* pending_nodes[2];
 	int pending_node_size[2];
 	int idx;
@@ -516,73 +551,52 @@ static co_decl_task(_ccv_nnc_graph_exec_run_loop, (ccv_nnc_graph_t* const graph,
 	const ccv_nnc_graph_exec_schedule_t* schd;
 	co_routine_t* task;
 )) {
+	// With workers, every exec node runs in its own task, thus, independent ones run in parallel.
+	CO_V(spawn) = co_scheduler_worker_count(co_self()->scheduler) > 0;
+	const int sub_task_capacity = (CO_P(graph)->sub_graphs ? CO_P(graph)->sub_graphs->rnum : 0) + (CO_V(spawn) ? CO_P(exec_info_size) : 0);
 	CO_V(sub_task_size) = 0;
-	CO_V(sub_tasks) = (co_routine_t**)ccv_nnc_graph_buffer(CO_P(graph), sizeof(co_routine_t*) * (CO_P(graph)->sub_graphs ? CO_P(graph)->sub_graphs->rnum : 0) + sizeof(int) * CO_P(exec_info_size) * 2);
-	CO_V(pending_nodes)[0] = (int*)(CO_V(sub_tasks) + (CO_P(graph)->sub_graphs ? CO_P(graph)->sub_graphs->rnum : 0));
+	CO_V(sub_tasks) = (co_routine_t**)ccv_nnc_graph_buffer(CO_P(graph), sizeof(co_routine_t*) * sub_task_capacity + sizeof(int) * (sub_task_capacity + CO_P(exec_info_size) * 2));
+	CO_V(sub_task_idxs) = (int*)(CO_V(sub_tasks) + sub_task_capacity);
+	CO_V(pending_nodes)[0] = CO_V(sub_task_idxs) + sub_task_capacity;
 	CO_V(pending_nodes)[1] = CO_V(pending_nodes)[0] + CO_P(exec_info_size);
 	CO_V(pending_node_size)[0] = 0;
 	CO_V(pending_node_size)[1] = 0;
 	for (CO_V(i) = CO_P(start_index); CO_V(i) < CO_P(exec_info_size); CO_V(i)++)
-	{
-		CO_V(idx) = CO_P(psort) ? CO_P(psort)[CO_V(i)] : CO_V(i);
-		CO_V(node) = CO_P(exec_info) + CO_V(idx);
-		CO_V(schd) = CO_P(schd_info) + CO_V(idx);
-		// If stream is blocked by but not blocked by current executing task.
-		int blocked = 0, j;
-		for (j = 0; j < CO_V(schd)->stream_size; j++)
-			if (CO_P(graph)->block_stream_tasks[SCHEDULE_STREAMS(*CO_V(schd))[j]])
-			{
-				CO_V(pending_nodes)[0][CO_V(pending_node_size)[0]++] = CO_V(idx);
-				_ccv_nnc_graph_mark_outgoing_streams_blocked_by_task(CO_P(graph), CO_P(schd_info), CO_V(node), CO_P(graph)->block_stream_tasks[SCHEDULE_STREAMS(*CO_V(schd))[j]]);
-				blocked = 1;
-			}
-		if (blocked)
-			continue;
-		CO_V(task) = _ccv_nnc_graph_exec_run_task(CO_P(graph), CO_V(node), CO_V(schd), CO_V(idx), CO_P(tensor_tape), CO_P(flags));
-		if (CO_V(task))
-		{
-			co_resume(CO_V(task));
-			if (!co_is_done(CO_V(task)))
-			{
-				CO_V(sub_tasks)[CO_V(sub_task_size)++] = CO_V(task);
-				int j;
-				for (j = 0; j < CO_V(schd)->stream_size; j++)
-					CO_P(graph)->block_stream_tasks[SCHEDULE_STREAMS(*CO_V(schd))[j]] = CO_V(task);
-				_ccv_nnc_graph_mark_outgoing_streams_blocked_by_task(CO_P(graph), CO_P(schd_info), CO_V(node), CO_V(task));
-			} else
-				co_free(CO_V(task));
-		}
-	}
-	if (CO_V(sub_task_size))
-		co_apply(_ccv_nnc_graph_wait_any_sub_tasks, (CO_P(graph), CO_V(sub_tasks), CO_V(sub_task_size), CO_P(schd_info), CO_V(pending_nodes)[0], CO_V(pending_node_size)[0]));
+		CO_V(pending_nodes)[0][CO_V(pending_node_size)[0]++] = CO_P(psort) ? CO_P(psort)[CO_V(i)] : CO_V(i);
 	CO_V(p) = 0;
 	CO_V(q) = 1;
 	while (CO_V(pending_node_size)[CO_V(p)] > 0)
 	{
 		CO_V(pending_node_size)[CO_V(q)] = 0;
-		CO_V(sub_task_size) = 0;
 		for (CO_V(i) = 0; CO_V(i) < CO_V(pending_node_size)[CO_V(p)]; CO_V(i)++)
 		{
 			CO_V(idx) = CO_V(pending_nodes)[CO_V(p)][CO_V(i)];
 			CO_V(node) = CO_P(exec_info) + CO_V(idx);
 			CO_V(schd) = CO_P(schd_info) + CO_V(idx);
+			// If stream is blocked by a task that is not done yet, this node has to wait, so do the nodes depend on it.
 			int blocked = 0, j;
 			for (j = 0; j < CO_V(schd)->stream_size; j++)
 				if (CO_P(graph)->block_stream_tasks[SCHEDULE_STREAMS(*CO_V(schd))[j]])
 				{
 					_ccv_nnc_graph_mark_outgoing_streams_blocked_by_task(CO_P(graph), CO_P(schd_info), CO_V(node), CO_P(graph)->block_stream_tasks[SCHEDULE_STREAMS(*CO_V(schd))[j]]);
-					CO_V(pending_nodes)[CO_V(q)][CO_V(pending_node_size)[CO_V(q)]++] = CO_V(idx);
 					blocked = 1;
 				}
 			if (blocked)
+			{
+				CO_V(pending_nodes)[CO_V(q)][CO_V(pending_node_size)[CO_V(q)]++] = CO_V(idx);
 				continue;
-			CO_V(task) = _ccv_nnc_graph_exec_run_task(CO_P(graph), CO_V(node), CO_V(schd), CO_V(idx), CO_P(tensor_tape), CO_P(flags));
+			}
+			CO_V(task) = _ccv_nnc_graph_exec_run_task(CO_P(graph), CO_V(node), CO_V(schd), CO_V(idx), CO_P(tensor_tape), CO_V(spawn), CO_P(flags));
 			if (CO_V(task))
 			{
-				co_resume(CO_V(task));
+				if (CO_V(node)->cmd.cmd == CCV_NNC_GRAPH_FORWARD || CO_V(node)->cmd.cmd == CCV_NNC_GRAPH_BACKWARD)
+					co_resume(CO_V(task));
+				else
+					co_spawn(CO_V(task));
 				if (!co_is_done(CO_V(task)))
 				{
-					CO_V(sub_tasks)[CO_V(sub_task_size)++] = CO_V(task);
+					CO_V(sub_tasks)[CO_V(sub_task_size)] = CO_V(task);
+					CO_V(sub_task_idxs)[CO_V(sub_task_size)++] = CO_V(idx);
 					for (j = 0; j < CO_V(schd)->stream_size; j++)
 						CO_P(graph)->block_stream_tasks[SCHEDULE_STREAMS(*CO_V(schd))[j]] = CO_V(task);
 					_ccv_nnc_graph_mark_outgoing_streams_blocked_by_task(CO_P(graph), CO_P(schd_info), CO_V(node), CO_V(task));
@@ -592,9 +606,12 @@ static co_decl_task(_ccv_nnc_graph_exec_run_loop, (ccv_nnc_graph_t* const graph,
 		}
 		int t;
 		CCV_SWAP(CO_V(p), CO_V(q), t);
-		if (CO_V(sub_task_size))
-			co_apply(_ccv_nnc_graph_wait_any_sub_tasks, (CO_P(graph), CO_V(sub_tasks), CO_V(sub_task_size), CO_P(schd_info), CO_V(pending_nodes)[CO_V(p)], CO_V(pending_node_size)[CO_V(p)]));
+		if (CO_V(sub_task_size) && CO_V(pending_node_size)[CO_V(p)] > 0)
+			co_apply(_ccv_nnc_graph_wait_any_sub_tasks, (CO_P(graph), CO_P(exec_info), CO_P(schd_info), CO_V(sub_tasks), CO_V(sub_task_idxs), &CO_V(sub_task_size)));
 	}
+	// Everything is submitted, wait for the tasks still running.
+	while (CO_V(sub_task_size) > 0)
+		co_apply(_ccv_nnc_graph_wait_any_sub_tasks, (CO_P(graph), CO_P(exec_info), CO_P(schd_info), CO_V(sub_tasks), CO_V(sub_task_idxs), &CO_V(sub_task_size)));
 } co_end()
 
 co_task(_ccv_nnc_graph_topsorted_run_coro, (ccv_nnc_graph_t* const graph, const int exec_idx, const ccv_nnc_graph_static_schedule_t* const schedule, ccv_nnc_graph_exec_info_t* const exec, ccv_nnc_tensor_tape_t* const tensor_tape, ccv_nnc_stream_context_t* const stream_context, const int flags), private(
@@ -31,11 +31,15 @@ typedef struct {
 	ccv_nnc_cmd_inplace_f enforce_inplace;
 } ccv_nnc_cmd_registry_t;
 
+// The backend applies all the fused activations itself.
+#define CCV_NNC_ACTIVATION_ALL ((1 << CCV_NNC_ACTIVATION_RELU) | (1 << CCV_NNC_ACTIVATION_SIGMOID) | (1 << CCV_NNC_ACTIVATION_TANH) | (1 << CCV_NNC_ACTIVATION_SWISH))
+
 typedef struct {
 	int tensor_formats; /**< [formats] The supported formats for this API implementation. */
 	int tensor_datatypes; /**< [datatypes] The supported data types for this API implementation. */
 	int tensor_memory; /**< [memory] The supported tensor memory type for this API implementation. */
 	int algorithms; /**< [algorithms] Number of algorithms variation. */
+	int activations; /**< [activations] The fused activations (1 << CCV_NNC_ACTIVATION_*) this API implementation applies itself, the rest are applied after it. */
 	ccv_nnc_cmd_exec_f exec;
 	ccv_nnc_cmd_autotune_f autotune;
 } ccv_nnc_cmd_backend_registry_t;
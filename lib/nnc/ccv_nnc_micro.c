@@ -118,6 +118,8 @@ CCV_WARN_UNUSED(ccv_nnc_micro_combine_t*) ccv_nnc_micro_combine_new(const ccv_nn
 	}
 	ccv_nnc_micro_combine_t* const combine = (ccv_nnc_micro_combine_t*)ccmalloc(sizeof(ccv_nnc_micro_combine_t));
 	combine->parameter_size = parameter_size;
+	combine->jit.forward = 0;
+	combine->jit.backward = 0;
 	combine->forward.input_size = input_size;
 	combine->forward.inputs = (int*)ccmalloc(sizeof(int) * (input_size + output_size));
 	for (i = 0; i < input_size; i++)
@@ -134,6 +136,7 @@ CCV_WARN_UNUSED(ccv_nnc_micro_combine_t*) ccv_nnc_micro_combine_new(const ccv_nn
 	combine->forward.function_count = function_count;
 	combine->forward.functions = functions;
 	ccv_nnc_micro_program_simplify(&combine->forward, inputs, input_size, outputs, output_size, equal_assertions);
+	ccv_nnc_micro_program_schedule(&combine->forward);
 	function_count = reverse_top->rnum * 2;
 	functions = (ccv_nnc_micro_function_t*)ccmalloc(sizeof(ccv_nnc_micro_function_t) * function_count);
 	for (i = 0; i < reverse_top->rnum; i++)
@@ -159,6 +162,7 @@ CCV_WARN_UNUSED(ccv_nnc_micro_combine_t*) ccv_nnc_micro_combine_new(const ccv_nn
 	combine->backward.function_count = function_count;
 	combine->backward.functions = functions;
 	ccv_nnc_micro_program_simplify(&combine->backward, ingrads, ingrad_size, outgrads, outgrad_size, equal_assertions);
+	ccv_nnc_micro_program_schedule(&combine->backward);
 	combine->equal_assertions = equal_assertions;
 	for (i = 0; i < reverse_top->rnum; i++)
 	{
@@ -339,8 +343,3 @@ void ccv_nnc_micro_combine_free(ccv_nnc_micro_combine_t* const combine)
 	ccv_array_free(combine->equal_assertions);
 	ccfree(combine);
 }
-
-char* ccv_nnc_micro_combine_c(ccv_nnc_micro_combine_t* const combine)
-{
-	return 0;
-}
@@ -219,12 +219,10 @@ static void _ccv_nnc_micro_statement_interpret(const ccv_nnc_micro_loop_statemen
 	}
 }
 
-static void _ccv_nnc_micro_loop_interpret(const ccv_nnc_micro_loop_t* const loops, const int loop_count, const int index, int* const loop_counter, ccv_nnc_micro_scalar_t* const carrieds, const int carried_count, float* const* const vars_mem, const int* const shapes, const ccv_nnc_micro_scalar_t* const values, const int parameter_size)
+static void _ccv_nnc_micro_loop_interpret(const ccv_nnc_micro_loop_t* const loops, const int loop_count, const int index, int* const loop_counter, ccv_nnc_micro_scalar_t* const carrieds, const int carried_count, float* const* const vars_mem, const int* const shapes, const ccv_nnc_micro_scalar_t* const values, const int parameter_size);
+
+static void _ccv_nnc_micro_loop_range_interpret(const ccv_nnc_micro_loop_t* const loops, const int loop_count, const int index, const int start_index, const int end_index, int* const loop_counter, ccv_nnc_micro_scalar_t* const carrieds, const int carried_count, float* const* const vars_mem, const int* const shapes, const ccv_nnc_micro_scalar_t* const values, const int parameter_size)
 {
-	if (index >= loop_count)
-		return;
-	const int start_index = _ccv_nnc_micro_index_interpret(loops[index].start_index, loop_counter, shapes, values, parameter_size);
-	const int end_index = _ccv_nnc_micro_index_interpret(loops[index].end_index, loop_counter, shapes, values, parameter_size);
 	int i, j;
 	const ccv_nnc_micro_loop_statement_t* const statements = loops[index].statements;
 	const int statement_count = loops[index].statement_count;
@@ -268,21 +266,83 @@ static void _ccv_nnc_micro_loop_interpret(const ccv_nnc_micro_loop_t* const loop
 	}
 }
 
-void ccv_nnc_micro_combine_interpret(ccv_nnc_micro_combine_t* const combine, const uint32_t cmd, ccv_nnc_tensor_t* const* const inputs, const int input_size, const ccv_nnc_micro_scalar_t* const values, const int parameter_size, ccv_nnc_tensor_t* const* const outputs, const int output_size)
+static void _ccv_nnc_micro_loop_interpret(const ccv_nnc_micro_loop_t* const loops, const int loop_count, const int index, int* const loop_counter, ccv_nnc_micro_scalar_t* const carrieds, const int carried_count, float* const* const vars_mem, const int* const shapes, const ccv_nnc_micro_scalar_t* const values, const int parameter_size)
+{
+	if (index >= loop_count)
+		return;
+	const int start_index = _ccv_nnc_micro_index_interpret(loops[index].start_index, loop_counter, shapes, values, parameter_size);
+	const int end_index = _ccv_nnc_micro_index_interpret(loops[index].end_index, loop_counter, shapes, values, parameter_size);
+	_ccv_nnc_micro_loop_range_interpret(loops, loop_count, index, start_index, end_index, loop_counter, carrieds, carried_count, vars_mem, shapes, values, parameter_size);
+}
+
+typedef struct {
+	const ccv_nnc_micro_loop_block_t* block;
+	float* const* vars_mem;
+	const int* shapes;
+	const ccv_nnc_micro_scalar_t* values;
+	int parameter_size;
+	int start;
+	int end;
+	int chunk;
+} ccv_nnc_micro_block_parallel_t;
+
+static void _ccv_nnc_micro_block_parallel_interpret(void* const context, const int idx)
+{
+	const ccv_nnc_micro_block_parallel_t* const parallel = (ccv_nnc_micro_block_parallel_t*)context;
+	const ccv_nnc_micro_loop_block_t* const block = parallel->block;
+	const int start = parallel->start + idx * parallel->chunk;
+	const int end = ccv_min(start + parallel->chunk, parallel->end);
+	// Each task has its own loop counters and loop-carried variables.
+	int loop_counter[CCV_NNC_MAX_DIM_ALLOC];
+	ccv_nnc_micro_scalar_t carrieds[ccv_max(1, block->carried_count)];
+	_ccv_nnc_micro_loop_range_interpret(block->loops, block->loop_count, 0, start, end, loop_counter, carrieds, block->carried_count, parallel->vars_mem, parallel->shapes, parallel->values, parallel->parameter_size);
+}
+
+static void _ccv_nnc_micro_block_interpret(const ccv_nnc_micro_loop_block_t* const block, int* const loop_counter, ccv_nnc_micro_scalar_t* const carrieds, float* const* const vars_mem, const int* const shapes, const ccv_nnc_micro_scalar_t* const values, const int parameter_size)
+{
+	const ccv_nnc_micro_loop_t* const loops = block->loops;
+	if (block->loop_count == 0 || !loops[0].parallel)
+	{
+		_ccv_nnc_micro_loop_interpret(loops, block->loop_count, 0, loop_counter, carrieds, block->carried_count, vars_mem, shapes, values, parameter_size);
+		return;
+	}
+	ccv_nnc_micro_block_parallel_t parallel = {
+		.block = block,
+		.vars_mem = vars_mem,
+		.shapes = shapes,
+		.values = values,
+		.parameter_size = parameter_size,
+		.start = _ccv_nnc_micro_index_interpret(loops[0].start_index, loop_counter, shapes, values, parameter_size),
+		.end = _ccv_nnc_micro_index_interpret(loops[0].end_index, loop_counter, shapes, values, parameter_size),
+	};
+	const int count = parallel.end - parallel.start;
+	if (count <= 0)
+		return;
+	// Estimate the iterations of the innermost loop, loops whose bounds depend on other loops count as one.
+	int64_t work = count;
+	int i;
+	for (i = 1; i < block->loop_count; i++)
+		if (!ccv_nnc_micro_loop_index_has_loop_id(loops[i].start_index, -1) && !ccv_nnc_micro_loop_index_has_loop_id(loops[i].end_index, -1))
+			work *= ccv_max(0, _ccv_nnc_micro_index_interpret(loops[i].end_index, loop_counter, shapes, values, parameter_size) - _ccv_nnc_micro_index_interpret(loops[i].start_index, loop_counter, shapes, values, parameter_size));
+	parallel.chunk = work > CCV_NNC_MICRO_PARALLEL_GRAIN ? (int)ccv_max(1, (CCV_NNC_MICRO_PARALLEL_GRAIN * (int64_t)count + work - 1) / work) : count;
+	const int task_count = (count + parallel.chunk - 1) / parallel.chunk;
+	if (task_count > 1)
+		ccv_nnc_parallel_for(task_count, 1, _ccv_nnc_micro_block_parallel_interpret, &parallel);
+	else
+		_ccv_nnc_micro_loop_range_interpret(loops, block->loop_count, 0, parallel.start, parallel.end, loop_counter, carrieds, block->carried_count, vars_mem, shapes, values, parameter_size);
+}
+
+float** ccv_nnc_micro_program_vars_new(const ccv_nnc_micro_combine_t* const combine, const ccv_nnc_micro_program_t* const program, ccv_nnc_tensor_t* const* const inputs, const int input_size, const ccv_nnc_micro_scalar_t* const values, const int parameter_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, int* const shapes)
 {
-	// We haven't optimized for emit_grad at the moment yet.
-	assert(cmd == CCV_NNC_CUSTOM_FORWARD || cmd == CCV_NNC_CUSTOM_BACKWARD);
 	int i, j;
-	const ccv_nnc_micro_program_t* const program = cmd == CCV_NNC_CUSTOM_FORWARD ? &combine->forward : &combine->backward;
 	const int var_count = program->var_count;
 	assert(input_size == program->input_size);
 	assert(output_size == program->output_size);
 	assert(parameter_size == combine->parameter_size);
-	int* const shapes = (int*)cccalloc(var_count, sizeof(int) * CCV_NNC_MAX_DIM_ALLOC);
+	memset(shapes, 0, sizeof(int) * CCV_NNC_MAX_DIM_ALLOC * var_count);
 	ccv_nnc_micro_tensor_t* const vars = program->vars;
 	for (i = 0; i < input_size; i++)
 		memcpy(shapes + program->inputs[i] * CCV_NNC_MAX_DIM_ALLOC, &inputs[i]->info.dim, sizeof(int) * CCV_NNC_MAX_DIM_ALLOC);
-	int loop_counter[CCV_NNC_MAX_DIM_ALLOC];
 	for (i = 0; i < var_count; i++)
 	{
 		int flag = 0;
@@ -293,7 +353,7 @@ void ccv_nnc_micro_combine_interpret(ccv_nnc_micro_combine_t* const combine, con
 		if (vars[i].shape)
 		{
 			for (j = 0; j < vars[i].dimensions; j++)
-				shapes[i * CCV_NNC_MAX_DIM_ALLOC + j] = _ccv_nnc_micro_index_interpret(vars[i].shape[j], loop_counter, shapes, values, parameter_size);
+				shapes[i * CCV_NNC_MAX_DIM_ALLOC + j] = _ccv_nnc_micro_index_interpret(vars[i].shape[j], 0 /* Shapes don't depend on loops. */, shapes, values, parameter_size);
 		} else
 			memcpy(shapes + i * CCV_NNC_MAX_DIM_ALLOC, shapes + vars[i].input * CCV_NNC_MAX_DIM_ALLOC, sizeof(int) * CCV_NNC_MAX_DIM_ALLOC);
 	}
@@ -355,6 +415,18 @@ void ccv_nnc_micro_combine_interpret(ccv_nnc_micro_combine_t* const combine, con
 		assert(!CCV_IS_TENSOR_VIEW(inputs[i]));
 		vars_mem[program->inputs[i]] = inputs[i]->data.f32;
 	}
+	return vars_mem;
+}
+
+void ccv_nnc_micro_combine_interpret(ccv_nnc_micro_combine_t* const combine, const uint32_t cmd, ccv_nnc_tensor_t* const* const inputs, const int input_size, const ccv_nnc_micro_scalar_t* const values, const int parameter_size, ccv_nnc_tensor_t* const* const outputs, const int output_size)
+{
+	// We haven't optimized for emit_grad at the moment yet.
+	assert(cmd == CCV_NNC_CUSTOM_FORWARD || cmd == CCV_NNC_CUSTOM_BACKWARD);
+	int i, j;
+	const ccv_nnc_micro_program_t* const program = cmd == CCV_NNC_CUSTOM_FORWARD ? &combine->forward : &combine->backward;
+	int* const shapes = (int*)ccmalloc(sizeof(int) * CCV_NNC_MAX_DIM_ALLOC * program->var_count);
+	float** const vars_mem = ccv_nnc_micro_program_vars_new(combine, program, inputs, input_size, values, parameter_size, outputs, output_size, shapes);
+	int loop_counter[CCV_NNC_MAX_DIM_ALLOC];
 	ccv_nnc_micro_function_t* const functions = program->functions;
 	const int function_count = program->function_count;
 	int max_carried_count = 0;
@@ -371,7 +443,7 @@ void ccv_nnc_micro_combine_interpret(ccv_nnc_micro_combine_t* const combine, con
 		const int block_count = functions[i].block_count;
 		ccv_nnc_micro_loop_block_t* const blocks = block_count == 1 ? &functions[i].one_block : functions[i].blocks;
 		for (j = 0; j < block_count; j++)
-			_ccv_nnc_micro_loop_interpret(blocks[j].loops, blocks[j].loop_count, 0, loop_counter, carrieds, blocks[j].carried_count, vars_mem, shapes, values, parameter_size);
+			_ccv_nnc_micro_block_interpret(blocks + j, loop_counter, carrieds, vars_mem, shapes, values, parameter_size);
 	}
 	if (carrieds)
 		ccfree(carrieds);
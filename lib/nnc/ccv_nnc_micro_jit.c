@@ -0,0 +1,760 @@
+#include "ccv_nnc.h"
+#include "ccv_nnc_easy.h"
+#include "ccv_nnc_internal.h"
+#include "ccv_internal.h"
+#include "_ccv_nnc_micro.h"
+#include "3rdparty/khash/khash.h"
+#include "3rdparty/siphash/siphash24.h"
+#include <stdarg.h>
+#ifdef HAVE_DLFCN
+#include <dlfcn.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#endif
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+// MARK - C Code Generation
+
+typedef struct {
+	size_t len;
+	size_t size;
+	char* buf;
+} ccv_nnc_micro_source_t;
+
+static void _ccv_nnc_micro_source_printf(ccv_nnc_micro_source_t* const source, const char* const format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	const int len = vsnprintf(source->buf + source->len, source->size - source->len, format, args);
+	va_end(args);
+	assert(len >= 0);
+	if (source->len + len + 1 > source->size)
+	{
+		source->size = ccv_max(source->size * 2, source->len + len + 1);
+		source->buf = (char*)ccrealloc(source->buf, source->size);
+		va_start(args, format);
+		vsnprintf(source->buf + source->len, source->size - source->len, format, args);
+		va_end(args);
+	}
+	source->len += len;
+}
+
+static void _ccv_nnc_micro_source_indent(ccv_nnc_micro_source_t* const source, const int level)
+{
+	int i;
+	for (i = 0; i < level; i++)
+		_ccv_nnc_micro_source_printf(source, "\t");
+}
+
+static void _ccv_nnc_micro_index_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_loop_index_term_t index)
+{
+	switch (index.type)
+	{
+		case CCV_NNC_MICRO_LOOP_INDEX_TYPE_VAL:
+			_ccv_nnc_micro_source_printf(source, "%d", index.immediate_value);
+			return;
+		case CCV_NNC_MICRO_LOOP_INDEX_TYPE_ID:
+			switch (index.id.type)
+			{
+				case CCV_NNC_MICRO_AXIS_SIZE_ID:
+					_ccv_nnc_micro_source_printf(source, "shapes[%d]", index.id.id * CCV_NNC_MAX_DIM_ALLOC + index.id.d);
+					return;
+				case CCV_NNC_MICRO_LOOP_ID:
+					_ccv_nnc_micro_source_printf(source, "i%d", index.id.id);
+					return;
+				case CCV_NNC_MICRO_SCALAR_ID:
+					_ccv_nnc_micro_source_printf(source, "values[%d]", index.id.id);
+					return;
+			}
+			break;
+		case CCV_NNC_MICRO_LOOP_INDEX_TYPE_BINARY:
+			switch (index.binary->op)
+			{
+				case CCV_NNC_MICRO_BINARY_OP_MAX:
+				case CCV_NNC_MICRO_BINARY_OP_MIN:
+					_ccv_nnc_micro_source_printf(source, index.binary->op == CCV_NNC_MICRO_BINARY_OP_MAX ? "ccv_max(" : "ccv_min(");
+					_ccv_nnc_micro_index_c(source, index.binary->left);
+					_ccv_nnc_micro_source_printf(source, ", ");
+					_ccv_nnc_micro_index_c(source, index.binary->right);
+					_ccv_nnc_micro_source_printf(source, ")");
+					return;
+				case CCV_NNC_MICRO_BINARY_OP_PLUS:
+				case CCV_NNC_MICRO_BINARY_OP_MINUS:
+				case CCV_NNC_MICRO_BINARY_OP_MUL:
+				case CCV_NNC_MICRO_BINARY_OP_DIV: {
+					static const char* const ops[] = { " + ", " - ", " * ", " / " };
+					_ccv_nnc_micro_source_printf(source, "(");
+					_ccv_nnc_micro_index_c(source, index.binary->left);
+					_ccv_nnc_micro_source_printf(source, "%s", ops[index.binary->op - CCV_NNC_MICRO_BINARY_OP_PLUS]);
+					_ccv_nnc_micro_index_c(source, index.binary->right);
+					_ccv_nnc_micro_source_printf(source, ")");
+					return;
+				}
+			}
+			break;
+	}
+	// Matches the interpreter, anything it cannot evaluate is 0.
+	_ccv_nnc_micro_source_printf(source, "0");
+}
+
+static void _ccv_nnc_micro_variable_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_loop_variable_t* const variable)
+{
+	assert(variable->id.type == CCV_NNC_MICRO_TENSOR_ID);
+	const int id = variable->id.id;
+	_ccv_nnc_micro_source_printf(source, "v%d[", id);
+	if (variable->index_count == 0)
+	{
+		_ccv_nnc_micro_source_printf(source, "0]");
+		return;
+	}
+	// Row-major offset, in Horner's form.
+	int i;
+	for (i = 1; i < variable->index_count; i++)
+		_ccv_nnc_micro_source_printf(source, "(");
+	_ccv_nnc_micro_index_c(source, variable->index[0]);
+	for (i = 1; i < variable->index_count; i++)
+	{
+		_ccv_nnc_micro_source_printf(source, ") * shapes[%d] + ", id * CCV_NNC_MAX_DIM_ALLOC + i);
+		_ccv_nnc_micro_index_c(source, variable->index[i]);
+	}
+	_ccv_nnc_micro_source_printf(source, "]");
+}
+
+static int _ccv_nnc_micro_variable_bound_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_loop_variable_t* const variable, int bound_count)
+{
+	int i;
+	for (i = 0; i < variable->index_count; i++)
+		if (!variable->no_check_bound[i])
+		{
+			_ccv_nnc_micro_source_printf(source, bound_count > 0 ? " && " : "");
+			_ccv_nnc_micro_index_c(source, variable->index[i]);
+			_ccv_nnc_micro_source_printf(source, " >= 0 && ");
+			_ccv_nnc_micro_index_c(source, variable->index[i]);
+			_ccv_nnc_micro_source_printf(source, " < shapes[%d]", variable->id.id * CCV_NNC_MAX_DIM_ALLOC + i);
+			++bound_count;
+		}
+	return bound_count;
+}
+
+static int _ccv_nnc_micro_expression_bound_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_loop_expression_t* const expression, int bound_count)
+{
+	switch (expression->type)
+	{
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_VAR:
+			return _ccv_nnc_micro_variable_bound_c(source, &expression->variable, bound_count);
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_UNARY:
+			return _ccv_nnc_micro_expression_bound_c(source, expression->unary.x, bound_count);
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_BINARY:
+			bound_count = _ccv_nnc_micro_expression_bound_c(source, expression->binary.left, bound_count);
+			return _ccv_nnc_micro_expression_bound_c(source, expression->binary.right, bound_count);
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_TERNAY:
+			bound_count = _ccv_nnc_micro_expression_bound_c(source, expression->ternary.pivot, bound_count);
+			bound_count = _ccv_nnc_micro_expression_bound_c(source, expression->ternary.left, bound_count);
+			return _ccv_nnc_micro_expression_bound_c(source, expression->ternary.right, bound_count);
+	}
+	return bound_count;
+}
+
+static void _ccv_nnc_micro_expression_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_loop_expression_t* const expression)
+{
+	switch (expression->type)
+	{
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_ID:
+			assert(expression->id.type == CCV_NNC_MICRO_LOOP_CARRIED_ID);
+			_ccv_nnc_micro_source_printf(source, "c%d", expression->id.id);
+			return;
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_VAL: {
+			const float value = expression->immediate_value.f32;
+			if (isnan(value))
+				_ccv_nnc_micro_source_printf(source, "NAN");
+			else if (isinf(value))
+				_ccv_nnc_micro_source_printf(source, value > 0 ? "INFINITY" : "(-INFINITY)");
+			else // 9 significant digits are enough for a float to round-trip.
+				_ccv_nnc_micro_source_printf(source, "((float)%.9g)", value);
+			return;
+		}
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_VAR:
+			_ccv_nnc_micro_variable_c(source, &expression->variable);
+			return;
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_UNARY:
+			switch (expression->unary.unary_op)
+			{
+				case CCV_NNC_MICRO_UNARY_OP_NEG:
+					_ccv_nnc_micro_source_printf(source, "(-");
+					break;
+				case CCV_NNC_MICRO_UNARY_OP_LOG:
+					_ccv_nnc_micro_source_printf(source, "logf(");
+					break;
+				case CCV_NNC_MICRO_UNARY_OP_EXP:
+					_ccv_nnc_micro_source_printf(source, "expf(");
+					break;
+				default:
+					assert(0 && "unknown unary op");
+			}
+			_ccv_nnc_micro_expression_c(source, expression->unary.x);
+			_ccv_nnc_micro_source_printf(source, ")");
+			return;
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_BINARY:
+			switch (expression->binary.binary_op)
+			{
+				case CCV_NNC_MICRO_BINARY_OP_MAX:
+				case CCV_NNC_MICRO_BINARY_OP_MIN:
+					_ccv_nnc_micro_source_printf(source, expression->binary.binary_op == CCV_NNC_MICRO_BINARY_OP_MAX ? "ccv_max(" : "ccv_min(");
+					_ccv_nnc_micro_expression_c(source, expression->binary.left);
+					_ccv_nnc_micro_source_printf(source, ", ");
+					_ccv_nnc_micro_expression_c(source, expression->binary.right);
+					_ccv_nnc_micro_source_printf(source, ")");
+					return;
+				default: {
+					static const char* const ops[] = { " + ", " - ", " * ", " / ", 0, 0, " == ", " < " };
+					assert(expression->binary.binary_op >= 0 && expression->binary.binary_op < sizeof(ops) / sizeof(ops[0]));
+					const int is_compare = (expression->binary.binary_op == CCV_NNC_MICRO_BINARY_OP_EQUAL_TO || expression->binary.binary_op == CCV_NNC_MICRO_BINARY_OP_LESS_THAN);
+					_ccv_nnc_micro_source_printf(source, is_compare ? "(float)(" : "(");
+					_ccv_nnc_micro_expression_c(source, expression->binary.left);
+					_ccv_nnc_micro_source_printf(source, "%s", ops[expression->binary.binary_op]);
+					_ccv_nnc_micro_expression_c(source, expression->binary.right);
+					_ccv_nnc_micro_source_printf(source, ")");
+					return;
+				}
+			}
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_TERNAY:
+			// If the pivot is 0, choose left, otherwise choose right.
+			_ccv_nnc_micro_source_printf(source, "(");
+			_ccv_nnc_micro_expression_c(source, expression->ternary.pivot);
+			_ccv_nnc_micro_source_printf(source, " ? ");
+			_ccv_nnc_micro_expression_c(source, expression->ternary.right);
+			_ccv_nnc_micro_source_printf(source, " : ");
+			_ccv_nnc_micro_expression_c(source, expression->ternary.left);
+			_ccv_nnc_micro_source_printf(source, ")");
+			return;
+	}
+	_ccv_nnc_micro_source_printf(source, "0");
+}
+
+static void _ccv_nnc_micro_statement_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_loop_statement_t* const statement, const int level)
+{
+	// Out of bound reads or writes skip the statement, the same as the interpreter.
+	_ccv_nnc_micro_source_indent(source, level);
+	const size_t if_len = source->len;
+	_ccv_nnc_micro_source_printf(source, "if (");
+	int bound_count = 0;
+	switch (statement->type)
+	{
+		case CCV_NNC_MICRO_LOOP_STATEMENT_TYPE_ASSIGNMENT:
+			bound_count = _ccv_nnc_micro_variable_bound_c(source, &statement->assignment.lvalue, bound_count);
+			bound_count = _ccv_nnc_micro_expression_bound_c(source, &statement->assignment.rvalue, bound_count);
+			break;
+		case CCV_NNC_MICRO_LOOP_STATEMENT_TYPE_COMPOUND_ASSIGNMENT:
+			if (statement->compound_assignment.lvalue.type == CCV_NNC_MICRO_LOOP_EXPR_TYPE_VAR)
+				bound_count = _ccv_nnc_micro_variable_bound_c(source, &statement->compound_assignment.lvalue.variable, bound_count);
+			bound_count = _ccv_nnc_micro_expression_bound_c(source, &statement->compound_assignment.rvalue, bound_count);
+			break;
+	}
+	if (bound_count > 0)
+	{
+		_ccv_nnc_micro_source_printf(source, ")\n");
+		_ccv_nnc_micro_source_indent(source, level + 1);
+	} else { // Nothing to check, take back the if.
+		source->len = if_len;
+		source->buf[if_len] = 0;
+	}
+	switch (statement->type)
+	{
+		case CCV_NNC_MICRO_LOOP_STATEMENT_TYPE_ASSIGNMENT:
+			_ccv_nnc_micro_variable_c(source, &statement->assignment.lvalue);
+			_ccv_nnc_micro_source_printf(source, " = ");
+			_ccv_nnc_micro_expression_c(source, &statement->assignment.rvalue);
+			break;
+		case CCV_NNC_MICRO_LOOP_STATEMENT_TYPE_COMPOUND_ASSIGNMENT:
+			if (statement->compound_assignment.lvalue.type == CCV_NNC_MICRO_LOOP_EXPR_TYPE_VAR)
+			{
+				_ccv_nnc_micro_variable_c(source, &statement->compound_assignment.lvalue.variable);
+				_ccv_nnc_micro_source_printf(source, " += ");
+				_ccv_nnc_micro_expression_c(source, &statement->compound_assignment.rvalue);
+				break;
+			}
+			assert(statement->compound_assignment.lvalue.id.type == CCV_NNC_MICRO_LOOP_CARRIED_ID);
+			const int id = statement->compound_assignment.lvalue.id.id;
+			switch (statement->compound_assignment.lvalue.id.d)
+			{
+				case CCV_NNC_MICRO_REDUCE_OP_MAX:
+				case CCV_NNC_MICRO_REDUCE_OP_MIN:
+					_ccv_nnc_micro_source_printf(source, "c%d = %s(c%d, ", id, statement->compound_assignment.lvalue.id.d == CCV_NNC_MICRO_REDUCE_OP_MAX ? "ccv_max" : "ccv_min", id);
+					_ccv_nnc_micro_expression_c(source, &statement->compound_assignment.rvalue);
+					_ccv_nnc_micro_source_printf(source, ")");
+					break;
+				case CCV_NNC_MICRO_REDUCE_OP_MEAN:
+				case CCV_NNC_MICRO_REDUCE_OP_SUM:
+					_ccv_nnc_micro_source_printf(source, "c%d += ", id);
+					_ccv_nnc_micro_expression_c(source, &statement->compound_assignment.rvalue);
+					break;
+				case CCV_NNC_MICRO_REDUCE_OP_PROD:
+					_ccv_nnc_micro_source_printf(source, "c%d *= ", id);
+					_ccv_nnc_micro_expression_c(source, &statement->compound_assignment.rvalue);
+					break;
+				default: // Neither does the interpreter support argmax / argmin yet.
+					assert(0 && "argmax / argmin is not supported");
+			}
+			break;
+	}
+	_ccv_nnc_micro_source_printf(source, ";\n");
+}
+
+static void _ccv_nnc_micro_loop_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_loop_t* const loops, const int loop_count, const int index, const int level, const int ranged);
+
+// The first loop of a parallel task iterates from start to end of the task instead.
+static void _ccv_nnc_micro_loop_bound_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_loop_t* const loops, const int index, const int ranged, const int end)
+{
+	if (index == 0 && ranged)
+		_ccv_nnc_micro_source_printf(source, end ? "end" : "start");
+	else
+		_ccv_nnc_micro_index_c(source, end ? loops[index].end_index : loops[index].start_index);
+}
+
+static void _ccv_nnc_micro_simd_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_loop_t* const loop, const int level)
+{
+	_ccv_nnc_micro_source_indent(source, level);
+	_ccv_nnc_micro_source_printf(source, "#pragma omp simd");
+	int i, j;
+	for (i = 0; i < loop->statement_count; i++)
+	{
+		const ccv_nnc_micro_loop_statement_t* const statement = loop->statements + i;
+		if (statement->type != CCV_NNC_MICRO_LOOP_STATEMENT_TYPE_COMPOUND_ASSIGNMENT || statement->compound_assignment.lvalue.type == CCV_NNC_MICRO_LOOP_EXPR_TYPE_VAR)
+			continue;
+		const ccv_nnc_micro_id_t carried = statement->compound_assignment.lvalue.id;
+		int flag = 0;
+		for (j = 0; !flag && j < i; j++)
+			flag = (loop->statements[j].type == CCV_NNC_MICRO_LOOP_STATEMENT_TYPE_COMPOUND_ASSIGNMENT && loop->statements[j].compound_assignment.lvalue.type != CCV_NNC_MICRO_LOOP_EXPR_TYPE_VAR && loop->statements[j].compound_assignment.lvalue.id.id == carried.id);
+		if (flag) // Already in the reduction clauses.
+			continue;
+		switch (carried.d)
+		{
+			case CCV_NNC_MICRO_REDUCE_OP_MAX:
+				_ccv_nnc_micro_source_printf(source, " reduction(max:c%d)", carried.id);
+				break;
+			case CCV_NNC_MICRO_REDUCE_OP_MIN:
+				_ccv_nnc_micro_source_printf(source, " reduction(min:c%d)", carried.id);
+				break;
+			case CCV_NNC_MICRO_REDUCE_OP_PROD:
+				_ccv_nnc_micro_source_printf(source, " reduction(*:c%d)", carried.id);
+				break;
+			default:
+				_ccv_nnc_micro_source_printf(source, " reduction(+:c%d)", carried.id);
+				break;
+		}
+	}
+	_ccv_nnc_micro_source_printf(source, "\n");
+}
+
+static void _ccv_nnc_micro_point_loop_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_loop_t* const loops, const int loop_count, const int index, const int level, const int ranged)
+{
+	const ccv_nnc_micro_loop_t* const loop = loops + index;
+	const int id = loop->id.id;
+	assert(id < CCV_NNC_MAX_DIM_ALLOC);
+	if (loop->vectorize)
+		_ccv_nnc_micro_simd_c(source, loop, level);
+	_ccv_nnc_micro_source_indent(source, level);
+	if (loop->tile_size > 0)
+	{
+		_ccv_nnc_micro_source_printf(source, "for (i%d = t%d; i%d < ccv_min(t%d + %d, ", id, id, id, id, loop->tile_size);
+		_ccv_nnc_micro_loop_bound_c(source, loops, index, ranged, 1);
+		_ccv_nnc_micro_source_printf(source, "); i%d++)\n", id);
+	} else {
+		_ccv_nnc_micro_source_printf(source, "for (i%d = ", id);
+		_ccv_nnc_micro_loop_bound_c(source, loops, index, ranged, 0);
+		_ccv_nnc_micro_source_printf(source, "; i%d < ", id);
+		_ccv_nnc_micro_loop_bound_c(source, loops, index, ranged, 1);
+		_ccv_nnc_micro_source_printf(source, "; i%d++)\n", id);
+	}
+	_ccv_nnc_micro_source_indent(source, level);
+	_ccv_nnc_micro_source_printf(source, "{\n");
+	int i;
+	for (i = 0; i < loop->carried_count; i++)
+	{
+		assert(loop->carrieds[i].id.type == CCV_NNC_MICRO_LOOP_CARRIED_ID);
+		_ccv_nnc_micro_source_indent(source, level + 1);
+		switch (loop->carrieds[i].id.d)
+		{
+			case CCV_NNC_MICRO_REDUCE_OP_MAX:
+				_ccv_nnc_micro_source_printf(source, "c%d = -FLT_MAX;\n", loop->carrieds[i].id.id);
+				break;
+			case CCV_NNC_MICRO_REDUCE_OP_MIN:
+				_ccv_nnc_micro_source_printf(source, "c%d = FLT_MAX;\n", loop->carrieds[i].id.id);
+				break;
+			case CCV_NNC_MICRO_REDUCE_OP_PROD:
+				_ccv_nnc_micro_source_printf(source, "c%d = 1;\n", loop->carrieds[i].id.id);
+				break;
+			default:
+				_ccv_nnc_micro_source_printf(source, "c%d = 0;\n", loop->carrieds[i].id.id);
+				break;
+		}
+	}
+	_ccv_nnc_micro_loop_c(source, loops, loop_count, index + 1, level + 1, ranged);
+	for (i = 0; i < loop->statement_count; i++)
+		_ccv_nnc_micro_statement_c(source, loop->statements + i, level + 1);
+	_ccv_nnc_micro_source_indent(source, level);
+	_ccv_nnc_micro_source_printf(source, "}\n");
+}
+
+static void _ccv_nnc_micro_loop_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_loop_t* const loops, const int loop_count, const int index, const int level, const int ranged)
+{
+	if (index >= loop_count)
+		return;
+	if (loops[index].tile_size == 0 || (index > 0 && loops[index - 1].tile_size > 0))
+	{
+		_ccv_nnc_micro_point_loop_c(source, loops, loop_count, index, level, ranged);
+		return;
+	}
+	// Iterate tiles of the consecutive tiled loops first, then the loops within a tile.
+	int i, tile_count;
+	for (tile_count = 0; index + tile_count < loop_count && loops[index + tile_count].tile_size > 0; tile_count++)
+		{ /* Count tiled loops. */ }
+	for (i = 0; i < tile_count; i++)
+	{
+		const int id = loops[index + i].id.id;
+		_ccv_nnc_micro_source_indent(source, level + i);
+		_ccv_nnc_micro_source_printf(source, "for (t%d = ", id);
+		_ccv_nnc_micro_loop_bound_c(source, loops, index + i, ranged, 0);
+		_ccv_nnc_micro_source_printf(source, "; t%d < ", id);
+		_ccv_nnc_micro_loop_bound_c(source, loops, index + i, ranged, 1);
+		_ccv_nnc_micro_source_printf(source, "; t%d += %d)\n", id, loops[index + i].tile_size);
+		_ccv_nnc_micro_source_indent(source, level + i);
+		_ccv_nnc_micro_source_printf(source, "{\n");
+	}
+	_ccv_nnc_micro_point_loop_c(source, loops, loop_count, index, level + tile_count, ranged);
+	for (i = tile_count - 1; i >= 0; i--)
+	{
+		_ccv_nnc_micro_source_indent(source, level + i);
+		_ccv_nnc_micro_source_printf(source, "}\n");
+	}
+}
+
+static void _ccv_nnc_micro_locals_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_program_t* const program)
+{
+	int i;
+	_ccv_nnc_micro_source_printf(source, "\tint i0");
+	for (i = 1; i < CCV_NNC_MAX_DIM_ALLOC; i++)
+		_ccv_nnc_micro_source_printf(source, ", i%d", i);
+	_ccv_nnc_micro_source_printf(source, ";\n");
+	for (i = 0; i < program->var_count; i++)
+		_ccv_nnc_micro_source_printf(source, "\tfloat* const v%d = vars[%d];\n", i, i);
+}
+
+static void _ccv_nnc_micro_block_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_loop_block_t* const block, const int ranged)
+{
+	int i;
+	_ccv_nnc_micro_source_printf(source, "\t{\n");
+	if (block->carried_count > 0)
+	{
+		_ccv_nnc_micro_source_printf(source, "\t\tfloat c0");
+		for (i = 1; i < block->carried_count; i++)
+			_ccv_nnc_micro_source_printf(source, ", c%d", i);
+		_ccv_nnc_micro_source_printf(source, ";\n");
+	}
+	for (i = 0; i < block->loop_count; i++)
+		if (block->loops[i].tile_size > 0)
+			_ccv_nnc_micro_source_printf(source, "\t\tint t%d;\n", block->loops[i].id.id);
+	_ccv_nnc_micro_loop_c(source, block->loops, block->loop_count, 0, 2, ranged);
+	_ccv_nnc_micro_source_printf(source, "\t}\n");
+}
+
+// A parallel block runs as tasks of consecutive iterations of its first loop.
+static void _ccv_nnc_micro_block_parallel_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_loop_block_t* const block, const char* const task)
+{
+	const ccv_nnc_micro_loop_t* const loops = block->loops;
+	_ccv_nnc_micro_source_printf(source, "\t{\n\t\tccv_nnc_micro_parallel_t parallel = {\n\t\t\t.vars = vars,\n\t\t\t.shapes = shapes,\n\t\t\t.values = values,\n\t\t\t.start = ");
+	_ccv_nnc_micro_index_c(source, loops[0].start_index);
+	_ccv_nnc_micro_source_printf(source, ",\n\t\t\t.end = ");
+	_ccv_nnc_micro_index_c(source, loops[0].end_index);
+	_ccv_nnc_micro_source_printf(source, ",\n\t\t};\n\t\tconst int count = parallel.end - parallel.start;\n\t\tconst long long work = (long long)count");
+	// Loops whose bounds depend on other loops count as one.
+	int i;
+	for (i = 1; i < block->loop_count; i++)
+		if (!ccv_nnc_micro_loop_index_has_loop_id(loops[i].start_index, -1) && !ccv_nnc_micro_loop_index_has_loop_id(loops[i].end_index, -1))
+		{
+			_ccv_nnc_micro_source_printf(source, " * ccv_max(0, ");
+			_ccv_nnc_micro_index_c(source, loops[i].end_index);
+			_ccv_nnc_micro_source_printf(source, " - ");
+			_ccv_nnc_micro_index_c(source, loops[i].start_index);
+			_ccv_nnc_micro_source_printf(source, ")");
+		}
+	_ccv_nnc_micro_source_printf(source, ";\n\t\tparallel.chunk = work > %d ? (int)ccv_max(1, (%dLL * count + work - 1) / work) : count;\n", CCV_NNC_MICRO_PARALLEL_GRAIN, CCV_NNC_MICRO_PARALLEL_GRAIN);
+	if (loops[0].tile_size > 0) // Tasks start at tile boundaries.
+		_ccv_nnc_micro_source_printf(source, "\t\tparallel.chunk = (parallel.chunk + %d) / %d * %d;\n", loops[0].tile_size - 1, loops[0].tile_size, loops[0].tile_size);
+	_ccv_nnc_micro_source_printf(source, "\t\tconst int task_count = count > 0 ? (count + parallel.chunk - 1) / parallel.chunk : 0;\n");
+	_ccv_nnc_micro_source_printf(source, "\t\tif (task_count > 1)\n\t\t\tparallel_for(task_count, 1, %s, &parallel);\n\t\telse if (task_count == 1)\n\t\t\t%s(&parallel, 0);\n\t}\n", task, task);
+}
+
+static void _ccv_nnc_micro_program_c(ccv_nnc_micro_source_t* const source, const ccv_nnc_micro_program_t* const program, const char* const name)
+{
+	int i, j;
+	char task[64];
+	const ccv_nnc_micro_function_t* const functions = program->functions;
+	// Tasks of parallel blocks go first.
+	for (i = 0; i < program->function_count; i++)
+	{
+		const int block_count = functions[i].block_count;
+		const ccv_nnc_micro_loop_block_t* const blocks = block_count == 1 ? &functions[i].one_block : functions[i].blocks;
+		for (j = 0; j < block_count; j++)
+			if (blocks[j].loop_count > 0 && blocks[j].loops[0].parallel)
+			{
+				_ccv_nnc_micro_source_printf(source, "\nstatic void ccv_nnc_micro_combine_%s_%d_%d(void* const context, const int idx)\n{\n", name, i, j);
+				_ccv_nnc_micro_source_printf(source, "\tconst ccv_nnc_micro_parallel_t* const parallel = (const ccv_nnc_micro_parallel_t*)context;\n");
+				_ccv_nnc_micro_source_printf(source, "\tfloat* const* const vars = parallel->vars;\n\tconst int* const shapes = parallel->shapes;\n\tconst int* const values = parallel->values;\n");
+				_ccv_nnc_micro_source_printf(source, "\tconst int start = parallel->start + idx * parallel->chunk;\n\tconst int end = ccv_min(start + parallel->chunk, parallel->end);\n");
+				_ccv_nnc_micro_locals_c(source, program);
+				_ccv_nnc_micro_block_c(source, blocks + j, 1);
+				_ccv_nnc_micro_source_printf(source, "}\n");
+			}
+	}
+	_ccv_nnc_micro_source_printf(source, "\nvoid ccv_nnc_micro_combine_%s(float* const* const vars, const int* const shapes, const int* const values, void(* const parallel_for)(const int n, const int grain_size, const ccv_nnc_parallel_for_f fn, void* const context))\n{\n", name);
+	_ccv_nnc_micro_locals_c(source, program);
+	for (i = 0; i < program->function_count; i++)
+	{
+		const int block_count = functions[i].block_count;
+		const ccv_nnc_micro_loop_block_t* const blocks = block_count == 1 ? &functions[i].one_block : functions[i].blocks;
+		for (j = 0; j < block_count; j++)
+			if (blocks[j].loop_count > 0 && blocks[j].loops[0].parallel)
+			{
+				snprintf(task, sizeof(task), "ccv_nnc_micro_combine_%s_%d_%d", name, i, j);
+				_ccv_nnc_micro_block_parallel_c(source, blocks + j, task);
+			} else
+				_ccv_nnc_micro_block_c(source, blocks + j, 0);
+	}
+	_ccv_nnc_micro_source_printf(source, "}\n");
+}
+
+char* ccv_nnc_micro_combine_c(ccv_nnc_micro_combine_t* const combine)
+{
+	ccv_nnc_micro_source_t source = {
+		.len = 0,
+		.size = 4096,
+		.buf = (char*)ccmalloc(4096),
+	};
+	source.buf[0] = 0;
+	_ccv_nnc_micro_source_printf(&source, "#include <math.h>\n#include <float.h>\n\n");
+	_ccv_nnc_micro_source_printf(&source, "#define ccv_max(a, b) ((a) > (b) ? (a) : (b))\n#define ccv_min(a, b) ((a) < (b) ? (a) : (b))\n");
+	_ccv_nnc_micro_source_printf(&source, "\ntypedef void(*ccv_nnc_parallel_for_f)(void* const context, const int idx);\n\n");
+	_ccv_nnc_micro_source_printf(&source, "typedef struct {\n\tfloat* const* vars;\n\tconst int* shapes;\n\tconst int* values;\n\tint start;\n\tint end;\n\tint chunk;\n} ccv_nnc_micro_parallel_t;\n");
+	_ccv_nnc_micro_program_c(&source, &combine->forward, "forward");
+	_ccv_nnc_micro_program_c(&source, &combine->backward, "backward");
+	return source.buf;
+}
+
+// MARK - JIT
+
+#ifdef HAVE_DLFCN
+
+KHASH_MAP_INIT_INT64(ccv_nnc_micro_jit, void*)
+
+static uint8_t key_siphash[16] = "nncmicrojitcache";
+// Handles are never closed, the compiled programs are shared by all combined ops with the same code.
+static khash_t(ccv_nnc_micro_jit)* jit_cache = 0;
+#ifdef HAVE_PTHREAD
+static pthread_mutex_t jit_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// Only trust what the current user owns and no one else can write to. For the cache directory, no one else can
+// even list it, otherwise a shared object planted at the predictable path would be loaded.
+static int _ccv_nnc_micro_jit_is_private(const struct stat* const st, const int is_dir)
+{
+	if (st->st_uid != getuid())
+		return 0;
+	if (is_dir)
+		return S_ISDIR(st->st_mode) && (st->st_mode & (S_IRWXG | S_IRWXO)) == 0;
+	return S_ISREG(st->st_mode) && (st->st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+static int _ccv_nnc_micro_jit_cache_dir(char* const dir, const size_t size)
+{
+	const char* const cache_dir = getenv("CCV_NNC_MICRO_CACHE_DIR");
+	if (cache_dir)
+	{
+		if (snprintf(dir, size, "%s", cache_dir) >= size)
+			return -1;
+	} else {
+		const char* tmp_dir = getenv("TMPDIR");
+		if (!tmp_dir)
+			tmp_dir = "/tmp";
+		// One directory per user, thus, users never share the compiled programs.
+		if (snprintf(dir, size, "%s/ccv_nnc_micro.%d", tmp_dir, (int)getuid()) >= size)
+			return -1;
+	}
+	if (mkdir(dir, S_IRWXU) != 0 && errno != EEXIST)
+		return -1;
+	struct stat st;
+	if (lstat(dir, &st) != 0 || !_ccv_nnc_micro_jit_is_private(&st, 1))
+		return -1;
+	return 0;
+}
+
+static void* _ccv_nnc_micro_jit_dlopen_cached(const char* const so_path)
+{
+	const int fd = open(so_path, O_RDONLY | O_NOFOLLOW);
+	if (fd < 0)
+		return 0;
+	struct stat st;
+	const int trusted = fstat(fd, &st) == 0 && _ccv_nnc_micro_jit_is_private(&st, 0);
+	close(fd);
+	if (!trusted)
+		return 0;
+	return dlopen(so_path, RTLD_NOW | RTLD_LOCAL);
+}
+
+// Run the compiler directly rather than through the shell, thus, neither CC nor the paths are ever interpreted.
+static int _ccv_nnc_micro_jit_cc(const char* const so_path, const char* const c_path)
+{
+	const char* cc = getenv("CC");
+	if (!cc)
+		cc = "cc";
+	char* const argv[] = {
+		(char*)cc, "-O3", "-fopenmp-simd", "-fPIC", "-shared", "-o", (char*)so_path, (char*)c_path, "-lm", 0
+	};
+	const pid_t pid = fork();
+	if (pid < 0)
+		return -1;
+	if (pid == 0)
+	{
+		execvp(cc, argv);
+		_exit(127);
+	}
+	int status;
+	while (waitpid(pid, &status, 0) < 0)
+		if (errno != EINTR)
+			return -1;
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+static void* _ccv_nnc_micro_jit_dlopen(const char* const code, const size_t len, const uint64_t hash)
+{
+	char dir[1024];
+	if (_ccv_nnc_micro_jit_cache_dir(dir, sizeof(dir)) != 0)
+		return 0;
+	char so_path[1024];
+	if (snprintf(so_path, sizeof(so_path), "%s/ccv_nnc_micro_%016llx.so", dir, (unsigned long long)hash) >= sizeof(so_path))
+		return 0;
+	// Compiled by an earlier run.
+	void* handle = _ccv_nnc_micro_jit_dlopen_cached(so_path);
+	if (handle)
+		return handle;
+	// Write and compile in a fresh directory only this process knows, and move the result in place, thus, no one
+	// ever loads a partially written shared object.
+	char work_dir[1024];
+	if (snprintf(work_dir, sizeof(work_dir), "%s/ccv_nnc_micro_XXXXXX", dir) >= sizeof(work_dir) || !mkdtemp(work_dir))
+		return 0;
+	// The directory name leaves enough room for the file names.
+	char c_path[1024 + 16];
+	snprintf(c_path, sizeof(c_path), "%s/program.c", work_dir);
+	char tmp_path[1024 + 16];
+	snprintf(tmp_path, sizeof(tmp_path), "%s/program.so", work_dir);
+	const int fd = open(c_path, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if (fd < 0)
+	{
+		rmdir(work_dir);
+		return 0;
+	}
+	size_t written = 0;
+	while (written < len)
+	{
+		const ssize_t n = write(fd, code + written, len - written);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		written += n;
+	}
+	close(fd);
+	const int status = written == len ? _ccv_nnc_micro_jit_cc(tmp_path, c_path) : -1;
+	remove(c_path);
+	if (status != 0 || rename(tmp_path, so_path) != 0)
+	{
+		remove(tmp_path);
+		rmdir(work_dir);
+		return 0;
+	}
+	rmdir(work_dir);
+	return dlopen(so_path, RTLD_NOW | RTLD_LOCAL);
+}
+
+#endif
+
+int ccv_nnc_micro_combine_compile(ccv_nnc_micro_combine_t* const combine)
+{
+#ifdef HAVE_DLFCN
+	if (combine->jit.forward)
+		return 0;
+	char* const code = ccv_nnc_micro_combine_c(combine);
+	const size_t len = strlen(code);
+	uint64_t hash;
+	siphash((uint8_t*)&hash, (const uint8_t*)code, len, key_siphash);
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&jit_cache_mutex);
+#endif
+	if (!jit_cache)
+		jit_cache = kh_init(ccv_nnc_micro_jit);
+	int ret;
+	const khiter_t k = kh_put(ccv_nnc_micro_jit, jit_cache, hash, &ret);
+	// If it failed to compile before, it is 0 in the cache and we won't try again.
+	if (ret != 0)
+		kh_val(jit_cache, k) = _ccv_nnc_micro_jit_dlopen(code, len, hash);
+	void* const handle = kh_val(jit_cache, k);
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock(&jit_cache_mutex);
+#endif
+	ccfree(code);
+	if (!handle)
+		return -1;
+	combine->jit.forward = (ccv_nnc_micro_program_f)dlsym(handle, "ccv_nnc_micro_combine_forward");
+	combine->jit.backward = (ccv_nnc_micro_program_f)dlsym(handle, "ccv_nnc_micro_combine_backward");
+	if (!combine->jit.forward || !combine->jit.backward)
+	{
+		combine->jit.forward = 0;
+		combine->jit.backward = 0;
+		return -1;
+	}
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+void ccv_nnc_micro_combine_exec(ccv_nnc_micro_combine_t* const combine, const uint32_t cmd, ccv_nnc_tensor_t* const* const inputs, const int input_size, const ccv_nnc_micro_scalar_t* const values, const int parameter_size, ccv_nnc_tensor_t* const* const outputs, const int output_size)
+{
+	assert(cmd == CCV_NNC_CUSTOM_FORWARD || cmd == CCV_NNC_CUSTOM_BACKWARD);
+	const ccv_nnc_micro_program_f jit = cmd == CCV_NNC_CUSTOM_FORWARD ? combine->jit.forward : combine->jit.backward;
+	if (!jit)
+	{
+		ccv_nnc_micro_combine_interpret(combine, cmd, inputs, input_size, values, parameter_size, outputs, output_size);
+		return;
+	}
+	const ccv_nnc_micro_program_t* const program = cmd == CCV_NNC_CUSTOM_FORWARD ? &combine->forward : &combine->backward;
+	int i;
+	// Parameters are only used as indexes, hence integers.
+	int index_values[ccv_max(1, parameter_size)];
+	for (i = 0; i < parameter_size; i++)
+		switch (values[i].type)
+		{
+			case CCV_8U:
+				index_values[i] = values[i].u8;
+				break;
+			case CCV_32S:
+				index_values[i] = values[i].i32;
+				break;
+			case CCV_64S:
+				index_values[i] = (int)values[i].i64;
+				break;
+			default:
+				index_values[i] = 0;
+				break;
+		}
+	int* const shapes = (int*)ccmalloc(sizeof(int) * CCV_NNC_MAX_DIM_ALLOC * program->var_count);
+	float** const vars_mem = ccv_nnc_micro_program_vars_new(combine, program, inputs, input_size, values, parameter_size, outputs, output_size, shapes);
+	jit(vars_mem, shapes, index_values, ccv_nnc_parallel_for);
+	ccfree(vars_mem);
+	ccfree(shapes);
+}
@@ -0,0 +1,333 @@
+#include "ccv_nnc.h"
+#include "ccv_nnc_easy.h"
+#include "ccv_nnc_internal.h"
+#include "ccv_internal.h"
+#include "_ccv_nnc_micro.h"
+#include <unistd.h>
+
+int ccv_nnc_micro_loop_index_has_loop_id(const ccv_nnc_micro_loop_index_term_t index, const int loop_id)
+{
+	switch (index.type)
+	{
+		case CCV_NNC_MICRO_LOOP_INDEX_TYPE_ID:
+			return index.id.type == CCV_NNC_MICRO_LOOP_ID && (loop_id < 0 || index.id.id == loop_id);
+		case CCV_NNC_MICRO_LOOP_INDEX_TYPE_BINARY:
+			return ccv_nnc_micro_loop_index_has_loop_id(index.binary->left, loop_id) || ccv_nnc_micro_loop_index_has_loop_id(index.binary->right, loop_id);
+	}
+	return 0;
+}
+
+static int _ccv_nnc_micro_index_is_loop_id(const ccv_nnc_micro_loop_index_term_t index, const int loop_id)
+{
+	return index.type == CCV_NNC_MICRO_LOOP_INDEX_TYPE_ID && index.id.type == CCV_NNC_MICRO_LOOP_ID && index.id.id == loop_id;
+}
+
+static int _ccv_nnc_micro_index_equal(const ccv_nnc_micro_loop_index_term_t a, const ccv_nnc_micro_loop_index_term_t b)
+{
+	if (a.type != b.type)
+		return 0;
+	switch (a.type)
+	{
+		case CCV_NNC_MICRO_LOOP_INDEX_TYPE_ID:
+			return a.id.type == b.id.type && a.id.d == b.id.d && a.id.id == b.id.id;
+		case CCV_NNC_MICRO_LOOP_INDEX_TYPE_VAL:
+			return a.immediate_value == b.immediate_value;
+		case CCV_NNC_MICRO_LOOP_INDEX_TYPE_BINARY:
+			return a.binary->op == b.binary->op && _ccv_nnc_micro_index_equal(a.binary->left, b.binary->left) && _ccv_nnc_micro_index_equal(a.binary->right, b.binary->right);
+	}
+	return 0;
+}
+
+static int _ccv_nnc_micro_variable_equal(const ccv_nnc_micro_loop_variable_t* const a, const ccv_nnc_micro_loop_variable_t* const b)
+{
+	if (a->id.type != b->id.type || a->id.id != b->id.id || a->index_count != b->index_count)
+		return 0;
+	int i;
+	for (i = 0; i < a->index_count; i++)
+		if (!_ccv_nnc_micro_index_equal(a->index[i], b->index[i]))
+			return 0;
+	return 1;
+}
+
+// The tensor this statement writes to, 0 if it only writes to a loop carried variable.
+static const ccv_nnc_micro_loop_variable_t* _ccv_nnc_micro_statement_lvalue(const ccv_nnc_micro_loop_statement_t* const statement)
+{
+	switch (statement->type)
+	{
+		case CCV_NNC_MICRO_LOOP_STATEMENT_TYPE_ASSIGNMENT:
+			return &statement->assignment.lvalue;
+		case CCV_NNC_MICRO_LOOP_STATEMENT_TYPE_COMPOUND_ASSIGNMENT:
+			if (statement->compound_assignment.lvalue.type == CCV_NNC_MICRO_LOOP_EXPR_TYPE_VAR)
+				return &statement->compound_assignment.lvalue.variable;
+			break;
+	}
+	return 0;
+}
+
+static const ccv_nnc_micro_loop_expression_t* _ccv_nnc_micro_statement_rvalue(const ccv_nnc_micro_loop_statement_t* const statement)
+{
+	return statement->type == CCV_NNC_MICRO_LOOP_STATEMENT_TYPE_ASSIGNMENT ? &statement->assignment.rvalue : &statement->compound_assignment.rvalue;
+}
+
+typedef int(*ccv_nnc_micro_variable_visit_f)(const ccv_nnc_micro_loop_variable_t* const variable, const void* const context);
+
+// Visit all tensors read by the expression, stop and return 0 if the visitor returns 0.
+static int _ccv_nnc_micro_expression_visit(const ccv_nnc_micro_loop_expression_t* const expression, const ccv_nnc_micro_variable_visit_f visit, const void* const context)
+{
+	switch (expression->type)
+	{
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_VAR:
+			return visit(&expression->variable, context);
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_UNARY:
+			return _ccv_nnc_micro_expression_visit(expression->unary.x, visit, context);
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_BINARY:
+			return _ccv_nnc_micro_expression_visit(expression->binary.left, visit, context) && _ccv_nnc_micro_expression_visit(expression->binary.right, visit, context);
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_TERNAY:
+			return _ccv_nnc_micro_expression_visit(expression->ternary.pivot, visit, context) && _ccv_nnc_micro_expression_visit(expression->ternary.left, visit, context) && _ccv_nnc_micro_expression_visit(expression->ternary.right, visit, context);
+	}
+	return 1;
+}
+
+// Visit all tensors read or written by statements of the loop at index and the loops nested in it.
+static int _ccv_nnc_micro_loops_visit(const ccv_nnc_micro_loop_t* const loops, const int loop_count, const int index, const ccv_nnc_micro_variable_visit_f visit, const void* const context)
+{
+	int i, j;
+	for (i = index; i < loop_count; i++)
+		for (j = 0; j < loops[i].statement_count; j++)
+		{
+			const ccv_nnc_micro_loop_variable_t* const lvalue = _ccv_nnc_micro_statement_lvalue(loops[i].statements + j);
+			if (lvalue && !visit(lvalue, context))
+				return 0;
+			if (!_ccv_nnc_micro_expression_visit(_ccv_nnc_micro_statement_rvalue(loops[i].statements + j), visit, context))
+				return 0;
+		}
+	return 1;
+}
+
+static int _ccv_nnc_micro_variable_same_or_other(const ccv_nnc_micro_loop_variable_t* const variable, const void* const context)
+{
+	const ccv_nnc_micro_loop_variable_t* const lvalue = (const ccv_nnc_micro_loop_variable_t*)context;
+	return variable->id.id != lvalue->id.id || _ccv_nnc_micro_variable_equal(variable, lvalue);
+}
+
+// Iterations of the loop with loop_id are independent if every tensor written within the loop at index is written
+// at the same place by all statements, this place is indexed by the loop counter, and it is read only from there.
+// Thus, each iteration touches its own elements of these tensors, and the iterations can run in any order.
+static int _ccv_nnc_micro_loop_is_independent(const ccv_nnc_micro_loop_t* const loops, const int loop_count, const int index, const int loop_id)
+{
+	int i, j, k;
+	for (i = index; i < loop_count; i++)
+		for (j = 0; j < loops[i].statement_count; j++)
+		{
+			const ccv_nnc_micro_loop_variable_t* const lvalue = _ccv_nnc_micro_statement_lvalue(loops[i].statements + j);
+			if (!lvalue)
+				continue;
+			int flag = 0;
+			for (k = 0; !flag && k < lvalue->index_count; k++)
+				flag = _ccv_nnc_micro_index_is_loop_id(lvalue->index[k], loop_id);
+			if (!flag)
+				return 0;
+			if (!_ccv_nnc_micro_loops_visit(loops, loop_count, index, _ccv_nnc_micro_variable_same_or_other, lvalue))
+				return 0;
+		}
+	return 1;
+}
+
+typedef struct {
+	const ccv_nnc_micro_loop_t* loops;
+	int loop_count;
+	int* scores;
+} ccv_nnc_micro_unit_stride_score_t;
+
+static int _ccv_nnc_micro_variable_unit_stride_score(const ccv_nnc_micro_loop_variable_t* const variable, const void* const context)
+{
+	const ccv_nnc_micro_unit_stride_score_t* const score = (const ccv_nnc_micro_unit_stride_score_t*)context;
+	if (variable->index_count == 0)
+		return 1;
+	int i;
+	for (i = 0; i < score->loop_count; i++)
+		if (_ccv_nnc_micro_index_is_loop_id(variable->index[variable->index_count - 1], score->loops[i].id.id))
+			++score->scores[i];
+	return 1;
+}
+
+static int _ccv_nnc_micro_variable_is_unit_stride(const ccv_nnc_micro_loop_variable_t* const variable, const void* const context)
+{
+	const int loop_id = *(const int*)context;
+	if (variable->index_count == 0)
+		return 1;
+	int i;
+	for (i = 0; i < variable->index_count - 1; i++)
+		if (ccv_nnc_micro_loop_index_has_loop_id(variable->index[i], loop_id))
+			return 0;
+	const ccv_nnc_micro_loop_index_term_t last = variable->index[variable->index_count - 1];
+	return !ccv_nnc_micro_loop_index_has_loop_id(last, loop_id) || _ccv_nnc_micro_index_is_loop_id(last, loop_id);
+}
+
+static int _ccv_nnc_micro_variable_mark(const ccv_nnc_micro_loop_variable_t* const variable, const void* const context)
+{
+	uint8_t* const marks = (uint8_t*)context;
+	marks[variable->id.id] = 1;
+	return 1;
+}
+
+static int _ccv_nnc_micro_expression_reads_carried(const ccv_nnc_micro_loop_expression_t* const expression, const int carried_id)
+{
+	switch (expression->type)
+	{
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_ID:
+			return expression->id.type == CCV_NNC_MICRO_LOOP_CARRIED_ID && expression->id.id == carried_id;
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_UNARY:
+			return _ccv_nnc_micro_expression_reads_carried(expression->unary.x, carried_id);
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_BINARY:
+			return _ccv_nnc_micro_expression_reads_carried(expression->binary.left, carried_id) || _ccv_nnc_micro_expression_reads_carried(expression->binary.right, carried_id);
+		case CCV_NNC_MICRO_LOOP_EXPR_TYPE_TERNAY:
+			return _ccv_nnc_micro_expression_reads_carried(expression->ternary.pivot, carried_id) || _ccv_nnc_micro_expression_reads_carried(expression->ternary.left, carried_id) || _ccv_nnc_micro_expression_reads_carried(expression->ternary.right, carried_id);
+	}
+	return 0;
+}
+
+// Only the loop id and the start / end index move, statements and loop-carried variables stay at the same level.
+static void _ccv_nnc_micro_loop_move(ccv_nnc_micro_loop_t* const loops, const int from, const int to)
+{
+	const ccv_nnc_micro_id_t id = loops[from].id;
+	const ccv_nnc_micro_loop_index_term_t start_index = loops[from].start_index;
+	const ccv_nnc_micro_loop_index_term_t end_index = loops[from].end_index;
+	int i;
+	if (from < to)
+		for (i = from; i < to; i++)
+		{
+			loops[i].id = loops[i + 1].id;
+			loops[i].start_index = loops[i + 1].start_index;
+			loops[i].end_index = loops[i + 1].end_index;
+		}
+	else
+		for (i = from; i > to; i--)
+		{
+			loops[i].id = loops[i - 1].id;
+			loops[i].start_index = loops[i - 1].start_index;
+			loops[i].end_index = loops[i - 1].end_index;
+		}
+	loops[to].id = id;
+	loops[to].start_index = start_index;
+	loops[to].end_index = end_index;
+}
+
+static int _ccv_nnc_micro_tile_size(const int tensor_count)
+{
+	long cache_size = 0;
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+	cache_size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+#endif
+	if (cache_size <= 0)
+		cache_size = 32 * 1024;
+	// A tile of each tensor touched should fit in half of the L1 data cache.
+	int tile_size = 128;
+	while (tile_size > 8 && (long)tile_size * tile_size * sizeof(float) * ccv_max(1, tensor_count) > cache_size / 2)
+		tile_size /= 2;
+	return tile_size;
+}
+
+static void _ccv_nnc_micro_block_schedule(ccv_nnc_micro_loop_block_t* const block, const int var_count)
+{
+	ccv_nnc_micro_loop_t* const loops = block->loops;
+	const int loop_count = block->loop_count;
+	int i, j, k;
+	// Loops up to the first one with statements or loop-carried variables only contain each other, thus, they
+	// can be reordered as long as their iterations are independent and their bounds don't depend on each other.
+	int band_count;
+	for (band_count = 1; band_count < loop_count && loops[band_count - 1].carried_count == 0 && loops[band_count - 1].statement_count == 0; band_count++)
+		{ /* Find the band. */ }
+	int independents[band_count];
+	for (i = 0; i < band_count; i++)
+		independents[i] = !ccv_nnc_micro_loop_index_has_loop_id(loops[i].start_index, -1) && !ccv_nnc_micro_loop_index_has_loop_id(loops[i].end_index, -1) && _ccv_nnc_micro_loop_is_independent(loops, loop_count, 0, loops[i].id.id);
+	if (band_count > 1)
+	{
+		// Interchange the loop most tensors use as their last index into the innermost of the band.
+		int scores[band_count];
+		memset(scores, 0, sizeof(scores));
+		ccv_nnc_micro_unit_stride_score_t score = {
+			.loops = loops,
+			.loop_count = band_count,
+			.scores = scores,
+		};
+		_ccv_nnc_micro_loops_visit(loops, loop_count, 0, _ccv_nnc_micro_variable_unit_stride_score, &score);
+		const int last = band_count - 1;
+		if (independents[last])
+		{
+			k = last;
+			for (i = 0; i < last; i++)
+				if (independents[i] && scores[i] > scores[k])
+					k = i;
+			if (k != last)
+			{
+				_ccv_nnc_micro_loop_move(loops, k, last);
+				for (i = k; i < last; i++)
+					independents[i] = independents[i + 1];
+				independents[last] = 1;
+			}
+		}
+		// Otherwise, bring an independent loop outermost so it can run in parallel.
+		if (!independents[0])
+			for (i = 1; i < last; i++)
+				if (independents[i])
+				{
+					_ccv_nnc_micro_loop_move(loops, i, 0);
+					for (j = i; j > 0; j--)
+						independents[j] = independents[j - 1];
+					independents[0] = 1;
+					break;
+				}
+	}
+	loops[0].parallel = independents[0];
+	// Tile the innermost two loops if they are all the loops there are, and some tensors are accessed with a stride
+	// along the innermost loop (transpose, for example).
+	if (band_count > 1 && band_count == loop_count && independents[loop_count - 2] && independents[loop_count - 1])
+	{
+		int loop_id = loops[loop_count - 1].id.id;
+		if (!_ccv_nnc_micro_loops_visit(loops, loop_count, 0, _ccv_nnc_micro_variable_is_unit_stride, &loop_id))
+		{
+			uint8_t marks[var_count];
+			memset(marks, 0, sizeof(marks));
+			_ccv_nnc_micro_loops_visit(loops, loop_count, 0, _ccv_nnc_micro_variable_mark, marks);
+			int tensor_count = 0;
+			for (i = 0; i < var_count; i++)
+				tensor_count += marks[i];
+			loops[loop_count - 2].tile_size = loops[loop_count - 1].tile_size = _ccv_nnc_micro_tile_size(tensor_count);
+		}
+	}
+	// The innermost loop can run in SIMD lanes if its iterations are independent, except reductions into loop-carried
+	// variables of the outer loops, and it accesses memory with unit-stride.
+	ccv_nnc_micro_loop_t* const innermost = loops + loop_count - 1;
+	int loop_id = innermost->id.id;
+	if (innermost->carried_count > 0 || !_ccv_nnc_micro_loop_is_independent(loops, loop_count, loop_count - 1, loop_id) || !_ccv_nnc_micro_loops_visit(loops, loop_count, loop_count - 1, _ccv_nnc_micro_variable_is_unit_stride, &loop_id))
+		return;
+	for (i = 0; i < innermost->statement_count; i++)
+	{
+		const ccv_nnc_micro_loop_statement_t* const statement = innermost->statements + i;
+		if (statement->type != CCV_NNC_MICRO_LOOP_STATEMENT_TYPE_COMPOUND_ASSIGNMENT || statement->compound_assignment.lvalue.type == CCV_NNC_MICRO_LOOP_EXPR_TYPE_VAR)
+			continue;
+		const ccv_nnc_micro_id_t carried = statement->compound_assignment.lvalue.id;
+		if (carried.d == CCV_NNC_MICRO_REDUCE_OP_ARGMAX || carried.d == CCV_NNC_MICRO_REDUCE_OP_ARGMIN)
+			return;
+		// A reduction cannot be read while it is still being reduced.
+		for (j = 0; j < innermost->statement_count; j++)
+			if (_ccv_nnc_micro_expression_reads_carried(_ccv_nnc_micro_statement_rvalue(innermost->statements + j), carried.id))
+				return;
+	}
+	innermost->vectorize = 1;
+}
+
+void ccv_nnc_micro_program_schedule(ccv_nnc_micro_program_t* const program)
+{
+	int i, j;
+	ccv_nnc_micro_function_t* const functions = program->functions;
+	for (i = 0; i < program->function_count; i++)
+	{
+		const int block_count = functions[i].block_count;
+		ccv_nnc_micro_loop_block_t* const blocks = block_count == 1 ? &functions[i].one_block : functions[i].blocks;
+		for (j = 0; j < block_count; j++)
+			if (blocks[j].loop_count > 0)
+				_ccv_nnc_micro_block_schedule(blocks + j, program->var_count);
+	}
+}
@@ -10,13 +10,42 @@
 #endif
 #include "_ccv_nnc_stream.h"
 
+typedef struct ccv_nnc_stream_cpu_task_s ccv_nnc_stream_cpu_task_t;
+
+struct ccv_nnc_stream_cpu_task_s {
+	ccv_nnc_callback_f fn;
+	void* context;
+	ccv_nnc_stream_cpu_task_t* next;
+};
+
 typedef struct {
 	ccv_nnc_stream_context_t super;
-	// Left for implementation yet, the CPU support for stream context.
+	// The workspace has to be the first after super, it matches the layout of the compat stream on CUDA.
 	size_t workspace_size;
 	void* workspace;
+	// The CPU stream context executes submitted tasks in order on its own thread, the thread is launched lazily.
+	int async;
+	int active;
+	int busy;
+	int quit;
+	int freed; // Freed from the stream thread itself, the thread frees the stream once all the tasks executed.
+	int status; // The first failure of the commands executed on the stream since the last wait.
+	ccv_nnc_stream_cpu_task_t* head;
+	ccv_nnc_stream_cpu_task_t* tail;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t notify;
+	pthread_cond_t drain;
 } ccv_nnc_stream_cpu_t;
 
+typedef struct {
+	ccv_nnc_stream_signal_t super;
+	uint64_t emitted; // How many times this signal has been emitted onto a stream.
+	uint64_t completed; // The latest emit that the stream has executed to.
+	pthread_mutex_t mutex;
+	pthread_cond_t notify;
+} ccv_nnc_stream_cpu_signal_t;
+
 typedef struct {
 	ccv_nnc_stream_context_destructor_f destructor_hook;
 	void* context;
@@ -34,9 +63,141 @@ ccv_nnc_stream_context_t* ccv_nnc_stream_context_new(const int type)
 	if (CCV_STREAM_GET_CONTEXT(type) == CCV_STREAM_CONTEXT_GPU)
 		return ccv_nnc_init_stream_context((ccv_nnc_stream_context_t*)stream_cpu);
 #endif
+	if (CCV_STREAM_GET_CONTEXT(type) == CCV_STREAM_CONTEXT_CPU)
+	{
+		stream_cpu->async = 1;
+		pthread_mutex_init(&stream_cpu->mutex, 0);
+		pthread_cond_init(&stream_cpu->notify, 0);
+		pthread_cond_init(&stream_cpu->drain, 0);
+	}
 	return (ccv_nnc_stream_context_t*)stream_cpu;
 }
 
+static __thread ccv_nnc_stream_cpu_t* stream_cpu_per_thread = 0;
+
+static void _ccv_nnc_stream_context_deinit(ccv_nnc_stream_context_t* const stream_context, const int cpu_async);
+
+static void* _ccv_nnc_stream_cpu_main(void* userdata)
+{
+	ccv_nnc_stream_cpu_t* const stream_cpu = (ccv_nnc_stream_cpu_t*)userdata;
+	stream_cpu_per_thread = stream_cpu;
+	pthread_mutex_lock(&stream_cpu->mutex);
+	for (;;)
+	{
+		while (!stream_cpu->head && !stream_cpu->quit)
+			pthread_cond_wait(&stream_cpu->notify, &stream_cpu->mutex);
+		// Only quit when everything submitted is executed.
+		if (!stream_cpu->head)
+			break;
+		ccv_nnc_stream_cpu_task_t* const task = stream_cpu->head;
+		stream_cpu->head = task->next;
+		if (!stream_cpu->head)
+			stream_cpu->tail = 0;
+		stream_cpu->busy = 1;
+		pthread_mutex_unlock(&stream_cpu->mutex);
+		task->fn(task->context);
+		ccfree(task);
+		pthread_mutex_lock(&stream_cpu->mutex);
+		stream_cpu->busy = 0;
+		if (!stream_cpu->head)
+			pthread_cond_broadcast(&stream_cpu->drain);
+	}
+	const int freed = stream_cpu->freed;
+	pthread_mutex_unlock(&stream_cpu->mutex);
+	if (freed)
+	{
+		// Nobody will join this thread.
+		pthread_detach(pthread_self());
+		stream_cpu_per_thread = 0;
+		_ccv_nnc_stream_context_deinit((ccv_nnc_stream_context_t*)stream_cpu, 1);
+	}
+	return 0;
+}
+
+static inline int _ccv_nnc_stream_cpu_is_async(const ccv_nnc_stream_context_t* const stream_context)
+{
+	if (!stream_context || CCV_STREAM_GET_CONTEXT(stream_context->type) != CCV_STREAM_CONTEXT_CPU)
+		return 0;
+	const ccv_nnc_stream_cpu_t* const stream_cpu = (const ccv_nnc_stream_cpu_t*)stream_context;
+	// If we are on the thread of the stream already, everything is in order, execute directly.
+	return stream_cpu->async && stream_cpu_per_thread != stream_cpu;
+}
+
+ccv_nnc_stream_context_t* ccv_nnc_stream_context_enter(ccv_nnc_stream_context_t* const stream_context)
+{
+	ccv_nnc_stream_context_t* const previous = (ccv_nnc_stream_context_t*)stream_cpu_per_thread;
+	if (stream_context && CCV_STREAM_GET_CONTEXT(stream_context->type) == CCV_STREAM_CONTEXT_CPU)
+		stream_cpu_per_thread = (ccv_nnc_stream_cpu_t*)stream_context;
+	return previous;
+}
+
+void ccv_nnc_stream_context_leave(ccv_nnc_stream_context_t* const previous)
+{
+	stream_cpu_per_thread = (ccv_nnc_stream_cpu_t*)previous;
+}
+
+static int _ccv_nnc_stream_cpu_wait(ccv_nnc_stream_cpu_t* const stream_cpu)
+{
+	pthread_mutex_lock(&stream_cpu->mutex);
+	while (stream_cpu->head || stream_cpu->busy)
+		pthread_cond_wait(&stream_cpu->drain, &stream_cpu->mutex);
+	const int status = stream_cpu->status;
+	stream_cpu->status = CCV_NNC_EXEC_SUCCESS;
+	pthread_mutex_unlock(&stream_cpu->mutex);
+	return status;
+}
+
+static int _ccv_nnc_stream_cpu_is_idle(ccv_nnc_stream_cpu_t* const stream_cpu)
+{
+	pthread_mutex_lock(&stream_cpu->mutex);
+	const int idle = !stream_cpu->head && !stream_cpu->busy;
+	pthread_mutex_unlock(&stream_cpu->mutex);
+	return idle;
+}
+
+int ccv_nnc_stream_context_is_async(const ccv_nnc_stream_context_t* const stream_context)
+{
+	return _ccv_nnc_stream_cpu_is_async(stream_context);
+}
+
+void ccv_nnc_stream_context_set_status(ccv_nnc_stream_context_t* const stream_context, const int status)
+{
+	if (status == CCV_NNC_EXEC_SUCCESS || !stream_context || CCV_STREAM_GET_CONTEXT(stream_context->type) != CCV_STREAM_CONTEXT_CPU)
+		return;
+	ccv_nnc_stream_cpu_t* const stream_cpu = (ccv_nnc_stream_cpu_t*)stream_context;
+	pthread_mutex_lock(&stream_cpu->mutex);
+	if (stream_cpu->status == CCV_NNC_EXEC_SUCCESS)
+		stream_cpu->status = status;
+	pthread_mutex_unlock(&stream_cpu->mutex);
+}
+
+void ccv_nnc_stream_context_submit(ccv_nnc_stream_context_t* const stream_context, const ccv_nnc_callback_f callback, void* const callback_context)
+{
+	if (!_ccv_nnc_stream_cpu_is_async(stream_context))
+	{
+		callback(callback_context);
+		return;
+	}
+	ccv_nnc_stream_cpu_t* const stream_cpu = (ccv_nnc_stream_cpu_t*)stream_context;
+	ccv_nnc_stream_cpu_task_t* const task = (ccv_nnc_stream_cpu_task_t*)ccmalloc(sizeof(ccv_nnc_stream_cpu_task_t));
+	task->fn = callback;
+	task->context = callback_context;
+	task->next = 0;
+	pthread_mutex_lock(&stream_cpu->mutex);
+	if (stream_cpu->tail)
+		stream_cpu->tail->next = task;
+	else
+		stream_cpu->head = task;
+	stream_cpu->tail = task;
+	if (!stream_cpu->active)
+	{
+		stream_cpu->active = 1;
+		pthread_create(&stream_cpu->thread, 0, _ccv_nnc_stream_cpu_main, stream_cpu);
+	} else
+		pthread_cond_signal(&stream_cpu->notify);
+	pthread_mutex_unlock(&stream_cpu->mutex);
+}
+
 CCV_WARN_UNUSED(int) ccv_nnc_stream_context_type(const ccv_nnc_stream_context_t* const stream_context)
 {
 	return stream_context->type;
@@ -72,6 +233,9 @@ void* ccv_nnc_stream_context_get_workspace(ccv_nnc_stream_context_t* const strea
 
 void ccv_nnc_stream_context_drain(ccv_nnc_stream_context_t* const stream_context)
 {
+	// The workspace can still be in use by the tasks on the stream.
+	if (_ccv_nnc_stream_cpu_is_async(stream_context))
+		_ccv_nnc_stream_cpu_wait((ccv_nnc_stream_cpu_t*)stream_context);
 #ifdef HAVE_CUDA
 	ccv_nnc_stream_compat_drain(stream_context);
 #else
@@ -93,9 +257,9 @@ static void _ccv_nnc_stream_context_add_callback(ccv_nnc_stream_context_t* const
 	if (CCV_STREAM_GET_CONTEXT(stream_context->type) == CCV_STREAM_CONTEXT_GPU)
 		ccv_nnc_stream_compat_add_callback(stream_context, callback, async_callback, callback_context);
 	else
-		callback(callback_context);
+		ccv_nnc_stream_context_submit(stream_context, callback, callback_context);
 #else
-	callback(callback_context);
+	ccv_nnc_stream_context_submit(stream_context, callback, callback_context);
 #endif
 }
 
@@ -146,10 +310,10 @@ void ccv_nnc_stream_context_add_callback(ccv_nnc_stream_context_t* const stream_
 		_ccv_nnc_stream_context_add_callback(stream_context, callback, _ccv_nnc_async_dispatch, callback_context);
 }
 
-void ccv_nnc_stream_context_wait(const ccv_nnc_stream_context_t* const stream_context)
+int ccv_nnc_stream_context_wait(const ccv_nnc_stream_context_t* const stream_context)
 {
 	if (!stream_context)
-		return;
+		return CCV_NNC_EXEC_SUCCESS;
 	co_scheduler_t* const scheduler = stream_context->scheduler;
 	if (scheduler && !co_is_on_scheduler(scheduler)) // First wait the scheduler to finish if I am not currently on that scheduler.
 	{
@@ -162,6 +326,9 @@ void ccv_nnc_stream_context_wait(const ccv_nnc_stream_context_t* const stream_co
 	if (CCV_STREAM_GET_CONTEXT(stream_context->type) == CCV_STREAM_CONTEXT_GPU)
 		ccv_nnc_synchronize_stream_context(stream_context);
 #endif
+	if (_ccv_nnc_stream_cpu_is_async(stream_context))
+		return _ccv_nnc_stream_cpu_wait((ccv_nnc_stream_cpu_t*)stream_context);
+	return CCV_NNC_EXEC_SUCCESS;
 }
 
 int ccv_nnc_stream_context_add_destructor_hook(ccv_nnc_stream_context_t* const stream, ccv_nnc_stream_context_destructor_f destructor, void* const context)
@@ -211,7 +378,7 @@ void ccv_nnc_stream_context_remove_destructor_hook(ccv_nnc_stream_context_t* con
 		stream->reuse_destructor_hook = -1;
 }
 
-void ccv_nnc_stream_context_free(ccv_nnc_stream_context_t* const stream_context)
+static void _ccv_nnc_stream_context_deinit(ccv_nnc_stream_context_t* const stream_context, const int cpu_async)
 {
 	if (stream_context->destructor_hooks)
 	{
@@ -232,6 +399,12 @@ void ccv_nnc_stream_context_free(ccv_nnc_stream_context_t* const stream_context)
 	ccv_nnc_stream_cpu_t* stream_cpu = (ccv_nnc_stream_cpu_t*)stream_context;
 	if (stream_cpu->workspace)
 		ccfree(stream_cpu->workspace);
+	if (cpu_async)
+	{
+		pthread_mutex_destroy(&stream_cpu->mutex);
+		pthread_cond_destroy(&stream_cpu->notify);
+		pthread_cond_destroy(&stream_cpu->drain);
+	}
 #ifdef HAVE_CUDA
 	}
 #endif
@@ -245,6 +418,29 @@ void ccv_nnc_stream_context_free(ccv_nnc_stream_context_t* const stream_context)
 	ccfree(stream_context);
 }
 
+void ccv_nnc_stream_context_free(ccv_nnc_stream_context_t* const stream_context)
+{
+	const int cpu_async = CCV_STREAM_GET_CONTEXT(stream_context->type) == CCV_STREAM_CONTEXT_CPU && ((ccv_nnc_stream_cpu_t*)stream_context)->async;
+	if (cpu_async)
+	{
+		// Let the stream thread finish all the submitted tasks and exit.
+		ccv_nnc_stream_cpu_t* const stream_cpu = (ccv_nnc_stream_cpu_t*)stream_context;
+		pthread_mutex_lock(&stream_cpu->mutex);
+		stream_cpu->quit = 1;
+		const int active = stream_cpu->active;
+		// Called from a task on the stream thread, it cannot wait for itself. Leave it to the thread once it is done.
+		if (stream_cpu_per_thread == stream_cpu)
+			stream_cpu->freed = 1;
+		pthread_cond_signal(&stream_cpu->notify);
+		pthread_mutex_unlock(&stream_cpu->mutex);
+		if (stream_cpu_per_thread == stream_cpu)
+			return;
+		if (active)
+			pthread_join(stream_cpu->thread, 0);
+	}
+	_ccv_nnc_stream_context_deinit(stream_context, cpu_async);
+}
+
 void ccv_nnc_stream_context_set_neighbor_discovery(ccv_nnc_stream_context_t* const stream_context, ccv_nnc_stream_context_neighbor_discovery_f discovery, void* const context)
 {
 	stream_context->neighbor_discovery = discovery;
@@ -260,13 +456,18 @@ ccv_nnc_stream_context_t* ccv_nnc_stream_context_find_neighbor(ccv_nnc_stream_co
 
 ccv_nnc_stream_signal_t* ccv_nnc_stream_signal_new(const int type)
 {
-	ccv_nnc_stream_signal_t* const signal = (ccv_nnc_stream_signal_t*)ccmalloc(sizeof(ccv_nnc_stream_signal_t));
+	ccv_nnc_stream_signal_t* const signal = (ccv_nnc_stream_signal_t*)ccmalloc(sizeof(ccv_nnc_stream_cpu_signal_t));
 	signal->type = type;
 	signal->emit_context = 0;
 #ifdef HAVE_CUDA
 	if (CCV_STREAM_GET_CONTEXT(type) == CCV_STREAM_CONTEXT_GPU)
 		return ccv_nnc_init_stream_signal(signal);
 #endif
+	ccv_nnc_stream_cpu_signal_t* const cpu_signal = (ccv_nnc_stream_cpu_signal_t*)signal;
+	cpu_signal->emitted = 0;
+	cpu_signal->completed = 0;
+	pthread_mutex_init(&cpu_signal->mutex, 0);
+	pthread_cond_init(&cpu_signal->notify, 0);
 	return signal;
 }
 
@@ -275,13 +476,52 @@ CCV_WARN_UNUSED(int) ccv_nnc_stream_signal_type(const ccv_nnc_stream_signal_t* c
 	return signal->type;
 }
 
+typedef struct {
+	ccv_nnc_stream_cpu_signal_t* signal;
+	uint64_t emitted;
+} ccv_nnc_stream_cpu_signal_emit_t;
+
+static void _ccv_nnc_stream_cpu_signal_complete(void* const context)
+{
+	ccv_nnc_stream_cpu_signal_emit_t* const emit = (ccv_nnc_stream_cpu_signal_emit_t*)context;
+	ccv_nnc_stream_cpu_signal_t* const cpu_signal = emit->signal;
+	pthread_mutex_lock(&cpu_signal->mutex);
+	if (emit->emitted > cpu_signal->completed)
+		cpu_signal->completed = emit->emitted;
+	pthread_cond_broadcast(&cpu_signal->notify);
+	pthread_mutex_unlock(&cpu_signal->mutex);
+	ccfree(emit);
+}
+
+static void _ccv_nnc_stream_cpu_signal_wait(void* const context)
+{
+	ccv_nnc_stream_cpu_signal_emit_t* const emit = (ccv_nnc_stream_cpu_signal_emit_t*)context;
+	ccv_nnc_stream_cpu_signal_t* const cpu_signal = emit->signal;
+	pthread_mutex_lock(&cpu_signal->mutex);
+	while (cpu_signal->completed < emit->emitted)
+		pthread_cond_wait(&cpu_signal->notify, &cpu_signal->mutex);
+	pthread_mutex_unlock(&cpu_signal->mutex);
+	ccfree(emit);
+}
+
 void ccv_nnc_stream_context_emit_signal(ccv_nnc_stream_context_t* const stream, ccv_nnc_stream_signal_t* const signal)
 {
 	signal->emit_context = stream;
 #ifdef HAVE_CUDA
 	if (CCV_STREAM_GET_CONTEXT(signal->type) == CCV_STREAM_CONTEXT_GPU)
+	{
 		ccv_nnc_stream_compat_emit_signal(stream, signal);
+		return;
+	}
 #endif
+	// Similar to CUDA event, a signal captures the work submitted to the stream up until now.
+	ccv_nnc_stream_cpu_signal_t* const cpu_signal = (ccv_nnc_stream_cpu_signal_t*)signal;
+	ccv_nnc_stream_cpu_signal_emit_t* const emit = (ccv_nnc_stream_cpu_signal_emit_t*)ccmalloc(sizeof(ccv_nnc_stream_cpu_signal_emit_t));
+	emit->signal = cpu_signal;
+	pthread_mutex_lock(&cpu_signal->mutex);
+	emit->emitted = ++cpu_signal->emitted;
+	pthread_mutex_unlock(&cpu_signal->mutex);
+	ccv_nnc_stream_context_submit(stream, _ccv_nnc_stream_cpu_signal_complete, emit);
 }
 
 ccv_nnc_stream_context_t* ccv_nnc_stream_signal_get_emitter(const ccv_nnc_stream_signal_t* const signal)
@@ -293,16 +533,46 @@ void ccv_nnc_stream_context_wait_signal(const ccv_nnc_stream_context_t* const st
 {
 #ifdef HAVE_CUDA
 	if (CCV_STREAM_GET_CONTEXT(signal->type) == CCV_STREAM_CONTEXT_GPU)
+	{
 		ccv_nnc_stream_compat_wait_signal(stream, signal);
+		return;
+	}
 #endif
+	ccv_nnc_stream_cpu_signal_t* const cpu_signal = (ccv_nnc_stream_cpu_signal_t*)signal;
+	ccv_nnc_stream_cpu_signal_emit_t* const emit = (ccv_nnc_stream_cpu_signal_emit_t*)ccmalloc(sizeof(ccv_nnc_stream_cpu_signal_emit_t));
+	emit->signal = cpu_signal;
+	pthread_mutex_lock(&cpu_signal->mutex);
+	// Only wait for the emits happened before this call.
+	emit->emitted = cpu_signal->emitted;
+	const int done = (cpu_signal->completed >= emit->emitted);
+	pthread_mutex_unlock(&cpu_signal->mutex);
+	if (done)
+	{
+		ccfree(emit);
+		return;
+	}
+	// If the stream cannot wait asynchronously, block the caller instead.
+	ccv_nnc_stream_context_submit((ccv_nnc_stream_context_t*)stream, _ccv_nnc_stream_cpu_signal_wait, emit);
 }
 
 void ccv_nnc_stream_signal_free(ccv_nnc_stream_signal_t* const signal)
 {
 #ifdef HAVE_CUDA
 	if (CCV_STREAM_GET_CONTEXT(signal->type) == CCV_STREAM_CONTEXT_GPU)
+	{
 		ccv_nnc_deinit_stream_signal(signal);
+		ccfree(signal);
+		return;
+	}
 #endif
+	ccv_nnc_stream_cpu_signal_t* const cpu_signal = (ccv_nnc_stream_cpu_signal_t*)signal;
+	// Make sure no stream still references this signal.
+	pthread_mutex_lock(&cpu_signal->mutex);
+	while (cpu_signal->completed < cpu_signal->emitted)
+		pthread_cond_wait(&cpu_signal->notify, &cpu_signal->mutex);
+	pthread_mutex_unlock(&cpu_signal->mutex);
+	pthread_mutex_destroy(&cpu_signal->mutex);
+	pthread_cond_destroy(&cpu_signal->notify);
 	ccfree(signal);
 }
 
@@ -322,10 +592,37 @@ co_scheduler_t* ccv_nnc_stream_context_get_scheduler(ccv_nnc_stream_context_t* c
 {
 	co_scheduler_t* scheduler = stream_context->scheduler;
 	if (!scheduler)
-		stream_context->scheduler = scheduler = co_scheduler_new();
+		stream_context->scheduler = scheduler = co_scheduler_new(stream_context->scheduler_worker_count);
 	return scheduler;
 }
 
+void ccv_nnc_stream_context_set_scheduler_worker_count(ccv_nnc_stream_context_t* const stream_context, const int worker_count)
+{
+	assert(worker_count >= 0);
+	if (stream_context->scheduler_worker_count == worker_count)
+		return;
+	stream_context->scheduler_worker_count = worker_count;
+	co_scheduler_t* const scheduler = stream_context->scheduler;
+	if (scheduler)
+	{
+		// The scheduler will be recreated with the new worker count.
+		assert(!co_scheduler_is_active(scheduler));
+		co_scheduler_free(scheduler);
+		stream_context->scheduler = 0;
+	}
+}
+
+static void _co_stream_cpu_resume(void* const userdata)
+{
+	co_routine_t* const task = (co_routine_t*)userdata;
+	co_scheduler_t* const scheduler = task->scheduler;
+	pthread_mutex_lock(&scheduler->mutex);
+	_co_prepend_task(scheduler, task);
+	--scheduler->stream_await_count;
+	pthread_cond_signal(&scheduler->wait);
+	pthread_mutex_unlock(&scheduler->mutex);
+}
+
 int _co_stream_await(co_routine_t* const self, ccv_nnc_stream_context_t* const stream)
 {
 	if (!stream)
@@ -334,7 +631,18 @@ int _co_stream_await(co_routine_t* const self, ccv_nnc_stream_context_t* const s
 	if (CCV_STREAM_GET_CONTEXT(stream->type) == CCV_STREAM_CONTEXT_GPU)
 		return co_stream_compat_await(self, stream);
 #endif
-	return 1;
+	if (!_ccv_nnc_stream_cpu_is_async(stream))
+		return 1;
+	ccv_nnc_stream_cpu_t* const stream_cpu = (ccv_nnc_stream_cpu_t*)stream;
+	// If the stream is completed, no need to wait.
+	if (_ccv_nnc_stream_cpu_is_idle(stream_cpu))
+		return 1;
+	co_scheduler_t* const scheduler = self->scheduler;
+	pthread_mutex_lock(&scheduler->mutex);
+	++scheduler->stream_await_count;
+	ccv_nnc_stream_context_submit(stream, _co_stream_cpu_resume, self);
+	pthread_mutex_unlock(&scheduler->mutex);
+	return 0;
 }
 
 // MARK - Signal Container
@@ -23,6 +23,13 @@ ccv_nnc_symbolic_graph_t* ccv_nnc_symbolic_graph_new(void)
 	return graph;
 }
 
+static ccv_nnc_tensor_t* _ccv_nnc_tensor_constant_copy(const ccv_nnc_tensor_t* const tensor)
+{
+	ccv_nnc_tensor_t* const constant = ccv_nnc_tensor_new(0, tensor->info, 0);
+	ccv_nnc_cmd_exec(CMD_DATA_TRANSFER_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST((ccv_nnc_tensor_t*)tensor), TENSOR_LIST(constant), 0);
+	return constant;
+}
+
 ccv_nnc_symbolic_graph_t* ccv_nnc_symbolic_graph_dup(const ccv_nnc_symbolic_graph_t* const graph, ccv_nnc_symbolic_graph_subst_f subst)
 {
 	ccv_nnc_symbolic_graph_t* new_graph = ccmalloc(sizeof(ccv_nnc_symbolic_graph_t));
@@ -51,6 +58,8 @@ ccv_nnc_symbolic_graph_t* ccv_nnc_symbolic_graph_dup(const ccv_nnc_symbolic_grap
 			symbol_info->s_ref->rnum = s_ref->rnum;
 			memcpy(ccv_array_get(symbol_info->s_ref, 0), ccv_array_get(s_ref, 0), sizeof(int) * s_ref->rnum);
 		}
+		if (symbol_info->constant)
+			symbol_info->constant = _ccv_nnc_tensor_constant_copy(symbol_info->constant);
 	}
 	new_graph->exec_symbol_info = ccv_array_new(sizeof(ccv_nnc_graph_exec_symbol_info_t), graph->exec_symbol_info->rnum, 0);
 	new_graph->exec_symbol_info->rnum = graph->exec_symbol_info->rnum;
@@ -192,6 +201,23 @@ ccv_nnc_tensor_symbol_t ccv_nnc_tensor_symbol_new(ccv_nnc_symbolic_graph_t* cons
 	return symbol;
 }
 
+ccv_nnc_tensor_symbol_t ccv_nnc_tensor_symbol_constant_new(ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_t* const tensor, const char* const name)
+{
+	assert(!CCV_IS_TENSOR_MULTIVIEW(tensor));
+	const ccv_nnc_tensor_symbol_t symbol = ccv_nnc_tensor_symbol_new(graph, tensor->info, name);
+	ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, symbol.d);
+	symbol_info->constant = _ccv_nnc_tensor_constant_copy(tensor);
+	return symbol;
+}
+
+ccv_nnc_tensor_t* ccv_nnc_tensor_symbol_constant(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_symbol_t tensor)
+{
+	assert(graph == tensor.graph);
+	assert(tensor.d >= 0 && tensor.d < graph->tensor_symbol_info->rnum);
+	const ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, tensor.d);
+	return symbol_info->constant;
+}
+
 void* ccv_nnc_tensor_symbol_new_hook(ccv_nnc_symbolic_graph_t* const graph, ccv_nnc_tensor_symbol_new_hook_f hook, void* context)
 {
 	void* const prev = graph->hooks.tensor_symbol_new.context;
@@ -791,6 +817,11 @@ void ccv_nnc_tensor_symbol_free(ccv_nnc_symbolic_graph_t* const graph, ccv_nnc_t
 		ccfree(symbol_info->name);
 		symbol_info->name = 0;
 	}
+	if (symbol_info->constant)
+	{
+		ccv_nnc_tensor_free(symbol_info->constant);
+		symbol_info->constant = 0;
+	}
 	symbol_info->flags |= CCV_NNC_TENSOR_SYMBOL_DEAD;
 	int i;
 	for (i = graph->tensor_symbol_info->rnum - 1; i >= 0; i--)
@@ -1444,6 +1475,8 @@ static void _ccv_nnc_symbolic_graph_dot_tensor_symbol(const int index, const ccv
 				flag = fputs(" (1", out); // Output if it is one init'ed.
 		if (symbol_info->flags & CCV_NNC_TENSOR_SYMBOL_TAPE_VAR)
 			flag = (flag >= 0) ? fputs(",t", out) : fputs(" (t", out); // Output is a tape variable
+		if (symbol_info->constant)
+			flag = (flag >= 0) ? fputs(",c", out) : fputs(" (c", out); // Output if it is a constant.
 		if (CCV_TENSOR_GET_MEMORY(symbol_info->info.type) == CCV_TENSOR_GPU_MEMORY &&
 			CCV_TENSOR_GET_DEVICE(symbol_info->info.type) != CCV_COMPUTE_DEVICE_ANY)
 			flag = (flag >= 0) ? fprintf(out, ",d%d", CCV_TENSOR_GET_DEVICE_ID(symbol_info->info.type)) : fprintf(out, " (d%d", CCV_TENSOR_GET_DEVICE_ID(symbol_info->info.type));
@@ -1821,6 +1854,8 @@ void ccv_nnc_symbolic_graph_free(ccv_nnc_symbolic_graph_t* const graph)
 			ccfree(symbol_info->name);
 		if (symbol_info->s_ref)
 			ccv_array_free(symbol_info->s_ref);
+		if (symbol_info->constant)
+			ccv_nnc_tensor_free(symbol_info->constant);
 	}
 	if (graph->sub_graphs)
 	{
@@ -1102,6 +1102,7 @@ static void _ccv_nnc_symbolic_graph_backward_prep_gen(ccv_nnc_symbolic_graph_bac
 			const ccv_nnc_graph_exec_symbol_info_t* forw_exec = exec_symbol_info + idx;
 			ccv_nnc_autograd_graph_exec_symbol_t* back_exec = autograd_execs + idx;
 			back_exec->cmd = forw_exec->cmd;
+			assert(forw_exec->cmd.info.activation.type == CCV_NNC_ACTIVATION_NONE); // Fused activations are split out before.
 			if (back_exec->cmd.cmd != CCV_NNC_NOOP)
 				back_exec->cmd.cmd += 1; /* Backward command is the one after forward command. */
 			assert(ccv_nnc_cmd_is_backward(back_exec->cmd) || back_exec->cmd.cmd == CCV_NNC_NOOP);
@@ -1949,6 +1950,119 @@ static void _ccv_nnc_symbolic_graph_backward_gen(const ccv_nnc_symbolic_graph_ba
 	}
 }
 
+// A command with a fused activation (from CCV_NNC_SIMPLIFY_OPS_FUSION) has no backward, split the activation out into
+// its own command again. This changes the forward graph in place, but the caller's sources and destinations stay valid:
+// the node becomes the activation if it is a destination (the rest of the command moves before it), otherwise it keeps
+// the rest of the command and the activation goes after it. A fused node that is both a source and a destination keeps
+// the command, and the activation after it is only reachable from the returned destinations.
+static void _ccv_nnc_symbolic_graph_backward_defuse(ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size)
+{
+	static const uint32_t activation_cmds[] = {
+		[CCV_NNC_ACTIVATION_RELU] = CCV_NNC_RELU_FORWARD,
+		[CCV_NNC_ACTIVATION_SIGMOID] = CCV_NNC_SIGMOID_FORWARD,
+		[CCV_NNC_ACTIVATION_TANH] = CCV_NNC_TANH_FORWARD,
+		[CCV_NNC_ACTIVATION_SWISH] = CCV_NNC_SWISH_FORWARD,
+	};
+	int i, j, k;
+	const int exec_symbol_info_size = graph->exec_symbol_info->rnum;
+	for (i = 0; i < exec_symbol_info_size; i++)
+	{
+		ccv_nnc_graph_exec_symbol_info_t* exec_symbol_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, i);
+		const int activation = exec_symbol_info->cmd.info.activation.type;
+		if (CCV_NNC_GRAPH_EXEC_IS_DEAD(exec_symbol_info->flags) || activation == CCV_NNC_ACTIVATION_NONE)
+			continue;
+		assert(activation > 0 && activation < sizeof(activation_cmds) / sizeof(activation_cmds[0]));
+		assert(exec_symbol_info->output_size > 0 && exec_symbol_info->outputs[0] >= 0);
+		int is_source = 0, is_destination = 0;
+		for (j = 0; !is_source && j < source_size; j++)
+			is_source = (sources[j].d == i && sources[j].graph == graph);
+		for (j = 0; !is_destination && j < destination_size; j++)
+			is_destination = (destinations[j].d == i && destinations[j].graph == graph);
+		const ccv_nnc_graph_exec_symbol_t exec = {
+			.d = i,
+			.graph = graph,
+		};
+		const ccv_nnc_tensor_symbol_t b = {
+			.d = exec_symbol_info->outputs[0],
+			.graph = graph,
+		};
+		const ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(graph, ccv_nnc_tensor_symbol_params(graph, b), 0);
+		const ccv_nnc_cmd_t activation_cmd = ccv_nnc_cmd(activation_cmds[activation], 0, ccv_nnc_cmd_auto, 0);
+		// The array may be reallocated when adding the new symbols.
+		exec_symbol_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, i);
+		if (is_destination && !is_source)
+		{
+			ccv_nnc_cmd_t cmd = exec_symbol_info->cmd;
+			cmd.info.activation.type = CCV_NNC_ACTIVATION_NONE;
+			const ccv_nnc_hint_t hint = exec_symbol_info->hint;
+			ccv_nnc_tensor_symbol_t inputs[ccv_max(1, exec_symbol_info->input_size)];
+			const int input_size = exec_symbol_info->input_size;
+			for (j = 0; j < input_size; j++)
+				inputs[j] = (ccv_nnc_tensor_symbol_t){
+					.d = exec_symbol_info->inputs[j],
+					.graph = exec_symbol_info->inputs[j] >= 0 ? graph : 0,
+				};
+			ccv_nnc_tensor_symbol_t outputs[exec_symbol_info->output_size];
+			const int output_size = exec_symbol_info->output_size;
+			for (j = 0; j < output_size; j++)
+				outputs[j] = (ccv_nnc_tensor_symbol_t){
+					.d = exec_symbol_info->outputs[j],
+					.graph = exec_symbol_info->outputs[j] >= 0 ? graph : 0,
+				};
+			outputs[0] = x;
+			const ccv_nnc_graph_exec_symbol_t command_exec = ccv_nnc_graph_exec_symbol_new(graph, cmd, inputs, input_size, outputs, output_size, 0);
+			ccv_nnc_graph_exec_symbol_set_hint(graph, command_exec, hint);
+			ccv_nnc_graph_exec_symbol_set(graph, exec, activation_cmd);
+			ccv_nnc_graph_exec_symbol_set_hint(graph, exec, ccv_nnc_no_hint);
+			ccv_nnc_graph_exec_symbol_set_io(graph, exec, &x, 1, &b, 1);
+			// Everything that led to the node now leads to the command before it, including the activations split out so far.
+			for (j = 0; j < graph->exec_symbol_info->rnum; j++)
+			{
+				const ccv_nnc_graph_exec_symbol_info_t* const incoming_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, j);
+				if (CCV_NNC_GRAPH_EXEC_IS_DEAD(incoming_info->flags) || !incoming_info->outgoings)
+					continue;
+				for (k = 0; k < incoming_info->outgoings->rnum; k++)
+					if (*(int*)ccv_array_get(incoming_info->outgoings, k) == i)
+						break;
+				if (k == incoming_info->outgoings->rnum)
+					continue;
+				const ccv_nnc_graph_exec_symbol_t incoming = {
+					.d = j,
+					.graph = graph,
+				};
+				ccv_nnc_graph_exec_symbol_disjoin(graph, incoming, exec);
+				ccv_nnc_graph_exec_symbol_concat(graph, incoming, command_exec);
+			}
+			ccv_nnc_graph_exec_symbol_concat(graph, command_exec, exec);
+			continue;
+		}
+		exec_symbol_info->cmd.info.activation.type = CCV_NNC_ACTIVATION_NONE;
+		const ccv_nnc_graph_exec_symbol_t activation_exec = ccv_nnc_graph_exec_symbol_new(graph, activation_cmd, &x, 1, &b, 1, 0);
+		exec_symbol_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, i);
+		exec_symbol_info->outputs[0] = x.d;
+		if (exec_symbol_info->outgoings && exec_symbol_info->outgoings->rnum > 0)
+		{
+			ccv_array_t* const outgoings = ccv_array_new(sizeof(int), exec_symbol_info->outgoings->rnum, 0);
+			for (j = 0; j < exec_symbol_info->outgoings->rnum; j++)
+				ccv_array_push(outgoings, ccv_array_get(exec_symbol_info->outgoings, j));
+			for (j = 0; j < outgoings->rnum; j++)
+			{
+				const ccv_nnc_graph_exec_symbol_t outgoing = {
+					.d = *(int*)ccv_array_get(outgoings, j),
+					.graph = graph,
+				};
+				ccv_nnc_graph_exec_symbol_disjoin(graph, exec, outgoing);
+				ccv_nnc_graph_exec_symbol_concat(graph, activation_exec, outgoing);
+			}
+			ccv_array_free(outgoings);
+		}
+		ccv_nnc_graph_exec_symbol_concat(graph, exec, activation_exec);
+		for (j = 0; j < destination_size; j++)
+			if (destinations[j].d == i && destinations[j].graph == graph)
+				destinations[j] = activation_exec;
+	}
+}
+
 void ccv_nnc_symbolic_graph_backward(ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_symbol_t* const f_symbols, const int f_symbol_size, const ccv_nnc_tensor_symbol_t* const wrt_symbols, const int wrt_symbol_size, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size)
 {
 	int i;
@@ -1964,13 +2078,16 @@ void ccv_nnc_symbolic_graph_backward(ccv_nnc_symbolic_graph_t* const graph, cons
 		// This is not an alias, or what it refers to is not an alias.
 		assert(!((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, wrt_symbols[i].d))->alias_ref || !((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, ((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, wrt_symbols[i].d))->alias_ref - 1))->alias_ref);
 	}
+	ccv_nnc_graph_exec_symbol_t defused_destinations[ccv_max(1, destination_size)];
+	memcpy(defused_destinations, destinations, sizeof(ccv_nnc_graph_exec_symbol_t) * destination_size);
+	_ccv_nnc_symbolic_graph_backward_defuse(graph, sources, source_size, defused_destinations, destination_size);
 	const int exec_symbol_info_size = graph->exec_symbol_info->rnum;
 	const int tensor_symbol_info_size = graph->tensor_symbol_info->rnum;
 	assert(exec_symbol_info_size > 0);
 	assert(tensor_symbol_info_size > 0);
-	ccv_nnc_symbolic_graph_backward_prep_t backward_prep = _ccv_nnc_symbolic_graph_backward_prep(graph, sources, source_size, destinations, destination_size);
-	_ccv_nnc_symbolic_graph_backward_prep_prune_ops(&backward_prep, f_symbols, f_symbol_size, wrt_symbols, wrt_symbol_size, sources, source_size, destinations, destination_size);
-	_ccv_nnc_symbolic_graph_backward_prep_gen(&backward_prep, f_symbols, f_symbol_size, wrt_symbols, wrt_symbol_size, 0, sources, source_size, destinations, destination_size);
+	ccv_nnc_symbolic_graph_backward_prep_t backward_prep = _ccv_nnc_symbolic_graph_backward_prep(graph, sources, source_size, defused_destinations, destination_size);
+	_ccv_nnc_symbolic_graph_backward_prep_prune_ops(&backward_prep, f_symbols, f_symbol_size, wrt_symbols, wrt_symbol_size, sources, source_size, defused_destinations, destination_size);
+	_ccv_nnc_symbolic_graph_backward_prep_gen(&backward_prep, f_symbols, f_symbol_size, wrt_symbols, wrt_symbol_size, 0, sources, source_size, defused_destinations, destination_size);
 	_ccv_nnc_symbolic_graph_backward_gen(&backward_prep, f_symbols, f_symbol_size, wrt_symbols, wrt_symbol_size, graph, graph);
 	_ccv_nnc_symbolic_graph_backward_prep_free(backward_prep);
 }
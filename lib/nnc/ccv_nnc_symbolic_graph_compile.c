@@ -1032,6 +1032,7 @@ static ccv_nnc_tensor_arena_t* _ccv_nnc_tensor_arena_new(ccv_nnc_symbolic_graph_
 	tensor_arena->vt_alias_r_refs_p = 0;
 	tensor_arena->vt_alias_r_refs = 0;
 	tensor_arena->vt_sizes = 0;
+	tensor_arena->constants = 0;
 	tensor_arena->sub_arena_size = graph_prep->sub_prep_size;
 	tensor_arena->tensor_metadata = ccv_array_new(16 /* align to 16 bytes */, 0, 0);
 	tensor_arena->m_tensor_idx = ccv_array_new(sizeof(int), 0, 0);
@@ -3485,17 +3486,22 @@ static ccv_nnc_tensor_t* _ccv_nnc_tensor_from_graph_prep(const ccv_nnc_symbolic_
 	return (ccv_nnc_tensor_t*)_ccv_nnc_tensor_metadata_get(prep->tensor_arena->tensor_metadata, (0 << 1) + 1);
 }
 
-static void _ccv_nnc_graph_exec_arena_topsort(ccv_nnc_graph_t* const graph, ccv_nnc_graph_exec_arena_t* const graph_exec_arena)
+void ccv_nnc_graph_exec_arena_topsort(ccv_nnc_graph_exec_arena_t* const graph_exec_arena, ccv_nnc_graph_t* const graph, int* const exec_cvt, const int exec_cvt_size)
 {
 	int i;
-	int* const exec_cvt = (int*)ccmalloc(sizeof(int) * graph->exec_info->rnum);
-	ccv_nnc_graph_topsort(graph, exec_cvt, graph->exec_info->rnum);
+	ccv_nnc_graph_topsort(graph, exec_cvt, exec_cvt_size);
 	graph_exec_arena->source.d = exec_cvt[graph_exec_arena->source.d];
 	graph_exec_arena->destination.d = exec_cvt[graph_exec_arena->destination.d];
 	ccv_nnc_graph_exec_t* const graph_execs = graph_exec_arena->graph_execs;
 	for (i = 0; i < graph_exec_arena->graph_exec_size; i++)
 		if (graph_execs[i].graph == graph)
 			graph_execs[i].d = exec_cvt[graph_execs[i].d];
+}
+
+static void _ccv_nnc_graph_exec_arena_topsort(ccv_nnc_graph_t* const graph, ccv_nnc_graph_exec_arena_t* const graph_exec_arena)
+{
+	int* const exec_cvt = (int*)ccmalloc(sizeof(int) * graph->exec_info->rnum);
+	ccv_nnc_graph_exec_arena_topsort(graph_exec_arena, graph, exec_cvt, graph->exec_info->rnum);
 	ccfree(exec_cvt);
 }
 
@@ -3824,21 +3830,84 @@ static void _ccv_nnc_symbolic_graph_prep_dup_breakpoints_free(ccv_nnc_symbolic_g
 
 const ccv_nnc_symbolic_graph_compile_param_t ccv_nnc_default_compile_params = {};
 
-void ccv_nnc_symbolic_graph_compile(const ccv_nnc_symbolic_graph_t* const symbolic_graph, const ccv_nnc_symbolic_graph_compile_param_t compile_params, const ccv_nnc_tensor_bind_t* const tensor_binds, const int tensor_bind_size, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size, ccv_nnc_graph_t** const graph_ref, ccv_nnc_tensor_arena_t** const tensor_arena_ref, ccv_nnc_graph_exec_arena_t** const graph_exec_arena_ref)
+static int _ccv_nnc_tensor_symbol_is_written(const ccv_nnc_symbolic_graph_t* const symbolic_graph, const int d)
+{
+	int i, j;
+	for (i = 0; i < symbolic_graph->exec_symbol_info->rnum; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_info_t* const exec_symbol_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(symbolic_graph->exec_symbol_info, i);
+		if (CCV_NNC_GRAPH_EXEC_IS_DEAD(exec_symbol_info->flags))
+			continue;
+		for (j = 0; j < exec_symbol_info->output_size; j++)
+		{
+			const int output = exec_symbol_info->outputs[j];
+			if (output == d || (output >= 0 && ((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(symbolic_graph->tensor_symbol_info, output))->alias_ref == d + 1))
+				return 1;
+		}
+	}
+	return 0;
+}
+
+static void _ccv_nnc_tensor_binds_add_constants(const ccv_nnc_symbolic_graph_t* const symbolic_graph, const ccv_nnc_tensor_bind_t* const tensor_binds, const int tensor_bind_size, ccv_array_t* const binds, ccv_array_t* const constants)
+{
+	int i, j;
+	for (i = 0; i < symbolic_graph->tensor_symbol_info->rnum; i++)
+	{
+		const ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(symbolic_graph->tensor_symbol_info, i);
+		if (!symbol_info->constant || CCV_NNC_TENSOR_SYMBOL_IS_DEAD(symbol_info->flags))
+			continue;
+		// If it is bound explicitly, that one wins.
+		int flag = 0;
+		for (j = 0; !flag && j < tensor_bind_size; j++)
+			flag = (tensor_binds[j].symbol.graph == symbolic_graph && tensor_binds[j].symbol.d == i);
+		// Something writes to it, it is not a constant, allocate it as usual.
+		if (flag || _ccv_nnc_tensor_symbol_is_written(symbolic_graph, i))
+			continue;
+		// Bind a copy owned by the tensor arena, thus, the compiled graph doesn't depend on the symbolic graph staying around.
+		ccv_nnc_tensor_t* const constant = ccv_nnc_tensor_new(0, symbol_info->constant->info, 0);
+		ccv_nnc_cmd_exec(CMD_DATA_TRANSFER_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(symbol_info->constant), TENSOR_LIST(constant), 0);
+		ccv_array_push(constants, &constant);
+		const ccv_nnc_tensor_bind_t bind = {
+			.symbol = {
+				.d = i,
+				.graph = symbolic_graph,
+			},
+			.tensor = constant,
+		};
+		ccv_array_push(binds, &bind);
+	}
+	if (symbolic_graph->sub_graphs)
+		for (i = 0; i < symbolic_graph->sub_graphs->rnum; i++)
+			_ccv_nnc_tensor_binds_add_constants(*(ccv_nnc_symbolic_graph_t**)ccv_array_get(symbolic_graph->sub_graphs, i), tensor_binds, tensor_bind_size, binds, constants);
+}
+
+void ccv_nnc_symbolic_graph_compile(const ccv_nnc_symbolic_graph_t* const symbolic_graph, const ccv_nnc_symbolic_graph_compile_param_t compile_params, const ccv_nnc_tensor_bind_t* const user_tensor_binds, const int user_tensor_bind_size, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size, ccv_nnc_graph_t** const graph_ref, ccv_nnc_tensor_arena_t** const tensor_arena_ref, ccv_nnc_graph_exec_arena_t** const graph_exec_arena_ref)
 {
 	assert(graph_ref);
 	assert(tensor_arena_ref);
 	assert(graph_exec_arena_ref);
 	int i;
 	// Cannot bind the multi-view.
-	for (i = 0; i < tensor_bind_size; i++)
+	for (i = 0; i < user_tensor_bind_size; i++)
 	{
-		assert(tensor_binds[i].tensor);
-		assert(!CCV_IS_TENSOR_MULTIVIEW(tensor_binds[i].tensor));
+		assert(user_tensor_binds[i].tensor);
+		assert(!CCV_IS_TENSOR_MULTIVIEW(user_tensor_binds[i].tensor));
 	}
+	// Constant tensor symbols are bound to copies of the tensors the symbolic graph holds.
+	ccv_array_t* const binds = ccv_array_new(sizeof(ccv_nnc_tensor_bind_t), user_tensor_bind_size, 0);
+	for (i = 0; i < user_tensor_bind_size; i++)
+		ccv_array_push(binds, user_tensor_binds + i);
+	ccv_array_t* const constants = ccv_array_new(sizeof(ccv_nnc_tensor_t*), 0, 0);
+	_ccv_nnc_tensor_binds_add_constants(symbolic_graph, user_tensor_binds, user_tensor_bind_size, binds, constants);
+	const ccv_nnc_tensor_bind_t* const tensor_binds = binds->rnum ? (ccv_nnc_tensor_bind_t*)ccv_array_get(binds, 0) : 0;
+	const int tensor_bind_size = binds->rnum;
 	ccv_nnc_symbolic_graph_prep_t* graph_prep = _ccv_nnc_symbolic_graph_prep_new(symbolic_graph, tensor_binds, tensor_bind_size, outputs, output_size, sources, source_size, destinations, destination_size, 0, 0, 0, 0);
 	_ccv_nnc_symbolic_graph_prep_while_count_tensor(graph_prep);
 	ccv_nnc_tensor_arena_t* tensor_arena = _ccv_nnc_tensor_arena_new(graph_prep, compile_params.allocator, 0, tensor_binds, tensor_bind_size);
+	if (constants->rnum)
+		tensor_arena->constants = constants;
+	else
+		ccv_array_free(constants);
 	_ccv_nnc_tensor_arena_fixup_pair_ref_and_tape_var(tensor_arena, graph_prep, tensor_arena);
 	*tensor_arena_ref = tensor_arena;
 	// The above handled tensor allocation, now we need to materialize the graph from symbolic to real.
@@ -3851,6 +3920,7 @@ void ccv_nnc_symbolic_graph_compile(const ccv_nnc_symbolic_graph_t* const symbol
 	_ccv_nnc_graph_exec_arena_fixup_pair_ref(graph_exec_arena, graph_prep, graph_exec_arena);
 	*graph_exec_arena_ref = graph_exec_arena;
 	_ccv_nnc_symbolic_graph_prep_free(graph_prep);
+	ccv_array_free(binds);
 }
 
 static void _ccv_nnc_tensor_arena_free(ccv_nnc_tensor_arena_t* const tensor_arena)
@@ -3874,6 +3944,12 @@ static void _ccv_nnc_tensor_arena_free(ccv_nnc_tensor_arena_t* const tensor_aren
 		ccfree(tensor_arena->vt_alias_r_refs_p);
 	if (tensor_arena->vt_sizes)
 		ccfree(tensor_arena->vt_sizes);
+	if (tensor_arena->constants)
+	{
+		for (i = 0; i < tensor_arena->constants->rnum; i++)
+			ccv_nnc_tensor_free(*(ccv_nnc_tensor_t**)ccv_array_get(tensor_arena->constants, i));
+		ccv_array_free(tensor_arena->constants);
+	}
 	ccfree(tensor_arena);
 }
 
@@ -314,6 +314,61 @@ void ccv_nnc_symbolic_graph_write(const ccv_nnc_symbolic_graph_t* const graph, c
 		sqlite3_clear_bindings(tensor_bind_insert_stmt);
 	}
 	sqlite3_finalize(tensor_bind_insert_stmt);
+	// Write the values of constant tensor symbols.
+	const char tensor_constant_create_table_qs[] = "CREATE TABLE IF NOT EXISTS tensor_constant "
+		"(id INTEGER, graph INTEGER, type INTEGER, format INTEGER, datatype INTEGER, "
+		"dim BLOB, data BLOB, PRIMARY KEY (id, graph))";
+	SQLITE_ENFORCE(SQLITE_OK == sqlite3_exec(conn, tensor_constant_create_table_qs, 0, 0, 0));
+	// Remove everything in that table.
+	SQLITE_ENFORCE(SQLITE_OK == sqlite3_exec(conn, "DELETE FROM tensor_constant", 0, 0, 0));
+	const char tensor_constant_insert_qs[] =
+		"REPLACE INTO tensor_constant "
+		"(id, graph, type, format, datatype, dim, data) VALUES ("
+		"$id, $graph, $type, $format, $datatype, $dim, $data)";
+	sqlite3_stmt* tensor_constant_insert_stmt = 0;
+	SQLITE_ENFORCE(SQLITE_OK == sqlite3_prepare_v2(conn, tensor_constant_insert_qs, sizeof(tensor_constant_insert_qs), &tensor_constant_insert_stmt, 0));
+	int j;
+	for (i = 0; i < repo->rnum; i++)
+	{
+		const ccv_nnc_symbolic_graph_t* const sub_graph = *(ccv_nnc_symbolic_graph_t**)ccv_array_get(repo, i);
+		for (j = 0; j < sub_graph->tensor_symbol_info->rnum; j++)
+		{
+			const ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(sub_graph->tensor_symbol_info, j);
+			if (!symbol_info->constant || CCV_NNC_TENSOR_SYMBOL_IS_DEAD(symbol_info->flags))
+				continue;
+			const ccv_nnc_tensor_t* const tensor = symbol_info->constant;
+			assert(!CCV_IS_TENSOR_VIEW(tensor));
+			sqlite3_bind_int(tensor_constant_insert_stmt, 1, j);
+			sqlite3_bind_int(tensor_constant_insert_stmt, 2, i);
+			sqlite3_bind_int(tensor_constant_insert_stmt, 3, tensor->info.type);
+			sqlite3_bind_int(tensor_constant_insert_stmt, 4, tensor->info.format);
+			sqlite3_bind_int(tensor_constant_insert_stmt, 5, tensor->info.datatype);
+			sqlite3_bind_blob(tensor_constant_insert_stmt, 6, tensor->info.dim, sizeof(tensor->info.dim), 0);
+			const size_t data_size = ccv_nnc_tensor_data_size(tensor->info);
+#ifdef HAVE_CUDA
+			if (CCV_TENSOR_GET_MEMORY(tensor->info.type) == CCV_TENSOR_GPU_MEMORY)
+			{
+				if (!workspace)
+				{
+					workspace = ccmalloc(data_size);
+					workspace_size = data_size;
+				} else if (data_size > workspace_size) {
+					workspace = ccrealloc(workspace, data_size);
+					workspace_size = data_size;
+				}
+				cumemcpy(workspace, CCV_TENSOR_CPU_MEMORY, tensor->data.u8, tensor->info.type, data_size);
+				sqlite3_bind_blob(tensor_constant_insert_stmt, 7, workspace, data_size, 0);
+			} else
+				sqlite3_bind_blob(tensor_constant_insert_stmt, 7, tensor->data.u8, data_size, 0);
+#else
+			sqlite3_bind_blob(tensor_constant_insert_stmt, 7, tensor->data.u8, data_size, 0);
+#endif
+			SQLITE_ENFORCE(SQLITE_DONE == sqlite3_step(tensor_constant_insert_stmt));
+			sqlite3_reset(tensor_constant_insert_stmt);
+			sqlite3_clear_bindings(tensor_constant_insert_stmt);
+		}
+	}
+	sqlite3_finalize(tensor_constant_insert_stmt);
 #ifdef HAVE_CUDA
 	if (workspace)
 		ccfree(workspace);
@@ -628,6 +683,43 @@ void ccv_nnc_symbolic_graph_read(const char* const fn, ccv_nnc_symbolic_graph_t*
 	int i;
 	for (i = 0; i < repo->rnum; i++)
 		_ccv_nnc_symbolic_graph_rewire(repo, *(ccv_nnc_symbolic_graph_t**)ccv_array_get(repo, i));
+	// Files written before constants were serialized don't have this table.
+	const char tensor_constant_select_qs[] =
+		"SELECT id, graph, type, format, datatype, dim, data FROM tensor_constant";
+	sqlite3_stmt* tensor_constant_select_stmt = 0;
+	if (SQLITE_OK == sqlite3_prepare_v2(conn, tensor_constant_select_qs, sizeof(tensor_constant_select_qs), &tensor_constant_select_stmt, 0))
+	{
+		while (SQLITE_ROW == sqlite3_step(tensor_constant_select_stmt))
+		{
+			const int d = sqlite3_column_int(tensor_constant_select_stmt, 0);
+			const int graph_idx = sqlite3_column_int(tensor_constant_select_stmt, 1);
+			assert(graph_idx >= 0 && graph_idx < repo->rnum);
+			ccv_nnc_symbolic_graph_t* const graph = *(ccv_nnc_symbolic_graph_t**)ccv_array_get(repo, graph_idx);
+			assert(d >= 0 && d < graph->tensor_symbol_info->rnum);
+			ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, d);
+			ccv_nnc_tensor_param_t info;
+			info.type = sqlite3_column_int(tensor_constant_select_stmt, 2);
+			info.format = sqlite3_column_int(tensor_constant_select_stmt, 3);
+			info.datatype = sqlite3_column_int(tensor_constant_select_stmt, 4);
+			const int* const dim = sqlite3_column_blob(tensor_constant_select_stmt, 5);
+			memset(info.dim, 0, sizeof(info.dim));
+			if (dim)
+				memcpy(info.dim, dim, ccv_min(sizeof(info.dim), sqlite3_column_bytes(tensor_constant_select_stmt, 5)));
+			const void* const data = sqlite3_column_blob(tensor_constant_select_stmt, 6);
+			assert(data);
+			symbol_info->constant = ccv_nnc_tensor_new(0, info, 0);
+			const size_t data_size = ccv_nnc_tensor_data_size(info);
+#ifdef HAVE_CUDA
+			if (CCV_TENSOR_GET_MEMORY(info.type) == CCV_TENSOR_GPU_MEMORY)
+				cumemcpy(symbol_info->constant->data.u8, info.type, data, CCV_TENSOR_CPU_MEMORY, ccv_min(data_size, sqlite3_column_bytes(tensor_constant_select_stmt, 6)));
+			else
+				memcpy(symbol_info->constant->data.u8, data, ccv_min(data_size, sqlite3_column_bytes(tensor_constant_select_stmt, 6)));
+#else
+			memcpy(symbol_info->constant->data.u8, data, ccv_min(data_size, sqlite3_column_bytes(tensor_constant_select_stmt, 6)));
+#endif
+		}
+		sqlite3_finalize(tensor_constant_select_stmt);
+	}
 	*graph_ref = (repo->rnum > 0) ? *(ccv_nnc_symbolic_graph_t**)ccv_array_get(repo, 0) : 0;
 	assert((tensor_bind_size_ref && tensor_binds_ref) || (!tensor_bind_size_ref && !tensor_binds_ref));
 	if (tensor_bind_size_ref && tensor_binds_ref)
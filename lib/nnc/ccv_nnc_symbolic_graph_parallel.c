@@ -30,13 +30,23 @@ void ccv_nnc_symbolic_graph_data_parallel(ccv_nnc_symbolic_graph_t* const graph,
 	assert(parallel_count > 1);
 	ccv_nnc_graph_visit_t* const visit = ccv_nnc_graph_visit_new(graph, (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, 0), graph->exec_symbol_info->rnum, sources, source_size, destinations, destination_size, 0);
 	int i, j, k;
+	// GPU tensors are the ones to be parallelized. If there is none, the CPU tensors are, with each replica as a device.
+	int parallel_memory = CCV_TENSOR_CPU_MEMORY;
+	ccv_nnc_graph_visit_for(visit, (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, 0), node, idx) {
+		for (i = 0; i < node->input_size && parallel_memory == CCV_TENSOR_CPU_MEMORY; i++)
+			if (node->inputs[i] >= 0 && CCV_TENSOR_GET_MEMORY(((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, node->inputs[i]))->info.type) == CCV_TENSOR_GPU_MEMORY)
+				parallel_memory = CCV_TENSOR_GPU_MEMORY;
+		for (i = 0; i < node->output_size && parallel_memory == CCV_TENSOR_CPU_MEMORY; i++)
+			if (node->outputs[i] >= 0 && CCV_TENSOR_GET_MEMORY(((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, node->outputs[i]))->info.type) == CCV_TENSOR_GPU_MEMORY)
+				parallel_memory = CCV_TENSOR_GPU_MEMORY;
+	} ccv_nnc_graph_visit_endfor
 	// Tensor symbol has to be on device 0 or any.
 	ccv_nnc_graph_visit_for(visit, (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, 0), node, idx) {
 		for (i = 0; i < node->input_size; i++)
 			if (node->inputs[i] >= 0)
 			{
 				ccv_nnc_tensor_symbol_info_t* const tensor_symbol = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, node->inputs[i]);
-				if (CCV_TENSOR_GET_MEMORY(tensor_symbol->info.type) == CCV_TENSOR_GPU_MEMORY &&
+				if (CCV_TENSOR_GET_MEMORY(tensor_symbol->info.type) == parallel_memory &&
 					CCV_TENSOR_GET_DEVICE(tensor_symbol->info.type) != CCV_COMPUTE_DEVICE_ANY)
 					{ assert(CCV_TENSOR_GET_DEVICE(tensor_symbol->info.type) == CCV_COMPUTE_DEVICE_000); }
 			}
@@ -44,7 +54,7 @@ void ccv_nnc_symbolic_graph_data_parallel(ccv_nnc_symbolic_graph_t* const graph,
 			if (node->outputs[i] >= 0)
 			{
 				ccv_nnc_tensor_symbol_info_t* const tensor_symbol = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, node->outputs[i]);
-				if (CCV_TENSOR_GET_MEMORY(tensor_symbol->info.type) == CCV_TENSOR_GPU_MEMORY &&
+				if (CCV_TENSOR_GET_MEMORY(tensor_symbol->info.type) == parallel_memory &&
 					CCV_TENSOR_GET_DEVICE(tensor_symbol->info.type) != CCV_COMPUTE_DEVICE_ANY)
 					{ assert(CCV_TENSOR_GET_DEVICE(tensor_symbol->info.type) == CCV_COMPUTE_DEVICE_000); }
 			}
@@ -102,7 +112,7 @@ void ccv_nnc_symbolic_graph_data_parallel(ccv_nnc_symbolic_graph_t* const graph,
 			if (node->inputs[i] >= 0)
 			{
 				ccv_nnc_tensor_symbol_info_t* const tensor_symbol = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, node->inputs[i]);
-				if (CCV_TENSOR_GET_MEMORY(tensor_symbol->info.type) == CCV_TENSOR_GPU_MEMORY)
+				if (CCV_TENSOR_GET_MEMORY(tensor_symbol->info.type) == parallel_memory)
 				{
 					if (CCV_TENSOR_GET_DEVICE(tensor_symbol->info.type) == CCV_COMPUTE_DEVICE_ANY)
 						CCV_TENSOR_SET_DEVICE_ID(tensor_symbol->info.type, 0);
@@ -120,7 +130,7 @@ void ccv_nnc_symbolic_graph_data_parallel(ccv_nnc_symbolic_graph_t* const graph,
 			if (node->outputs[i] >= 0)
 			{
 				ccv_nnc_tensor_symbol_info_t* const tensor_symbol = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, node->outputs[i]);
-				if (CCV_TENSOR_GET_MEMORY(tensor_symbol->info.type) == CCV_TENSOR_GPU_MEMORY)
+				if (CCV_TENSOR_GET_MEMORY(tensor_symbol->info.type) == parallel_memory)
 				{
 					if (CCV_TENSOR_GET_DEVICE(tensor_symbol->info.type) == CCV_COMPUTE_DEVICE_ANY)
 						CCV_TENSOR_SET_DEVICE_ID(tensor_symbol->info.type, 0);
@@ -145,13 +155,13 @@ void ccv_nnc_symbolic_graph_data_parallel(ccv_nnc_symbolic_graph_t* const graph,
 				exec_flags[idx] = CCV_NNC_PARALLEL_REDUCER;
 			ccv_array_push(broadcast_reduce_execs, &idx);
 		} else if (parallelizable_data && !broadcast_outputs && !reduce_inputs) {
-			// If this node contains GPU data that need to be parallelized, and this node itself is not a broadcast node or a reducer node..
+			// If this node contains data that need to be parallelized, and this node itself is not a broadcast node or a reducer node..
 			ccv_array_push(dup_execs, &idx);
 			for (i = 0; i < node->input_size; i++)
 				if (node->inputs[i] >= 0)
 				{
 					ccv_nnc_tensor_symbol_info_t* const tensor_symbol = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, node->inputs[i]);
-					if (CCV_TENSOR_GET_MEMORY(tensor_symbol->info.type) == CCV_TENSOR_GPU_MEMORY)
+					if (CCV_TENSOR_GET_MEMORY(tensor_symbol->info.type) == parallel_memory)
 					{
 						// Add the symbol alias to first.
 						if (tensor_symbol->alias_ref)
@@ -163,7 +173,7 @@ void ccv_nnc_symbolic_graph_data_parallel(ccv_nnc_symbolic_graph_t* const graph,
 				if (node->outputs[i] >= 0)
 				{
 					ccv_nnc_tensor_symbol_info_t* const tensor_symbol = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, node->outputs[i]);
-					if (CCV_TENSOR_GET_MEMORY(tensor_symbol->info.type) == CCV_TENSOR_GPU_MEMORY)
+					if (CCV_TENSOR_GET_MEMORY(tensor_symbol->info.type) == parallel_memory)
 					{
 						if (tensor_symbol->alias_ref)
 							ccv_array_add_unique_int(dup_tensors, tensor_symbol->alias_ref - 1);
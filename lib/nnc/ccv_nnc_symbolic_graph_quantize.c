@@ -0,0 +1,155 @@
+#include "ccv_nnc.h"
+#include "ccv_nnc_easy.h"
+#include "ccv_nnc_internal.h"
+#include "ccv_internal.h"
+#include "_ccv_nnc_symbolic_graph.h"
+
+// MARK - Level-3.5 API
+
+static int _ccv_nnc_exec_symbol_can_quantize(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_info_t* const node)
+{
+	if (CCV_NNC_GRAPH_EXEC_IS_DEAD(node->flags))
+		return 0;
+	if (node->cmd.cmd != CCV_NNC_CONVOLUTION_FORWARD && node->cmd.cmd != CCV_NNC_GEMM_FORWARD)
+		return 0;
+	if (node->input_size < 2 || node->input_size > 3 || node->inputs[0] < 0 || node->inputs[1] < 0 || node->output_size != 1 || node->outputs[0] < 0)
+		return 0;
+	const ccv_nnc_tensor_symbol_info_t* const tensor_symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, 0);
+	// The quantize command only works with full tensors.
+	if (tensor_symbol_info[node->inputs[0]].alias_ref || tensor_symbol_info[node->inputs[1]].alias_ref)
+		return 0;
+	const ccv_nnc_tensor_param_t a = tensor_symbol_info[node->inputs[0]].info;
+	const ccv_nnc_tensor_param_t w = tensor_symbol_info[node->inputs[1]].info;
+	const ccv_nnc_tensor_param_t b = tensor_symbol_info[node->outputs[0]].info;
+	if (CCV_TENSOR_GET_MEMORY(a.type) != CCV_TENSOR_CPU_MEMORY || a.datatype != CCV_32F || w.datatype != CCV_32F || b.datatype != CCV_32F)
+		return 0;
+	if (node->input_size > 2 && node->inputs[2] >= 0 && tensor_symbol_info[node->inputs[2]].info.datatype != CCV_32F)
+		return 0;
+	if (node->cmd.cmd == CCV_NNC_CONVOLUTION_FORWARD)
+		return node->cmd.info.convolution.groups == 1 && a.format == CCV_TENSOR_FORMAT_NHWC;
+	// Only the direct multiplication with transposed weights has a quantized kernel.
+	return ccv_nnc_tensor_nd(a.dim) <= 2 && ccv_nnc_tensor_nd(w.dim) == 2 &&
+		node->cmd.info.blas.transpose_a[0] == node->cmd.info.blas.transpose_a[1] &&
+		node->cmd.info.blas.transpose_b[0] != node->cmd.info.blas.transpose_b[1];
+}
+
+static const ccv_nnc_tensor_t* _ccv_nnc_tensor_symbol_value(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_symbol_t symbol, const ccv_nnc_tensor_bind_t* const tensor_binds, const int tensor_bind_size)
+{
+	int i;
+	const ccv_nnc_tensor_t* tensor = 0;
+	for (i = 0; !tensor && i < tensor_bind_size; i++)
+		if (tensor_binds[i].symbol.graph == graph && tensor_binds[i].symbol.d == symbol.d)
+			tensor = tensor_binds[i].tensor;
+	if (!tensor)
+		tensor = ((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, symbol.d))->constant;
+	// Only a plain tensor on the CPU can be quantized right away.
+	if (!tensor || CCV_IS_TENSOR_VIEW(tensor) || CCV_IS_TENSOR_MULTIVIEW(tensor) || CCV_TENSOR_GET_MEMORY(tensor->info.type) != CCV_TENSOR_CPU_MEMORY)
+		return 0;
+	return tensor;
+}
+
+void ccv_nnc_symbolic_graph_quantize(ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_t* const execs, const float* const ranges, const int exec_size, const ccv_nnc_tensor_bind_t* const tensor_binds, const int tensor_bind_size)
+{
+	int i, j, k;
+	for (i = 0; i < exec_size; i++)
+	{
+		assert(execs[i].graph == graph);
+		const int idx = execs[i].d;
+		// Note that the exec_symbol_info can be reallocated once new exec symbols created, therefore, cannot hold on to the node.
+		const ccv_nnc_graph_exec_symbol_info_t* const node = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx);
+		if (!_ccv_nnc_exec_symbol_can_quantize(graph, node))
+			continue;
+		const ccv_nnc_tensor_symbol_t a = {
+			.d = node->inputs[0],
+			.graph = graph,
+		};
+		const ccv_nnc_tensor_symbol_t w = {
+			.d = node->inputs[1],
+			.graph = graph,
+		};
+		const ccv_nnc_tensor_symbol_t bias = {
+			.d = node->input_size > 2 ? node->inputs[2] : CCV_NNC_NO_TENSOR_SYMBOL,
+			.graph = graph,
+		};
+		const ccv_nnc_tensor_symbol_t b = {
+			.d = node->outputs[0],
+			.graph = graph,
+		};
+		ccv_nnc_tensor_param_t a_params = ccv_nnc_tensor_symbol_params(graph, a);
+		ccv_nnc_tensor_param_t w_params = ccv_nnc_tensor_symbol_params(graph, w);
+		a_params.datatype = CCV_8S;
+		w_params.datatype = CCV_8S;
+		ccv_nnc_tensor_param_t scale_params = {
+			.type = w_params.type,
+			.format = w_params.format,
+			.datatype = CCV_32F,
+			.dim = {1},
+		};
+		const ccv_nnc_tensor_symbol_t qa = ccv_nnc_tensor_symbol_new(graph, a_params, 0);
+		const ccv_nnc_tensor_symbol_t a_scale = ccv_nnc_tensor_symbol_new(graph, scale_params, 0);
+		// One scale per output channel for the weights.
+		scale_params.dim[0] = w_params.dim[0];
+		// If the weights are known now, quantize them once here and keep the results as constants. Otherwise, they
+		// are quantized every time the graph runs.
+		const ccv_nnc_tensor_t* const w_tensor = _ccv_nnc_tensor_symbol_value(graph, w, tensor_binds, tensor_bind_size);
+		ccv_nnc_tensor_symbol_t qw, w_scale;
+		ccv_nnc_graph_exec_symbol_t quantize_w = {
+			.d = CCV_NNC_NO_GRAPH_EXEC_SYMBOL,
+			.graph = graph,
+		};
+		if (w_tensor)
+		{
+			ccv_nnc_tensor_t* const qw_tensor = ccv_nnc_tensor_new(0, w_params, 0);
+			ccv_nnc_tensor_t* const w_scale_tensor = ccv_nnc_tensor_new(0, scale_params, 0);
+			ccv_nnc_cmd_exec(CMD_QUANTIZE_FORWARD(0), ccv_nnc_no_hint, 0, TENSOR_LIST((ccv_nnc_tensor_t*)w_tensor), TENSOR_LIST(qw_tensor, w_scale_tensor), 0);
+			qw = ccv_nnc_tensor_symbol_constant_new(graph, qw_tensor, 0);
+			w_scale = ccv_nnc_tensor_symbol_constant_new(graph, w_scale_tensor, 0);
+			ccv_nnc_tensor_free(qw_tensor);
+			ccv_nnc_tensor_free(w_scale_tensor);
+		} else {
+			qw = ccv_nnc_tensor_symbol_new(graph, w_params, 0);
+			w_scale = ccv_nnc_tensor_symbol_new(graph, scale_params, 0);
+			quantize_w = ccv_nnc_graph_exec_symbol_new(graph, CMD_QUANTIZE_FORWARD(0), TENSOR_SYMBOL_LIST(w), TENSOR_SYMBOL_LIST(qw, w_scale), 0);
+		}
+		// With the calibrated range, activations are quantized with a static scale. Otherwise, the scale is computed from the activations on the fly.
+		const float static_scale = ranges && ranges[i] > 0 ? ranges[i] / 127 : 0;
+		const ccv_nnc_graph_exec_symbol_t quantize_a = ccv_nnc_graph_exec_symbol_new(graph, CMD_QUANTIZE_FORWARD(static_scale), TENSOR_SYMBOL_LIST(a), TENSOR_SYMBOL_LIST(qa, a_scale), 0);
+		// Whatever runs before the node now runs before the quantization as well.
+		const int exec_symbol_info_size = graph->exec_symbol_info->rnum;
+		for (j = 0; j < exec_symbol_info_size; j++)
+		{
+			const ccv_nnc_graph_exec_symbol_info_t* const parent = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, j);
+			if (CCV_NNC_GRAPH_EXEC_IS_DEAD(parent->flags) || !parent->outgoings)
+				continue;
+			for (k = 0; k < parent->outgoings->rnum; k++)
+				if (*(int*)ccv_array_get(parent->outgoings, k) == idx)
+					break;
+			if (k == parent->outgoings->rnum)
+				continue;
+			const ccv_nnc_graph_exec_symbol_t parent_symbol = {
+				.d = j,
+				.graph = graph,
+			};
+			ccv_nnc_graph_exec_symbol_concat(graph, parent_symbol, quantize_a);
+			if (quantize_w.d != CCV_NNC_NO_GRAPH_EXEC_SYMBOL)
+				ccv_nnc_graph_exec_symbol_concat(graph, parent_symbol, quantize_w);
+		}
+		ccv_nnc_graph_exec_symbol_concat(graph, quantize_a, execs[i]);
+		if (quantize_w.d != CCV_NNC_NO_GRAPH_EXEC_SYMBOL)
+			ccv_nnc_graph_exec_symbol_concat(graph, quantize_w, execs[i]);
+		ccv_nnc_graph_exec_symbol_set_io(graph, execs[i], TENSOR_SYMBOL_LIST(qa, qw, bias, a_scale, w_scale), TENSOR_SYMBOL_LIST(b));
+		// If the node is a source, the quantization nodes become the sources instead.
+		if (graph->sources)
+			for (j = 0; j < graph->sources->rnum; j++)
+			{
+				ccv_nnc_graph_exec_symbol_t* const source = (ccv_nnc_graph_exec_symbol_t*)ccv_array_get(graph->sources, j);
+				if (source->d == idx)
+				{
+					*source = quantize_a;
+					if (quantize_w.d != CCV_NNC_NO_GRAPH_EXEC_SYMBOL)
+						ccv_nnc_symbolic_graph_add_source(graph, quantize_w);
+					break;
+				}
+			}
+	}
+}
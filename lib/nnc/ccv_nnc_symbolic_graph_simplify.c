@@ -551,116 +551,508 @@ static void _ccv_nnc_symbolic_graph_data_transfer_opt(ccv_nnc_symbolic_graph_sim
 }
 
 typedef struct {
-	uint32_t fused_op; // The final fused op id.
-	uint32_t ops_seq[2]; // The sequence of commands to identify.
+	uint32_t ops_seq[CCV_NNC_OPS_FUSION_MAX_SEQ]; // The sequence of commands to identify.
 	int ops_seq_size;
-	int ops_info_select; // Which ops' info will be selected.
-	struct {
-		int type; // Whether it is input, or output. It doesn't make sense for example, input in ops_seq, but output in fused_op.
-		int op_idx; // Index into the ops_seq.
-		int from; // The index in ops_seq.
-		int to; // The index in fused_op.
-	} pos[4]; // maps of positions from ops seq to fused_op for inputs (outputs).
-	int pos_size;
+	ccv_nnc_ops_fusion_f fusion; // Build the fused command from the matched nodes, or reject the match.
 } ccv_nnc_ops_fusion_t;
 
-enum {
-	CCV_NNC_OPS_FUSION_INPUT_INDEX,
-	CCV_NNC_OPS_FUSION_OUTPUT_INDEX,
-};
+// Matches any command in ops_seq, the fusion function checks what it is. Only used by the built-in patterns.
+#define CCV_NNC_OPS_FUSION_ANY_OP (0xffffffff)
+#define CCV_NNC_OPS_FUSION_MAX_REGISTERED (64)
+
+static ccv_nnc_ops_fusion_t ccv_nnc_registered_ops_fusions[CCV_NNC_OPS_FUSION_MAX_REGISTERED];
+static int ccv_nnc_registered_ops_fusion_size = 0;
+
+void ccv_nnc_ops_fusion_register(const uint32_t* const ops_seq, const int ops_seq_size, const ccv_nnc_ops_fusion_f fusion)
+{
+	assert(ops_seq_size >= 2 && ops_seq_size <= CCV_NNC_OPS_FUSION_MAX_SEQ);
+	assert(ccv_nnc_registered_ops_fusion_size < CCV_NNC_OPS_FUSION_MAX_REGISTERED);
+	ccv_nnc_ops_fusion_t* const ops_fusion = ccv_nnc_registered_ops_fusions + ccv_nnc_registered_ops_fusion_size;
+	memcpy(ops_fusion->ops_seq, ops_seq, sizeof(uint32_t) * ops_seq_size);
+	ops_fusion->ops_seq_size = ops_seq_size;
+	ops_fusion->fusion = fusion;
+	++ccv_nnc_registered_ops_fusion_size;
+}
+
+static int _ccv_nnc_ops_fusion_io(const ccv_nnc_symbolic_graph_t* const graph, const int* const io, const int io_size, ccv_nnc_tensor_symbol_t* const symbols)
+{
+	int i;
+	for (i = 0; i < io_size; i++)
+		symbols[i] = (ccv_nnc_tensor_symbol_t){
+			.d = io[i],
+			.graph = io[i] >= 0 ? graph : 0,
+		};
+	return io_size;
+}
+
+static int _ccv_nnc_ops_fusion_crossentropy(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_t* const execs, const int exec_size, ccv_nnc_cmd_t* const cmd, ccv_nnc_hint_t* const hint, ccv_nnc_tensor_symbol_t* const inputs, int* const input_size, ccv_nnc_tensor_symbol_t* const outputs, int* const output_size)
+{
+	const int* act_inputs;
+	int act_input_size;
+	const int* act_outputs;
+	int act_output_size;
+	ccv_nnc_graph_exec_symbol_io(graph, execs[0], &act_inputs, &act_input_size, &act_outputs, &act_output_size);
+	const int* loss_inputs;
+	int loss_input_size;
+	const int* loss_outputs;
+	int loss_output_size;
+	ccv_nnc_graph_exec_symbol_io(graph, execs[1], &loss_inputs, &loss_input_size, &loss_outputs, &loss_output_size);
+	if (act_input_size < 1 || act_output_size < 1 || loss_input_size < 2 || loss_output_size < 1 || loss_inputs[0] != act_outputs[0])
+		return 0;
+	// Takes the activation input and the labels, outputs the loss, and the activation output the backward pass needs.
+	*cmd = ccv_nnc_cmd(cmd->cmd == CCV_NNC_SOFTMAX_FORWARD ? CCV_NNC_SOFTMAX_CROSSENTROPY_FORWARD : CCV_NNC_SIGMOID_BINARY_CROSSENTROPY_FORWARD, 0, ccv_nnc_graph_exec_symbol_cmd(graph, execs[1]).info, 0);
+	*input_size = _ccv_nnc_ops_fusion_io(graph, act_inputs, 1, inputs);
+	*input_size += _ccv_nnc_ops_fusion_io(graph, loss_inputs + 1, 1, inputs + 1);
+	*output_size = _ccv_nnc_ops_fusion_io(graph, loss_outputs, 1, outputs);
+	*output_size += _ccv_nnc_ops_fusion_io(graph, act_outputs, 1, outputs + 1);
+	return 1;
+}
 
-const static int ccv_nnc_ops_fusion_io_size = 2;
-const static ccv_nnc_ops_fusion_t ccv_nnc_ops_fusions[] = {
+static int _ccv_nnc_ops_fusion_bias(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_t* const execs, const int exec_size, ccv_nnc_cmd_t* const cmd, ccv_nnc_hint_t* const hint, ccv_nnc_tensor_symbol_t* const inputs, int* const input_size, ccv_nnc_tensor_symbol_t* const outputs, int* const output_size)
+{
+	if ((cmd->cmd != CCV_NNC_CONVOLUTION_FORWARD && cmd->cmd != CCV_NNC_GEMM_FORWARD) || cmd->info.activation.type != CCV_NNC_ACTIVATION_NONE)
+		return 0;
+	const int* mul_inputs;
+	int mul_input_size;
+	const int* mul_outputs;
+	int mul_output_size;
+	ccv_nnc_graph_exec_symbol_io(graph, execs[0], &mul_inputs, &mul_input_size, &mul_outputs, &mul_output_size);
+	// Only if it doesn't have a bias yet.
+	if (mul_input_size < 2 || (mul_input_size > 2 && mul_inputs[2] >= 0) || mul_output_size != 1)
+		return 0;
+	const ccv_nnc_cmd_t add = ccv_nnc_graph_exec_symbol_cmd(graph, execs[1]);
+	if (add.info.blas.a[0] != 1 || add.info.blas.a[1] != 1)
+		return 0;
+	const int* add_inputs;
+	int add_input_size;
+	const int* add_outputs;
+	int add_output_size;
+	ccv_nnc_graph_exec_symbol_io(graph, execs[1], &add_inputs, &add_input_size, &add_outputs, &add_output_size);
+	if (add_input_size != 2 || add_output_size != 1 || add_outputs[0] < 0 || add_inputs[0] == add_inputs[1])
+		return 0;
+	const ccv_nnc_tensor_symbol_t bias = {
+		.d = add_inputs[0] == mul_outputs[0] ? add_inputs[1] : add_inputs[0],
+		.graph = graph,
+	};
+	if (bias.d < 0 || ccv_nnc_tensor_symbol_alias_to(graph, bias).d != CCV_NNC_NO_TENSOR_SYMBOL)
+		return 0;
+	// The bias has to be a vector that broadcasts along the output channels, which are the last axis.
+	const ccv_nnc_tensor_param_t y_params = ccv_nnc_tensor_symbol_params(graph, (ccv_nnc_tensor_symbol_t){
+		.d = mul_outputs[0],
+		.graph = graph,
+	});
+	const ccv_nnc_tensor_param_t z_params = ccv_nnc_tensor_symbol_params(graph, (ccv_nnc_tensor_symbol_t){
+		.d = add_outputs[0],
+		.graph = graph,
+	});
+	const ccv_nnc_tensor_param_t bias_params = ccv_nnc_tensor_symbol_params(graph, bias);
+	const int y_nd = ccv_nnc_tensor_nd(y_params.dim);
+	if (y_nd < 1 || ccv_nnc_tensor_nd(bias_params.dim) != 1 || bias_params.dim[0] != y_params.dim[y_nd - 1] ||
+		bias_params.datatype != y_params.datatype || memcmp(z_params.dim, y_params.dim, sizeof(y_params.dim)) != 0)
+		return 0;
+	if (cmd->cmd == CCV_NNC_CONVOLUTION_FORWARD && y_params.format != CCV_TENSOR_FORMAT_NHWC)
+		return 0;
+	*input_size = _ccv_nnc_ops_fusion_io(graph, mul_inputs, 2, inputs);
+	inputs[(*input_size)++] = bias;
+	*output_size = _ccv_nnc_ops_fusion_io(graph, add_outputs, 1, outputs);
+	return 1;
+}
+
+static int _ccv_nnc_ops_fusion_activation(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_t* const execs, const int exec_size, ccv_nnc_cmd_t* const cmd, ccv_nnc_hint_t* const hint, ccv_nnc_tensor_symbol_t* const inputs, int* const input_size, ccv_nnc_tensor_symbol_t* const outputs, int* const output_size)
+{
+	switch (cmd->cmd)
+	{
+		case CCV_NNC_CONVOLUTION_FORWARD:
+		case CCV_NNC_GEMM_FORWARD:
+		case CCV_NNC_BATCH_NORM_FORWARD:
+		case CCV_NNC_EWSUM_FORWARD:
+		case CCV_NNC_EWPROD_FORWARD:
+		case CCV_NNC_ADD_FORWARD:
+		case CCV_NNC_MUL_FORWARD:
+			break;
+		default:
+			return 0;
+	}
+	if (cmd->info.activation.type != CCV_NNC_ACTIVATION_NONE)
+		return 0;
+	const int* x_inputs;
+	int x_input_size;
+	const int* x_outputs;
+	int x_output_size;
+	ccv_nnc_graph_exec_symbol_io(graph, execs[0], &x_inputs, &x_input_size, &x_outputs, &x_output_size);
+	const int* act_inputs;
+	int act_input_size;
+	const int* act_outputs;
+	int act_output_size;
+	ccv_nnc_graph_exec_symbol_io(graph, execs[1], &act_inputs, &act_input_size, &act_outputs, &act_output_size);
+	if (act_input_size != 1 || act_output_size != 1 || act_outputs[0] < 0)
+		return 0;
+	const ccv_nnc_tensor_symbol_t y = {
+		.d = act_outputs[0],
+		.graph = graph,
+	};
+	// The command writes into the activation output directly now, keep it simple for the kernels, no views.
+	if (ccv_nnc_tensor_symbol_alias_to(graph, y).d != CCV_NNC_NO_TENSOR_SYMBOL)
+		return 0;
+	const ccv_nnc_tensor_param_t x_params = ccv_nnc_tensor_symbol_params(graph, (ccv_nnc_tensor_symbol_t){
+		.d = x_outputs[0],
+		.graph = graph,
+	});
+	const ccv_nnc_tensor_param_t y_params = ccv_nnc_tensor_symbol_params(graph, y);
+	// The kernels only fuse the activation for full precision.
+	if (x_params.datatype != CCV_32F || y_params.datatype != CCV_32F || memcmp(x_params.dim, y_params.dim, sizeof(x_params.dim)) != 0)
+		return 0;
+	switch (ccv_nnc_graph_exec_symbol_cmd(graph, execs[1]).cmd)
+	{
+		case CCV_NNC_RELU_FORWARD:
+			cmd->info.activation.type = CCV_NNC_ACTIVATION_RELU;
+			break;
+		case CCV_NNC_SIGMOID_FORWARD:
+			cmd->info.activation.type = CCV_NNC_ACTIVATION_SIGMOID;
+			break;
+		case CCV_NNC_TANH_FORWARD:
+			cmd->info.activation.type = CCV_NNC_ACTIVATION_TANH;
+			break;
+		case CCV_NNC_SWISH_FORWARD:
+			cmd->info.activation.type = CCV_NNC_ACTIVATION_SWISH;
+			break;
+		default:
+			return 0;
+	}
+	*input_size = _ccv_nnc_ops_fusion_io(graph, x_inputs, x_input_size, inputs);
+	*output_size = _ccv_nnc_ops_fusion_io(graph, x_outputs, x_output_size, outputs);
+	outputs[0] = y;
+	return 1;
+}
+
+// Whether it is a plain n-ary elementwise sum (or product) with all inputs in the shape of the output.
+static int _ccv_nnc_ops_fusion_is_ew(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_t exec, const uint32_t ew, const uint32_t blas, const int** const inputs, int* const input_size, const int** const outputs)
+{
+	const ccv_nnc_cmd_t cmd = ccv_nnc_graph_exec_symbol_cmd(graph, exec);
+	if (cmd.info.activation.type != CCV_NNC_ACTIVATION_NONE)
+		return 0;
+	if (cmd.cmd == blas && (cmd.info.blas.a[0] != 1 || (blas == CCV_NNC_ADD_FORWARD && cmd.info.blas.a[1] != 1)))
+		return 0;
+	if (cmd.cmd != ew && cmd.cmd != blas)
+		return 0;
+	int output_size;
+	ccv_nnc_graph_exec_symbol_io(graph, exec, inputs, input_size, outputs, &output_size);
+	if (output_size != 1 || (*outputs)[0] < 0)
+		return 0;
+	const ccv_nnc_tensor_param_t params = ccv_nnc_tensor_symbol_params(graph, (ccv_nnc_tensor_symbol_t){
+		.d = (*outputs)[0],
+		.graph = graph,
+	});
+	if (ccv_nnc_tensor_nd(params.dim) < 1)
+		return 0;
+	int i;
+	for (i = 0; i < *input_size; i++)
+	{
+		if ((*inputs)[i] < 0)
+			return 0;
+		const ccv_nnc_tensor_param_t input_params = ccv_nnc_tensor_symbol_params(graph, (ccv_nnc_tensor_symbol_t){
+			.d = (*inputs)[i],
+			.graph = graph,
+		});
+		if (memcmp(input_params.dim, params.dim, sizeof(params.dim)) != 0)
+			return 0;
+	}
+	return 1;
+}
+
+static int _ccv_nnc_ops_fusion_ew(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_t* const execs, const int exec_size, ccv_nnc_cmd_t* const cmd, ccv_nnc_hint_t* const hint, ccv_nnc_tensor_symbol_t* const inputs, int* const input_size, ccv_nnc_tensor_symbol_t* const outputs, int* const output_size)
+{
+	const int sum = (cmd->cmd == CCV_NNC_EWSUM_FORWARD || cmd->cmd == CCV_NNC_ADD_FORWARD);
+	const uint32_t ew = sum ? CCV_NNC_EWSUM_FORWARD : CCV_NNC_EWPROD_FORWARD;
+	const uint32_t blas = sum ? CCV_NNC_ADD_FORWARD : CCV_NNC_MUL_FORWARD;
+	const int* a_inputs;
+	int a_input_size;
+	const int* a_outputs;
+	const int* b_inputs;
+	int b_input_size;
+	const int* b_outputs;
+	if (!_ccv_nnc_ops_fusion_is_ew(graph, execs[0], ew, blas, &a_inputs, &a_input_size, &a_outputs) ||
+		!_ccv_nnc_ops_fusion_is_ew(graph, execs[1], ew, blas, &b_inputs, &b_input_size, &b_outputs))
+		return 0;
+	// The intermediate result is replaced by the inputs that make it, this only works if it is used once.
+	int i, j = -1;
+	for (i = 0; i < b_input_size; i++)
+		if (b_inputs[i] == a_outputs[0])
+		{
+			if (j >= 0)
+				return 0;
+			j = i;
+		}
+	assert(j >= 0);
+	*cmd = ccv_nnc_cmd(ew, 0, ccv_nnc_cmd_auto, 0);
+	*hint = ccv_nnc_no_hint;
+	*input_size = _ccv_nnc_ops_fusion_io(graph, b_inputs, j, inputs);
+	*input_size += _ccv_nnc_ops_fusion_io(graph, a_inputs, a_input_size, inputs + *input_size);
+	*input_size += _ccv_nnc_ops_fusion_io(graph, b_inputs + j + 1, b_input_size - j - 1, inputs + *input_size);
+	*output_size = _ccv_nnc_ops_fusion_io(graph, b_outputs, 1, outputs);
+	return 1;
+}
+
+static const ccv_nnc_ops_fusion_t ccv_nnc_ops_fusions[] = {
 	{
-		.fused_op = CCV_NNC_SOFTMAX_CROSSENTROPY_FORWARD,
 		.ops_seq = {
 			CCV_NNC_SOFTMAX_FORWARD, CCV_NNC_CATEGORICAL_CROSSENTROPY_FORWARD,
 		},
 		.ops_seq_size = 2,
-		.ops_info_select = 1,
-		.pos = {
-			{
-				.type = CCV_NNC_OPS_FUSION_INPUT_INDEX,
-				.op_idx = 0,
-				.from = 0,
-				.to = 0,
-			},
-			{
-				.type = CCV_NNC_OPS_FUSION_INPUT_INDEX,
-				.op_idx = 1,
-				.from = 1,
-				.to = 1,
-			},
-			{
-				.type = CCV_NNC_OPS_FUSION_OUTPUT_INDEX,
-				.op_idx = 0,
-				.from = 0,
-				.to = 1,
-			},
-			{
-				.type = CCV_NNC_OPS_FUSION_OUTPUT_INDEX,
-				.op_idx = 1,
-				.from = 0,
-				.to = 0,
-			},
-		},
-		.pos_size = 4,
+		.fusion = _ccv_nnc_ops_fusion_crossentropy,
 	},
 	{
-		.fused_op = CCV_NNC_SIGMOID_BINARY_CROSSENTROPY_FORWARD,
 		.ops_seq = {
 			CCV_NNC_SIGMOID_FORWARD, CCV_NNC_BINARY_CROSSENTROPY_FORWARD,
 		},
 		.ops_seq_size = 2,
-		.ops_info_select = 1,
-		.pos = {
-			{
-				.type = CCV_NNC_OPS_FUSION_INPUT_INDEX,
-				.op_idx = 0,
-				.from = 0,
-				.to = 0,
-			},
-			{
-				.type = CCV_NNC_OPS_FUSION_INPUT_INDEX,
-				.op_idx = 1,
-				.from = 1,
-				.to = 1,
-			},
-			{
-				.type = CCV_NNC_OPS_FUSION_OUTPUT_INDEX,
-				.op_idx = 0,
-				.from = 0,
-				.to = 1,
-			},
-			{
-				.type = CCV_NNC_OPS_FUSION_OUTPUT_INDEX,
-				.op_idx = 1,
-				.from = 0,
-				.to = 0,
-			},
+		.fusion = _ccv_nnc_ops_fusion_crossentropy,
+	},
+	{
+		.ops_seq = {
+			CCV_NNC_CONVOLUTION_FORWARD, CCV_NNC_ADD_FORWARD,
 		},
-		.pos_size = 4,
-	}
+		.ops_seq_size = 2,
+		.fusion = _ccv_nnc_ops_fusion_bias,
+	},
+	{
+		.ops_seq = {
+			CCV_NNC_GEMM_FORWARD, CCV_NNC_ADD_FORWARD,
+		},
+		.ops_seq_size = 2,
+		.fusion = _ccv_nnc_ops_fusion_bias,
+	},
+	{
+		.ops_seq = {
+			CCV_NNC_OPS_FUSION_ANY_OP, CCV_NNC_OPS_FUSION_ANY_OP,
+		},
+		.ops_seq_size = 2,
+		.fusion = _ccv_nnc_ops_fusion_ew,
+	},
+	{
+		.ops_seq = {
+			CCV_NNC_OPS_FUSION_ANY_OP, CCV_NNC_RELU_FORWARD,
+		},
+		.ops_seq_size = 2,
+		.fusion = _ccv_nnc_ops_fusion_activation,
+	},
+	{
+		.ops_seq = {
+			CCV_NNC_OPS_FUSION_ANY_OP, CCV_NNC_SIGMOID_FORWARD,
+		},
+		.ops_seq_size = 2,
+		.fusion = _ccv_nnc_ops_fusion_activation,
+	},
+	{
+		.ops_seq = {
+			CCV_NNC_OPS_FUSION_ANY_OP, CCV_NNC_TANH_FORWARD,
+		},
+		.ops_seq_size = 2,
+		.fusion = _ccv_nnc_ops_fusion_activation,
+	},
+	{
+		.ops_seq = {
+			CCV_NNC_OPS_FUSION_ANY_OP, CCV_NNC_SWISH_FORWARD,
+		},
+		.ops_seq_size = 2,
+		.fusion = _ccv_nnc_ops_fusion_activation,
+	},
 };
 
-static int _ccv_nnc_find_ops_for_fusion(const ccv_nnc_ops_fusion_t* const fusion, const int ops_idx, const ccv_nnc_graph_exec_symbol_info_t* const exec_symbol_info, const uint32_t* const exec_dead, const int exec_idx, int* const fusing_exec_symbols)
+static int _ccv_nnc_exec_symbol_reaches(const ccv_nnc_symbolic_graph_t* const graph, const int from, const int to)
+{
+	if (from == to)
+		return 1;
+	uint32_t* const visited = cccalloc((graph->exec_symbol_info->rnum + 31) >> 5, sizeof(uint32_t));
+	ccv_array_t* const stack = ccv_array_new(sizeof(int), 0, 0);
+	ccv_array_push(stack, &from);
+	visited[from >> 5] |= (1u << (from & 0x1f));
+	int reached = 0;
+	while (stack->rnum > 0 && !reached)
+	{
+		const int idx = *(int*)ccv_array_get(stack, stack->rnum - 1);
+		--stack->rnum;
+		const ccv_nnc_graph_exec_symbol_info_t* const node = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx);
+		if (!node->outgoings)
+			continue;
+		int i;
+		for (i = 0; i < node->outgoings->rnum && !reached; i++)
+		{
+			const int d = *(int*)ccv_array_get(node->outgoings, i);
+			if (d == to)
+				reached = 1;
+			else if (!(visited[d >> 5] & (1u << (d & 0x1f)))) {
+				visited[d >> 5] |= (1u << (d & 0x1f));
+				ccv_array_push(stack, &d);
+			}
+		}
+	}
+	ccv_array_free(stack);
+	ccfree(visited);
+	return reached;
+}
+
+static int _ccv_nnc_ops_fusion_has_tensor(const ccv_nnc_tensor_symbol_t* const symbols, const int symbol_size, const int d)
 {
-	if (exec_dead[exec_idx >> 5] & (1u << (exec_idx & 0x1f)))
+	int i;
+	for (i = 0; i < symbol_size; i++)
+		if (symbols[i].d == d)
+			return 1;
+	return 0;
+}
+
+static int _ccv_nnc_ops_fusion_has_exec(const int* const execs, const int exec_size, const int d)
+{
+	int i;
+	for (i = 0; i < exec_size; i++)
+		if (execs[i] == d)
+			return 1;
+	return 0;
+}
+
+static int _ccv_nnc_ops_fusion_apply(ccv_nnc_symbolic_graph_simplify_t* const simplify, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const ccv_nnc_ops_fusion_t* const ops_fusion, const int* const fusing_exec_symbols)
+{
+	ccv_nnc_symbolic_graph_t* const graph = simplify->graph;
+	const int exec_size = ops_fusion->ops_seq_size;
+	ccv_nnc_graph_exec_symbol_t execs[CCV_NNC_OPS_FUSION_MAX_SEQ];
+	int i, j, k;
+	int max_input_size = 0, max_output_size = 0;
+	for (i = 0; i < exec_size; i++)
+	{
+		execs[i] = (ccv_nnc_graph_exec_symbol_t){
+			.d = fusing_exec_symbols[i],
+			.graph = graph,
+		};
+		max_input_size += simplify->exec_symbol_info[fusing_exec_symbols[i]].input_size;
+		max_output_size += simplify->exec_symbol_info[fusing_exec_symbols[i]].output_size;
+	}
+	const ccv_nnc_graph_exec_symbol_info_t* const first = simplify->exec_symbol_info + fusing_exec_symbols[0];
+	ccv_nnc_cmd_t cmd = first->cmd;
+	ccv_nnc_hint_t hint = first->hint;
+	ccv_nnc_tensor_symbol_t fused_inputs[ccv_max(1, max_input_size)];
+	ccv_nnc_tensor_symbol_t fused_outputs[ccv_max(1, max_output_size)];
+	int fused_input_size = max_input_size, fused_output_size = max_output_size;
+	if (!ops_fusion->fusion(graph, execs, exec_size, &cmd, &hint, fused_inputs, &fused_input_size, fused_outputs, &fused_output_size))
+		return 0;
+	assert(fused_input_size <= max_input_size && fused_output_size <= max_output_size);
+	// The fused command cannot read what the fused nodes write.
+	for (i = 0; i < fused_input_size; i++)
+		if (fused_inputs[i].d >= 0 && _ccv_nnc_ops_fusion_has_exec(fusing_exec_symbols, exec_size, simplify->output_execs[fused_inputs[i].d]))
+			return 0;
+	// Whatever the fused command doesn't write will be gone, thus, it cannot be an output, be aliased, or be read by anyone else.
+	for (i = 0; i < exec_size; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_info_t* const node = simplify->exec_symbol_info + fusing_exec_symbols[i];
+		for (j = 0; j < node->output_size; j++)
+		{
+			const int d = node->outputs[j];
+			if (d < 0 || _ccv_nnc_ops_fusion_has_tensor(fused_outputs, fused_output_size, d))
+				continue;
+			for (k = 0; k < output_size; k++)
+				if (outputs[k].d == d)
+					return 0;
+			if (simplify->tensor_symbol_info[d].alias_ref)
+				return 0;
+			for (k = 0; k < simplify->tensor_symbol_info_size; k++)
+				if (simplify->tensor_symbol_info[k].alias_ref == d + 1)
+					return 0;
+			ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, other, idx) {
+				if ((simplify->exec_dead[idx >> 5] & (1u << (idx & 0x1f))) || _ccv_nnc_ops_fusion_has_exec(fusing_exec_symbols, exec_size, idx))
+					continue;
+				for (k = 0; k < other->input_size; k++)
+					if (other->inputs[k] == d)
+						return 0;
+			} ccv_nnc_graph_visit_endfor
+		}
+	}
+	// The fused command takes the place of the first node, thus, the others' inputs have to be ready by then. Anyone
+	// (the caller included) who holds the first node stays valid.
+	const int first_idx = fusing_exec_symbols[0];
+	for (i = 0; i < fused_input_size; i++)
+	{
+		const int d = fused_inputs[i].d;
+		if (d < 0 || simplify->output_execs[d] < 0)
+			continue;
+		for (j = 0; j < first->input_size; j++)
+			if (first->inputs[j] == d)
+				break;
+		if (j == first->input_size && !_ccv_nnc_exec_symbol_reaches(graph, simplify->output_execs[d], first_idx))
+			return 0;
+	}
+	const ccv_nnc_graph_exec_symbol_t fused_exec = execs[0];
+	// Mark the rest as dead, with what they write but the fused command doesn't. Whoever comes after them now comes
+	// after the fused command, thus, it can be fused again with these.
+	for (i = 0; i < exec_size; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_info_t* const node = simplify->exec_symbol_info + fusing_exec_symbols[i];
+		for (j = 0; j < node->output_size; j++)
+		{
+			const int d = node->outputs[j];
+			if (d >= 0 && !_ccv_nnc_ops_fusion_has_tensor(fused_outputs, fused_output_size, d))
+			{
+				simplify->output_execs[d] = -1;
+				simplify->tensor_dead[d >> 5] |= (1u << (d & 0x1f));
+			}
+		}
+		if (i == 0)
+			continue;
+		simplify->exec_dead[fusing_exec_symbols[i] >> 5] |= (1u << (fusing_exec_symbols[i] & 0x1f));
+		if (node->outgoings)
+			for (j = 0; j < node->outgoings->rnum; j++)
+			{
+				const int d = *(int*)ccv_array_get(node->outgoings, j);
+				if (!_ccv_nnc_ops_fusion_has_exec(fusing_exec_symbols, exec_size, d))
+					ccv_nnc_graph_exec_symbol_concat(graph, fused_exec, (ccv_nnc_graph_exec_symbol_t){
+						.d = d,
+						.graph = graph,
+					});
+			}
+	}
+	// Set the io last, the inputs / outputs of the first node may be reallocated.
+	const int first_cmd = first->cmd.cmd;
+	ccv_nnc_graph_exec_symbol_set(graph, fused_exec, cmd); // Set before the io, thus, the backend is found for the fused command.
+	ccv_nnc_graph_exec_symbol_set_io(graph, fused_exec, fused_inputs, fused_input_size, fused_outputs, fused_output_size);
+	if (cmd.cmd == first_cmd)
+		ccv_nnc_graph_exec_symbol_set(graph, fused_exec, cmd); // Set again to keep the backend / algorithm of the first command.
+	ccv_nnc_graph_exec_symbol_set_hint(graph, fused_exec, hint);
+	// Keep the copy in sync.
+	simplify->exec_symbol_info[first_idx] = *(ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, first_idx);
+	for (i = 0; i < fused_output_size; i++)
+		if (fused_outputs[i].d >= 0)
+			simplify->output_execs[fused_outputs[i].d] = first_idx;
+	return 1;
+}
+
+static int _ccv_nnc_find_ops_for_fusion(ccv_nnc_symbolic_graph_simplify_t* const simplify, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const ccv_nnc_ops_fusion_t* const fusion, const int ops_idx, const int exec_idx, int* const fusing_exec_symbols)
+{
+	if (simplify->exec_dead[exec_idx >> 5] & (1u << (exec_idx & 0x1f)))
 		return 0;
-	const ccv_nnc_graph_exec_symbol_info_t* const node = exec_symbol_info + exec_idx;
+	const ccv_nnc_graph_exec_symbol_info_t* const node = simplify->exec_symbol_info + exec_idx;
 	// Doesn't match the ops_seq, return 0.
-	if (fusion->ops_seq[ops_idx] != node->cmd.cmd)
+	if (fusion->ops_seq[ops_idx] != CCV_NNC_OPS_FUSION_ANY_OP && fusion->ops_seq[ops_idx] != node->cmd.cmd)
 		return 0;
+	int i;
+	// Each command reads the first output of the command before.
+	if (ops_idx > 0)
+	{
+		const ccv_nnc_graph_exec_symbol_info_t* const prev = simplify->exec_symbol_info + fusing_exec_symbols[ops_idx - 1];
+		if (prev->output_size < 1 || prev->outputs[0] < 0)
+			return 0;
+		for (i = 0; i < node->input_size; i++)
+			if (node->inputs[i] == prev->outputs[0])
+				break;
+		if (i == node->input_size)
+			return 0;
+	}
 	fusing_exec_symbols[ops_idx] = exec_idx;
-	// If already reached the end, we are good.
+	// If already reached the end, try to fuse these.
 	if (ops_idx == fusion->ops_seq_size - 1)
-		return 1;
+		return _ccv_nnc_ops_fusion_apply(simplify, outputs, output_size, fusion, fusing_exec_symbols);
 	// Otherwise, we need to go on, but don't have any to follow-up.
 	if (!node->outgoings || !node->outgoings->rnum)
 		return 0;
-	int i;
 	for (i = 0; i < node->outgoings->rnum; i++)
-		if (_ccv_nnc_find_ops_for_fusion(fusion, ops_idx + 1, exec_symbol_info, exec_dead, *(int*)ccv_array_get(node->outgoings, i), fusing_exec_symbols))
+		if (_ccv_nnc_find_ops_for_fusion(simplify, outputs, output_size, fusion, ops_idx + 1, *(int*)ccv_array_get(node->outgoings, i), fusing_exec_symbols))
 			return 1;
 	return 0;
 }
@@ -668,64 +1060,952 @@ static int _ccv_nnc_find_ops_for_fusion(const ccv_nnc_ops_fusion_t* const fusion
 static void _ccv_nnc_symbolic_graph_ops_fusion(ccv_nnc_symbolic_graph_simplify_t* const simplify, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size)
 {
 	uint32_t* const exec_dead = simplify->exec_dead;
-	ccv_nnc_graph_exec_symbol_info_t* const exec_symbol_info = simplify->exec_symbol_info;
-	int i, j;
-	int fusing_exec_symbols[sizeof(ccv_nnc_ops_fusions->ops_seq)];
-	int fused_inputs[ccv_nnc_ops_fusion_io_size]; // 2 is just a number based on the ops_fusion.
-	int fused_outputs[ccv_nnc_ops_fusion_io_size];
-	ccv_nnc_graph_visit_for(simplify->visit, exec_symbol_info, node, idx) {
+	int i;
+	int fusing_exec_symbols[CCV_NNC_OPS_FUSION_MAX_SEQ];
+	_ccv_nnc_symbolic_graph_simplify_update_output_execs(simplify);
+	ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
 		// If already marked as dead, skip.
 		if (exec_dead[idx >> 5] & (1u << (idx & 0x1f)))
 			continue;
-		// Run through rudimentary pattern matching for ops_seq. There are better ways to do this (immediately come to mind, Boyer-Moore). However, this is simpler to code.
-		// If I am running into performance issues with this, I would be very happy.
-		for (i = 0; i < sizeof(ccv_nnc_ops_fusions) / sizeof(ccv_nnc_ops_fusion_t); i++)
-		{
-			const ccv_nnc_ops_fusion_t* const ops_fusion = ccv_nnc_ops_fusions + i;
-			// Check to see if a list of symbols are possible.
-			if (ops_fusion->ops_seq[0] == node->cmd.cmd &&
-				_ccv_nnc_find_ops_for_fusion(ops_fusion, 0, exec_symbol_info, exec_dead, idx, fusing_exec_symbols))
-			{
-				// Go through all the inputs and outputs, check if they exists and are mapped.
-				// TODO: the mapping can be more sophisticated than what we have here.
-				// Also, I need to check if some inputs / outputs cannot be mapped, then we cannot continue.
-				for (j = 0; j < ccv_nnc_ops_fusion_io_size; j++)
-					fused_inputs[j] = fused_outputs[j] = CCV_NNC_NO_TENSOR_SYMBOL;
-				int input_size = 0, output_size = 0;
-				for (j = 0; j < ops_fusion->pos_size; j++)
+		// Match the patterns from this node along its outgoing nodes. The fused command replaces this node, thus, keep
+		// matching until nothing can be fused with it any more.
+		int fused;
+		do {
+			fused = 0;
+			for (i = 0; !fused && i < ccv_nnc_registered_ops_fusion_size; i++)
+				fused = _ccv_nnc_find_ops_for_fusion(simplify, outputs, output_size, ccv_nnc_registered_ops_fusions + i, 0, idx, fusing_exec_symbols);
+			for (i = 0; !fused && i < sizeof(ccv_nnc_ops_fusions) / sizeof(ccv_nnc_ops_fusion_t); i++)
+				fused = _ccv_nnc_find_ops_for_fusion(simplify, outputs, output_size, ccv_nnc_ops_fusions + i, 0, idx, fusing_exec_symbols);
+		} while (fused);
+	} ccv_nnc_graph_visit_endfor
+}
+
+static int _ccv_nnc_tensor_symbol_channel_axis(const ccv_nnc_tensor_param_t params)
+{
+	const int nd = ccv_nnc_tensor_nd(params.dim);
+	switch (params.format)
+	{
+		case CCV_TENSOR_FORMAT_NHWC:
+			return nd - 1;
+		case CCV_TENSOR_FORMAT_NCHW:
+			return nd >= 3 ? nd - 3 : nd - 1;
+		case CCV_TENSOR_FORMAT_CHWN:
+			return 0;
+	}
+	return -1;
+}
+
+static int _ccv_nnc_batch_norm_folding_match(ccv_nnc_symbolic_graph_simplify_t* const simplify, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const int bn_idx)
+{
+	const ccv_nnc_graph_exec_symbol_info_t* const bn = simplify->exec_symbol_info + bn_idx;
+	// Only inference-mode batch norm, and nothing but the normalized output is used.
+	if (bn->cmd.cmd != CCV_NNC_BATCH_NORM_FORWARD || !bn->cmd.info.bnorm.is_test || bn->input_size != 5 || bn->output_size < 1 || bn->outputs[0] < 0)
+		return -1;
+	int i, j;
+	for (i = 0; i < 5; i++)
+		if (bn->inputs[i] < 0)
+			return -1;
+	for (i = 1; i < bn->output_size; i++)
+		if (bn->outputs[i] >= 0)
+			return -1;
+	const int y = bn->inputs[0];
+	const int conv_idx = simplify->output_execs[y];
+	if (conv_idx < 0)
+		return -1;
+	const ccv_nnc_graph_exec_symbol_info_t* const conv = simplify->exec_symbol_info + conv_idx;
+	if (conv->cmd.cmd != CCV_NNC_CONVOLUTION_FORWARD || conv->input_size < 2 || conv->output_size != 1 || conv->outputs[0] != y || conv->inputs[0] < 0 || conv->inputs[1] < 0)
+		return -1;
+	// With an activation fused in (from ops fusion), the batch norm applies after the activation and cannot be folded.
+	if (conv->cmd.info.activation.type != CCV_NNC_ACTIVATION_NONE)
+		return -1;
+	// The intermediate result will be gone, thus, it cannot be an output, be aliased, or be read by anyone else.
+	for (i = 0; i < output_size; i++)
+		if (outputs[i].d == y)
+			return -1;
+	if (simplify->tensor_symbol_info[y].alias_ref)
+		return -1;
+	for (i = 0; i < simplify->tensor_symbol_info_size; i++)
+		if (simplify->tensor_symbol_info[i].alias_ref == y + 1)
+			return -1;
+	ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+		if (idx == bn_idx || (simplify->exec_dead[idx >> 5] & (1u << (idx & 0x1f))))
+			continue;
+		for (j = 0; j < node->input_size; j++)
+			if (node->inputs[j] == y)
+				return -1;
+	} ccv_nnc_graph_visit_endfor
+	// The batch norm has to be per output channel of the convolution.
+	const int oc = simplify->tensor_symbol_info[conv->inputs[1]].info.dim[0];
+	const int channel_axis = _ccv_nnc_tensor_symbol_channel_axis(simplify->tensor_symbol_info[y].info);
+	if (channel_axis < 0)
+		return -1;
+	if (simplify->tensor_symbol_info[y].info.dim[channel_axis] != oc || bn->cmd.info.bnorm.count != ccv_nnc_tensor_nd(simplify->tensor_symbol_info[y].info.dim) - 1)
+		return -1;
+	for (i = 0; i < bn->cmd.info.bnorm.count; i++)
+		if (bn->cmd.info.bnorm.axis[i] == channel_axis)
+			return -1;
+	for (i = 1; i < 5; i++)
+		if (ccv_nnc_tensor_count(simplify->tensor_symbol_info[bn->inputs[i]].info) != oc)
+			return -1;
+	return conv_idx;
+}
+
+static void _ccv_nnc_symbolic_graph_batch_norm_folding(ccv_nnc_symbolic_graph_simplify_t* const simplify, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size)
+{
+	ccv_nnc_symbolic_graph_t* const graph = simplify->graph;
+	_ccv_nnc_symbolic_graph_simplify_update_output_execs(simplify);
+	ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+		if (simplify->exec_dead[idx >> 5] & (1u << (idx & 0x1f)))
+			continue;
+		const int conv_idx = _ccv_nnc_batch_norm_folding_match(simplify, outputs, output_size, idx);
+		if (conv_idx < 0)
+			continue;
+		const ccv_nnc_graph_exec_symbol_info_t conv = simplify->exec_symbol_info[conv_idx];
+		const ccv_nnc_graph_exec_symbol_info_t bn = *node;
+		const int y = bn.inputs[0];
+		const int oc = simplify->tensor_symbol_info[conv.inputs[1]].info.dim[0];
+		// With s = scale / (sqrt(var) + epsilon), matching the inference batch norm, conv(x, w, bias) * s + (beta - mean * s)
+		// is conv(x, w * s, bias * s + beta - mean * s). The new weights are computed on the graph from the parameters,
+		// which costs a pass over the weights rather than a pass over the activations.
+		const ccv_nnc_tensor_symbol_t x = { .d = conv.inputs[0], .graph = graph };
+		const ccv_nnc_tensor_symbol_t w = { .d = conv.inputs[1], .graph = graph };
+		const ccv_nnc_tensor_symbol_t bias = { .d = conv.input_size > 2 ? conv.inputs[2] : CCV_NNC_NO_TENSOR_SYMBOL, .graph = graph };
+		const ccv_nnc_tensor_symbol_t scale = { .d = bn.inputs[1], .graph = graph };
+		const ccv_nnc_tensor_symbol_t beta = { .d = bn.inputs[2], .graph = graph };
+		const ccv_nnc_tensor_symbol_t mean = { .d = bn.inputs[3], .graph = graph };
+		const ccv_nnc_tensor_symbol_t var = { .d = bn.inputs[4], .graph = graph };
+		const ccv_nnc_tensor_symbol_t z = { .d = bn.outputs[0], .graph = graph };
+		const ccv_nnc_tensor_param_t scale_params = simplify->tensor_symbol_info[bn.inputs[1]].info;
+		const ccv_nnc_tensor_param_t w_params = simplify->tensor_symbol_info[conv.inputs[1]].info;
+		ccv_nnc_tensor_param_t oc_params = scale_params;
+		memset(oc_params.dim, 0, sizeof(oc_params.dim));
+		oc_params.dim[0] = oc;
+		ccv_nnc_tensor_param_t sw_params = w_params;
+		int i;
+		for (i = 1; i < CCV_NNC_MAX_DIM_ALLOC && sw_params.dim[i]; i++)
+			sw_params.dim[i] = 1;
+		const ccv_nnc_tensor_symbol_t epsilon = ccv_nnc_tensor_symbol_new(graph, scale_params, 0);
+		const ccv_nnc_tensor_symbol_t std = ccv_nnc_tensor_symbol_new(graph, scale_params, 0);
+		const ccv_nnc_tensor_symbol_t std_epsilon = ccv_nnc_tensor_symbol_new(graph, scale_params, 0);
+		const ccv_nnc_tensor_symbol_t s = ccv_nnc_tensor_symbol_new(graph, scale_params, 0);
+		const ccv_nnc_tensor_symbol_t mean_s = ccv_nnc_tensor_symbol_new(graph, scale_params, 0);
+		const ccv_nnc_tensor_symbol_t shift = ccv_nnc_tensor_symbol_new(graph, scale_params, 0);
+		const ccv_nnc_tensor_symbol_t folded_w = ccv_nnc_tensor_symbol_new(graph, w_params, 0);
+		const ccv_nnc_tensor_symbol_t sw = ccv_nnc_tensor_symbol_alias_new(graph, s, ccv_nnc_no_ofs, sw_params.dim, sw_params, 0);
+		const ccv_nnc_tensor_symbol_t shift_oc = ccv_nnc_tensor_symbol_alias_new(graph, shift, ccv_nnc_no_ofs, oc_params.dim, oc_params, 0);
+		ccv_nnc_graph_exec_symbol_t folding[8];
+		int folding_size = 0;
+		folding[folding_size++] = ccv_nnc_graph_exec_symbol_new(graph, CMD_EWSQRT_FORWARD(), TENSOR_SYMBOL_LIST(var), TENSOR_SYMBOL_LIST(std), 0);
+		folding[folding_size++] = ccv_nnc_graph_exec_symbol_new(graph, CMD_EWSUM_FORWARD(), TENSOR_SYMBOL_LIST(std, epsilon), TENSOR_SYMBOL_LIST(std_epsilon), 0);
+		folding[folding_size++] = ccv_nnc_graph_exec_symbol_new(graph, CMD_EWDIV_FORWARD(), TENSOR_SYMBOL_LIST(scale, std_epsilon), TENSOR_SYMBOL_LIST(s), 0);
+		folding[folding_size++] = ccv_nnc_graph_exec_symbol_new(graph, CMD_MUL_FORWARD(1), TENSOR_SYMBOL_LIST(w, sw), TENSOR_SYMBOL_LIST(folded_w), 0);
+		folding[folding_size++] = ccv_nnc_graph_exec_symbol_new(graph, CMD_MUL_FORWARD(1), TENSOR_SYMBOL_LIST(mean, s), TENSOR_SYMBOL_LIST(mean_s), 0);
+		folding[folding_size++] = ccv_nnc_graph_exec_symbol_new(graph, CMD_ADD_FORWARD(1, -1), TENSOR_SYMBOL_LIST(beta, mean_s), TENSOR_SYMBOL_LIST(shift), 0);
+		ccv_nnc_tensor_symbol_t folded_bias = shift_oc;
+		if (bias.d >= 0)
+		{
+			const ccv_nnc_tensor_param_t bias_params = simplify->tensor_symbol_info[bias.d].info;
+			const ccv_nnc_tensor_symbol_t s_oc = ccv_nnc_tensor_symbol_alias_new(graph, s, ccv_nnc_no_ofs, oc_params.dim, oc_params, 0);
+			const ccv_nnc_tensor_symbol_t bias_s = ccv_nnc_tensor_symbol_new(graph, bias_params, 0);
+			folded_bias = ccv_nnc_tensor_symbol_new(graph, bias_params, 0);
+			folding[folding_size++] = ccv_nnc_graph_exec_symbol_new(graph, CMD_MUL_FORWARD(1), TENSOR_SYMBOL_LIST(bias, s_oc), TENSOR_SYMBOL_LIST(bias_s), 0);
+			folding[folding_size++] = ccv_nnc_graph_exec_symbol_new(graph, CMD_ADD_FORWARD(1, 1), TENSOR_SYMBOL_LIST(bias_s, shift_oc), TENSOR_SYMBOL_LIST(folded_bias), 0);
+		}
+		// Reuse the convolution node to fill in the epsilon, and the batch norm node to do the folded convolution,
+		// thus, the given sources / destinations still cover the rewritten graph.
+		const ccv_nnc_graph_exec_symbol_t conv_symbol = { .d = conv_idx, .graph = graph };
+		const ccv_nnc_graph_exec_symbol_t bn_symbol = { .d = idx, .graph = graph };
+		ccv_nnc_graph_exec_symbol_set(graph, conv_symbol, CMD_SET_FORWARD(bn.cmd.info.bnorm.epsilon));
+		ccv_nnc_graph_exec_symbol_set_io(graph, conv_symbol, 0, 0, TENSOR_SYMBOL_LIST(epsilon));
+		ccv_nnc_graph_exec_symbol_set_hint(graph, conv_symbol, ccv_nnc_no_hint);
+		ccv_nnc_graph_exec_symbol_set_io(graph, bn_symbol, TENSOR_SYMBOL_LIST(x, folded_w, folded_bias), TENSOR_SYMBOL_LIST(z));
+		ccv_nnc_graph_exec_symbol_set(graph, bn_symbol, conv.cmd); // Set after the io to keep the backend/ algorithm of the convolution.
+		ccv_nnc_graph_exec_symbol_set_hint(graph, bn_symbol, conv.hint);
+		ccv_nnc_graph_exec_symbol_concat(graph, conv_symbol, folding[0]);
+		for (i = 1; i < folding_size; i++)
+			ccv_nnc_graph_exec_symbol_concat(graph, folding[i - 1], folding[i]);
+		ccv_nnc_graph_exec_symbol_concat(graph, folding[folding_size - 1], bn_symbol);
+		// Keep the copies in sync, their inputs / outputs may be reallocated.
+		simplify->exec_symbol_info[conv_idx] = *(ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, conv_idx);
+		simplify->exec_symbol_info[idx] = *(ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx);
+		simplify->output_execs[y] = -1;
+		simplify->tensor_dead[y >> 5] |= (1u << (y & 0x1f));
+	} ccv_nnc_graph_visit_endfor
+}
+
+static int _ccv_nnc_constant_folding_cmd(const ccv_nnc_graph_exec_symbol_info_t* const node)
+{
+	if (node->flags & (CCV_NNC_GRAPH_EXEC_P_WHILE | CCV_NNC_GRAPH_EXEC_CASE_OF))
+		return 0;
+	switch (node->cmd.cmd)
+	{
+		// These are either not pure, or cannot be executed on their own.
+		case CCV_NNC_NOOP:
+		case CCV_NNC_GRAPH_FORWARD:
+		case CCV_NNC_GRAPH_BACKWARD:
+		case CCV_NNC_CUSTOM_FORWARD:
+		case CCV_NNC_CUSTOM_BACKWARD:
+		case CCV_NNC_RANDOM_UNIFORM_FORWARD:
+		case CCV_NNC_RANDOM_UNIFORM_BACKWARD:
+		case CCV_NNC_RANDOM_NORMAL_FORWARD:
+		case CCV_NNC_RANDOM_NORMAL_BACKWARD:
+		case CCV_NNC_DROPOUT_FORWARD:
+		case CCV_NNC_DROPOUT_BACKWARD:
+			return 0;
+	}
+	return 1;
+}
+
+static ccv_nnc_tensor_t* _ccv_nnc_constant_folding_input(ccv_nnc_symbolic_graph_simplify_t* const simplify, const uint32_t* const bound, const int d, ccv_nnc_tensor_t* const alias)
+{
+	const ccv_nnc_tensor_symbol_info_t* const symbol_info = simplify->tensor_symbol_info + d;
+	const int alias_ref = symbol_info->alias_ref ? symbol_info->alias_ref - 1 : d;
+	if ((bound[d >> 5] & (1u << (d & 0x1f))) || (bound[alias_ref >> 5] & (1u << (alias_ref & 0x1f))))
+		return 0;
+	ccv_nnc_tensor_t* const constant = simplify->tensor_symbol_info[alias_ref].constant;
+	if (!constant || !symbol_info->alias_ref)
+		return constant;
+	// Only the alias that is a reshape of the constant can be used as is.
+	if (memcmp(ccv_nnc_no_ofs, symbol_info->ofs, sizeof(ccv_nnc_no_ofs)) != 0 ||
+		memcmp(symbol_info->inc, symbol_info->info.dim, sizeof(int) * CCV_NNC_MAX_DIM_ALLOC) != 0)
+		return 0;
+	*alias = ccv_nnc_tensor(constant->data.u8, symbol_info->info, 0);
+	return alias;
+}
+
+static int _ccv_nnc_constant_folding_output(ccv_nnc_symbolic_graph_simplify_t* const simplify, const uint32_t* const bound, const int exec_idx, const int d)
+{
+	const ccv_nnc_tensor_symbol_info_t* const symbol_info = simplify->tensor_symbol_info + d;
+	// The output has to be a plain tensor on the CPU that is not carried over, not bound, and written only once.
+	if ((bound[d >> 5] & (1u << (d & 0x1f))) || symbol_info->constant || symbol_info->alias_ref || symbol_info->assign_ref || symbol_info->r_assign_ref ||
+		symbol_info->bypass_ref || symbol_info->r_bypass_ref || symbol_info->p_ref || symbol_info->pair_ref || (symbol_info->s_ref && symbol_info->s_ref->rnum) ||
+		(symbol_info->flags & (CCV_NNC_TENSOR_SYMBOL_INIT_ZEROS | CCV_NNC_TENSOR_SYMBOL_INIT_ONES | CCV_NNC_TENSOR_SYMBOL_TAPE_VAR)) ||
+		CCV_TENSOR_GET_MEMORY(symbol_info->info.type) != CCV_TENSOR_CPU_MEMORY || ccv_nnc_tensor_count(symbol_info->info) <= 0)
+		return 0;
+	// If any other exec writes to it, directly or through an alias (an in-place update for example), it is not a constant.
+	int i, j;
+	for (i = 0; i < simplify->exec_symbol_info_size; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_info_t* const node = simplify->exec_symbol_info + i;
+		if (i == exec_idx || (simplify->exec_dead[i >> 5] & (1u << (i & 0x1f))) || CCV_NNC_GRAPH_EXEC_IS_DEAD(node->flags))
+			continue;
+		for (j = 0; j < node->output_size; j++)
+			if (node->outputs[j] == d || (node->outputs[j] >= 0 && simplify->tensor_symbol_info[node->outputs[j]].alias_ref == d + 1))
+				return 0;
+	}
+	return 1;
+}
+
+static void _ccv_nnc_symbolic_graph_constant_folding(ccv_nnc_symbolic_graph_simplify_t* const simplify, const ccv_nnc_tensor_symbol_t* const binds, const int bind_size, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size)
+{
+	ccv_nnc_symbolic_graph_t* const graph = simplify->graph;
+	// Besides the bound ones, remember the constants we made, the ones that end up unused can be released.
+	uint32_t* const bound = (uint32_t*)cccalloc(sizeof(uint32_t), ((simplify->tensor_symbol_info_size + 31) >> 5) * 2);
+	uint32_t* const folded = bound + ((simplify->tensor_symbol_info_size + 31) >> 5);
+	int i, j;
+	for (i = 0; i < bind_size; i++)
+		if (binds[i].graph == graph && binds[i].d >= 0)
+			bound[binds[i].d >> 5] |= (1u << (binds[i].d & 0x1f));
+	ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+		if ((simplify->exec_dead[idx >> 5] & (1u << (idx & 0x1f))) || !_ccv_nnc_constant_folding_cmd(node))
+			continue;
+		ccv_nnc_tensor_t* inputs[ccv_max(1, node->input_size)];
+		ccv_nnc_tensor_t aliases[ccv_max(1, node->input_size)];
+		ccv_nnc_tensor_t* outputs[ccv_max(1, node->output_size)];
+		int flag = 1, input_count = 0, output_count = 0;
+		for (i = 0; flag && i < node->input_size; i++)
+			if (node->inputs[i] >= 0)
+			{
+				inputs[i] = _ccv_nnc_constant_folding_input(simplify, bound, node->inputs[i], aliases + i);
+				flag = !!inputs[i];
+				++input_count;
+			} else
+				inputs[i] = 0;
+		for (i = 0; flag && i < node->output_size; i++)
+			if (node->outputs[i] >= 0)
+			{
+				flag = _ccv_nnc_constant_folding_output(simplify, bound, idx, node->outputs[i]);
+				++output_count;
+			}
+		// Without inputs, only fills are folded.
+		if (!flag || !output_count || (!input_count && node->cmd.cmd != CCV_NNC_SET_FORWARD))
+			continue;
+		for (i = 0; i < node->output_size; i++)
+			outputs[i] = node->outputs[i] >= 0 ? ccv_nnc_tensor_new(0, simplify->tensor_symbol_info[node->outputs[i]].info, 0) : 0;
+		ccv_nnc_cmd_t cmd = node->cmd;
+		// The backend may be picked for the device, find the one on CPU.
+		int tensor_formats = 0, tensor_datatypes = 0;
+		for (i = 0; i < node->input_size; i++)
+			if (inputs[i])
+				tensor_formats |= inputs[i]->info.format, tensor_datatypes |= inputs[i]->info.datatype;
+		for (i = 0; i < node->output_size; i++)
+			if (outputs[i])
+				tensor_formats |= outputs[i]->info.format, tensor_datatypes |= outputs[i]->info.datatype;
+		cmd.backend = CCV_NNC_NO_BACKEND;
+		cmd.backend = ccv_nnc_cmd_find_backend(cmd, CCV_TENSOR_CPU_MEMORY, tensor_formats, tensor_datatypes);
+		cmd.algorithm = 0;
+		if (cmd.backend == CCV_NNC_NO_BACKEND || ccv_nnc_cmd_exec(cmd, node->hint, 0, inputs, node->input_size, outputs, node->output_size, 0) != CCV_NNC_EXEC_SUCCESS)
+		{
+			for (i = 0; i < node->output_size; i++)
+				if (outputs[i])
+					ccv_nnc_tensor_free(outputs[i]);
+			continue;
+		}
+		for (i = 0; i < node->output_size; i++)
+		{
+			const int d = node->outputs[i];
+			if (d < 0)
+				continue;
+			simplify->tensor_symbol_info[d].constant = outputs[i];
+			ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, d);
+			symbol_info->constant = outputs[i];
+			symbol_info->info = outputs[i]->info;
+			folded[d >> 5] |= (1u << (d & 0x1f));
+		}
+		simplify->exec_dead[idx >> 5] |= (1u << (idx & 0x1f));
+	} ccv_nnc_graph_visit_endfor
+	// The intermediate constants nobody reads any more don't need to hold on to the memory.
+	for (i = 0; i < output_size; i++)
+	{
+		const int d = simplify->tensor_symbol_info[outputs[i].d].alias_ref ? simplify->tensor_symbol_info[outputs[i].d].alias_ref - 1 : outputs[i].d;
+		folded[d >> 5] &= ~(1u << (d & 0x1f));
+	}
+	// Go over all execs, not only the visited ones, if it is read by some, keep it.
+	for (i = 0; i < simplify->exec_symbol_info_size; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_info_t* const node = simplify->exec_symbol_info + i;
+		if ((simplify->exec_dead[i >> 5] & (1u << (i & 0x1f))) || CCV_NNC_GRAPH_EXEC_IS_DEAD(node->flags))
+			continue;
+		for (j = 0; j < node->input_size; j++)
+			if (node->inputs[j] >= 0)
+			{
+				const int d = simplify->tensor_symbol_info[node->inputs[j]].alias_ref ? simplify->tensor_symbol_info[node->inputs[j]].alias_ref - 1 : node->inputs[j];
+				folded[d >> 5] &= ~(1u << (d & 0x1f));
+			}
+	}
+	for (i = 0; i < simplify->tensor_symbol_info_size; i++)
+		if (folded[i >> 5] & (1u << (i & 0x1f)))
+		{
+			ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, i);
+			ccv_nnc_tensor_free(symbol_info->constant);
+			symbol_info->constant = 0;
+			simplify->tensor_symbol_info[i].constant = 0;
+			simplify->tensor_dead[i >> 5] |= (1u << (i & 0x1f));
+			for (j = 0; j < simplify->tensor_symbol_info_size; j++)
+				if (simplify->tensor_symbol_info[j].alias_ref == i + 1)
+					simplify->tensor_dead[j >> 5] |= (1u << (j & 0x1f));
+		}
+	ccfree(bound);
+}
+
+enum {
+	CCV_NNC_LAYOUT_FROZEN = 0, // It keeps the format it has.
+	CCV_NNC_LAYOUT_FORMAT_AWARE, // It runs in whichever format its backends support.
+	CCV_NNC_LAYOUT_ELEMENTWISE, // It runs in any format as long as all its inputs / outputs agree.
+	CCV_NNC_LAYOUT_TRANSFORM, // It converts from one format to another.
+};
+
+#define CCV_NNC_LAYOUT_INF_COST ((int64_t)1 << 50)
+
+static int _ccv_nnc_layout_cmd(const ccv_nnc_graph_exec_symbol_info_t* const node)
+{
+	if (node->flags & (CCV_NNC_GRAPH_EXEC_P_WHILE | CCV_NNC_GRAPH_EXEC_CASE_OF))
+		return CCV_NNC_LAYOUT_FROZEN;
+	switch (node->cmd.cmd)
+	{
+		case CCV_NNC_CONVOLUTION_FORWARD:
+		case CCV_NNC_MAX_POOL_FORWARD:
+		case CCV_NNC_AVERAGE_POOL_FORWARD:
+		case CCV_NNC_UPSAMPLE_BILINEAR_FORWARD:
+			return CCV_NNC_LAYOUT_FORMAT_AWARE;
+		case CCV_NNC_EWSUM_FORWARD:
+		case CCV_NNC_EWPROD_FORWARD:
+		case CCV_NNC_EWDIV_FORWARD:
+		case CCV_NNC_EWEXP_FORWARD:
+		case CCV_NNC_EWLOG_FORWARD:
+		case CCV_NNC_EWSQRT_FORWARD:
+		case CCV_NNC_ADD_FORWARD:
+		case CCV_NNC_MUL_FORWARD:
+		case CCV_NNC_SCALAR_MUL_FORWARD:
+		case CCV_NNC_RELU_FORWARD:
+		case CCV_NNC_SIGMOID_FORWARD:
+		case CCV_NNC_TANH_FORWARD:
+		case CCV_NNC_SWISH_FORWARD:
+		case CCV_NNC_CLAMP_FORWARD:
+		case CCV_NNC_SET_FORWARD:
+		case CCV_NNC_DATA_TRANSFER_FORWARD:
+		case CCV_NNC_DATATYPE_CONVERSION_FORWARD:
+			return CCV_NNC_LAYOUT_ELEMENTWISE;
+		case CCV_NNC_FORMAT_TRANSFORM_FORWARD:
+		case CCV_NNC_FORMAT_TRANSFORM_BACKWARD:
+			return CCV_NNC_LAYOUT_TRANSFORM;
+	}
+	return CCV_NNC_LAYOUT_FROZEN;
+}
+
+static int _ccv_nnc_layout_tensor(const ccv_nnc_tensor_symbol_info_t* const symbol_info)
+{
+	const int nd = ccv_nnc_tensor_nd(symbol_info->info.dim);
+	return (nd == 3 || nd == 4) && (symbol_info->info.format == CCV_TENSOR_FORMAT_NHWC || symbol_info->info.format == CCV_TENSOR_FORMAT_NCHW);
+}
+
+static int _ccv_nnc_layout_contiguous(const ccv_nnc_tensor_symbol_info_t* const symbol_info)
+{
+	return !symbol_info->alias_ref || (memcmp(ccv_nnc_no_ofs, symbol_info->ofs, sizeof(ccv_nnc_no_ofs)) == 0 &&
+		memcmp(symbol_info->inc, symbol_info->info.dim, sizeof(int) * CCV_NNC_MAX_DIM_ALLOC) == 0);
+}
+
+static ccv_nnc_tensor_param_t _ccv_nnc_layout_tensor_params(ccv_nnc_tensor_param_t params, const int format)
+{
+	if (params.format == format)
+		return params;
+	const int nd = ccv_nnc_tensor_nd(params.dim);
+	// The channel is the last dimension for NHWC, and the third last for NCHW (the same holds for the convolution weights).
+	if (format == CCV_TENSOR_FORMAT_NCHW)
+	{
+		const int c = params.dim[nd - 1];
+		params.dim[nd - 1] = params.dim[nd - 2];
+		params.dim[nd - 2] = params.dim[nd - 3];
+		params.dim[nd - 3] = c;
+	} else {
+		const int c = params.dim[nd - 3];
+		params.dim[nd - 3] = params.dim[nd - 2];
+		params.dim[nd - 2] = params.dim[nd - 1];
+		params.dim[nd - 1] = c;
+	}
+	params.format = format;
+	return params;
+}
+
+static int _ccv_nnc_layout_exec(const ccv_nnc_symbolic_graph_simplify_t* const simplify, const ccv_nnc_graph_exec_symbol_info_t* const node, int* const allowed)
+{
+	const int kind = _ccv_nnc_layout_cmd(node);
+	if (kind == CCV_NNC_LAYOUT_FROZEN)
+		return CCV_NNC_LAYOUT_FROZEN;
+	int i, k;
+	if (kind == CCV_NNC_LAYOUT_TRANSFORM)
+	{
+		// For format transform, we only respect output size.
+		if (node->input_size < node->output_size)
+			return CCV_NNC_LAYOUT_FROZEN;
+		for (i = 0; i < node->output_size; i++)
+			if (node->inputs[i] < 0 || node->outputs[i] < 0 ||
+				!_ccv_nnc_layout_tensor(simplify->tensor_symbol_info + node->inputs[i]) || !_ccv_nnc_layout_contiguous(simplify->tensor_symbol_info + node->inputs[i]) ||
+				!_ccv_nnc_layout_tensor(simplify->tensor_symbol_info + node->outputs[i]) || !_ccv_nnc_layout_contiguous(simplify->tensor_symbol_info + node->outputs[i]))
+				return CCV_NNC_LAYOUT_FROZEN;
+		return CCV_NNC_LAYOUT_TRANSFORM;
+	}
+	int format = 0, tensor_memory = 0, tensor_formats = 0, tensor_datatypes = 0;
+	for (k = 0; k < 2; k++)
+	{
+		const int* const io = k ? node->outputs : node->inputs;
+		const int io_size = k ? node->output_size : node->input_size;
+		for (i = 0; i < io_size; i++)
+		{
+			if (io[i] < 0)
+				continue;
+			const ccv_nnc_tensor_symbol_info_t* const symbol_info = simplify->tensor_symbol_info + io[i];
+			if (ccv_nnc_is_tensor_auto(symbol_info->info))
+				return CCV_NNC_LAYOUT_FROZEN;
+			tensor_memory |= CCV_TENSOR_GET_MEMORY(symbol_info->info.type), tensor_datatypes |= symbol_info->info.datatype;
+			if (_ccv_nnc_layout_tensor(symbol_info))
+			{
+				// All the tensors in a layout have to agree on the format, and cannot be a strided view.
+				if ((format && format != symbol_info->info.format) || !_ccv_nnc_layout_contiguous(symbol_info))
+					return CCV_NNC_LAYOUT_FROZEN;
+				format = symbol_info->info.format;
+			} else if (kind == CCV_NNC_LAYOUT_ELEMENTWISE)
+				return CCV_NNC_LAYOUT_FROZEN;
+			else // Such as the bias, it doesn't change with the layout.
+				tensor_formats |= symbol_info->info.format;
+		}
+	}
+	if (!format)
+		return CCV_NNC_LAYOUT_FROZEN;
+	// The formats it can run with are the ones there is a backend for.
+	ccv_nnc_cmd_t cmd = node->cmd;
+	*allowed = 0;
+	cmd.backend = CCV_NNC_NO_BACKEND;
+	if (ccv_nnc_cmd_find_backend(cmd, tensor_memory, tensor_formats | CCV_TENSOR_FORMAT_NHWC, tensor_datatypes) != CCV_NNC_NO_BACKEND)
+		*allowed |= CCV_TENSOR_FORMAT_NHWC;
+	if (ccv_nnc_cmd_find_backend(cmd, tensor_memory, tensor_formats | CCV_TENSOR_FORMAT_NCHW, tensor_datatypes) != CCV_NNC_NO_BACKEND)
+		*allowed |= CCV_TENSOR_FORMAT_NCHW;
+	return *allowed ? kind : CCV_NNC_LAYOUT_FROZEN;
+}
+
+static int _ccv_nnc_layout_group_find(int* const groups, int d)
+{
+	while (groups[d] != d)
+		d = groups[d] = groups[groups[d]];
+	return d;
+}
+
+typedef struct {
+	int to;
+	int next;
+	int64_t capacity;
+} ccv_nnc_layout_edge_t;
+
+static void _ccv_nnc_layout_edge_add(ccv_array_t* const edges, int* const heads, const int from, const int to, const int64_t capacity, const int64_t r_capacity)
+{
+	ccv_nnc_layout_edge_t edge = {
+		.to = to,
+		.next = heads[from],
+		.capacity = capacity,
+	};
+	heads[from] = edges->rnum;
+	ccv_array_push(edges, &edge);
+	edge.to = from;
+	edge.next = heads[to];
+	edge.capacity = r_capacity;
+	heads[to] = edges->rnum;
+	ccv_array_push(edges, &edge);
+}
+
+static void _ccv_nnc_layout_cost_add(ccv_array_t* const edges, int* const heads, const int group, const int format, const int64_t cost)
+{
+	// The source (0) side is NHWC, and the sink (1) side is NCHW. The cost is paid if the edge is cut, that is
+	// when the group ends up on the other side.
+	if (format == CCV_TENSOR_FORMAT_NHWC)
+		_ccv_nnc_layout_edge_add(edges, heads, 0, group + 2, cost, 0);
+	else
+		_ccv_nnc_layout_edge_add(edges, heads, group + 2, 1, cost, 0);
+}
+
+static void _ccv_nnc_layout_min_cut(ccv_array_t* const edges, const int* const heads, const int node_size, int* const prev)
+{
+	// Edmonds-Karp, when it stops, the nodes that can still be reached from the source (prev[i] != -1) are on the source side.
+	int* const queue = prev + node_size;
+	int i;
+	for (;;)
+	{
+		for (i = 0; i < node_size; i++)
+			prev[i] = -1;
+		prev[0] = -2;
+		int head = 0, tail = 0;
+		queue[tail++] = 0;
+		while (head < tail && prev[1] == -1)
+		{
+			const int from = queue[head++];
+			for (i = heads[from]; i >= 0; i = ((ccv_nnc_layout_edge_t*)ccv_array_get(edges, i))->next)
+			{
+				const ccv_nnc_layout_edge_t* const edge = (ccv_nnc_layout_edge_t*)ccv_array_get(edges, i);
+				if (edge->capacity > 0 && prev[edge->to] == -1)
 				{
-					ccv_nnc_graph_exec_symbol_info_t* const fusing_op = exec_symbol_info + fusing_exec_symbols[ops_fusion->pos[j].op_idx];
-					switch (ops_fusion->pos[j].type)
+					prev[edge->to] = i;
+					queue[tail++] = edge->to;
+				}
+			}
+		}
+		if (prev[1] == -1)
+			break;
+		int64_t flow = CCV_NNC_LAYOUT_INF_COST;
+		for (i = 1; i != 0; i = ((ccv_nnc_layout_edge_t*)ccv_array_get(edges, prev[i] ^ 1))->to)
+			flow = ccv_min(flow, ((ccv_nnc_layout_edge_t*)ccv_array_get(edges, prev[i]))->capacity);
+		for (i = 1; i != 0; i = ((ccv_nnc_layout_edge_t*)ccv_array_get(edges, prev[i] ^ 1))->to)
+		{
+			((ccv_nnc_layout_edge_t*)ccv_array_get(edges, prev[i]))->capacity -= flow;
+			((ccv_nnc_layout_edge_t*)ccv_array_get(edges, prev[i] ^ 1))->capacity += flow;
+		}
+	}
+}
+
+static int _ccv_nnc_layout_tensor_base(const ccv_nnc_symbolic_graph_simplify_t* const simplify, const int d)
+{
+	return simplify->tensor_symbol_info[d].alias_ref ? simplify->tensor_symbol_info[d].alias_ref - 1 : d;
+}
+
+static ccv_nnc_tensor_symbol_t _ccv_nnc_layout_bridge(ccv_nnc_symbolic_graph_simplify_t* const simplify, const int exec_idx, const int d, const int format, const int is_output, int* const transform_idx)
+{
+	ccv_nnc_symbolic_graph_t* const graph = simplify->graph;
+	const ccv_nnc_tensor_symbol_t x = {
+		.d = d,
+		.graph = graph,
+	};
+	const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(graph, _ccv_nnc_layout_tensor_params(simplify->tensor_symbol_info[d].info, format), 0);
+	const ccv_nnc_graph_exec_symbol_t exec = {
+		.d = exec_idx,
+		.graph = graph,
+	};
+	const ccv_nnc_graph_exec_symbol_t transform = is_output ?
+		ccv_nnc_graph_exec_symbol_new(graph, CMD_FORMAT_TRANSFORM_FORWARD(), TENSOR_SYMBOL_LIST(y), TENSOR_SYMBOL_LIST(x), 0) :
+		ccv_nnc_graph_exec_symbol_new(graph, CMD_FORMAT_TRANSFORM_FORWARD(), TENSOR_SYMBOL_LIST(x), TENSOR_SYMBOL_LIST(y), 0);
+	if (is_output)
+		ccv_nnc_graph_exec_symbol_concat(graph, exec, transform);
+	else
+		ccv_nnc_graph_exec_symbol_concat(graph, transform, exec);
+	// Order it after whoever writes, or before whoever reads the tensor (or any alias of it).
+	const int base = _ccv_nnc_layout_tensor_base(simplify, d);
+	int i, flag = 0;
+	ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+		if (idx == exec_idx || (simplify->exec_dead[idx >> 5] & (1u << (idx & 0x1f))))
+			continue;
+		const int* const io = is_output ? node->inputs : node->outputs;
+		const int io_size = is_output ? node->input_size : node->output_size;
+		for (i = 0; i < io_size; i++)
+			if (io[i] >= 0 && _ccv_nnc_layout_tensor_base(simplify, io[i]) == base)
+			{
+				const ccv_nnc_graph_exec_symbol_t other = {
+					.d = idx,
+					.graph = graph,
+				};
+				if (is_output)
+					ccv_nnc_graph_exec_symbol_concat(graph, transform, other);
+				else
+					ccv_nnc_graph_exec_symbol_concat(graph, other, transform);
+				flag = 1;
+				break;
+			}
+	} ccv_nnc_graph_visit_endfor
+	// Nobody writes it (an input of the graph), or nobody reads it (an output of the graph). Otherwise the transform
+	// would be a new source / destination the given ones don't cover, thus, order it after the execs before this one,
+	// or before the execs after this one instead.
+	if (!flag)
+		ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+			if (idx == exec_idx || (simplify->exec_dead[idx >> 5] & (1u << (idx & 0x1f))))
+				continue;
+			const ccv_array_t* const outgoings = ((ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, is_output ? exec_idx : idx))->outgoings;
+			const int target = is_output ? idx : exec_idx;
+			if (outgoings)
+				for (i = 0; i < outgoings->rnum; i++)
+					if (*(int*)ccv_array_get(outgoings, i) == target)
 					{
-						case CCV_NNC_OPS_FUSION_INPUT_INDEX:
-							fused_inputs[ops_fusion->pos[j].to] = ops_fusion->pos[j].from < fusing_op->input_size ? fusing_op->inputs[ops_fusion->pos[j].from] : CCV_NNC_NO_TENSOR_SYMBOL;
-							input_size = ccv_max(input_size, ops_fusion->pos[j].to + 1);
-							break;
-						case CCV_NNC_OPS_FUSION_OUTPUT_INDEX:
-							fused_outputs[ops_fusion->pos[j].to] = ops_fusion->pos[j].from < fusing_op->output_size ? fusing_op->outputs[ops_fusion->pos[j].from] : CCV_NNC_NO_TENSOR_SYMBOL;
-							output_size = ccv_max(output_size, ops_fusion->pos[j].to + 1);
-							break;
+						const ccv_nnc_graph_exec_symbol_t other = {
+							.d = idx,
+							.graph = graph,
+						};
+						if (is_output)
+							ccv_nnc_graph_exec_symbol_concat(graph, transform, other);
+						else
+							ccv_nnc_graph_exec_symbol_concat(graph, other, transform);
+						break;
 					}
+		} ccv_nnc_graph_visit_endfor
+	*transform_idx = transform.d;
+	return y;
+}
+
+static int _ccv_nnc_symbolic_graph_layout_propagation(ccv_nnc_symbolic_graph_simplify_t* const simplify, const ccv_nnc_tensor_symbol_t* const binds, const int bind_size, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size)
+{
+	ccv_nnc_symbolic_graph_t* const graph = simplify->graph;
+	ccv_nnc_tensor_symbol_info_t* const tensor_symbol_info = simplify->tensor_symbol_info;
+	const int tensor_symbol_info_size = simplify->tensor_symbol_info_size;
+	const int exec_symbol_info_size = simplify->exec_symbol_info_size;
+	int i, j, k;
+	int* const exec_kinds = (int*)cccalloc(exec_symbol_info_size * 3 + ((exec_symbol_info_size + 31) >> 5), sizeof(int));
+	int* const exec_allowed = exec_kinds + exec_symbol_info_size;
+	int* const exec_groups = exec_allowed + exec_symbol_info_size;
+	uint32_t* const pinned = (uint32_t*)(exec_groups + exec_symbol_info_size);
+	// A tensor can change its format if it is a plain tensor only used by the execs we understand.
+	int* const tensor_groups = (int*)ccmalloc(sizeof(int) * tensor_symbol_info_size * 3);
+	int* const tensor_group_ids = tensor_groups + tensor_symbol_info_size;
+	int* const refs = tensor_group_ids + tensor_symbol_info_size;
+	for (i = 0; i < tensor_symbol_info_size; i++)
+	{
+		const ccv_nnc_tensor_symbol_info_t* const symbol_info = tensor_symbol_info + i;
+		tensor_groups[i] = (_ccv_nnc_layout_tensor(symbol_info) && !symbol_info->alias_ref && !symbol_info->constant &&
+			!symbol_info->assign_ref && !symbol_info->r_assign_ref && !symbol_info->bypass_ref && !symbol_info->r_bypass_ref &&
+			!symbol_info->p_ref && !symbol_info->pair_ref && !(symbol_info->s_ref && symbol_info->s_ref->rnum) &&
+			!(symbol_info->flags & CCV_NNC_TENSOR_SYMBOL_TAPE_VAR) && !(simplify->tensor_dead[i >> 5] & (1u << (i & 0x1f)))) ? i : -1;
+	}
+	for (i = 0; i < tensor_symbol_info_size; i++)
+		if (tensor_symbol_info[i].alias_ref)
+			tensor_groups[tensor_symbol_info[i].alias_ref - 1] = -1;
+	for (i = 0; i < bind_size; i++)
+		if (binds[i].graph == graph && binds[i].d >= 0)
+			tensor_groups[binds[i].d] = -1;
+	for (i = 0; i < output_size; i++)
+		if (outputs[i].d >= 0)
+			tensor_groups[outputs[i].d] = -1;
+	ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+		if (!(simplify->exec_dead[idx >> 5] & (1u << (idx & 0x1f))))
+			exec_kinds[idx] = _ccv_nnc_layout_exec(simplify, node, exec_allowed + idx);
+	} ccv_nnc_graph_visit_endfor
+	// The given sources / destinations have to stay valid. Nothing can be put before a source or after a destination,
+	// thus, they keep their formats. The transforms among them are kept as well, even if they end up as copies.
+	for (i = 0; i < source_size; i++)
+		if (sources[i].graph == graph && sources[i].d >= 0)
+			pinned[sources[i].d >> 5] |= (1u << (sources[i].d & 0x1f));
+	for (i = 0; i < destination_size; i++)
+		if (destinations[i].graph == graph && destinations[i].d >= 0)
+			pinned[destinations[i].d >> 5] |= (1u << (destinations[i].d & 0x1f));
+	for (i = 0; i < exec_symbol_info_size; i++)
+		if ((pinned[i >> 5] & (1u << (i & 0x1f))) && exec_kinds[i] != CCV_NNC_LAYOUT_TRANSFORM)
+			exec_kinds[i] = CCV_NNC_LAYOUT_FROZEN;
+	// Go over all execs, not only the visited ones, whatever touched by the execs we cannot change keeps its format.
+	for (i = 0; i < exec_symbol_info_size; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_info_t* const node = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, i);
+		if (exec_kinds[i] != CCV_NNC_LAYOUT_FROZEN || (simplify->exec_dead[i >> 5] & (1u << (i & 0x1f))) || CCV_NNC_GRAPH_EXEC_IS_DEAD(node->flags))
+			continue;
+		for (j = 0; j < node->input_size; j++)
+			if (node->inputs[j] >= 0)
+				tensor_groups[node->inputs[j]] = -1;
+		for (j = 0; j < node->output_size; j++)
+			if (node->outputs[j] >= 0)
+				tensor_groups[node->outputs[j]] = -1;
+	}
+	// The tensors of the same exec have to be in the same format, group them together.
+	ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+		if (exec_kinds[idx] != CCV_NNC_LAYOUT_FORMAT_AWARE && exec_kinds[idx] != CCV_NNC_LAYOUT_ELEMENTWISE)
+			continue;
+		int group = -1;
+		for (k = 0; k < 2; k++)
+		{
+			const int* const io = k ? node->outputs : node->inputs;
+			const int io_size = k ? node->output_size : node->input_size;
+			for (i = 0; i < io_size; i++)
+				if (io[i] >= 0 && tensor_groups[io[i]] >= 0)
+				{
+					const int root = _ccv_nnc_layout_group_find(tensor_groups, io[i]);
+					if (group < 0)
+						group = root;
+					else if (root != group)
+						tensor_groups[root] = group;
 				}
-				const ccv_nnc_cmd_param_t info = exec_symbol_info[fusing_exec_symbols[ops_fusion->ops_info_select]].cmd.info;
-				// Modify the first node so it is the correct type and value. I need to look back to the actual graph to get the info.
-				ccv_nnc_graph_exec_symbol_info_t* const actual_node = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(simplify->graph->exec_symbol_info, idx);
-				actual_node->cmd.cmd = node->cmd.cmd = ops_fusion->fused_op;
-				actual_node->cmd.info = node->cmd.info = info;
-				if (node->input_size + node->output_size < input_size + output_size)
-					actual_node->inputs = node->inputs = node->inputs ? ccrealloc(node->inputs, sizeof(int) * (input_size + output_size)) : ccmalloc(sizeof(int) * (input_size + output_size));
-				actual_node->outputs = node->outputs = node->inputs + input_size;
-				actual_node->input_size = node->input_size = input_size;
-				actual_node->output_size = node->output_size = output_size;
-				memcpy(node->inputs, fused_inputs, sizeof(int) * input_size);
-				memcpy(node->outputs, fused_outputs, sizeof(int) * output_size);
-				// Afterwards, mark the rest as dead.
-				for (j = 1; j < ops_fusion->ops_seq_size; j++)
-					exec_dead[fusing_exec_symbols[j] >> 5] |= (1u << (fusing_exec_symbols[j] & 0x1f));
-				break;
+		}
+	} ccv_nnc_graph_visit_endfor
+	int group_size = 0;
+	for (i = 0; i < tensor_symbol_info_size; i++)
+		if (tensor_groups[i] == i)
+			tensor_group_ids[i] = group_size++;
+	int changed = 0;
+	if (!group_size)
+	{
+		ccfree(exec_kinds);
+		ccfree(tensor_groups);
+		return changed;
+	}
+	int* const group_allowed = (int*)ccmalloc(sizeof(int) * (group_size * 3 + (group_size + 2) * 3));
+	int* const group_formats = group_allowed + group_size;
+	int* const group_labels = group_formats + group_size;
+	int* const heads = group_labels + group_size;
+	int* const prev = heads + group_size + 2;
+	for (i = 0; i < tensor_symbol_info_size; i++)
+		if (tensor_groups[i] >= 0)
+		{
+			tensor_group_ids[i] = tensor_group_ids[_ccv_nnc_layout_group_find(tensor_groups, i)];
+			group_formats[tensor_group_ids[i]] = tensor_symbol_info[i].info.format;
+		} else
+			tensor_group_ids[i] = -1;
+	for (i = 0; i < group_size; i++)
+		group_allowed[i] = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW;
+	ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+		exec_groups[idx] = -1;
+		if (exec_kinds[idx] != CCV_NNC_LAYOUT_FORMAT_AWARE && exec_kinds[idx] != CCV_NNC_LAYOUT_ELEMENTWISE)
+			continue;
+		for (k = 0; exec_groups[idx] < 0 && k < 2; k++)
+		{
+			const int* const io = k ? node->outputs : node->inputs;
+			const int io_size = k ? node->output_size : node->input_size;
+			for (i = 0; exec_groups[idx] < 0 && i < io_size; i++)
+				if (io[i] >= 0)
+					exec_groups[idx] = tensor_group_ids[io[i]];
+		}
+		if (exec_groups[idx] >= 0)
+			group_allowed[exec_groups[idx]] &= exec_allowed[idx];
+	} ccv_nnc_graph_visit_endfor
+	// If no format works for all the execs in the group, leave it as is.
+	for (i = 0; i < tensor_symbol_info_size; i++)
+		if (tensor_group_ids[i] >= 0 && !group_allowed[tensor_group_ids[i]])
+			tensor_group_ids[i] = -1;
+	ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+		if (exec_groups[idx] >= 0 && !group_allowed[exec_groups[idx]])
+			exec_groups[idx] = -1;
+	} ccv_nnc_graph_visit_endfor
+	// Pick the format for each group with a minimum s-t cut. Transforms cost the number of elements they move, which
+	// always outweighs keeping the original formats, the tie-breaker.
+	const int64_t w = group_size + 1;
+	ccv_array_t* const edges = ccv_array_new(sizeof(ccv_nnc_layout_edge_t), group_size * 4, 0);
+	for (i = 0; i < group_size + 2; i++)
+		heads[i] = -1;
+	for (i = 0; i < group_size; i++)
+		if (group_allowed[i])
+		{
+			_ccv_nnc_layout_cost_add(edges, heads, i, group_formats[i], 1);
+			if (!(group_allowed[i] & CCV_TENSOR_FORMAT_NHWC))
+				_ccv_nnc_layout_cost_add(edges, heads, i, CCV_TENSOR_FORMAT_NCHW, CCV_NNC_LAYOUT_INF_COST);
+			if (!(group_allowed[i] & CCV_TENSOR_FORMAT_NCHW))
+				_ccv_nnc_layout_cost_add(edges, heads, i, CCV_TENSOR_FORMAT_NHWC, CCV_NNC_LAYOUT_INF_COST);
+		}
+	ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+		if (exec_kinds[idx] == CCV_NNC_LAYOUT_TRANSFORM)
+		{
+			for (i = 0; i < node->output_size; i++)
+			{
+				const int input_group = tensor_group_ids[node->inputs[i]];
+				const int output_group = tensor_group_ids[node->outputs[i]];
+				const int64_t cost = (int64_t)ccv_nnc_tensor_count(tensor_symbol_info[node->outputs[i]].info) * w;
+				if (input_group >= 0 && output_group >= 0)
+				{
+					if (input_group != output_group)
+						_ccv_nnc_layout_edge_add(edges, heads, input_group + 2, output_group + 2, cost, cost);
+				} else if (input_group >= 0)
+					_ccv_nnc_layout_cost_add(edges, heads, input_group, tensor_symbol_info[node->outputs[i]].info.format, cost);
+				else if (output_group >= 0)
+					_ccv_nnc_layout_cost_add(edges, heads, output_group, tensor_symbol_info[node->inputs[i]].info.format, cost);
+			}
+		} else if (exec_groups[idx] >= 0) {
+			// The tensors of the exec that keep their formats need a transform if the group ends up in the other format.
+			for (k = 0; k < 2; k++)
+			{
+				const int* const io = k ? node->outputs : node->inputs;
+				const int io_size = k ? node->output_size : node->input_size;
+				for (i = 0; i < io_size; i++)
+					if (io[i] >= 0 && tensor_group_ids[io[i]] < 0 && _ccv_nnc_layout_tensor(tensor_symbol_info + io[i]))
+						_ccv_nnc_layout_cost_add(edges, heads, exec_groups[idx], tensor_symbol_info[io[i]].info.format, (int64_t)ccv_nnc_tensor_count(tensor_symbol_info[io[i]].info) * w);
+			}
+		}
+	} ccv_nnc_graph_visit_endfor
+	_ccv_nnc_layout_min_cut(edges, heads, group_size + 2, prev);
+	ccv_array_free(edges);
+	for (i = 0; i < group_size; i++)
+		group_labels[i] = group_allowed[i] ? (prev[i + 2] != -1 ? CCV_TENSOR_FORMAT_NHWC : CCV_TENSOR_FORMAT_NCHW) : group_formats[i];
+	for (i = 0; i < tensor_symbol_info_size; i++)
+		if (tensor_group_ids[i] >= 0 && group_labels[tensor_group_ids[i]] != tensor_symbol_info[i].info.format)
+		{
+			tensor_symbol_info[i].info = _ccv_nnc_layout_tensor_params(tensor_symbol_info[i].info, group_labels[tensor_group_ids[i]]);
+			((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, i))->info = tensor_symbol_info[i].info;
+			changed = 1;
+		}
+	if (!changed)
+	{
+		ccfree(group_allowed);
+		ccfree(exec_kinds);
+		ccfree(tensor_groups);
+		return changed;
+	}
+	// The transforms between the tensors that are in the same format now are just copies, use one of the tensors for both.
+	for (i = 0; i < tensor_symbol_info_size; i++)
+		refs[i] = -1;
+	uint32_t* const bound = (uint32_t*)cccalloc(sizeof(uint32_t), (tensor_symbol_info_size + 31) >> 5);
+	for (i = 0; i < bind_size; i++)
+		if (binds[i].graph == graph && binds[i].d >= 0)
+			bound[binds[i].d >> 5] |= (1u << (binds[i].d & 0x1f));
+	int updated_refs = 0;
+	ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+		if (exec_kinds[idx] != CCV_NNC_LAYOUT_TRANSFORM || (pinned[idx >> 5] & (1u << (idx & 0x1f))))
+			continue;
+		for (i = 0; i < node->output_size; i++)
+		{
+			const int input = node->inputs[i];
+			const int output = node->outputs[i];
+			if (tensor_symbol_info[input].info.format != tensor_symbol_info[output].info.format ||
+				tensor_symbol_info[input].info.datatype != tensor_symbol_info[output].info.datatype ||
+				tensor_symbol_info[input].info.type != tensor_symbol_info[output].info.type)
+				continue;
+			if (tensor_group_ids[output] >= 0)
+			{
+				if (refs[output] < 0)
+					refs[output] = input, updated_refs = 1;
+			} else if (tensor_group_ids[input] >= 0) {
+				const ccv_nnc_tensor_symbol_info_t* const symbol_info = tensor_symbol_info + output;
+				// The one it writes to keeps its format, it can be used in place of the input if it is a plain tensor.
+				if (refs[input] < 0 && !symbol_info->alias_ref && !symbol_info->constant && !(bound[output >> 5] & (1u << (output & 0x1f))) &&
+					!symbol_info->assign_ref && !symbol_info->r_assign_ref && !symbol_info->bypass_ref && !symbol_info->r_bypass_ref && !symbol_info->p_ref)
+					refs[input] = output, updated_refs = 1;
+			}
+		}
+	} ccv_nnc_graph_visit_endfor
+	ccfree(bound);
+	if (updated_refs)
+	{
+		// Make sure refs reference to the end.
+		for (i = 0; i < tensor_symbol_info_size; i++)
+			if (refs[i] >= 0)
+			{
+				int ref = refs[i];
+				while (refs[ref] >= 0)
+					ref = refs[ref];
+				refs[i] = ref;
+			}
+		_ccv_nnc_symbolic_graph_update_refs(simplify, outputs, output_size, refs, 0);
+		ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+			if (exec_kinds[idx] != CCV_NNC_LAYOUT_TRANSFORM)
+				continue;
+			for (i = 0; i < node->output_size; i++)
+				if (node->inputs[i] == node->outputs[i])
+				{
+					if (i + 1 < node->output_size)
+					{
+						node->inputs[i] = node->inputs[i + 1];
+						node->outputs[i] = node->outputs[i + 1];
+					}
+					--node->output_size;
+					--i;
+				}
+			node->input_size = node->output_size;
+			((ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx))->input_size = node->input_size;
+			((ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx))->output_size = node->output_size;
+			if (node->output_size == 0)
+				simplify->exec_dead[idx >> 5] |= (1u << (idx & 0x1f));
+		} ccv_nnc_graph_visit_endfor
+	}
+	// The tensors that keep their formats get a transform to / from the format of the group, shared between the readers.
+	int* const bridges = tensor_groups;
+	int* const bridge_execs = refs;
+	for (i = 0; i < tensor_symbol_info_size; i++)
+		bridges[i] = bridge_execs[i] = -1;
+	ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+		if (exec_kinds[idx] == CCV_NNC_LAYOUT_FROZEN || (simplify->exec_dead[idx >> 5] & (1u << (idx & 0x1f))))
+			continue;
+		const int format = exec_groups[idx] >= 0 ? group_labels[exec_groups[idx]] : 0;
+		ccv_nnc_tensor_symbol_t inputs[ccv_max(1, node->input_size)];
+		ccv_nnc_tensor_symbol_t outputs[ccv_max(1, node->output_size)];
+		int flag = 0;
+		for (i = 0; i < node->input_size; i++)
+		{
+			const int d = node->inputs[i];
+			inputs[i].d = d;
+			inputs[i].graph = graph;
+			if (d < 0)
+				continue;
+			flag = flag || (tensor_group_ids[d] >= 0 && group_labels[tensor_group_ids[d]] != group_formats[tensor_group_ids[d]]);
+			if (format && _ccv_nnc_layout_tensor(tensor_symbol_info + d) && tensor_symbol_info[d].info.format != format)
+			{
+				if (bridges[d] < 0)
+					bridges[d] = _ccv_nnc_layout_bridge(simplify, idx, d, format, 0, bridge_execs + d).d;
+				else
+					ccv_nnc_graph_exec_symbol_concat(graph, (ccv_nnc_graph_exec_symbol_t){
+						.d = bridge_execs[d],
+						.graph = graph,
+					}, (ccv_nnc_graph_exec_symbol_t){
+						.d = idx,
+						.graph = graph,
+					});
+				inputs[i].d = bridges[d];
+				flag = 1;
+			}
+		}
+		for (i = 0; i < node->output_size; i++)
+		{
+			const int d = node->outputs[i];
+			outputs[i].d = d;
+			outputs[i].graph = graph;
+			if (d < 0)
+				continue;
+			flag = flag || (tensor_group_ids[d] >= 0 && group_labels[tensor_group_ids[d]] != group_formats[tensor_group_ids[d]]);
+			if (format && _ccv_nnc_layout_tensor(tensor_symbol_info + d) && tensor_symbol_info[d].info.format != format)
+			{
+				int transform_idx;
+				outputs[i] = _ccv_nnc_layout_bridge(simplify, idx, d, format, 1, &transform_idx);
+				flag = 1;
 			}
 		}
+		// Set the inputs / outputs again for the ones touched, thus, the backend is picked for the new formats.
+		if (flag)
+		{
+			ccv_nnc_graph_exec_symbol_set_io(graph, (ccv_nnc_graph_exec_symbol_t){
+				.d = idx,
+				.graph = graph,
+			}, inputs, node->input_size, outputs, node->output_size);
+			simplify->exec_symbol_info[idx] = *(ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx);
+		}
 	} ccv_nnc_graph_visit_endfor
+	ccfree(group_allowed);
+	ccfree(exec_kinds);
+	ccfree(tensor_groups);
+	return changed;
 }
 
 static void _ccv_nnc_symbolic_graph_pruning_undead_exec(ccv_nnc_symbolic_graph_simplify_t* const simplify, const int exec_idx, uint32_t* const tensor_visited, ccv_array_t* const next)
@@ -967,7 +2247,7 @@ static void _ccv_nnc_symbolic_graph_pruning(ccv_nnc_symbolic_graph_simplify_t* c
 
 void ccv_nnc_symbolic_graph_simplify(ccv_nnc_symbolic_graph_t* const graph, const int* const passes, const int pass_size, const ccv_nnc_tensor_symbol_t* const binds, const int bind_size, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size)
 {
-	ccv_nnc_symbolic_graph_simplify_t* const simplify = _ccv_nnc_symbolic_graph_simplify_new(graph, sources, source_size, destinations, destination_size);
+	ccv_nnc_symbolic_graph_simplify_t* simplify = _ccv_nnc_symbolic_graph_simplify_new(graph, sources, source_size, destinations, destination_size);
 	int i;
 	for (i = 0; i < pass_size; i++)
 		switch (passes[i])
@@ -984,6 +2264,26 @@ void ccv_nnc_symbolic_graph_simplify(ccv_nnc_symbolic_graph_t* const graph, cons
 			case CCV_NNC_SIMPLIFY_OPS_FUSION:
 				_ccv_nnc_symbolic_graph_ops_fusion(simplify, outputs, output_size);
 				break;
+			case CCV_NNC_SIMPLIFY_CONSTANT_FOLDING:
+				_ccv_nnc_symbolic_graph_constant_folding(simplify, binds, bind_size, outputs, output_size);
+				break;
+			case CCV_NNC_SIMPLIFY_BATCH_NORM_FOLDING:
+				_ccv_nnc_symbolic_graph_batch_norm_folding(simplify, outputs, output_size);
+				// New symbols are added to the graph, start over so the later passes can see them.
+				_ccv_nnc_symbolic_graph_simplify_apply(simplify);
+				_ccv_nnc_symbolic_graph_simplify_free(simplify);
+				simplify = _ccv_nnc_symbolic_graph_simplify_new(graph, sources, source_size, destinations, destination_size);
+				break;
+			case CCV_NNC_SIMPLIFY_LAYOUT_PROPAGATION:
+				if (_ccv_nnc_symbolic_graph_layout_propagation(simplify, binds, bind_size, outputs, output_size, sources, source_size, destinations, destination_size))
+				{
+					// New format transforms are added to the graph (in between the given sources / destinations), start over
+					// so the later passes can see them.
+					_ccv_nnc_symbolic_graph_simplify_apply(simplify);
+					_ccv_nnc_symbolic_graph_simplify_free(simplify);
+					simplify = _ccv_nnc_symbolic_graph_simplify_new(graph, sources, source_size, destinations, destination_size);
+				}
+				break;
 		}
 	_ccv_nnc_symbolic_graph_simplify_apply(simplify);
 	_ccv_nnc_symbolic_graph_simplify_free(simplify);
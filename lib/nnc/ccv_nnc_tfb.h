@@ -63,6 +63,7 @@ typedef struct {
 
 typedef union ccv_numeric_data_u {
 	unsigned char* u8;
+	int8_t* i8;
 	int* i32;
 	ccv_float16_t* f16;
 	float* f32;
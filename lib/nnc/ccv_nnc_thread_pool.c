@@ -0,0 +1,225 @@
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <sched.h>
+#endif
+#include "ccv_nnc.h"
+#include "ccv_nnc_internal.h"
+#include <pthread.h>
+#include <unistd.h>
+
+const ccv_nnc_thread_pool_param_t ccv_nnc_default_thread_pool_params = {
+	.thread_count = 0,
+	.caller_participates = 1,
+	.nested = CCV_NNC_THREAD_POOL_NESTED_SERIAL,
+	.pin_cpus = 0,
+	.cpu_offset = 0,
+};
+
+typedef struct ccv_nnc_parallel_job_s ccv_nnc_parallel_job_t;
+
+struct ccv_nnc_parallel_job_s {
+	int n;
+	int grain_size;
+	int next; // The next iteration nobody claimed yet.
+	int remaining; // The number of iterations not finished yet.
+	ccv_nnc_parallel_for_f fn;
+	void* context;
+	ccv_nnc_parallel_job_t* next_job;
+};
+
+typedef struct {
+	int initialized;
+	int quit;
+	int thread_count; // The number of threads launched, doesn't include the caller.
+	int size; // The number of threads can participate in one parallel for.
+	ccv_nnc_thread_pool_param_t params;
+	pthread_t* threads;
+	// Jobs that still have iterations to claim.
+	ccv_nnc_parallel_job_t* head;
+	ccv_nnc_parallel_job_t* tail;
+	pthread_mutex_t mutex;
+	pthread_cond_t notify;
+	pthread_cond_t finish;
+} ccv_nnc_thread_pool_t;
+
+static ccv_nnc_thread_pool_t thread_pool = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.notify = PTHREAD_COND_INITIALIZER,
+	.finish = PTHREAD_COND_INITIALIZER,
+};
+
+// Whether current thread is executing an iteration of a parallel for.
+static __thread int in_parallel_for = 0;
+
+static int _ccv_nnc_cpu_count(void)
+{
+	const long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+	return cpu_count > 0 ? (int)cpu_count : 1;
+}
+
+static void _ccv_nnc_thread_pin(const int cpu)
+{
+#ifdef __linux__
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	CPU_SET(cpu % _ccv_nnc_cpu_count(), &cpu_set);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+#endif
+}
+
+// Claim the next chunk of iterations of the job, has to be called with the mutex locked.
+static int _ccv_nnc_parallel_job_claim(ccv_nnc_parallel_job_t* const job, int* const start, int* const end)
+{
+	if (job->next >= job->n)
+		return 0;
+	*start = job->next;
+	*end = ccv_min(job->n, job->next + job->grain_size);
+	job->next = *end;
+	// Everything is claimed, no other threads need to look at this job any more.
+	if (job->next >= job->n)
+	{
+		ccv_nnc_parallel_job_t* prev = 0;
+		ccv_nnc_parallel_job_t* it = thread_pool.head;
+		while (it != job)
+			prev = it, it = it->next_job;
+		if (prev)
+			prev->next_job = job->next_job;
+		else
+			thread_pool.head = job->next_job;
+		if (thread_pool.tail == job)
+			thread_pool.tail = prev;
+	}
+	return 1;
+}
+
+// Run the chunk with the mutex unlocked, and mark it as finished once done.
+static void _ccv_nnc_parallel_job_run(ccv_nnc_parallel_job_t* const job, const int start, const int end)
+{
+	pthread_mutex_unlock(&thread_pool.mutex);
+	const int previous = in_parallel_for;
+	in_parallel_for = 1;
+	int i;
+	for (i = start; i < end; i++)
+		job->fn(job->context, i);
+	in_parallel_for = previous;
+	pthread_mutex_lock(&thread_pool.mutex);
+	job->remaining -= end - start;
+	if (job->remaining == 0)
+		pthread_cond_broadcast(&thread_pool.finish);
+}
+
+static void* _ccv_nnc_thread_pool_main(void* userdata)
+{
+	const int thread_idx = (int)(intptr_t)userdata;
+	if (thread_pool.params.pin_cpus)
+		_ccv_nnc_thread_pin(thread_pool.params.cpu_offset + thread_idx + (thread_pool.params.caller_participates ? 1 : 0));
+	pthread_mutex_lock(&thread_pool.mutex);
+	for (;;)
+	{
+		while (!thread_pool.head && !thread_pool.quit)
+			pthread_cond_wait(&thread_pool.notify, &thread_pool.mutex);
+		if (!thread_pool.head)
+			break;
+		ccv_nnc_parallel_job_t* const job = thread_pool.head;
+		int start, end;
+		if (_ccv_nnc_parallel_job_claim(job, &start, &end))
+			_ccv_nnc_parallel_job_run(job, start, end);
+	}
+	pthread_mutex_unlock(&thread_pool.mutex);
+	return 0;
+}
+
+// Has to be called with the mutex locked.
+static void _ccv_nnc_thread_pool_start(const ccv_nnc_thread_pool_param_t params)
+{
+	thread_pool.params = params;
+	thread_pool.size = params.thread_count > 0 ? params.thread_count : _ccv_nnc_cpu_count();
+	thread_pool.thread_count = params.caller_participates ? thread_pool.size - 1 : thread_pool.size;
+	thread_pool.threads = thread_pool.thread_count > 0 ? (pthread_t*)ccmalloc(sizeof(pthread_t) * thread_pool.thread_count) : 0;
+	thread_pool.quit = 0;
+	int i;
+	for (i = 0; i < thread_pool.thread_count; i++)
+		pthread_create(thread_pool.threads + i, 0, _ccv_nnc_thread_pool_main, (void*)(intptr_t)i);
+	thread_pool.initialized = 1;
+}
+
+void ccv_nnc_thread_pool_configure(const ccv_nnc_thread_pool_param_t params)
+{
+	pthread_mutex_lock(&thread_pool.mutex);
+	assert(!thread_pool.head);
+	if (thread_pool.initialized)
+	{
+		thread_pool.quit = 1;
+		pthread_cond_broadcast(&thread_pool.notify);
+		pthread_mutex_unlock(&thread_pool.mutex);
+		int i;
+		for (i = 0; i < thread_pool.thread_count; i++)
+			pthread_join(thread_pool.threads[i], 0);
+		pthread_mutex_lock(&thread_pool.mutex);
+		if (thread_pool.threads)
+			ccfree(thread_pool.threads);
+		thread_pool.threads = 0;
+		thread_pool.initialized = 0;
+	}
+	_ccv_nnc_thread_pool_start(params);
+	pthread_mutex_unlock(&thread_pool.mutex);
+}
+
+int ccv_nnc_thread_pool_size(void)
+{
+	pthread_mutex_lock(&thread_pool.mutex);
+	if (!thread_pool.initialized)
+		_ccv_nnc_thread_pool_start(ccv_nnc_default_thread_pool_params);
+	const int size = thread_pool.size;
+	pthread_mutex_unlock(&thread_pool.mutex);
+	return size;
+}
+
+void ccv_nnc_parallel_for(const int n, const int grain_size, const ccv_nnc_parallel_for_f fn, void* const context)
+{
+	int i;
+	if (n <= 0)
+		return;
+	pthread_mutex_lock(&thread_pool.mutex);
+	if (!thread_pool.initialized)
+		_ccv_nnc_thread_pool_start(ccv_nnc_default_thread_pool_params);
+	const int size = thread_pool.size;
+	const int serial = (thread_pool.thread_count == 0 || (in_parallel_for && thread_pool.params.nested == CCV_NNC_THREAD_POOL_NESTED_SERIAL));
+	// Nested parallel for has to participate, otherwise we may run out of threads.
+	const int caller_participates = thread_pool.params.caller_participates || in_parallel_for;
+	pthread_mutex_unlock(&thread_pool.mutex);
+	// By default, have 4 chunks per thread to balance the load.
+	const int grain = grain_size > 0 ? grain_size : ccv_max(1, n / (size * 4));
+	if (serial || grain >= n)
+	{
+		for (i = 0; i < n; i++)
+			fn(context, i);
+		return;
+	}
+	ccv_nnc_parallel_job_t job = {
+		.n = n,
+		.grain_size = grain,
+		.next = 0,
+		.remaining = n,
+		.fn = fn,
+		.context = context,
+		.next_job = 0,
+	};
+	pthread_mutex_lock(&thread_pool.mutex);
+	if (thread_pool.tail)
+		thread_pool.tail->next_job = &job;
+	else
+		thread_pool.head = &job;
+	thread_pool.tail = &job;
+	pthread_cond_broadcast(&thread_pool.notify);
+	if (caller_participates)
+	{
+		int start, end;
+		// Only claim from our own job, other jobs will be picked up by the pool.
+		while (_ccv_nnc_parallel_job_claim(&job, &start, &end))
+			_ccv_nnc_parallel_job_run(&job, start, end);
+	}
+	while (job.remaining > 0)
+		pthread_cond_wait(&thread_pool.finish, &thread_pool.mutex);
+	pthread_mutex_unlock(&thread_pool.mutex);
+}
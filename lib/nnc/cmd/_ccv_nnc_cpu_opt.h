@@ -0,0 +1,690 @@
+#ifndef GUARD_ccv_nnc_cpu_opt_h
+#define GUARD_ccv_nnc_cpu_opt_h
+
+#include "ccv.h"
+#include "nnc/ccv_nnc.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+// F16C, AVX2 and AVX-512 are not part of the baseline we compile for, these are compiled for it with target attribute
+// and only called when the CPU supports it.
+#define CCV_NNC_CPU_OPT_F16C (1)
+#define CCV_NNC_CPU_OPT_AVX2 (1)
+#define CCV_NNC_CPU_OPT_AVX512 (1)
+#endif
+#endif
+
+#ifdef CCV_NNC_CPU_OPT_F16C
+__attribute__((target("avx,f16c"))) static inline float _ccv_nnc_sdot_f16_f16c(const float* const a, const ccv_float16_t* const h, const int n)
+{
+	__m256 v0 = _mm256_setzero_ps();
+	__m256 v1 = _mm256_setzero_ps();
+	int i;
+	for (i = 0; i < n - 15; i += 16)
+	{
+		const __m256 h0 = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(h + i)));
+		const __m256 h1 = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(h + i + 8)));
+		v0 = _mm256_add_ps(v0, _mm256_mul_ps(_mm256_loadu_ps(a + i), h0));
+		v1 = _mm256_add_ps(v1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), h1));
+	}
+	v0 = _mm256_add_ps(v0, v1);
+	const __m128 v = _mm_add_ps(_mm256_castps256_ps128(v0), _mm256_extractf128_ps(v0, 1));
+	float s[4];
+	_mm_storeu_ps(s, v);
+	float sum = s[0] + s[1] + s[2] + s[3];
+	for (; i < n; i++)
+		sum += a[i] * _cvtsh_ss(h[i].v);
+	return sum;
+}
+
+__attribute__((target("avx,f16c"))) static inline void _ccv_nnc_f16_to_f32_f16c(const ccv_float16_t* const h, float* const f, const int n)
+{
+	int i;
+	for (i = 0; i < n - 7; i += 8)
+		_mm256_storeu_ps(f + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(h + i))));
+	for (; i < n; i++)
+		f[i] = _cvtsh_ss(h[i].v);
+}
+
+__attribute__((target("avx,f16c"))) static inline void _ccv_nnc_f32_to_f16_f16c(const float* const f, ccv_float16_t* const h, const int n)
+{
+	int i;
+	for (i = 0; i < n - 7; i += 8)
+		_mm_storeu_si128((__m128i*)(h + i), _mm256_cvtps_ph(_mm256_loadu_ps(f + i), _MM_FROUND_TO_NEAREST_INT));
+	for (; i < n; i++)
+		h[i].v = _cvtss_sh(f[i], _MM_FROUND_TO_NEAREST_INT);
+}
+#endif
+
+#ifdef CCV_NNC_CPU_OPT_AVX2
+__attribute__((target("avx2"))) static inline int _ccv_nnc_i8dot_avx2(const int8_t* const a, const int8_t* const b, const int n)
+{
+	__m256i v0 = _mm256_setzero_si256();
+	__m256i v1 = _mm256_setzero_si256();
+	int i;
+	for (i = 0; i < n - 31; i += 32)
+	{
+		const __m256i a0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(a + i)));
+		const __m256i b0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(b + i)));
+		const __m256i a1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(a + i + 16)));
+		const __m256i b1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(b + i + 16)));
+		v0 = _mm256_add_epi32(v0, _mm256_madd_epi16(a0, b0));
+		v1 = _mm256_add_epi32(v1, _mm256_madd_epi16(a1, b1));
+	}
+	v0 = _mm256_add_epi32(v0, v1);
+	const __m128i v = _mm_add_epi32(_mm256_castsi256_si128(v0), _mm256_extracti128_si256(v0, 1));
+	int s[4];
+	_mm_storeu_si128((__m128i*)s, v);
+	int sum = s[0] + s[1] + s[2] + s[3];
+	for (; i < n; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+#endif
+
+/**
+ * Whether the half precision helpers below can use F16C instructions on this CPU.
+ */
+static inline int _ccv_nnc_cpu_opt_has_f16c(void)
+{
+#ifdef CCV_NNC_CPU_OPT_F16C
+	return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+#else
+	return 0;
+#endif
+}
+
+/**
+ * Dot product of n floats and n half precision floats, accumulated in single precision.
+ */
+static inline float _ccv_nnc_sdot_f16(const float* const a, const ccv_float16_t* const h, const int n)
+{
+#ifdef CCV_NNC_CPU_OPT_F16C
+	if (_ccv_nnc_cpu_opt_has_f16c())
+		return _ccv_nnc_sdot_f16_f16c(a, h, n);
+#endif
+	float f[64];
+	float sum = 0;
+	int i, j;
+	for (i = 0; i < n; i += 64)
+	{
+		const int len = ccv_min(64, n - i);
+		ccv_half_precision_to_float((uint16_t*)(h + i), f, len);
+		for (j = 0; j < len; j++)
+			sum += a[i + j] * f[j];
+	}
+	return sum;
+}
+
+/**
+ * Dot product of n floats.
+ */
+static inline float _ccv_nnc_sdot(const float* const a, const float* const b, const int n)
+{
+	int i = 0;
+	float sum = 0;
+#if defined(HAVE_SSE2)
+	__m128 v0 = _mm_setzero_ps();
+	__m128 v1 = _mm_setzero_ps();
+	for (; i < n - 7; i += 8)
+	{
+		v0 = _mm_add_ps(v0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		v1 = _mm_add_ps(v1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+	}
+	float s[4];
+	_mm_storeu_ps(s, _mm_add_ps(v0, v1));
+	sum = s[0] + s[1] + s[2] + s[3];
+#endif
+	for (; i < n; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+/**
+ * Sum of squares of n floats, accumulated in double.
+ */
+static inline double _ccv_nnc_sum_of_squares(const float* const a, const int n)
+{
+	int i = 0;
+	double sum = 0;
+#if defined(HAVE_SSE2)
+	__m128d v0 = _mm_setzero_pd();
+	__m128d v1 = _mm_setzero_pd();
+	for (; i < n - 3; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(a + i);
+		const __m128 x2 = _mm_mul_ps(x, x);
+		v0 = _mm_add_pd(v0, _mm_cvtps_pd(x2));
+		v1 = _mm_add_pd(v1, _mm_cvtps_pd(_mm_movehl_ps(x2, x2)));
+	}
+	double s[2];
+	_mm_storeu_pd(s, _mm_add_pd(v0, v1));
+	sum = s[0] + s[1];
+#endif
+	for (; i < n; i++)
+		sum += a[i] * a[i];
+	return sum;
+}
+
+// Optimizers can update many parameters with one command. The parameters are split into chunks of at most this many elements,
+// thus, small parameters are batched into one pass and large parameters are spread across threads.
+#define CCV_NNC_MULTI_TENSOR_CHUNK (16384)
+
+typedef struct {
+	int group; // The parameter (every stride tensors) this chunk belongs to.
+	int offset;
+	int count;
+} ccv_nnc_multi_tensor_chunk_t;
+
+/**
+ * Split the tensors at every stride into chunks. Returns the number of chunks, and fills them in if chunks is not 0.
+ */
+static inline int _ccv_nnc_multi_tensor_chunks(ccv_nnc_tensor_t* const* const tensors, const int tensor_size, const int stride, ccv_nnc_multi_tensor_chunk_t* const chunks)
+{
+	int i, j, chunk_count = 0;
+	for (i = 0; i < tensor_size; i += stride)
+	{
+		const int count = ccv_nnc_tensor_count(tensors[i]->info);
+		for (j = 0; j < count; j += CCV_NNC_MULTI_TENSOR_CHUNK, chunk_count++)
+			if (chunks)
+				chunks[chunk_count] = (ccv_nnc_multi_tensor_chunk_t){
+					.group = i / stride,
+					.offset = j,
+					.count = ccv_min(count - j, CCV_NNC_MULTI_TENSOR_CHUNK),
+				};
+	}
+	return chunk_count;
+}
+
+typedef struct {
+	const ccv_nnc_multi_tensor_chunk_t* chunks;
+	ccv_nnc_tensor_t* const* gradients;
+	int stride;
+	double* sums;
+} ccv_nnc_multi_tensor_norm_t;
+
+static inline void _ccv_nnc_multi_tensor_norm_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_multi_tensor_norm_t* const norm = (ccv_nnc_multi_tensor_norm_t*)context;
+	const ccv_nnc_multi_tensor_chunk_t chunk = norm->chunks[idx];
+	norm->sums[idx] = _ccv_nnc_sum_of_squares(norm->gradients[chunk.group * norm->stride]->data.f32 + chunk.offset, chunk.count);
+}
+
+/**
+ * The factor to scale the gradients (the first tensor of every stride, multiplied by scale) with, such that their L2 norm is
+ * at most max_norm. The partial sums are added up in the order of chunks, thus, the result doesn't depend on the number of threads.
+ */
+static inline float _ccv_nnc_multi_tensor_clip(const float max_norm, const float scale, ccv_nnc_tensor_t* const* const gradients, const int stride, const ccv_nnc_multi_tensor_chunk_t* const chunks, const int chunk_count, double* const sums)
+{
+	if (max_norm <= 0)
+		return 1;
+	ccv_nnc_multi_tensor_norm_t norm = {
+		.chunks = chunks,
+		.gradients = gradients,
+		.stride = stride,
+		.sums = sums,
+	};
+	ccv_nnc_parallel_for(chunk_count, 0, _ccv_nnc_multi_tensor_norm_parallel, &norm);
+	double sum = 0;
+	int i;
+	for (i = 0; i < chunk_count; i++)
+		sum += sums[i];
+	const double l2 = sqrt(sum) * fabsf(scale);
+	return l2 > max_norm ? (float)(max_norm / (l2 + 1e-6)) : 1;
+}
+
+/**
+ * Whether the int8 helpers below can use AVX2 instructions on this CPU.
+ */
+static inline int _ccv_nnc_cpu_opt_has_avx2(void)
+{
+#ifdef CCV_NNC_CPU_OPT_AVX2
+	return __builtin_cpu_supports("avx2");
+#else
+	return 0;
+#endif
+}
+
+/**
+ * Whether the single precision helpers can use AVX2 with fused multiply-add on this CPU.
+ */
+static inline int _ccv_nnc_cpu_opt_has_avx2_fma(void)
+{
+#ifdef CCV_NNC_CPU_OPT_AVX2
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+	return 0;
+#endif
+}
+
+/**
+ * Whether the single precision helpers can use AVX-512 on this CPU.
+ */
+static inline int _ccv_nnc_cpu_opt_has_avx512(void)
+{
+#ifdef CCV_NNC_CPU_OPT_AVX512
+	return __builtin_cpu_supports("avx512f");
+#else
+	return 0;
+#endif
+}
+
+/**
+ * Dot product of n int8, accumulated in int32. The inputs are in [-127, 127], thus, products of pairs
+ * never overflow the int16 to int32 multiply-add.
+ */
+static inline int _ccv_nnc_i8dot(const int8_t* const a, const int8_t* const b, const int n)
+{
+#ifdef CCV_NNC_CPU_OPT_AVX2
+	if (_ccv_nnc_cpu_opt_has_avx2())
+		return _ccv_nnc_i8dot_avx2(a, b, n);
+#endif
+	int i = 0;
+	int sum = 0;
+#if defined(HAVE_SSE2)
+	__m128i v0 = _mm_setzero_si128();
+	__m128i v1 = _mm_setzero_si128();
+	for (; i < n - 15; i += 16)
+	{
+		const __m128i a8 = _mm_loadu_si128((const __m128i*)(a + i));
+		const __m128i b8 = _mm_loadu_si128((const __m128i*)(b + i));
+		// Sign extend to int16 by interleaving with itself and shifting back.
+		const __m128i a0 = _mm_srai_epi16(_mm_unpacklo_epi8(a8, a8), 8);
+		const __m128i b0 = _mm_srai_epi16(_mm_unpacklo_epi8(b8, b8), 8);
+		const __m128i a1 = _mm_srai_epi16(_mm_unpackhi_epi8(a8, a8), 8);
+		const __m128i b1 = _mm_srai_epi16(_mm_unpackhi_epi8(b8, b8), 8);
+		v0 = _mm_add_epi32(v0, _mm_madd_epi16(a0, b0));
+		v1 = _mm_add_epi32(v1, _mm_madd_epi16(a1, b1));
+	}
+	int s[4];
+	_mm_storeu_si128((__m128i*)s, _mm_add_epi32(v0, v1));
+	sum = s[0] + s[1] + s[2] + s[3];
+#endif
+	for (; i < n; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+#if defined(HAVE_SSE2)
+/**
+ * Exponential of 4 floats. This is the Cephes polynomial, within 1 ulp of the double precision result for all floats
+ * in [-88, 88] (measured 0.99 ulps). Inputs are clamped to [-88.37, 88.37], thus, it doesn't overflow to infinity.
+ */
+static inline __m128 _ccv_nnc_exp_ps(__m128 x)
+{
+	x = _mm_min_ps(x, _mm_set1_ps(88.3762626647949f));
+	x = _mm_max_ps(x, _mm_set1_ps(-88.3762626647949f));
+	// Express exp(x) as exp(g + n * log(2)).
+	__m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+	__m128 tmp = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+	// Round towards negative infinity.
+	fx = _mm_sub_ps(tmp, _mm_and_ps(_mm_cmpgt_ps(tmp, fx), _mm_set1_ps(1)));
+	x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+	const __m128 z = _mm_mul_ps(x, x);
+	__m128 y = _mm_set1_ps(1.9875691500E-4f);
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507E-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073E-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894E-2f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201E-1f));
+	y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), _mm_set1_ps(1));
+	// Build 2^n from the exponent bits.
+	const __m128i n = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(127)), 23);
+	return _mm_mul_ps(y, _mm_castsi128_ps(n));
+}
+
+/**
+ * Natural logarithm of 4 floats. This is the Cephes polynomial, within a few ulps of logf. It returns -inf
+ * for 0 and NaN for negative numbers.
+ */
+static inline __m128 _ccv_nnc_log_ps(__m128 x)
+{
+	const __m128 zero_mask = _mm_cmpeq_ps(x, _mm_setzero_ps());
+	const __m128 invalid_mask = _mm_cmplt_ps(x, _mm_setzero_ps());
+	// Cut off denormalized numbers.
+	x = _mm_max_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x00800000)));
+	// Split into exponent and mantissa in [0.5, 1).
+	__m128i emm0 = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(x), 23), _mm_set1_epi32(127));
+	x = _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(~0x7f800000)));
+	x = _mm_or_ps(x, _mm_set1_ps(0.5f));
+	__m128 e = _mm_add_ps(_mm_cvtepi32_ps(emm0), _mm_set1_ps(1));
+	// If the mantissa is less than sqrt(0.5), use 2 * mantissa - 1 and decrement exponent, otherwise, mantissa - 1.
+	const __m128 mask = _mm_cmplt_ps(x, _mm_set1_ps(0.707106781186547524f));
+	const __m128 tmp = _mm_and_ps(x, mask);
+	x = _mm_sub_ps(x, _mm_set1_ps(1));
+	e = _mm_sub_ps(e, _mm_and_ps(_mm_set1_ps(1), mask));
+	x = _mm_add_ps(x, tmp);
+	const __m128 z = _mm_mul_ps(x, x);
+	__m128 y = _mm_set1_ps(7.0376836292E-2f);
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.1514610310E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.1676998740E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.2420140846E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.4249322787E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.6668057665E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(2.0000714765E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-2.4999993993E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(3.3333331174E-1f));
+	y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+	y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+	y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+	x = _mm_add_ps(_mm_add_ps(x, y), _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+	x = _mm_or_ps(x, invalid_mask); // NaN has all exponent and mantissa bits set.
+	return _mm_or_ps(_mm_andnot_ps(zero_mask, x), _mm_and_ps(zero_mask, _mm_set1_ps(-INFINITY)));
+}
+
+/**
+ * Logistic sigmoid of 4 floats, 1 / (1 + exp(-x)) with _ccv_nnc_exp_ps. Within 3 ulps of the double
+ * precision result for all floats in [-88, 88] where the result is normal (measured 2.48 ulps).
+ */
+static inline __m128 _ccv_nnc_sigmoid_ps(const __m128 x)
+{
+	const __m128 one = _mm_set1_ps(1);
+	return _mm_div_ps(one, _mm_add_ps(one, _ccv_nnc_exp_ps(_mm_sub_ps(_mm_setzero_ps(), x))));
+}
+
+/**
+ * Hyperbolic tangent of 4 floats. This is the Cephes tanhf, an odd polynomial for |x| < 0.625 and
+ * 1 - 2 / (exp(2|x|) + 1) otherwise. Within 2 ulps of the double precision result for all floats (measured 1.33 ulps).
+ */
+static inline __m128 _ccv_nnc_tanh_ps(const __m128 x)
+{
+	const __m128 sign_mask = _mm_set1_ps(-0.f);
+	const __m128 sign = _mm_and_ps(x, sign_mask);
+	const __m128 abs_x = _mm_andnot_ps(sign_mask, x);
+	const __m128 one = _mm_set1_ps(1);
+	// Large: 1 - 2 / (exp(2|x|) + 1), with the sign of x.
+	__m128 large = _mm_sub_ps(one, _mm_div_ps(_mm_set1_ps(2), _mm_add_ps(_ccv_nnc_exp_ps(_mm_add_ps(abs_x, abs_x)), one)));
+	large = _mm_or_ps(large, sign);
+	// Small: x + x * z * P(z), z = x * x.
+	const __m128 z = _mm_mul_ps(x, x);
+	__m128 y = _mm_set1_ps(-5.70498872745E-3f);
+	y = _mm_add_ps(_mm_mul_ps(y, z), _mm_set1_ps(2.06390887954E-2f));
+	y = _mm_add_ps(_mm_mul_ps(y, z), _mm_set1_ps(-5.37397155531E-2f));
+	y = _mm_add_ps(_mm_mul_ps(y, z), _mm_set1_ps(1.33314422036E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, z), _mm_set1_ps(-3.33332819422E-1f));
+	const __m128 small = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(y, z), x), x);
+	const __m128 mask = _mm_cmplt_ps(abs_x, _mm_set1_ps(0.625f));
+	return _mm_or_ps(_mm_and_ps(mask, small), _mm_andnot_ps(mask, large));
+}
+
+/**
+ * Apply the fused activation (CCV_NNC_ACTIVATION_*) to 4 floats.
+ */
+static inline __m128 _ccv_nnc_activation_ps(const int activation, const __m128 x)
+{
+	switch (activation)
+	{
+		case CCV_NNC_ACTIVATION_RELU:
+			return _mm_max_ps(x, _mm_setzero_ps());
+		case CCV_NNC_ACTIVATION_SIGMOID:
+			return _ccv_nnc_sigmoid_ps(x);
+		case CCV_NNC_ACTIVATION_TANH:
+			return _ccv_nnc_tanh_ps(x);
+		case CCV_NNC_ACTIVATION_SWISH:
+			return _mm_mul_ps(x, _ccv_nnc_sigmoid_ps(x));
+	}
+	return x;
+}
+#endif
+
+/**
+ * Apply the fused activation (CCV_NNC_ACTIVATION_*) to one float.
+ */
+static inline float _ccv_nnc_activation_f32(const int activation, const float x)
+{
+	switch (activation)
+	{
+		case CCV_NNC_ACTIVATION_RELU:
+			return ccv_max(x, 0);
+		case CCV_NNC_ACTIVATION_SIGMOID:
+			return 1. / (1. + expf(-x));
+		case CCV_NNC_ACTIVATION_TANH:
+			return tanhf(x);
+		case CCV_NNC_ACTIVATION_SWISH:
+			return x / (1. + expf(-x));
+	}
+	return x;
+}
+
+/**
+ * Apply the fused activation (CCV_NNC_ACTIVATION_*) to n floats at every stride in place. Kernels call this on
+ * the part of the output they just computed, while it is still in cache.
+ */
+static inline void _ccv_nnc_activation_cpu_opt(const int activation, float* const a, const int stride, const int n)
+{
+	if (activation == CCV_NNC_ACTIVATION_NONE)
+		return;
+	int i = 0;
+#if defined(HAVE_SSE2)
+	if (stride == 1)
+		for (; i < n - 3; i += 4)
+			_mm_storeu_ps(a + i, _ccv_nnc_activation_ps(activation, _mm_loadu_ps(a + i)));
+#endif
+	for (; i < n; i++)
+		a[i * stride] = _ccv_nnc_activation_f32(activation, a[i * stride]);
+}
+
+typedef struct {
+	int activation;
+	int rows;
+	int row_size; // The innermost dimension.
+	int dim[CCV_NNC_MAX_DIM_ALLOC];
+	int inc[CCV_NNC_MAX_DIM_ALLOC];
+	int nd;
+	float* a;
+} ccv_nnc_activation_cpu_opt_parallel_t;
+
+static inline void _ccv_nnc_activation_tensor_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_activation_cpu_opt_parallel_t* const parallel = (ccv_nnc_activation_cpu_opt_parallel_t*)context;
+	// Each task is a row of a tensor view, or a chunk of CCV_NNC_MULTI_TENSOR_CHUNK floats of a contiguous tensor.
+	if (parallel->rows == 0)
+	{
+		const int offset = idx * CCV_NNC_MULTI_TENSOR_CHUNK;
+		_ccv_nnc_activation_cpu_opt(parallel->activation, parallel->a + offset, 1, ccv_min(parallel->row_size - offset, CCV_NNC_MULTI_TENSOR_CHUNK));
+		return;
+	}
+	int row = idx;
+	size_t offset = 0, s = parallel->inc[parallel->nd - 1];
+	int k;
+	for (k = parallel->nd - 2; k >= 0; k--)
+	{
+		offset += (size_t)(row % parallel->dim[k]) * s;
+		row /= parallel->dim[k];
+		s *= parallel->inc[k];
+	}
+	_ccv_nnc_activation_cpu_opt(parallel->activation, parallel->a + offset, 1, parallel->row_size);
+}
+
+/**
+ * Apply the fused activation to the whole (32F) output tensor in place, for the kernels that cannot do it
+ * while computing the output.
+ */
+static inline void _ccv_nnc_activation_tensor_cpu_opt(const int activation, ccv_nnc_tensor_view_t* const b)
+{
+	if (activation == CCV_NNC_ACTIVATION_NONE)
+		return;
+	assert(b->info.datatype == CCV_32F);
+	ccv_nnc_activation_cpu_opt_parallel_t parallel = {
+		.activation = activation,
+		.a = b->data.f32,
+	};
+	if (!CCV_IS_TENSOR_VIEW(b))
+	{
+		parallel.row_size = ccv_nnc_tensor_count(b->info);
+		ccv_nnc_parallel_for((parallel.row_size + CCV_NNC_MULTI_TENSOR_CHUNK - 1) / CCV_NNC_MULTI_TENSOR_CHUNK, 0, _ccv_nnc_activation_tensor_parallel, &parallel);
+		return;
+	}
+	parallel.nd = ccv_nnc_tensor_nd(b->info.dim);
+	memcpy(parallel.dim, b->info.dim, sizeof(parallel.dim));
+	memcpy(parallel.inc, b->inc, sizeof(parallel.inc));
+	parallel.row_size = b->info.dim[parallel.nd - 1];
+	parallel.rows = ccv_nnc_tensor_count(b->info) / parallel.row_size;
+	ccv_nnc_parallel_for(parallel.rows, 0, _ccv_nnc_activation_tensor_parallel, &parallel);
+}
+
+/**
+ * Convert n half precision floats to single precision.
+ */
+static inline void _ccv_nnc_f16_to_f32(const ccv_float16_t* const h, float* const f, const int n)
+{
+#ifdef CCV_NNC_CPU_OPT_F16C
+	if (_ccv_nnc_cpu_opt_has_f16c())
+	{
+		_ccv_nnc_f16_to_f32_f16c(h, f, n);
+		return;
+	}
+#endif
+	ccv_half_precision_to_float((uint16_t*)h, f, n);
+}
+
+/**
+ * Convert n single precision floats to half precision.
+ */
+static inline void _ccv_nnc_f32_to_f16(const float* const f, ccv_float16_t* const h, const int n)
+{
+#ifdef CCV_NNC_CPU_OPT_F16C
+	if (_ccv_nnc_cpu_opt_has_f16c())
+	{
+		_ccv_nnc_f32_to_f16_f16c(f, h, n);
+		return;
+	}
+#endif
+	ccv_float_to_half_precision((float*)f, (uint16_t*)h, n);
+}
+
+// Random number kernels split their output into chunks of this many elements. It is a multiple of 16, thus,
+// the SIMD path of the Philox generator below stays aligned to its blocks within a chunk.
+#define CCV_NNC_RAND_CHUNK (16384)
+
+#define CCV_NNC_PHILOX_M0 (0xD2511F53)
+#define CCV_NNC_PHILOX_M1 (0xCD9E8D57)
+#define CCV_NNC_PHILOX_W0 (0x9E3779B9)
+#define CCV_NNC_PHILOX_W1 (0xBB67AE85)
+
+/**
+ * Philox4x32-10 (Salmon et al., Parallel Random Numbers: As Easy as 1, 2, 3). Encrypt the 128-bit counter
+ * with the 64-bit key to 4 random 32-bit words.
+ */
+static inline void _ccv_nnc_philox4x32_10(const uint32_t* const counter, const uint32_t* const key, uint32_t* const out)
+{
+	uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+	uint32_t k0 = key[0], k1 = key[1];
+	int i;
+	for (i = 0; i < 10; i++)
+	{
+		const uint64_t p0 = (uint64_t)CCV_NNC_PHILOX_M0 * c0;
+		const uint64_t p1 = (uint64_t)CCV_NNC_PHILOX_M1 * c2;
+		c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+		c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+		c1 = (uint32_t)p1;
+		c3 = (uint32_t)p0;
+		k0 += CCV_NNC_PHILOX_W0;
+		k1 += CCV_NNC_PHILOX_W1;
+	}
+	out[0] = c0, out[1] = c1, out[2] = c2, out[3] = c3;
+}
+
+#if defined(HAVE_SSE2)
+// The low and high 32-bit of the products of m and each lane of v.
+static inline void _ccv_nnc_philox_mulhilo_sse2(const __m128i m, const __m128i v, __m128i* const lo, __m128i* const hi)
+{
+	// Products of lane 0, 2 and lane 1, 3 respectively, as 64-bit integers.
+	const __m128i even = _mm_shuffle_epi32(_mm_mul_epu32(v, m), _MM_SHUFFLE(3, 1, 2, 0));
+	const __m128i odd = _mm_shuffle_epi32(_mm_mul_epu32(_mm_srli_epi64(v, 32), m), _MM_SHUFFLE(3, 1, 2, 0));
+	*lo = _mm_unpacklo_epi32(even, odd);
+	*hi = _mm_unpackhi_epi32(even, odd);
+}
+
+/**
+ * Philox4x32-10 of 4 consecutive counters at once. Each lane of c[i] is the i-th word of one counter, and
+ * it is the i-th word of the output for that counter on return.
+ */
+static inline void _ccv_nnc_philox4x32_10_sse2(__m128i* const c, const uint32_t* const key)
+{
+	const __m128i m0 = _mm_set1_epi32(CCV_NNC_PHILOX_M0);
+	const __m128i m1 = _mm_set1_epi32(CCV_NNC_PHILOX_M1);
+	uint32_t k0 = key[0], k1 = key[1];
+	__m128i lo0, hi0, lo1, hi1;
+	int i;
+	for (i = 0; i < 10; i++)
+	{
+		_ccv_nnc_philox_mulhilo_sse2(m0, c[0], &lo0, &hi0);
+		_ccv_nnc_philox_mulhilo_sse2(m1, c[2], &lo1, &hi1);
+		c[0] = _mm_xor_si128(_mm_xor_si128(hi1, c[1]), _mm_set1_epi32(k0));
+		c[2] = _mm_xor_si128(_mm_xor_si128(hi0, c[3]), _mm_set1_epi32(k1));
+		c[1] = lo1;
+		c[3] = lo0;
+		k0 += CCV_NNC_PHILOX_W0;
+		k1 += CCV_NNC_PHILOX_W1;
+	}
+}
+#endif
+
+// Map the top 24 bits to a float in (0, 1].
+#define CCV_NNC_PHILOX_TO_FLOAT(x) ((float)(((x) >> 8) + 1) * (1.0f / 16777216.0f))
+
+/**
+ * Fill r with n uniform random numbers in (0, 1]. The i-th number is the (offset + i)-th of the stream keyed
+ * by seed: word (offset + i) % 4 of the Philox output for counter (offset + i) / 4. Thus, any split of the
+ * stream across threads generates the same numbers.
+ */
+static inline void _ccv_nnc_philox_uniform(const uint64_t seed, const uint64_t offset, float* const r, const int n)
+{
+	const uint32_t key[2] = { (uint32_t)seed, (uint32_t)(seed >> 32) };
+	uint64_t i = offset;
+	const uint64_t end = offset + n;
+	uint32_t counter[4] = { 0, 0, 0, 0 };
+	uint32_t out[4];
+	int j;
+#if defined(HAVE_SSE2)
+	// Head, up to the next multiple of 16.
+	while (i < end && (i & 15) != 0)
+	{
+		counter[0] = (uint32_t)(i >> 2), counter[1] = (uint32_t)(i >> 34);
+		_ccv_nnc_philox4x32_10(counter, key, out);
+		for (j = i & 3; j < 4 && i < end; j++, i++)
+			r[i - offset] = CCV_NNC_PHILOX_TO_FLOAT(out[j]);
+	}
+	const __m128 scale = _mm_set1_ps(1.0f / 16777216.0f);
+	const __m128i one = _mm_set1_epi32(1);
+	for (; end - i >= 16; i += 16)
+	{
+		const uint64_t b = i >> 2;
+		__m128i c[4] = {
+			_mm_set_epi32((uint32_t)(b + 3), (uint32_t)(b + 2), (uint32_t)(b + 1), (uint32_t)b),
+			_mm_set_epi32((uint32_t)((b + 3) >> 32), (uint32_t)((b + 2) >> 32), (uint32_t)((b + 1) >> 32), (uint32_t)(b >> 32)),
+			_mm_setzero_si128(),
+			_mm_setzero_si128(),
+		};
+		_ccv_nnc_philox4x32_10_sse2(c, key);
+		// Transpose such that each register holds the 4 words of one counter.
+		const __m128i t0 = _mm_unpacklo_epi32(c[0], c[1]);
+		const __m128i t1 = _mm_unpacklo_epi32(c[2], c[3]);
+		const __m128i t2 = _mm_unpackhi_epi32(c[0], c[1]);
+		const __m128i t3 = _mm_unpackhi_epi32(c[2], c[3]);
+		const __m128i w[4] = {
+			_mm_unpacklo_epi64(t0, t1),
+			_mm_unpackhi_epi64(t0, t1),
+			_mm_unpacklo_epi64(t2, t3),
+			_mm_unpackhi_epi64(t2, t3),
+		};
+		float* const rp = r + (i - offset);
+		for (j = 0; j < 4; j++)
+			_mm_storeu_ps(rp + j * 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_srli_epi32(w[j], 8), one)), scale));
+	}
+#endif
+	// Tail.
+	while (i < end)
+	{
+		counter[0] = (uint32_t)(i >> 2), counter[1] = (uint32_t)(i >> 34);
+		_ccv_nnc_philox4x32_10(counter, key, out);
+		for (j = i & 3; j < 4 && i < end; j++, i++)
+			r[i - offset] = CCV_NNC_PHILOX_TO_FLOAT(out[j]);
+	}
+}
+
+#endif
@@ -0,0 +1,117 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+
+// Shared methods.
+#include "../_ccv_nnc_cpu_opt.h"
+
+typedef struct {
+	const ccv_nnc_multi_tensor_chunk_t* chunks;
+	ccv_nnc_tensor_t* const* inputs;
+	ccv_nnc_tensor_t* const* outputs;
+	float clip;
+	float beta1;
+	float beta2;
+	float decay;
+	float epsilon;
+	float rate_inv_bias_correction1;
+	float inv_bias_correction2;
+} ccv_nnc_adam_parallel_t;
+
+static void _ccv_nnc_adam_forw_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_adam_parallel_t* const parallel = (ccv_nnc_adam_parallel_t*)context;
+	const ccv_nnc_multi_tensor_chunk_t chunk = parallel->chunks[idx];
+	ccv_nnc_tensor_t* const* const inputs = parallel->inputs + chunk.group * 4;
+	ccv_nnc_tensor_t* const* const outputs = parallel->outputs + chunk.group * 3;
+	const float* const gp = inputs[0]->data.f32 + chunk.offset;
+	const float* const ap = inputs[1]->data.f32 + chunk.offset;
+	const float* const mp = inputs[2]->data.f32 + chunk.offset;
+	const float* const vp = inputs[3]->data.f32 + chunk.offset;
+	float* const bp = outputs[0]->data.f32 + chunk.offset;
+	float* const np = outputs[1]->data.f32 + chunk.offset;
+	float* const up = outputs[2]->data.f32 + chunk.offset;
+	const float clip = parallel->clip;
+	const float beta1 = parallel->beta1;
+	const float beta2 = parallel->beta2;
+	const float decay = parallel->decay;
+	const float epsilon = parallel->epsilon;
+	const float rate_inv_bias_correction1 = parallel->rate_inv_bias_correction1;
+	const float inv_bias_correction2 = parallel->inv_bias_correction2;
+	const int count = chunk.count;
+	int x = 0;
+#if defined(HAVE_SSE2)
+	const __m128 clip4 = _mm_set1_ps(clip);
+	const __m128 beta14 = _mm_set1_ps(beta1);
+	const __m128 beta24 = _mm_set1_ps(beta2);
+	const __m128 one_minus_beta14 = _mm_set1_ps(1 - beta1);
+	const __m128 one_minus_beta24 = _mm_set1_ps(1 - beta2);
+	const __m128 decay4 = _mm_set1_ps(decay);
+	const __m128 epsilon4 = _mm_set1_ps(epsilon);
+	const __m128 rate_inv_bias_correction14 = _mm_set1_ps(rate_inv_bias_correction1);
+	const __m128 inv_bias_correction24 = _mm_set1_ps(inv_bias_correction2);
+	for (; x < count - 3; x += 4)
+	{
+		const __m128 a = _mm_loadu_ps(ap + x);
+		const __m128 grad = _mm_add_ps(_mm_mul_ps(clip4, _mm_loadu_ps(gp + x)), _mm_mul_ps(decay4, a));
+		const __m128 mom = _mm_add_ps(_mm_mul_ps(beta14, _mm_loadu_ps(mp + x)), _mm_mul_ps(one_minus_beta14, grad));
+		const __m128 vel = _mm_add_ps(_mm_mul_ps(beta24, _mm_loadu_ps(vp + x)), _mm_mul_ps(_mm_mul_ps(one_minus_beta24, grad), grad));
+		_mm_storeu_ps(np + x, mom);
+		_mm_storeu_ps(up + x, vel);
+		_mm_storeu_ps(bp + x, _mm_sub_ps(a, _mm_div_ps(_mm_mul_ps(mom, rate_inv_bias_correction14), _mm_add_ps(_mm_sqrt_ps(_mm_mul_ps(vel, inv_bias_correction24)), epsilon4))));
+	}
+#endif
+	for (; x < count; x++)
+	{
+		float grad = clip * gp[x];
+		grad += decay * ap[x];
+		const float mom = np[x] = beta1 * mp[x] + (1 - beta1) * grad;
+		const float vel = up[x] = beta2 * vp[x] + (1 - beta2) * grad * grad;
+		bp[x] = ap[x] - (mom * rate_inv_bias_correction1) / (sqrtf(vel * inv_bias_correction2) + epsilon);
+	}
+}
+
+static int _ccv_nnc_adam_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	// Multiple parameters can be updated in one command, 4 inputs and 3 outputs each.
+	assert(input_size % 4 == 0);
+	assert(output_size == input_size / 4 * 3);
+	int i;
+	for (i = 0; i < input_size; i++)
+		if (CCV_IS_TENSOR_VIEW(inputs[i]))
+			return CCV_NNC_EXEC_INVALID;
+	for (i = 0; i < output_size; i++)
+		if (CCV_IS_TENSOR_VIEW(outputs[i]))
+			return CCV_NNC_EXEC_INVALID;
+	const int step = cmd.info.adam.step;
+	assert(step >= 1);
+	const int chunk_count = _ccv_nnc_multi_tensor_chunks(inputs, input_size, 4, 0);
+	double* const sums = (double*)ccv_nnc_stream_context_get_workspace(stream_context, (sizeof(double) + sizeof(ccv_nnc_multi_tensor_chunk_t)) * chunk_count, CCV_TENSOR_CPU_MEMORY);
+	ccv_nnc_multi_tensor_chunk_t* const chunks = (ccv_nnc_multi_tensor_chunk_t*)(sums + chunk_count);
+	_ccv_nnc_multi_tensor_chunks(inputs, input_size, 4, chunks);
+	ccv_nnc_adam_parallel_t parallel = {
+		.chunks = chunks,
+		.inputs = inputs,
+		.outputs = outputs,
+		.clip = _ccv_nnc_multi_tensor_clip(cmd.info.adam.max_norm, 1, inputs, 4, chunks, chunk_count, sums),
+		.beta1 = cmd.info.adam.beta1,
+		.beta2 = cmd.info.adam.beta2,
+		.decay = cmd.info.adam.decay,
+		.epsilon = cmd.info.adam.epsilon,
+		.rate_inv_bias_correction1 = cmd.info.adam.rate / (1 - powf(cmd.info.adam.beta1, step)),
+		.inv_bias_correction2 = 1. / (1 - powf(cmd.info.adam.beta2, step)),
+	};
+	ccv_nnc_parallel_for(chunk_count, 0, _ccv_nnc_adam_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_ADAM_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_adam_forw;
+}
@@ -0,0 +1,78 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+
+// Shared with the elementwise and reduce commands.
+#include "../ew/_ccv_nnc_ew_cpu_opt.h"
+#include "../reduce/_ccv_nnc_reduce_cpu_opt.h"
+#include "../_ccv_nnc_cpu_ref.h"
+
+static int _ccv_nnc_add_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 2);
+	const float p = cmd.info.blas.a[0];
+	const float q = cmd.info.blas.a[1];
+	if (inputs[1] == 0)
+	{
+		// It cannot be set otherwise we have trouble.
+		assert(q == 0);
+		_ccv_nnc_ew_activation_cpu_opt(CCV_NNC_EW_CPU_OPT_SCALE, p, 0, (ccv_nnc_tensor_view_t*)inputs[0], 0, (ccv_nnc_tensor_view_t*)outputs[0], cmd.info.activation.type);
+	} else
+		_ccv_nnc_ew_activation_cpu_opt(CCV_NNC_EW_CPU_OPT_SUM, p, q, (ccv_nnc_tensor_view_t*)inputs[0], (ccv_nnc_tensor_view_t*)inputs[1], (ccv_nnc_tensor_view_t*)outputs[0], cmd.info.activation.type);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_ADD_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->activations = CCV_NNC_ACTIVATION_ALL;
+	registry->exec = _ccv_nnc_add_forw;
+}
+
+static int _ccv_nnc_add_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	int k;
+	if (inputs[0] == 0)
+	{
+		for (k = 0; k < ccv_min(output_size, 2); k++)
+			if (outputs[k])
+				_ccv_nnc_tensor_set_cpu_ref((ccv_nnc_tensor_view_t*)outputs[k], cmd.info.blas.a[k]);
+		return CCV_NNC_EXEC_SUCCESS;
+	}
+	int gdim[CCV_NNC_MAX_DIM_ALLOC];
+	ccv_nnc_tensor_view_t* const g = (ccv_nnc_tensor_view_t*)inputs[0];
+	ccv_nnc_tensor_view_get_dim(g, gdim);
+	for (k = 0; k < ccv_min(output_size, 2); k++)
+	{
+		if (!outputs[k])
+			continue;
+		ccv_nnc_tensor_view_t* const a = (ccv_nnc_tensor_view_t*)outputs[k];
+		const float p = cmd.info.blas.a[k];
+		if (ccv_nnc_tensor_view_check_dim(a, gdim))
+		{
+			_ccv_nnc_ew_cpu_opt(CCV_NNC_EW_CPU_OPT_SCALE, p, 0, g, 0, a);
+			continue;
+		}
+		// The gradient of a broadcast is the sum over the broadcast axes.
+		const int status = _ccv_nnc_reduce_cpu_opt(CCV_NNC_REDUCE_CPU_OPT_SUM, cmd.algorithm, g, a, stream_context);
+		if (status != CCV_NNC_EXEC_SUCCESS)
+			return status;
+		if (p != 1)
+			_ccv_nnc_ew_cpu_opt(CCV_NNC_EW_CPU_OPT_SCALE, p, 0, a, 0, a);
+	}
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_ADD_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = CCV_NNC_CMD_OPT_REDUCE_ALGO_COUNT;
+	registry->exec = _ccv_nnc_add_back;
+}
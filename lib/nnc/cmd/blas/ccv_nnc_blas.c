@@ -17,6 +17,9 @@ static int _ccv_nnc_gemm_forw_bitmask(const int input_size, const int output_siz
 	// No bias is OK.
 	if (input_size == 2 && (input_bitmasks[0] & 3u) == ((1u << 0) | (1u << 1)) && output_bitmasks[0] == 1u)
 		return 1;
+	// Quantized input and weights, followed by the activation scale and the weight scales. Bias is optional.
+	if (input_size == 5 && (input_bitmasks[0] & 27u) == ((1u << 0) | (1u << 1) | (1u << 3) | (1u << 4)) && output_bitmasks[0] == 1u)
+		return 1;
 	return 0;
 }
 
@@ -47,7 +50,8 @@ static void _ccv_nnc_gemm_tensor_auto_forw(const ccv_nnc_cmd_param_t cmd, const
 	ccv_nnc_tensor_get_matrix_params(inputs[1], inputs[1].dim, cmd.blas.transpose_b, &w_batch_size, &w_rows, &w_cols, &w_batch_inc, &w_rows_inc, &w_cols_inc);
 	outputs[0].type = inputs[0].type;
 	outputs[0].format = inputs[0].format;
-	outputs[0].datatype = inputs[0].datatype;
+	// Quantized GEMM dequantizes its output.
+	outputs[0].datatype = inputs[0].datatype == CCV_8S ? CCV_32F : inputs[0].datatype;
 	int b_rows = a_rows, b_cols = w_cols;
 	if (a_nd == 1) {
 		outputs[0].dim[0] = b_cols;
@@ -118,7 +122,7 @@ static void _ccv_nnc_broadcast_tensor_auto_forw(const ccv_nnc_cmd_param_t cmd, c
 }
 
 REGISTER_COMMAND(CCV_NNC_ADD_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_add_cpu_ref.c, gpu/ccv_nnc_add_gpu_cudnn.cu)
+	FIND_BACKEND(ccv_nnc_add_cpu_ref.c, ccv_nnc_add_cpu_opt.c, gpu/ccv_nnc_add_gpu_cudnn.cu)
 {
 	registry->bitmask = _ccv_nnc_add_forw_bitmask;
 	registry->tensor_auto = _ccv_nnc_broadcast_tensor_auto_forw;
@@ -126,7 +130,7 @@ REGISTER_COMMAND(CCV_NNC_ADD_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
 }
 
 REGISTER_COMMAND(CCV_NNC_ADD_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_add_cpu_ref.c, gpu/ccv_nnc_add_gpu_cudnn.cu)
+	FIND_BACKEND(ccv_nnc_add_cpu_ref.c, ccv_nnc_add_cpu_opt.c, gpu/ccv_nnc_add_gpu_cudnn.cu)
 {
 	registry->flags = CCV_NNC_CMD_ATTR_NULL_IS_ONES;
 	registry->bitmask = _ccv_nnc_add_back_bitmask;
@@ -160,7 +164,7 @@ static int _ccv_nnc_mul_back_bitmask(const int input_size, const int output_size
 }
 
 REGISTER_COMMAND(CCV_NNC_MUL_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_mul_cpu_ref.c, gpu/ccv_nnc_mul_gpu_cudnn.cu)
+	FIND_BACKEND(ccv_nnc_mul_cpu_ref.c, ccv_nnc_mul_cpu_opt.c, gpu/ccv_nnc_mul_gpu_cudnn.cu)
 {
 	registry->bitmask = _ccv_nnc_mul_forw_bitmask;
 	registry->tensor_auto = _ccv_nnc_broadcast_tensor_auto_forw;
@@ -196,7 +200,7 @@ static int _ccv_nnc_scalar_mul_back_bitmask(const int input_size, const int outp
 }
 
 REGISTER_COMMAND(CCV_NNC_SCALAR_MUL_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_mul_cpu_ref.c, gpu/ccv_nnc_mul_gpu_cudnn.cu)
+	FIND_BACKEND(ccv_nnc_mul_cpu_ref.c, ccv_nnc_mul_cpu_opt.c, gpu/ccv_nnc_mul_gpu_cudnn.cu)
 {
 	registry->bitmask = _ccv_nnc_scalar_mul_forw_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
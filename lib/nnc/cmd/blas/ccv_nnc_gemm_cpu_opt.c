@@ -6,15 +6,18 @@
 
 #include "_ccv_nnc_gemm_cpu_opt.h"
 
-FIND_FILE(cpu_opt/_ccv_nnc_gemm_cpu_opt.c, cpu_sys/_ccv_nnc_gemm_cpu_sys.c)
+// Shared methods.
+#include "../_ccv_nnc_cpu_opt.h"
+
+FIND_FILE(cpu_opt/_ccv_nnc_gemm_cpu_opt.c, cpu_opt/_ccv_nnc_gemm_cpu_packed.c, cpu_sys/_ccv_nnc_gemm_cpu_sys.c)
 
 enum {
-	CCV_NNC_CMD_OPT_GEMM_ALGO_DIRECT, // Direct multiplication
+	CCV_NNC_CMD_OPT_GEMM_ALGO_DIRECT, // Direct multiplication, with packed and cache blocked GEMM for batches
 	CCV_NNC_CMD_OPT_GEMM_ALGO_SYSTEM, // Use system GEMM
 	CCV_NNC_CMD_OPT_GEMM_ALGO_COUNT
 };
 
-static int _ccv_nnc_gemm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+static int _ccv_nnc_gemm_forw_linear(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
 	assert(input_size >= 2);
 	const ccv_nnc_tensor_view_t* w = (const ccv_nnc_tensor_view_t*)inputs[1];
@@ -24,6 +27,30 @@ static int _ccv_nnc_gemm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 	// Cannot compute if w is not transposed and dimensions are batched.
 	// Copy the most of parameters, but reshape the dimension of a to a vector.
 	assert(output_size == 1);
+	if (a->info.datatype == CCV_8S)
+	{
+		// The quantized GEMM takes the activation scale and the weight scales after the bias, and only does direct multiplication.
+		if (input_size < 5 || w->info.datatype != CCV_8S || cmd.algorithm == CCV_NNC_CMD_OPT_GEMM_ALGO_SYSTEM ||
+			ccv_nnc_tensor_nd(a->info.dim) > 2 || ccv_nnc_tensor_nd(b->info.dim) > 2 ||
+			ccv_nnc_tensor_nd(w->info.dim) > 2 ||
+			(bias && ccv_nnc_tensor_nd(bias->info.dim) > 1) ||
+			cmd.info.blas.transpose_a[0] != cmd.info.blas.transpose_a[1] ||
+			cmd.info.blas.transpose_b[0] == cmd.info.blas.transpose_b[1])
+			return CCV_NNC_EXEC_INVALID;
+		return _ccv_nnc_gemm_forw_8s_cpu_opt(a, w, bias, (const ccv_nnc_tensor_view_t*)inputs[3], (const ccv_nnc_tensor_view_t*)inputs[4], b, stream_context);
+	}
+	if (a->info.datatype == CCV_16F || w->info.datatype == CCV_16F || (bias && bias->info.datatype == CCV_16F) || b->info.datatype == CCV_16F)
+	{
+		// Only direct multiplication can handle half precision, system GEMM cannot.
+		if (cmd.algorithm == CCV_NNC_CMD_OPT_GEMM_ALGO_SYSTEM ||
+			ccv_nnc_tensor_nd(a->info.dim) > 2 || ccv_nnc_tensor_nd(b->info.dim) > 2 ||
+			ccv_nnc_tensor_nd(w->info.dim) > 2 ||
+			(bias && ccv_nnc_tensor_nd(bias->info.dim) > 1) ||
+			cmd.info.blas.transpose_a[0] != cmd.info.blas.transpose_a[1] ||
+			cmd.info.blas.transpose_b[0] == cmd.info.blas.transpose_b[1])
+			return CCV_NNC_EXEC_INVALID;
+		return _ccv_nnc_gemm_forw_16f_cpu_opt(a, w, bias, b, stream_context);
+	}
 	switch (cmd.algorithm)
 	{
 		case CCV_NNC_CMD_OPT_GEMM_ALGO_DIRECT:
@@ -66,6 +93,15 @@ static int _ccv_nnc_gemm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 	return _ccv_nnc_gemm_forw_cpu_opt(a, w, bias, b);
 }
 
+static int _ccv_nnc_gemm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	const int result = _ccv_nnc_gemm_forw_linear(cmd, hint, flags, inputs, input_size, outputs, output_size, stream_context);
+	// Neither the system GEMM nor the packed kernel hands out its tiles, apply the fused activation as one more pass.
+	if (result == CCV_NNC_EXEC_SUCCESS)
+		_ccv_nnc_activation_tensor_cpu_opt(cmd.info.activation.type, (ccv_nnc_tensor_view_t*)outputs[0]);
+	return result;
+}
+
 static int _ccv_nnc_gemm_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
 	// inputs: gradient, forw prop input, [w]
@@ -138,9 +174,10 @@ static int _ccv_nnc_gemm_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 REGISTER_COMMAND_BACKEND(CCV_NNC_GEMM_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
 {
 	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW;
-	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_datatypes = CCV_32F | CCV_16F | CCV_8S;
 	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
 	registry->algorithms = CCV_NNC_CMD_OPT_GEMM_ALGO_COUNT;
+	registry->activations = CCV_NNC_ACTIVATION_ALL;
 	registry->exec = _ccv_nnc_gemm_forw;
 }
 
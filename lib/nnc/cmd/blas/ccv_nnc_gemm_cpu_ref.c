@@ -3,12 +3,44 @@
 #include "nnc/ccv_nnc.h"
 #include "nnc/ccv_nnc_easy.h"
 #include "nnc/ccv_nnc_internal.h"
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif
-#ifdef USE_DISPATCH
-#include <dispatch/dispatch.h>
-#endif
+
+typedef struct {
+	const ccv_nnc_tensor_view_t* a;
+	const ccv_nnc_tensor_view_t* w;
+	const ccv_nnc_tensor_view_t* bias;
+	ccv_nnc_tensor_view_t* b;
+	int batch_size;
+	int rows;
+	int a_cols;
+	int a_batch_inc, a_rows_inc, a_cols_inc;
+	int w_batch_inc, w_rows_inc, w_cols_inc;
+	int bias_batch_inc, bias_rows_inc, bias_cols_inc;
+	int b_batch_inc, b_rows_inc, b_cols_inc;
+} ccv_nnc_gemm_forw_parallel_t;
+
+static void _ccv_nnc_gemm_forw_parallel(void* const context, const int j)
+{
+	const ccv_nnc_gemm_forw_parallel_t* const parallel = (ccv_nnc_gemm_forw_parallel_t*)context;
+	const int a_cols = parallel->a_cols;
+	const int a_cols_inc = parallel->a_cols_inc;
+	const int w_rows_inc = parallel->w_rows_inc;
+	int n, i, k;
+	for (n = 0; n < parallel->batch_size; n++)
+	{
+		const float* const ap = parallel->a->data.f32 + n * parallel->a_batch_inc;
+		const float* const wpj = parallel->w->data.f32 + n * parallel->w_batch_inc + j * parallel->w_cols_inc;
+		const float* const biasp = parallel->bias ? parallel->bias->data.f32 + n * parallel->bias_batch_inc + j * parallel->bias_cols_inc : 0;
+		float* const bp = parallel->b->data.f32 + n * parallel->b_batch_inc + j * parallel->b_cols_inc;
+		for (i = 0; i < parallel->rows; i++)
+		{
+			const float* const api = ap + i * parallel->a_rows_inc;
+			float v = biasp ? biasp[i * parallel->bias_rows_inc] : 0;
+			for (k = 0; k < a_cols; k++)
+				v += wpj[k * w_rows_inc] * api[k * a_cols_inc];
+			bp[i * parallel->b_rows_inc] = v;
+		}
+	}
+}
 
 static int _ccv_nnc_gemm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
@@ -37,7 +69,23 @@ static int _ccv_nnc_gemm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 	assert(a_rows == b_rows);
 	assert(a_cols == w_rows);
 	assert(w_cols == b_cols);
-	int n, i;
+	ccv_nnc_gemm_forw_parallel_t parallel = {
+		.a = a,
+		.w = w,
+		.b = b,
+		.batch_size = b_batch_size,
+		.rows = b_rows,
+		.a_cols = a_cols,
+		.a_batch_inc = a_batch_inc,
+		.a_rows_inc = a_rows_inc,
+		.a_cols_inc = a_cols_inc,
+		.w_batch_inc = w_batch_inc,
+		.w_rows_inc = w_rows_inc,
+		.w_cols_inc = w_cols_inc,
+		.b_batch_inc = b_batch_inc,
+		.b_rows_inc = b_rows_inc,
+		.b_cols_inc = b_cols_inc,
+	};
 	if (bias)
 	{
 		int bias_batch_size, bias_rows, bias_cols, bias_batch_inc, bias_rows_inc, bias_cols_inc;
@@ -48,49 +96,72 @@ static int _ccv_nnc_gemm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 		if (bias_rows == 1 && b_rows > 1)
 			bias_rows_inc = 0;
 		assert(bias_cols == b_cols);
-		for (n = 0; n < b_batch_size; n++)
+		parallel.bias = bias;
+		parallel.bias_batch_inc = bias_batch_inc;
+		parallel.bias_rows_inc = bias_rows_inc;
+		parallel.bias_cols_inc = bias_cols_inc;
+	}
+	// Each column of the output is computed independently, thus, no need to synchronize.
+	ccv_nnc_parallel_for(b_cols, 0, _ccv_nnc_gemm_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+typedef struct {
+	const ccv_nnc_tensor_view_t* g;
+	const ccv_nnc_tensor_view_t* a; // a for dw, w for h.
+	ccv_nnc_tensor_view_t* o; // dw or h.
+	int zero;
+	int batch_size;
+	int rows;
+	int cols;
+	int g_batch_inc, g_rows_inc, g_cols_inc;
+	int a_batch_inc, a_rows_inc, a_cols_inc;
+	int o_batch_inc, o_rows_inc, o_cols_inc;
+} ccv_nnc_gemm_back_parallel_t;
+
+static void _ccv_nnc_gemm_back_dw_parallel(void* const context, const int j)
+{
+	const ccv_nnc_gemm_back_parallel_t* const parallel = (ccv_nnc_gemm_back_parallel_t*)context;
+	const int a_cols = parallel->cols;
+	const int a_cols_inc = parallel->a_cols_inc;
+	const int dw_rows_inc = parallel->o_rows_inc;
+	int n, i, k;
+	for (n = 0; n < parallel->batch_size; n++)
+	{
+		const float* const gp = parallel->g->data.f32 + n * parallel->g_batch_inc + j * parallel->g_cols_inc;
+		const float* const ap = parallel->a->data.f32 + n * parallel->a_batch_inc;
+		float* const dwpj = parallel->o->data.f32 + n * parallel->o_batch_inc + j * parallel->o_cols_inc;
+		for (i = 0; i < parallel->rows; i++)
 		{
-			const float* const ap = a->data.f32 + n * a_batch_inc;
-			const float* const wp = w->data.f32 + n * w_batch_inc;
-			const float* const biasp = bias->data.f32 + n * bias_batch_inc;
-			float* const bp = b->data.f32 + n * b_batch_inc;
-			for (i = 0; i < b_rows; i++)
-			{
-				const float* const api = ap + i * a_rows_inc;
-				const float* const biaspi = biasp + i * bias_rows_inc;
-				float* const bpi = bp + i * b_rows_inc;
-				parallel_for(j, b_cols) {
-					float v = biaspi[j * bias_cols_inc];
-					const float* const wpj = wp + j * w_cols_inc;
-					int k;
-					for (k = 0; k < a_cols; k++)
-						v += wpj[k * w_rows_inc] * api[k * a_cols_inc];
-					bpi[j * b_cols_inc] = v;
-				} parallel_endfor
-			}
+			const float v = gp[i * parallel->g_rows_inc];
+			const float* const api = ap + i * parallel->a_rows_inc;
+			for (k = 0; k < a_cols; k++)
+				dwpj[k * dw_rows_inc] += api[k * a_cols_inc] * v;
 		}
-	} else {
-		for (n = 0; n < b_batch_size; n++)
+	}
+}
+
+static void _ccv_nnc_gemm_back_h_parallel(void* const context, const int j)
+{
+	const ccv_nnc_gemm_back_parallel_t* const parallel = (ccv_nnc_gemm_back_parallel_t*)context;
+	const int g_cols = parallel->cols;
+	const int g_cols_inc = parallel->g_cols_inc;
+	const int w_cols_inc = parallel->a_cols_inc;
+	int n, i, k;
+	for (n = 0; n < parallel->batch_size; n++)
+	{
+		const float* const gp = parallel->g->data.f32 + n * parallel->g_batch_inc;
+		const float* const wpj = parallel->a->data.f32 + n * parallel->a_batch_inc + j * parallel->a_rows_inc;
+		float* const hpj = parallel->o->data.f32 + n * parallel->o_batch_inc + j * parallel->o_cols_inc;
+		for (i = 0; i < parallel->rows; i++)
 		{
-			const float* const ap = a->data.f32 + n * a_batch_inc;
-			const float* const wp = w->data.f32 + n * w_batch_inc;
-			float* const bp = b->data.f32 + n * b_batch_inc;
-			for (i = 0; i < b_rows; i++)
-			{
-				const float* const api = ap + i * a_rows_inc;
-				float* const bpi = bp + i * b_rows_inc;
-				parallel_for(j, b_cols) {
-					float v = 0;
-					const float* const wpj = wp + j * w_cols_inc;
-					int k;
-					for (k = 0; k < a_cols; k++)
-						v += wpj[k * w_rows_inc] * api[k * a_cols_inc];
-					bpi[j * b_cols_inc] = v;
-				} parallel_endfor
-			}
+			const float* const gpi = gp + i * parallel->g_rows_inc;
+			float v = parallel->zero ? 0 : hpj[i * parallel->o_rows_inc];
+			for (k = 0; k < g_cols; k++)
+				v += wpj[k * w_cols_inc] * gpi[k * g_cols_inc];
+			hpj[i * parallel->o_rows_inc] = v;
 		}
 	}
-	return CCV_NNC_EXEC_SUCCESS;
 }
 
 static int _ccv_nnc_gemm_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
@@ -150,24 +221,25 @@ static int _ccv_nnc_gemm_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 		assert(dw_batch_size == g_batch_size || dw_batch_size == 1);
 		if (dw_batch_size == 1 && g_batch_size > 1)
 			dw_batch_inc = 0;
-		for (n = 0; n < g_batch_size; n++)
-		{
-			const float* const gp = g->data.f32 + n * g_batch_inc;
-			const float* const ap = a->data.f32 + n * a_batch_inc;
-			float* const dwp = dw->data.f32 + n * dw_batch_inc;
-			for (i = 0; i < a_rows; i++)
-			{
-				const float* const gpi = gp + i * g_rows_inc;
-				const float* const api = ap + i * a_rows_inc;
-				parallel_for(j, g_cols) {
-					const float v = gpi[j * g_cols_inc];
-					float* dwpj = dwp + j * dw_cols_inc;
-					int k;
-					for (k = 0; k < a_cols; k++)
-						dwpj[k * dw_rows_inc] += api[k * a_cols_inc] * v;
-				} parallel_endfor
-			}
-		}
+		ccv_nnc_gemm_back_parallel_t parallel = {
+			.g = g,
+			.a = a,
+			.o = dw,
+			.batch_size = g_batch_size,
+			.rows = a_rows,
+			.cols = a_cols,
+			.g_batch_inc = g_batch_inc,
+			.g_rows_inc = g_rows_inc,
+			.g_cols_inc = g_cols_inc,
+			.a_batch_inc = a_batch_inc,
+			.a_rows_inc = a_rows_inc,
+			.a_cols_inc = a_cols_inc,
+			.o_batch_inc = dw_batch_inc,
+			.o_rows_inc = dw_rows_inc,
+			.o_cols_inc = dw_cols_inc,
+		};
+		// dw accumulates over the batch and the rows, split by its columns such that no two threads write to the same place.
+		ccv_nnc_parallel_for(g_cols, 0, _ccv_nnc_gemm_back_dw_parallel, &parallel);
 	}
 	ccv_nnc_tensor_view_t* h = (ccv_nnc_tensor_view_t*)outputs[0];
 	if (h)
@@ -186,25 +258,25 @@ static int _ccv_nnc_gemm_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 		assert(w_batch_size == g_batch_size || w_batch_size == 1);
 		if (w_batch_size == 1 && g_batch_size > 1)
 			w_batch_inc = 0;
-		for (n = 0; n < g_batch_size; n++)
-		{
-			const float* const gp = g->data.f32 + n * g_batch_inc;
-			const float* const wp = w->data.f32 + n * w_batch_inc;
-			float* const hp = h->data.f32 + n * h_batch_inc;
-			for (i = 0; i < h_rows; i++)
-			{
-				const float* const gpi = gp + i * g_rows_inc;
-				float* const hpi = hp + i * h_rows_inc;
-				parallel_for(j, h_cols) {
-					const float* const wpj = wp + j * w_rows_inc;
-					float v = zero_h ? 0 : hpi[j * h_cols_inc];
-					int k;
-					for (k = 0; k < g_cols; k++)
-						v += wpj[k * w_cols_inc] * gpi[k * g_cols_inc];
-					hpi[j * h_cols_inc] = v;
-				} parallel_endfor
-			}
-		}
+		ccv_nnc_gemm_back_parallel_t parallel = {
+			.g = g,
+			.a = w,
+			.o = h,
+			.zero = zero_h,
+			.batch_size = g_batch_size,
+			.rows = h_rows,
+			.cols = g_cols,
+			.g_batch_inc = g_batch_inc,
+			.g_rows_inc = g_rows_inc,
+			.g_cols_inc = g_cols_inc,
+			.a_batch_inc = w_batch_inc,
+			.a_rows_inc = w_rows_inc,
+			.a_cols_inc = w_cols_inc,
+			.o_batch_inc = h_batch_inc,
+			.o_rows_inc = h_rows_inc,
+			.o_cols_inc = h_cols_inc,
+		};
+		ccv_nnc_parallel_for(h_cols, 0, _ccv_nnc_gemm_back_h_parallel, &parallel);
 	}
 	return CCV_NNC_EXEC_SUCCESS;
 }
@@ -8,15 +8,59 @@
 #elif defined(HAVE_NEON)
 #include <arm_neon.h>
 #endif
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif
-#ifdef USE_DISPATCH
-#include <dispatch/dispatch.h>
-#endif
 #include "../_ccv_nnc_gemm_cpu_opt.h"
+#include "../../_ccv_nnc_cpu_opt.h"
+
+typedef struct {
+	const ccv_nnc_tensor_view_t* a;
+	const ccv_nnc_tensor_view_t* w;
+	const ccv_nnc_tensor_view_t* bias;
+	const ccv_nnc_tensor_view_t* g;
+	ccv_nnc_tensor_view_t* b;
+	ccv_nnc_tensor_view_t* dw;
+	ccv_nnc_tensor_view_t* h;
+	int batch_size;
+	int adim;
+	int gdim;
+	int a_batch_inc;
+	int b_batch_inc;
+	int g_batch_inc;
+	int h_batch_inc;
+	const int* winc;
+	const int* dwinc;
+} ccv_nnc_gemm_cpu_opt_parallel_t;
 
 #ifdef HAVE_SSE2
+static void _ccv_nnc_gemm_forw_sse2_parallel(void* const context, const int j)
+{
+	const ccv_nnc_gemm_cpu_opt_parallel_t* const parallel = (ccv_nnc_gemm_cpu_opt_parallel_t*)context;
+	const int adim = parallel->adim;
+	const float* const wp = parallel->w->data.f32 + j * parallel->winc[1];
+	const float biasval = parallel->bias ? parallel->bias->data.f32[j] : 0;
+	int i;
+	for (i = 0; i < parallel->batch_size; i++)
+	{
+		const float* const ap = parallel->a->data.f32 + i * parallel->a_batch_inc;
+		float* const bp = parallel->b->data.f32 + i * parallel->b_batch_inc;
+		int k;
+		__m128 v40 = _mm_set_ss(biasval);
+		__m128 v41 = _mm_setzero_ps();
+		for (k = 0; k < adim - 7; k += 8)
+		{
+			__m128 ap40 = _mm_load_ps(ap + k);
+			__m128 ap41 = _mm_load_ps(ap + k + 4);
+			__m128 w40 = _mm_load_ps(wp + k);
+			__m128 w41 = _mm_load_ps(wp + k + 4);
+			v40 =_mm_add_ps(_mm_mul_ps(w40, ap40), v40);
+			v41 =_mm_add_ps(_mm_mul_ps(w41, ap41), v41);
+		}
+		v40 = _mm_add_ps(v40, v41);
+		v41 = _mm_add_ps(v40, _mm_movehl_ps(v40, v40));
+		v40 = _mm_add_ss(v41, _mm_shuffle_ps(v41, v41, 1));
+		_mm_store_ss(bp + j, v40);
+	}
+}
+
 static int _ccv_nnc_gemm_forw_sse2(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b)
 {
 	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
@@ -31,60 +75,78 @@ static int _ccv_nnc_gemm_forw_sse2(const ccv_nnc_tensor_view_t* const a, const c
 	const int a_batch_inc = CCV_IS_TENSOR_VIEW(a) ? (a_nd == 1 ? a->inc[0] : a->inc[1]) : adim[0];
 	const int b_batch_inc = CCV_IS_TENSOR_VIEW(b) ? (b_nd == 1 ? b->inc[0] : b->inc[1]) : bdim[0];
 	const int* winc = CCV_IS_TENSOR_VIEW(w) ? w->inc : w->info.dim;
+	ccv_nnc_gemm_cpu_opt_parallel_t parallel = {
+		.a = a,
+		.w = w,
+		.bias = bias,
+		.b = b,
+		.batch_size = batch_size,
+		.adim = adim[0],
+		.a_batch_inc = a_batch_inc,
+		.b_batch_inc = b_batch_inc,
+		.winc = winc,
+	};
+	ccv_nnc_parallel_for(bdim[0], 0, _ccv_nnc_gemm_forw_sse2_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static void _ccv_nnc_gemm_back_dw_sse2_parallel(void* const context, const int j)
+{
+	const ccv_nnc_gemm_cpu_opt_parallel_t* const parallel = (ccv_nnc_gemm_cpu_opt_parallel_t*)context;
+	const int adim = parallel->adim;
+	float* const dwp = parallel->dw->data.f32 + j * parallel->dwinc[1];
 	int i;
-	if (bias)
+	for (i = 0; i < parallel->batch_size; i++)
 	{
-		for (i = 0; i < batch_size; i++)
+		const float* const gp = parallel->g->data.f32 + i * parallel->g_batch_inc;
+		const float* const ap = parallel->a->data.f32 + i * parallel->a_batch_inc;
+		__m128 g4 = _mm_set1_ps(gp[j]);
+		int k;
+		for (k = 0; k < adim - 3; k+= 4)
 		{
-			const float* const ap = a->data.f32 + i * a_batch_inc;
-			float* const bp = b->data.f32 + i * b_batch_inc;
-			parallel_for(j, bdim[0]) {
-				const float* const wp = w->data.f32 + j * winc[1];
-				int k;
-				__m128 v40 = _mm_set_ss(bias->data.f32[j]);
-				__m128 v41 = _mm_setzero_ps();
-				for (k = 0; k < adim[0] - 7; k += 8)
-				{
-					__m128 ap40 = _mm_load_ps(ap + k);
-					__m128 ap41 = _mm_load_ps(ap + k + 4);
-					__m128 w40 = _mm_load_ps(wp + k);
-					__m128 w41 = _mm_load_ps(wp + k + 4);
-					v40 =_mm_add_ps(_mm_mul_ps(w40, ap40), v40);
-					v41 =_mm_add_ps(_mm_mul_ps(w41, ap41), v41);
-				}
-				v40 = _mm_add_ps(v40, v41);
-				v41 = _mm_add_ps(v40, _mm_movehl_ps(v40, v40));
-				v40 = _mm_add_ss(v41, _mm_shuffle_ps(v41, v41, 1));
-				_mm_store_ss(bp + j, v40);
-			} parallel_endfor
+			__m128 a4 = _mm_load_ps(ap + k);
+			__m128 dw4 = _mm_load_ps(dwp + k);
+			_mm_stream_ps(dwp + k, _mm_add_ps(dw4, _mm_mul_ps(a4, g4)));
 		}
-	} else {
-		for (i = 0; i < batch_size; i++)
+	}
+}
+
+static void _ccv_nnc_gemm_back_h_sse2_parallel(void* const context, const int y)
+{
+	const ccv_nnc_gemm_cpu_opt_parallel_t* const parallel = (ccv_nnc_gemm_cpu_opt_parallel_t*)context;
+	const int gdim = parallel->gdim;
+	const int j = y * 4;
+	const float* const wp = parallel->w->data.f32 + j;
+	int i;
+	for (i = 0; i < parallel->batch_size; i++)
+	{
+		const float* const gp = parallel->g->data.f32 + i * parallel->g_batch_inc;
+		float* const hp = parallel->h->data.f32 + i * parallel->h_batch_inc;
+		__m128 v40 = _mm_setzero_ps();
+		__m128 v41 = _mm_setzero_ps();
+		__m128 v42 = _mm_setzero_ps();
+		__m128 v43 = _mm_setzero_ps();
+		int k;
+		for (k = 0; k < gdim; k += 4)
 		{
-			const float* const ap = a->data.f32 + i * a_batch_inc;
-			float* const bp = b->data.f32 + i * b_batch_inc;
-			parallel_for(j, bdim[0]) {
-				const float* const wp = w->data.f32 + j * winc[1];
-				int k;
-				__m128 v40 = _mm_setzero_ps();
-				__m128 v41 = _mm_setzero_ps();
-				for (k = 0; k < adim[0] - 7; k += 8)
-				{
-					__m128 ap40 = _mm_load_ps(ap + k);
-					__m128 ap41 = _mm_load_ps(ap + k + 4);
-					__m128 w40 = _mm_load_ps(wp + k);
-					__m128 w41 = _mm_load_ps(wp + k + 4);
-					v40 =_mm_add_ps(_mm_mul_ps(w40, ap40), v40);
-					v41 =_mm_add_ps(_mm_mul_ps(w41, ap41), v41);
-				}
-				v40 = _mm_add_ps(v40, v41);
-				v41 = _mm_add_ps(v40, _mm_movehl_ps(v40, v40));
-				v40 = _mm_add_ss(v41, _mm_shuffle_ps(v41, v41, 1));
-				_mm_store_ss(bp + j, v40);
-			} parallel_endfor
+			__m128 g4 = _mm_load_ps(gp + k);
+			__m128 w40 = _mm_load_ps(wp + k * parallel->winc[1]);
+			__m128 w41 = _mm_load_ps(wp + (k + 1) * parallel->winc[1]);
+			__m128 w42 = _mm_load_ps(wp + (k + 2) * parallel->winc[1]);
+			__m128 w43 = _mm_load_ps(wp + (k + 3) * parallel->winc[1]);
+			__m128 g40 = _mm_shuffle_ps(g4, g4, 0x00);
+			__m128 g41 = _mm_shuffle_ps(g4, g4, 0x55);
+			__m128 g42 = _mm_shuffle_ps(g4, g4, 0xAA);
+			__m128 g43 = _mm_shuffle_ps(g4, g4, 0xFF);
+			v40 = _mm_add_ps(_mm_mul_ps(g40, w40), v40);
+			v41 = _mm_add_ps(_mm_mul_ps(g41, w41), v41);
+			v42 = _mm_add_ps(_mm_mul_ps(g42, w42), v42);
+			v43 = _mm_add_ps(_mm_mul_ps(g43, w43), v43);
 		}
+		v40 = _mm_add_ps(v40, v41);
+		v42 = _mm_add_ps(v42, v43);
+		_mm_stream_ps(hp + j, _mm_add_ps(v40, v42));
 	}
-	return CCV_NNC_EXEC_SUCCESS;
 }
 
 static int _ccv_nnc_gemm_back_sse2(const ccv_nnc_tensor_view_t* const g, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, ccv_nnc_tensor_view_t* const dw, ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const h, const int flags)
@@ -122,22 +184,20 @@ static int _ccv_nnc_gemm_back_sse2(const ccv_nnc_tensor_view_t* const g, const c
 	assert(gdim[0] == dw->info.dim[0]);
 	assert(adim[0] == dw->info.dim[1]);
 	const int a_batch_inc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == 1) ? a->inc[0] : a->inc[1]) : adim[0];
-	for (i = 0; i < batch_size; i++)
-	{
-		const float* const gp = g->data.f32 + i * g_batch_inc;
-		const float* const ap = a->data.f32 + i * a_batch_inc;
-		parallel_for(j, gdim[0]) {
-			float* const dwp = dw->data.f32 + j * dwinc[1];
-			__m128 g4 = _mm_set1_ps(gp[j]);
-			int k;
-			for (k = 0; k < adim[0] - 3; k+= 4)
-			{
-				__m128 a4 = _mm_load_ps(ap + k);
-				__m128 dw4 = _mm_load_ps(dwp + k);
-				_mm_stream_ps(dwp + k, _mm_add_ps(dw4, _mm_mul_ps(a4, g4)));
-			}
-		} parallel_endfor
-	}
+	ccv_nnc_gemm_cpu_opt_parallel_t parallel = {
+		.a = a,
+		.w = w,
+		.g = g,
+		.dw = dw,
+		.h = h,
+		.batch_size = batch_size,
+		.adim = adim[0],
+		.gdim = gdim[0],
+		.a_batch_inc = a_batch_inc,
+		.g_batch_inc = g_batch_inc,
+		.dwinc = dwinc,
+	};
+	ccv_nnc_parallel_for(gdim[0], 0, _ccv_nnc_gemm_back_dw_sse2_parallel, &parallel);
 	if (h && w)
 	{
 		const int h_nd = ccv_nnc_tensor_nd(h->info.dim);
@@ -145,45 +205,44 @@ static int _ccv_nnc_gemm_back_sse2(const ccv_nnc_tensor_view_t* const g, const c
 		assert(hdim[0] == adim[0]);
 		const int h_batch_inc = CCV_IS_TENSOR_VIEW(h) ? ((h_nd == 1) ? h->inc[0] : h->inc[1]) : hdim[0];
 		const int* winc = CCV_IS_TENSOR_VIEW(w) ? w->inc : w->info.dim;
-		for (i = 0; i < batch_size; i++)
-		{
-			const float* const gp = g->data.f32 + i * g_batch_inc;
-			float* const hp = h->data.f32 + i * h_batch_inc;
-			parallel_for(y, hdim[0] / 4) {
-				const int j = y * 4;
-				const float* const wp = w->data.f32 + j;
-				__m128 v40 = _mm_setzero_ps();
-				__m128 v41 = _mm_setzero_ps();
-				__m128 v42 = _mm_setzero_ps();
-				__m128 v43 = _mm_setzero_ps();
-				int k;
-				for (k = 0; k < gdim[0]; k += 4)
-				{
-					__m128 g4 = _mm_load_ps(gp + k);
-					__m128 w40 = _mm_load_ps(wp + k * winc[1]);
-					__m128 w41 = _mm_load_ps(wp + (k + 1) * winc[1]);
-					__m128 w42 = _mm_load_ps(wp + (k + 2) * winc[1]);
-					__m128 w43 = _mm_load_ps(wp + (k + 3) * winc[1]);
-					__m128 g40 = _mm_shuffle_ps(g4, g4, 0x00);
-					__m128 g41 = _mm_shuffle_ps(g4, g4, 0x55);
-					__m128 g42 = _mm_shuffle_ps(g4, g4, 0xAA);
-					__m128 g43 = _mm_shuffle_ps(g4, g4, 0xFF);
-					v40 = _mm_add_ps(_mm_mul_ps(g40, w40), v40);
-					v41 = _mm_add_ps(_mm_mul_ps(g41, w41), v41);
-					v42 = _mm_add_ps(_mm_mul_ps(g42, w42), v42);
-					v43 = _mm_add_ps(_mm_mul_ps(g43, w43), v43);
-				}
-				v40 = _mm_add_ps(v40, v41);
-				v42 = _mm_add_ps(v42, v43);
-				_mm_stream_ps(hp + j, _mm_add_ps(v40, v42));
-			} parallel_endfor
-		}
+		parallel.h_batch_inc = h_batch_inc;
+		parallel.winc = winc;
+		ccv_nnc_parallel_for(hdim[0] / 4, 0, _ccv_nnc_gemm_back_h_sse2_parallel, &parallel);
 	}
 	return CCV_NNC_EXEC_SUCCESS;
 }
 #endif
 
 #ifdef HAVE_NEON
+static void _ccv_nnc_gemm_forw_neon_parallel(void* const context, const int j)
+{
+	const ccv_nnc_gemm_cpu_opt_parallel_t* const parallel = (ccv_nnc_gemm_cpu_opt_parallel_t*)context;
+	const int adim = parallel->adim;
+	const float* const wp = parallel->w->data.f32 + j * parallel->winc[1];
+	const float biasval = parallel->bias ? parallel->bias->data.f32[j] : 0;
+	int i;
+	for (i = 0; i < parallel->batch_size; i++)
+	{
+		const float* const ap = parallel->a->data.f32 + i * parallel->a_batch_inc;
+		float* const bp = parallel->b->data.f32 + i * parallel->b_batch_inc;
+		int k;
+		float32x4_t v41 = vmovq_n_f32(0);
+		float32x4_t v40 = vld1q_lane_f32(&biasval, v41, 0);
+		for (k = 0; k < adim - 7; k += 8)
+		{
+			float32x4_t ap40 = vld1q_f32(ap + k);
+			float32x4_t ap41 = vld1q_f32(ap + k + 4);
+			float32x4_t w40 = vld1q_f32(wp + k);
+			float32x4_t w41 = vld1q_f32(wp + k + 4);
+			v40 = vmlaq_f32(v40, w40, ap40);
+			v41 = vmlaq_f32(v41, w41, ap41);
+		}
+		v40 = vaddq_f32(v40, v41);
+		float32x2_t v2 = vpadd_f32(vget_high_f32(v40), vget_low_f32(v40));
+		bp[j] = vget_lane_f32(vpadd_f32(v2, v2), 0);
+	}
+}
+
 static int _ccv_nnc_gemm_forw_neon(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b)
 {
 	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
@@ -195,58 +254,78 @@ static int _ccv_nnc_gemm_forw_neon(const ccv_nnc_tensor_view_t* const a, const c
 	const int a_batch_inc = CCV_IS_TENSOR_VIEW(a) ? (a_nd == 1 ? a->inc[0] : a->inc[1]) : adim[0];
 	const int b_batch_inc = CCV_IS_TENSOR_VIEW(b) ? (b_nd == 1 ? b->inc[0] : b->inc[1]) : bdim[0];
 	const int* winc = CCV_IS_TENSOR_VIEW(w) ? w->inc : w->info.dim;
+	ccv_nnc_gemm_cpu_opt_parallel_t parallel = {
+		.a = a,
+		.w = w,
+		.bias = bias,
+		.b = b,
+		.batch_size = batch_size,
+		.adim = adim[0],
+		.a_batch_inc = a_batch_inc,
+		.b_batch_inc = b_batch_inc,
+		.winc = winc,
+	};
+	ccv_nnc_parallel_for(bdim[0], 0, _ccv_nnc_gemm_forw_neon_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static void _ccv_nnc_gemm_back_dw_neon_parallel(void* const context, const int j)
+{
+	const ccv_nnc_gemm_cpu_opt_parallel_t* const parallel = (ccv_nnc_gemm_cpu_opt_parallel_t*)context;
+	const int adim = parallel->adim;
+	float* const dwp = parallel->dw->data.f32 + j * parallel->dwinc[1];
 	int i;
-	if (bias)
+	for (i = 0; i < parallel->batch_size; i++)
 	{
-		for (i = 0; i < batch_size; i++)
+		const float* const gp = parallel->g->data.f32 + i * parallel->g_batch_inc;
+		const float* const ap = parallel->a->data.f32 + i * parallel->a_batch_inc;
+		float32x4_t g4 = vld1q_dup_f32(gp + j);
+		int k;
+		for (k = 0; k < adim - 3; k+= 4)
 		{
-			const float* const ap = a->data.f32 + i * a_batch_inc;
-			float* const bp = b->data.f32 + i * b_batch_inc;
-			parallel_for(j, bdim[0]) {
-				const float* const wp = w->data.f32 + j * winc[1];
-				int k;
-				float32x4_t v41 = vmovq_n_f32(0);
-				float32x4_t v40 = vld1q_lane_f32(bias->data.f32 + j, v41, 0);
-				for (k = 0; k < adim[0] - 7; k += 8)
-				{
-					float32x4_t ap40 = vld1q_f32(ap + k);
-					float32x4_t ap41 = vld1q_f32(ap + k + 4);
-					float32x4_t w40 = vld1q_f32(wp + k);
-					float32x4_t w41 = vld1q_f32(wp + k + 4);
-					v40 = vmlaq_f32(v40, w40, ap40);
-					v41 = vmlaq_f32(v41, w41, ap41);
-				}
-				v40 = vaddq_f32(v40, v41);
-				float32x2_t v2 = vpadd_f32(vget_high_f32(v40), vget_low_f32(v40));
-				bp[j] = vget_lane_f32(vpadd_f32(v2, v2), 0);
-			} parallel_endfor
+			float32x4_t a4 = vld1q_f32(ap + k);
+			float32x4_t dw4 = vld1q_f32(dwp + k);
+			vst1q_f32(dwp + k, vmlaq_f32(dw4, a4, g4));
 		}
-	} else {
-		for (i = 0; i < batch_size; i++)
+	}
+}
+
+static void _ccv_nnc_gemm_back_h_neon_parallel(void* const context, const int y)
+{
+	const ccv_nnc_gemm_cpu_opt_parallel_t* const parallel = (ccv_nnc_gemm_cpu_opt_parallel_t*)context;
+	const int gdim = parallel->gdim;
+	const int j = y * 4;
+	const float* const wp = parallel->w->data.f32 + j;
+	int i;
+	for (i = 0; i < parallel->batch_size; i++)
+	{
+		const float* const gp = parallel->g->data.f32 + i * parallel->g_batch_inc;
+		float* const hp = parallel->h->data.f32 + i * parallel->h_batch_inc;
+		float32x4_t v40 = vmovq_n_f32(0);
+		float32x4_t v41 = vmovq_n_f32(0);
+		float32x4_t v42 = vmovq_n_f32(0);
+		float32x4_t v43 = vmovq_n_f32(0);
+		int k;
+		for (k = 0; k < gdim; k += 4)
 		{
-			const float* const ap = a->data.f32 + i * a_batch_inc;
-			float* const bp = b->data.f32 + i * b_batch_inc;
-			parallel_for(j, bdim[0]) {
-				const float* const wp = w->data.f32 + j * winc[1];
-				int k;
-				float32x4_t v41 = vmovq_n_f32(0);
-				float32x4_t v40 = vmovq_n_f32(0);
-				for (k = 0; k < adim[0] - 7; k += 8)
-				{
-					float32x4_t ap40 = vld1q_f32(ap + k);
-					float32x4_t ap41 = vld1q_f32(ap + k + 4);
-					float32x4_t w40 = vld1q_f32(wp + k);
-					float32x4_t w41 = vld1q_f32(wp + k + 4);
-					v40 = vmlaq_f32(v40, w40, ap40);
-					v41 = vmlaq_f32(v41, w41, ap41);
-				}
-				v40 = vaddq_f32(v40, v41);
-				float32x2_t v2 = vpadd_f32(vget_high_f32(v40), vget_low_f32(v40));
-				bp[j] = vget_lane_f32(vpadd_f32(v2, v2), 0);
-			} parallel_endfor
+			float32x2x2_t g4 = vld2_f32(gp + k);
+			float32x4_t w40 = vld1q_f32(wp + k * parallel->winc[1]);
+			float32x4_t w41 = vld1q_f32(wp + (k + 1) * parallel->winc[1]);
+			float32x4_t w42 = vld1q_f32(wp + (k + 2) * parallel->winc[1]);
+			float32x4_t w43 = vld1q_f32(wp + (k + 3) * parallel->winc[1]);
+			float32x4_t g40 = vdupq_lane_f32(g4.val[0], 0);
+			float32x4_t g41 = vdupq_lane_f32(g4.val[1], 0);
+			float32x4_t g42 = vdupq_lane_f32(g4.val[0], 1);
+			float32x4_t g43 = vdupq_lane_f32(g4.val[1], 1);
+			v40 = vmlaq_f32(v40, g40, w40);
+			v41 = vmlaq_f32(v41, g41, w41);
+			v42 = vmlaq_f32(v42, g42, w42);
+			v43 = vmlaq_f32(v43, g43, w43);
 		}
+		v40 = vaddq_f32(v40, v41);
+		v42 = vaddq_f32(v42, v43);
+		vst1q_f32(hp + j, vaddq_f32(v40, v42));
 	}
-	return CCV_NNC_EXEC_SUCCESS;
 }
 
 static int _ccv_nnc_gemm_back_neon(const ccv_nnc_tensor_view_t* const g, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, ccv_nnc_tensor_view_t* const dw, ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const h, const int flags)
@@ -281,98 +360,285 @@ static int _ccv_nnc_gemm_back_neon(const ccv_nnc_tensor_view_t* const g, const c
 		}
 	}
 	const int a_batch_inc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == 1) ? a->inc[0] : a->inc[1]) : adim[0];
-	for (i = 0; i < batch_size; i++)
-	{
-		const float* const gp = g->data.f32 + i * g_batch_inc;
-		const float* const ap = a->data.f32 + i * a_batch_inc;
-		parallel_for(j, gdim[0]) {
-			float* const dwp = dw->data.f32 + j * dwinc[1];
-			float32x4_t g4 = vld1q_dup_f32(gp + j);
-			int k;
-			for (k = 0; k < adim[0] - 3; k+= 4)
-			{
-				float32x4_t a4 = vld1q_f32(ap + k);
-				float32x4_t dw4 = vld1q_f32(dwp + k);
-				vst1q_f32(dwp + k, vmlaq_f32(dw4, a4, g4));
-			}
-		} parallel_endfor
-	}
+	ccv_nnc_gemm_cpu_opt_parallel_t parallel = {
+		.a = a,
+		.w = w,
+		.g = g,
+		.dw = dw,
+		.h = h,
+		.batch_size = batch_size,
+		.adim = adim[0],
+		.gdim = gdim[0],
+		.a_batch_inc = a_batch_inc,
+		.g_batch_inc = g_batch_inc,
+		.dwinc = dwinc,
+	};
+	ccv_nnc_parallel_for(gdim[0], 0, _ccv_nnc_gemm_back_dw_neon_parallel, &parallel);
 	if (h && w)
 	{
 		const int h_nd = ccv_nnc_tensor_nd(h->info.dim);
 		const int* hdim = (h_nd == 1) ? h->info.dim : h->info.dim + 1;
 		const int h_batch_inc = CCV_IS_TENSOR_VIEW(h) ? ((h_nd == 1) ? h->inc[0] : h->inc[1]) : hdim[0];
 		const int* winc = CCV_IS_TENSOR_VIEW(w) ? w->inc : w->info.dim;
+		parallel.h_batch_inc = h_batch_inc;
+		parallel.winc = winc;
+		ccv_nnc_parallel_for(hdim[0] / 4, 0, _ccv_nnc_gemm_back_h_neon_parallel, &parallel);
+	}
+	return CCV_NNC_EXEC_SUCCESS;
+}
+#endif
+
+typedef struct {
+	const float* a;
+	const ccv_nnc_tensor_view_t* w;
+	const float* bias;
+	ccv_nnc_tensor_view_t* b;
+	int batch_size;
+	int adim;
+	int a_batch_inc;
+	int b_batch_inc;
+	int winc;
+} ccv_nnc_gemm_16f_parallel_t;
+
+static void _ccv_nnc_gemm_forw_16f_parallel(void* const context, const int j)
+{
+	const ccv_nnc_gemm_16f_parallel_t* const parallel = (ccv_nnc_gemm_16f_parallel_t*)context;
+	const int adim = parallel->adim;
+	const ccv_nnc_tensor_view_t* const w = parallel->w;
+	ccv_nnc_tensor_view_t* const b = parallel->b;
+	const float biasval = parallel->bias ? parallel->bias[j] : 0;
+	int i;
+	for (i = 0; i < parallel->batch_size; i++)
+	{
+		const float* const ap = parallel->a + i * parallel->a_batch_inc;
+		// The weights are converted in the inner loop, thus, only half of the memory bandwidth is used for 16F weights.
+		const float v = biasval + (w->info.datatype == CCV_16F ? _ccv_nnc_sdot_f16(ap, w->data.f16 + j * parallel->winc, adim) : _ccv_nnc_sdot(ap, w->data.f32 + j * parallel->winc, adim));
+		if (b->info.datatype == CCV_16F)
+			_ccv_nnc_f32_to_f16(&v, b->data.f16 + i * parallel->b_batch_inc + j, 1);
+		else
+			b->data.f32[i * parallel->b_batch_inc + j] = v;
+	}
+}
+
+int _ccv_nnc_gemm_forw_16f_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b, ccv_nnc_stream_context_t* const stream_context)
+{
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	const int* adim = (a_nd == 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	const int* bdim = (b_nd == 1) ? b->info.dim : b->info.dim + 1;
+	assert(!bias || bdim[0] == bias->info.dim[0]);
+	assert(bdim[0] == w->info.dim[0]);
+	assert(adim[0] == w->info.dim[1]);
+	const int batch_size = a_nd == 1 ? 1 : ccv_max(1, a->info.dim[0]);
+	assert(batch_size == (b_nd == 1) ? 1 : ccv_max(1, b->info.dim[0]));
+	int a_batch_inc = CCV_IS_TENSOR_VIEW(a) ? (a_nd == 1 ? a->inc[0] : a->inc[1]) : adim[0];
+	const int b_batch_inc = CCV_IS_TENSOR_VIEW(b) ? (b_nd == 1 ? b->inc[0] : b->inc[1]) : bdim[0];
+	const int winc = CCV_IS_TENSOR_VIEW(w) ? w->inc[1] : w->info.dim[1];
+	// The activations and the bias are much smaller than the weights, convert these to float once.
+	const int a_size = a->info.datatype == CCV_16F ? batch_size * adim[0] : 0;
+	const int bias_size = bias && bias->info.datatype == CCV_16F ? bdim[0] : 0;
+	float* workmem = 0;
+	if (a_size + bias_size > 0)
+	{
+		workmem = (float*)ccv_nnc_stream_context_get_workspace(stream_context, sizeof(float) * (a_size + bias_size), CCV_TENSOR_CPU_MEMORY);
+		if (!workmem)
+			return CCV_NNC_EXEC_OOM;
+	}
+	const float* ap = a->data.f32;
+	if (a_size)
+	{
+		int i;
+		for (i = 0; i < batch_size; i++)
+			_ccv_nnc_f16_to_f32(a->data.f16 + i * a_batch_inc, workmem + i * adim[0], adim[0]);
+		ap = workmem;
+		a_batch_inc = adim[0];
+	}
+	const float* biasp = bias ? bias->data.f32 : 0;
+	if (bias_size)
+	{
+		_ccv_nnc_f16_to_f32(bias->data.f16, workmem + a_size, bias_size);
+		biasp = workmem + a_size;
+	}
+	ccv_nnc_gemm_16f_parallel_t parallel = {
+		.a = ap,
+		.w = w,
+		.bias = biasp,
+		.b = b,
+		.batch_size = batch_size,
+		.adim = adim[0],
+		.a_batch_inc = a_batch_inc,
+		.b_batch_inc = b_batch_inc,
+		.winc = winc,
+	};
+	ccv_nnc_parallel_for(bdim[0], 0, _ccv_nnc_gemm_forw_16f_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+typedef struct {
+	const ccv_nnc_tensor_view_t* a;
+	const ccv_nnc_tensor_view_t* w;
+	const float* bias;
+	const float* scale;
+	ccv_nnc_tensor_view_t* b;
+	int batch_size;
+	int adim;
+	int a_batch_inc;
+	int b_batch_inc;
+	int winc;
+} ccv_nnc_gemm_8s_parallel_t;
+
+static void _ccv_nnc_gemm_forw_8s_parallel(void* const context, const int j)
+{
+	const ccv_nnc_gemm_8s_parallel_t* const parallel = (ccv_nnc_gemm_8s_parallel_t*)context;
+	const int adim = parallel->adim;
+	const int8_t* const wp = parallel->w->data.i8 + j * parallel->winc;
+	float* const bp = parallel->b->data.f32 + j;
+	const float biasval = parallel->bias ? parallel->bias[j] : 0;
+	const float scale = parallel->scale[j];
+	int i;
+	for (i = 0; i < parallel->batch_size; i++)
+		bp[i * parallel->b_batch_inc] = _ccv_nnc_i8dot(parallel->a->data.i8 + i * parallel->a_batch_inc, wp, adim) * scale + biasval;
+}
+
+int _ccv_nnc_gemm_forw_8s_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, const ccv_nnc_tensor_view_t* const a_scale, const ccv_nnc_tensor_view_t* const w_scale, ccv_nnc_tensor_view_t* const b, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(w->info.datatype == CCV_8S);
+	assert(b->info.datatype == CCV_32F);
+	assert(!bias || bias->info.datatype == CCV_32F);
+	assert(a_scale->info.datatype == CCV_32F && w_scale->info.datatype == CCV_32F);
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	const int* adim = (a_nd == 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	const int* bdim = (b_nd == 1) ? b->info.dim : b->info.dim + 1;
+	assert(!bias || bdim[0] == bias->info.dim[0]);
+	assert(bdim[0] == w->info.dim[0]);
+	assert(adim[0] == w->info.dim[1]);
+	const int batch_size = a_nd == 1 ? 1 : ccv_max(1, a->info.dim[0]);
+	assert(batch_size == (b_nd == 1) ? 1 : ccv_max(1, b->info.dim[0]));
+	assert(ccv_nnc_tensor_count(a_scale->info) == 1);
+	const int w_scale_count = ccv_nnc_tensor_count(w_scale->info);
+	assert(w_scale_count == 1 || w_scale_count == bdim[0]);
+	// Fold the activation scale into the weight scales, such that the output is dequantized with one multiplication.
+	float* const scale = (float*)ccv_nnc_stream_context_get_workspace(stream_context, sizeof(float) * bdim[0], CCV_TENSOR_CPU_MEMORY);
+	if (!scale)
+		return CCV_NNC_EXEC_OOM;
+	int j;
+	for (j = 0; j < bdim[0]; j++)
+		scale[j] = a_scale->data.f32[0] * w_scale->data.f32[w_scale_count == 1 ? 0 : j];
+	ccv_nnc_gemm_8s_parallel_t parallel = {
+		.a = a,
+		.w = w,
+		.bias = bias ? bias->data.f32 : 0,
+		.scale = scale,
+		.b = b,
+		.batch_size = batch_size,
+		.adim = adim[0],
+		.a_batch_inc = CCV_IS_TENSOR_VIEW(a) ? (a_nd == 1 ? a->inc[0] : a->inc[1]) : adim[0],
+		.b_batch_inc = CCV_IS_TENSOR_VIEW(b) ? (b_nd == 1 ? b->inc[0] : b->inc[1]) : bdim[0],
+		.winc = CCV_IS_TENSOR_VIEW(w) ? w->inc[1] : w->info.dim[1],
+	};
+	ccv_nnc_parallel_for(bdim[0], 0, _ccv_nnc_gemm_forw_8s_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_gemm_forw_packed(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b)
+{
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	const int* adim = (a_nd == 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	const int* bdim = (b_nd == 1) ? b->info.dim : b->info.dim + 1;
+	assert(!bias || bdim[0] == bias->info.dim[0]);
+	assert(bdim[0] == w->info.dim[0]);
+	assert(adim[0] == w->info.dim[1]);
+	const int batch_size = a_nd == 1 ? 1 : ccv_max(1, a->info.dim[0]);
+	assert(batch_size == (b_nd == 1) ? 1 : ccv_max(1, b->info.dim[0]));
+	const int a_batch_inc = CCV_IS_TENSOR_VIEW(a) ? (a_nd == 1 ? a->inc[0] : a->inc[1]) : adim[0];
+	const int b_batch_inc = CCV_IS_TENSOR_VIEW(b) ? (b_nd == 1 ? b->inc[0] : b->inc[1]) : bdim[0];
+	const int* winc = CCV_IS_TENSOR_VIEW(w) ? w->inc : w->info.dim;
+	int i;
+	if (bias)
+		for (i = 0; i < batch_size; i++)
+			memcpy(b->data.f32 + i * b_batch_inc, bias->data.f32, sizeof(float) * bdim[0]);
+	// b = a * w^T, w^T is read with the strides swapped.
+	_ccv_nnc_sgemm_packed_cpu_opt(batch_size, bdim[0], adim[0], a->data.f32, a_batch_inc, 1, w->data.f32, 1, winc[1], b->data.f32, b_batch_inc, !!bias);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_gemm_back_packed(const ccv_nnc_tensor_view_t* const g, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, ccv_nnc_tensor_view_t* const dw, ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const h, const int flags)
+{
+	const int* dwinc = CCV_IS_TENSOR_VIEW(dw) ? dw->inc : dw->info.dim;
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	const int* adim = (a_nd == 1) ? a->info.dim : a->info.dim + 1;
+	const int g_nd = ccv_nnc_tensor_nd(g->info.dim);
+	const int* gdim = (g_nd == 1) ? g->info.dim : g->info.dim + 1;
+	const int batch_size = a_nd == 1 ? 1 : ccv_max(1, a->info.dim[0]);
+	const int a_batch_inc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == 1) ? a->inc[0] : a->inc[1]) : adim[0];
+	const int g_batch_inc = CCV_IS_TENSOR_VIEW(g) ? ((g_nd == 1) ? g->inc[0] : g->inc[1]) : gdim[0];
+	assert(gdim[0] == dw->info.dim[0]);
+	assert(adim[0] == dw->info.dim[1]);
+	int i, j;
+	if (bias)
+	{
+		assert(bias->info.dim[0] == gdim[0]);
+		if (!(flags & CCV_NNC_ACCUMULATE_OUTPUT))
+			memset(bias->data.u8, 0, sizeof(float) * bias->info.dim[0]);
 		for (i = 0; i < batch_size; i++)
 		{
 			const float* const gp = g->data.f32 + i * g_batch_inc;
-			float* const hp = h->data.f32 + i * h_batch_inc;
-			parallel_for(y, hdim[0] / 4) {
-				const int j = y * 4;
-				const float* const wp = w->data.f32 + j;
-				float32x4_t v40 = vmovq_n_f32(0);
-				float32x4_t v41 = vmovq_n_f32(0);
-				float32x4_t v42 = vmovq_n_f32(0);
-				float32x4_t v43 = vmovq_n_f32(0);
-				int k;
-				for (k = 0; k < gdim[0]; k += 4)
-				{
-					float32x2x2_t g4 = vld2_f32(gp + k);
-					float32x4_t w40 = vld1q_f32(wp + k * winc[1]);
-					float32x4_t w41 = vld1q_f32(wp + (k + 1) * winc[1]);
-					float32x4_t w42 = vld1q_f32(wp + (k + 2) * winc[1]);
-					float32x4_t w43 = vld1q_f32(wp + (k + 3) * winc[1]);
-					float32x4_t g40 = vdupq_lane_f32(g4.val[0], 0);
-					float32x4_t g41 = vdupq_lane_f32(g4.val[1], 0);
-					float32x4_t g42 = vdupq_lane_f32(g4.val[0], 1);
-					float32x4_t g43 = vdupq_lane_f32(g4.val[1], 1);
-					v40 = vmlaq_f32(v40, g40, w40);
-					v41 = vmlaq_f32(v41, g41, w41);
-					v42 = vmlaq_f32(v42, g42, w42);
-					v43 = vmlaq_f32(v43, g43, w43);
-				}
-				v40 = vaddq_f32(v40, v41);
-				v42 = vaddq_f32(v42, v43);
-				vst1q_f32(hp + j, vaddq_f32(v40, v42));
-			} parallel_endfor
+			for (j = 0; j < gdim[0]; j++)
+				bias->data.f32[j] += gp[j];
 		}
 	}
+	// dw = g^T * a, g^T is read with the strides swapped.
+	_ccv_nnc_sgemm_packed_cpu_opt(gdim[0], adim[0], batch_size, g->data.f32, 1, g_batch_inc, a->data.f32, a_batch_inc, 1, dw->data.f32, dwinc[1], flags & CCV_NNC_ACCUMULATE_OUTPUT);
+	if (h && w)
+	{
+		const int h_nd = ccv_nnc_tensor_nd(h->info.dim);
+		const int* hdim = (h_nd == 1) ? h->info.dim : h->info.dim + 1;
+		assert(hdim[0] == adim[0]);
+		const int h_batch_inc = CCV_IS_TENSOR_VIEW(h) ? ((h_nd == 1) ? h->inc[0] : h->inc[1]) : hdim[0];
+		const int* winc = CCV_IS_TENSOR_VIEW(w) ? w->inc : w->info.dim;
+		// h = g * w
+		_ccv_nnc_sgemm_packed_cpu_opt(batch_size, hdim[0], gdim[0], g->data.f32, g_batch_inc, 1, w->data.f32, winc[1], 1, h->data.f32, h_batch_inc, 0);
+	}
 	return CCV_NNC_EXEC_SUCCESS;
 }
-#endif
 
 int _ccv_nnc_gemm_forw_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b)
 {
-#if defined(HAVE_SSE2) || defined(HAVE_NEON)
 	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+#if defined(HAVE_SSE2) || defined(HAVE_NEON)
 	const int adim = (a_nd == 1) ? a->info.dim[0] : a->info.dim[1];
 #endif
+	const int batch_size = a_nd == 1 ? 1 : ccv_max(1, a->info.dim[0]);
+	// A single row is a matrix-vector product bound by reading w once, packing doesn't pay off there.
 #if defined(HAVE_SSE2)
-	if (adim % 8 == 0)
+	if (batch_size == 1 && adim % 8 == 0)
 		return _ccv_nnc_gemm_forw_sse2(a, w, bias, b);
 #elif defined(HAVE_NEON)
-	if (adim % 8 == 0)
+	if (batch_size == 1 && adim % 8 == 0)
 		return _ccv_nnc_gemm_forw_neon(a, w, bias, b);
 #endif
-	return CCV_NNC_EXEC_INVALID;
+	return _ccv_nnc_gemm_forw_packed(a, w, bias, b);
 }
 
 int _ccv_nnc_gemm_back_cpu_opt(const ccv_nnc_tensor_view_t* const g, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, ccv_nnc_tensor_view_t* const dw, ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const h, const int flags)
 {
-#if defined(HAVE_SSE2) || defined(HAVE_NEON)
 	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+#if defined(HAVE_SSE2) || defined(HAVE_NEON)
 	const int adim = (a_nd == 1) ? a->info.dim[0] : a->info.dim[1];
 	const int g_nd = ccv_nnc_tensor_nd(g->info.dim);
 	const int gdim = (g_nd == 1) ? g->info.dim[0] : g->info.dim[1];
 	const int h_nd = h ? ccv_nnc_tensor_nd(h->info.dim) : 0;
 	const int hdim = h ? ((h_nd == 1) ? h->info.dim[0] : h->info.dim[1]) : 0;
 #endif
+	const int batch_size = a_nd == 1 ? 1 : ccv_max(1, a->info.dim[0]);
 #if defined(HAVE_SSE2)
-	if (gdim % 4 == 0 && adim % 4 == 0 && (!h || hdim % 4 == 0))
+	if (batch_size == 1 && gdim % 4 == 0 && adim % 4 == 0 && (!h || hdim % 4 == 0))
 		return _ccv_nnc_gemm_back_sse2(g, a, w, dw, bias, h, flags);
 #elif defined(HAVE_NEON)
-	if (gdim % 4 == 0 && adim % 4 == 0 && (!h || hdim % 4 == 0))
+	if (batch_size == 1 && gdim % 4 == 0 && adim % 4 == 0 && (!h || hdim % 4 == 0))
 		return _ccv_nnc_gemm_back_neon(g, a, w, dw, bias, h, flags);
 #endif
-	return CCV_NNC_EXEC_INVALID;
+	return _ccv_nnc_gemm_back_packed(g, a, w, dw, bias, h, flags);
 }
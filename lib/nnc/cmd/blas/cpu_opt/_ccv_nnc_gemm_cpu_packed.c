@@ -0,0 +1,353 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#elif defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+#include "../_ccv_nnc_gemm_cpu_opt.h"
+#include "../../_ccv_nnc_cpu_opt.h"
+
+// Blocking follows the usual five loops around a register-blocked microkernel:
+// KC x NC panel of B stays in L3, MC x KC block of A stays in L2, KC x NR micro-panel of B stays in L1.
+#define CCV_NNC_SGEMM_MR (6)
+#define CCV_NNC_SGEMM_KC (256)
+#define CCV_NNC_SGEMM_MC (120)
+#define CCV_NNC_SGEMM_NC (3072)
+#define CCV_NNC_SGEMM_MAX_NR (32)
+
+// c[MR x NR] (+)= a[kc x MR]^T * b[kc x NR], both packed with the MR / NR dimension innermost.
+typedef void (*ccv_nnc_sgemm_kernel_f)(const int kc, const float* const a, const float* const b, float* const c, const int ldc, const int accumulate);
+
+static void _ccv_nnc_sgemm_kernel_6x8(const int kc, const float* a, const float* b, float* const c, const int ldc, const int accumulate)
+{
+	int i, j, p;
+#if defined(HAVE_SSE2)
+	__m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps();
+	__m128 c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps();
+	__m128 c20 = _mm_setzero_ps(), c21 = _mm_setzero_ps();
+	__m128 c30 = _mm_setzero_ps(), c31 = _mm_setzero_ps();
+	__m128 c40 = _mm_setzero_ps(), c41 = _mm_setzero_ps();
+	__m128 c50 = _mm_setzero_ps(), c51 = _mm_setzero_ps();
+	for (p = 0; p < kc; p++, a += 6, b += 8)
+	{
+		const __m128 b0 = _mm_load_ps(b);
+		const __m128 b1 = _mm_load_ps(b + 4);
+		__m128 a4 = _mm_set1_ps(a[0]);
+		c00 = _mm_add_ps(_mm_mul_ps(a4, b0), c00), c01 = _mm_add_ps(_mm_mul_ps(a4, b1), c01);
+		a4 = _mm_set1_ps(a[1]);
+		c10 = _mm_add_ps(_mm_mul_ps(a4, b0), c10), c11 = _mm_add_ps(_mm_mul_ps(a4, b1), c11);
+		a4 = _mm_set1_ps(a[2]);
+		c20 = _mm_add_ps(_mm_mul_ps(a4, b0), c20), c21 = _mm_add_ps(_mm_mul_ps(a4, b1), c21);
+		a4 = _mm_set1_ps(a[3]);
+		c30 = _mm_add_ps(_mm_mul_ps(a4, b0), c30), c31 = _mm_add_ps(_mm_mul_ps(a4, b1), c31);
+		a4 = _mm_set1_ps(a[4]);
+		c40 = _mm_add_ps(_mm_mul_ps(a4, b0), c40), c41 = _mm_add_ps(_mm_mul_ps(a4, b1), c41);
+		a4 = _mm_set1_ps(a[5]);
+		c50 = _mm_add_ps(_mm_mul_ps(a4, b0), c50), c51 = _mm_add_ps(_mm_mul_ps(a4, b1), c51);
+	}
+	__m128 cv[6][2] = {
+		{ c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 }
+	};
+	for (i = 0; i < 6; i++)
+		for (j = 0; j < 2; j++)
+			if (accumulate)
+				_mm_storeu_ps(c + i * ldc + j * 4, _mm_add_ps(_mm_loadu_ps(c + i * ldc + j * 4), cv[i][j]));
+			else
+				_mm_storeu_ps(c + i * ldc + j * 4, cv[i][j]);
+#elif defined(HAVE_NEON)
+	float32x4_t cv[6][2];
+	for (i = 0; i < 6; i++)
+		cv[i][0] = cv[i][1] = vdupq_n_f32(0);
+	for (p = 0; p < kc; p++, a += 6, b += 8)
+	{
+		const float32x4_t b0 = vld1q_f32(b);
+		const float32x4_t b1 = vld1q_f32(b + 4);
+		for (i = 0; i < 6; i++)
+		{
+			cv[i][0] = vmlaq_n_f32(cv[i][0], b0, a[i]);
+			cv[i][1] = vmlaq_n_f32(cv[i][1], b1, a[i]);
+		}
+	}
+	for (i = 0; i < 6; i++)
+		for (j = 0; j < 2; j++)
+			if (accumulate)
+				vst1q_f32(c + i * ldc + j * 4, vaddq_f32(vld1q_f32(c + i * ldc + j * 4), cv[i][j]));
+			else
+				vst1q_f32(c + i * ldc + j * 4, cv[i][j]);
+#else
+	float cv[6][8] = {};
+	for (p = 0; p < kc; p++, a += 6, b += 8)
+		for (i = 0; i < 6; i++)
+			for (j = 0; j < 8; j++)
+				cv[i][j] += a[i] * b[j];
+	for (i = 0; i < 6; i++)
+		for (j = 0; j < 8; j++)
+			c[i * ldc + j] = accumulate ? c[i * ldc + j] + cv[i][j] : cv[i][j];
+#endif
+}
+
+#ifdef CCV_NNC_CPU_OPT_AVX2
+__attribute__((target("avx2,fma"))) static void _ccv_nnc_sgemm_kernel_6x16_avx2(const int kc, const float* a, const float* b, float* const c, const int ldc, const int accumulate)
+{
+	__m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+	__m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+	__m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+	__m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+	__m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+	__m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+	int p;
+	for (p = 0; p < kc; p++, a += 6, b += 16)
+	{
+		const __m256 b0 = _mm256_load_ps(b);
+		const __m256 b1 = _mm256_load_ps(b + 8);
+		__m256 a8 = _mm256_broadcast_ss(a);
+		c00 = _mm256_fmadd_ps(a8, b0, c00), c01 = _mm256_fmadd_ps(a8, b1, c01);
+		a8 = _mm256_broadcast_ss(a + 1);
+		c10 = _mm256_fmadd_ps(a8, b0, c10), c11 = _mm256_fmadd_ps(a8, b1, c11);
+		a8 = _mm256_broadcast_ss(a + 2);
+		c20 = _mm256_fmadd_ps(a8, b0, c20), c21 = _mm256_fmadd_ps(a8, b1, c21);
+		a8 = _mm256_broadcast_ss(a + 3);
+		c30 = _mm256_fmadd_ps(a8, b0, c30), c31 = _mm256_fmadd_ps(a8, b1, c31);
+		a8 = _mm256_broadcast_ss(a + 4);
+		c40 = _mm256_fmadd_ps(a8, b0, c40), c41 = _mm256_fmadd_ps(a8, b1, c41);
+		a8 = _mm256_broadcast_ss(a + 5);
+		c50 = _mm256_fmadd_ps(a8, b0, c50), c51 = _mm256_fmadd_ps(a8, b1, c51);
+	}
+	if (accumulate)
+	{
+		c00 = _mm256_add_ps(_mm256_loadu_ps(c), c00), c01 = _mm256_add_ps(_mm256_loadu_ps(c + 8), c01);
+		c10 = _mm256_add_ps(_mm256_loadu_ps(c + ldc), c10), c11 = _mm256_add_ps(_mm256_loadu_ps(c + ldc + 8), c11);
+		c20 = _mm256_add_ps(_mm256_loadu_ps(c + 2 * ldc), c20), c21 = _mm256_add_ps(_mm256_loadu_ps(c + 2 * ldc + 8), c21);
+		c30 = _mm256_add_ps(_mm256_loadu_ps(c + 3 * ldc), c30), c31 = _mm256_add_ps(_mm256_loadu_ps(c + 3 * ldc + 8), c31);
+		c40 = _mm256_add_ps(_mm256_loadu_ps(c + 4 * ldc), c40), c41 = _mm256_add_ps(_mm256_loadu_ps(c + 4 * ldc + 8), c41);
+		c50 = _mm256_add_ps(_mm256_loadu_ps(c + 5 * ldc), c50), c51 = _mm256_add_ps(_mm256_loadu_ps(c + 5 * ldc + 8), c51);
+	}
+	_mm256_storeu_ps(c, c00), _mm256_storeu_ps(c + 8, c01);
+	_mm256_storeu_ps(c + ldc, c10), _mm256_storeu_ps(c + ldc + 8, c11);
+	_mm256_storeu_ps(c + 2 * ldc, c20), _mm256_storeu_ps(c + 2 * ldc + 8, c21);
+	_mm256_storeu_ps(c + 3 * ldc, c30), _mm256_storeu_ps(c + 3 * ldc + 8, c31);
+	_mm256_storeu_ps(c + 4 * ldc, c40), _mm256_storeu_ps(c + 4 * ldc + 8, c41);
+	_mm256_storeu_ps(c + 5 * ldc, c50), _mm256_storeu_ps(c + 5 * ldc + 8, c51);
+}
+#endif
+
+#ifdef CCV_NNC_CPU_OPT_AVX512
+__attribute__((target("avx512f"))) static void _ccv_nnc_sgemm_kernel_6x32_avx512(const int kc, const float* a, const float* b, float* const c, const int ldc, const int accumulate)
+{
+	__m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps();
+	__m512 c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+	__m512 c20 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps();
+	__m512 c30 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+	__m512 c40 = _mm512_setzero_ps(), c41 = _mm512_setzero_ps();
+	__m512 c50 = _mm512_setzero_ps(), c51 = _mm512_setzero_ps();
+	int p;
+	for (p = 0; p < kc; p++, a += 6, b += 32)
+	{
+		const __m512 b0 = _mm512_load_ps(b);
+		const __m512 b1 = _mm512_load_ps(b + 16);
+		__m512 a16 = _mm512_set1_ps(a[0]);
+		c00 = _mm512_fmadd_ps(a16, b0, c00), c01 = _mm512_fmadd_ps(a16, b1, c01);
+		a16 = _mm512_set1_ps(a[1]);
+		c10 = _mm512_fmadd_ps(a16, b0, c10), c11 = _mm512_fmadd_ps(a16, b1, c11);
+		a16 = _mm512_set1_ps(a[2]);
+		c20 = _mm512_fmadd_ps(a16, b0, c20), c21 = _mm512_fmadd_ps(a16, b1, c21);
+		a16 = _mm512_set1_ps(a[3]);
+		c30 = _mm512_fmadd_ps(a16, b0, c30), c31 = _mm512_fmadd_ps(a16, b1, c31);
+		a16 = _mm512_set1_ps(a[4]);
+		c40 = _mm512_fmadd_ps(a16, b0, c40), c41 = _mm512_fmadd_ps(a16, b1, c41);
+		a16 = _mm512_set1_ps(a[5]);
+		c50 = _mm512_fmadd_ps(a16, b0, c50), c51 = _mm512_fmadd_ps(a16, b1, c51);
+	}
+	if (accumulate)
+	{
+		c00 = _mm512_add_ps(_mm512_loadu_ps(c), c00), c01 = _mm512_add_ps(_mm512_loadu_ps(c + 16), c01);
+		c10 = _mm512_add_ps(_mm512_loadu_ps(c + ldc), c10), c11 = _mm512_add_ps(_mm512_loadu_ps(c + ldc + 16), c11);
+		c20 = _mm512_add_ps(_mm512_loadu_ps(c + 2 * ldc), c20), c21 = _mm512_add_ps(_mm512_loadu_ps(c + 2 * ldc + 16), c21);
+		c30 = _mm512_add_ps(_mm512_loadu_ps(c + 3 * ldc), c30), c31 = _mm512_add_ps(_mm512_loadu_ps(c + 3 * ldc + 16), c31);
+		c40 = _mm512_add_ps(_mm512_loadu_ps(c + 4 * ldc), c40), c41 = _mm512_add_ps(_mm512_loadu_ps(c + 4 * ldc + 16), c41);
+		c50 = _mm512_add_ps(_mm512_loadu_ps(c + 5 * ldc), c50), c51 = _mm512_add_ps(_mm512_loadu_ps(c + 5 * ldc + 16), c51);
+	}
+	_mm512_storeu_ps(c, c00), _mm512_storeu_ps(c + 16, c01);
+	_mm512_storeu_ps(c + ldc, c10), _mm512_storeu_ps(c + ldc + 16, c11);
+	_mm512_storeu_ps(c + 2 * ldc, c20), _mm512_storeu_ps(c + 2 * ldc + 16, c21);
+	_mm512_storeu_ps(c + 3 * ldc, c30), _mm512_storeu_ps(c + 3 * ldc + 16, c31);
+	_mm512_storeu_ps(c + 4 * ldc, c40), _mm512_storeu_ps(c + 4 * ldc + 16, c41);
+	_mm512_storeu_ps(c + 5 * ldc, c50), _mm512_storeu_ps(c + 5 * ldc + 16, c51);
+}
+#endif
+
+typedef struct {
+	int m;
+	int n;
+	int kc;
+	int nc;
+	int nr;
+	const float* a;
+	int rsa;
+	int csa;
+	const float* b;
+	int rsb;
+	int csb;
+	float* c;
+	int ldc;
+	int accumulate;
+	float* pa; // Packed A, [m / MR][kc][MR].
+	float* pb; // Packed B, [nc / NR][kc][NR].
+	int n_chunk; // Number of NR micro-panels each job computes.
+	int n_chunk_count;
+	ccv_nnc_sgemm_kernel_f kernel;
+} ccv_nnc_sgemm_packed_parallel_t;
+
+static void _ccv_nnc_sgemm_pack_a_parallel(void* const context, const int i)
+{
+	const ccv_nnc_sgemm_packed_parallel_t* const parallel = (ccv_nnc_sgemm_packed_parallel_t*)context;
+	const int kc = parallel->kc;
+	const int mr = ccv_min(CCV_NNC_SGEMM_MR, parallel->m - i * CCV_NNC_SGEMM_MR);
+	const float* const ap = parallel->a + i * CCV_NNC_SGEMM_MR * parallel->rsa;
+	float* pap = parallel->pa + i * CCV_NNC_SGEMM_MR * kc;
+	int x, p;
+	for (p = 0; p < kc; p++, pap += CCV_NNC_SGEMM_MR)
+	{
+		for (x = 0; x < mr; x++)
+			pap[x] = ap[x * parallel->rsa + p * parallel->csa];
+		for (; x < CCV_NNC_SGEMM_MR; x++)
+			pap[x] = 0;
+	}
+}
+
+static void _ccv_nnc_sgemm_pack_b_parallel(void* const context, const int j)
+{
+	const ccv_nnc_sgemm_packed_parallel_t* const parallel = (ccv_nnc_sgemm_packed_parallel_t*)context;
+	const int kc = parallel->kc;
+	const int nr = parallel->nr;
+	const int nn = ccv_min(nr, parallel->nc - j * nr);
+	const float* const bp = parallel->b + j * nr * parallel->csb;
+	float* pbp = parallel->pb + j * nr * kc;
+	int x, p;
+	for (p = 0; p < kc; p++, pbp += nr)
+	{
+		if (parallel->csb == 1)
+			memcpy(pbp, bp + p * parallel->rsb, sizeof(float) * nn);
+		else
+			for (x = 0; x < nn; x++)
+				pbp[x] = bp[p * parallel->rsb + x * parallel->csb];
+		for (x = nn; x < nr; x++)
+			pbp[x] = 0;
+	}
+}
+
+static void _ccv_nnc_sgemm_compute_parallel(void* const context, const int job)
+{
+	const ccv_nnc_sgemm_packed_parallel_t* const parallel = (ccv_nnc_sgemm_packed_parallel_t*)context;
+	const int kc = parallel->kc;
+	const int nr = parallel->nr;
+	const int ic = (job / parallel->n_chunk_count) * CCV_NNC_SGEMM_MC;
+	const int mc = ccv_min(CCV_NNC_SGEMM_MC, parallel->m - ic);
+	const int jr_start = (job % parallel->n_chunk_count) * parallel->n_chunk;
+	const int jr_end = ccv_min(jr_start + parallel->n_chunk, (parallel->nc + nr - 1) / nr);
+	float edge[CCV_NNC_SGEMM_MR * CCV_NNC_SGEMM_MAX_NR];
+	int i, j, x, y;
+	for (j = jr_start; j < jr_end; j++)
+	{
+		const int nn = ccv_min(nr, parallel->nc - j * nr);
+		const float* const pbp = parallel->pb + j * nr * kc;
+		for (i = 0; i < mc; i += CCV_NNC_SGEMM_MR)
+		{
+			const int mm = ccv_min(CCV_NNC_SGEMM_MR, mc - i);
+			const float* const pap = parallel->pa + (ic + i) * kc;
+			float* const cp = parallel->c + (ic + i) * parallel->ldc + j * nr;
+			if (mm == CCV_NNC_SGEMM_MR && nn == nr)
+				parallel->kernel(kc, pap, pbp, cp, parallel->ldc, parallel->accumulate);
+			else {
+				// Partial tile, compute into a full tile on the stack and only write back what is inside.
+				parallel->kernel(kc, pap, pbp, edge, nr, 0);
+				for (y = 0; y < mm; y++)
+					for (x = 0; x < nn; x++)
+						cp[y * parallel->ldc + x] = parallel->accumulate ? cp[y * parallel->ldc + x] + edge[y * nr + x] : edge[y * nr + x];
+			}
+		}
+	}
+}
+
+static ccv_nnc_sgemm_kernel_f _ccv_nnc_sgemm_kernel(int* const nr)
+{
+#ifdef CCV_NNC_CPU_OPT_AVX512
+	if (_ccv_nnc_cpu_opt_has_avx512())
+	{
+		*nr = 32;
+		return _ccv_nnc_sgemm_kernel_6x32_avx512;
+	}
+#endif
+#ifdef CCV_NNC_CPU_OPT_AVX2
+	if (_ccv_nnc_cpu_opt_has_avx2_fma())
+	{
+		*nr = 16;
+		return _ccv_nnc_sgemm_kernel_6x16_avx2;
+	}
+#endif
+	*nr = 8;
+	return _ccv_nnc_sgemm_kernel_6x8;
+}
+
+void _ccv_nnc_sgemm_packed_cpu_opt(const int m, const int n, const int k, const float* const a, const int rsa, const int csa, const float* const b, const int rsb, const int csb, float* const c, const int ldc, const int accumulate)
+{
+	int nr;
+	const ccv_nnc_sgemm_kernel_f kernel = _ccv_nnc_sgemm_kernel(&nr);
+	if (k == 0)
+	{
+		int i;
+		if (!accumulate)
+			for (i = 0; i < m; i++)
+				memset(c + i * ldc, 0, sizeof(float) * n);
+		return;
+	}
+	const int m_round = (m + CCV_NNC_SGEMM_MR - 1) / CCV_NNC_SGEMM_MR * CCV_NNC_SGEMM_MR;
+	const int nc_max = ccv_min(CCV_NNC_SGEMM_NC, (n + nr - 1) / nr * nr);
+	const int kc_max = ccv_min(CCV_NNC_SGEMM_KC, k);
+	// Keep packed B on a 64-byte boundary, the microkernels use aligned loads on it.
+	const size_t pa_size = ((size_t)m_round * kc_max + 15) & -16;
+	float* pa = 0;
+	ccmemalign((void**)&pa, 64, sizeof(float) * (pa_size + (size_t)nc_max * kc_max));
+	float* const pb = pa + pa_size;
+	ccv_nnc_sgemm_packed_parallel_t parallel = {
+		.m = m,
+		.nr = nr,
+		.rsa = rsa,
+		.csa = csa,
+		.rsb = rsb,
+		.csb = csb,
+		.ldc = ldc,
+		.pa = pa,
+		.pb = pb,
+		.kernel = kernel,
+	};
+	const int m_blocks = (m + CCV_NNC_SGEMM_MC - 1) / CCV_NNC_SGEMM_MC;
+	const int thread_count = ccv_nnc_thread_pool_size();
+	int jc, pc;
+	for (jc = 0; jc < n; jc += CCV_NNC_SGEMM_NC)
+	{
+		const int nc = ccv_min(CCV_NNC_SGEMM_NC, n - jc);
+		const int n_panels = (nc + nr - 1) / nr;
+		// Split the NR micro-panels so there are enough jobs to occupy all threads even if A is only one MC block.
+		const int n_chunk_count = ccv_max(1, ccv_min(n_panels, (thread_count + m_blocks - 1) / m_blocks));
+		parallel.nc = nc;
+		parallel.n_chunk = (n_panels + n_chunk_count - 1) / n_chunk_count;
+		parallel.n_chunk_count = (n_panels + parallel.n_chunk - 1) / parallel.n_chunk;
+		parallel.c = c + jc;
+		for (pc = 0; pc < k; pc += CCV_NNC_SGEMM_KC)
+		{
+			parallel.kc = ccv_min(CCV_NNC_SGEMM_KC, k - pc);
+			parallel.a = a + pc * csa;
+			parallel.b = b + pc * rsb + jc * csb;
+			parallel.accumulate = accumulate || pc > 0;
+			ccv_nnc_parallel_for(n_panels, 0, _ccv_nnc_sgemm_pack_b_parallel, &parallel);
+			ccv_nnc_parallel_for(m_round / CCV_NNC_SGEMM_MR, 0, _ccv_nnc_sgemm_pack_a_parallel, &parallel);
+			ccv_nnc_parallel_for(m_blocks * parallel.n_chunk_count, 0, _ccv_nnc_sgemm_compute_parallel, &parallel);
+		}
+	}
+	ccfree(pa);
+}
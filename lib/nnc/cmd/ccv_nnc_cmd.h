@@ -112,6 +112,10 @@ enum {
 	CCV_NNC_BATCH_NORM_BACKWARD = 0x5419819d,
 	CCV_NNC_LAYER_NORM_FORWARD = 0xbed3c264,
 	CCV_NNC_LAYER_NORM_BACKWARD = 0xbed3c265,
-	CCV_NNC_COUNT = 107,
+	CCV_NNC_QUANTIZE_FORWARD = 0xb49048e,
+	CCV_NNC_QUANTIZE_BACKWARD = 0xb49048f,
+	CCV_NNC_DEQUANTIZE_FORWARD = 0x9736c488,
+	CCV_NNC_DEQUANTIZE_BACKWARD = 0x9736c489,
+	CCV_NNC_COUNT = 111,
 };
 /** @} */
@@ -242,5 +242,13 @@
 #define CMD_LAYER_NORM_FORWARD(_epsilon, ...) ccv_nnc_cmd(CCV_NNC_LAYER_NORM_FORWARD, 0, ((ccv_nnc_cmd_param_t){.size={.dim={1,1,1}},.lnorm={.epsilon=_epsilon,.count=LIST_COUNT(__VA_ARGS__),.axis={__VA_ARGS__}}}), 0)
 // CCV_NNC_LAYER_NORM_BACKWARD
 #define CMD_LAYER_NORM_BACKWARD(_epsilon, ...) ccv_nnc_cmd(CCV_NNC_LAYER_NORM_BACKWARD, 0, ((ccv_nnc_cmd_param_t){.size={.dim={1,1,1}},.lnorm={.epsilon=_epsilon,.count=LIST_COUNT(__VA_ARGS__),.axis={__VA_ARGS__}}}), 0)
+// CCV_NNC_QUANTIZE_FORWARD
+#define CMD_QUANTIZE_FORWARD(_scale) ccv_nnc_cmd(CCV_NNC_QUANTIZE_FORWARD, 0, (ccv_nnc_cmd_param_t){.size={.dim={1,1,1}},.blas={.a={_scale,}}}, 0)
+// CCV_NNC_QUANTIZE_BACKWARD
+#define CMD_QUANTIZE_BACKWARD(_scale) ccv_nnc_cmd(CCV_NNC_QUANTIZE_BACKWARD, 0, (ccv_nnc_cmd_param_t){.size={.dim={1,1,1}},.blas={.a={_scale,}}}, 0)
+// CCV_NNC_DEQUANTIZE_FORWARD
+#define CMD_DEQUANTIZE_FORWARD() ccv_nnc_cmd(CCV_NNC_DEQUANTIZE_FORWARD, 0, ccv_nnc_cmd_auto, 0)
+// CCV_NNC_DEQUANTIZE_BACKWARD
+#define CMD_DEQUANTIZE_BACKWARD() ccv_nnc_cmd(CCV_NNC_DEQUANTIZE_BACKWARD, 0, ccv_nnc_cmd_auto, 0)
 
 /** @} */
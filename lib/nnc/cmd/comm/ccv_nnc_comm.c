@@ -94,7 +94,7 @@ static int _ccv_nnc_allreduce_back_bitmask(const int input_size, const int outpu
 }
 
 REGISTER_COMMAND(CCV_NNC_COMM_ALLREDUCE_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(gpu/ccv_nnc_comm_gpu_nccl.cu)
+	FIND_BACKEND(ccv_nnc_comm_cpu_ref.c, gpu/ccv_nnc_comm_gpu_nccl.cu)
 {
 	registry->bitmask = _ccv_nnc_allreduce_forw_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
@@ -102,7 +102,7 @@ REGISTER_COMMAND(CCV_NNC_COMM_ALLREDUCE_FORWARD)(ccv_nnc_cmd_registry_t* const r
 }
 
 REGISTER_COMMAND(CCV_NNC_COMM_ALLREDUCE_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(gpu/ccv_nnc_comm_gpu_nccl.cu)
+	FIND_BACKEND(ccv_nnc_comm_cpu_ref.c, gpu/ccv_nnc_comm_gpu_nccl.cu)
 {
 	registry->bitmask = _ccv_nnc_allreduce_back_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_backward_from_gradient;
@@ -206,7 +206,7 @@ static int _ccv_nnc_broadcast_back_bitmask(const int input_size, const int outpu
 }
 
 REGISTER_COMMAND(CCV_NNC_COMM_BROADCAST_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(gpu/ccv_nnc_comm_gpu_nccl.cu)
+	FIND_BACKEND(ccv_nnc_comm_cpu_ref.c, gpu/ccv_nnc_comm_gpu_nccl.cu)
 {
 	registry->bitmask = _ccv_nnc_broadcast_forw_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_backward_from_gradient;
@@ -214,7 +214,7 @@ REGISTER_COMMAND(CCV_NNC_COMM_BROADCAST_FORWARD)(ccv_nnc_cmd_registry_t* const r
 }
 
 REGISTER_COMMAND(CCV_NNC_COMM_BROADCAST_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(gpu/ccv_nnc_comm_gpu_nccl.cu)
+	FIND_BACKEND(ccv_nnc_comm_cpu_ref.c, gpu/ccv_nnc_comm_gpu_nccl.cu)
 {
 	registry->bitmask = _ccv_nnc_broadcast_back_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
@@ -318,7 +318,7 @@ static int _ccv_nnc_reduce_back_bitmask(const int input_size, const int output_s
 }
 
 REGISTER_COMMAND(CCV_NNC_COMM_REDUCE_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(gpu/ccv_nnc_comm_gpu_nccl.cu)
+	FIND_BACKEND(ccv_nnc_comm_cpu_ref.c, gpu/ccv_nnc_comm_gpu_nccl.cu)
 {
 	registry->bitmask = _ccv_nnc_reduce_forw_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
@@ -326,7 +326,7 @@ REGISTER_COMMAND(CCV_NNC_COMM_REDUCE_FORWARD)(ccv_nnc_cmd_registry_t* const regi
 }
 
 REGISTER_COMMAND(CCV_NNC_COMM_REDUCE_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(gpu/ccv_nnc_comm_gpu_nccl.cu)
+	FIND_BACKEND(ccv_nnc_comm_cpu_ref.c, gpu/ccv_nnc_comm_gpu_nccl.cu)
 {
 	registry->bitmask = _ccv_nnc_reduce_back_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_backward_from_gradient;
@@ -0,0 +1,307 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+
+// Each "device" is one replica of the tensor in the host memory. Work is split into chunks so a worker only writes to
+// the replica it owns in each step, which keeps the writes local if the replicas are allocated on different NUMA nodes.
+#define CCV_NNC_COMM_CHUNK (16384)
+
+enum {
+	CCV_NNC_CMD_COMM_ALGO_RING = 0, // Reduce-scatter then all-gather around a ring, bandwidth optimal.
+	CCV_NNC_CMD_COMM_ALGO_TREE = 1, // Pairwise reduction then broadcast down a binary tree, fewer steps.
+	CCV_NNC_CMD_COMM_ALGO_COUNT
+};
+
+typedef struct {
+	ccv_nnc_tensor_t* const* tensors;
+	int device_count;
+	int step;
+	int chunk_count; // Chunks per segment / per tensor.
+	size_t count;
+} ccv_nnc_comm_parallel_t;
+
+static inline size_t _ccv_nnc_ring_segment_start(const ccv_nnc_comm_parallel_t* const parallel, const int segment)
+{
+	return parallel->count * segment / parallel->device_count;
+}
+
+static void _ccv_nnc_ring_reduce_scatter_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_comm_parallel_t* const parallel = (ccv_nnc_comm_parallel_t*)context;
+	const int device_count = parallel->device_count;
+	const int device_id = idx / parallel->chunk_count;
+	const int prev_id = (device_id + device_count - 1) % device_count;
+	// In step s, device i accumulates segment (i - 1 - s) from its predecessor, which is never the segment the predecessor writes.
+	const int segment = (device_id + device_count * 2 - 1 - parallel->step) % device_count;
+	const size_t start = _ccv_nnc_ring_segment_start(parallel, segment) + (size_t)(idx % parallel->chunk_count) * CCV_NNC_COMM_CHUNK;
+	const size_t end = ccv_min(start + CCV_NNC_COMM_CHUNK, _ccv_nnc_ring_segment_start(parallel, segment + 1));
+	if (start >= end)
+		return;
+	float* const bp = parallel->tensors[device_id]->data.f32;
+	const float* const ap = parallel->tensors[prev_id]->data.f32;
+	size_t x;
+	for (x = start; x < end; x++)
+		bp[x] += ap[x];
+}
+
+static void _ccv_nnc_ring_all_gather_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_comm_parallel_t* const parallel = (ccv_nnc_comm_parallel_t*)context;
+	const int device_count = parallel->device_count;
+	const int device_id = idx / parallel->chunk_count;
+	const int prev_id = (device_id + device_count - 1) % device_count;
+	// After reduce-scatter, device i holds the complete segment (i + 1). In step s, device i copies segment (i - s).
+	const int segment = (device_id + device_count - parallel->step) % device_count;
+	const size_t start = _ccv_nnc_ring_segment_start(parallel, segment) + (size_t)(idx % parallel->chunk_count) * CCV_NNC_COMM_CHUNK;
+	const size_t end = ccv_min(start + CCV_NNC_COMM_CHUNK, _ccv_nnc_ring_segment_start(parallel, segment + 1));
+	if (start >= end)
+		return;
+	memcpy(parallel->tensors[device_id]->data.f32 + start, parallel->tensors[prev_id]->data.f32 + start, sizeof(float) * (end - start));
+}
+
+static void _ccv_nnc_tree_reduce_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_comm_parallel_t* const parallel = (ccv_nnc_comm_parallel_t*)context;
+	const int stride = parallel->step;
+	const int device_id = idx / parallel->chunk_count * stride * 2;
+	if (device_id + stride >= parallel->device_count)
+		return;
+	const size_t start = (size_t)(idx % parallel->chunk_count) * CCV_NNC_COMM_CHUNK;
+	const size_t end = ccv_min(start + CCV_NNC_COMM_CHUNK, parallel->count);
+	float* const bp = parallel->tensors[device_id]->data.f32;
+	const float* const ap = parallel->tensors[device_id + stride]->data.f32;
+	size_t x;
+	for (x = start; x < end; x++)
+		bp[x] += ap[x];
+}
+
+static void _ccv_nnc_tree_broadcast_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_comm_parallel_t* const parallel = (ccv_nnc_comm_parallel_t*)context;
+	const int stride = parallel->step;
+	const int device_id = idx / parallel->chunk_count * stride * 2;
+	if (device_id + stride >= parallel->device_count)
+		return;
+	const size_t start = (size_t)(idx % parallel->chunk_count) * CCV_NNC_COMM_CHUNK;
+	const size_t end = ccv_min(start + CCV_NNC_COMM_CHUNK, parallel->count);
+	memcpy(parallel->tensors[device_id + stride]->data.f32 + start, parallel->tensors[device_id]->data.f32 + start, sizeof(float) * (end - start));
+}
+
+typedef struct {
+	ccv_nnc_tensor_t* const* inputs;
+	int input_size;
+	ccv_nnc_tensor_t* const* outputs;
+	int output_size;
+	size_t count;
+} ccv_nnc_comm_fan_parallel_t;
+
+static void _ccv_nnc_reduce_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_comm_fan_parallel_t* const parallel = (ccv_nnc_comm_fan_parallel_t*)context;
+	const size_t start = (size_t)idx * CCV_NNC_COMM_CHUNK;
+	const size_t end = ccv_min(start + CCV_NNC_COMM_CHUNK, parallel->count);
+	float* const bp = parallel->outputs[0]->data.f32;
+	// The output can be the first input, thus, accumulate the rest into it in order.
+	if (bp != parallel->inputs[0]->data.f32)
+		memcpy(bp + start, parallel->inputs[0]->data.f32 + start, sizeof(float) * (end - start));
+	int i;
+	size_t x;
+	for (i = 1; i < parallel->input_size; i++)
+	{
+		const float* const ap = parallel->inputs[i]->data.f32;
+		for (x = start; x < end; x++)
+			bp[x] += ap[x];
+	}
+}
+
+static void _ccv_nnc_broadcast_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_comm_fan_parallel_t* const parallel = (ccv_nnc_comm_fan_parallel_t*)context;
+	const size_t start = (size_t)idx * CCV_NNC_COMM_CHUNK;
+	const size_t end = ccv_min(start + CCV_NNC_COMM_CHUNK, parallel->count);
+	const float* const ap = parallel->inputs[0]->data.f32;
+	int i;
+	for (i = 0; i < parallel->output_size; i++)
+		if (parallel->outputs[i]->data.f32 != ap)
+			memcpy(parallel->outputs[i]->data.f32 + start, ap + start, sizeof(float) * (end - start));
+}
+
+static int _ccv_nnc_allreduce_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size >= output_size);
+	assert(output_size > 0);
+	int i;
+	const size_t tensor_count = ccv_nnc_tensor_count(inputs[0]->info);
+	for (i = 0; i < output_size; i++)
+	{
+		assert(!CCV_IS_TENSOR_VIEW(inputs[i]));
+		assert(ccv_nnc_tensor_count(inputs[i]->info) == tensor_count);
+		assert(!CCV_IS_TENSOR_VIEW(outputs[i]));
+		assert(ccv_nnc_tensor_count(outputs[i]->info) == tensor_count);
+		if (inputs[i]->data.f32 != outputs[i]->data.f32)
+			memcpy(outputs[i]->data.f32, inputs[i]->data.f32, sizeof(float) * tensor_count);
+	}
+	const int device_count = output_size;
+	if (device_count == 1 || tensor_count == 0)
+		return CCV_NNC_EXEC_SUCCESS;
+	ccv_nnc_comm_parallel_t parallel = {
+		.tensors = outputs,
+		.device_count = device_count,
+		.count = tensor_count,
+	};
+	if (cmd.algorithm == CCV_NNC_CMD_COMM_ALGO_TREE)
+	{
+		parallel.chunk_count = (tensor_count + CCV_NNC_COMM_CHUNK - 1) / CCV_NNC_COMM_CHUNK;
+		int stride;
+		for (stride = 1; stride < device_count; stride *= 2)
+		{
+			parallel.step = stride;
+			ccv_nnc_parallel_for((device_count + stride * 2 - 1) / (stride * 2) * parallel.chunk_count, 0, _ccv_nnc_tree_reduce_parallel, &parallel);
+		}
+		for (stride /= 2; stride > 0; stride /= 2)
+		{
+			parallel.step = stride;
+			ccv_nnc_parallel_for((device_count + stride * 2 - 1) / (stride * 2) * parallel.chunk_count, 0, _ccv_nnc_tree_broadcast_parallel, &parallel);
+		}
+		return CCV_NNC_EXEC_SUCCESS;
+	}
+	// The largest segment determines how many chunks each device processes per step.
+	const size_t segment_size = (tensor_count + device_count - 1) / device_count;
+	parallel.chunk_count = (segment_size + CCV_NNC_COMM_CHUNK - 1) / CCV_NNC_COMM_CHUNK;
+	for (i = 0; i < device_count - 1; i++)
+	{
+		parallel.step = i;
+		ccv_nnc_parallel_for(device_count * parallel.chunk_count, 0, _ccv_nnc_ring_reduce_scatter_parallel, &parallel);
+	}
+	for (i = 0; i < device_count - 1; i++)
+	{
+		parallel.step = i;
+		ccv_nnc_parallel_for(device_count * parallel.chunk_count, 0, _ccv_nnc_ring_all_gather_parallel, &parallel);
+	}
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_allreduce_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(output_size >= input_size);
+	// For allreduce, forward and backward are the same.
+	return _ccv_nnc_allreduce_forw(cmd, hint, flags, inputs, output_size, outputs, output_size, stream_context);
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_COMM_ALLREDUCE_FORWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = CCV_NNC_CMD_COMM_ALGO_COUNT;
+	registry->exec = _ccv_nnc_allreduce_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_COMM_ALLREDUCE_BACKWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = CCV_NNC_CMD_COMM_ALGO_COUNT;
+	registry->exec = _ccv_nnc_allreduce_back;
+}
+
+static int _ccv_nnc_broadcast_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 1);
+	assert(output_size >= 1);
+	int i;
+	assert(!CCV_IS_TENSOR_VIEW(inputs[0]));
+	const size_t tensor_count = ccv_nnc_tensor_count(inputs[0]->info);
+	for (i = 0; i < output_size; i++)
+	{
+		assert(!CCV_IS_TENSOR_VIEW(outputs[i]));
+		assert(ccv_nnc_tensor_count(outputs[i]->info) == tensor_count);
+	}
+	ccv_nnc_comm_fan_parallel_t parallel = {
+		.inputs = inputs,
+		.input_size = 1,
+		.outputs = outputs,
+		.output_size = output_size,
+		.count = tensor_count,
+	};
+	ccv_nnc_parallel_for((tensor_count + CCV_NNC_COMM_CHUNK - 1) / CCV_NNC_COMM_CHUNK, 0, _ccv_nnc_broadcast_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_reduce_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size >= 1);
+	assert(output_size >= 1);
+	int i;
+	assert(!CCV_IS_TENSOR_VIEW(outputs[0]));
+	const size_t tensor_count = ccv_nnc_tensor_count(outputs[0]->info);
+	for (i = 0; i < input_size; i++)
+	{
+		assert(!CCV_IS_TENSOR_VIEW(inputs[i]));
+		assert(ccv_nnc_tensor_count(inputs[i]->info) == tensor_count);
+		// Only the first input can be in-place with the output.
+		assert(i == 0 || inputs[i]->data.f32 != outputs[0]->data.f32);
+	}
+	ccv_nnc_comm_fan_parallel_t parallel = {
+		.inputs = inputs,
+		.input_size = input_size,
+		.outputs = outputs,
+		.output_size = 1,
+		.count = tensor_count,
+	};
+	ccv_nnc_parallel_for((tensor_count + CCV_NNC_COMM_CHUNK - 1) / CCV_NNC_COMM_CHUNK, 0, _ccv_nnc_reduce_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_broadcast_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(output_size == 1);
+	// The gradient of broadcast is the reduce of the gradients.
+	return _ccv_nnc_reduce_forw(cmd, hint, flags, inputs, (input_size - 1) / 2, outputs, output_size, stream_context);
+}
+
+static int _ccv_nnc_reduce_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 1);
+	// The gradient of reduce is the broadcast of the gradient.
+	return _ccv_nnc_broadcast_forw(cmd, hint, flags, inputs, 1, outputs, output_size, stream_context);
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_COMM_BROADCAST_FORWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_broadcast_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_COMM_BROADCAST_BACKWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_broadcast_back;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_COMM_REDUCE_FORWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_reduce_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_COMM_REDUCE_BACKWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_reduce_back;
+}
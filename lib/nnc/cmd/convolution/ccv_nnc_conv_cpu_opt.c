@@ -6,16 +6,31 @@
 
 #include "_ccv_nnc_conv_cpu_opt.h"
 
-FIND_FILE(cpu_opt/_ccv_nnc_conv_cpu_4x4_3x3_winograd.c, cpu_opt/_ccv_nnc_conv_cpu_fft.c, cpu_opt/_ccv_nnc_conv_cpu_gemm.c, cpu_opt/_ccv_nnc_conv_cpu_opt.c)
+// Shared methods.
+#include "../_ccv_nnc_cpu_opt.h"
+
+FIND_FILE(cpu_opt/_ccv_nnc_conv_cpu_4x4_3x3_winograd.c, cpu_opt/_ccv_nnc_conv_cpu_fft.c, cpu_opt/_ccv_nnc_conv_cpu_gemm.c, cpu_opt/_ccv_nnc_conv_cpu_grouped.c, cpu_opt/_ccv_nnc_conv_cpu_opt.c, cpu_opt/_ccv_nnc_conv_cpu_winograd.c)
 
 enum {
 	CCV_NNC_CMD_OPT_CONV_ALGO_DC, // Direct convolution
 	CCV_NNC_CMD_OPT_CONV_ALGO_GEMM, // GEMM (for 1x1)
 	CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD, // Winograd algorithm
 	CCV_NNC_CMD_OPT_CONV_ALGO_FFT, // Fast Fourier transform
+	CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD_2X2_3X3, // Winograd F(2x2, 3x3), fewer transforms for small feature maps
+	CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD_6X6_3X3, // Winograd F(6x6, 3x3), fewer multiplies for large feature maps
+	CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD_4X4_5X5, // Winograd F(4x4, 5x5)
+	CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD_STRIDED, // Winograd on the polyphase components of a stride 2 convolution
 	CCV_NNC_CMD_OPT_CONV_ALGO_COUNT
 };
 
+// For the kernels that don't fuse the activation, apply it after the whole output is computed.
+static int _ccv_nnc_conv_forw_activation(const int result, const int activation, ccv_nnc_tensor_view_t* const b)
+{
+	if (result == CCV_NNC_EXEC_SUCCESS)
+		_ccv_nnc_activation_tensor_cpu_opt(activation, b);
+	return result;
+}
+
 static int _ccv_nnc_conv_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
 	assert(input_size >= 2);
@@ -32,10 +47,9 @@ static int _ccv_nnc_conv_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
 	assert(b_nd == CCV_NNC_MAX_DIM + 1 || b_nd == CCV_NNC_MAX_DIM + 2);
 	const int* bdim = (b_nd == CCV_NNC_MAX_DIM + 1) ? b->info.dim : b->info.dim + 1;
-	assert(w->info.dim[CCV_NNC_MAX_DIM + 1] == adim[CCV_NNC_MAX_DIM]);
+	const int groups = cmd.info.convolution.groups;
+	assert(w->info.dim[CCV_NNC_MAX_DIM + 1] * groups == adim[CCV_NNC_MAX_DIM]);
 	assert(bdim[CCV_NNC_MAX_DIM] == cmd.info.convolution.count);
-	if (cmd.info.convolution.groups != 1)
-		return CCV_NNC_EXEC_INVALID;
 	int i;
 	// Make sure the weights dimension matches the network dimension
 	for (i = 1; i < CCV_NNC_MAX_DIM_ALLOC; i++)
@@ -44,43 +58,142 @@ static int _ccv_nnc_conv_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 			break;
 		assert(w->info.dim[i] == cmd.info.size.dim[i - 1]);
 	}
+	if (groups != 1)
+	{
+		// Grouped (and depthwise) convolution only has a direct kernel, in full precision.
+		if (a->info.datatype != CCV_32F || w->info.datatype != CCV_32F || (bias && bias->info.datatype != CCV_32F) || b->info.datatype != CCV_32F ||
+			(cmd.algorithm != -1 && cmd.algorithm != CCV_NNC_CMD_OPT_CONV_ALGO_DC))
+			return CCV_NNC_EXEC_INVALID;
+		return _ccv_nnc_conv_forw_activation(_ccv_nnc_conv_forw_grouped_cpu_opt(a, w, bias, groups, hint, b, stream_context), cmd.info.activation.type, b);
+	}
+	if (a->info.datatype == CCV_8S)
+	{
+		// The quantized convolution takes the activation scale and the weight scales after the bias.
+		if (input_size < 5 || w->info.datatype != CCV_8S || (cmd.algorithm != -1 && cmd.algorithm != CCV_NNC_CMD_OPT_CONV_ALGO_DC))
+			return CCV_NNC_EXEC_INVALID;
+		return _ccv_nnc_conv_forw_activation(_ccv_nnc_conv_forw_8s_cpu_opt(a, w, bias, inputs[3], inputs[4], hint, b, stream_context), cmd.info.activation.type, b);
+	}
+	if (a->info.datatype == CCV_16F || w->info.datatype == CCV_16F || (bias && bias->info.datatype == CCV_16F) || b->info.datatype == CCV_16F)
+	{
+		// Only direct convolution can handle half precision.
+		if (cmd.algorithm != -1 && cmd.algorithm != CCV_NNC_CMD_OPT_CONV_ALGO_DC)
+			return CCV_NNC_EXEC_INVALID;
+		return _ccv_nnc_conv_forw_activation(_ccv_nnc_conv_forw_16f_cpu_opt(a, w, bias, hint, b, stream_context), cmd.info.activation.type, b);
+	}
 	switch (cmd.algorithm)
 	{
 		case CCV_NNC_CMD_OPT_CONV_ALGO_DC:
-			return _ccv_nnc_conv_forw_cpu_opt(a, w, bias, hint, b);
+			return _ccv_nnc_conv_forw_cpu_opt(a, w, bias, hint, b, cmd.info.activation.type);
 		case CCV_NNC_CMD_OPT_CONV_ALGO_GEMM:
 			if (w->info.dim[1] == 1 && w->info.dim[2] == 1 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1 &&
 				hint.border.begin[0] == 0 && hint.border.begin[1] == 0 && hint.border.end[0] == 0 && hint.border.end[1] == 0 &&
 				!CCV_IS_TENSOR_VIEW(a) && !CCV_IS_TENSOR_VIEW(b) && !CCV_IS_TENSOR_VIEW(w) && (!bias || !CCV_IS_TENSOR_VIEW(bias)))
-				return _ccv_nnc_conv_forw_gemm_cpu_opt(a, w, bias, hint, b);
+				return _ccv_nnc_conv_forw_activation(_ccv_nnc_conv_forw_gemm_cpu_opt(a, w, bias, hint, b), cmd.info.activation.type, b);
 			return CCV_NNC_EXEC_INVALID;
 		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD:
 			if (w->info.dim[1] == 3 && w->info.dim[2] == 3 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1)
-				return _ccv_nnc_conv_forw_4x4_3x3_winograd_cpu_opt(a, w, bias, hint, b, stream_context);
+				return _ccv_nnc_conv_forw_4x4_3x3_winograd_cpu_opt(a, w, bias, hint, b, cmd.info.activation.type, stream_context);
 			return CCV_NNC_EXEC_INVALID;
 		case CCV_NNC_CMD_OPT_CONV_ALGO_FFT:
 			return CCV_NNC_EXEC_INVALID; // Placeholder, for fft.
+		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD_2X2_3X3:
+			if (w->info.dim[1] == 3 && w->info.dim[2] == 3 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1)
+				return _ccv_nnc_conv_forw_activation(_ccv_nnc_conv_forw_winograd_cpu_opt(a, w, bias, 2, hint, b, stream_context), cmd.info.activation.type, b);
+			return CCV_NNC_EXEC_INVALID;
+		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD_6X6_3X3:
+			if (w->info.dim[1] == 3 && w->info.dim[2] == 3 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1)
+				return _ccv_nnc_conv_forw_activation(_ccv_nnc_conv_forw_winograd_cpu_opt(a, w, bias, 6, hint, b, stream_context), cmd.info.activation.type, b);
+			return CCV_NNC_EXEC_INVALID;
+		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD_4X4_5X5:
+			if (w->info.dim[1] == 5 && w->info.dim[2] == 5 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1)
+				return _ccv_nnc_conv_forw_activation(_ccv_nnc_conv_forw_winograd_cpu_opt(a, w, bias, 4, hint, b, stream_context), cmd.info.activation.type, b);
+			return CCV_NNC_EXEC_INVALID;
+		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD_STRIDED:
+			if (((w->info.dim[1] == 3 && w->info.dim[2] == 3) || (w->info.dim[1] == 5 && w->info.dim[2] == 5)) && hint.stride.dim[0] == 2 && hint.stride.dim[1] == 2)
+				return _ccv_nnc_conv_forw_activation(_ccv_nnc_conv_forw_strided_winograd_cpu_opt(a, w, bias, hint, b, stream_context), cmd.info.activation.type, b);
+			return CCV_NNC_EXEC_INVALID;
 		case -1:
 			// Pass-through
 			break;
 	}
 	// If the size is 3x3, and no stride, choose Winograd kernel
 	if (w->info.dim[1] == 3 && w->info.dim[2] == 3 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1)
-		return _ccv_nnc_conv_forw_4x4_3x3_winograd_cpu_opt(a, w, bias, hint, b, stream_context);
+		return _ccv_nnc_conv_forw_4x4_3x3_winograd_cpu_opt(a, w, bias, hint, b, cmd.info.activation.type, stream_context);
 	// If the size is 1x1, and no stride, and not a tensor view object, no padding, choose GEMM kernel
 	if (w->info.dim[1] == 1 && w->info.dim[2] == 1 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1 &&
 		hint.border.begin[0] == 0 && hint.border.begin[1] == 0 && hint.border.end[0] == 0 && hint.border.end[1] == 0 &&
 		!CCV_IS_TENSOR_VIEW(a) && !CCV_IS_TENSOR_VIEW(b) && !CCV_IS_TENSOR_VIEW(w) && (!bias || !CCV_IS_TENSOR_VIEW(bias)))
-		return _ccv_nnc_conv_forw_gemm_cpu_opt(a, w, bias, hint, b);
+		return _ccv_nnc_conv_forw_activation(_ccv_nnc_conv_forw_gemm_cpu_opt(a, w, bias, hint, b), cmd.info.activation.type, b);
 	// Otherwise, use direct convolution kernel
-	return _ccv_nnc_conv_forw_cpu_opt(a, w, bias, hint, b);
+	return _ccv_nnc_conv_forw_cpu_opt(a, w, bias, hint, b, cmd.info.activation.type);
 }
 
+#if (defined HAVE_CBLAS || defined HAVE_ACCELERATE_FRAMEWORK)
+static int _ccv_nnc_conv_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	// inputs: gradient, forw prop input, [w]
+	// outputs: [output gradient], weight updates, bias updates
+	assert(input_size >= 2 && output_size >= 2);
+	const ccv_nnc_tensor_view_t* g = (ccv_nnc_tensor_view_t*)inputs[0]; // gradients
+	const ccv_nnc_tensor_view_t* a = (ccv_nnc_tensor_view_t*)inputs[1];
+	ccv_nnc_tensor_t* dw = outputs[1];
+	assert(!CCV_IS_TENSOR_VIEW(dw));
+	ccv_nnc_tensor_t* bias = output_size > 2 ? outputs[2] : 0;
+	assert(!bias || !CCV_IS_TENSOR_VIEW(bias));
+	ccv_nnc_tensor_view_t* h = (ccv_nnc_tensor_view_t*)outputs[0]; // output gradients
+	const ccv_nnc_tensor_t* w = h ? inputs[2] : 0;
+	assert(!h || (input_size > 2 && w));
+	if (cmd.info.convolution.groups != 1)
+		return CCV_NNC_EXEC_INVALID;
+	// The Winograd kernel only computes the output gradient, weight updates always go through GEMM.
+	const int winograd = h && dw->info.dim[1] == 3 && dw->info.dim[2] == 3 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1 &&
+		hint.border.begin[0] == 1 && hint.border.begin[1] == 1 && hint.border.end[0] <= 2 && hint.border.end[1] <= 2;
+	switch (cmd.algorithm)
+	{
+		case CCV_NNC_CMD_OPT_CONV_ALGO_GEMM:
+			return _ccv_nnc_conv_back_gemm_cpu_opt(g, a, w, dw, bias, hint, h, flags, stream_context);
+		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD:
+			if (!winograd)
+				return CCV_NNC_EXEC_INVALID;
+			break;
+		case CCV_NNC_CMD_OPT_CONV_ALGO_DC:
+		case CCV_NNC_CMD_OPT_CONV_ALGO_FFT:
+		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD_2X2_3X3:
+		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD_6X6_3X3:
+		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD_4X4_5X5:
+		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD_STRIDED:
+			return CCV_NNC_EXEC_INVALID;
+		case -1:
+			// Pass-through
+			if (!winograd)
+				return _ccv_nnc_conv_back_gemm_cpu_opt(g, a, w, dw, bias, hint, h, flags, stream_context);
+			break;
+	}
+	const int result = _ccv_nnc_conv_back_gemm_cpu_opt(g, a, 0, dw, bias, hint, 0, flags, stream_context);
+	if (result != CCV_NNC_EXEC_SUCCESS)
+		return result;
+	return _ccv_nnc_conv_back_4x4_3x3_winograd_cpu_opt(g, w, hint, h, stream_context);
+}
+#endif
+
 REGISTER_COMMAND_BACKEND(CCV_NNC_CONVOLUTION_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
 {
 	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
-	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_datatypes = CCV_32F | CCV_16F | CCV_8S;
 	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
 	registry->algorithms = CCV_NNC_CMD_OPT_CONV_ALGO_COUNT;
+	registry->activations = CCV_NNC_ACTIVATION_ALL;
 	registry->exec = _ccv_nnc_conv_forw;
 }
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_CONVOLUTION_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = CCV_NNC_CMD_OPT_CONV_ALGO_COUNT;
+#if (defined HAVE_CBLAS || defined HAVE_ACCELERATE_FRAMEWORK)
+	// Weight and bias updates always go through cblas_sgemm, leave backward to the reference backend otherwise.
+	registry->exec = _ccv_nnc_conv_back;
+#endif
+}
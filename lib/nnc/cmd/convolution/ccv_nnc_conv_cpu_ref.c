@@ -3,12 +3,74 @@
 #include "nnc/ccv_nnc.h"
 #include "nnc/ccv_nnc_easy.h"
 #include "nnc/ccv_nnc_internal.h"
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif
-#ifdef USE_DISPATCH
-#include <dispatch/dispatch.h>
-#endif
+
+typedef struct {
+	const ccv_nnc_tensor_view_t* a;
+	const ccv_nnc_tensor_view_t* g;
+	ccv_nnc_tensor_view_t* b;
+	const ccv_nnc_tensor_t* w;
+	const ccv_nnc_tensor_t* bias;
+	const int* adim;
+	const int* bdim;
+	const int* gdim;
+	const int* ainc;
+	const int* binc;
+	const int* ginc;
+	ccv_nnc_hint_t hint;
+	int group_size;
+	int channel_size;
+} ccv_nnc_conv_parallel_t;
+
+static void _ccv_nnc_conv_forw_parallel(void* const context, const int k)
+{
+	const ccv_nnc_conv_parallel_t* const parallel = (ccv_nnc_conv_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	ccv_nnc_tensor_view_t* const b = parallel->b;
+	const ccv_nnc_tensor_t* const w = parallel->w;
+	const ccv_nnc_tensor_t* const bias = parallel->bias;
+	const int* const adim = parallel->adim;
+	const int* const bdim = parallel->bdim;
+	const int* const ainc = parallel->ainc;
+	const int* const binc = parallel->binc;
+	const ccv_nnc_hint_t hint = parallel->hint;
+	const int group_size = parallel->group_size;
+	const int channel_size = parallel->channel_size;
+	int c;
+	const int gidx = k / group_size;
+	float* ap = a->data.f32;
+	float* bp = b->data.f32 + k;
+	// kernel weight for one dim.
+	float* wp = w->data.f32 + k * w->info.dim[1] * w->info.dim[2] * channel_size;
+	float biasval = bias ? bias->data.f32[k] : 0;
+	// This block will be cause in each for-loop, therefore, you can use it to generate some temporary variables.
+	int i[CCV_NNC_MAX_DIM];
+	int n[CCV_NNC_MAX_DIM];
+	int m[CCV_NNC_MAX_DIM];
+	int j[CCV_NNC_MAX_DIM];
+	for (i[0] = 0; i[0] < bdim[0]; i[0]++)
+	{
+		SET_BORDER_OFFSET_SIZE_FOR(0, i, hint, w->info.dim + 1, adim, n, m);
+		float* wpu = wp + n[0] * w->info.dim[CCV_NNC_MAX_DIM] * channel_size;
+		for (i[1] = 0; i[1] < bdim[1]; i[1]++)
+		{
+			SET_BORDER_OFFSET_SIZE_FOR(1, i, hint, w->info.dim + 1, adim, n, m);
+			float p = biasval;
+			float* wpz = wpu + n[1] * channel_size;
+			float* apz = ap + ccv_max(i[1] * hint.stride.dim[1] - hint.border.begin[1], 0) * ainc[CCV_NNC_MAX_DIM] + gidx * channel_size;
+			for (j[0] = 0; j[0] < m[0]; j[0]++)
+			{
+				for (j[1] = 0; j[1] < m[1]; j[1]++)
+					for (c = 0; c < channel_size; c++)
+						p += wpz[j[1] * channel_size + c] * apz[j[1] * ainc[CCV_NNC_MAX_DIM] + c];
+				wpz += w->info.dim[CCV_NNC_MAX_DIM] * channel_size;
+				apz += ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM];
+			}
+			bp[i[1] * binc[CCV_NNC_MAX_DIM]] = p;
+		}
+		bp += binc[CCV_NNC_MAX_DIM - 1] * binc[CCV_NNC_MAX_DIM];
+		ap += ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM] * (ccv_max((i[0] + 1) * hint.stride.dim[0] - hint.border.begin[0], 0) - ccv_max(i[0] * hint.stride.dim[0] - hint.border.begin[0], 0));
+	}
+}
 
 static int _ccv_nnc_conv_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
@@ -45,44 +107,75 @@ static int _ccv_nnc_conv_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 	const int* binc = CCV_IS_TENSOR_VIEW(b) ? ((b_nd == CCV_NNC_MAX_DIM + 1) ? b->inc : b->inc + 1) : bdim;
 	assert(!bias || bias->info.dim[0] == cmd.info.convolution.count);
 	const int channel_size = w->info.dim[CCV_NNC_MAX_DIM + 1];
-	parallel_for(k, cmd.info.convolution.count) {
-		int c;
-		const int gidx = k / group_size;
-		float* ap = a->data.f32;
-		float* bp = b->data.f32 + k;
-		// kernel weight for one dim.
-		float* wp = w->data.f32 + k * w->info.dim[1] * w->info.dim[2] * channel_size;
-		float biasval = bias ? bias->data.f32[k] : 0;
-		// This block will be cause in each for-loop, therefore, you can use it to generate some temporary variables.
-		int i[CCV_NNC_MAX_DIM];
-		int n[CCV_NNC_MAX_DIM];
-		int m[CCV_NNC_MAX_DIM];
-		int j[CCV_NNC_MAX_DIM];
-		for (i[0] = 0; i[0] < bdim[0]; i[0]++)
+	ccv_nnc_conv_parallel_t parallel = {
+		.a = a,
+		.b = b,
+		.w = w,
+		.bias = bias,
+		.adim = adim,
+		.bdim = bdim,
+		.ainc = ainc,
+		.binc = binc,
+		.hint = hint,
+		.group_size = group_size,
+		.channel_size = channel_size,
+	};
+	ccv_nnc_parallel_for(cmd.info.convolution.count, 0, _ccv_nnc_conv_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static void _ccv_nnc_conv_back_parallel(void* const context, const int k)
+{
+	const ccv_nnc_conv_parallel_t* const parallel = (ccv_nnc_conv_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	const ccv_nnc_tensor_view_t* const g = parallel->g;
+	const ccv_nnc_tensor_t* const w = parallel->w;
+	const ccv_nnc_tensor_t* const bias = parallel->bias;
+	const int* const adim = parallel->adim;
+	const int* const gdim = parallel->gdim;
+	const int* const ainc = parallel->ainc;
+	const int* const ginc = parallel->ginc;
+	const ccv_nnc_hint_t hint = parallel->hint;
+	const int group_size = parallel->group_size;
+	const int channel_size = parallel->channel_size;
+	int c;
+	const int gidx = k / group_size;
+	float* ap = a->data.f32;
+	float* gp = g->data.f32 + k;
+	// kernel weight for one dim.
+	float* wp = w->data.f32 + k * w->info.dim[1] * w->info.dim[2] * w->info.dim[3];
+	float biasval = 0;
+	int i[CCV_NNC_MAX_DIM];
+	int n[CCV_NNC_MAX_DIM];
+	int m[CCV_NNC_MAX_DIM];
+	int j[CCV_NNC_MAX_DIM];
+	for (i[0] = 0; i[0] < gdim[0]; i[0]++)
+	{
+		SET_BORDER_OFFSET_SIZE_FOR(0, i, hint, w->info.dim + 1, adim, n, m);
+		float* wpu = wp + n[0] * w->info.dim[CCV_NNC_MAX_DIM] * channel_size;
+		for (i[1] = 0; i[1] < gdim[1]; i[1]++)
 		{
-			SET_BORDER_OFFSET_SIZE_FOR(0, i, hint, w->info.dim + 1, adim, n, m);
-			float* wpu = wp + n[0] * w->info.dim[CCV_NNC_MAX_DIM] * channel_size;
-			for (i[1] = 0; i[1] < bdim[1]; i[1]++)
+			SET_BORDER_OFFSET_SIZE_FOR(1, i, hint, w->info.dim + 1, adim, n, m);
+			const float v = gp[i[1] * gdim[CCV_NNC_MAX_DIM]];
+			if (v == 0) // shortcut if v is zero
+				continue;
+			biasval += v;
+			float* wpz = wpu + n[1] * channel_size;
+			float* apz = ap + ccv_max(i[1] * hint.stride.dim[1] - hint.border.begin[1], 0) * ainc[CCV_NNC_MAX_DIM] + gidx * channel_size;
+			for (j[0] = 0; j[0] < m[0]; j[0]++)
 			{
-				SET_BORDER_OFFSET_SIZE_FOR(1, i, hint, w->info.dim + 1, adim, n, m);
-				float p = biasval;
-				float* wpz = wpu + n[1] * channel_size;
-				float* apz = ap + ccv_max(i[1] * hint.stride.dim[1] - hint.border.begin[1], 0) * ainc[CCV_NNC_MAX_DIM] + gidx * channel_size;
-				for (j[0] = 0; j[0] < m[0]; j[0]++)
-				{
-					for (j[1] = 0; j[1] < m[1]; j[1]++)
-						for (c = 0; c < channel_size; c++)
-							p += wpz[j[1] * channel_size + c] * apz[j[1] * ainc[CCV_NNC_MAX_DIM] + c];
-					wpz += w->info.dim[CCV_NNC_MAX_DIM] * channel_size;
-					apz += ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM];
-				}
-				bp[i[1] * binc[CCV_NNC_MAX_DIM]] = p;
+				for (j[1] = 0; j[1] < m[1]; j[1]++)
+					for (c = 0; c < channel_size; c++)
+						wpz[j[1] * channel_size + c] += v * apz[j[1] * ainc[CCV_NNC_MAX_DIM] + c];
+				wpz += w->info.dim[CCV_NNC_MAX_DIM] * channel_size;
+				apz += ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM];
 			}
-			bp += binc[CCV_NNC_MAX_DIM - 1] * binc[CCV_NNC_MAX_DIM];
-			ap += ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM] * (ccv_max((i[0] + 1) * hint.stride.dim[0] - hint.border.begin[0], 0) - ccv_max(i[0] * hint.stride.dim[0] - hint.border.begin[0], 0));
 		}
-	} parallel_endfor
-	return CCV_NNC_EXEC_SUCCESS;
+		gp += ginc[CCV_NNC_MAX_DIM - 1] * ginc[CCV_NNC_MAX_DIM];
+		ap += ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM] * (ccv_max((i[0] + 1) * hint.stride.dim[0] - hint.border.begin[0], 0) - ccv_max(i[0] * hint.stride.dim[0] - hint.border.begin[0], 0));
+	}
+	if (bias)
+		bias->data.f32[k] = biasval;
 }
 
 static int _ccv_nnc_conv_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
@@ -116,46 +209,20 @@ static int _ccv_nnc_conv_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 	assert(cmd.info.convolution.count % groups == 0);
 	const int group_size = cmd.info.convolution.count / groups;
 	const int channel_size = w->info.dim[CCV_NNC_MAX_DIM + 1];
-	parallel_for(k, cmd.info.convolution.count) {
-		int c;
-		const int gidx = k / group_size;
-		float* ap = a->data.f32;
-		float* gp = g->data.f32 + k;
-		// kernel weight for one dim.
-		float* wp = w->data.f32 + k * w->info.dim[1] * w->info.dim[2] * w->info.dim[3];
-		float biasval = 0;
-		int i[CCV_NNC_MAX_DIM];
-		int n[CCV_NNC_MAX_DIM];
-		int m[CCV_NNC_MAX_DIM];
-		int j[CCV_NNC_MAX_DIM];
-		for (i[0] = 0; i[0] < gdim[0]; i[0]++)
-		{
-			SET_BORDER_OFFSET_SIZE_FOR(0, i, hint, w->info.dim + 1, adim, n, m);
-			float* wpu = wp + n[0] * w->info.dim[CCV_NNC_MAX_DIM] * channel_size;
-			for (i[1] = 0; i[1] < gdim[1]; i[1]++)
-			{
-				SET_BORDER_OFFSET_SIZE_FOR(1, i, hint, w->info.dim + 1, adim, n, m);
-				const float v = gp[i[1] * gdim[CCV_NNC_MAX_DIM]];
-				if (v == 0) // shortcut if v is zero
-					continue;
-				biasval += v;
-				float* wpz = wpu + n[1] * channel_size;
-				float* apz = ap + ccv_max(i[1] * hint.stride.dim[1] - hint.border.begin[1], 0) * ainc[CCV_NNC_MAX_DIM] + gidx * channel_size;
-				for (j[0] = 0; j[0] < m[0]; j[0]++)
-				{
-					for (j[1] = 0; j[1] < m[1]; j[1]++)
-						for (c = 0; c < channel_size; c++)
-							wpz[j[1] * channel_size + c] += v * apz[j[1] * ainc[CCV_NNC_MAX_DIM] + c];
-					wpz += w->info.dim[CCV_NNC_MAX_DIM] * channel_size;
-					apz += ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM];
-				}
-			}
-			gp += ginc[CCV_NNC_MAX_DIM - 1] * ginc[CCV_NNC_MAX_DIM];
-			ap += ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM] * (ccv_max((i[0] + 1) * hint.stride.dim[0] - hint.border.begin[0], 0) - ccv_max(i[0] * hint.stride.dim[0] - hint.border.begin[0], 0));
-		}
-		if (bias)
-			bias->data.f32[k] = biasval;
-	} parallel_endfor
+	ccv_nnc_conv_parallel_t parallel = {
+		.a = a,
+		.g = g,
+		.w = w,
+		.bias = bias,
+		.adim = adim,
+		.gdim = gdim,
+		.ainc = ainc,
+		.ginc = ginc,
+		.hint = hint,
+		.group_size = group_size,
+		.channel_size = channel_size,
+	};
+	ccv_nnc_parallel_for(cmd.info.convolution.count, 0, _ccv_nnc_conv_back_parallel, &parallel);
 	// If h is available, therefore, we need to propagate the gradients back
 	if (h)
 	{
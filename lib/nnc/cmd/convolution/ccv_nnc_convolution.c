@@ -10,6 +10,9 @@ static int _ccv_nnc_conv_forw_bitmask(const int input_size, const int output_siz
 	// Ignore bias.
 	if (input_size == 2 && (input_bitmasks[0] & 3u) == ((1u << 0) | (1u << 1)) && output_bitmasks[0] == 1u)
 		return 1;
+	// Quantized input and weights, followed by the activation scale and the weight scales. Bias is optional.
+	if (input_size == 5 && (input_bitmasks[0] & 27u) == ((1u << 0) | (1u << 1) | (1u << 3) | (1u << 4)) && output_bitmasks[0] == 1u)
+		return 1;
 	return 0;
 }
 
@@ -35,7 +38,8 @@ static void _ccv_nnc_conv_tensor_auto_forw(const ccv_nnc_cmd_param_t cmd, const
 	assert(output_size == 1);
 	outputs[0].type = inputs[0].type;
 	outputs[0].format = inputs[0].format;
-	outputs[0].datatype = inputs[0].datatype;
+	// Quantized convolution dequantizes its output.
+	outputs[0].datatype = inputs[0].datatype == CCV_8S ? CCV_32F : inputs[0].datatype;
 	// Get the channel output from the weight matrix.
 	const int count = ccv_nnc_tensor_get_n(inputs[1]);
 	assert(count == cmd.convolution.count);
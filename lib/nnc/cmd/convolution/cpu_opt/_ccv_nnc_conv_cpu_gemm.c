@@ -4,6 +4,11 @@
 #include "nnc/ccv_nnc_easy.h"
 #include "nnc/ccv_nnc_internal.h"
 #include "../_ccv_nnc_conv_cpu_opt.h"
+#if HAVE_ACCELERATE_FRAMEWORK
+#include <Accelerate/Accelerate.h>
+#elif HAVE_CBLAS
+#include <cblas.h>
+#endif
 
 int _ccv_nnc_conv_forw_gemm_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b)
 {
@@ -37,3 +42,157 @@ int _ccv_nnc_conv_forw_gemm_cpu_opt(const ccv_nnc_tensor_view_t* const a, const
 		ccv_gemm(&am, &wm, 1, 0, 0, CCV_B_TRANSPOSE, (ccv_matrix_t**)&dbm, 0); // supply b as matrix C is allowed
 	return CCV_NNC_EXEC_SUCCESS;
 }
+
+#if (defined HAVE_CBLAS || defined HAVE_ACCELERATE_FRAMEWORK)
+typedef struct {
+	const ccv_nnc_tensor_view_t* a;
+	const int* adim;
+	const int* ainc;
+	const int* wdim;
+	ccv_nnc_hint_t hint;
+	int y;
+	int cols;
+	float* col;
+} ccv_nnc_conv_im2col_parallel_t;
+
+static void _ccv_nnc_conv_im2col_parallel(void* const context, const int i)
+{
+	const ccv_nnc_conv_im2col_parallel_t* const parallel = (ccv_nnc_conv_im2col_parallel_t*)context;
+	const int* const adim = parallel->adim;
+	const int* const ainc = parallel->ainc;
+	const int* const wdim = parallel->wdim;
+	const ccv_nnc_hint_t hint = parallel->hint;
+	const int channel_size = adim[CCV_NNC_MAX_DIM];
+	const int oy = parallel->y + i / parallel->cols;
+	const int ox = i % parallel->cols;
+	float* colp = parallel->col + i * wdim[1] * wdim[2] * channel_size;
+	int x, y;
+	for (y = 0; y < wdim[1]; y++)
+	{
+		const int iy = oy * hint.stride.dim[0] - hint.border.begin[0] + y;
+		if (iy < 0 || iy >= adim[0])
+		{
+			memset(colp, 0, sizeof(float) * wdim[2] * channel_size);
+			colp += wdim[2] * channel_size;
+			continue;
+		}
+		const float* const ap = parallel->a->data.f32 + iy * ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM];
+		for (x = 0; x < wdim[2]; x++)
+		{
+			const int ix = ox * hint.stride.dim[1] - hint.border.begin[1] + x;
+			if (ix < 0 || ix >= adim[1])
+				memset(colp, 0, sizeof(float) * channel_size);
+			else
+				memcpy(colp, ap + ix * ainc[CCV_NNC_MAX_DIM], sizeof(float) * channel_size);
+			colp += channel_size;
+		}
+	}
+}
+#endif
+
+int _ccv_nnc_conv_back_gemm_cpu_opt(const ccv_nnc_tensor_view_t* const g, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, ccv_nnc_tensor_t* const dw, ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const h, const int flags, ccv_nnc_stream_context_t* const stream_context)
+{
+#if (defined HAVE_CBLAS || defined HAVE_ACCELERATE_FRAMEWORK)
+	assert(!CCV_IS_TENSOR_VIEW(dw));
+	assert(!bias || !CCV_IS_TENSOR_VIEW(bias));
+	assert(!h || (w && !CCV_IS_TENSOR_VIEW(w)));
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int g_nd = ccv_nnc_tensor_nd(g->info.dim);
+	assert(g_nd == CCV_NNC_MAX_DIM + 1 || g_nd == CCV_NNC_MAX_DIM + 2);
+	const int* gdim = (g_nd == CCV_NNC_MAX_DIM + 1) ? g->info.dim : g->info.dim + 1;
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == CCV_NNC_MAX_DIM + 1) ? a->inc : a->inc + 1) : adim;
+	const int* ginc = CCV_IS_TENSOR_VIEW(g) ? ((g_nd == CCV_NNC_MAX_DIM + 1) ? g->inc : g->inc + 1) : gdim;
+	const int* const wdim = dw->info.dim;
+	assert(wdim[CCV_NNC_MAX_DIM + 1] == adim[CCV_NNC_MAX_DIM]);
+	assert(wdim[0] == gdim[CCV_NNC_MAX_DIM]);
+	const int count = wdim[0];
+	const int cols = wdim[1] * wdim[2] * wdim[3];
+	if (!(flags & CCV_NNC_ACCUMULATE_OUTPUT)) // reset the gradients to 0
+	{
+		memset(dw->data.u8, 0, sizeof(float) * ccv_nnc_tensor_count(dw->info));
+		if (bias)
+			memset(bias->data.u8, 0, sizeof(float) * ccv_nnc_tensor_count(bias->info));
+	}
+	int i, j, k;
+	if (bias)
+		for (i = 0; i < gdim[0]; i++)
+			for (j = 0; j < gdim[1]; j++)
+			{
+				const float* const gp = g->data.f32 + (i * ginc[CCV_NNC_MAX_DIM - 1] + j) * ginc[CCV_NNC_MAX_DIM];
+				for (k = 0; k < count; k++)
+					bias->data.f32[k] += gp[k];
+			}
+	const int* hinc = 0;
+	if (h)
+	{
+		const int h_nd = ccv_nnc_tensor_nd(h->info.dim);
+		assert(h_nd == CCV_NNC_MAX_DIM + 1 || h_nd == CCV_NNC_MAX_DIM + 2);
+		const int* hdim = (h_nd == CCV_NNC_MAX_DIM + 1) ? h->info.dim : h->info.dim + 1;
+		hinc = CCV_IS_TENSOR_VIEW(h) ? ((h_nd == CCV_NNC_MAX_DIM + 1) ? h->inc : h->inc + 1) : hdim;
+		assert(hdim[0] == adim[0] && hdim[1] == adim[1] && hdim[2] == adim[2]);
+		ccv_nnc_tensor_zero(h);
+	}
+	// Unfold a block of output rows at a time, so the column buffer stays bounded. If g's rows are not
+	// contiguous (a tensor view with narrower width), only one row can be addressed as a matrix.
+	const int block_rows = ginc[CCV_NNC_MAX_DIM - 1] == gdim[1] ? ccv_min(ccv_max((1 << 20) / (gdim[1] * cols), 1), gdim[0]) : 1;
+	float* const col = (float*)ccv_nnc_stream_context_get_workspace(stream_context, sizeof(float) * block_rows * gdim[1] * cols, CCV_TENSOR_CPU_MEMORY);
+	if (!col)
+		return CCV_NNC_EXEC_OOM;
+	ccv_nnc_conv_im2col_parallel_t parallel = {
+		.a = a,
+		.adim = adim,
+		.ainc = ainc,
+		.wdim = wdim,
+		.hint = hint,
+		.cols = gdim[1],
+		.col = col,
+	};
+	int y;
+	for (y = 0; y < gdim[0]; y += block_rows)
+	{
+		const int rows = ccv_min(block_rows, gdim[0] - y) * gdim[1];
+		const float* const gp = g->data.f32 + y * ginc[CCV_NNC_MAX_DIM - 1] * ginc[CCV_NNC_MAX_DIM];
+		parallel.y = y;
+		ccv_nnc_parallel_for(rows, 0, _ccv_nnc_conv_im2col_parallel, &parallel);
+		// dw += g^T * col
+		cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans, count, cols, rows, 1.0, gp, ginc[CCV_NNC_MAX_DIM], col, cols, 1.0, dw->data.f32, cols);
+		if (!h)
+			continue;
+		// col = g * w, then fold the columns back into h.
+		cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, rows, cols, count, 1.0, gp, ginc[CCV_NNC_MAX_DIM], w->data.f32, cols, 0.0, col, cols);
+		for (i = 0; i < rows; i++)
+		{
+			const int oy = y + i / gdim[1];
+			const int ox = i % gdim[1];
+			const float* colp = col + i * cols;
+			for (j = 0; j < wdim[1]; j++)
+			{
+				const int iy = oy * hint.stride.dim[0] - hint.border.begin[0] + j;
+				if (iy < 0 || iy >= adim[0])
+				{
+					colp += wdim[2] * wdim[3];
+					continue;
+				}
+				float* const hp = h->data.f32 + iy * hinc[CCV_NNC_MAX_DIM - 1] * hinc[CCV_NNC_MAX_DIM];
+				for (k = 0; k < wdim[2]; k++)
+				{
+					const int ix = ox * hint.stride.dim[1] - hint.border.begin[1] + k;
+					if (ix >= 0 && ix < adim[1])
+					{
+						float* const hpz = hp + ix * hinc[CCV_NNC_MAX_DIM];
+						int c;
+						for (c = 0; c < wdim[3]; c++)
+							hpz[c] += colp[c];
+					}
+					colp += wdim[3];
+				}
+			}
+		}
+	}
+	return CCV_NNC_EXEC_SUCCESS;
+#else
+	return CCV_NNC_EXEC_INVALID;
+#endif
+}
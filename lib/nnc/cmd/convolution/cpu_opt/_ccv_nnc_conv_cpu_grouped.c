@@ -0,0 +1,204 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#elif defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+#include "../_ccv_nnc_conv_cpu_opt.h"
+
+typedef struct {
+	const ccv_nnc_tensor_view_t* a;
+	const ccv_nnc_tensor_t* bias;
+	ccv_nnc_hint_t hint;
+	ccv_nnc_tensor_view_t* b;
+	const int* adim;
+	const int* bdim;
+	const int* ainc;
+	const int* binc;
+	const int* wdim;
+	int groups;
+	const float* pw; // Packed weights, with the output channels of a group innermost.
+} ccv_nnc_conv_grouped_parallel_t;
+
+static void _ccv_nnc_conv_forw_depthwise_parallel(void* const context, const int y)
+{
+	const ccv_nnc_conv_grouped_parallel_t* const parallel = (ccv_nnc_conv_grouped_parallel_t*)context;
+	const ccv_nnc_hint_t hint = parallel->hint;
+	const int* const adim = parallel->adim;
+	const int* const bdim = parallel->bdim;
+	const int* const ainc = parallel->ainc;
+	const int* const binc = parallel->binc;
+	const int* const wdim = parallel->wdim;
+	const int channel_size = adim[CCV_NNC_MAX_DIM];
+	const float* const biasp = parallel->bias ? parallel->bias->data.f32 : 0;
+	const int iy = y * hint.stride.dim[0] - hint.border.begin[0];
+	const int ky0 = ccv_max(-iy, 0);
+	const int ky1 = ccv_min(wdim[1], adim[0] - iy);
+	float* const bp = parallel->b->data.f32 + y * binc[CCV_NNC_MAX_DIM - 1] * binc[CCV_NNC_MAX_DIM];
+	int x, j, k, c;
+	for (x = 0; x < bdim[1]; x++)
+	{
+		const int ix = x * hint.stride.dim[1] - hint.border.begin[1];
+		const int kx0 = ccv_max(-ix, 0);
+		const int kx1 = ccv_min(wdim[2], adim[1] - ix);
+		float* const bpz = bp + x * binc[CCV_NNC_MAX_DIM];
+		c = 0;
+#if defined(HAVE_SSE2)
+		for (; c < channel_size - 3; c += 4)
+		{
+			__m128 v4 = biasp ? _mm_loadu_ps(biasp + c) : _mm_setzero_ps();
+			for (j = ky0; j < ky1; j++)
+			{
+				const float* const apz = parallel->a->data.f32 + ((iy + j) * ainc[CCV_NNC_MAX_DIM - 1] + ix) * ainc[CCV_NNC_MAX_DIM] + c;
+				const float* const wpz = parallel->pw + j * wdim[2] * channel_size + c;
+				for (k = kx0; k < kx1; k++)
+					v4 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(apz + k * ainc[CCV_NNC_MAX_DIM]), _mm_loadu_ps(wpz + k * channel_size)), v4);
+			}
+			_mm_storeu_ps(bpz + c, v4);
+		}
+#elif defined(HAVE_NEON)
+		for (; c < channel_size - 3; c += 4)
+		{
+			float32x4_t v4 = biasp ? vld1q_f32(biasp + c) : vdupq_n_f32(0);
+			for (j = ky0; j < ky1; j++)
+			{
+				const float* const apz = parallel->a->data.f32 + ((iy + j) * ainc[CCV_NNC_MAX_DIM - 1] + ix) * ainc[CCV_NNC_MAX_DIM] + c;
+				const float* const wpz = parallel->pw + j * wdim[2] * channel_size + c;
+				for (k = kx0; k < kx1; k++)
+					v4 = vmlaq_f32(v4, vld1q_f32(apz + k * ainc[CCV_NNC_MAX_DIM]), vld1q_f32(wpz + k * channel_size));
+			}
+			vst1q_f32(bpz + c, v4);
+		}
+#endif
+		for (; c < channel_size; c++)
+		{
+			float v = biasp ? biasp[c] : 0;
+			for (j = ky0; j < ky1; j++)
+			{
+				const float* const apz = parallel->a->data.f32 + ((iy + j) * ainc[CCV_NNC_MAX_DIM - 1] + ix) * ainc[CCV_NNC_MAX_DIM] + c;
+				const float* const wpz = parallel->pw + j * wdim[2] * channel_size + c;
+				for (k = kx0; k < kx1; k++)
+					v += apz[k * ainc[CCV_NNC_MAX_DIM]] * wpz[k * channel_size];
+			}
+			bpz[c] = v;
+		}
+	}
+}
+
+static void _ccv_nnc_conv_forw_grouped_parallel(void* const context, const int y)
+{
+	const ccv_nnc_conv_grouped_parallel_t* const parallel = (ccv_nnc_conv_grouped_parallel_t*)context;
+	const ccv_nnc_hint_t hint = parallel->hint;
+	const int* const adim = parallel->adim;
+	const int* const bdim = parallel->bdim;
+	const int* const ainc = parallel->ainc;
+	const int* const binc = parallel->binc;
+	const int* const wdim = parallel->wdim;
+	const int groups = parallel->groups;
+	const int channel_size = wdim[CCV_NNC_MAX_DIM + 1];
+	const int group_size = wdim[0] / groups;
+	const float* const biasp = parallel->bias ? parallel->bias->data.f32 : 0;
+	const int iy = y * hint.stride.dim[0] - hint.border.begin[0];
+	const int ky0 = ccv_max(-iy, 0);
+	const int ky1 = ccv_min(wdim[1], adim[0] - iy);
+	float* const bp = parallel->b->data.f32 + y * binc[CCV_NNC_MAX_DIM - 1] * binc[CCV_NNC_MAX_DIM];
+	int x, g, j, k, c, q;
+	for (x = 0; x < bdim[1]; x++)
+	{
+		const int ix = x * hint.stride.dim[1] - hint.border.begin[1];
+		const int kx0 = ccv_max(-ix, 0);
+		const int kx1 = ccv_min(wdim[2], adim[1] - ix);
+		float* const bpz = bp + x * binc[CCV_NNC_MAX_DIM];
+		if (biasp)
+			memcpy(bpz, biasp, sizeof(float) * wdim[0]);
+		else
+			memset(bpz, 0, sizeof(float) * wdim[0]);
+		for (g = 0; g < groups; g++)
+		{
+			float* const bpg = bpz + g * group_size;
+			for (j = ky0; j < ky1; j++)
+				for (k = kx0; k < kx1; k++)
+				{
+					const float* const apz = parallel->a->data.f32 + ((iy + j) * ainc[CCV_NNC_MAX_DIM - 1] + ix + k) * ainc[CCV_NNC_MAX_DIM] + g * channel_size;
+					const float* wpz = parallel->pw + (((g * wdim[1] + j) * wdim[2] + k) * channel_size) * group_size;
+					// Accumulate the outer product of the input channels and the output channels of this group.
+					for (c = 0; c < channel_size; c++, wpz += group_size)
+					{
+						const float av = apz[c];
+						q = 0;
+#if defined(HAVE_SSE2)
+						const __m128 av4 = _mm_set1_ps(av);
+						for (; q < group_size - 3; q += 4)
+							_mm_storeu_ps(bpg + q, _mm_add_ps(_mm_mul_ps(av4, _mm_loadu_ps(wpz + q)), _mm_loadu_ps(bpg + q)));
+#elif defined(HAVE_NEON)
+						const float32x4_t av4 = vdupq_n_f32(av);
+						for (; q < group_size - 3; q += 4)
+							vst1q_f32(bpg + q, vmlaq_f32(vld1q_f32(bpg + q), av4, vld1q_f32(wpz + q)));
+#endif
+						for (; q < group_size; q++)
+							bpg[q] += av * wpz[q];
+					}
+				}
+		}
+	}
+}
+
+int _ccv_nnc_conv_forw_grouped_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const int groups, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, ccv_nnc_stream_context_t* const stream_context)
+{
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	assert(b_nd == CCV_NNC_MAX_DIM + 1 || b_nd == CCV_NNC_MAX_DIM + 2);
+	const int* bdim = (b_nd == CCV_NNC_MAX_DIM + 1) ? b->info.dim : b->info.dim + 1;
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == CCV_NNC_MAX_DIM + 1) ? a->inc : a->inc + 1) : adim;
+	const int* binc = CCV_IS_TENSOR_VIEW(b) ? ((b_nd == CCV_NNC_MAX_DIM + 1) ? b->inc : b->inc + 1) : bdim;
+	const int* const wdim = w->info.dim;
+	assert(wdim[CCV_NNC_MAX_DIM + 1] * groups == adim[CCV_NNC_MAX_DIM]);
+	assert(wdim[0] % groups == 0);
+	assert(wdim[0] == bdim[CCV_NNC_MAX_DIM]);
+	const int channel_size = wdim[CCV_NNC_MAX_DIM + 1];
+	const int group_size = wdim[0] / groups;
+	const int window_size = wdim[1] * wdim[2];
+	float* const pw = (float*)ccv_nnc_stream_context_get_workspace(stream_context, sizeof(float) * wdim[0] * window_size * channel_size, CCV_TENSOR_CPU_MEMORY);
+	if (!pw)
+		return CCV_NNC_EXEC_OOM;
+	// Reorder the weights into [groups][h][w][channels][group_size], so the innermost loop runs over the outputs.
+	// For depthwise convolution this is simply [h][w][channels].
+	int g, i, c, k;
+	if (channel_size == 1 && group_size == 1)
+		for (i = 0; i < window_size; i++)
+			for (g = 0; g < groups; g++)
+				pw[i * groups + g] = w->data.f32[g * window_size + i];
+	else
+		for (g = 0; g < groups; g++)
+			for (k = 0; k < group_size; k++)
+			{
+				const float* const wp = w->data.f32 + (g * group_size + k) * window_size * channel_size;
+				for (i = 0; i < window_size; i++)
+					for (c = 0; c < channel_size; c++)
+						pw[((g * window_size + i) * channel_size + c) * group_size + k] = wp[i * channel_size + c];
+			}
+	ccv_nnc_conv_grouped_parallel_t parallel = {
+		.a = a,
+		.bias = bias,
+		.hint = hint,
+		.b = b,
+		.adim = adim,
+		.bdim = bdim,
+		.ainc = ainc,
+		.binc = binc,
+		.wdim = wdim,
+		.groups = groups,
+		.pw = pw,
+	};
+	if (channel_size == 1 && group_size == 1)
+		ccv_nnc_parallel_for(bdim[0], 0, _ccv_nnc_conv_forw_depthwise_parallel, &parallel);
+	else
+		ccv_nnc_parallel_for(bdim[0], 0, _ccv_nnc_conv_forw_grouped_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
@@ -0,0 +1,422 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#elif defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+#include "../_ccv_nnc_conv_cpu_opt.h"
+
+// Transform matrices for F(m x m, r x r), interpolated at 0, 1, -1, 2, -2, 1/2, -1/2 (as many as needed) and infinity.
+// Tile size alpha = m + r - 1, BT is alpha x alpha, G is alpha x r and AT is m x alpha, all row-major.
+
+static const float _ccv_nnc_winograd_2x2_3x3_bt[] = {
+	-1, 0, 1, 0,
+	0, 1, 1, 0,
+	0, -1, 1, 0,
+	0, -1, 0, 1,
+};
+static const float _ccv_nnc_winograd_2x2_3x3_g[] = {
+	-1, 0, 0,
+	0.5, 0.5, 0.5,
+	0.5, -0.5, 0.5,
+	0, 0, 1,
+};
+static const float _ccv_nnc_winograd_2x2_3x3_at[] = {
+	1, 1, 1, 0,
+	0, 1, -1, 1,
+};
+
+static const float _ccv_nnc_winograd_6x6_3x3_bt[] = {
+	-1, 0, 5.25, 0, -5.25, 0, 1, 0,
+	0, 1, 1, -4.25, -4.25, 1, 1, 0,
+	0, -1, 1, 4.25, -4.25, -1, 1, 0,
+	0, 0.5, 0.25, -2.5, -1.25, 2, 1, 0,
+	0, -0.5, 0.25, 2.5, -1.25, -2, 1, 0,
+	0, 2, 4, -2.5, -5, 0.5, 1, 0,
+	0, -2, 4, 2.5, -5, -0.5, 1, 0,
+	0, -1, 0, 5.25, 0, -5.25, 0, 1,
+};
+static const float _ccv_nnc_winograd_6x6_3x3_g[] = {
+	-1, 0, 0,
+	-2. / 9, -2. / 9, -2. / 9,
+	-2. / 9, 2. / 9, -2. / 9,
+	1. / 90, 1. / 45, 2. / 45,
+	1. / 90, -1. / 45, 2. / 45,
+	32. / 45, 16. / 45, 8. / 45,
+	32. / 45, -16. / 45, 8. / 45,
+	0, 0, 1,
+};
+static const float _ccv_nnc_winograd_6x6_3x3_at[] = {
+	1, 1, 1, 1, 1, 1, 1, 0,
+	0, 1, -1, 2, -2, 0.5, -0.5, 0,
+	0, 1, 1, 4, 4, 0.25, 0.25, 0,
+	0, 1, -1, 8, -8, 0.125, -0.125, 0,
+	0, 1, 1, 16, 16, 0.0625, 0.0625, 0,
+	0, 1, -1, 32, -32, 0.03125, -0.03125, 1,
+};
+
+// F(4x4, 5x5) shares the 8x8 input transform with F(6x6, 3x3).
+static const float _ccv_nnc_winograd_4x4_5x5_g[] = {
+	-1, 0, 0, 0, 0,
+	-2. / 9, -2. / 9, -2. / 9, -2. / 9, -2. / 9,
+	-2. / 9, 2. / 9, -2. / 9, 2. / 9, -2. / 9,
+	1. / 90, 1. / 45, 2. / 45, 4. / 45, 8. / 45,
+	1. / 90, -1. / 45, 2. / 45, -4. / 45, 8. / 45,
+	32. / 45, 16. / 45, 8. / 45, 4. / 45, 2. / 45,
+	32. / 45, -16. / 45, 8. / 45, -4. / 45, 2. / 45,
+	0, 0, 0, 0, 1,
+};
+static const float _ccv_nnc_winograd_4x4_5x5_at[] = {
+	1, 1, 1, 1, 1, 1, 1, 0,
+	0, 1, -1, 2, -2, 0.5, -0.5, 0,
+	0, 1, 1, 4, 4, 0.25, 0.25, 0,
+	0, 1, -1, 8, -8, 0.125, -0.125, 1,
+};
+
+static const float _ccv_nnc_winograd_4x4_2x2_bt[] = {
+	0.5, -1, -0.5, 1, 0,
+	0, -0.5, 0.5, 1, 0,
+	0, 0.5, -1.5, 1, 0,
+	0, -1, 0, 1, 0,
+	0, 0.5, -1, -0.5, 1,
+};
+static const float _ccv_nnc_winograd_4x4_2x2_g[] = {
+	2, 0,
+	1, 1,
+	-1. / 3, 1. / 3,
+	-8. / 3, -4. / 3,
+	0, 1,
+};
+static const float _ccv_nnc_winograd_4x4_2x2_at[] = {
+	1, 1, 1, 1, 0,
+	0, 1, -1, 0.5, 0,
+	0, 1, 1, 0.25, 0,
+	0, 1, -1, 0.125, 1,
+};
+
+typedef struct {
+	int m; // Output tile size.
+	int r; // Kernel size.
+	const float* bt;
+	const float* g;
+	const float* at;
+} ccv_nnc_winograd_t;
+
+static const ccv_nnc_winograd_t _ccv_nnc_winograd_2x2_3x3 = {
+	.m = 2, .r = 3, .bt = _ccv_nnc_winograd_2x2_3x3_bt, .g = _ccv_nnc_winograd_2x2_3x3_g, .at = _ccv_nnc_winograd_2x2_3x3_at,
+};
+
+static const ccv_nnc_winograd_t _ccv_nnc_winograd_6x6_3x3 = {
+	.m = 6, .r = 3, .bt = _ccv_nnc_winograd_6x6_3x3_bt, .g = _ccv_nnc_winograd_6x6_3x3_g, .at = _ccv_nnc_winograd_6x6_3x3_at,
+};
+
+static const ccv_nnc_winograd_t _ccv_nnc_winograd_4x4_5x5 = {
+	.m = 4, .r = 5, .bt = _ccv_nnc_winograd_6x6_3x3_bt, .g = _ccv_nnc_winograd_4x4_5x5_g, .at = _ccv_nnc_winograd_4x4_5x5_at,
+};
+
+static const ccv_nnc_winograd_t _ccv_nnc_winograd_4x4_2x2 = {
+	.m = 4, .r = 2, .bt = _ccv_nnc_winograd_4x4_2x2_bt, .g = _ccv_nnc_winograd_4x4_2x2_g, .at = _ccv_nnc_winograd_4x4_2x2_at,
+};
+
+typedef struct {
+	const ccv_nnc_winograd_t* wg;
+	const float* a;
+	int adim[3]; // Height, width and channels of the input.
+	int arow; // Stride between input rows.
+	int acol; // Stride between input pixels.
+	int border[2]; // Zero padding at the top and the left.
+	const float* w; // The kernel, in [count][r][r][channels].
+	const float* bias;
+	float* b;
+	int bdim[3]; // Height, width and channels (count) of the output.
+	int brow;
+	int bcol;
+	int tile_dim[2];
+	int jobs;
+	float* u; // The transformed kernel, in [alpha * alpha][channels][count].
+	float* workmem;
+	int job_size;
+} ccv_nnc_winograd_parallel_t;
+
+// y[0:n] += s * x[0:n], this is what all transforms and the element-wise multiply boil down to.
+static inline void _ccv_nnc_winograd_axpy(float* const y, const float s, const float* const x, const int n)
+{
+	int i = 0;
+#if defined(HAVE_SSE2)
+	const __m128 s4 = _mm_set1_ps(s);
+	for (; i < n - 3; i += 4)
+		_mm_storeu_ps(y + i, _mm_add_ps(_mm_mul_ps(s4, _mm_loadu_ps(x + i)), _mm_loadu_ps(y + i)));
+#elif defined(HAVE_NEON)
+	const float32x4_t s4 = vdupq_n_f32(s);
+	for (; i < n - 3; i += 4)
+		vst1q_f32(y + i, vmlaq_f32(vld1q_f32(y + i), s4, vld1q_f32(x + i)));
+#endif
+	for (; i < n; i++)
+		y[i] += s * x[i];
+}
+
+static void _ccv_nnc_winograd_gwtg_parallel(void* const context, const int k)
+{
+	const ccv_nnc_winograd_parallel_t* const parallel = (ccv_nnc_winograd_parallel_t*)context;
+	const ccv_nnc_winograd_t* const wg = parallel->wg;
+	const int r = wg->r;
+	const int alpha = wg->m + r - 1;
+	const int channel_size = parallel->adim[2];
+	const int count = parallel->bdim[2];
+	const float* const gp = wg->g;
+	int i, j, x, y, c;
+	for (c = 0; c < channel_size; c++)
+	{
+		const float* const wp = parallel->w + k * r * r * channel_size + c;
+		float gw[8 * 5];
+		// gw = G * w, then U = gw * G^T.
+		for (i = 0; i < alpha; i++)
+			for (x = 0; x < r; x++)
+			{
+				float v = 0;
+				for (y = 0; y < r; y++)
+					v += gp[i * r + y] * wp[(y * r + x) * channel_size];
+				gw[i * r + x] = v;
+			}
+		for (i = 0; i < alpha; i++)
+			for (j = 0; j < alpha; j++)
+			{
+				float v = 0;
+				for (x = 0; x < r; x++)
+					v += gw[i * r + x] * gp[j * r + x];
+				parallel->u[((i * alpha + j) * channel_size + c) * count + k] = v;
+			}
+	}
+}
+
+static void _ccv_nnc_winograd_tile_row_parallel(void* const context, const int job)
+{
+	const ccv_nnc_winograd_parallel_t* const parallel = (ccv_nnc_winograd_parallel_t*)context;
+	const ccv_nnc_winograd_t* const wg = parallel->wg;
+	const int m = wg->m;
+	const int alpha = m + wg->r - 1;
+	const int alpha2 = alpha * alpha;
+	const int* const adim = parallel->adim;
+	const int* const bdim = parallel->bdim;
+	const int channel_size = adim[2];
+	const int count = bdim[2];
+	const int tile_w = parallel->tile_dim[1];
+	const int vec_size = ccv_max(channel_size, count);
+	float* const v = parallel->workmem + job * parallel->job_size; // [alpha * alpha][tile_w][channels]
+	float* const mm = v + alpha2 * tile_w * channel_size; // [alpha * alpha][tile_w][count]
+	float* const d = mm + alpha2 * tile_w * count;
+	float* const t = d + alpha2 * vec_size;
+	const float* const bt = wg->bt;
+	const float* const at = wg->at;
+	int i, j, l, p, c, tx, ty;
+	for (ty = job; ty < parallel->tile_dim[0]; ty += parallel->jobs)
+	{
+		const int iy = ty * m - parallel->border[0];
+		// Input transform, V = BT * d * B, with channels innermost.
+		for (tx = 0; tx < tile_w; tx++)
+		{
+			const int ix = tx * m - parallel->border[1];
+			for (i = 0; i < alpha; i++)
+				for (j = 0; j < alpha; j++)
+					if (iy + i >= 0 && iy + i < adim[0] && ix + j >= 0 && ix + j < adim[1])
+						memcpy(d + (i * alpha + j) * channel_size, parallel->a + (iy + i) * parallel->arow + (ix + j) * parallel->acol, sizeof(float) * channel_size);
+					else
+						memset(d + (i * alpha + j) * channel_size, 0, sizeof(float) * channel_size);
+			memset(t, 0, sizeof(float) * alpha2 * channel_size);
+			for (i = 0; i < alpha; i++)
+				for (l = 0; l < alpha; l++)
+					if (bt[i * alpha + l] != 0)
+						for (j = 0; j < alpha; j++)
+							_ccv_nnc_winograd_axpy(t + (i * alpha + j) * channel_size, bt[i * alpha + l], d + (l * alpha + j) * channel_size, channel_size);
+			for (i = 0; i < alpha; i++)
+				for (j = 0; j < alpha; j++)
+				{
+					float* const vp = v + ((i * alpha + j) * tile_w + tx) * channel_size;
+					memset(vp, 0, sizeof(float) * channel_size);
+					for (l = 0; l < alpha; l++)
+						if (bt[j * alpha + l] != 0)
+							_ccv_nnc_winograd_axpy(vp, bt[j * alpha + l], t + (i * alpha + l) * channel_size, channel_size);
+				}
+		}
+		// Element-wise multiply in the transformed domain, which is a small GEMM per position.
+		memset(mm, 0, sizeof(float) * alpha2 * tile_w * count);
+		for (p = 0; p < alpha2; p++)
+			for (tx = 0; tx < tile_w; tx++)
+			{
+				const float* const vp = v + (p * tile_w + tx) * channel_size;
+				const float* const up = parallel->u + p * channel_size * count;
+				float* const mp = mm + (p * tile_w + tx) * count;
+				for (c = 0; c < channel_size; c++)
+					_ccv_nnc_winograd_axpy(mp, vp[c], up + c * count, count);
+			}
+		// Output transform, Y = AT * M * A, and store the part inside the output.
+		for (tx = 0; tx < tile_w; tx++)
+		{
+			memset(t, 0, sizeof(float) * m * alpha * count);
+			for (i = 0; i < m; i++)
+				for (l = 0; l < alpha; l++)
+					if (at[i * alpha + l] != 0)
+						for (j = 0; j < alpha; j++)
+							_ccv_nnc_winograd_axpy(t + (i * alpha + j) * count, at[i * alpha + l], mm + ((l * alpha + j) * tile_w + tx) * count, count);
+			for (i = 0; i < m && ty * m + i < bdim[0]; i++)
+				for (j = 0; j < m && tx * m + j < bdim[1]; j++)
+				{
+					float* const bp = parallel->b + (ty * m + i) * parallel->brow + (tx * m + j) * parallel->bcol;
+					if (parallel->bias)
+						memcpy(bp, parallel->bias, sizeof(float) * count);
+					else
+						memset(bp, 0, sizeof(float) * count);
+					for (l = 0; l < alpha; l++)
+						if (at[j * alpha + l] != 0)
+							_ccv_nnc_winograd_axpy(bp, at[j * alpha + l], t + (i * alpha + l) * count, count);
+				}
+		}
+	}
+}
+
+static size_t _ccv_nnc_winograd_workmem_size(const ccv_nnc_winograd_t* const wg, ccv_nnc_winograd_parallel_t* const parallel)
+{
+	const int m = wg->m;
+	const int alpha = m + wg->r - 1;
+	const int alpha2 = alpha * alpha;
+	const int channel_size = parallel->adim[2];
+	const int count = parallel->bdim[2];
+	parallel->tile_dim[0] = (parallel->bdim[0] + m - 1) / m;
+	parallel->tile_dim[1] = (parallel->bdim[1] + m - 1) / m;
+	parallel->jobs = ccv_max(1, ccv_min(parallel->tile_dim[0], ccv_nnc_thread_pool_size()));
+	parallel->job_size = alpha2 * (parallel->tile_dim[1] * (channel_size + count) + 2 * ccv_max(channel_size, count));
+	return (size_t)alpha2 * channel_size * count + (size_t)parallel->jobs * parallel->job_size;
+}
+
+static void _ccv_nnc_winograd_forw(const ccv_nnc_winograd_t* const wg, ccv_nnc_winograd_parallel_t* const parallel, float* const workmem)
+{
+	const int alpha = wg->m + wg->r - 1;
+	parallel->wg = wg;
+	parallel->u = workmem;
+	parallel->workmem = workmem + alpha * alpha * parallel->adim[2] * parallel->bdim[2];
+	ccv_nnc_parallel_for(parallel->bdim[2], 0, _ccv_nnc_winograd_gwtg_parallel, parallel);
+	ccv_nnc_parallel_for(parallel->jobs, 0, _ccv_nnc_winograd_tile_row_parallel, parallel);
+}
+
+int _ccv_nnc_conv_forw_winograd_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const int m, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, ccv_nnc_stream_context_t* const stream_context)
+{
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	assert(b_nd == CCV_NNC_MAX_DIM + 1 || b_nd == CCV_NNC_MAX_DIM + 2);
+	const int* bdim = (b_nd == CCV_NNC_MAX_DIM + 1) ? b->info.dim : b->info.dim + 1;
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == CCV_NNC_MAX_DIM + 1) ? a->inc : a->inc + 1) : adim;
+	const int* binc = CCV_IS_TENSOR_VIEW(b) ? ((b_nd == CCV_NNC_MAX_DIM + 1) ? b->inc : b->inc + 1) : bdim;
+	assert(w->info.dim[1] == w->info.dim[2]);
+	const ccv_nnc_winograd_t* wg;
+	if (m == 2 && w->info.dim[1] == 3)
+		wg = &_ccv_nnc_winograd_2x2_3x3;
+	else if (m == 6 && w->info.dim[1] == 3)
+		wg = &_ccv_nnc_winograd_6x6_3x3;
+	else if (m == 4 && w->info.dim[1] == 5)
+		wg = &_ccv_nnc_winograd_4x4_5x5;
+	else
+		return CCV_NNC_EXEC_INVALID;
+	ccv_nnc_winograd_parallel_t parallel = {
+		.a = a->data.f32,
+		.adim = { adim[0], adim[1], adim[2] },
+		.arow = ainc[1] * ainc[2],
+		.acol = ainc[2],
+		.border = { hint.border.begin[0], hint.border.begin[1] },
+		.w = w->data.f32,
+		.bias = bias ? bias->data.f32 : 0,
+		.b = b->data.f32,
+		.bdim = { bdim[0], bdim[1], bdim[2] },
+		.brow = binc[1] * binc[2],
+		.bcol = binc[2],
+	};
+	const size_t size = _ccv_nnc_winograd_workmem_size(wg, &parallel);
+	float* const workmem = (float*)ccv_nnc_stream_context_get_workspace(stream_context, sizeof(float) * size, CCV_TENSOR_CPU_MEMORY);
+	if (!workmem)
+		return CCV_NNC_EXEC_OOM;
+	_ccv_nnc_winograd_forw(wg, &parallel, workmem);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+int _ccv_nnc_conv_forw_strided_winograd_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, ccv_nnc_stream_context_t* const stream_context)
+{
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	assert(b_nd == CCV_NNC_MAX_DIM + 1 || b_nd == CCV_NNC_MAX_DIM + 2);
+	const int* bdim = (b_nd == CCV_NNC_MAX_DIM + 1) ? b->info.dim : b->info.dim + 1;
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == CCV_NNC_MAX_DIM + 1) ? a->inc : a->inc + 1) : adim;
+	const int* binc = CCV_IS_TENSOR_VIEW(b) ? ((b_nd == CCV_NNC_MAX_DIM + 1) ? b->inc : b->inc + 1) : bdim;
+	assert(hint.stride.dim[0] == 2 && hint.stride.dim[1] == 2);
+	const int r = w->info.dim[1];
+	assert(w->info.dim[2] == r);
+	// A stride 2 convolution is 4 stride 1 convolutions on the polyphase components of the input, one per
+	// (row, column) parity, each with a ceil(r / 2) kernel. Stacking the phases along the channels turns it
+	// into a single stride 1 convolution with 4x the channels and no padding.
+	const int pr = (r + 1) / 2;
+	const ccv_nnc_winograd_t* wg;
+	if (pr == 2)
+		wg = &_ccv_nnc_winograd_4x4_2x2;
+	else if (pr == 3)
+		wg = &_ccv_nnc_winograd_2x2_3x3;
+	else
+		return CCV_NNC_EXEC_INVALID;
+	const int channel_size = adim[2];
+	const int count = bdim[2];
+	const int pdim[3] = { bdim[0] + pr - 1, bdim[1] + pr - 1, channel_size * 4 };
+	ccv_nnc_winograd_parallel_t parallel = {
+		.adim = { pdim[0], pdim[1], pdim[2] },
+		.arow = pdim[1] * pdim[2],
+		.acol = pdim[2],
+		.border = { 0, 0 },
+		.bias = bias ? bias->data.f32 : 0,
+		.b = b->data.f32,
+		.bdim = { bdim[0], bdim[1], bdim[2] },
+		.brow = binc[1] * binc[2],
+		.bcol = binc[2],
+	};
+	const size_t pa_size = (size_t)pdim[0] * pdim[1] * pdim[2];
+	const size_t pw_size = (size_t)count * pr * pr * pdim[2];
+	const size_t size = _ccv_nnc_winograd_workmem_size(wg, &parallel);
+	float* const workmem = (float*)ccv_nnc_stream_context_get_workspace(stream_context, sizeof(float) * (pa_size + pw_size + size), CCV_TENSOR_CPU_MEMORY);
+	if (!workmem)
+		return CCV_NNC_EXEC_OOM;
+	float* const pa = workmem;
+	float* const pw = workmem + pa_size;
+	int i, j, k, x, y, q;
+	for (i = 0; i < pdim[0]; i++)
+		for (j = 0; j < pdim[1]; j++)
+			for (q = 0; q < 4; q++)
+			{
+				const int iy = i * 2 + (q >> 1) - hint.border.begin[0];
+				const int ix = j * 2 + (q & 1) - hint.border.begin[1];
+				float* const pap = pa + (i * pdim[1] + j) * pdim[2] + q * channel_size;
+				if (iy >= 0 && iy < adim[0] && ix >= 0 && ix < adim[1])
+					memcpy(pap, a->data.f32 + (iy * ainc[1] + ix) * ainc[2], sizeof(float) * channel_size);
+				else
+					memset(pap, 0, sizeof(float) * channel_size);
+			}
+	for (k = 0; k < count; k++)
+		for (y = 0; y < pr; y++)
+			for (x = 0; x < pr; x++)
+				for (q = 0; q < 4; q++)
+				{
+					const int wy = y * 2 + (q >> 1);
+					const int wx = x * 2 + (q & 1);
+					float* const pwp = pw + ((k * pr + y) * pr + x) * pdim[2] + q * channel_size;
+					if (wy < r && wx < r)
+						memcpy(pwp, w->data.f32 + ((k * r + wy) * r + wx) * channel_size, sizeof(float) * channel_size);
+					else
+						memset(pwp, 0, sizeof(float) * channel_size);
+				}
+	parallel.a = pa;
+	parallel.w = pw;
+	_ccv_nnc_winograd_forw(wg, &parallel, pw + pw_size);
+	return CCV_NNC_EXEC_SUCCESS;
+}
@@ -55,7 +55,7 @@ static int _ccv_nnc_dropout_back_bitmask(const int input_size, const int output_
 }
 
 REGISTER_COMMAND(CCV_NNC_DROPOUT_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_dropout_cpu_ref.c, gpu/ccv_nnc_dropout_gpu_cudnn.cu)
+	FIND_BACKEND(ccv_nnc_dropout_cpu_ref.c, ccv_nnc_dropout_cpu_opt.c, gpu/ccv_nnc_dropout_gpu_cudnn.cu)
 {
 	registry->bitmask = _ccv_nnc_dropout_forw_bitmask;
 	registry->tensor_auto = _ccv_nnc_dropout_tensor_auto_forw;
@@ -63,7 +63,7 @@ REGISTER_COMMAND(CCV_NNC_DROPOUT_FORWARD)(ccv_nnc_cmd_registry_t* const registry
 }
 
 REGISTER_COMMAND(CCV_NNC_DROPOUT_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_dropout_cpu_ref.c, gpu/ccv_nnc_dropout_gpu_cudnn.cu)
+	FIND_BACKEND(ccv_nnc_dropout_cpu_ref.c, ccv_nnc_dropout_cpu_opt.c, gpu/ccv_nnc_dropout_gpu_cudnn.cu)
 {
 	registry->bitmask = _ccv_nnc_dropout_back_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_backward_from_gradient;
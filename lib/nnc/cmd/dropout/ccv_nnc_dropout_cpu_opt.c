@@ -0,0 +1,178 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+
+// Shared methods.
+#include "../_ccv_nnc_cpu_opt.h"
+
+// The uniform random numbers are generated on stack in blocks of this many.
+#define CCV_NNC_DROPOUT_BLOCK (256)
+
+typedef struct {
+	const float* ap;
+	float* bp;
+	uint8_t* maskp;
+	int count;
+	uint64_t seed;
+	uint64_t offset;
+	float p;
+	float inv_p;
+	int drop; // For entirety, whether the whole tensor is dropped.
+} ccv_nnc_dropout_parallel_t;
+
+// bp = mask ? 0 : ap * inv_p, where the mask is generated if r is not 0, otherwise read from maskp.
+static inline void _ccv_nnc_dropout_apply(const float* const ap, float* const bp, uint8_t* const maskp, const float* const r, const float p, const float inv_p, const int count)
+{
+	int i = 0;
+#if defined(HAVE_SSE2)
+	const __m128 pv = _mm_set1_ps(p);
+	const __m128 inv_pv = _mm_set1_ps(inv_p);
+	const __m128 zero = _mm_setzero_ps();
+	int j;
+	for (; i < count - 3; i += 4)
+	{
+		__m128 drop;
+		if (r)
+		{
+			drop = _mm_cmple_ps(_mm_loadu_ps(r + i), pv);
+			const int m = _mm_movemask_ps(drop);
+			for (j = 0; j < 4; j++)
+				maskp[i + j] = (m >> j) & 1;
+		} else
+			drop = _mm_cmpneq_ps(_mm_set_ps(maskp[i + 3], maskp[i + 2], maskp[i + 1], maskp[i]), zero);
+		_mm_storeu_ps(bp + i, _mm_andnot_ps(drop, _mm_mul_ps(_mm_loadu_ps(ap + i), inv_pv)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		if (r)
+			maskp[i] = (r[i] <= p);
+		bp[i] = maskp[i] ? 0 : ap[i] * inv_p;
+	}
+}
+
+static void _ccv_nnc_dropout_forw_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_dropout_parallel_t* const parallel = (ccv_nnc_dropout_parallel_t*)context;
+	const int offset = idx * CCV_NNC_RAND_CHUNK;
+	const int count = ccv_min(parallel->count - offset, CCV_NNC_RAND_CHUNK);
+	float r[CCV_NNC_DROPOUT_BLOCK];
+	int i;
+	for (i = 0; i < count; i += CCV_NNC_DROPOUT_BLOCK)
+	{
+		const int block = ccv_min(count - i, CCV_NNC_DROPOUT_BLOCK);
+		_ccv_nnc_philox_uniform(parallel->seed, parallel->offset + offset + i, r, block);
+		_ccv_nnc_dropout_apply(parallel->ap + offset + i, parallel->bp + offset + i, parallel->maskp + offset + i, r, parallel->p, parallel->inv_p, block);
+	}
+}
+
+static void _ccv_nnc_dropout_mask_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_dropout_parallel_t* const parallel = (ccv_nnc_dropout_parallel_t*)context;
+	const int offset = idx * CCV_NNC_RAND_CHUNK;
+	const int count = ccv_min(parallel->count - offset, CCV_NNC_RAND_CHUNK);
+	_ccv_nnc_dropout_apply(parallel->ap + offset, parallel->bp + offset, parallel->maskp + offset, 0, parallel->p, parallel->inv_p, count);
+}
+
+static void _ccv_nnc_dropout_entirety_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_dropout_parallel_t* const parallel = (ccv_nnc_dropout_parallel_t*)context;
+	const int offset = idx * CCV_NNC_RAND_CHUNK;
+	const int count = ccv_min(parallel->count - offset, CCV_NNC_RAND_CHUNK);
+	const float* const ap = parallel->ap + offset;
+	float* const bp = parallel->bp + offset;
+	if (parallel->drop)
+	{
+		memset(bp, 0, sizeof(float) * count);
+		return;
+	}
+	const float inv_p = parallel->inv_p;
+	int i = 0;
+#if defined(HAVE_SSE2)
+	const __m128 inv_pv = _mm_set1_ps(inv_p);
+	for (; i < count - 3; i += 4)
+		_mm_storeu_ps(bp + i, _mm_mul_ps(_mm_loadu_ps(ap + i), inv_pv));
+#endif
+	for (; i < count; i++)
+		bp[i] = ap[i] * inv_p;
+}
+
+static int _ccv_nnc_dropout_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(output_size >= 2);
+	ccv_nnc_tensor_view_t* a = (ccv_nnc_tensor_view_t*)inputs[0];
+	ccv_nnc_tensor_view_t* b = (ccv_nnc_tensor_view_t*)outputs[0];
+	if (CCV_IS_TENSOR_VIEW(a) || CCV_IS_TENSOR_VIEW(b))
+		return CCV_NNC_EXEC_INVALID;
+	const int count = ccv_nnc_tensor_count(a->info);
+	assert(count == ccv_nnc_tensor_count(b->info));
+	const float p = cmd.info.dropout.p;
+	ccv_nnc_dropout_parallel_t parallel = {
+		.ap = a->data.f32,
+		.bp = b->data.f32,
+		.maskp = outputs[1]->data.u8,
+		.count = count,
+		.seed = cmd.info.rand.seed ? cmd.info.rand.seed : (uint32_t)a->data.i32[0], // Otherwise, seeded the same way as the reference implementation.
+		.offset = cmd.info.rand.seed ? cmd.info.rand.offset : 0,
+		.p = p,
+		.inv_p = 1. / (1. - p),
+	};
+	const int chunk_count = (count + CCV_NNC_RAND_CHUNK - 1) / CCV_NNC_RAND_CHUNK;
+	if (cmd.info.dropout.entirety)
+	{
+		float r[4]; // It may fill up a whole block of 4.
+		_ccv_nnc_philox_uniform(parallel.seed, parallel.offset, r, 1);
+		parallel.drop = ((int32_t*)parallel.maskp)[0] = (r[0] <= p);
+		ccv_nnc_parallel_for(chunk_count, 0, _ccv_nnc_dropout_entirety_parallel, &parallel);
+	} else
+		ccv_nnc_parallel_for(chunk_count, 0, _ccv_nnc_dropout_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_dropout_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 5);
+	ccv_nnc_tensor_view_t* g = (ccv_nnc_tensor_view_t*)inputs[0];
+	ccv_nnc_tensor_view_t* h = (ccv_nnc_tensor_view_t*)outputs[0];
+	if (CCV_IS_TENSOR_VIEW(g) || CCV_IS_TENSOR_VIEW(h))
+		return CCV_NNC_EXEC_INVALID;
+	const int count = ccv_nnc_tensor_count(g->info);
+	assert(count == ccv_nnc_tensor_count(h->info));
+	const float p = cmd.info.dropout.p;
+	ccv_nnc_dropout_parallel_t parallel = {
+		.ap = g->data.f32,
+		.bp = h->data.f32,
+		.maskp = inputs[4]->data.u8,
+		.count = count,
+		.p = p,
+		.inv_p = 1. / (1. - p),
+	};
+	const int chunk_count = (count + CCV_NNC_RAND_CHUNK - 1) / CCV_NNC_RAND_CHUNK;
+	if (cmd.info.dropout.entirety)
+	{
+		parallel.drop = ((int32_t*)parallel.maskp)[0];
+		ccv_nnc_parallel_for(chunk_count, 0, _ccv_nnc_dropout_entirety_parallel, &parallel);
+	} else
+		ccv_nnc_parallel_for(chunk_count, 0, _ccv_nnc_dropout_mask_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_DROPOUT_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_dropout_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_DROPOUT_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_dropout_back;
+}
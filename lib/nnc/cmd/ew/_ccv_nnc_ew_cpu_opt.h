@@ -0,0 +1,36 @@
+/**********************************************************
+ * C-based/Cached/Core Computer Vision Library
+ * Liu Liu, 2010-02-01
+ **********************************************************/
+
+/**********************************************************
+ * CCV - Neural Network Collection
+ **********************************************************/
+
+#ifndef GUARD_ccv_nnc_ew_cpu_opt_h
+#define GUARD_ccv_nnc_ew_cpu_opt_h
+
+#include "ccv.h"
+#include "nnc/ccv_nnc.h"
+
+enum {
+	CCV_NNC_EW_CPU_OPT_SUM, // c = p * a + q * b
+	CCV_NNC_EW_CPU_OPT_PROD, // c = p * a * b
+	CCV_NNC_EW_CPU_OPT_DIV, // c = p * a / b, a can be 0, which taken as all ones tensor.
+	CCV_NNC_EW_CPU_OPT_SCALE, // c = p * a
+	CCV_NNC_EW_CPU_OPT_EXP, // c = exp(a)
+	CCV_NNC_EW_CPU_OPT_LOG, // c = log(a)
+	CCV_NNC_EW_CPU_OPT_SQRT, // c = sqrt(a)
+};
+
+/**
+ * Apply an elementwise operation. Both a and b can be tensor views, and broadcast to c (for the binary operations).
+ * b is ignored for the unary operations. Large tensors are split across the threads.
+ */
+void _ccv_nnc_ew_cpu_opt(const int op, const float p, const float q, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const b, ccv_nnc_tensor_view_t* const c);
+/**
+ * Same as above, and then apply the fused activation (CCV_NNC_ACTIVATION_*) to c while it is still in cache.
+ */
+void _ccv_nnc_ew_activation_cpu_opt(const int op, const float p, const float q, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const b, ccv_nnc_tensor_view_t* const c, const int activation);
+
+#endif
@@ -0,0 +1,275 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#elif defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+#include "../_ccv_nnc_ew_cpu_opt.h"
+#include "../../_ccv_nnc_cpu_opt.h"
+
+// Below this many elements, it is not worth to wake up other threads.
+#define CCV_NNC_EW_PARALLEL_MIN (32768)
+// Long rows are split into chunks of this size, thus, a contiguous tensor can be split across threads as well.
+#define CCV_NNC_EW_CHUNK_SIZE (8192)
+
+typedef struct {
+	int op;
+	float p;
+	float q;
+	int activation; // Applied to each chunk of c after it is computed.
+	int nd; // The number of dimensions after collapsing contiguous ones.
+	int dim[CCV_NNC_MAX_DIM + 2];
+	int astride[CCV_NNC_MAX_DIM + 2]; // Broadcast dimension has stride of 0.
+	int bstride[CCV_NNC_MAX_DIM + 2];
+	int cstride[CCV_NNC_MAX_DIM + 2];
+	int chunk_count; // The number of chunks for each row.
+	const float* a;
+	const float* b;
+	float* c;
+} ccv_nnc_ew_cpu_opt_parallel_t;
+
+static inline float _ccv_nnc_ew_op(const int op, const float p, const float q, const float a, const float b)
+{
+	switch (op)
+	{
+		case CCV_NNC_EW_CPU_OPT_SUM:
+			return p * a + q * b;
+		case CCV_NNC_EW_CPU_OPT_PROD:
+			return p * a * b;
+		case CCV_NNC_EW_CPU_OPT_DIV:
+			return p * a / b;
+		case CCV_NNC_EW_CPU_OPT_SCALE:
+			return p * a;
+		case CCV_NNC_EW_CPU_OPT_EXP:
+			return expf(a);
+		case CCV_NNC_EW_CPU_OPT_LOG:
+			return logf(a);
+		case CCV_NNC_EW_CPU_OPT_SQRT:
+			return sqrtf(a);
+	}
+	return 0;
+}
+
+static void _ccv_nnc_ew_strided(const int op, const float p, const float q, const float* const a, const int as, const float* const b, const int bs, float* const c, const int cs, const int n)
+{
+	int x;
+	for (x = 0; x < n; x++)
+		c[x * cs] = _ccv_nnc_ew_op(op, p, q, a[x * as], b[x * bs]);
+}
+
+#ifdef HAVE_SSE2
+// a and b are either contiguous (stride 1) or a scalar (stride 0), c is contiguous.
+static void _ccv_nnc_ew_sse2(const int op, const float p, const float q, const float* const a, const int as, const float* const b, const int bs, float* const c, const int n)
+{
+	const __m128 p4 = _mm_set1_ps(p);
+	const __m128 q4 = _mm_set1_ps(q);
+	const __m128 a4 = _mm_set1_ps(a[0]);
+	const __m128 b4 = _mm_set1_ps(b[0]);
+#define LOAD_A(x) (as ? _mm_loadu_ps(a + (x)) : a4)
+#define LOAD_B(x) (bs ? _mm_loadu_ps(b + (x)) : b4)
+	int x = 0;
+	switch (op)
+	{
+		case CCV_NNC_EW_CPU_OPT_SUM:
+			for (; x < n - 3; x += 4)
+				_mm_storeu_ps(c + x, _mm_add_ps(_mm_mul_ps(p4, LOAD_A(x)), _mm_mul_ps(q4, LOAD_B(x))));
+			break;
+		case CCV_NNC_EW_CPU_OPT_PROD:
+			for (; x < n - 3; x += 4)
+				_mm_storeu_ps(c + x, _mm_mul_ps(_mm_mul_ps(p4, LOAD_A(x)), LOAD_B(x)));
+			break;
+		case CCV_NNC_EW_CPU_OPT_DIV:
+			for (; x < n - 3; x += 4)
+				_mm_storeu_ps(c + x, _mm_div_ps(_mm_mul_ps(p4, LOAD_A(x)), LOAD_B(x)));
+			break;
+		case CCV_NNC_EW_CPU_OPT_SCALE:
+			for (; x < n - 3; x += 4)
+				_mm_storeu_ps(c + x, _mm_mul_ps(p4, LOAD_A(x)));
+			break;
+		case CCV_NNC_EW_CPU_OPT_EXP:
+			for (; x < n - 3; x += 4)
+				_mm_storeu_ps(c + x, _ccv_nnc_exp_ps(LOAD_A(x)));
+			break;
+		case CCV_NNC_EW_CPU_OPT_LOG:
+			for (; x < n - 3; x += 4)
+				_mm_storeu_ps(c + x, _ccv_nnc_log_ps(LOAD_A(x)));
+			break;
+		case CCV_NNC_EW_CPU_OPT_SQRT:
+			for (; x < n - 3; x += 4)
+				_mm_storeu_ps(c + x, _mm_sqrt_ps(LOAD_A(x)));
+			break;
+	}
+#undef LOAD_A
+#undef LOAD_B
+	for (; x < n; x++)
+		c[x] = _ccv_nnc_ew_op(op, p, q, a[x * as], b[x * bs]);
+}
+#endif
+
+#ifdef HAVE_NEON
+// a and b are either contiguous (stride 1) or a scalar (stride 0), c is contiguous.
+static void _ccv_nnc_ew_neon(const int op, const float p, const float q, const float* const a, const int as, const float* const b, const int bs, float* const c, const int n)
+{
+	const float32x4_t p4 = vdupq_n_f32(p);
+	const float32x4_t q4 = vdupq_n_f32(q);
+	const float32x4_t a4 = vdupq_n_f32(a[0]);
+	const float32x4_t b4 = vdupq_n_f32(b[0]);
+#define LOAD_A(x) (as ? vld1q_f32(a + (x)) : a4)
+#define LOAD_B(x) (bs ? vld1q_f32(b + (x)) : b4)
+	int x = 0;
+	// Division, exp, log and sqrt doesn't have a full precision NEON instruction on ARMv7, these are done with the scalar loop.
+	switch (op)
+	{
+		case CCV_NNC_EW_CPU_OPT_SUM:
+			for (; x < n - 3; x += 4)
+				vst1q_f32(c + x, vaddq_f32(vmulq_f32(p4, LOAD_A(x)), vmulq_f32(q4, LOAD_B(x))));
+			break;
+		case CCV_NNC_EW_CPU_OPT_PROD:
+			for (; x < n - 3; x += 4)
+				vst1q_f32(c + x, vmulq_f32(vmulq_f32(p4, LOAD_A(x)), LOAD_B(x)));
+			break;
+		case CCV_NNC_EW_CPU_OPT_SCALE:
+			for (; x < n - 3; x += 4)
+				vst1q_f32(c + x, vmulq_f32(p4, LOAD_A(x)));
+			break;
+	}
+#undef LOAD_A
+#undef LOAD_B
+	for (; x < n; x++)
+		c[x] = _ccv_nnc_ew_op(op, p, q, a[x * as], b[x * bs]);
+}
+#endif
+
+static void _ccv_nnc_ew_cpu_opt_parallel(void* const context, const int i)
+{
+	const ccv_nnc_ew_cpu_opt_parallel_t* const parallel = (ccv_nnc_ew_cpu_opt_parallel_t*)context;
+	const int nd = parallel->nd;
+	const int start = (i % parallel->chunk_count) * CCV_NNC_EW_CHUNK_SIZE;
+	const int n = ccv_min(CCV_NNC_EW_CHUNK_SIZE, parallel->dim[nd - 1] - start);
+	const int as = parallel->astride[nd - 1];
+	const int bs = parallel->bstride[nd - 1];
+	const int cs = parallel->cstride[nd - 1];
+	const float* ap = parallel->a + start * as;
+	const float* bp = parallel->b + start * bs;
+	float* cp = parallel->c + start * cs;
+	int row = i / parallel->chunk_count;
+	int k;
+	for (k = nd - 2; k >= 0; k--)
+	{
+		const int x = row % parallel->dim[k];
+		row /= parallel->dim[k];
+		ap += x * parallel->astride[k];
+		bp += x * parallel->bstride[k];
+		cp += x * parallel->cstride[k];
+	}
+#if defined(HAVE_SSE2)
+	if (cs == 1 && (as == 0 || as == 1) && (bs == 0 || bs == 1))
+		_ccv_nnc_ew_sse2(parallel->op, parallel->p, parallel->q, ap, as, bp, bs, cp, n);
+	else
+#elif defined(HAVE_NEON)
+	if (cs == 1 && (as == 0 || as == 1) && (bs == 0 || bs == 1))
+		_ccv_nnc_ew_neon(parallel->op, parallel->p, parallel->q, ap, as, bp, bs, cp, n);
+	else
+#endif
+		_ccv_nnc_ew_strided(parallel->op, parallel->p, parallel->q, ap, as, bp, bs, cp, cs, n);
+	_ccv_nnc_activation_cpu_opt(parallel->activation, cp, cs, n);
+}
+
+void _ccv_nnc_ew_cpu_opt(const int op, const float p, const float q, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const b, ccv_nnc_tensor_view_t* const c)
+{
+	_ccv_nnc_ew_activation_cpu_opt(op, p, q, a, b, c, CCV_NNC_ACTIVATION_NONE);
+}
+
+void _ccv_nnc_ew_activation_cpu_opt(const int op, const float p, const float q, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const b, ccv_nnc_tensor_view_t* const c, const int activation)
+{
+	// Missing input is a scalar, for division, 0 means all ones tensor.
+	static const float one = 1;
+	const int binary = (op == CCV_NNC_EW_CPU_OPT_SUM || op == CCV_NNC_EW_CPU_OPT_PROD || op == CCV_NNC_EW_CPU_OPT_DIV);
+	assert(a || op == CCV_NNC_EW_CPU_OPT_DIV);
+	assert(b || !binary);
+	int cdim[CCV_NNC_MAX_DIM_ALLOC];
+	assert(ccv_nnc_tensor_nd(c->info.dim) <= CCV_NNC_MAX_DIM + 2);
+	ccv_nnc_tensor_view_get_dim(c, cdim);
+	const ccv_nnc_tensor_view_t* const tvs[3] = {
+		a, binary ? b : 0, c
+	};
+	int stride[3][CCV_NNC_MAX_DIM + 2];
+	int i, k;
+	for (i = 0; i < 3; i++)
+	{
+		if (!tvs[i])
+		{
+			for (k = 0; k < CCV_NNC_MAX_DIM + 2; k++)
+				stride[i][k] = 0;
+			continue;
+		}
+		assert(ccv_nnc_tensor_nd(tvs[i]->info.dim) <= CCV_NNC_MAX_DIM + 2);
+		assert(binary ? ccv_nnc_tensor_view_check_broadcast_dim(tvs[i], cdim) : ccv_nnc_tensor_view_check_dim(tvs[i], cdim));
+		int dim[CCV_NNC_MAX_DIM_ALLOC];
+		int inc[CCV_NNC_MAX_DIM_ALLOC];
+		ccv_nnc_tensor_view_get_dim(tvs[i], dim);
+		ccv_nnc_tensor_view_get_inc(tvs[i], inc);
+		int s = 1;
+		for (k = CCV_NNC_MAX_DIM + 1; k >= 0; k--)
+		{
+			stride[i][k] = dim[k] == 1 ? 0 : s;
+			s *= inc[k];
+		}
+	}
+	ccv_nnc_ew_cpu_opt_parallel_t parallel = {
+		.op = op,
+		.p = p,
+		.q = q,
+		.activation = activation,
+		.nd = 0,
+		.a = a ? a->data.f32 : &one,
+		.b = binary ? b->data.f32 : &one,
+		.c = c->data.f32,
+	};
+	// Drop dimensions of 1, and collapse the dimension into the inner one if it is contiguous for all tensors.
+	for (k = 0; k < CCV_NNC_MAX_DIM + 2; k++)
+	{
+		if (cdim[k] == 1)
+			continue;
+		const int nd = parallel.nd;
+		if (nd > 0 &&
+			parallel.astride[nd - 1] == stride[0][k] * cdim[k] &&
+			parallel.bstride[nd - 1] == stride[1][k] * cdim[k] &&
+			parallel.cstride[nd - 1] == stride[2][k] * cdim[k])
+		{
+			parallel.dim[nd - 1] *= cdim[k];
+			parallel.astride[nd - 1] = stride[0][k];
+			parallel.bstride[nd - 1] = stride[1][k];
+			parallel.cstride[nd - 1] = stride[2][k];
+		} else {
+			parallel.dim[nd] = cdim[k];
+			parallel.astride[nd] = stride[0][k];
+			parallel.bstride[nd] = stride[1][k];
+			parallel.cstride[nd] = stride[2][k];
+			++parallel.nd;
+		}
+	}
+	if (parallel.nd == 0)
+	{
+		parallel.nd = 1;
+		parallel.dim[0] = 1;
+		parallel.astride[0] = parallel.bstride[0] = parallel.cstride[0] = 0;
+	}
+	const int nd = parallel.nd;
+	int rows = 1;
+	for (k = 0; k < nd - 1; k++)
+		rows *= parallel.dim[k];
+	parallel.chunk_count = (parallel.dim[nd - 1] + CCV_NNC_EW_CHUNK_SIZE - 1) / CCV_NNC_EW_CHUNK_SIZE;
+	const int count = rows * parallel.dim[nd - 1];
+	if (count < CCV_NNC_EW_PARALLEL_MIN)
+	{
+		for (i = 0; i < rows * parallel.chunk_count; i++)
+			_ccv_nnc_ew_cpu_opt_parallel(&parallel, i);
+		return;
+	}
+	ccv_nnc_parallel_for(rows * parallel.chunk_count, 0, _ccv_nnc_ew_cpu_opt_parallel, &parallel);
+}
@@ -3,12 +3,29 @@
 #include "nnc/ccv_nnc.h"
 #include "nnc/ccv_nnc_easy.h"
 #include "nnc/ccv_nnc_internal.h"
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif
-#ifdef USE_DISPATCH
-#include <dispatch/dispatch.h>
-#endif
+
+typedef struct {
+	const ccv_nnc_tensor_view_t* a;
+	const ccv_nnc_tensor_view_t* indices;
+	const ccv_nnc_tensor_view_t* b;
+	int a_rows;
+	int a_cols;
+	int a_cols_inc;
+	int b_rows;
+	int b_cols_inc;
+	size_t data_size;
+} ccv_nnc_index_select_parallel_t;
+
+static void _ccv_nnc_index_select_forw_parallel(void* const context, const int i)
+{
+	const ccv_nnc_index_select_parallel_t* const parallel = (ccv_nnc_index_select_parallel_t*)context;
+	const size_t data_size = parallel->data_size;
+	const int index = parallel->indices->data.i32[i];
+	assert(index < parallel->a_rows);
+	uint8_t* const bp = parallel->b->data.u8 + data_size * parallel->b_cols_inc * i;
+	uint8_t* const ap = parallel->a->data.u8 + data_size * parallel->a_cols_inc * index;
+	memcpy(bp, ap, data_size * parallel->a_cols);
+}
 
 static int _ccv_nnc_index_select_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
@@ -34,16 +51,64 @@ static int _ccv_nnc_index_select_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hin
 	assert(a->info.datatype == b->info.datatype);
 	assert(a->info.datatype == CCV_32F || a->info.datatype == CCV_16F);
 	const size_t data_size = CCV_GET_DATA_TYPE_SIZE(a->info.datatype);
-	parallel_for(i, b_rows) {
-		const int index = indices->data.i32[i];
-		assert(index < a_rows);
-		uint8_t* const bp = b->data.u8 + data_size * b_cols_inc * i;
-		uint8_t* const ap = a->data.u8 + data_size * a_cols_inc * index;
-		memcpy(bp, ap, data_size * a_cols);
-	} parallel_endfor
+	ccv_nnc_index_select_parallel_t parallel = {
+		.a = a,
+		.indices = indices,
+		.b = b,
+		.a_rows = a_rows,
+		.a_cols = a_cols,
+		.a_cols_inc = a_cols_inc,
+		.b_cols_inc = b_cols_inc,
+		.data_size = data_size,
+	};
+	ccv_nnc_parallel_for(b_rows, 0, _ccv_nnc_index_select_forw_parallel, &parallel);
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
+#define INDEX_SELECT_COLUMN_BLOCK (64)
+
+static void _ccv_nnc_index_select_back_parallel(void* const context, const int k)
+{
+	const ccv_nnc_index_select_parallel_t* const parallel = (ccv_nnc_index_select_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const g = parallel->a;
+	const ccv_nnc_tensor_view_t* const h = parallel->b;
+	const int g_rows = parallel->b_rows;
+	const int g_cols_inc = parallel->a_cols_inc;
+	const int h_cols_inc = parallel->b_cols_inc;
+	const int h_rows = parallel->a_rows;
+	const int start = k * INDEX_SELECT_COLUMN_BLOCK;
+	const int end = ccv_min(start + INDEX_SELECT_COLUMN_BLOCK, parallel->a_cols);
+	int i, j;
+	if (g->info.datatype == CCV_32F)
+	{
+		for (i = 0; i < g_rows; i++)
+		{
+			const int index = parallel->indices->data.i32[i];
+			assert(index < h_rows);
+			float* const hp = h->data.f32 + h_cols_inc * index;
+			float* const gp = g->data.f32 + g_cols_inc * i;
+			for (j = start; j < end; j++)
+				hp[j] += gp[j];
+		}
+	} else {
+		for (i = 0; i < g_rows; i++)
+		{
+			const int index = parallel->indices->data.i32[i];
+			assert(index < h_rows);
+			ccv_float16_t* const hp = h->data.f16 + h_cols_inc * index;
+			ccv_float16_t* const gp = g->data.f16 + g_cols_inc * i;
+			for (j = start; j < end; j++)
+			{
+				float t, v;
+				ccv_half_precision_to_float((uint16_t*)gp + j, &t, 1);
+				ccv_half_precision_to_float((uint16_t*)hp + j, &v, 1);
+				v += t;
+				ccv_float_to_half_precision(&v, (uint16_t*)hp + j, 1);
+			}
+		}
+	}
+}
+
 static int _ccv_nnc_index_select_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
 	assert(input_size >= 3);
@@ -70,35 +135,18 @@ static int _ccv_nnc_index_select_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hin
 	assert(indices->info.datatype == CCV_32S);
 	assert(g->info.datatype == h->info.datatype);
 	assert(g->info.datatype == CCV_32F || g->info.datatype == CCV_16F);
-	int i;
-	if (g->info.datatype == CCV_32F)
-	{
-		for (i = 0; i < g_rows; i++)
-		{
-			const int index = indices->data.i32[i];
-			assert(index < h_rows);
-			float* const hp = h->data.f32 + h_cols_inc * index;
-			float* const gp = g->data.f32 + g_cols_inc * i;
-			parallel_for(j, g_cols) {
-				hp[j] += gp[j];
-			} parallel_endfor
-		}
-	} else {
-		for (i = 0; i < g_rows; i++)
-		{
-			const int index = indices->data.i32[i];
-			assert(index < h_rows);
-			ccv_float16_t* const hp = h->data.f16 + h_cols_inc * index;
-			ccv_float16_t* const gp = g->data.f16 + g_cols_inc * i;
-			parallel_for(j, g_cols) {
-				float t, v;
-				ccv_half_precision_to_float((uint16_t*)gp + j, &t, 1);
-				ccv_half_precision_to_float((uint16_t*)hp + j, &v, 1);
-				v += t;
-				ccv_float_to_half_precision(&v, (uint16_t*)hp + j, 1);
-			} parallel_endfor
-		}
-	}
+	// Different rows can scatter into the same index, therefore, split the columns rather than the rows.
+	ccv_nnc_index_select_parallel_t parallel = {
+		.a = g,
+		.indices = indices,
+		.b = h,
+		.a_rows = h_rows,
+		.a_cols = g_cols,
+		.a_cols_inc = g_cols_inc,
+		.b_rows = g_rows,
+		.b_cols_inc = h_cols_inc,
+	};
+	ccv_nnc_parallel_for((g_cols + INDEX_SELECT_COLUMN_BLOCK - 1) / INDEX_SELECT_COLUMN_BLOCK, 0, _ccv_nnc_index_select_back_parallel, &parallel);
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
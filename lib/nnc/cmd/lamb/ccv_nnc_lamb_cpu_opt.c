@@ -0,0 +1,195 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+
+// Shared methods.
+#include "../_ccv_nnc_cpu_opt.h"
+
+typedef struct {
+	const ccv_nnc_multi_tensor_chunk_t* chunks;
+	ccv_nnc_tensor_t* const* inputs;
+	ccv_nnc_tensor_t* const* outputs;
+	float clip;
+	float beta1;
+	float beta2;
+	float decay;
+	float epsilon;
+	float inv_bias_correction1;
+	float inv_bias_correction2;
+	double* w_norms; // Partial sum of squares of the weights, per chunk.
+	double* update_norms; // Partial sum of squares of the updates, per chunk.
+	float* rate_trust_ratios; // Per parameter.
+} ccv_nnc_lamb_parallel_t;
+
+// The first pass computes the new moments and the norms. The update is not kept, it is computed again from the new moments
+// in the second pass, thus, no scratch space as large as the parameters is needed.
+static void _ccv_nnc_lamb_forw_moment_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_lamb_parallel_t* const parallel = (ccv_nnc_lamb_parallel_t*)context;
+	const ccv_nnc_multi_tensor_chunk_t chunk = parallel->chunks[idx];
+	ccv_nnc_tensor_t* const* const inputs = parallel->inputs + chunk.group * 4;
+	ccv_nnc_tensor_t* const* const outputs = parallel->outputs + chunk.group * 3;
+	const float* const gp = inputs[0]->data.f32 + chunk.offset;
+	const float* const ap = inputs[1]->data.f32 + chunk.offset;
+	const float* const mp = inputs[2]->data.f32 + chunk.offset;
+	const float* const vp = inputs[3]->data.f32 + chunk.offset;
+	float* const np = outputs[1]->data.f32 + chunk.offset;
+	float* const up = outputs[2]->data.f32 + chunk.offset;
+	const float clip = parallel->clip;
+	const float beta1 = parallel->beta1;
+	const float beta2 = parallel->beta2;
+	const float decay = parallel->decay;
+	const float epsilon = parallel->epsilon;
+	const float inv_bias_correction1 = parallel->inv_bias_correction1;
+	const float inv_bias_correction2 = parallel->inv_bias_correction2;
+	const int count = chunk.count;
+	double w_norm = 0;
+	double update_norm = 0;
+	int x = 0;
+#if defined(HAVE_SSE2)
+	const __m128 clip4 = _mm_set1_ps(clip);
+	const __m128 beta14 = _mm_set1_ps(beta1);
+	const __m128 beta24 = _mm_set1_ps(beta2);
+	const __m128 one_minus_beta14 = _mm_set1_ps(1 - beta1);
+	const __m128 one_minus_beta24 = _mm_set1_ps(1 - beta2);
+	const __m128 decay4 = _mm_set1_ps(decay);
+	const __m128 epsilon4 = _mm_set1_ps(epsilon);
+	const __m128 inv_bias_correction14 = _mm_set1_ps(inv_bias_correction1);
+	const __m128 inv_bias_correction24 = _mm_set1_ps(inv_bias_correction2);
+	__m128d w_norm2 = _mm_setzero_pd();
+	__m128d update_norm2 = _mm_setzero_pd();
+	for (; x < count - 3; x += 4)
+	{
+		const __m128 grad = _mm_mul_ps(clip4, _mm_loadu_ps(gp + x));
+		const __m128 w = _mm_loadu_ps(ap + x);
+		const __m128 mom = _mm_add_ps(_mm_mul_ps(beta14, _mm_loadu_ps(mp + x)), _mm_mul_ps(one_minus_beta14, grad));
+		const __m128 vel = _mm_add_ps(_mm_mul_ps(beta24, _mm_loadu_ps(vp + x)), _mm_mul_ps(_mm_mul_ps(one_minus_beta24, grad), grad));
+		_mm_storeu_ps(np + x, mom);
+		_mm_storeu_ps(up + x, vel);
+		const __m128 update = _mm_add_ps(_mm_div_ps(_mm_mul_ps(mom, inv_bias_correction14), _mm_add_ps(_mm_sqrt_ps(_mm_mul_ps(vel, inv_bias_correction24)), epsilon4)), _mm_mul_ps(w, decay4));
+		const __m128 w2 = _mm_mul_ps(w, w);
+		const __m128 update2 = _mm_mul_ps(update, update);
+		w_norm2 = _mm_add_pd(w_norm2, _mm_add_pd(_mm_cvtps_pd(w2), _mm_cvtps_pd(_mm_movehl_ps(w2, w2))));
+		update_norm2 = _mm_add_pd(update_norm2, _mm_add_pd(_mm_cvtps_pd(update2), _mm_cvtps_pd(_mm_movehl_ps(update2, update2))));
+	}
+	double s[2];
+	_mm_storeu_pd(s, w_norm2);
+	w_norm = s[0] + s[1];
+	_mm_storeu_pd(s, update_norm2);
+	update_norm = s[0] + s[1];
+#endif
+	for (; x < count; x++)
+	{
+		const float grad = clip * gp[x];
+		const float w = ap[x];
+		const float mom = np[x] = beta1 * mp[x] + (1 - beta1) * grad;
+		const float vel = up[x] = beta2 * vp[x] + (1 - beta2) * grad * grad;
+		const float update = (mom * inv_bias_correction1) / (sqrtf(vel * inv_bias_correction2) + epsilon) + w * decay;
+		w_norm += w * w;
+		update_norm += update * update;
+	}
+	parallel->w_norms[idx] = w_norm;
+	parallel->update_norms[idx] = update_norm;
+}
+
+static void _ccv_nnc_lamb_forw_apply_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_lamb_parallel_t* const parallel = (ccv_nnc_lamb_parallel_t*)context;
+	const ccv_nnc_multi_tensor_chunk_t chunk = parallel->chunks[idx];
+	ccv_nnc_tensor_t* const* const inputs = parallel->inputs + chunk.group * 4;
+	ccv_nnc_tensor_t* const* const outputs = parallel->outputs + chunk.group * 3;
+	const float* const ap = inputs[1]->data.f32 + chunk.offset;
+	float* const bp = outputs[0]->data.f32 + chunk.offset;
+	const float* const np = outputs[1]->data.f32 + chunk.offset;
+	const float* const up = outputs[2]->data.f32 + chunk.offset;
+	const float decay = parallel->decay;
+	const float epsilon = parallel->epsilon;
+	const float inv_bias_correction1 = parallel->inv_bias_correction1;
+	const float inv_bias_correction2 = parallel->inv_bias_correction2;
+	const float rate_trust_ratio = parallel->rate_trust_ratios[chunk.group];
+	const int count = chunk.count;
+	int x = 0;
+#if defined(HAVE_SSE2)
+	const __m128 decay4 = _mm_set1_ps(decay);
+	const __m128 epsilon4 = _mm_set1_ps(epsilon);
+	const __m128 inv_bias_correction14 = _mm_set1_ps(inv_bias_correction1);
+	const __m128 inv_bias_correction24 = _mm_set1_ps(inv_bias_correction2);
+	const __m128 rate_trust_ratio4 = _mm_set1_ps(rate_trust_ratio);
+	for (; x < count - 3; x += 4)
+	{
+		const __m128 w = _mm_loadu_ps(ap + x);
+		const __m128 update = _mm_add_ps(_mm_div_ps(_mm_mul_ps(_mm_loadu_ps(np + x), inv_bias_correction14), _mm_add_ps(_mm_sqrt_ps(_mm_mul_ps(_mm_loadu_ps(up + x), inv_bias_correction24)), epsilon4)), _mm_mul_ps(w, decay4));
+		_mm_storeu_ps(bp + x, _mm_sub_ps(w, _mm_mul_ps(rate_trust_ratio4, update)));
+	}
+#endif
+	for (; x < count; x++)
+	{
+		const float update = (np[x] * inv_bias_correction1) / (sqrtf(up[x] * inv_bias_correction2) + epsilon) + ap[x] * decay;
+		bp[x] = ap[x] - rate_trust_ratio * update;
+	}
+}
+
+static int _ccv_nnc_lamb_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	// Multiple parameters can be updated in one command, 4 inputs and 3 outputs each.
+	assert(input_size % 4 == 0);
+	assert(output_size == input_size / 4 * 3);
+	int i;
+	for (i = 0; i < input_size; i++)
+		if (CCV_IS_TENSOR_VIEW(inputs[i]))
+			return CCV_NNC_EXEC_INVALID;
+	for (i = 0; i < output_size; i++)
+		if (CCV_IS_TENSOR_VIEW(outputs[i]))
+			return CCV_NNC_EXEC_INVALID;
+	const int step = cmd.info.lamb.step;
+	assert(step >= 1);
+	const int group_count = input_size / 4;
+	const int chunk_count = _ccv_nnc_multi_tensor_chunks(inputs, input_size, 4, 0);
+	double* const w_norms = (double*)ccv_nnc_stream_context_get_workspace(stream_context, (sizeof(double) * 2 + sizeof(ccv_nnc_multi_tensor_chunk_t)) * chunk_count + sizeof(float) * group_count, CCV_TENSOR_CPU_MEMORY);
+	double* const update_norms = w_norms + chunk_count;
+	ccv_nnc_multi_tensor_chunk_t* const chunks = (ccv_nnc_multi_tensor_chunk_t*)(update_norms + chunk_count);
+	float* const rate_trust_ratios = (float*)(chunks + chunk_count);
+	_ccv_nnc_multi_tensor_chunks(inputs, input_size, 4, chunks);
+	ccv_nnc_lamb_parallel_t parallel = {
+		.chunks = chunks,
+		.inputs = inputs,
+		.outputs = outputs,
+		.clip = _ccv_nnc_multi_tensor_clip(cmd.info.lamb.max_norm, 1, inputs, 4, chunks, chunk_count, w_norms),
+		.beta1 = cmd.info.lamb.beta1,
+		.beta2 = cmd.info.lamb.beta2,
+		.decay = cmd.info.lamb.decay,
+		.epsilon = cmd.info.lamb.epsilon,
+		.inv_bias_correction1 = 1. / (1 - powf(cmd.info.lamb.beta1, step)),
+		.inv_bias_correction2 = 1. / (1 - powf(cmd.info.lamb.beta2, step)),
+		.w_norms = w_norms,
+		.update_norms = update_norms,
+		.rate_trust_ratios = rate_trust_ratios,
+	};
+	ccv_nnc_parallel_for(chunk_count, 0, _ccv_nnc_lamb_forw_moment_parallel, &parallel);
+	// Chunks of a parameter are next to each other, add up the partial sums in order.
+	int j = 0;
+	for (i = 0; i < group_count; i++)
+	{
+		double w_norm = 0;
+		double update_norm = 0;
+		for (; j < chunk_count && chunks[j].group == i; j++)
+			w_norm += w_norms[j], update_norm += update_norms[j];
+		w_norm = sqrt(w_norm);
+		update_norm = sqrt(update_norm);
+		const float trust_ratio = w_norm > 0 && update_norm > 0 ? w_norm / update_norm : 1.;
+		rate_trust_ratios[i] = cmd.info.lamb.rate * trust_ratio;
+	}
+	ccv_nnc_parallel_for(chunk_count, 0, _ccv_nnc_lamb_forw_apply_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_LAMB_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_lamb_forw;
+}
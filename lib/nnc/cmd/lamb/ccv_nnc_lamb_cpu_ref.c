@@ -13,10 +13,8 @@
 // Shared methods.
 #include "../_ccv_nnc_cpu_ref.h"
 
-static int _ccv_nnc_lamb_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+static void _ccv_nnc_lamb_forw_cpu_ref(const ccv_nnc_cmd_t cmd, const float clip, ccv_nnc_tensor_t* const* const inputs, ccv_nnc_tensor_t* const* const outputs, ccv_nnc_stream_context_t* const stream_context)
 {
-	assert(input_size == 4);
-	assert(output_size == 3);
 	ccv_nnc_tensor_view_t* const g = (ccv_nnc_tensor_view_t*)inputs[0];
 	ccv_nnc_tensor_view_t* const a = (ccv_nnc_tensor_view_t*)inputs[1];
 	ccv_nnc_tensor_view_t* const m = (ccv_nnc_tensor_view_t*)inputs[2];
@@ -80,7 +78,7 @@ static int _ccv_nnc_lamb_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 			{
 				for (x = 0; x < adim[3]; x++)
 				{
-					const float grad = gp[x];
+					const float grad = clip * gp[x];
 					const float w = ap[x];
 					const float mom = np[x] = beta1 * mp[x] + (1 - beta1) * grad;
 					const float vel = up[x] = beta2 * vp[x] + (1 - beta2) * grad * grad;
@@ -135,6 +133,17 @@ static int _ccv_nnc_lamb_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 		ap += (ainc[1] - adim[1]) * ainc[2] * ainc[3];
 		bp += (binc[1] - adim[1]) * binc[2] * binc[3];
 	}
+}
+
+static int _ccv_nnc_lamb_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	// Multiple parameters can be updated in one command, 4 inputs and 3 outputs each.
+	assert(input_size % 4 == 0);
+	assert(output_size == input_size / 4 * 3);
+	const float clip = _ccv_nnc_gradient_clip_cpu_ref(cmd.info.lamb.max_norm, 1, inputs, input_size, 4);
+	int i;
+	for (i = 0; i < input_size / 4; i++)
+		_ccv_nnc_lamb_forw_cpu_ref(cmd, clip, inputs + i * 4, outputs + i * 3, stream_context);
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
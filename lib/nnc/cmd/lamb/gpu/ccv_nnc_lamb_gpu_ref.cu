@@ -51,10 +51,8 @@ __global__ void _ccv_nnc_lamb_kernel(const size_t tensor_count, const float* con
 	}
 }
 
-static int _ccv_nnc_lamb_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+static void _ccv_nnc_lamb_forw_gpu_ref(const ccv_nnc_cmd_t cmd, ccv_nnc_tensor_t* const* const inputs, ccv_nnc_tensor_t* const* const outputs, ccv_nnc_stream_context_t* const stream_context)
 {
-	assert(input_size == 4);
-	assert(output_size == 3);
 	cudaStream_t stream = ccv_nnc_stream_context_get_stream(stream_context);
 	cublasHandle_t cublas = ccv_nnc_stream_context_get_cublas(stream_context);
 	const int step = cmd.info.lamb.step;
@@ -135,6 +133,19 @@ static int _ccv_nnc_lamb_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 		_ccv_nnc_rate_trust_ratio<<<1, 1, 0, stream>>>(rate, w_norm, update_norm, rate_trust_ratio);
 		_ccv_nnc_lamb_kernel<<<CUDA_GET_BLOCKS(tensor_count), CUDA_NUM_THREADS, 0, stream>>>(tensor_count, rate_trust_ratio, update, a->data.f32, b->data.f32);
 	}
+}
+
+static int _ccv_nnc_lamb_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	// Multiple parameters can be updated in one command, 4 inputs and 3 outputs each.
+	assert(input_size % 4 == 0);
+	assert(output_size == input_size / 4 * 3);
+	// Clipping to the gradient norm across all parameters is not implemented on GPU.
+	if (cmd.info.lamb.max_norm > 0)
+		return CCV_NNC_EXEC_INVALID;
+	int i;
+	for (i = 0; i < input_size / 4; i++)
+		_ccv_nnc_lamb_forw_gpu_ref(cmd, inputs + i * 4, outputs + i * 3, stream_context);
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
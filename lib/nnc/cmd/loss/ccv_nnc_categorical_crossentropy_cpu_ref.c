@@ -3,12 +3,57 @@
 #include "nnc/ccv_nnc.h"
 #include "nnc/ccv_nnc_easy.h"
 #include "nnc/ccv_nnc_internal.h"
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif
-#ifdef USE_DISPATCH
-#include <dispatch/dispatch.h>
-#endif
+
+typedef struct {
+	const ccv_nnc_tensor_t* g;
+	const ccv_nnc_tensor_t* a;
+	const ccv_nnc_tensor_t* b;
+	ccv_nnc_tensor_t* c;
+	int count;
+	int range; // 1 if b is the label, otherwise b is the probability distribution.
+	float trim0;
+	float trim1;
+} ccv_nnc_categorical_crossentropy_parallel_t;
+
+static inline int _ccv_nnc_categorical_crossentropy_label(const ccv_nnc_tensor_t* const b, const int i)
+{
+	return b->info.datatype == CCV_32F ? (int)(b->data.f32[i] + 0.5) : b->data.i32[i];
+}
+
+static void _ccv_nnc_categorical_crossentropy_forw_parallel(void* const context, const int i)
+{
+	const ccv_nnc_categorical_crossentropy_parallel_t* const parallel = (ccv_nnc_categorical_crossentropy_parallel_t*)context;
+	const ccv_nnc_tensor_t* const a = parallel->a;
+	const ccv_nnc_tensor_t* const b = parallel->b;
+	ccv_nnc_tensor_t* const c = parallel->c;
+	const int count = parallel->count;
+	const float trim0 = parallel->trim0;
+	const float trim1 = parallel->trim1;
+	int j;
+	float* const ap = a->data.f32 + i * count;
+	if (parallel->range == 1)
+	{
+		const int label = _ccv_nnc_categorical_crossentropy_label(b, i);
+		assert(label >= 0 && label < count);
+		if (trim0 == 0 && trim1 == 1)
+			c->data.f32[i] = -logf(ap[label]);
+		else {
+			float p = 0;
+			for (j = 0; j < label; j++)
+				p += -trim0 * logf(ap[j]);
+			p += -trim1 * logf(ap[label]);
+			for (j = label + 1; j < count; j++)
+				p += -trim0 * logf(ap[j]);
+			c->data.f32[i] = p;
+		}
+	} else {
+		float p = 0;
+		float* const bp = b->data.f32 + i * count;
+		for (j = 0; j < count; j++)
+			p += -bp[j] * logf(ap[j]);
+		c->data.f32[i] = p;
+	}
+}
 
 static int _ccv_nnc_categorical_crossentropy_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
@@ -24,82 +69,63 @@ static int _ccv_nnc_categorical_crossentropy_forw(const ccv_nnc_cmd_t cmd, const
 	const int batch_size = axis_count < 2 ? 1 : a->info.dim[0];
 	const int count = ccv_nnc_tensor_count(a->info) / batch_size;
 	int i;
-	if (b->info.datatype == CCV_32F)
+	assert(b->info.datatype == CCV_32F || b->info.datatype == CCV_32S);
+	// If has more than 1 axis, then the range is the channel count. Otherwise, if our batch size is 1, then the range is
+	// the channel count. Otherwise, the range is 1 (and the only axis is the batch size).
+	const int range = b->info.datatype == CCV_32S ? 1 : (ccv_nnc_tensor_nd(b->info.dim) > 1 ? ccv_nnc_tensor_get_c(b->info) : (batch_size == 1 ? b->info.dim[0] : 1));
+	if (range == 1)
 	{
-		// If has more than 1 axis, then the range is the channel count. Otherwise, if our batch size is 1, then the range is
-		// the channel count. Otherwise, the range is 1 (and the only axis is the batch size).
-		const int range = ccv_nnc_tensor_nd(b->info.dim) > 1 ? ccv_nnc_tensor_get_c(b->info) : (batch_size == 1 ? b->info.dim[0] : 1);
-		if (range == 1)
-		{
-			for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && b->info.dim[i] > 0; i++)
-				{ assert(b->info.dim[i] == c->info.dim[i]); }
-			const float trim0 = cmd.info.label_smoothing.trim0;
-			const float trim1 = cmd.info.label_smoothing.trim1;
-			if (trim0 == 0 && trim1 == 1)
-			{
-				parallel_for(i, batch_size) {
-					const int label = (int)(b->data.f32[i] + 0.5);
-					assert(label >= 0 && label < count);
-					const float p = a->data.f32[i * count + label];
-					c->data.f32[i] = -logf(p);
-				} parallel_endfor
-			} else {
-				parallel_for(i, batch_size) {
-					const int label = (int)(b->data.f32[i] + 0.5);
-					assert(label >= 0 && label < count);
-					int j;
-					float p = 0;
-					float* const ap = a->data.f32 + i * count;
-					for (j = 0; j < label; j++)
-						p += -trim0 * logf(ap[j]);
-					p += -trim1 * logf(ap[label]);
-					for (j = label + 1; j < count; j++)
-						p += -trim0 * logf(ap[j]);
-					c->data.f32[i] = p;
-				} parallel_endfor
-			}
-		} else {
-			assert(range == count);
-			parallel_for(i, batch_size) {
-				int j;
-				float p = 0;
-				float* const bp = b->data.f32 + i * count;
-				float* const ap = a->data.f32 + i * count;
-				for (j = 0; j < count; j++)
-					p += -bp[j] * logf(ap[j]);
-				c->data.f32[i] = p;
-			} parallel_endfor
-		}
-	} else if (b->info.datatype == CCV_32S) {
 		for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && b->info.dim[i] > 0; i++)
 			{ assert(b->info.dim[i] == c->info.dim[i]); }
-		const float trim0 = cmd.info.label_smoothing.trim0;
-		const float trim1 = cmd.info.label_smoothing.trim1;
+	} else
+		{ assert(range == count); }
+	ccv_nnc_categorical_crossentropy_parallel_t parallel = {
+		.a = a,
+		.b = b,
+		.c = c,
+		.count = count,
+		.range = range,
+		.trim0 = cmd.info.label_smoothing.trim0,
+		.trim1 = cmd.info.label_smoothing.trim1,
+	};
+	ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_categorical_crossentropy_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static void _ccv_nnc_categorical_crossentropy_back_parallel(void* const context, const int i)
+{
+	const ccv_nnc_categorical_crossentropy_parallel_t* const parallel = (ccv_nnc_categorical_crossentropy_parallel_t*)context;
+	const ccv_nnc_tensor_t* const a = parallel->a;
+	const ccv_nnc_tensor_t* const b = parallel->b;
+	ccv_nnc_tensor_t* const h = parallel->c;
+	const int count = parallel->count;
+	const float trim0 = parallel->trim0;
+	const float trim1 = parallel->trim1;
+	// Without g, it is the same as g is 1.
+	const float gp = parallel->g ? parallel->g->data.f32[i] : 1;
+	int j;
+	float* const hp = h->data.f32 + i * count;
+	float* const ap = a->data.f32 + i * count;
+	if (parallel->range == 1)
+	{
+		const int label = _ccv_nnc_categorical_crossentropy_label(b, i);
 		if (trim0 == 0 && trim1 == 1)
 		{
-			parallel_for(i, batch_size) {
-				const int label = b->data.i32[i];
-				assert(label >= 0 && label < count);
-				const float p = a->data.f32[i * count + label];
-				c->data.f32[i] = -logf(p);
-			} parallel_endfor
+			for (j = 0; j < count; j++)
+				hp[j] = 0;
+			hp[label] = -gp / ap[label];
 		} else {
-			parallel_for(i, batch_size) {
-				const int label = b->data.i32[i];
-				assert(label >= 0 && label < count);
-				int j;
-				float p = 0;
-				float* const ap = a->data.f32 + i * count;
-				for (j = 0; j < label; j++)
-					p += -trim0 * logf(ap[j]);
-				p += -trim1 * logf(ap[label]);
-				for (j = label + 1; j < count; j++)
-					p += -trim0 * logf(ap[j]);
-				c->data.f32[i] = p;
-			} parallel_endfor
+			for (j = 0; j < label; j++)
+				hp[j] = -gp * trim0 / ap[j];
+			hp[label] = -gp * trim1 / ap[label];
+			for (j = label + 1; j < count; j++)
+				hp[j] = -gp * trim0 / ap[j];
 		}
+	} else {
+		float* const bp = b->data.f32 + i * count;
+		for (j = 0; j < count; j++)
+			hp[j] = -gp * bp[j] / ap[j];
 	}
-	return CCV_NNC_EXEC_SUCCESS;
 }
 
 static int _ccv_nnc_categorical_crossentropy_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
@@ -118,169 +144,27 @@ static int _ccv_nnc_categorical_crossentropy_back(const ccv_nnc_cmd_t cmd, const
 	const int batch_size = axis_count < 2 ? 1 : a->info.dim[0];
 	const int count = ccv_nnc_tensor_count(a->info) / batch_size;
 	int i;
-	if (g)
+	assert(b->info.datatype == CCV_32F || b->info.datatype == CCV_32S);
+	// If has more than 1 axis, then the range is the channel count. Otherwise, if our batch size is 1, then the range is
+	// the channel count. Otherwise, the range is 1 (and the only axis is the batch size).
+	const int range = b->info.datatype == CCV_32S ? 1 : (ccv_nnc_tensor_nd(b->info.dim) > 1 ? ccv_nnc_tensor_get_c(b->info) : (batch_size == 1 ? b->info.dim[0] : 1));
+	if (range == 1)
 	{
-		if (b->info.datatype == CCV_32F)
-		{
-			// If has more than 1 axis, then the range is the channel count. Otherwise, if our batch size is 1, then the range is
-			// the channel count. Otherwise, the range is 1 (and the only axis is the batch size).
-			const int range = ccv_nnc_tensor_nd(b->info.dim) > 1 ? ccv_nnc_tensor_get_c(b->info) : (batch_size == 1 ? b->info.dim[0] : 1);
-			if (range == 1)
-			{
-				for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
-					{ assert(a->info.dim[i] == h->info.dim[i]); }
-				const float trim0 = cmd.info.label_smoothing.trim0;
-				const float trim1 = cmd.info.label_smoothing.trim1;
-				if (trim0 == 0 && trim1 == 1)
-				{
-					parallel_for(i, batch_size) {
-						int j;
-						const float gp = g->data.f32[i];
-						const int label = (int)(b->data.f32[i] + 0.5);
-						float* const hp = h->data.f32 + i * count;
-						for (j = 0; j < count; j++)
-							hp[j] = 0;
-						const float p = a->data.f32[i * count + label];
-						hp[label] = -gp / p;
-					} parallel_endfor
-				} else {
-					parallel_for(i, batch_size) {
-						int j;
-						const float gp = g->data.f32[i];
-						const int label = (int)(b->data.f32[i] + 0.5);
-						float* const hp = h->data.f32 + i * count;
-						float* const ap = a->data.f32 + i * count;
-						for (j = 0; j < label; j++)
-							hp[j] = -gp * trim0 / ap[j];
-						hp[label] = -gp * trim1 / ap[label];
-						for (j = label + 1; j < count; j++)
-							hp[j] = -gp * trim0 / ap[j];
-					} parallel_endfor
-				}
-			} else {
-				assert(range == count);
-				parallel_for(i, batch_size) {
-					int j;
-					const float gp = g->data.f32[i];
-					float* const hp = h->data.f32 + i * count;
-					float* const ap = a->data.f32 + i * count;
-					float* const bp = b->data.f32 + i * count;
-					for (j = 0; j < count; j++)
-						hp[j] = -gp * bp[j] / ap[j];
-				} parallel_endfor
-			}
-		} else if (b->info.datatype == CCV_32S) {
-			for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
-				{ assert(a->info.dim[i] == h->info.dim[i]); }
-			const float trim0 = cmd.info.label_smoothing.trim0;
-			const float trim1 = cmd.info.label_smoothing.trim1;
-			if (trim0 == 0 && trim1 == 1)
-			{
-				parallel_for(i, batch_size) {
-					int j;
-					const float gp = g->data.f32[i];
-					const int label = b->data.i32[i];
-					float* const hp = h->data.f32 + i * count;
-					for (j = 0; j < count; j++)
-						hp[j] = 0;
-					const float p = a->data.f32[i * count + label];
-					hp[label] = -gp / p;
-				} parallel_endfor
-			} else {
-				parallel_for(i, batch_size) {
-					int j;
-					const float gp = g->data.f32[i];
-					const int label = b->data.i32[i];
-					float* const hp = h->data.f32 + i * count;
-					float* const ap = a->data.f32 + i * count;
-					for (j = 0; j < label; j++)
-						hp[j] = -gp * trim0 / ap[j];
-					hp[label] = -gp * trim1 / ap[label];
-					for (j = label + 1; j < count; j++)
-						hp[j] = -gp * trim0 / ap[j];
-				} parallel_endfor
-			}
-		}
-	} else {
-		if (b->info.datatype == CCV_32F)
-		{
-			// If has more than 1 axis, then the range is the channel count. Otherwise, if our batch size is 1, then the range is
-			// the channel count. Otherwise, the range is 1 (and the only axis is the batch size).
-			const int range = ccv_nnc_tensor_nd(b->info.dim) > 1 ? ccv_nnc_tensor_get_c(b->info) : (batch_size == 1 ? b->info.dim[0] : 1);
-			if (range == 1)
-			{
-				for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
-					{ assert(a->info.dim[i] == h->info.dim[i]); }
-				const float trim0 = cmd.info.label_smoothing.trim0;
-				const float trim1 = cmd.info.label_smoothing.trim1;
-				if (trim0 == 0 && trim1 == 1)
-				{
-					parallel_for(i, batch_size) {
-						int j;
-						const int label = (int)(b->data.f32[i] + 0.5);
-						float* const hp = h->data.f32 + i * count;
-						for (j = 0; j < count; j++)
-							hp[j] = 0;
-						const float p = a->data.f32[i * count + label];
-						hp[label] = -1. / p;
-					} parallel_endfor
-				} else {
-					parallel_for(i, batch_size) {
-						int j;
-						const int label = (int)(b->data.f32[i] + 0.5);
-						float* const hp = h->data.f32 + i * count;
-						float* const ap = a->data.f32 + i * count;
-						for (j = 0; j < label; j++)
-							hp[j] = -trim0 / ap[j];
-						hp[label] = -trim1 / ap[label];
-						for (j = label + 1; j < count; j++)
-							hp[j] = -trim0 / ap[j];
-					} parallel_endfor
-				}
-			} else {
-				assert(range == count);
-				parallel_for(i, batch_size) {
-					int j;
-					float* const hp = h->data.f32 + i * count;
-					float* const ap = a->data.f32 + i * count;
-					float* const bp = b->data.f32 + i * count;
-					for (j = 0; j < count; j++)
-						hp[j] = -bp[j] / ap[j];
-				} parallel_endfor
-			}
-		} else if (b->info.datatype == CCV_32S) {
-			const float trim0 = cmd.info.label_smoothing.trim0;
-			const float trim1 = cmd.info.label_smoothing.trim1;
-			if (trim0 == 0 && trim1 == 1)
-			{
-				for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
-					{ assert(a->info.dim[i] == h->info.dim[i]); }
-				parallel_for(i, batch_size) {
-					int j;
-					const int label = b->data.i32[i];
-					float* const hp = h->data.f32 + i * count;
-					for (j = 0; j < count; j++)
-						hp[j] = 0;
-					const float p = a->data.f32[i * count + label];
-					hp[label] = -1. / p;
-				} parallel_endfor
-			} else {
-				for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
-					{ assert(a->info.dim[i] == h->info.dim[i]); }
-				parallel_for(i, batch_size) {
-					int j;
-					const int label = b->data.i32[i];
-					float* const hp = h->data.f32 + i * count;
-					float* const ap = a->data.f32 + i * count;
-					for (j = 0; j < label; j++)
-						hp[j] = -trim0 / ap[j];
-					hp[label] = -trim1 / ap[label];
-					for (j = label + 1; j < count; j++)
-						hp[j] = -trim0 / ap[j];
-				} parallel_endfor
-			}
-		}
-	}
+		for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
+			{ assert(a->info.dim[i] == h->info.dim[i]); }
+	} else
+		{ assert(range == count); }
+	ccv_nnc_categorical_crossentropy_parallel_t parallel = {
+		.g = g,
+		.a = a,
+		.b = b,
+		.c = h,
+		.count = count,
+		.range = range,
+		.trim0 = cmd.info.label_smoothing.trim0,
+		.trim1 = cmd.info.label_smoothing.trim1,
+	};
+	ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_categorical_crossentropy_back_parallel, &parallel);
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
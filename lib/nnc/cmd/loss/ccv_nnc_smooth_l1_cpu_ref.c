@@ -3,12 +3,54 @@
 #include "nnc/ccv_nnc.h"
 #include "nnc/ccv_nnc_easy.h"
 #include "nnc/ccv_nnc_internal.h"
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif
-#ifdef USE_DISPATCH
-#include <dispatch/dispatch.h>
-#endif
+
+typedef struct {
+	const ccv_nnc_tensor_view_t* g;
+	const ccv_nnc_tensor_view_t* a;
+	const ccv_nnc_tensor_view_t* b;
+	const ccv_nnc_tensor_view_t* c;
+	ccv_nnc_tensor_view_t* h;
+	int count;
+	int astep;
+	int bstep;
+	int cstep;
+	int gstep;
+	int hstep;
+	float beta;
+	float beta_2;
+	float beta_inv_2;
+	float inv_beta;
+} ccv_nnc_smooth_l1_parallel_t;
+
+static void _ccv_nnc_smooth_l1_forw_parallel(void* const context, const int i)
+{
+	const ccv_nnc_smooth_l1_parallel_t* const parallel = (ccv_nnc_smooth_l1_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	const ccv_nnc_tensor_view_t* const b = parallel->b;
+	const ccv_nnc_tensor_view_t* const c = parallel->c;
+	const int count = parallel->count;
+	const int astep = parallel->astep;
+	const int bstep = parallel->bstep;
+	const int cstep = parallel->cstep;
+	const float beta = parallel->beta;
+	const float beta_2 = parallel->beta_2;
+	const float beta_inv_2 = parallel->beta_inv_2;
+	int j;
+	const float* const ap = a->data.f32 + i * astep;
+	const float* const bp = b->data.f32 + i * bstep;
+	float cp = 0;
+	for (j = 0; j < count; j++)
+		cp += fabs(bp[j] - ap[j]);
+	if (cp < beta)
+	{
+		cp = 0;
+		for (j = 0; j < count; j++)
+			cp += (bp[j] - ap[j]) * (bp[j] - ap[j]);
+		cp *= beta_inv_2;
+	} else
+		cp -= beta_2;
+	c->data.f32[i * cstep] = cp;
+}
 
 static int _ccv_nnc_smooth_l1_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
@@ -37,26 +79,82 @@ static int _ccv_nnc_smooth_l1_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t
 	const float beta = cmd.info.smooth_l1.beta;
 	const float beta_inv_2 = 0.5 / beta;
 	const float beta_2 = 0.5 * beta;
-	parallel_for(i, batch_size) {
-		int j;
-		const float* const ap = a->data.f32 + i * astep;
-		const float* const bp = b->data.f32 + i * bstep;
-		float cp = 0;
-		for (j = 0; j < count; j++)
-			cp += fabs(bp[j] - ap[j]);
-		if (cp < beta)
-		{
-			cp = 0;
-			for (j = 0; j < count; j++)
-				cp += (bp[j] - ap[j]) * (bp[j] - ap[j]);
-			cp *= beta_inv_2;
-		} else
-			cp -= beta_2;
-		c->data.f32[i * cstep] = cp;
-	} parallel_endfor
+	ccv_nnc_smooth_l1_parallel_t parallel = {
+		.a = a,
+		.b = b,
+		.c = c,
+		.count = count,
+		.astep = astep,
+		.bstep = bstep,
+		.cstep = cstep,
+		.beta = beta,
+		.beta_2 = beta_2,
+		.beta_inv_2 = beta_inv_2,
+	};
+	ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_smooth_l1_forw_parallel, &parallel);
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
+static void _ccv_nnc_smooth_l1_back_parallel(void* const context, const int i)
+{
+	const ccv_nnc_smooth_l1_parallel_t* const parallel = (ccv_nnc_smooth_l1_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const g = parallel->g;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	const ccv_nnc_tensor_view_t* const b = parallel->b;
+	const ccv_nnc_tensor_view_t* const c = parallel->c;
+	ccv_nnc_tensor_view_t* const h = parallel->h;
+	const int count = parallel->count;
+	const int astep = parallel->astep;
+	const int bstep = parallel->bstep;
+	const int cstep = parallel->cstep;
+	const int gstep = parallel->gstep;
+	const int hstep = parallel->hstep;
+	const float beta_2 = parallel->beta_2;
+	const float inv_beta = parallel->inv_beta;
+	int j;
+	const float cp = c->data.f32[i * cstep];
+	const float* const ap = a->data.f32 + i * astep;
+	const float* const bp = b->data.f32 + i * bstep;
+	float* const hp = h->data.f32 + i * hstep;
+	if (cp < beta_2)
+	{
+		const float gp = inv_beta * g->data.f32[i * gstep];
+		for (j = 0; j < count; j++)
+			hp[j] = gp * (ap[j] - bp[j]);
+	} else {
+		const float gp = g->data.f32[i * gstep];
+		for (j = 0; j < count; j++)
+			hp[j] = ((ap[j] - bp[j]) > 0 ? 1 : -1) * gp;
+	}
+}
+
+static void _ccv_nnc_smooth_l1_back_no_g_parallel(void* const context, const int i)
+{
+	const ccv_nnc_smooth_l1_parallel_t* const parallel = (ccv_nnc_smooth_l1_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	const ccv_nnc_tensor_view_t* const b = parallel->b;
+	const ccv_nnc_tensor_view_t* const c = parallel->c;
+	ccv_nnc_tensor_view_t* const h = parallel->h;
+	const int count = parallel->count;
+	const int astep = parallel->astep;
+	const int bstep = parallel->bstep;
+	const int cstep = parallel->cstep;
+	const int hstep = parallel->hstep;
+	const float beta_2 = parallel->beta_2;
+	const float inv_beta = parallel->inv_beta;
+	int j;
+	const float cp = c->data.f32[i * cstep];
+	const float* const ap = a->data.f32 + i * astep;
+	const float* const bp = b->data.f32 + i * bstep;
+	float* const hp = h->data.f32 + i * hstep;
+	if (cp < beta_2)
+		for (j = 0; j < count; j++)
+			hp[j] = inv_beta * (ap[j] - bp[j]);
+	else
+		for (j = 0; j < count; j++)
+			hp[j] = (ap[j] - bp[j]) > 0 ? 1 : -1;
+}
+
 static int _ccv_nnc_smooth_l1_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
 	assert(input_size >= 3);
@@ -96,37 +194,37 @@ static int _ccv_nnc_smooth_l1_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t
 		ccv_nnc_tensor_view_get_inc(g, ginc);
 		assert(ccv_nnc_tensor_count(g->info) == batch_size);
 		const int gstep = ccv_nnc_tensor_nd(g->info.dim) == 1 ? 1 : ginc[CCV_NNC_MAX_DIM + 1];
-		parallel_for(i, batch_size) {
-			int j;
-			const float cp = c->data.f32[i * cstep];
-			const float* const ap = a->data.f32 + i * astep;
-			const float* const bp = b->data.f32 + i * bstep;
-			float* const hp = h->data.f32 + i * hstep;
-			if (cp < beta_2)
-			{
-				const float gp = inv_beta * g->data.f32[i * gstep];
-				for (j = 0; j < count; j++)
-					hp[j] = gp * (ap[j] - bp[j]);
-			} else {
-				const float gp = g->data.f32[i * gstep];
-				for (j = 0; j < count; j++)
-					hp[j] = ((ap[j] - bp[j]) > 0 ? 1 : -1) * gp;
-			}
-		} parallel_endfor
+		ccv_nnc_smooth_l1_parallel_t parallel = {
+			.g = g,
+			.a = a,
+			.b = b,
+			.c = c,
+			.h = h,
+			.count = count,
+			.astep = astep,
+			.bstep = bstep,
+			.cstep = cstep,
+			.gstep = gstep,
+			.hstep = hstep,
+			.beta_2 = beta_2,
+			.inv_beta = inv_beta,
+		};
+		ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_smooth_l1_back_parallel, &parallel);
 	} else {
-		parallel_for(i, batch_size) {
-			int j;
-			const float cp = c->data.f32[i * cstep];
-			const float* const ap = a->data.f32 + i * astep;
-			const float* const bp = b->data.f32 + i * bstep;
-			float* const hp = h->data.f32 + i * hstep;
-			if (cp < beta_2)
-				for (j = 0; j < count; j++)
-					hp[j] = inv_beta * (ap[j] - bp[j]);
-			else
-				for (j = 0; j < count; j++)
-					hp[j] = (ap[j] - bp[j]) > 0 ? 1 : -1;
-		} parallel_endfor
+		ccv_nnc_smooth_l1_parallel_t parallel = {
+			.a = a,
+			.b = b,
+			.c = c,
+			.h = h,
+			.count = count,
+			.astep = astep,
+			.bstep = bstep,
+			.cstep = cstep,
+			.hstep = hstep,
+			.beta_2 = beta_2,
+			.inv_beta = inv_beta,
+		};
+		ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_smooth_l1_back_no_g_parallel, &parallel);
 	}
 	return CCV_NNC_EXEC_SUCCESS;
 }
@@ -0,0 +1,241 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#endif
+
+typedef struct {
+	float score;
+	int idx;
+} ccv_nnc_nms_key_t;
+
+#define less_than(a, b, aux) ((a).score > (b).score)
+CCV_IMPLEMENT_QSORT(_ccv_nnc_nms_sortby_score, ccv_nnc_nms_key_t, less_than)
+#undef less_than
+
+typedef struct {
+	const ccv_nnc_tensor_view_t* a;
+	ccv_nnc_tensor_view_t* b;
+	ccv_nnc_tensor_view_t* c;
+	int aninc;
+	int bninc;
+	int cninc;
+	int m;
+	int k; // Number of boxes considered after the top-k pre-filter.
+	int gk; // Number of 64-bit words for a bitmask of k boxes.
+	int d;
+	int aminc;
+	int bminc;
+	float iou_threshold;
+	size_t workspace_size; // Scratch space per batch.
+	unsigned char* workspace;
+} ccv_nnc_nms_parallel_t;
+
+static inline void _ccv_nnc_nms_suppress(const float* const x1, const float* const y1, const float* const x2, const float* const y2, const float* const area, const int x, const int start, const int k, const float iou_threshold, uint64_t* const removed)
+{
+	int y = start;
+#if defined(HAVE_SSE2)
+	const __m128 bx1 = _mm_set1_ps(x1[x]);
+	const __m128 by1 = _mm_set1_ps(y1[x]);
+	const __m128 bx2 = _mm_set1_ps(x2[x]);
+	const __m128 by2 = _mm_set1_ps(y2[x]);
+	const __m128 barea = _mm_set1_ps(area[x]);
+	const __m128 threshold = _mm_set1_ps(iou_threshold);
+	const __m128 zero = _mm_setzero_ps();
+	for (; y < k - 3; y += 4)
+	{
+		const __m128 xdiff = _mm_max_ps(zero, _mm_sub_ps(_mm_min_ps(bx2, _mm_loadu_ps(x2 + y)), _mm_max_ps(bx1, _mm_loadu_ps(x1 + y))));
+		const __m128 ydiff = _mm_max_ps(zero, _mm_sub_ps(_mm_min_ps(by2, _mm_loadu_ps(y2 + y)), _mm_max_ps(by1, _mm_loadu_ps(y1 + y))));
+		const __m128 intersection = _mm_mul_ps(xdiff, ydiff);
+		const __m128 iou = _mm_div_ps(intersection, _mm_sub_ps(_mm_add_ps(barea, _mm_loadu_ps(area + y)), intersection));
+		const uint64_t mask = _mm_movemask_ps(_mm_cmpge_ps(iou, threshold));
+		if (!mask)
+			continue;
+		// y is a multiple of 4 relative to start, which is not necessarily aligned to the 64-bit word, thus, may straddle two words.
+		removed[y >> 6] |= mask << (y & 63);
+		if ((y & 63) > 60)
+			removed[(y >> 6) + 1] |= mask >> (64 - (y & 63));
+	}
+#endif
+	for (; y < k; y++)
+	{
+		const float xdiff = ccv_max(0, ccv_min(x2[x], x2[y]) - ccv_max(x1[x], x1[y]));
+		const float ydiff = ccv_max(0, ccv_min(y2[x], y2[y]) - ccv_max(y1[x], y1[y]));
+		const float intersection = xdiff * ydiff;
+		const float iou = intersection / (area[x] + area[y] - intersection);
+		if (iou >= iou_threshold)
+			removed[y >> 6] |= (uint64_t)1 << (y & 63);
+	}
+}
+
+typedef struct {
+	ccv_nnc_nms_key_t* keys;
+	uint64_t* removed; // Suppression bitmask of the sorted boxes.
+	uint64_t* iou_mask; // Row x is the bitmask of boxes after x overlapping with x.
+	float* x1;
+	float* y1;
+	float* x2;
+	float* y2;
+	float* area;
+} ccv_nnc_nms_workspace_t;
+
+static ccv_nnc_nms_workspace_t _ccv_nnc_nms_workspace(const ccv_nnc_nms_parallel_t* const parallel, const int i)
+{
+	const int k = parallel->k;
+	ccv_nnc_nms_workspace_t workspace;
+	workspace.keys = (ccv_nnc_nms_key_t*)(parallel->workspace + parallel->workspace_size * i);
+	workspace.removed = (uint64_t*)(workspace.keys + parallel->m);
+	workspace.iou_mask = workspace.removed + parallel->gk;
+	workspace.x1 = (float*)(workspace.iou_mask + (size_t)k * parallel->gk);
+	workspace.y1 = workspace.x1 + k;
+	workspace.x2 = workspace.y1 + k;
+	workspace.y2 = workspace.x2 + k;
+	workspace.area = workspace.y2 + k;
+	return workspace;
+}
+
+static void _ccv_nnc_nms_sort_parallel(void* const context, const int i)
+{
+	const ccv_nnc_nms_parallel_t* const parallel = (ccv_nnc_nms_parallel_t*)context;
+	const int m = parallel->m;
+	const int k = parallel->k;
+	const int aminc = parallel->aminc;
+	const float* const ap = parallel->a->data.f32 + i * parallel->aninc;
+	const ccv_nnc_nms_workspace_t workspace = _ccv_nnc_nms_workspace(parallel, i);
+	int x;
+	// Sort once, then lay out the coordinates of the top k boxes in SoA form for the IoU computation.
+	for (x = 0; x < m; x++)
+		workspace.keys[x].score = ap[x * aminc], workspace.keys[x].idx = x;
+	_ccv_nnc_nms_sortby_score(workspace.keys, m, 0);
+	memset(workspace.removed, 0, sizeof(uint64_t) * parallel->gk);
+	for (x = 0; x < k; x++)
+	{
+		const float* const box = ap + workspace.keys[x].idx * aminc;
+		workspace.x1[x] = box[1];
+		workspace.y1[x] = box[2];
+		workspace.x2[x] = box[1] + box[3];
+		workspace.y2[x] = box[2] + box[4];
+		workspace.area[x] = box[3] * box[4];
+		if (box[0] == -FLT_MAX) // Suppressed.
+			workspace.removed[x >> 6] |= (uint64_t)1 << (x & 63);
+	}
+}
+
+static void _ccv_nnc_nms_iou_mask_parallel(void* const context, const int i)
+{
+	const ccv_nnc_nms_parallel_t* const parallel = (ccv_nnc_nms_parallel_t*)context;
+	// Rows of all images are computed in parallel, they don't depend on each other.
+	const int k = parallel->k;
+	const int x = i % k;
+	const ccv_nnc_nms_workspace_t workspace = _ccv_nnc_nms_workspace(parallel, i / k);
+	uint64_t* const row = workspace.iou_mask + (size_t)x * parallel->gk;
+	memset(row, 0, sizeof(uint64_t) * parallel->gk);
+	if (!(workspace.removed[x >> 6] & ((uint64_t)1 << (x & 63))))
+		_ccv_nnc_nms_suppress(workspace.x1, workspace.y1, workspace.x2, workspace.y2, workspace.area, x, x + 1, k, parallel->iou_threshold, row);
+}
+
+static void _ccv_nnc_nms_forw_parallel(void* const context, const int i)
+{
+	const ccv_nnc_nms_parallel_t* const parallel = (ccv_nnc_nms_parallel_t*)context;
+	const int m = parallel->m;
+	const int k = parallel->k;
+	const int gk = parallel->gk;
+	const int d = parallel->d;
+	const int aminc = parallel->aminc;
+	const int bminc = parallel->bminc;
+	const float* const ap = parallel->a->data.f32 + i * parallel->aninc;
+	float* const bp = parallel->b->data.f32 + i * parallel->bninc;
+	int* const cp = parallel->c->data.i32 + i * parallel->cninc;
+	const ccv_nnc_nms_workspace_t workspace = _ccv_nnc_nms_workspace(parallel, i);
+	const ccv_nnc_nms_key_t* const keys = workspace.keys;
+	uint64_t* const removed = workspace.removed;
+	int x, y;
+	// Only this pass is sequential, a kept box suppresses the boxes its row overlaps with.
+	for (x = 0; x < k; x++)
+		if (!(removed[x >> 6] & ((uint64_t)1 << (x & 63))))
+		{
+			const uint64_t* const row = workspace.iou_mask + (size_t)x * gk;
+			for (y = x >> 6; y < gk; y++)
+				removed[y] |= row[y];
+		}
+	// Kept boxes first, in the sorted order, then the suppressed ones.
+	for (x = 0, y = 0; x < k; x++)
+		if (!(removed[x >> 6] & ((uint64_t)1 << (x & 63))))
+		{
+			memcpy(bp + y * bminc, ap + keys[x].idx * aminc, sizeof(float) * d);
+			cp[y] = keys[x].idx;
+			++y;
+		}
+	for (x = 0; x < m; x++)
+		if (x >= k || (removed[x >> 6] & ((uint64_t)1 << (x & 63))))
+		{
+			memcpy(bp + y * bminc, ap + keys[x].idx * aminc, sizeof(float) * d);
+			bp[y * bminc] = -FLT_MAX;
+			cp[y] = -1;
+			++y;
+		}
+}
+
+static int _ccv_nnc_nms_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 1);
+	const ccv_nnc_tensor_view_t* a = (ccv_nnc_tensor_view_t*)inputs[0];
+	assert(output_size == 2);
+	ccv_nnc_tensor_view_t* b = (ccv_nnc_tensor_view_t*)outputs[0];
+	ccv_nnc_tensor_view_t* c = (ccv_nnc_tensor_view_t*)outputs[1];
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	const int c_nd = ccv_nnc_tensor_nd(c->info.dim);
+	assert(a_nd == b_nd);
+	int i;
+	for (i = 0; i < a_nd; i++)
+		{ assert(a->info.dim[i] == b->info.dim[i]); }
+	const int d = a_nd <= 1 ? 1 : a->info.dim[a_nd - 1];
+	if (d < 5 || a->data.f32 == b->data.f32) // Need the input to gather from.
+		return CCV_NNC_EXEC_INVALID;
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? a->inc : a->info.dim;
+	const int* binc = CCV_IS_TENSOR_VIEW(b) ? b->inc : b->info.dim;
+	const int* cinc = CCV_IS_TENSOR_VIEW(c) ? c->inc : c->info.dim;
+	const int n = a_nd >= 3 ? a->info.dim[0] : 1;
+	const int m = a_nd >= 3 ? a->info.dim[1] : a->info.dim[0];
+	if (c_nd == 1)
+		{ assert(m == c->info.dim[0]); }
+	else
+		{ assert(c_nd == 2 && n == c->info.dim[0] && m == c->info.dim[1]); }
+	const int k = cmd.info.nms.top_k > 0 ? ccv_min(cmd.info.nms.top_k, m) : m;
+	const int gk = (k + 63) >> 6;
+	const size_t workspace_size = ((sizeof(ccv_nnc_nms_key_t) * m + sizeof(uint64_t) * gk * (k + 1) + sizeof(float) * 5 * k) + 15) & -16;
+	ccv_nnc_nms_parallel_t parallel = {
+		.a = a,
+		.b = b,
+		.c = c,
+		.aninc = a_nd >= 3 ? ainc[1] * ainc[2] : 0,
+		.bninc = b_nd >= 3 ? binc[1] * binc[2] : 0,
+		.cninc = c_nd >= 2 ? cinc[1] : 0,
+		.m = m,
+		.k = k,
+		.gk = gk,
+		.d = d,
+		.aminc = ainc[a_nd - 1],
+		.bminc = binc[b_nd - 1],
+		.iou_threshold = cmd.info.nms.iou_threshold,
+		.workspace_size = workspace_size,
+		.workspace = (unsigned char*)ccv_nnc_stream_context_get_workspace(stream_context, workspace_size * n, CCV_TENSOR_CPU_MEMORY),
+	};
+	ccv_nnc_parallel_for(n, 0, _ccv_nnc_nms_sort_parallel, &parallel);
+	ccv_nnc_parallel_for(n * k, 0, _ccv_nnc_nms_iou_mask_parallel, &parallel);
+	ccv_nnc_parallel_for(n, 0, _ccv_nnc_nms_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_NMS_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW;
+	registry->tensor_datatypes = CCV_32F | CCV_32S;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_nms_forw;
+}
@@ -3,12 +3,6 @@
 #include "nnc/ccv_nnc.h"
 #include "nnc/ccv_nnc_easy.h"
 #include "nnc/ccv_nnc_internal.h"
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif
-#ifdef USE_DISPATCH
-#include <dispatch/dispatch.h>
-#endif
 
 typedef struct {
 	float v[5];
@@ -26,6 +20,162 @@ CCV_IMPLEMENT_QSORT_EX(_ccv_nnc_nms_sortby_f5_32f, float5, less_than, swap_func,
 #undef less_than
 #undef swap_func
 
+typedef struct {
+	const ccv_nnc_tensor_view_t* a;
+	ccv_nnc_tensor_view_t* b;
+	ccv_nnc_tensor_view_t* c;
+	int aninc;
+	int bninc;
+	int cninc;
+	int m;
+	int d;
+	int aminc;
+	int bminc;
+	int top_k;
+	float iou_threshold;
+} ccv_nnc_nms_parallel_t;
+
+static void _ccv_nnc_nms_forw_f5_parallel(void* const context, const int i)
+{
+	const ccv_nnc_nms_parallel_t* const parallel = (ccv_nnc_nms_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	ccv_nnc_tensor_view_t* const b = parallel->b;
+	ccv_nnc_tensor_view_t* const c = parallel->c;
+	const int aninc = parallel->aninc;
+	const int bninc = parallel->bninc;
+	const int cninc = parallel->cninc;
+	const int m = parallel->m;
+	const int d = parallel->d;
+	const float iou_threshold = parallel->iou_threshold;
+	int x, y;
+	const float* const ap = a->data.f32 + i * aninc;
+	float* const bp = b->data.f32 + i * bninc;
+	int* const cp = c->data.i32 + i * cninc;
+	for (x = 0; x < m; x++)
+		cp[x] = x;
+	for (x = 0; x < m * d; x++)
+		bp[x] = ap[x];
+	_ccv_nnc_nms_sortby_f5_32f((float5*)bp, m, cp);
+	for (x = parallel->top_k; x < m; x++) // Outside of the top k, suppressed.
+		bp[x * 5] = -FLT_MAX;
+	for (x = 0; x < m; x++)
+	{
+		float v = bp[x * 5];
+		if (v == -FLT_MAX) // Suppressed.
+			continue;
+		const float area1 = bp[x * 5 + 3] * bp[x * 5 + 4];
+		for (y = x + 1; y < m; y++)
+		{
+			const float u = bp[y * 5];
+			if (u == -FLT_MAX) // Suppressed.
+				continue;
+			const float area2 = bp[y * 5 + 3] * bp[y * 5 + 4];
+			const float xdiff = ccv_max(0, ccv_min(bp[x * 5 + 1] + bp[x * 5 + 3], bp[y * 5 + 1] + bp[y * 5 + 3]) - ccv_max(bp[x * 5 + 1], bp[y * 5 + 1]));
+			const float ydiff = ccv_max(0, ccv_min(bp[x * 5 + 2] + bp[x * 5 + 4], bp[y * 5 + 2] + bp[y * 5 + 4]) - ccv_max(bp[x * 5 + 2], bp[y * 5 + 2]));
+			const float intersection = xdiff * ydiff;
+			const float iou = intersection / (area1 + area2 - intersection);
+			if (iou >= iou_threshold)
+				bp[y * 5] = -FLT_MAX;
+		}
+	}
+	// Move these values up and move suppressed to the end.
+	for (x = 0, y = 0; x < m; x++)
+		if (bp[x * 5] != -FLT_MAX)
+		{
+			int j;
+			if (x != y)
+			{
+				for (j = 0; j < 5; j++)
+					bp[y * 5 + j] = bp[x * 5 + j];
+				cp[y] = cp[x];
+			}
+			++y;
+		}
+	for (x = y; x < m; x++)
+		cp[x] = -1, bp[x * 5] = -FLT_MAX;
+}
+
+static void _ccv_nnc_nms_forw_parallel(void* const context, const int i)
+{
+	const ccv_nnc_nms_parallel_t* const parallel = (ccv_nnc_nms_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	ccv_nnc_tensor_view_t* const b = parallel->b;
+	ccv_nnc_tensor_view_t* const c = parallel->c;
+	const int aninc = parallel->aninc;
+	const int bninc = parallel->bninc;
+	const int cninc = parallel->cninc;
+	const int m = parallel->m;
+	const int d = parallel->d;
+	const int aminc = parallel->aminc;
+	const int bminc = parallel->bminc;
+	const float iou_threshold = parallel->iou_threshold;
+	int x, y;
+	const float* const ap = a->data.f32 + i * aninc;
+	float* const bp = b->data.f32 + i * bninc;
+	int* const cp = c->data.i32 + i * cninc;
+	for (x = 0; x < m; x++)
+		cp[x] = x;
+	for (x = 0; x < m; x++)
+		for (y = 0; y < d; y++)
+			bp[x * bminc + y] = ap[x * aminc + y];
+	for (x = 0; x < m; x++)
+	{
+		float v = bp[x * bminc];
+		int k = x;
+		for (y = x + 1; y < m; y++)
+		{
+			const float u = bp[y * bminc];
+			if (u > v)
+				k = y, v = u;
+		}
+		for (y = 0; y < d; y++)
+		{
+			const float t = bp[k * bminc + y];
+			bp[k * bminc + y] = bp[x * bminc + y];
+			bp[x * bminc + y] = t;
+			const int u = cp[k];
+			cp[k] = cp[x];
+			cp[x] = u;
+		}
+	}
+	for (x = parallel->top_k; x < m; x++) // Outside of the top k, suppressed.
+		bp[x * bminc] = -FLT_MAX;
+	for (x = 0; x < m; x++)
+	{
+		float v = bp[x * bminc];
+		if (v == -FLT_MAX) // Suppressed.
+			continue;
+		const float area1 = bp[x * bminc + 3] * bp[x * bminc + 4];
+		for (y = x + 1; y < m; y++)
+		{
+			const float u = bp[y * bminc];
+			if (u == -FLT_MAX) // Suppressed.
+				continue;
+			const float area2 = bp[y * bminc + 3] * bp[y * bminc + 4];
+			const float xdiff = ccv_max(0, ccv_min(bp[x * bminc + 1] + bp[x * bminc + 3], bp[y * bminc + 1] + bp[y * bminc + 3]) - ccv_max(bp[x * bminc + 1], bp[y * bminc + 1]));
+			const float ydiff = ccv_max(0, ccv_min(bp[x * bminc + 2] + bp[x * bminc + 4], bp[y * bminc + 2] + bp[y * bminc + 4]) - ccv_max(bp[x * bminc + 2], bp[y * bminc + 2]));
+			const float intersection = xdiff * ydiff;
+			const float iou = intersection / (area1 + area2 - intersection);
+			if (iou >= iou_threshold)
+				bp[y * bminc] = -FLT_MAX;
+		}
+	}
+	for (x = 0, y = 0; x < m; x++)
+		if (bp[x * bminc] != -FLT_MAX)
+		{
+			int j;
+			if (x != y)
+			{
+				for (j = 0; j < 5; j++)
+					bp[y * bminc + j] = bp[x * bminc + j];
+				cp[y] = cp[x];
+			}
+			++y;
+		}
+	for (x = y; x < m; x++)
+		cp[x] = -1, bp[x * bminc] = -FLT_MAX;
+}
+
 static int _ccv_nnc_nms_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
 	assert(input_size == 1);
@@ -56,127 +206,73 @@ static int _ccv_nnc_nms_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint,
 	const int bminc = binc[b_nd - 1];
 	const int d = a_nd <= 1 ? 1 : a->info.dim[a_nd - 1];
 	const float iou_threshold = cmd.info.nms.iou_threshold;
+	const int top_k = cmd.info.nms.top_k > 0 ? ccv_min(cmd.info.nms.top_k, m) : m;
 	if (d == 5 && aminc == 5 && aminc == bminc) // If it is 5, we can use our quick sort implementation.
 	{
-		parallel_for(i, n)
-		{
-			int x, y;
-			const float* const ap = a->data.f32 + i * aninc;
-			float* const bp = b->data.f32 + i * bninc;
-			int* const cp = c->data.i32 + i * cninc;
-			for (x = 0; x < m; x++)
-				cp[x] = x;
-			for (x = 0; x < m * d; x++)
-				bp[x] = ap[x];
-			_ccv_nnc_nms_sortby_f5_32f((float5*)bp, m, cp);
-			for (x = 0; x < m; x++)
-			{
-				float v = bp[x * 5];
-				if (v == -FLT_MAX) // Suppressed.
-					continue;
-				const float area1 = bp[x * 5 + 3] * bp[x * 5 + 4];
-				for (y = x + 1; y < m; y++)
-				{
-					const float u = bp[y * 5];
-					if (u == -FLT_MAX) // Suppressed.
-						continue;
-					const float area2 = bp[y * 5 + 3] * bp[y * 5 + 4];
-					const float xdiff = ccv_max(0, ccv_min(bp[x * 5 + 1] + bp[x * 5 + 3], bp[y * 5 + 1] + bp[y * 5 + 3]) - ccv_max(bp[x * 5 + 1], bp[y * 5 + 1]));
-					const float ydiff = ccv_max(0, ccv_min(bp[x * 5 + 2] + bp[x * 5 + 4], bp[y * 5 + 2] + bp[y * 5 + 4]) - ccv_max(bp[x * 5 + 2], bp[y * 5 + 2]));
-					const float intersection = xdiff * ydiff;
-					const float iou = intersection / (area1 + area2 - intersection);
-					if (iou >= iou_threshold)
-						bp[y * 5] = -FLT_MAX;
-				}
-			}
-			// Move these values up and move suppressed to the end.
-			for (x = 0, y = 0; x < m; x++)
-				if (bp[x * 5] != -FLT_MAX)
-				{
-					int j;
-					if (x != y)
-					{
-						for (j = 0; j < 5; j++)
-							bp[y * 5 + j] = bp[x * 5 + j];
-						cp[y] = cp[x];
-					}
-					++y;
-				}
-			for (x = y; x < m; x++)
-				cp[x] = -1, bp[x * 5] = -FLT_MAX;
-		} parallel_endfor
+		ccv_nnc_nms_parallel_t parallel = {
+			.a = a,
+			.b = b,
+			.c = c,
+			.aninc = aninc,
+			.bninc = bninc,
+			.cninc = cninc,
+			.m = m,
+			.d = d,
+			.top_k = top_k,
+			.iou_threshold = iou_threshold,
+		};
+		ccv_nnc_parallel_for(n, 0, _ccv_nnc_nms_forw_f5_parallel, &parallel);
 	} else {
 		// Otherwise, fall to use selection sort.
-		parallel_for(i, n)
-		{
-			int x, y;
-			const float* const ap = a->data.f32 + i * aninc;
-			float* const bp = b->data.f32 + i * bninc;
-			int* const cp = c->data.i32 + i * cninc;
-			for (x = 0; x < m; x++)
-				cp[x] = x;
-			for (x = 0; x < m; x++)
-				for (y = 0; y < d; y++)
-					bp[x * bminc + y] = ap[x * aminc + y];
-			for (x = 0; x < m; x++)
-			{
-				float v = bp[x * bminc];
-				int k = x;
-				for (y = x + 1; y < m; y++)
-				{
-					const float u = bp[y * bminc];
-					if (u > v)
-						k = y, v = u;
-				}
-				for (y = 0; y < d; y++)
-				{
-					const float t = bp[k * bminc + y];
-					bp[k * bminc + y] = bp[x * bminc + y];
-					bp[x * bminc + y] = t;
-					const int u = cp[k];
-					cp[k] = cp[x];
-					cp[x] = u;
-				}
-			}
-			for (x = 0; x < m; x++)
-			{
-				float v = bp[x * bminc];
-				if (v == -FLT_MAX) // Suppressed.
-					continue;
-				const float area1 = bp[x * bminc + 3] * bp[x * bminc + 4];
-				for (y = x + 1; y < m; y++)
-				{
-					const float u = bp[y * bminc];
-					if (u == -FLT_MAX) // Suppressed.
-						continue;
-					const float area2 = bp[y * bminc + 3] * bp[y * bminc + 4];
-					const float xdiff = ccv_max(0, ccv_min(bp[x * bminc + 1] + bp[x * bminc + 3], bp[y * bminc + 1] + bp[y * bminc + 3]) - ccv_max(bp[x * bminc + 1], bp[y * bminc + 1]));
-					const float ydiff = ccv_max(0, ccv_min(bp[x * bminc + 2] + bp[x * bminc + 4], bp[y * bminc + 2] + bp[y * bminc + 4]) - ccv_max(bp[x * bminc + 2], bp[y * bminc + 2]));
-					const float intersection = xdiff * ydiff;
-					const float iou = intersection / (area1 + area2 - intersection);
-					if (iou >= iou_threshold)
-						bp[y * bminc] = -FLT_MAX;
-				}
-			}
-			for (x = 0, y = 0; x < m; x++)
-				if (bp[x * bminc] != -FLT_MAX)
-				{
-					int j;
-					if (x != y)
-					{
-						for (j = 0; j < 5; j++)
-							bp[y * bminc + j] = bp[x * bminc + j];
-						cp[y] = cp[x];
-					}
-					++y;
-				}
-			for (x = y; x < m; x++)
-				cp[x] = -1, bp[x * bminc] = -FLT_MAX;
-		} parallel_endfor
+		ccv_nnc_nms_parallel_t parallel = {
+			.a = a,
+			.b = b,
+			.c = c,
+			.aninc = aninc,
+			.bninc = bninc,
+			.cninc = cninc,
+			.m = m,
+			.d = d,
+			.aminc = aminc,
+			.bminc = bminc,
+			.top_k = top_k,
+			.iou_threshold = iou_threshold,
+		};
+		ccv_nnc_parallel_for(n, 0, _ccv_nnc_nms_forw_parallel, &parallel);
 	}
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
+static void _ccv_nnc_nms_back_parallel(void* const context, const int i)
+{
+	const ccv_nnc_nms_parallel_t* const parallel = (ccv_nnc_nms_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	ccv_nnc_tensor_view_t* const b = parallel->b;
+	ccv_nnc_tensor_view_t* const c = parallel->c;
+	const int aninc = parallel->aninc;
+	const int bninc = parallel->bninc;
+	const int cninc = parallel->cninc;
+	const int m = parallel->m;
+	const int d = parallel->d;
+	const int aminc = parallel->aminc;
+	const int bminc = parallel->bminc;
+	int x, y;
+	const float* const ap = a->data.f32 + i * aninc;
+	const int* const cp = c->data.i32 + i * cninc;
+	float* const bp = b->data.f32 + i * bninc;
+	for (x = 0; x < m; x++)
+		for (y = 0; y < d; y++)
+			bp[x * bminc + y] = 0;
+	for (x = 0; x < m; x++)
+	{
+		const int k = cp[x];
+		if (k < 0)
+			break;
+		for (y = 0; y < d; y++)
+			bp[k * bminc + y] = ap[x * aminc + y];
+	}
+}
+
 static int _ccv_nnc_nms_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
 	assert(input_size >= 5);
@@ -206,24 +302,19 @@ static int _ccv_nnc_nms_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint,
 	const int aminc = ainc[a_nd - 1];
 	const int bminc = binc[b_nd - 1];
 	const int d = a_nd <= 1 ? 1 : a->info.dim[a_nd - 1];
-	parallel_for(i, n)
-	{
-		int x, y;
-		const float* const ap = a->data.f32 + i * aninc;
-		const int* const cp = c->data.i32 + i * cninc;
-		float* const bp = b->data.f32 + i * bninc;
-		for (x = 0; x < m; x++)
-			for (y = 0; y < d; y++)
-				bp[x * bminc + y] = 0;
-		for (x = 0; x < m; x++)
-		{
-			const int k = cp[x];
-			if (k < 0)
-				break;
-			for (y = 0; y < d; y++)
-				bp[k * bminc + y] = ap[x * aminc + y];
-		}
-	} parallel_endfor
+	ccv_nnc_nms_parallel_t parallel = {
+		.a = a,
+		.b = b,
+		.c = (ccv_nnc_tensor_view_t*)c,
+		.aninc = aninc,
+		.bninc = bninc,
+		.cninc = cninc,
+		.m = m,
+		.d = d,
+		.aminc = aminc,
+		.bminc = bminc,
+	};
+	ccv_nnc_parallel_for(n, 0, _ccv_nnc_nms_back_parallel, &parallel);
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
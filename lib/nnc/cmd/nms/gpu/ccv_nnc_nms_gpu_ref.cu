@@ -160,6 +160,14 @@ __global__ void _ccv_nnc_iou_postproc_kernel(const int gm, const int m, const ui
 	}
 }
 
+__global__ void _ccv_nnc_nms_suppress_kernel(const int n, float* const b, int* const c)
+{
+	CUDA_1D_KERNEL_LOOP(i, n) {
+		c[i] = -1;
+		b[i * 5] = -FLT_MAX;
+	}
+}
+
 static int _ccv_nnc_nms_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
 	assert(input_size == 1);
@@ -187,13 +195,15 @@ static int _ccv_nnc_nms_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint,
 	else
 		{ assert(c_nd == 2 && n == c->info.dim[0] && m == c->info.dim[1]); }
 	const float iou_threshold = cmd.info.nms.iou_threshold;
+	// Only the top k boxes after sorting are considered, the rest are suppressed.
+	const int k = cmd.info.nms.top_k > 0 ? ccv_min(cmd.info.nms.top_k, m) : m;
 	assert((a_nd <= 1 ? 1 : a->info.dim[a_nd - 1]) == 5 && ainc[a_nd - 1] == 5 && ainc[a_nd - 1] == binc[b_nd - 1]);
 	size_t temp_storage_bytes = 0;
 	cub::DeviceRadixSort::SortPairsDescending(0, temp_storage_bytes, a->data.f32, b->data.f32, (float5*)b->data.f32, (float5*)b->data.i32, m, 0, sizeof(float) * 8, 0);
 	size_t aligned_temp_storage_bytes = ((temp_storage_bytes + 511) / 512) * 512;
-	const int gm = (m + 63) / 64;
+	const int gm = (k + 63) / 64;
 	// Use full parallelism to compute whether it overlaps or not (iou >= iou_threshold).
-	size_t iou_bytes = ((sizeof(uint64_t) * (m * gm) + 511) / 512) * 512;
+	size_t iou_bytes = ((sizeof(uint64_t) * (k * gm) + 511) / 512) * 512;
 	size_t flag_bytes = sizeof(int) * gm;
 	size_t total_bytes = ccv_max(iou_bytes + flag_bytes, aligned_temp_storage_bytes + sizeof(float) * m);
 	uint8_t* const d_temp_storage = (uint8_t*)ccv_nnc_stream_context_get_workspace(stream_context, total_bytes, CCV_TENSOR_GPU_MEMORY);
@@ -214,10 +224,12 @@ static int _ccv_nnc_nms_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint,
 		_ccv_nnc_merge_rank_kernel<<<CUDA_GET_BLOCKS(m), CUDA_NUM_THREADS, 0, stream>>>(m, bp, rank, cp);
 		// Compute whether it overlaps or not with the other. There is no dependencies between them.
 		const int block_size = (gm + 1) * gm / 2;
-		_ccv_nnc_iou_mask_kernel<64><<<block_size, 64, 0, stream>>>(gm, m, iou_threshold, bp, d_ious);
+		_ccv_nnc_iou_mask_kernel<64><<<block_size, 64, 0, stream>>>(gm, k, iou_threshold, bp, d_ious);
 		_ccv_nnc_nms_zero_flags<<<CUDA_GET_BLOCKS(gm), CUDA_NUM_THREADS, 0, stream>>>(gm, d_flags);
 		// Remove overlap items. There are dependencies, because we only remove items that overlap with existing items.
-		_ccv_nnc_iou_postproc_kernel<64><<<gm, 64, 0, stream>>>(gm, m, d_ious, d_flags, bp, cp);
+		_ccv_nnc_iou_postproc_kernel<64><<<gm, 64, 0, stream>>>(gm, k, d_ious, d_flags, bp, cp);
+		if (k < m)
+			_ccv_nnc_nms_suppress_kernel<<<CUDA_GET_BLOCKS(m - k), CUDA_NUM_THREADS, 0, stream>>>(m - k, bp + k * 5, cp + k);
 	}
 	return CCV_NNC_EXEC_SUCCESS;
 }
@@ -0,0 +1,398 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#elif defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+// Shared methods.
+#include "../_ccv_nnc_cpu_opt.h"
+
+// Rows are split into a fixed number of blocks rather than one per thread, thus, the statistics don't depend on the thread pool size.
+#define CCV_NNC_BATCH_NORM_BLOCK_COUNT (64)
+#define CCV_NNC_BATCH_NORM_CHANNEL_BLOCK (64)
+
+typedef struct {
+	int rows;
+	int channels;
+	int block_count;
+	int channel_blocks;
+	float epsilon;
+	float momentum;
+	int activation; // Applied to each row of b after it is computed.
+	const float* a;
+	const float* g;
+	float* b;
+	float* h;
+	const float* scale;
+	const float* bias;
+	float* mean;
+	float* var;
+	float* saved_mean;
+	float* saved_inv_std;
+	float* dscale;
+	float* dbias;
+	float* partial; // block_count x channels x 2 of the per block statistics.
+	float* nscale;
+	float* nbias;
+	float* nx; // Only for backward, the coefficient of x.
+} ccv_nnc_batch_norm_parallel_t;
+
+static inline int _ccv_nnc_batch_norm_block_start(const int rows, const int block_count, const int idx)
+{
+	return (int)((int64_t)rows * idx / block_count);
+}
+
+static void _ccv_nnc_batch_norm_welford_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_batch_norm_parallel_t* const parallel = (ccv_nnc_batch_norm_parallel_t*)context;
+	const int channels = parallel->channels;
+	const int y0 = _ccv_nnc_batch_norm_block_start(parallel->rows, parallel->block_count, idx);
+	const int y1 = _ccv_nnc_batch_norm_block_start(parallel->rows, parallel->block_count, idx + 1);
+	float* const meanp = parallel->partial + idx * channels * 2;
+	float* const m2p = meanp + channels;
+	memset(meanp, 0, sizeof(float) * channels * 2);
+	int y, c;
+	for (y = y0; y < y1; y++)
+	{
+		const float* const ap = parallel->a + (size_t)y * channels;
+		// Single pass Welford update, mean += (x - mean) / k, m2 += (x - old mean) * (x - new mean).
+		const float inv_k = 1. / (y - y0 + 1);
+		c = 0;
+#if defined(HAVE_SSE2)
+		const __m128 inv_k4 = _mm_set1_ps(inv_k);
+		for (; c < channels - 3; c += 4)
+		{
+			const __m128 x4 = _mm_loadu_ps(ap + c);
+			const __m128 mean4 = _mm_loadu_ps(meanp + c);
+			const __m128 delta4 = _mm_sub_ps(x4, mean4);
+			const __m128 nmean4 = _mm_add_ps(mean4, _mm_mul_ps(delta4, inv_k4));
+			_mm_storeu_ps(meanp + c, nmean4);
+			_mm_storeu_ps(m2p + c, _mm_add_ps(_mm_loadu_ps(m2p + c), _mm_mul_ps(delta4, _mm_sub_ps(x4, nmean4))));
+		}
+#elif defined(HAVE_NEON)
+		for (; c < channels - 3; c += 4)
+		{
+			const float32x4_t x4 = vld1q_f32(ap + c);
+			const float32x4_t mean4 = vld1q_f32(meanp + c);
+			const float32x4_t delta4 = vsubq_f32(x4, mean4);
+			const float32x4_t nmean4 = vmlaq_n_f32(mean4, delta4, inv_k);
+			vst1q_f32(meanp + c, nmean4);
+			vst1q_f32(m2p + c, vmlaq_f32(vld1q_f32(m2p + c), delta4, vsubq_f32(x4, nmean4)));
+		}
+#endif
+		for (; c < channels; c++)
+		{
+			const float delta = ap[c] - meanp[c];
+			meanp[c] += delta * inv_k;
+			m2p[c] += delta * (ap[c] - meanp[c]);
+		}
+	}
+}
+
+static void _ccv_nnc_batch_norm_merge_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_batch_norm_parallel_t* const parallel = (ccv_nnc_batch_norm_parallel_t*)context;
+	const int channels = parallel->channels;
+	const int c0 = idx * CCV_NNC_BATCH_NORM_CHANNEL_BLOCK;
+	const int c1 = ccv_min(c0 + CCV_NNC_BATCH_NORM_CHANNEL_BLOCK, channels);
+	const float momentum = parallel->momentum;
+	int i, c;
+	for (c = c0; c < c1; c++)
+	{
+		// Combine the per block statistics with Chan et al.'s pairwise update.
+		double mean = 0, m2 = 0;
+		int n = 0;
+		for (i = 0; i < parallel->block_count; i++)
+		{
+			const int nb = _ccv_nnc_batch_norm_block_start(parallel->rows, parallel->block_count, i + 1) - _ccv_nnc_batch_norm_block_start(parallel->rows, parallel->block_count, i);
+			if (!nb)
+				continue;
+			const float* const meanp = parallel->partial + i * channels * 2;
+			const double delta = meanp[c] - mean;
+			const int nn = n + nb;
+			mean += delta * nb / nn;
+			m2 += meanp[channels + c] + delta * delta * ((double)n * nb / nn);
+			n = nn;
+		}
+		const float var = m2 / n;
+		const float inv_std = 1. / sqrtf(var + parallel->epsilon);
+		parallel->saved_mean[c] = mean;
+		parallel->saved_inv_std[c] = inv_std;
+		parallel->mean[c] = momentum * parallel->mean[c] + (1 - momentum) * mean;
+		parallel->var[c] = momentum * parallel->var[c] + (1 - momentum) * var;
+		const float w = inv_std * parallel->scale[c];
+		parallel->nscale[c] = w;
+		parallel->nbias[c] = parallel->bias[c] - mean * w;
+	}
+}
+
+static void _ccv_nnc_batch_norm_apply_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_batch_norm_parallel_t* const parallel = (ccv_nnc_batch_norm_parallel_t*)context;
+	const int channels = parallel->channels;
+	const int y0 = _ccv_nnc_batch_norm_block_start(parallel->rows, parallel->block_count, idx);
+	const int y1 = _ccv_nnc_batch_norm_block_start(parallel->rows, parallel->block_count, idx + 1);
+	const float* const nscalep = parallel->nscale;
+	const float* const nbiasp = parallel->nbias;
+	int y, c;
+	for (y = y0; y < y1; y++)
+	{
+		const float* const ap = parallel->a + (size_t)y * channels;
+		float* const bp = parallel->b + (size_t)y * channels;
+		c = 0;
+#if defined(HAVE_SSE2)
+		for (; c < channels - 3; c += 4)
+			_mm_storeu_ps(bp + c, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(ap + c), _mm_loadu_ps(nscalep + c)), _mm_loadu_ps(nbiasp + c)));
+#elif defined(HAVE_NEON)
+		for (; c < channels - 3; c += 4)
+			vst1q_f32(bp + c, vmlaq_f32(vld1q_f32(nbiasp + c), vld1q_f32(ap + c), vld1q_f32(nscalep + c)));
+#endif
+		for (; c < channels; c++)
+			bp[c] = ap[c] * nscalep[c] + nbiasp[c];
+		_ccv_nnc_activation_cpu_opt(parallel->activation, bp, 1, channels);
+	}
+}
+
+static void _ccv_nnc_batch_norm_back_sum_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_batch_norm_parallel_t* const parallel = (ccv_nnc_batch_norm_parallel_t*)context;
+	const int channels = parallel->channels;
+	const int y0 = _ccv_nnc_batch_norm_block_start(parallel->rows, parallel->block_count, idx);
+	const int y1 = _ccv_nnc_batch_norm_block_start(parallel->rows, parallel->block_count, idx + 1);
+	const float* const meanp = parallel->saved_mean;
+	float* const sgp = parallel->partial + idx * channels * 2; // Sum of g.
+	float* const sgxp = sgp + channels; // Sum of g * (x - mean).
+	memset(sgp, 0, sizeof(float) * channels * 2);
+	int y, c;
+	for (y = y0; y < y1; y++)
+	{
+		const float* const ap = parallel->a + (size_t)y * channels;
+		const float* const gp = parallel->g + (size_t)y * channels;
+		c = 0;
+#if defined(HAVE_SSE2)
+		for (; c < channels - 3; c += 4)
+		{
+			const __m128 g4 = _mm_loadu_ps(gp + c);
+			_mm_storeu_ps(sgp + c, _mm_add_ps(_mm_loadu_ps(sgp + c), g4));
+			_mm_storeu_ps(sgxp + c, _mm_add_ps(_mm_loadu_ps(sgxp + c), _mm_mul_ps(g4, _mm_sub_ps(_mm_loadu_ps(ap + c), _mm_loadu_ps(meanp + c)))));
+		}
+#elif defined(HAVE_NEON)
+		for (; c < channels - 3; c += 4)
+		{
+			const float32x4_t g4 = vld1q_f32(gp + c);
+			vst1q_f32(sgp + c, vaddq_f32(vld1q_f32(sgp + c), g4));
+			vst1q_f32(sgxp + c, vmlaq_f32(vld1q_f32(sgxp + c), g4, vsubq_f32(vld1q_f32(ap + c), vld1q_f32(meanp + c))));
+		}
+#endif
+		for (; c < channels; c++)
+		{
+			sgp[c] += gp[c];
+			sgxp[c] += gp[c] * (ap[c] - meanp[c]);
+		}
+	}
+}
+
+static void _ccv_nnc_batch_norm_back_merge_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_batch_norm_parallel_t* const parallel = (ccv_nnc_batch_norm_parallel_t*)context;
+	const int channels = parallel->channels;
+	const int c0 = idx * CCV_NNC_BATCH_NORM_CHANNEL_BLOCK;
+	const int c1 = ccv_min(c0 + CCV_NNC_BATCH_NORM_CHANNEL_BLOCK, channels);
+	const float inv_n = 1. / parallel->rows;
+	int i, c;
+	for (c = c0; c < c1; c++)
+	{
+		float dbias = 0, sgx = 0;
+		for (i = 0; i < parallel->block_count; i++)
+		{
+			dbias += parallel->partial[i * channels * 2 + c];
+			sgx += parallel->partial[i * channels * 2 + channels + c];
+		}
+		const float inv_std = parallel->saved_inv_std[c];
+		const float dscale = sgx * inv_std;
+		parallel->dbias[c] = dbias;
+		parallel->dscale[c] = dscale;
+		// h = scale * inv_std * (g - dbias / n - (x - mean) * inv_std * dscale / n), expand it to h = g * nscale + x * nx + nbias.
+		const float w = parallel->scale[c] * inv_std;
+		const float wx = w * inv_std * dscale * inv_n;
+		parallel->nscale[c] = w;
+		parallel->nx[c] = -wx;
+		parallel->nbias[c] = parallel->saved_mean[c] * wx - w * dbias * inv_n;
+	}
+}
+
+static void _ccv_nnc_batch_norm_back_apply_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_batch_norm_parallel_t* const parallel = (ccv_nnc_batch_norm_parallel_t*)context;
+	const int channels = parallel->channels;
+	const int y0 = _ccv_nnc_batch_norm_block_start(parallel->rows, parallel->block_count, idx);
+	const int y1 = _ccv_nnc_batch_norm_block_start(parallel->rows, parallel->block_count, idx + 1);
+	const float* const nscalep = parallel->nscale;
+	const float* const nxp = parallel->nx;
+	const float* const nbiasp = parallel->nbias;
+	int y, c;
+	for (y = y0; y < y1; y++)
+	{
+		const float* const ap = parallel->a + (size_t)y * channels;
+		const float* const gp = parallel->g + (size_t)y * channels;
+		float* const hp = parallel->h + (size_t)y * channels;
+		c = 0;
+#if defined(HAVE_SSE2)
+		for (; c < channels - 3; c += 4)
+			_mm_storeu_ps(hp + c, _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(gp + c), _mm_loadu_ps(nscalep + c)), _mm_mul_ps(_mm_loadu_ps(ap + c), _mm_loadu_ps(nxp + c))), _mm_loadu_ps(nbiasp + c)));
+#elif defined(HAVE_NEON)
+		for (; c < channels - 3; c += 4)
+			vst1q_f32(hp + c, vmlaq_f32(vmlaq_f32(vld1q_f32(nbiasp + c), vld1q_f32(gp + c), vld1q_f32(nscalep + c)), vld1q_f32(ap + c), vld1q_f32(nxp + c)));
+#endif
+		for (; c < channels; c++)
+			hp[c] = gp[c] * nscalep[c] + ap[c] * nxp[c] + nbiasp[c];
+	}
+}
+
+// Only the channel-wise batch norm (reduce every axis but the innermost one) on plain tensors is optimized.
+static int _ccv_nnc_batch_norm_channel_wise(ccv_nnc_tensor_t* const* const tensors, const int tensor_size, const int* const adim, const int* const rdim)
+{
+	int i;
+	for (i = 0; i < tensor_size; i++)
+		if (tensors[i] && CCV_IS_TENSOR_VIEW(tensors[i]))
+			return 0;
+	for (i = 0; i < CCV_NNC_MAX_DIM + 1; i++)
+		if (rdim[i] != 1)
+			return 0;
+	return rdim[CCV_NNC_MAX_DIM + 1] == adim[CCV_NNC_MAX_DIM + 1];
+}
+
+static int _ccv_nnc_batch_norm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 5);
+	ccv_nnc_tensor_view_t* const a = (ccv_nnc_tensor_view_t*)inputs[0];
+	ccv_nnc_tensor_view_t* const scale = (ccv_nnc_tensor_view_t*)inputs[1];
+	ccv_nnc_tensor_view_t* const b = (ccv_nnc_tensor_view_t*)outputs[0];
+	assert(ccv_nnc_tensor_nd(a->info.dim) <= CCV_NNC_MAX_DIM + 2);
+	assert(ccv_nnc_tensor_nd(b->info.dim) <= CCV_NNC_MAX_DIM + 2);
+	int adim[CCV_NNC_MAX_DIM_ALLOC];
+	int rdim[CCV_NNC_MAX_DIM_ALLOC];
+	ccv_nnc_tensor_view_get_dim(a, adim);
+	ccv_nnc_tensor_view_get_dim(scale, rdim);
+	assert(ccv_nnc_tensor_view_check_dim(b, adim));
+	if (!_ccv_nnc_batch_norm_channel_wise(inputs, input_size, adim, rdim) ||
+		!_ccv_nnc_batch_norm_channel_wise(outputs, output_size, adim, rdim) ||
+		(flags & CCV_NNC_ZERO_MEMORY_ALLOC))
+		return CCV_NNC_EXEC_INVALID;
+	const int channels = adim[CCV_NNC_MAX_DIM + 1];
+	const int rows = ccv_nnc_tensor_count(a->info) / channels;
+	const int block_count = ccv_min(rows, CCV_NNC_BATCH_NORM_BLOCK_COUNT);
+	const int channel_blocks = (channels + CCV_NNC_BATCH_NORM_CHANNEL_BLOCK - 1) / CCV_NNC_BATCH_NORM_CHANNEL_BLOCK;
+	float* const workspace = (float*)ccv_nnc_stream_context_get_workspace(stream_context, sizeof(float) * channels * (block_count * 2 + 2), CCV_TENSOR_CPU_MEMORY);
+	ccv_nnc_batch_norm_parallel_t parallel = {
+		.rows = rows,
+		.channels = channels,
+		.block_count = block_count,
+		.channel_blocks = channel_blocks,
+		.epsilon = cmd.info.bnorm.epsilon,
+		.momentum = cmd.info.bnorm.momentum,
+		.activation = cmd.info.activation.type,
+		.a = a->data.f32,
+		.b = b->data.f32,
+		.scale = scale->data.f32,
+		.bias = inputs[2]->data.f32,
+		.mean = inputs[3]->data.f32,
+		.var = inputs[4]->data.f32,
+		.nscale = workspace,
+		.nbias = workspace + channels,
+		.partial = workspace + channels * 2,
+	};
+	if (!cmd.info.bnorm.is_test)
+	{
+		assert(output_size == 5);
+		// Both are inplace.
+		assert(inputs[3]->data.f32 == outputs[1]->data.f32);
+		assert(inputs[4]->data.f32 == outputs[2]->data.f32);
+		parallel.saved_mean = outputs[3]->data.f32;
+		parallel.saved_inv_std = outputs[4]->data.f32;
+		ccv_nnc_parallel_for(block_count, 0, _ccv_nnc_batch_norm_welford_parallel, &parallel);
+		ccv_nnc_parallel_for(channel_blocks, 0, _ccv_nnc_batch_norm_merge_parallel, &parallel);
+	} else {
+		int c;
+		for (c = 0; c < channels; c++)
+		{
+			// Matches the reference implementation, epsilon is outside of the sqrt at inference time.
+			const float w = parallel.scale[c] / (sqrtf(parallel.var[c]) + parallel.epsilon);
+			parallel.nscale[c] = w;
+			parallel.nbias[c] = parallel.bias[c] - parallel.mean[c] * w;
+		}
+	}
+	ccv_nnc_parallel_for(block_count, 0, _ccv_nnc_batch_norm_apply_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_batch_norm_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 15);
+	assert(output_size == 5);
+	ccv_nnc_tensor_view_t* const g = (ccv_nnc_tensor_view_t*)inputs[0];
+	ccv_nnc_tensor_view_t* const scale = (ccv_nnc_tensor_view_t*)inputs[6];
+	ccv_nnc_tensor_view_t* const h = (ccv_nnc_tensor_view_t*)outputs[0];
+	assert(ccv_nnc_tensor_nd(g->info.dim) <= CCV_NNC_MAX_DIM + 2);
+	assert(ccv_nnc_tensor_nd(h->info.dim) <= CCV_NNC_MAX_DIM + 2);
+	int gdim[CCV_NNC_MAX_DIM_ALLOC];
+	int rdim[CCV_NNC_MAX_DIM_ALLOC];
+	ccv_nnc_tensor_view_get_dim(g, gdim);
+	ccv_nnc_tensor_view_get_dim(scale, rdim);
+	assert(ccv_nnc_tensor_view_check_dim(h, gdim));
+	if (!_ccv_nnc_batch_norm_channel_wise(inputs, input_size, gdim, rdim) ||
+		!_ccv_nnc_batch_norm_channel_wise(outputs, output_size, gdim, rdim))
+		return CCV_NNC_EXEC_INVALID;
+	assert(!(flags & CCV_NNC_ZERO_MEMORY_ALLOC));
+	const int channels = gdim[CCV_NNC_MAX_DIM + 1];
+	const int rows = ccv_nnc_tensor_count(g->info) / channels;
+	const int block_count = ccv_min(rows, CCV_NNC_BATCH_NORM_BLOCK_COUNT);
+	const int channel_blocks = (channels + CCV_NNC_BATCH_NORM_CHANNEL_BLOCK - 1) / CCV_NNC_BATCH_NORM_CHANNEL_BLOCK;
+	float* const workspace = (float*)ccv_nnc_stream_context_get_workspace(stream_context, sizeof(float) * channels * (block_count * 2 + 3), CCV_TENSOR_CPU_MEMORY);
+	ccv_nnc_batch_norm_parallel_t parallel = {
+		.rows = rows,
+		.channels = channels,
+		.block_count = block_count,
+		.channel_blocks = channel_blocks,
+		.a = inputs[5]->data.f32,
+		.g = g->data.f32,
+		.h = h->data.f32,
+		.scale = scale->data.f32,
+		.saved_mean = inputs[13]->data.f32,
+		.saved_inv_std = inputs[14]->data.f32,
+		.dscale = outputs[1]->data.f32,
+		.dbias = outputs[2]->data.f32,
+		.nscale = workspace,
+		.nbias = workspace + channels,
+		.nx = workspace + channels * 2,
+		.partial = workspace + channels * 3,
+	};
+	ccv_nnc_parallel_for(block_count, 0, _ccv_nnc_batch_norm_back_sum_parallel, &parallel);
+	ccv_nnc_parallel_for(channel_blocks, 0, _ccv_nnc_batch_norm_back_merge_parallel, &parallel);
+	ccv_nnc_parallel_for(block_count, 0, _ccv_nnc_batch_norm_back_apply_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_BATCH_NORM_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->activations = CCV_NNC_ACTIVATION_ALL;
+	registry->exec = _ccv_nnc_batch_norm_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_BATCH_NORM_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_batch_norm_back;
+}
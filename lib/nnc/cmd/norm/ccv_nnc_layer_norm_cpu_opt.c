@@ -0,0 +1,364 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#elif defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+// Rows are split into a fixed number of blocks for backward, thus, dscale / dbias don't depend on the thread pool size.
+#define CCV_NNC_LAYER_NORM_BLOCK_COUNT (64)
+#define CCV_NNC_LAYER_NORM_COLUMN_BLOCK (256)
+
+typedef struct {
+	int rows;
+	int n; // Number of elements normalized together in a row.
+	int block_count;
+	float epsilon;
+	const float* a;
+	const float* g;
+	float* b;
+	float* h;
+	const float* scale;
+	const float* bias;
+	float* saved_mean;
+	float* saved_inv_std;
+	float* dscale;
+	float* dbias;
+	float* partial; // block_count x n x 2 of the per block dscale / dbias.
+} ccv_nnc_layer_norm_parallel_t;
+
+static inline int _ccv_nnc_layer_norm_block_start(const int rows, const int block_count, const int idx)
+{
+	return (int)((int64_t)rows * idx / block_count);
+}
+
+// Single pass Welford statistics of a row, each SIMD lane keeps its own mean / m2, and they are merged at the end.
+static inline void _ccv_nnc_layer_norm_welford(const float* const ap, const int n, float* const mean_out, float* const var_out)
+{
+	int x = 0;
+	float mean = 0, m2 = 0;
+	int k = 0;
+#if defined(HAVE_SSE2) || defined(HAVE_NEON)
+	if (n >= 4)
+	{
+		float lane_mean[4], lane_m2[4];
+#if defined(HAVE_SSE2)
+		__m128 mean4 = _mm_setzero_ps();
+		__m128 m24 = _mm_setzero_ps();
+		for (; x < n - 3; x += 4)
+		{
+			const __m128 x4 = _mm_loadu_ps(ap + x);
+			const __m128 delta4 = _mm_sub_ps(x4, mean4);
+			mean4 = _mm_add_ps(mean4, _mm_mul_ps(delta4, _mm_set1_ps(1. / (++k))));
+			m24 = _mm_add_ps(m24, _mm_mul_ps(delta4, _mm_sub_ps(x4, mean4)));
+		}
+		_mm_storeu_ps(lane_mean, mean4);
+		_mm_storeu_ps(lane_m2, m24);
+#else
+		float32x4_t mean4 = vdupq_n_f32(0);
+		float32x4_t m24 = vdupq_n_f32(0);
+		for (; x < n - 3; x += 4)
+		{
+			const float32x4_t x4 = vld1q_f32(ap + x);
+			const float32x4_t delta4 = vsubq_f32(x4, mean4);
+			mean4 = vmlaq_n_f32(mean4, delta4, 1. / (++k));
+			m24 = vmlaq_f32(m24, delta4, vsubq_f32(x4, mean4));
+		}
+		vst1q_f32(lane_mean, mean4);
+		vst1q_f32(lane_m2, m24);
+#endif
+		// All lanes have the same count k, merging them is simpler than the general pairwise update.
+		mean = (lane_mean[0] + lane_mean[1] + lane_mean[2] + lane_mean[3]) * 0.25;
+		int i;
+		for (i = 0; i < 4; i++)
+			m2 += lane_m2[i] + (lane_mean[i] - mean) * (lane_mean[i] - mean) * k;
+		k *= 4;
+	}
+#endif
+	for (; x < n; x++)
+	{
+		const float delta = ap[x] - mean;
+		mean += delta / (++k);
+		m2 += delta * (ap[x] - mean);
+	}
+	*mean_out = mean;
+	*var_out = m2 / n;
+}
+
+static void _ccv_nnc_layer_norm_forw_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_layer_norm_parallel_t* const parallel = (ccv_nnc_layer_norm_parallel_t*)context;
+	const int n = parallel->n;
+	const float* const ap = parallel->a + (size_t)idx * n;
+	float* const bp = parallel->b + (size_t)idx * n;
+	const float* const scalep = parallel->scale;
+	const float* const biasp = parallel->bias;
+	float mean, var;
+	_ccv_nnc_layer_norm_welford(ap, n, &mean, &var);
+	// The epsilon is outside of the sqrt, matching the reference implementation.
+	const float inv_std = 1. / (sqrtf(var) + parallel->epsilon);
+	if (parallel->saved_mean)
+		parallel->saved_mean[idx] = mean;
+	if (parallel->saved_inv_std)
+		parallel->saved_inv_std[idx] = inv_std;
+	int x = 0;
+#if defined(HAVE_SSE2)
+	const __m128 mean4 = _mm_set1_ps(mean);
+	const __m128 inv_std4 = _mm_set1_ps(inv_std);
+	for (; x < n - 3; x += 4)
+		_mm_storeu_ps(bp + x, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(ap + x), mean4), inv_std4), _mm_loadu_ps(scalep + x)), _mm_loadu_ps(biasp + x)));
+#elif defined(HAVE_NEON)
+	const float32x4_t mean4 = vdupq_n_f32(mean);
+	for (; x < n - 3; x += 4)
+		vst1q_f32(bp + x, vmlaq_f32(vld1q_f32(biasp + x), vmulq_n_f32(vsubq_f32(vld1q_f32(ap + x), mean4), inv_std), vld1q_f32(scalep + x)));
+#endif
+	for (; x < n; x++)
+		bp[x] = (ap[x] - mean) * inv_std * scalep[x] + biasp[x];
+}
+
+static void _ccv_nnc_layer_norm_back_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_layer_norm_parallel_t* const parallel = (ccv_nnc_layer_norm_parallel_t*)context;
+	const int n = parallel->n;
+	const int y0 = _ccv_nnc_layer_norm_block_start(parallel->rows, parallel->block_count, idx);
+	const int y1 = _ccv_nnc_layer_norm_block_start(parallel->rows, parallel->block_count, idx + 1);
+	const float* const scalep = parallel->scale;
+	float* const dscalep = parallel->partial + (size_t)idx * n * 2;
+	float* const dbiasp = dscalep + n;
+	memset(dscalep, 0, sizeof(float) * n * 2);
+	const float inv_n = 1. / n;
+	int y, x;
+	for (y = y0; y < y1; y++)
+	{
+		const float* const ap = parallel->a + (size_t)y * n;
+		const float* const gp = parallel->g + (size_t)y * n;
+		float* const hp = parallel->h + (size_t)y * n;
+		const float mean = parallel->saved_mean[y];
+		const float inv_std = parallel->saved_inv_std[y];
+		// With ah = (x - mean) * inv_std and gss = g * scale * inv_std, h = gss - (sum(gss) + ah * sum(ah * gss)) / n.
+		float sgss = 0, sahgss = 0;
+		x = 0;
+#if defined(HAVE_SSE2)
+		const __m128 mean4 = _mm_set1_ps(mean);
+		const __m128 inv_std4 = _mm_set1_ps(inv_std);
+		__m128 sgss4 = _mm_setzero_ps();
+		__m128 sahgss4 = _mm_setzero_ps();
+		for (; x < n - 3; x += 4)
+		{
+			const __m128 g4 = _mm_loadu_ps(gp + x);
+			const __m128 ah4 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(ap + x), mean4), inv_std4);
+			const __m128 gss4 = _mm_mul_ps(_mm_mul_ps(g4, _mm_loadu_ps(scalep + x)), inv_std4);
+			sgss4 = _mm_add_ps(sgss4, gss4);
+			sahgss4 = _mm_add_ps(sahgss4, _mm_mul_ps(ah4, gss4));
+			_mm_storeu_ps(dscalep + x, _mm_add_ps(_mm_loadu_ps(dscalep + x), _mm_mul_ps(ah4, g4)));
+			_mm_storeu_ps(dbiasp + x, _mm_add_ps(_mm_loadu_ps(dbiasp + x), g4));
+		}
+		float v[4];
+		_mm_storeu_ps(v, sgss4);
+		sgss = v[0] + v[1] + v[2] + v[3];
+		_mm_storeu_ps(v, sahgss4);
+		sahgss = v[0] + v[1] + v[2] + v[3];
+#elif defined(HAVE_NEON)
+		const float32x4_t mean4 = vdupq_n_f32(mean);
+		float32x4_t sgss4 = vdupq_n_f32(0);
+		float32x4_t sahgss4 = vdupq_n_f32(0);
+		for (; x < n - 3; x += 4)
+		{
+			const float32x4_t g4 = vld1q_f32(gp + x);
+			const float32x4_t ah4 = vmulq_n_f32(vsubq_f32(vld1q_f32(ap + x), mean4), inv_std);
+			const float32x4_t gss4 = vmulq_n_f32(vmulq_f32(g4, vld1q_f32(scalep + x)), inv_std);
+			sgss4 = vaddq_f32(sgss4, gss4);
+			sahgss4 = vmlaq_f32(sahgss4, ah4, gss4);
+			vst1q_f32(dscalep + x, vmlaq_f32(vld1q_f32(dscalep + x), ah4, g4));
+			vst1q_f32(dbiasp + x, vaddq_f32(vld1q_f32(dbiasp + x), g4));
+		}
+		float v[4];
+		vst1q_f32(v, sgss4);
+		sgss = v[0] + v[1] + v[2] + v[3];
+		vst1q_f32(v, sahgss4);
+		sahgss = v[0] + v[1] + v[2] + v[3];
+#endif
+		for (; x < n; x++)
+		{
+			const float ah = (ap[x] - mean) * inv_std;
+			const float gss = gp[x] * scalep[x] * inv_std;
+			sgss += gss;
+			sahgss += ah * gss;
+			dscalep[x] += ah * gp[x];
+			dbiasp[x] += gp[x];
+		}
+		sgss *= inv_n;
+		sahgss *= inv_n;
+		x = 0;
+#if defined(HAVE_SSE2)
+		const __m128 sgss4n = _mm_set1_ps(sgss);
+		const __m128 sahgss4n = _mm_set1_ps(sahgss);
+		for (; x < n - 3; x += 4)
+		{
+			const __m128 ah4 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(ap + x), mean4), inv_std4);
+			const __m128 gss4 = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(gp + x), _mm_loadu_ps(scalep + x)), inv_std4);
+			_mm_storeu_ps(hp + x, _mm_sub_ps(gss4, _mm_add_ps(sgss4n, _mm_mul_ps(ah4, sahgss4n))));
+		}
+#elif defined(HAVE_NEON)
+		const float32x4_t sgss4n = vdupq_n_f32(sgss);
+		for (; x < n - 3; x += 4)
+		{
+			const float32x4_t ah4 = vmulq_n_f32(vsubq_f32(vld1q_f32(ap + x), mean4), inv_std);
+			const float32x4_t gss4 = vmulq_n_f32(vmulq_f32(vld1q_f32(gp + x), vld1q_f32(scalep + x)), inv_std);
+			vst1q_f32(hp + x, vsubq_f32(gss4, vmlaq_n_f32(sgss4n, ah4, sahgss)));
+		}
+#endif
+		for (; x < n; x++)
+		{
+			const float ah = (ap[x] - mean) * inv_std;
+			hp[x] = gp[x] * scalep[x] * inv_std - (sgss + ah * sahgss);
+		}
+	}
+}
+
+static void _ccv_nnc_layer_norm_back_merge_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_layer_norm_parallel_t* const parallel = (ccv_nnc_layer_norm_parallel_t*)context;
+	const int n = parallel->n;
+	const int x0 = idx * CCV_NNC_LAYER_NORM_COLUMN_BLOCK;
+	const int x1 = ccv_min(x0 + CCV_NNC_LAYER_NORM_COLUMN_BLOCK, n);
+	float* const dscalep = parallel->dscale;
+	float* const dbiasp = parallel->dbias;
+	int i, x;
+	memcpy(dscalep + x0, parallel->partial + x0, sizeof(float) * (x1 - x0));
+	memcpy(dbiasp + x0, parallel->partial + n + x0, sizeof(float) * (x1 - x0));
+	for (i = 1; i < parallel->block_count; i++)
+	{
+		const float* const pdscalep = parallel->partial + (size_t)i * n * 2;
+		const float* const pdbiasp = pdscalep + n;
+		for (x = x0; x < x1; x++)
+			dscalep[x] += pdscalep[x], dbiasp[x] += pdbiasp[x];
+	}
+}
+
+// Only normalizing over the innermost axes with element-wise scale / bias on plain tensors is optimized.
+// Returns the number of leading axes that are not normalized, or -1 if it is not supported.
+static int _ccv_nnc_layer_norm_leading_axis(ccv_nnc_tensor_t* const* const tensors, const int tensor_size, const int* const adim, const int* const rdim, const ccv_nnc_tensor_t* const scale, const ccv_nnc_tensor_t* const bias)
+{
+	int i;
+	for (i = 0; i < tensor_size; i++)
+		if (tensors[i] && CCV_IS_TENSOR_VIEW(tensors[i]))
+			return -1;
+	int p = CCV_NNC_MAX_DIM + 2;
+	while (p > 0 && rdim[p - 1] == 1)
+		--p;
+	for (i = 0; i < p; i++)
+		if (rdim[i] != adim[i])
+			return -1;
+	int sdim[CCV_NNC_MAX_DIM_ALLOC];
+	int bias_dim[CCV_NNC_MAX_DIM_ALLOC];
+	ccv_nnc_tensor_view_get_dim((ccv_nnc_tensor_view_t*)scale, sdim);
+	ccv_nnc_tensor_view_get_dim((ccv_nnc_tensor_view_t*)bias, bias_dim);
+	for (i = 0; i < CCV_NNC_MAX_DIM + 2; i++)
+		if (sdim[i] != (i < p ? 1 : adim[i]) || bias_dim[i] != (i < p ? 1 : adim[i]))
+			return -1;
+	return p;
+}
+
+static int _ccv_nnc_layer_norm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 3);
+	ccv_nnc_tensor_view_t* const a = (ccv_nnc_tensor_view_t*)inputs[0];
+	ccv_nnc_tensor_view_t* const b = (ccv_nnc_tensor_view_t*)outputs[0];
+	assert(ccv_nnc_tensor_nd(a->info.dim) <= CCV_NNC_MAX_DIM + 2);
+	assert(ccv_nnc_tensor_nd(b->info.dim) <= CCV_NNC_MAX_DIM + 2);
+	int adim[CCV_NNC_MAX_DIM_ALLOC];
+	int rdim[CCV_NNC_MAX_DIM_ALLOC];
+	ccv_nnc_tensor_view_get_dim(a, adim);
+	assert(ccv_nnc_tensor_view_check_dim(b, adim));
+	// The saved mean / inv_std are optional, thus, derive the reduced dimensions from the axis instead.
+	int i;
+	memcpy(rdim, adim, sizeof(rdim));
+	const int offset = CCV_NNC_MAX_DIM + 2 - ccv_nnc_tensor_nd(a->info.dim);
+	for (i = 0; i < cmd.info.lnorm.count; i++)
+		rdim[cmd.info.lnorm.axis[i] + offset] = 1;
+	const int p = _ccv_nnc_layer_norm_leading_axis(inputs, input_size, adim, rdim, inputs[1], inputs[2]);
+	if (p < 0 || _ccv_nnc_layer_norm_leading_axis(outputs, output_size, adim, rdim, inputs[1], inputs[2]) < 0)
+		return CCV_NNC_EXEC_INVALID;
+	int rows = 1;
+	for (i = 0; i < p; i++)
+		rows *= adim[i];
+	ccv_nnc_layer_norm_parallel_t parallel = {
+		.rows = rows,
+		.n = ccv_nnc_tensor_count(a->info) / rows,
+		.epsilon = cmd.info.lnorm.epsilon,
+		.a = a->data.f32,
+		.b = b->data.f32,
+		.scale = inputs[1]->data.f32,
+		.bias = inputs[2]->data.f32,
+		.saved_mean = output_size > 1 && outputs[1] ? outputs[1]->data.f32 : 0,
+		.saved_inv_std = output_size > 2 && outputs[2] ? outputs[2]->data.f32 : 0,
+	};
+	ccv_nnc_parallel_for(rows, 0, _ccv_nnc_layer_norm_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_layer_norm_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 9);
+	assert(output_size == 3);
+	ccv_nnc_tensor_view_t* const g = (ccv_nnc_tensor_view_t*)inputs[0];
+	ccv_nnc_tensor_view_t* const saved_mean = (ccv_nnc_tensor_view_t*)inputs[7];
+	ccv_nnc_tensor_view_t* const h = (ccv_nnc_tensor_view_t*)outputs[0];
+	assert(ccv_nnc_tensor_nd(g->info.dim) <= CCV_NNC_MAX_DIM + 2);
+	assert(ccv_nnc_tensor_nd(h->info.dim) <= CCV_NNC_MAX_DIM + 2);
+	int gdim[CCV_NNC_MAX_DIM_ALLOC];
+	int rdim[CCV_NNC_MAX_DIM_ALLOC];
+	ccv_nnc_tensor_view_get_dim(g, gdim);
+	ccv_nnc_tensor_view_get_dim(saved_mean, rdim);
+	assert(ccv_nnc_tensor_view_check_dim(h, gdim));
+	const int p = _ccv_nnc_layer_norm_leading_axis(inputs, input_size, gdim, rdim, inputs[4], outputs[2]);
+	if (p < 0 || _ccv_nnc_layer_norm_leading_axis(outputs, output_size, gdim, rdim, outputs[1], outputs[2]) < 0)
+		return CCV_NNC_EXEC_INVALID;
+	assert(!(flags & CCV_NNC_ZERO_MEMORY_ALLOC));
+	int i;
+	int rows = 1;
+	for (i = 0; i < p; i++)
+		rows *= gdim[i];
+	const int n = ccv_nnc_tensor_count(g->info) / rows;
+	const int block_count = ccv_min(rows, CCV_NNC_LAYER_NORM_BLOCK_COUNT);
+	ccv_nnc_layer_norm_parallel_t parallel = {
+		.rows = rows,
+		.n = n,
+		.block_count = block_count,
+		.a = inputs[3]->data.f32,
+		.g = g->data.f32,
+		.h = h->data.f32,
+		.scale = inputs[4]->data.f32,
+		.saved_mean = saved_mean->data.f32,
+		.saved_inv_std = inputs[8]->data.f32,
+		.dscale = outputs[1]->data.f32,
+		.dbias = outputs[2]->data.f32,
+		.partial = (float*)ccv_nnc_stream_context_get_workspace(stream_context, sizeof(float) * n * 2 * block_count, CCV_TENSOR_CPU_MEMORY),
+	};
+	ccv_nnc_parallel_for(block_count, 0, _ccv_nnc_layer_norm_back_parallel, &parallel);
+	ccv_nnc_parallel_for((n + CCV_NNC_LAYER_NORM_COLUMN_BLOCK - 1) / CCV_NNC_LAYER_NORM_COLUMN_BLOCK, 0, _ccv_nnc_layer_norm_back_merge_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_LAYER_NORM_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_layer_norm_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_LAYER_NORM_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_layer_norm_back;
+}
@@ -0,0 +1,270 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#elif defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+typedef struct {
+	ccv_nnc_hint_t hint;
+	const int* size; // The pooling window.
+	const float* a;
+	float* b;
+	const int* adim;
+	const int* bdim;
+	const int* ainc;
+	const int* binc;
+	int a_batch_inc;
+	int b_batch_inc;
+	int channel_blocks;
+} ccv_nnc_avg_pool_parallel_t;
+
+// y[0:n] += s * x[0:n]
+static inline void _ccv_nnc_avg_pool_axpy(float* const y, const float s, const float* const x, const int n)
+{
+	int c = 0;
+#if defined(HAVE_SSE2)
+	const __m128 s4 = _mm_set1_ps(s);
+	for (; c < n - 3; c += 4)
+		_mm_storeu_ps(y + c, _mm_add_ps(_mm_loadu_ps(y + c), _mm_mul_ps(s4, _mm_loadu_ps(x + c))));
+#elif defined(HAVE_NEON)
+	for (; c < n - 3; c += 4)
+		vst1q_f32(y + c, vmlaq_n_f32(vld1q_f32(y + c), vld1q_f32(x + c), s));
+#endif
+	for (; c < n; c++)
+		y[c] += s * x[c];
+}
+
+// Channel-wise average over a window of rows x cols pixels, with channels innermost.
+static inline void _ccv_nnc_avg_pool_window(const float* const ap, const int rows, const int cols, const int row_inc, const int col_inc, const int channel_size, float* const bp)
+{
+	const float inv = 1.0 / (rows * cols);
+	int c = 0, y, x;
+#if defined(HAVE_SSE2)
+	const __m128 inv4 = _mm_set1_ps(inv);
+	if (rows == 2 && cols == 2)
+		for (; c < channel_size - 3; c += 4)
+		{
+			const __m128 v0 = _mm_add_ps(_mm_loadu_ps(ap + c), _mm_loadu_ps(ap + col_inc + c));
+			const __m128 v1 = _mm_add_ps(_mm_loadu_ps(ap + row_inc + c), _mm_loadu_ps(ap + row_inc + col_inc + c));
+			_mm_storeu_ps(bp + c, _mm_mul_ps(_mm_add_ps(v0, v1), inv4));
+		}
+	else if (rows == 3 && cols == 3)
+		for (; c < channel_size - 3; c += 4)
+		{
+			const float* const ap0 = ap + c;
+			const float* const ap1 = ap0 + row_inc;
+			const float* const ap2 = ap1 + row_inc;
+			const __m128 v0 = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(ap0), _mm_loadu_ps(ap0 + col_inc)), _mm_loadu_ps(ap0 + 2 * col_inc));
+			const __m128 v1 = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(ap1), _mm_loadu_ps(ap1 + col_inc)), _mm_loadu_ps(ap1 + 2 * col_inc));
+			const __m128 v2 = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(ap2), _mm_loadu_ps(ap2 + col_inc)), _mm_loadu_ps(ap2 + 2 * col_inc));
+			_mm_storeu_ps(bp + c, _mm_mul_ps(_mm_add_ps(_mm_add_ps(v0, v1), v2), inv4));
+		}
+	else
+		for (; c < channel_size - 3; c += 4)
+		{
+			__m128 v = _mm_setzero_ps();
+			for (y = 0; y < rows; y++)
+				for (x = 0; x < cols; x++)
+					v = _mm_add_ps(v, _mm_loadu_ps(ap + y * row_inc + x * col_inc + c));
+			_mm_storeu_ps(bp + c, _mm_mul_ps(v, inv4));
+		}
+#elif defined(HAVE_NEON)
+	for (; c < channel_size - 3; c += 4)
+	{
+		float32x4_t v = vdupq_n_f32(0);
+		for (y = 0; y < rows; y++)
+			for (x = 0; x < cols; x++)
+				v = vaddq_f32(v, vld1q_f32(ap + y * row_inc + x * col_inc + c));
+		vst1q_f32(bp + c, vmulq_n_f32(v, inv));
+	}
+#endif
+	for (; c < channel_size; c++)
+	{
+		float v = 0;
+		for (y = 0; y < rows; y++)
+			for (x = 0; x < cols; x++)
+				v += ap[y * row_inc + x * col_inc + c];
+		bp[c] = v * inv;
+	}
+}
+
+static void _ccv_nnc_avg_pool_forw_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_avg_pool_parallel_t* const parallel = (ccv_nnc_avg_pool_parallel_t*)context;
+	const ccv_nnc_hint_t hint = parallel->hint;
+	const int* const size = parallel->size;
+	const int* const adim = parallel->adim;
+	const int* const bdim = parallel->bdim;
+	const int* const ainc = parallel->ainc;
+	const int* const binc = parallel->binc;
+	const int n = idx / bdim[0];
+	const int y = idx % bdim[0];
+	const int iy = y * hint.stride.dim[0] - hint.border.begin[0];
+	const int iy0 = ccv_max(iy, 0);
+	const int rows = ccv_min(iy + size[0], adim[0]) - iy0;
+	const float* const ap = parallel->a + n * parallel->a_batch_inc + iy0 * ainc[1] * ainc[2];
+	float* const bp = parallel->b + n * parallel->b_batch_inc + y * binc[1] * binc[2];
+	int x;
+	for (x = 0; x < bdim[1]; x++)
+	{
+		const int ix = x * hint.stride.dim[1] - hint.border.begin[1];
+		const int ix0 = ccv_max(ix, 0);
+		const int cols = ccv_min(ix + size[1], adim[1]) - ix0;
+		_ccv_nnc_avg_pool_window(ap + ix0 * ainc[2], rows, cols, ainc[1] * ainc[2], ainc[2], bdim[2], bp + x * binc[2]);
+	}
+}
+
+#define CCV_NNC_AVG_POOL_CHANNEL_BLOCK (64)
+
+static void _ccv_nnc_avg_pool_forw_global_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_avg_pool_parallel_t* const parallel = (ccv_nnc_avg_pool_parallel_t*)context;
+	const int* const adim = parallel->adim;
+	const int* const ainc = parallel->ainc;
+	const int n = idx / parallel->channel_blocks;
+	const int c0 = (idx % parallel->channel_blocks) * CCV_NNC_AVG_POOL_CHANNEL_BLOCK;
+	const int channel_size = ccv_min(CCV_NNC_AVG_POOL_CHANNEL_BLOCK, adim[2] - c0);
+	const float* const ap = parallel->a + n * parallel->a_batch_inc + c0;
+	float* const bp = parallel->b + n * parallel->b_batch_inc + c0;
+	// Sum each block of channels over all pixels in the stack, and only scale at the end.
+	float v[CCV_NNC_AVG_POOL_CHANNEL_BLOCK] = {};
+	int y, x;
+	for (y = 0; y < adim[0]; y++)
+		for (x = 0; x < adim[1]; x++)
+			_ccv_nnc_avg_pool_axpy(v, 1, ap + (y * ainc[1] + x) * ainc[2], channel_size);
+	const float inv = 1.0 / (adim[0] * adim[1]);
+	for (x = 0; x < channel_size; x++)
+		bp[x] = v[x] * inv;
+}
+
+static void _ccv_nnc_avg_pool_back_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_avg_pool_parallel_t* const parallel = (ccv_nnc_avg_pool_parallel_t*)context;
+	const ccv_nnc_hint_t hint = parallel->hint;
+	const int* const size = parallel->size;
+	// For backward, a is the gradient and b is the output gradient, adim and bdim follow.
+	const int* const gdim = parallel->adim;
+	const int* const hdim = parallel->bdim;
+	const int* const ginc = parallel->ainc;
+	const int* const hinc = parallel->binc;
+	const int channel_size = gdim[2];
+	// Gather from every output whose window covers this input row, so rows never write over each other.
+	const int n = idx / hdim[0];
+	const int iy = idx % hdim[0];
+	float* const hp = parallel->b + n * parallel->b_batch_inc + iy * hinc[1] * hinc[2];
+	const int y0 = ccv_max(0, (iy + hint.border.begin[0] - size[0] + hint.stride.dim[0]) / hint.stride.dim[0]);
+	const int y1 = ccv_min(gdim[0] - 1, (iy + hint.border.begin[0]) / hint.stride.dim[0]);
+	int x, y, j;
+	for (x = 0; x < hdim[1]; x++)
+		memset(hp + x * hinc[2], 0, sizeof(float) * channel_size);
+	for (y = y0; y <= y1; y++)
+	{
+		const float* const gp = parallel->a + n * parallel->a_batch_inc + y * ginc[1] * ginc[2];
+		const int wy = y * hint.stride.dim[0] - hint.border.begin[0];
+		const int rows = ccv_min(wy + size[0], hdim[0]) - ccv_max(wy, 0);
+		for (x = 0; x < gdim[1]; x++)
+		{
+			const int ix = x * hint.stride.dim[1] - hint.border.begin[1];
+			const int ix0 = ccv_max(ix, 0);
+			const int ix1 = ccv_min(ix + size[1], hdim[1]);
+			const float inv = 1.0 / (rows * (ix1 - ix0));
+			for (j = ix0; j < ix1; j++)
+				_ccv_nnc_avg_pool_axpy(hp + j * hinc[2], inv, gp + x * ginc[2], channel_size);
+		}
+	}
+}
+
+static int _ccv_nnc_avg_pool_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 1);
+	const ccv_nnc_tensor_view_t* a = (ccv_nnc_tensor_view_t*)inputs[0];
+	assert(output_size == 1);
+	ccv_nnc_tensor_view_t* b = (ccv_nnc_tensor_view_t*)outputs[0];
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	assert(b_nd == CCV_NNC_MAX_DIM + 1 || b_nd == CCV_NNC_MAX_DIM + 2);
+	const int* bdim = (b_nd == CCV_NNC_MAX_DIM + 1) ? b->info.dim : b->info.dim + 1;
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == CCV_NNC_MAX_DIM + 1) ? a->inc : a->inc + 1) : adim;
+	const int* binc = CCV_IS_TENSOR_VIEW(b) ? ((b_nd == CCV_NNC_MAX_DIM + 1) ? b->inc : b->inc + 1) : bdim;
+	assert(adim[CCV_NNC_MAX_DIM] == bdim[CCV_NNC_MAX_DIM]);
+	const int batch_size = a_nd == CCV_NNC_MAX_DIM + 2 ? a->info.dim[0] : 1;
+	assert(batch_size == (b_nd == CCV_NNC_MAX_DIM + 2 ? b->info.dim[0] : 1));
+	ccv_nnc_avg_pool_parallel_t parallel = {
+		.hint = hint,
+		.size = cmd.info.size.dim,
+		.a = a->data.f32,
+		.b = b->data.f32,
+		.adim = adim,
+		.bdim = bdim,
+		.ainc = ainc,
+		.binc = binc,
+		.a_batch_inc = ainc[0] * ainc[1] * ainc[2],
+		.b_batch_inc = binc[0] * binc[1] * binc[2],
+		.channel_blocks = (adim[2] + CCV_NNC_AVG_POOL_CHANNEL_BLOCK - 1) / CCV_NNC_AVG_POOL_CHANNEL_BLOCK,
+	};
+	// Global average pooling has only one output per image, split the channels instead of the rows.
+	if (bdim[0] == 1 && bdim[1] == 1 && hint.border.begin[0] <= 0 && hint.border.begin[1] <= 0 &&
+		cmd.info.size.dim[0] >= adim[0] && cmd.info.size.dim[1] >= adim[1])
+		ccv_nnc_parallel_for(batch_size * parallel.channel_blocks, 0, _ccv_nnc_avg_pool_forw_global_parallel, &parallel);
+	else
+		ccv_nnc_parallel_for(batch_size * bdim[0], 0, _ccv_nnc_avg_pool_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_avg_pool_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size >= 1);
+	const ccv_nnc_tensor_view_t* g = (ccv_nnc_tensor_view_t*)inputs[0];
+	assert(output_size == 1);
+	ccv_nnc_tensor_view_t* h = (ccv_nnc_tensor_view_t*)outputs[0];
+	const int g_nd = ccv_nnc_tensor_nd(g->info.dim);
+	assert(g_nd == CCV_NNC_MAX_DIM + 1 || g_nd == CCV_NNC_MAX_DIM + 2);
+	const int* gdim = (g_nd == CCV_NNC_MAX_DIM + 1) ? g->info.dim : g->info.dim + 1;
+	const int h_nd = ccv_nnc_tensor_nd(h->info.dim);
+	assert(h_nd == CCV_NNC_MAX_DIM + 1 || h_nd == CCV_NNC_MAX_DIM + 2);
+	const int* hdim = (h_nd == CCV_NNC_MAX_DIM + 1) ? h->info.dim : h->info.dim + 1;
+	const int* ginc = CCV_IS_TENSOR_VIEW(g) ? ((g_nd == CCV_NNC_MAX_DIM + 1) ? g->inc : g->inc + 1) : gdim;
+	const int* hinc = CCV_IS_TENSOR_VIEW(h) ? ((h_nd == CCV_NNC_MAX_DIM + 1) ? h->inc : h->inc + 1) : hdim;
+	assert(gdim[CCV_NNC_MAX_DIM] == hdim[CCV_NNC_MAX_DIM]);
+	const int batch_size = h_nd == CCV_NNC_MAX_DIM + 2 ? h->info.dim[0] : 1;
+	assert(batch_size == (g_nd == CCV_NNC_MAX_DIM + 2 ? g->info.dim[0] : 1));
+	ccv_nnc_avg_pool_parallel_t parallel = {
+		.hint = hint,
+		.size = cmd.info.size.dim,
+		.a = g->data.f32,
+		.b = h->data.f32,
+		.adim = gdim,
+		.bdim = hdim,
+		.ainc = ginc,
+		.binc = hinc,
+		.a_batch_inc = ginc[0] * ginc[1] * ginc[2],
+		.b_batch_inc = hinc[0] * hinc[1] * hinc[2],
+	};
+	ccv_nnc_parallel_for(batch_size * hdim[0], 0, _ccv_nnc_avg_pool_back_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_AVERAGE_POOL_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_avg_pool_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_AVERAGE_POOL_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_avg_pool_back;
+}
@@ -0,0 +1,280 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#elif defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+typedef struct {
+	ccv_nnc_hint_t hint;
+	const int* size; // The pooling window.
+	int batch_size;
+	const float* a;
+	float* b;
+	const float* g;
+	float* h;
+	const int* adim;
+	const int* bdim;
+	const int* ainc;
+	const int* binc;
+	const int* ginc;
+	const int* hinc;
+	int a_batch_inc;
+	int b_batch_inc;
+	int g_batch_inc;
+	int h_batch_inc;
+} ccv_nnc_max_pool_parallel_t;
+
+// Channel-wise max over a window of rows x cols pixels, with channels innermost.
+static inline void _ccv_nnc_max_pool_window(const float* const ap, const int rows, const int cols, const int row_inc, const int col_inc, const int channel_size, float* const bp)
+{
+	int c = 0, y, x;
+#if defined(HAVE_SSE2)
+	if (rows == 2 && cols == 2)
+		for (; c < channel_size - 3; c += 4)
+		{
+			const __m128 v0 = _mm_max_ps(_mm_loadu_ps(ap + c), _mm_loadu_ps(ap + col_inc + c));
+			const __m128 v1 = _mm_max_ps(_mm_loadu_ps(ap + row_inc + c), _mm_loadu_ps(ap + row_inc + col_inc + c));
+			_mm_storeu_ps(bp + c, _mm_max_ps(v0, v1));
+		}
+	else if (rows == 3 && cols == 3)
+		for (; c < channel_size - 3; c += 4)
+		{
+			const float* const ap0 = ap + c;
+			const float* const ap1 = ap0 + row_inc;
+			const float* const ap2 = ap1 + row_inc;
+			const __m128 v0 = _mm_max_ps(_mm_max_ps(_mm_loadu_ps(ap0), _mm_loadu_ps(ap0 + col_inc)), _mm_loadu_ps(ap0 + 2 * col_inc));
+			const __m128 v1 = _mm_max_ps(_mm_max_ps(_mm_loadu_ps(ap1), _mm_loadu_ps(ap1 + col_inc)), _mm_loadu_ps(ap1 + 2 * col_inc));
+			const __m128 v2 = _mm_max_ps(_mm_max_ps(_mm_loadu_ps(ap2), _mm_loadu_ps(ap2 + col_inc)), _mm_loadu_ps(ap2 + 2 * col_inc));
+			_mm_storeu_ps(bp + c, _mm_max_ps(_mm_max_ps(v0, v1), v2));
+		}
+	else
+		for (; c < channel_size - 3; c += 4)
+		{
+			__m128 v = _mm_loadu_ps(ap + c);
+			for (y = 0; y < rows; y++)
+				for (x = 0; x < cols; x++)
+					v = _mm_max_ps(v, _mm_loadu_ps(ap + y * row_inc + x * col_inc + c));
+			_mm_storeu_ps(bp + c, v);
+		}
+#elif defined(HAVE_NEON)
+	for (; c < channel_size - 3; c += 4)
+	{
+		float32x4_t v = vld1q_f32(ap + c);
+		for (y = 0; y < rows; y++)
+			for (x = 0; x < cols; x++)
+				v = vmaxq_f32(v, vld1q_f32(ap + y * row_inc + x * col_inc + c));
+		vst1q_f32(bp + c, v);
+	}
+#endif
+	for (; c < channel_size; c++)
+	{
+		float v = ap[c];
+		for (y = 0; y < rows; y++)
+			for (x = 0; x < cols; x++)
+				v = ccv_max(v, ap[y * row_inc + x * col_inc + c]);
+		bp[c] = v;
+	}
+}
+
+static void _ccv_nnc_max_pool_forw_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_max_pool_parallel_t* const parallel = (ccv_nnc_max_pool_parallel_t*)context;
+	const ccv_nnc_hint_t hint = parallel->hint;
+	const int* const size = parallel->size;
+	const int* const adim = parallel->adim;
+	const int* const bdim = parallel->bdim;
+	const int* const ainc = parallel->ainc;
+	const int* const binc = parallel->binc;
+	const int n = idx / bdim[0];
+	const int y = idx % bdim[0];
+	const int iy = y * hint.stride.dim[0] - hint.border.begin[0];
+	const int iy0 = ccv_max(iy, 0);
+	const int rows = ccv_min(iy + size[0], adim[0]) - iy0;
+	const float* const ap = parallel->a + n * parallel->a_batch_inc + iy0 * ainc[1] * ainc[2];
+	float* const bp = parallel->b + n * parallel->b_batch_inc + y * binc[1] * binc[2];
+	int x;
+	for (x = 0; x < bdim[1]; x++)
+	{
+		const int ix = x * hint.stride.dim[1] - hint.border.begin[1];
+		const int ix0 = ccv_max(ix, 0);
+		const int cols = ccv_min(ix + size[1], adim[1]) - ix0;
+		_ccv_nnc_max_pool_window(ap + ix0 * ainc[2], rows, cols, ainc[1] * ainc[2], ainc[2], bdim[2], (float*)bp + x * binc[2]);
+	}
+}
+
+static void _ccv_nnc_max_pool_back_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_max_pool_parallel_t* const parallel = (ccv_nnc_max_pool_parallel_t*)context;
+	const ccv_nnc_hint_t hint = parallel->hint;
+	const int* const size = parallel->size;
+	const int* const adim = parallel->adim;
+	const int* const bdim = parallel->bdim;
+	const int* const ainc = parallel->ainc;
+	const int* const binc = parallel->binc;
+	const int* const ginc = parallel->ginc;
+	const int* const hinc = parallel->hinc;
+	const int channel_size = bdim[2];
+	// Gather from every output whose window covers this input row, so rows never write over each other.
+	const int n = idx / adim[0];
+	const int iy = idx % adim[0];
+	const float* const ap = parallel->a + n * parallel->a_batch_inc + iy * ainc[1] * ainc[2];
+	float* const hp = parallel->h + n * parallel->h_batch_inc + iy * hinc[1] * hinc[2];
+	const int y0 = ccv_max(0, (iy + hint.border.begin[0] - size[0] + hint.stride.dim[0]) / hint.stride.dim[0]);
+	const int y1 = ccv_min(bdim[0] - 1, (iy + hint.border.begin[0]) / hint.stride.dim[0]);
+	int x, y, j, c;
+	for (x = 0; x < adim[1]; x++)
+		memset(hp + x * hinc[2], 0, sizeof(float) * channel_size);
+	for (y = y0; y <= y1; y++)
+	{
+		const float* const bp = parallel->b + n * parallel->b_batch_inc + y * binc[1] * binc[2];
+		const float* const gp = parallel->g + n * parallel->g_batch_inc + y * ginc[1] * ginc[2];
+		for (x = 0; x < bdim[1]; x++)
+		{
+			const int ix = x * hint.stride.dim[1] - hint.border.begin[1];
+			const int ix0 = ccv_max(ix, 0);
+			const int ix1 = ccv_min(ix + size[1], adim[1]);
+			const float* const bpz = bp + x * binc[2];
+			const float* const gpz = gp + x * ginc[2];
+			for (j = ix0; j < ix1; j++)
+			{
+				const float* const apz = ap + j * ainc[2];
+				float* const hpz = hp + j * hinc[2];
+				c = 0;
+#if defined(HAVE_SSE2)
+				for (; c < channel_size - 3; c += 4)
+				{
+					const __m128 mask = _mm_cmpeq_ps(_mm_loadu_ps(apz + c), _mm_loadu_ps(bpz + c));
+					_mm_storeu_ps(hpz + c, _mm_add_ps(_mm_loadu_ps(hpz + c), _mm_and_ps(mask, _mm_loadu_ps(gpz + c))));
+				}
+#elif defined(HAVE_NEON)
+				for (; c < channel_size - 3; c += 4)
+				{
+					const uint32x4_t mask = vceqq_f32(vld1q_f32(apz + c), vld1q_f32(bpz + c));
+					vst1q_f32(hpz + c, vaddq_f32(vld1q_f32(hpz + c), vreinterpretq_f32_u32(vandq_u32(mask, vreinterpretq_u32_f32(vld1q_f32(gpz + c))))));
+				}
+#endif
+				for (; c < channel_size; c++)
+					if (apz[c] == bpz[c])
+						hpz[c] += gpz[c];
+			}
+		}
+	}
+}
+
+static int _ccv_nnc_max_pool_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 1);
+	const ccv_nnc_tensor_view_t* a = (ccv_nnc_tensor_view_t*)inputs[0];
+	assert(output_size == 1);
+	ccv_nnc_tensor_view_t* b = (ccv_nnc_tensor_view_t*)outputs[0];
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	assert(b_nd == CCV_NNC_MAX_DIM + 1 || b_nd == CCV_NNC_MAX_DIM + 2);
+	const int* bdim = (b_nd == CCV_NNC_MAX_DIM + 1) ? b->info.dim : b->info.dim + 1;
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == CCV_NNC_MAX_DIM + 1) ? a->inc : a->inc + 1) : adim;
+	const int* binc = CCV_IS_TENSOR_VIEW(b) ? ((b_nd == CCV_NNC_MAX_DIM + 1) ? b->inc : b->inc + 1) : bdim;
+	assert(adim[CCV_NNC_MAX_DIM] == bdim[CCV_NNC_MAX_DIM]);
+	const int batch_size = a_nd == CCV_NNC_MAX_DIM + 2 ? a->info.dim[0] : 1;
+	assert(batch_size == (b_nd == CCV_NNC_MAX_DIM + 2 ? b->info.dim[0] : 1));
+	ccv_nnc_max_pool_parallel_t parallel = {
+		.hint = hint,
+		.size = cmd.info.size.dim,
+		.batch_size = batch_size,
+		.a = a->data.f32,
+		.b = b->data.f32,
+		.adim = adim,
+		.bdim = bdim,
+		.ainc = ainc,
+		.binc = binc,
+		.a_batch_inc = ainc[0] * ainc[1] * ainc[2],
+		.b_batch_inc = binc[0] * binc[1] * binc[2],
+	};
+	ccv_nnc_parallel_for(batch_size * bdim[0], 0, _ccv_nnc_max_pool_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_max_pool_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 3);
+	const ccv_nnc_tensor_view_t* g = (ccv_nnc_tensor_view_t*)inputs[0]; // gradients
+	const ccv_nnc_tensor_view_t* a = (ccv_nnc_tensor_view_t*)inputs[1];
+	const ccv_nnc_tensor_view_t* b = (ccv_nnc_tensor_view_t*)inputs[2];
+	assert(output_size == 1);
+	ccv_nnc_tensor_view_t* h = (ccv_nnc_tensor_view_t*)outputs[0];
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	assert(b_nd == CCV_NNC_MAX_DIM + 1 || b_nd == CCV_NNC_MAX_DIM + 2);
+	const int* bdim = (b_nd == CCV_NNC_MAX_DIM + 1) ? b->info.dim : b->info.dim + 1;
+	const int g_nd = ccv_nnc_tensor_nd(g->info.dim);
+	assert(g_nd == b_nd);
+	const int* gdim = (g_nd == CCV_NNC_MAX_DIM + 1) ? g->info.dim : g->info.dim + 1;
+	const int h_nd = ccv_nnc_tensor_nd(h->info.dim);
+	assert(h_nd == a_nd);
+	const int* hdim = (h_nd == CCV_NNC_MAX_DIM + 1) ? h->info.dim : h->info.dim + 1;
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == CCV_NNC_MAX_DIM + 1) ? a->inc : a->inc + 1) : adim;
+	const int* binc = CCV_IS_TENSOR_VIEW(b) ? ((b_nd == CCV_NNC_MAX_DIM + 1) ? b->inc : b->inc + 1) : bdim;
+	const int* ginc = CCV_IS_TENSOR_VIEW(g) ? ((g_nd == CCV_NNC_MAX_DIM + 1) ? g->inc : g->inc + 1) : gdim;
+	const int* hinc = CCV_IS_TENSOR_VIEW(h) ? ((h_nd == CCV_NNC_MAX_DIM + 1) ? h->inc : h->inc + 1) : hdim;
+	int c;
+	for (c = 0; c < CCV_NNC_MAX_DIM_ALLOC; c++)
+	{
+		assert(a->info.dim[c] == h->info.dim[c]);
+		if (a->info.dim[c] == 0 || h->info.dim[c] == 0)
+			break;
+	}
+	for (c = 0; c < CCV_NNC_MAX_DIM_ALLOC; c++)
+	{
+		assert(b->info.dim[c] == g->info.dim[c]);
+		if (b->info.dim[c] == 0 || g->info.dim[c] == 0)
+			break;
+	}
+	const int batch_size = a_nd == CCV_NNC_MAX_DIM + 2 ? a->info.dim[0] : 1;
+	ccv_nnc_max_pool_parallel_t parallel = {
+		.hint = hint,
+		.size = cmd.info.size.dim,
+		.batch_size = batch_size,
+		.a = a->data.f32,
+		.b = b->data.f32,
+		.g = g->data.f32,
+		.h = h->data.f32,
+		.adim = adim,
+		.bdim = bdim,
+		.ainc = ainc,
+		.binc = binc,
+		.ginc = ginc,
+		.hinc = hinc,
+		.a_batch_inc = ainc[0] * ainc[1] * ainc[2],
+		.b_batch_inc = binc[0] * binc[1] * binc[2],
+		.g_batch_inc = ginc[0] * ginc[1] * ginc[2],
+		.h_batch_inc = hinc[0] * hinc[1] * hinc[2],
+	};
+	ccv_nnc_parallel_for(batch_size * adim[0], 0, _ccv_nnc_max_pool_back_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_MAX_POOL_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_max_pool_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_MAX_POOL_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_max_pool_back;
+}
@@ -0,0 +1,92 @@
+#include "ccv.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_internal.h"
+
+static int _ccv_nnc_quantize_forw_bitmask(const int input_size, const int output_size, const uint64_t* const input_bitmasks, const int input_bitmask_size, const uint64_t* const output_bitmasks, const int output_bitmask_size)
+{
+	// Output the quantized tensor and the scale.
+	if (input_size == 1 && input_bitmasks[0] == 1u && output_bitmasks[0] == ((1u << 0) | (1u << 1)))
+		return 1;
+	// Don't output the scale, only possible with a static scale.
+	if (input_size == 1 && input_bitmasks[0] == 1u && output_bitmasks[0] == 1u)
+		return 1;
+	return 0;
+}
+
+static int _ccv_nnc_dequantize_forw_bitmask(const int input_size, const int output_size, const uint64_t* const input_bitmasks, const int input_bitmask_size, const uint64_t* const output_bitmasks, const int output_bitmask_size)
+{
+	if (input_size == 2 && (input_bitmasks[0] & 3u) == ((1u << 0) | (1u << 1)) && output_bitmasks[0] == 1u)
+		return 1;
+	return 0;
+}
+
+static int _ccv_nnc_quantize_back_bitmask(const int input_size, const int output_size, const uint64_t* const input_bitmasks, const int input_bitmask_size, const uint64_t* const output_bitmasks, const int output_bitmask_size)
+{
+	// Straight-through, only need the gradient.
+	if ((input_bitmasks[0] & 1u) == 1u && output_bitmasks[0] == 1u)
+		return 1;
+	return 0;
+}
+
+static void _ccv_nnc_quantize_tensor_auto_forw(const ccv_nnc_cmd_param_t cmd, const ccv_nnc_tensor_param_t* const inputs, const int input_size, const ccv_nnc_hint_t hint, ccv_nnc_tensor_param_t* const outputs, const int output_size)
+{
+	assert(input_size >= 1);
+	assert(output_size >= 1);
+	outputs[0] = inputs[0];
+	outputs[0].datatype = CCV_8S;
+	if (output_size > 1)
+	{
+		// By default, one scale for the whole tensor.
+		memset(outputs[1].dim, 0, sizeof(outputs[1].dim));
+		outputs[1].type = inputs[0].type;
+		outputs[1].format = inputs[0].format;
+		outputs[1].datatype = CCV_32F;
+		outputs[1].dim[0] = 1;
+	}
+}
+
+static void _ccv_nnc_dequantize_tensor_auto_forw(const ccv_nnc_cmd_param_t cmd, const ccv_nnc_tensor_param_t* const inputs, const int input_size, const ccv_nnc_hint_t hint, ccv_nnc_tensor_param_t* const outputs, const int output_size)
+{
+	assert(input_size >= 1);
+	assert(output_size == 1);
+	outputs[0] = inputs[0];
+	outputs[0].datatype = CCV_32F;
+}
+
+REGISTER_COMMAND(CCV_NNC_QUANTIZE_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
+	FIND_BACKEND(ccv_nnc_quantize_cpu_ref.c)
+{
+	registry->bitmask = _ccv_nnc_quantize_forw_bitmask;
+	registry->tensor_auto = _ccv_nnc_quantize_tensor_auto_forw;
+}
+
+REGISTER_COMMAND(CCV_NNC_QUANTIZE_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
+	FIND_BACKEND(ccv_nnc_quantize_cpu_ref.c)
+{
+	registry->bitmask = _ccv_nnc_quantize_back_bitmask;
+	registry->tensor_auto = ccv_nnc_hint_tensor_auto_backward_from_gradient;
+}
+
+//@REGISTER_EASY_COMMAND_MACRO(CCV_NNC_QUANTIZE_FORWARD)
+#define CMD_QUANTIZE_FORWARD(_scale) ccv_nnc_cmd(CCV_NNC_QUANTIZE_FORWARD, 0, (ccv_nnc_cmd_param_t){.size={.dim={1,1,1}},.blas={.a={_scale,}}}, 0)
+//@REGISTER_EASY_COMMAND_MACRO(CCV_NNC_QUANTIZE_BACKWARD)
+#define CMD_QUANTIZE_BACKWARD(_scale) ccv_nnc_cmd(CCV_NNC_QUANTIZE_BACKWARD, 0, (ccv_nnc_cmd_param_t){.size={.dim={1,1,1}},.blas={.a={_scale,}}}, 0)
+
+REGISTER_COMMAND(CCV_NNC_DEQUANTIZE_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
+	FIND_BACKEND(ccv_nnc_quantize_cpu_ref.c)
+{
+	registry->bitmask = _ccv_nnc_dequantize_forw_bitmask;
+	registry->tensor_auto = _ccv_nnc_dequantize_tensor_auto_forw;
+}
+
+REGISTER_COMMAND(CCV_NNC_DEQUANTIZE_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
+	FIND_BACKEND(ccv_nnc_quantize_cpu_ref.c)
+{
+	registry->bitmask = _ccv_nnc_quantize_back_bitmask;
+	registry->tensor_auto = ccv_nnc_hint_tensor_auto_backward_from_gradient;
+}
+
+//@REGISTER_EASY_COMMAND_MACRO(CCV_NNC_DEQUANTIZE_FORWARD)
+#define CMD_DEQUANTIZE_FORWARD() ccv_nnc_cmd(CCV_NNC_DEQUANTIZE_FORWARD, 0, ccv_nnc_cmd_auto, 0)
+//@REGISTER_EASY_COMMAND_MACRO(CCV_NNC_DEQUANTIZE_BACKWARD)
+#define CMD_DEQUANTIZE_BACKWARD() ccv_nnc_cmd(CCV_NNC_DEQUANTIZE_BACKWARD, 0, ccv_nnc_cmd_auto, 0)
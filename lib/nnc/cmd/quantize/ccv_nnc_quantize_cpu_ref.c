@@ -0,0 +1,121 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+
+static int _ccv_nnc_quantize_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 1);
+	const ccv_nnc_tensor_t* const a = inputs[0];
+	ccv_nnc_tensor_t* const b = outputs[0];
+	ccv_nnc_tensor_t* const scale = output_size > 1 ? outputs[1] : 0;
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	assert(a->info.datatype == CCV_32F);
+	assert(b->info.datatype == CCV_8S);
+	const int count = ccv_nnc_tensor_count(a->info);
+	assert(count == ccv_nnc_tensor_count(b->info));
+	// Without a static scale, we have to compute the scale from the input.
+	assert(scale || cmd.info.blas.a[0] > 0);
+	assert(!scale || (!CCV_IS_TENSOR_VIEW(scale) && scale->info.datatype == CCV_32F));
+	// One scale per slice along the first dimension (per output channel for weights), or one for the whole tensor.
+	const int scale_count = scale ? ccv_nnc_tensor_count(scale->info) : 1;
+	assert(scale_count == 1 || scale_count == a->info.dim[0]);
+	const int slice_size = count / scale_count;
+	int i, j;
+	for (i = 0; i < scale_count; i++)
+	{
+		const float* const ap = a->data.f32 + i * slice_size;
+		int8_t* const bp = b->data.i8 + i * slice_size;
+		float s = cmd.info.blas.a[0];
+		if (s <= 0)
+		{
+			float max = 0;
+			for (j = 0; j < slice_size; j++)
+				max = ccv_max(max, fabsf(ap[j]));
+			s = max > 0 ? max / 127 : 1;
+		}
+		if (scale)
+			scale->data.f32[i] = s;
+		const float inv = 1.0 / s;
+		for (j = 0; j < slice_size; j++)
+			bp[j] = (int8_t)ccv_clamp((int)lrintf(ap[j] * inv), -127, 127);
+	}
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_dequantize_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 2);
+	assert(output_size == 1);
+	const ccv_nnc_tensor_t* const a = inputs[0];
+	const ccv_nnc_tensor_t* const scale = inputs[1];
+	ccv_nnc_tensor_t* const b = outputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	assert(!CCV_IS_TENSOR_VIEW(scale));
+	assert(a->info.datatype == CCV_8S);
+	assert(scale->info.datatype == CCV_32F);
+	assert(b->info.datatype == CCV_32F);
+	const int count = ccv_nnc_tensor_count(a->info);
+	assert(count == ccv_nnc_tensor_count(b->info));
+	const int scale_count = ccv_nnc_tensor_count(scale->info);
+	assert(scale_count == 1 || scale_count == a->info.dim[0]);
+	const int slice_size = count / scale_count;
+	int i, j;
+	for (i = 0; i < scale_count; i++)
+	{
+		const int8_t* const ap = a->data.i8 + i * slice_size;
+		float* const bp = b->data.f32 + i * slice_size;
+		const float s = scale->data.f32[i];
+		for (j = 0; j < slice_size; j++)
+			bp[j] = ap[j] * s;
+	}
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_quantize_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	// Straight-through estimator, the gradient passes as is.
+	assert(input_size >= 1);
+	assert(output_size >= 1);
+	ccv_nnc_cmd_exec(CMD_DATA_TRANSFER_FORWARD(), hint, flags, inputs, 1, outputs, 1, stream_context);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_QUANTIZE_FORWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F | CCV_8S;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_quantize_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_QUANTIZE_BACKWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_quantize_back;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_DEQUANTIZE_FORWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F | CCV_8S;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_dequantize_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_DEQUANTIZE_BACKWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_quantize_back;
+}
@@ -10,14 +10,14 @@ static int _ccv_nnc_random_bitmask(const int input_size, const int output_size,
 }
 
 REGISTER_COMMAND(CCV_NNC_RANDOM_UNIFORM_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_rand_uniform_cpu_ref.c, gpu/ccv_nnc_rand_uniform_gpu_ref.cu)
+	FIND_BACKEND(ccv_nnc_rand_uniform_cpu_ref.c, ccv_nnc_rand_uniform_cpu_opt.c, gpu/ccv_nnc_rand_uniform_gpu_ref.cu)
 {
 	registry->bitmask = _ccv_nnc_random_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
 }
 
 REGISTER_COMMAND(CCV_NNC_RANDOM_UNIFORM_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_rand_uniform_cpu_ref.c, gpu/ccv_nnc_rand_uniform_gpu_ref.cu)
+	FIND_BACKEND(ccv_nnc_rand_uniform_cpu_ref.c, ccv_nnc_rand_uniform_cpu_opt.c, gpu/ccv_nnc_rand_uniform_gpu_ref.cu)
 {
 	registry->bitmask = _ccv_nnc_random_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
@@ -29,14 +29,14 @@ REGISTER_COMMAND(CCV_NNC_RANDOM_UNIFORM_BACKWARD)(ccv_nnc_cmd_registry_t* const
 #define CMD_RANDOM_UNIFORM_BACKWARD(_lb, _ub) ccv_nnc_cmd(CCV_NNC_RANDOM_UNIFORM_BACKWARD, 0, (ccv_nnc_cmd_param_t){.size={.dim={1,1,1}},.blas={.a={_lb, _ub}}}, 0)
 
 REGISTER_COMMAND(CCV_NNC_RANDOM_NORMAL_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_rand_normal_cpu_ref.c, gpu/ccv_nnc_rand_normal_gpu_ref.cu)
+	FIND_BACKEND(ccv_nnc_rand_normal_cpu_ref.c, ccv_nnc_rand_normal_cpu_opt.c, gpu/ccv_nnc_rand_normal_gpu_ref.cu)
 {
 	registry->bitmask = _ccv_nnc_random_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
 }
 
 REGISTER_COMMAND(CCV_NNC_RANDOM_NORMAL_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_rand_normal_cpu_ref.c, gpu/ccv_nnc_rand_normal_gpu_ref.cu)
+	FIND_BACKEND(ccv_nnc_rand_normal_cpu_ref.c, ccv_nnc_rand_normal_cpu_opt.c, gpu/ccv_nnc_rand_normal_gpu_ref.cu)
 {
 	registry->bitmask = _ccv_nnc_random_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
@@ -0,0 +1,98 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+
+// Shared methods.
+#include "../_ccv_nnc_cpu_opt.h"
+
+typedef struct {
+	float* ap;
+	int count;
+	uint64_t seed;
+	uint64_t offset;
+	float std;
+	float mean;
+} ccv_nnc_random_normal_parallel_t;
+
+static void _ccv_nnc_random_normal_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_random_normal_parallel_t* const parallel = (ccv_nnc_random_normal_parallel_t*)context;
+	const int offset = idx * CCV_NNC_RAND_CHUNK;
+	const int count = ccv_min(parallel->count - offset, CCV_NNC_RAND_CHUNK);
+	float* const ap = parallel->ap + offset;
+	_ccv_nnc_philox_uniform(parallel->seed, parallel->offset + offset, ap, count);
+	const float std = parallel->std;
+	const float mean = parallel->mean;
+	// Box-Muller transform, the (2k)-th and (2k + 1)-th uniform number generate the (2k)-th and (2k + 1)-th normal number.
+	int i = 0, j;
+#if defined(HAVE_SSE2)
+	const __m128 stdv = _mm_set1_ps(std);
+	const __m128 neg2 = _mm_set1_ps(-2);
+	float mag[4], r1[4];
+	for (; i < count - 7; i += 8)
+	{
+		const __m128 v0 = _mm_loadu_ps(ap + i);
+		const __m128 v1 = _mm_loadu_ps(ap + i + 4);
+		_mm_storeu_ps(mag, _mm_mul_ps(stdv, _mm_sqrt_ps(_mm_mul_ps(neg2, _ccv_nnc_log_ps(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0)))))));
+		_mm_storeu_ps(r1, _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1)));
+		for (j = 0; j < 4; j++)
+		{
+			ap[i + j * 2] = mag[j] * cosf(CCV_PI * 2 * r1[j]) + mean;
+			ap[i + j * 2 + 1] = mag[j] * sinf(CCV_PI * 2 * r1[j]) + mean;
+		}
+	}
+#endif
+	for (; i < count; i += 2)
+	{
+		float r = 0;
+		if (i + 1 < count)
+			r = ap[i + 1];
+		else { // The last number of an odd sized tensor, draw its pair from the stream.
+			float r4[4]; // It may fill up a whole block of 4.
+			_ccv_nnc_philox_uniform(parallel->seed, parallel->offset + offset + i + 1, r4, 1);
+			r = r4[0];
+		}
+		const float mag = std * sqrtf(-2 * logf(ap[i]));
+		ap[i] = mag * cosf(CCV_PI * 2 * r) + mean;
+		if (i + 1 < count)
+			ap[i + 1] = mag * sinf(CCV_PI * 2 * r) + mean;
+	}
+}
+
+static int _ccv_nnc_random_normal(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(output_size == 1);
+	ccv_nnc_tensor_t* const a = outputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	const int count = ccv_nnc_tensor_count(a->info);
+	ccv_nnc_random_normal_parallel_t parallel = {
+		.ap = a->data.f32,
+		.count = count,
+		.seed = cmd.info.rand.seed ? cmd.info.rand.seed : (uint64_t)(uintptr_t)a->data.f32, // Otherwise, seeded the same way as the reference implementation.
+		.offset = cmd.info.rand.seed ? cmd.info.rand.offset : 0,
+		.std = cmd.info.blas.a[0],
+		.mean = cmd.info.blas.a[1],
+	};
+	ccv_nnc_parallel_for((count + CCV_NNC_RAND_CHUNK - 1) / CCV_NNC_RAND_CHUNK, 0, _ccv_nnc_random_normal_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_RANDOM_NORMAL_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_random_normal;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_RANDOM_NORMAL_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_random_normal;
+}
@@ -0,0 +1,77 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+
+// Shared methods.
+#include "../_ccv_nnc_cpu_opt.h"
+
+typedef struct {
+	float* ap;
+	int count;
+	uint64_t seed;
+	uint64_t offset;
+	float l;
+	float u;
+} ccv_nnc_random_uniform_parallel_t;
+
+static void _ccv_nnc_random_uniform_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_random_uniform_parallel_t* const parallel = (ccv_nnc_random_uniform_parallel_t*)context;
+	const int offset = idx * CCV_NNC_RAND_CHUNK;
+	const int count = ccv_min(parallel->count - offset, CCV_NNC_RAND_CHUNK);
+	float* const ap = parallel->ap + offset;
+	_ccv_nnc_philox_uniform(parallel->seed, parallel->offset + offset, ap, count);
+	const float l = parallel->l;
+	const float u = parallel->u;
+	int i = 0;
+#if defined(HAVE_SSE2)
+	const __m128 lv = _mm_set1_ps(l);
+	const __m128 uv = _mm_set1_ps(u);
+	const __m128 one = _mm_set1_ps(1);
+	for (; i < count - 3; i += 4)
+	{
+		const __m128 r = _mm_loadu_ps(ap + i);
+		_mm_storeu_ps(ap + i, _mm_add_ps(_mm_mul_ps(r, uv), _mm_mul_ps(_mm_sub_ps(one, r), lv)));
+	}
+#endif
+	for (; i < count; i++)
+		ap[i] = ap[i] * u + (1 - ap[i]) * l;
+}
+
+static int _ccv_nnc_random_uniform(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(output_size == 1);
+	ccv_nnc_tensor_t* const a = outputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	const int count = ccv_nnc_tensor_count(a->info);
+	ccv_nnc_random_uniform_parallel_t parallel = {
+		.ap = a->data.f32,
+		.count = count,
+		.seed = cmd.info.rand.seed ? cmd.info.rand.seed : (uint64_t)(uintptr_t)a->data.f32, // Otherwise, seeded the same way as the reference implementation.
+		.offset = cmd.info.rand.seed ? cmd.info.rand.offset : 0,
+		.l = cmd.info.blas.a[0],
+		.u = cmd.info.blas.a[1],
+	};
+	ccv_nnc_parallel_for((count + CCV_NNC_RAND_CHUNK - 1) / CCV_NNC_RAND_CHUNK, 0, _ccv_nnc_random_uniform_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_RANDOM_UNIFORM_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_random_uniform;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_RANDOM_UNIFORM_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_random_uniform;
+}
@@ -0,0 +1,34 @@
+/**********************************************************
+ * C-based/Cached/Core Computer Vision Library
+ * Liu Liu, 2010-02-01
+ **********************************************************/
+
+/**********************************************************
+ * CCV - Neural Network Collection
+ **********************************************************/
+
+#ifndef GUARD_ccv_nnc_reduce_cpu_opt_h
+#define GUARD_ccv_nnc_reduce_cpu_opt_h
+
+#include "ccv.h"
+#include "nnc/ccv_nnc.h"
+
+enum {
+	CCV_NNC_REDUCE_CPU_OPT_SUM, // b = sum(a)
+	CCV_NNC_REDUCE_CPU_OPT_MAX, // b = max(a)
+};
+
+enum {
+	CCV_NNC_CMD_OPT_REDUCE_ALGO_DIRECT, // Long reductions with few outputs are split into one partial per thread.
+	CCV_NNC_CMD_OPT_REDUCE_ALGO_DETERMINISTIC, // Split into partials of fixed size and combine them in a tree, the result doesn't depend on the thread count.
+	CCV_NNC_CMD_OPT_REDUCE_ALGO_COUNT
+};
+
+/**
+ * Reduce a into b. The dimensions of b are either the same as a, or 1 for the axes reduced. Neither can be a tensor
+ * view. The axes are collapsed into [r0, o, r, i] with r0, r reduced, and returns CCV_NNC_EXEC_INVALID if that is not
+ * possible.
+ */
+int _ccv_nnc_reduce_cpu_opt(const int op, const int algorithm, const ccv_nnc_tensor_view_t* const a, ccv_nnc_tensor_view_t* const b, ccv_nnc_stream_context_t* const stream_context);
+
+#endif
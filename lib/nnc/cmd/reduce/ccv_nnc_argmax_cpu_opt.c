@@ -0,0 +1,171 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <emmintrin.h>
+#endif
+
+// Below this many elements, it is not worth to wake up other threads.
+#define CCV_NNC_ARGMAX_PARALLEL_MIN (32768)
+// Outer axis argmax is split into blocks of this many columns.
+#define CCV_NNC_ARGMAX_COLUMN_BLOCK (256)
+
+typedef struct {
+	int axis_dim;
+	int dim_after_axis;
+	int column_blocks;
+	const float* a;
+	int* bi; // One of bi and bf is set, depends on the output datatype.
+	float* bf;
+} ccv_nnc_argmax_cpu_opt_parallel_t;
+
+// The index of the first maximum of a contiguous row of n elements.
+static int _ccv_nnc_argmax_row(const float* const a, const int n)
+{
+	int x = 1;
+	float max = a[0];
+	int idx = 0;
+#if defined(HAVE_SSE2)
+	if (n >= 8)
+	{
+		// Each lane keeps the first maximum of its own elements, then the lanes are merged.
+		__m128 max4 = _mm_loadu_ps(a);
+		__m128i idx4 = _mm_setr_epi32(0, 1, 2, 3);
+		__m128i x4 = idx4;
+		const __m128i four = _mm_set1_epi32(4);
+		for (x = 4; x < n - 3; x += 4)
+		{
+			x4 = _mm_add_epi32(x4, four);
+			const __m128 a4 = _mm_loadu_ps(a + x);
+			const __m128 gt = _mm_cmpgt_ps(a4, max4);
+			max4 = _mm_or_ps(_mm_and_ps(gt, a4), _mm_andnot_ps(gt, max4));
+			idx4 = _mm_or_si128(_mm_and_si128(_mm_castps_si128(gt), x4), _mm_andnot_si128(_mm_castps_si128(gt), idx4));
+		}
+		float maxs[4];
+		int idxs[4];
+		_mm_storeu_ps(maxs, max4);
+		_mm_storeu_si128((__m128i*)idxs, idx4);
+		max = maxs[0];
+		idx = idxs[0];
+		int y;
+		for (y = 1; y < 4; y++)
+			if (maxs[y] > max || (maxs[y] == max && idxs[y] < idx))
+				max = maxs[y], idx = idxs[y];
+	}
+#endif
+	for (; x < n; x++)
+		if (a[x] > max)
+			max = a[x], idx = x;
+	return idx;
+}
+
+// The indexes of the first maximums along the rows, for n columns.
+static void _ccv_nnc_argmax_columns(const float* const a, const int stride, const int rows, int* const idx, const int n)
+{
+	int x = 0, k;
+#if defined(HAVE_SSE2)
+	for (; x < n - 3; x += 4)
+	{
+		__m128 max4 = _mm_loadu_ps(a + x);
+		__m128i idx4 = _mm_setzero_si128();
+		for (k = 1; k < rows; k++)
+		{
+			const __m128 a4 = _mm_loadu_ps(a + k * stride + x);
+			const __m128 gt = _mm_cmpgt_ps(a4, max4);
+			max4 = _mm_or_ps(_mm_and_ps(gt, a4), _mm_andnot_ps(gt, max4));
+			idx4 = _mm_or_si128(_mm_and_si128(_mm_castps_si128(gt), _mm_set1_epi32(k)), _mm_andnot_si128(_mm_castps_si128(gt), idx4));
+		}
+		_mm_storeu_si128((__m128i*)(idx + x), idx4);
+	}
+#endif
+	for (; x < n; x++)
+	{
+		float max = a[x];
+		int i = 0;
+		for (k = 1; k < rows; k++)
+			if (a[k * stride + x] > max)
+				max = a[k * stride + x], i = k;
+		idx[x] = i;
+	}
+}
+
+static void _ccv_nnc_argmax_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_argmax_cpu_opt_parallel_t* const parallel = (ccv_nnc_argmax_cpu_opt_parallel_t*)context;
+	const int axis_dim = parallel->axis_dim;
+	const int dim_after_axis = parallel->dim_after_axis;
+	const int i = idx / parallel->column_blocks;
+	const int j = (idx % parallel->column_blocks) * CCV_NNC_ARGMAX_COLUMN_BLOCK;
+	const float* const ap0 = parallel->a + (size_t)i * dim_after_axis * axis_dim + j;
+	const size_t b_offset = (size_t)i * dim_after_axis + j;
+	if (dim_after_axis == 1)
+	{
+		const int x = _ccv_nnc_argmax_row(ap0, axis_dim);
+		if (parallel->bi)
+			parallel->bi[b_offset] = x;
+		else
+			parallel->bf[b_offset] = x;
+		return;
+	}
+	const int n = ccv_min(dim_after_axis - j, CCV_NNC_ARGMAX_COLUMN_BLOCK);
+	if (parallel->bi)
+		_ccv_nnc_argmax_columns(ap0, dim_after_axis, axis_dim, parallel->bi + b_offset, n);
+	else {
+		int x[CCV_NNC_ARGMAX_COLUMN_BLOCK];
+		_ccv_nnc_argmax_columns(ap0, dim_after_axis, axis_dim, x, n);
+		int k;
+		for (k = 0; k < n; k++)
+			parallel->bf[b_offset + k] = x[k];
+	}
+}
+
+static int _ccv_nnc_argmax_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 1);
+	ccv_nnc_tensor_t* const a = inputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	assert(output_size == 1);
+	ccv_nnc_tensor_t* const b = outputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	const int axis = cmd.info.reduce.axis[0];
+	assert(cmd.info.reduce.count == 1);
+	assert(axis >= 0);
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(axis < a_nd);
+	const int tensor_count = ccv_nnc_tensor_count(a->info);
+	const int axis_dim = a->info.dim[axis];
+	int i;
+	int dim_after_axis = 1;
+	for (i = axis + 1; i < a_nd; i++)
+		dim_after_axis *= a->info.dim[i];
+	const int dim_before_axis = tensor_count / axis_dim / dim_after_axis;
+	assert(ccv_nnc_tensor_count(b->info) == tensor_count / axis_dim);
+	assert(b->info.datatype == CCV_32F || b->info.datatype == CCV_32S);
+	ccv_nnc_argmax_cpu_opt_parallel_t parallel = {
+		.axis_dim = axis_dim,
+		.dim_after_axis = dim_after_axis,
+		.column_blocks = (dim_after_axis + CCV_NNC_ARGMAX_COLUMN_BLOCK - 1) / CCV_NNC_ARGMAX_COLUMN_BLOCK,
+		.a = a->data.f32,
+		.bi = b->info.datatype == CCV_32S ? b->data.i32 : 0,
+		.bf = b->info.datatype == CCV_32F ? b->data.f32 : 0,
+	};
+	const int task_count = dim_before_axis * parallel.column_blocks;
+	if (tensor_count < CCV_NNC_ARGMAX_PARALLEL_MIN)
+	{
+		for (i = 0; i < task_count; i++)
+			_ccv_nnc_argmax_parallel(&parallel, i);
+	} else
+		ccv_nnc_parallel_for(task_count, 0, _ccv_nnc_argmax_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_ARGMAX_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F | CCV_32S;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_argmax_forw;
+}
@@ -28,7 +28,7 @@ static int _ccv_nnc_reduce_sum_back_bitmask(const int input_size, const int outp
 }
 
 REGISTER_COMMAND(CCV_NNC_REDUCE_SUM_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_reduce_sum_cpu_ref.c, gpu/ccv_nnc_reduce_sum_gpu_cudnn.cu)
+	FIND_BACKEND(ccv_nnc_reduce_sum_cpu_ref.c, ccv_nnc_reduce_sum_cpu_opt.c, gpu/ccv_nnc_reduce_sum_gpu_cudnn.cu)
 {
 	registry->bitmask = _ccv_nnc_reduce_sum_forw_bitmask;
 	registry->tensor_auto = _ccv_nnc_reduce_tensor_auto_forw;
@@ -62,7 +62,7 @@ static int _ccv_nnc_reduce_max_back_bitmask(const int input_size, const int outp
 }
 
 REGISTER_COMMAND(CCV_NNC_REDUCE_MAX_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_reduce_max_cpu_ref.c)
+	FIND_BACKEND(ccv_nnc_reduce_max_cpu_ref.c, ccv_nnc_reduce_max_cpu_opt.c)
 {
 	registry->bitmask = _ccv_nnc_reduce_max_forw_bitmask;
 	registry->tensor_auto = _ccv_nnc_reduce_tensor_auto_forw;
@@ -110,7 +110,7 @@ static void _ccv_nnc_argmax_tensor_auto_back(const ccv_nnc_cmd_param_t cmd, cons
 }
 
 REGISTER_COMMAND(CCV_NNC_ARGMAX_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_argmax_cpu_ref.c, gpu/ccv_nnc_argmax_gpu_ref.cu)
+	FIND_BACKEND(ccv_nnc_argmax_cpu_ref.c, ccv_nnc_argmax_cpu_opt.c, gpu/ccv_nnc_argmax_gpu_ref.cu)
 {
 	registry->bitmask = _ccv_nnc_argmax_forw_bitmask;
 	registry->tensor_auto = _ccv_nnc_argmax_tensor_auto_forw;
@@ -0,0 +1,258 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#endif
+#include "../_ccv_nnc_reduce_cpu_opt.h"
+
+// Below this many elements, it is not worth to wake up other threads.
+#define CCV_NNC_REDUCE_PARALLEL_MIN (32768)
+// Outer axis reductions are split into blocks of this many columns.
+#define CCV_NNC_REDUCE_COLUMN_BLOCK (256)
+// The reduced axes are only split into partials if there are at most this many outputs.
+#define CCV_NNC_REDUCE_PARTIAL_MAX (4096)
+// For the deterministic algorithm, each partial covers roughly this many elements.
+#define CCV_NNC_REDUCE_CHUNK_SIZE (16384)
+
+typedef struct {
+	int op;
+	int r0; // The size of the leading reduced axes.
+	int o; // The size of the kept axes in between.
+	int r; // The size of the reduced axes.
+	int i; // The size of the trailing kept axes, 1 if the reduction is on the inner most axes.
+	int column_blocks;
+	int chunk_size; // The number of reduced rows (r0 * r) each partial covers.
+	int chunk_count;
+	const float* a;
+	float* b; // Either the output, or chunk_count partials of size o * i.
+} ccv_nnc_reduce_cpu_opt_parallel_t;
+
+static inline float _ccv_nnc_reduce_op(const int op, const float x, const float y)
+{
+	return op == CCV_NNC_REDUCE_CPU_OPT_SUM ? x + y : ccv_max(x, y);
+}
+
+static inline float _ccv_nnc_reduce_identity(const int op)
+{
+	return op == CCV_NNC_REDUCE_CPU_OPT_SUM ? 0 : -FLT_MAX;
+}
+
+// Reduce a contiguous row of n elements.
+static float _ccv_nnc_reduce_row(const int op, const float* const a, const int n)
+{
+	int x = 0;
+	float v = _ccv_nnc_reduce_identity(op);
+#if defined(HAVE_SSE2)
+	if (n >= 16)
+	{
+		__m128 v0 = _mm_set1_ps(v);
+		__m128 v1 = v0, v2 = v0, v3 = v0;
+		if (op == CCV_NNC_REDUCE_CPU_OPT_SUM)
+		{
+			for (; x < n - 15; x += 16)
+			{
+				v0 = _mm_add_ps(v0, _mm_loadu_ps(a + x));
+				v1 = _mm_add_ps(v1, _mm_loadu_ps(a + x + 4));
+				v2 = _mm_add_ps(v2, _mm_loadu_ps(a + x + 8));
+				v3 = _mm_add_ps(v3, _mm_loadu_ps(a + x + 12));
+			}
+			v0 = _mm_add_ps(_mm_add_ps(v0, v1), _mm_add_ps(v2, v3));
+		} else {
+			for (; x < n - 15; x += 16)
+			{
+				v0 = _mm_max_ps(v0, _mm_loadu_ps(a + x));
+				v1 = _mm_max_ps(v1, _mm_loadu_ps(a + x + 4));
+				v2 = _mm_max_ps(v2, _mm_loadu_ps(a + x + 8));
+				v3 = _mm_max_ps(v3, _mm_loadu_ps(a + x + 12));
+			}
+			v0 = _mm_max_ps(_mm_max_ps(v0, v1), _mm_max_ps(v2, v3));
+		}
+		float s[4];
+		_mm_storeu_ps(s, v0);
+		v = _ccv_nnc_reduce_op(op, _ccv_nnc_reduce_op(op, s[0], s[1]), _ccv_nnc_reduce_op(op, s[2], s[3]));
+	}
+#endif
+	for (; x < n; x++)
+		v = _ccv_nnc_reduce_op(op, v, a[x]);
+	return v;
+}
+
+// Accumulate rows of n elements, rows apart by stride, into c.
+static void _ccv_nnc_reduce_rows(const int op, const float* a, const size_t stride, const int rows, float* const c, const int n)
+{
+	int y, x;
+	for (y = 0; y < rows; y++, a += stride)
+	{
+		x = 0;
+#if defined(HAVE_SSE2)
+		if (op == CCV_NNC_REDUCE_CPU_OPT_SUM)
+			for (; x < n - 3; x += 4)
+				_mm_storeu_ps(c + x, _mm_add_ps(_mm_loadu_ps(c + x), _mm_loadu_ps(a + x)));
+		else
+			for (; x < n - 3; x += 4)
+				_mm_storeu_ps(c + x, _mm_max_ps(_mm_loadu_ps(c + x), _mm_loadu_ps(a + x)));
+#endif
+		for (; x < n; x++)
+			c[x] = _ccv_nnc_reduce_op(op, c[x], a[x]);
+	}
+}
+
+// Reduce reduced rows [t0, t1) of output o, columns [i0, i0 + n) into c.
+static void _ccv_nnc_reduce_slice(const ccv_nnc_reduce_cpu_opt_parallel_t* const parallel, const int o, const int i0, const int n, int t0, const int t1, float* const c)
+{
+	const int op = parallel->op;
+	int x;
+	if (parallel->i == 1)
+	{
+		assert(i0 == 0 && n == 1);
+		float v = _ccv_nnc_reduce_identity(op);
+		while (t0 < t1)
+		{
+			const int r0 = t0 / parallel->r;
+			const int r = t0 % parallel->r;
+			const int rows = ccv_min(t1 - t0, parallel->r - r);
+			v = _ccv_nnc_reduce_op(op, v, _ccv_nnc_reduce_row(op, parallel->a + ((size_t)r0 * parallel->o + o) * parallel->r + r, rows));
+			t0 += rows;
+		}
+		c[0] = v;
+		return;
+	}
+	const float identity = _ccv_nnc_reduce_identity(op);
+	for (x = 0; x < n; x++)
+		c[x] = identity;
+	while (t0 < t1)
+	{
+		const int r0 = t0 / parallel->r;
+		const int r = t0 % parallel->r;
+		const int rows = ccv_min(t1 - t0, parallel->r - r);
+		_ccv_nnc_reduce_rows(op, parallel->a + (((size_t)r0 * parallel->o + o) * parallel->r + r) * parallel->i + i0, parallel->i, rows, c, n);
+		t0 += rows;
+	}
+}
+
+static void _ccv_nnc_reduce_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_reduce_cpu_opt_parallel_t* const parallel = (ccv_nnc_reduce_cpu_opt_parallel_t*)context;
+	const int o = idx / parallel->column_blocks;
+	const int i0 = (idx % parallel->column_blocks) * CCV_NNC_REDUCE_COLUMN_BLOCK;
+	const int n = ccv_min(parallel->i - i0, CCV_NNC_REDUCE_COLUMN_BLOCK);
+	_ccv_nnc_reduce_slice(parallel, o, i0, n, 0, parallel->r0 * parallel->r, parallel->b + (size_t)o * parallel->i + i0);
+}
+
+static void _ccv_nnc_reduce_partial_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_reduce_cpu_opt_parallel_t* const parallel = (ccv_nnc_reduce_cpu_opt_parallel_t*)context;
+	const int t0 = idx * parallel->chunk_size;
+	const int t1 = ccv_min(t0 + parallel->chunk_size, parallel->r0 * parallel->r);
+	float* const partial = parallel->b + (size_t)idx * parallel->o * parallel->i;
+	int o;
+	for (o = 0; o < parallel->o; o++)
+		_ccv_nnc_reduce_slice(parallel, o, 0, parallel->i, t0, t1, partial + (size_t)o * parallel->i);
+}
+
+static void _ccv_nnc_reduce_combine(const int op, float* const c, const float* const a, const int n)
+{
+	int x;
+	for (x = 0; x < n; x++)
+		c[x] = _ccv_nnc_reduce_op(op, c[x], a[x]);
+}
+
+int _ccv_nnc_reduce_cpu_opt(const int op, const int algorithm, const ccv_nnc_tensor_view_t* const a, ccv_nnc_tensor_view_t* const b, ccv_nnc_stream_context_t* const stream_context)
+{
+	if (CCV_IS_TENSOR_VIEW(a) || CCV_IS_TENSOR_VIEW(b))
+		return CCV_NNC_EXEC_INVALID;
+	assert(ccv_nnc_tensor_nd(a->info.dim) <= CCV_NNC_MAX_DIM + 2);
+	assert(ccv_nnc_tensor_nd(b->info.dim) <= CCV_NNC_MAX_DIM + 2);
+	int adim[CCV_NNC_MAX_DIM_ALLOC];
+	int bdim[CCV_NNC_MAX_DIM_ALLOC];
+	ccv_nnc_tensor_view_get_dim(a, adim);
+	ccv_nnc_tensor_view_get_dim(b, bdim);
+	assert(ccv_nnc_tensor_view_check_broadcast_dim(b, adim));
+	// Collapse the adjacent axes that are both reduced, or both kept.
+	int size[CCV_NNC_MAX_DIM + 2];
+	int reduced[CCV_NNC_MAX_DIM + 2];
+	int x, nd = 0;
+	for (x = 0; x < CCV_NNC_MAX_DIM + 2; x++)
+	{
+		if (adim[x] == 1)
+			continue;
+		const int is_reduced = (bdim[x] == 1);
+		if (nd > 0 && reduced[nd - 1] == is_reduced)
+			size[nd - 1] *= adim[x];
+		else {
+			size[nd] = adim[x];
+			reduced[nd] = is_reduced;
+			++nd;
+		}
+	}
+	ccv_nnc_reduce_cpu_opt_parallel_t parallel = {
+		.op = op,
+		.r0 = 1,
+		.o = 1,
+		.r = 1,
+		.i = 1,
+		.a = a->data.f32,
+	};
+	x = nd - 1;
+	if (x >= 0 && !reduced[x])
+		parallel.i = size[x--];
+	if (x >= 0)
+		parallel.r = size[x--];
+	if (x >= 0)
+		parallel.o = size[x--];
+	if (x >= 0)
+		parallel.r0 = size[x--];
+	if (x >= 0)
+		return CCV_NNC_EXEC_INVALID;
+	const int t = parallel.r0 * parallel.r;
+	const int output_count = parallel.o * parallel.i;
+	parallel.column_blocks = (parallel.i + CCV_NNC_REDUCE_COLUMN_BLOCK - 1) / CCV_NNC_REDUCE_COLUMN_BLOCK;
+	const int task_count = parallel.o * parallel.column_blocks;
+	parallel.chunk_count = 1;
+	if (output_count <= CCV_NNC_REDUCE_PARTIAL_MAX && (size_t)t * output_count >= CCV_NNC_REDUCE_PARALLEL_MIN)
+	{
+		if (algorithm == CCV_NNC_CMD_OPT_REDUCE_ALGO_DETERMINISTIC)
+		{
+			// Only depends on the shape, thus, the same partials regardless of the number of threads.
+			parallel.chunk_size = ccv_max(1, CCV_NNC_REDUCE_CHUNK_SIZE / output_count);
+			parallel.chunk_count = (t + parallel.chunk_size - 1) / parallel.chunk_size;
+		} else {
+			const int thread_count = ccv_nnc_thread_pool_size();
+			if (task_count < thread_count)
+			{
+				parallel.chunk_size = (t + thread_count - 1) / thread_count;
+				parallel.chunk_count = (t + parallel.chunk_size - 1) / parallel.chunk_size;
+			}
+		}
+	}
+	if (parallel.chunk_count <= 1)
+	{
+		parallel.b = b->data.f32;
+		if ((size_t)t * output_count < CCV_NNC_REDUCE_PARALLEL_MIN)
+		{
+			for (x = 0; x < task_count; x++)
+				_ccv_nnc_reduce_parallel(&parallel, x);
+		} else
+			ccv_nnc_parallel_for(task_count, 0, _ccv_nnc_reduce_parallel, &parallel);
+		return CCV_NNC_EXEC_SUCCESS;
+	}
+	float* const partials = (float*)ccv_nnc_stream_context_get_workspace(stream_context, sizeof(float) * parallel.chunk_count * output_count, CCV_TENSOR_CPU_MEMORY);
+	parallel.b = partials;
+	ccv_nnc_parallel_for(parallel.chunk_count, 0, _ccv_nnc_reduce_partial_parallel, &parallel);
+	int k;
+	if (algorithm == CCV_NNC_CMD_OPT_REDUCE_ALGO_DETERMINISTIC)
+	{
+		// Pairwise, such that the rounding error grows with the log of the number of partials.
+		int stride;
+		for (stride = 1; stride < parallel.chunk_count; stride *= 2)
+			for (k = 0; k + stride < parallel.chunk_count; k += stride * 2)
+				_ccv_nnc_reduce_combine(op, partials + (size_t)k * output_count, partials + (size_t)(k + stride) * output_count, output_count);
+	} else
+		for (k = 1; k < parallel.chunk_count; k++)
+			_ccv_nnc_reduce_combine(op, partials, partials + (size_t)k * output_count, output_count);
+	memcpy(b->data.f32, partials, sizeof(float) * output_count);
+	return CCV_NNC_EXEC_SUCCESS;
+}
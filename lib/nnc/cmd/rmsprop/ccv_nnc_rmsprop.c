@@ -6,14 +6,22 @@ static int _ccv_nnc_rmsprop_forw_bitmask(const int input_size, const int output_
 {
 	// 4 inputs (gradient, x, momentum, squared gradient average)
 	// 3 outputs (y, new momentum, new squared gradient average)
-	if (input_bitmasks[0] == 15u && output_bitmasks[0] == 7u)
-		return 1;
-	return 0;
+	// These can be repeated to update multiple parameters with one command.
+	if (input_size < 4 || input_size % 4 != 0 || output_size != input_size / 4 * 3)
+		return 0;
+	int i;
+	for (i = 0; i < input_size; i++)
+		if (!(input_bitmasks[i >> 6] & ((uint64_t)1 << (i & 63))))
+			return 0;
+	for (i = 0; i < output_size; i++)
+		if (!(output_bitmasks[i >> 6] & ((uint64_t)1 << (i & 63))))
+			return 0;
+	return 1;
 }
 
 static int _ccv_nnc_rmsprop_allow_inplace(const int input_idx, const int input_size, const int output_idx, const int output_size)
 {
-	if (input_idx == output_idx + 1)
+	if (input_idx % 4 == output_idx % 3 + 1 && input_idx / 4 == output_idx / 3)
 		return 1;
 	return 0;
 }
@@ -28,7 +36,7 @@ static void _ccv_nnc_rmsprop_tensor_auto_forw(const ccv_nnc_cmd_param_t cmd, con
 {
 	int i;
 	for (i = 0; i < output_size; i++)
-		outputs[i] = inputs[0];
+		outputs[i] = inputs[i / 3 * 4];
 }
 
 static void _ccv_nnc_rmsprop_tensor_auto_back(const ccv_nnc_cmd_param_t cmd, const ccv_nnc_tensor_param_t* const inputs, const int input_size, const ccv_nnc_hint_t hint, ccv_nnc_tensor_param_t* const outputs, const int output_size)
@@ -37,7 +45,7 @@ static void _ccv_nnc_rmsprop_tensor_auto_back(const ccv_nnc_cmd_param_t cmd, con
 }
 
 REGISTER_COMMAND(CCV_NNC_RMSPROP_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_rmsprop_cpu_ref.c, gpu/ccv_nnc_rmsprop_gpu_ref.cu)
+	FIND_BACKEND(ccv_nnc_rmsprop_cpu_ref.c, ccv_nnc_rmsprop_cpu_opt.c, gpu/ccv_nnc_rmsprop_gpu_ref.cu)
 {
 	registry->bitmask = _ccv_nnc_rmsprop_forw_bitmask;
 	registry->tensor_auto = _ccv_nnc_rmsprop_tensor_auto_forw;
@@ -0,0 +1,110 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+
+// Shared methods.
+#include "../_ccv_nnc_cpu_opt.h"
+
+typedef struct {
+	const ccv_nnc_multi_tensor_chunk_t* chunks;
+	ccv_nnc_tensor_t* const* inputs;
+	ccv_nnc_tensor_t* const* outputs;
+	float clip;
+	float rate;
+	float decay;
+	float alpha;
+	float momentum;
+	float epsilon;
+} ccv_nnc_rmsprop_parallel_t;
+
+static void _ccv_nnc_rmsprop_forw_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_rmsprop_parallel_t* const parallel = (ccv_nnc_rmsprop_parallel_t*)context;
+	const ccv_nnc_multi_tensor_chunk_t chunk = parallel->chunks[idx];
+	ccv_nnc_tensor_t* const* const inputs = parallel->inputs + chunk.group * 4;
+	ccv_nnc_tensor_t* const* const outputs = parallel->outputs + chunk.group * 3;
+	const float* const gp = inputs[0]->data.f32 + chunk.offset;
+	const float* const ap = inputs[1]->data.f32 + chunk.offset;
+	const float* const mp = inputs[2]->data.f32 + chunk.offset;
+	const float* const vp = inputs[3]->data.f32 + chunk.offset;
+	float* const bp = outputs[0]->data.f32 + chunk.offset;
+	float* const np = outputs[1]->data.f32 + chunk.offset;
+	float* const up = outputs[2]->data.f32 + chunk.offset;
+	const float clip = parallel->clip;
+	const float rate = parallel->rate;
+	const float decay = parallel->decay;
+	const float alpha = parallel->alpha;
+	const float momentum = parallel->momentum;
+	const float epsilon = parallel->epsilon;
+	const int count = chunk.count;
+	int x = 0;
+#if defined(HAVE_SSE2)
+	const __m128 clip4 = _mm_set1_ps(clip);
+	const __m128 rate4 = _mm_set1_ps(rate);
+	const __m128 decay4 = _mm_set1_ps(decay);
+	const __m128 alpha4 = _mm_set1_ps(alpha);
+	const __m128 one_minus_alpha4 = _mm_set1_ps(1 - alpha);
+	const __m128 momentum4 = _mm_set1_ps(momentum);
+	const __m128 epsilon4 = _mm_set1_ps(epsilon);
+	for (; x < count - 3; x += 4)
+	{
+		const __m128 a = _mm_loadu_ps(ap + x);
+		const __m128 grad = _mm_add_ps(_mm_mul_ps(clip4, _mm_loadu_ps(gp + x)), _mm_mul_ps(decay4, a));
+		const __m128 vel = _mm_add_ps(_mm_mul_ps(alpha4, _mm_loadu_ps(vp + x)), _mm_mul_ps(_mm_mul_ps(one_minus_alpha4, grad), grad));
+		const __m128 mom = _mm_add_ps(_mm_mul_ps(momentum4, _mm_loadu_ps(mp + x)), _mm_div_ps(grad, _mm_add_ps(_mm_sqrt_ps(vel), epsilon4)));
+		_mm_storeu_ps(up + x, vel);
+		_mm_storeu_ps(np + x, mom);
+		_mm_storeu_ps(bp + x, _mm_sub_ps(a, _mm_mul_ps(rate4, mom)));
+	}
+#endif
+	for (; x < count; x++)
+	{
+		float grad = clip * gp[x];
+		grad += decay * ap[x];
+		const float vel = up[x] = alpha * vp[x] + (1 - alpha) * grad * grad;
+		const float mom = np[x] = momentum * mp[x] + grad / (sqrtf(vel) + epsilon);
+		bp[x] = ap[x] - rate * mom;
+	}
+}
+
+static int _ccv_nnc_rmsprop_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	// Multiple parameters can be updated in one command, 4 inputs and 3 outputs each.
+	assert(input_size % 4 == 0);
+	assert(output_size == input_size / 4 * 3);
+	int i;
+	for (i = 0; i < input_size; i++)
+		if (CCV_IS_TENSOR_VIEW(inputs[i]))
+			return CCV_NNC_EXEC_INVALID;
+	for (i = 0; i < output_size; i++)
+		if (CCV_IS_TENSOR_VIEW(outputs[i]))
+			return CCV_NNC_EXEC_INVALID;
+	const int chunk_count = _ccv_nnc_multi_tensor_chunks(inputs, input_size, 4, 0);
+	double* const sums = (double*)ccv_nnc_stream_context_get_workspace(stream_context, (sizeof(double) + sizeof(ccv_nnc_multi_tensor_chunk_t)) * chunk_count, CCV_TENSOR_CPU_MEMORY);
+	ccv_nnc_multi_tensor_chunk_t* const chunks = (ccv_nnc_multi_tensor_chunk_t*)(sums + chunk_count);
+	_ccv_nnc_multi_tensor_chunks(inputs, input_size, 4, chunks);
+	ccv_nnc_rmsprop_parallel_t parallel = {
+		.chunks = chunks,
+		.inputs = inputs,
+		.outputs = outputs,
+		.clip = _ccv_nnc_multi_tensor_clip(cmd.info.rmsprop.max_norm, 1, inputs, 4, chunks, chunk_count, sums),
+		.rate = cmd.info.rmsprop.rate,
+		.decay = cmd.info.rmsprop.decay,
+		.alpha = cmd.info.rmsprop.alpha,
+		.momentum = cmd.info.rmsprop.momentum,
+		.epsilon = cmd.info.rmsprop.epsilon,
+	};
+	ccv_nnc_parallel_for(chunk_count, 0, _ccv_nnc_rmsprop_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_RMSPROP_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_rmsprop_forw;
+}
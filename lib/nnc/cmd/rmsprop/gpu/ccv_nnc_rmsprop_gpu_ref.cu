@@ -23,10 +23,8 @@ __global__ void _ccv_nnc_rmsprop_kernel(const size_t tensor_count, const float r
 	}
 }
 
-static int _ccv_nnc_rmsprop_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+static void _ccv_nnc_rmsprop_forw_gpu_ref(const ccv_nnc_cmd_t cmd, ccv_nnc_tensor_t* const* const inputs, ccv_nnc_tensor_t* const* const outputs, ccv_nnc_stream_context_t* const stream_context)
 {
-	assert(input_size == 4);
-	assert(output_size == 3);
 	cudaStream_t stream = ccv_nnc_stream_context_get_stream(stream_context);
 	const float rate = cmd.info.rmsprop.rate;
 	const float decay = cmd.info.rmsprop.decay;
@@ -71,6 +69,19 @@ static int _ccv_nnc_rmsprop_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t h
 		else if (b->info.datatype == CCV_32F)
 			_ccv_nnc_rmsprop_kernel<<<CUDA_GET_BLOCKS(tensor_count), CUDA_NUM_THREADS, 0, stream>>>(tensor_count, rate, decay, alpha, momentum, epsilon, g->data.f32, a->data.f32, m->data.f32, v->data.f32, b->data.f32, n->data.f32, u->data.f32);
 	}
+}
+
+static int _ccv_nnc_rmsprop_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	// Multiple parameters can be updated in one command, 4 inputs and 3 outputs each.
+	assert(input_size % 4 == 0);
+	assert(output_size == input_size / 4 * 3);
+	// Clipping to the gradient norm across all parameters is not implemented on GPU.
+	if (cmd.info.rmsprop.max_norm > 0)
+		return CCV_NNC_EXEC_INVALID;
+	int i;
+	for (i = 0; i < input_size / 4; i++)
+		_ccv_nnc_rmsprop_forw_gpu_ref(cmd, inputs + i * 4, outputs + i * 3, stream_context);
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
@@ -36,14 +36,14 @@ static void _ccv_nnc_roi_align_tensor_auto_back(const ccv_nnc_cmd_param_t cmd, c
 }
 
 REGISTER_COMMAND(CCV_NNC_ROI_ALIGN_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_roi_align_cpu_ref.c, gpu/ccv_nnc_roi_align_gpu_ref.cu)
+	FIND_BACKEND(ccv_nnc_roi_align_cpu_ref.c, ccv_nnc_roi_align_cpu_opt.c, gpu/ccv_nnc_roi_align_gpu_ref.cu)
 {
 	registry->bitmask = _ccv_nnc_roi_align_forw_bitmask;
 	registry->tensor_auto = _ccv_nnc_roi_align_tensor_auto_forw;
 }
 
 REGISTER_COMMAND(CCV_NNC_ROI_ALIGN_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_roi_align_cpu_ref.c, gpu/ccv_nnc_roi_align_gpu_ref.cu)
+	FIND_BACKEND(ccv_nnc_roi_align_cpu_ref.c, ccv_nnc_roi_align_cpu_opt.c, gpu/ccv_nnc_roi_align_gpu_ref.cu)
 {
 	registry->bitmask = _ccv_nnc_roi_align_back_bitmask;
 	registry->tensor_auto = _ccv_nnc_roi_align_tensor_auto_back;
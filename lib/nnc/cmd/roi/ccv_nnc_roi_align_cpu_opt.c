@@ -0,0 +1,412 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#endif
+
+typedef struct {
+	int i0, i1, mute;
+	float r;
+} roi_align_coeffs_t;
+
+typedef struct {
+	int bin_h, bin_w;
+	roi_align_coeffs_t* y_coeffs;
+	roi_align_coeffs_t* x_coeffs;
+	int* bin_h_at_y;
+	int* bin_w_at_x;
+} ccv_nnc_roi_align_table_t;
+
+typedef struct {
+	const float* ap;
+	const float* bp;
+	float* cp;
+	const float* gp;
+	float* op;
+	int h, w, ch;
+	int pool_h, pool_w;
+	int a_n, b_n, c_n; // For backward, a is o and c is g.
+	int aninc, bninc, cninc;
+	int ainc[CCV_NNC_MAX_DIM + 1];
+	int cinc[CCV_NNC_MAX_DIM + 1];
+	ccv_nnc_roi_align_table_t* tables;
+} ccv_nnc_roi_align_parallel_t;
+
+// How many channels each backward task owns. Tasks own disjoint channels thus can scatter without atomics.
+#define CCV_NNC_ROI_ALIGN_CH_BLOCK (32)
+
+static inline void _ccv_nnc_roi_align_bin_size(const float roi_h, const float roi_w, const int pool_h, const int pool_w, int* const bin_h, int* const bin_w)
+{
+	*bin_h = (int)ceilf(roi_h / pool_h);
+	*bin_w = (int)ceilf(roi_w / pool_w);
+}
+
+static void _ccv_nnc_roi_align_coeffs(const int h, const int w, const float roi_y, const float roi_x, const float roi_h, const float roi_w, const int pool_h, const int pool_w, const ccv_nnc_roi_align_table_t* const table)
+{
+	const int bin_h = table->bin_h;
+	const int bin_w = table->bin_w;
+	const float scale_y = roi_h / (bin_h * pool_h);
+	const float scale_x = roi_w / (bin_w * pool_w);
+	roi_align_coeffs_t* const y_coeffs = table->y_coeffs;
+	roi_align_coeffs_t* const x_coeffs = table->x_coeffs;
+	int x, y, i, j;
+	for (i = 0; i < pool_h; i++)
+	{
+		const int pi = i * bin_h;
+		int count = 0;
+		for (y = 0; y < bin_h; y++)
+		{
+			const float ay = roi_y + (y + pi + 0.5) * scale_y - 0.5;
+			const int iy = (int)floorf(ay);
+			y_coeffs[pi + y].i0 = ccv_clamp(iy, 0, h - 1);
+			y_coeffs[pi + y].i1 = ccv_clamp(iy + 1, 0, h - 1);
+			y_coeffs[pi + y].r = ay - iy;
+			const int mute = (iy + 1 < 0 || iy > h - 1);
+			y_coeffs[pi + y].mute = mute;
+			if (!mute)
+				++count;
+		}
+		table->bin_h_at_y[i] = count;
+	}
+	for (j = 0; j < pool_w; j++)
+	{
+		const int pj = j * bin_w;
+		int count = 0;
+		for (x = 0; x < bin_w; x++)
+		{
+			const float ax = roi_x + (x + pj + 0.5) * scale_x - 0.5;
+			const int ix = (int)floorf(ax);
+			x_coeffs[pj + x].i0 = ccv_clamp(ix, 0, w - 1);
+			x_coeffs[pj + x].i1 = ccv_clamp(ix + 1, 0, w - 1);
+			x_coeffs[pj + x].r = ax - ix;
+			const int mute = (ix + 1 < 0 || ix > w - 1);
+			x_coeffs[pj + x].mute = mute;
+			if (!mute)
+				++count;
+		}
+		table->bin_w_at_x[j] = count;
+	}
+}
+
+static void _ccv_nnc_roi_align_coeffs_parallel(void* const context, const int n)
+{
+	const ccv_nnc_roi_align_parallel_t* const parallel = (ccv_nnc_roi_align_parallel_t*)context;
+	const float* const bp = parallel->bp + n * parallel->bninc;
+	const int h = parallel->h;
+	const int w = parallel->w;
+	_ccv_nnc_roi_align_coeffs(h, w, bp[1] * h, bp[0] * w, bp[3] * h, bp[2] * w, parallel->pool_h, parallel->pool_w, parallel->tables + n);
+}
+
+// Compute the interpolation tables once for every distinct ROI, in parallel.
+static void _ccv_nnc_roi_align_tables(ccv_nnc_roi_align_parallel_t* const parallel, ccv_nnc_stream_context_t* const stream_context)
+{
+	const int b_n = parallel->b_n;
+	const int h = parallel->h;
+	const int w = parallel->w;
+	const int pool_h = parallel->pool_h;
+	const int pool_w = parallel->pool_w;
+	size_t size = sizeof(ccv_nnc_roi_align_table_t) * b_n;
+	int n, bin_h, bin_w;
+	for (n = 0; n < b_n; n++)
+	{
+		const float* const bp = parallel->bp + n * parallel->bninc;
+		_ccv_nnc_roi_align_bin_size(bp[3] * h, bp[2] * w, pool_h, pool_w, &bin_h, &bin_w);
+		size += sizeof(roi_align_coeffs_t) * (bin_h * pool_h + bin_w * pool_w) + sizeof(int) * (pool_h + pool_w);
+	}
+	ccv_nnc_roi_align_table_t* const tables = (ccv_nnc_roi_align_table_t*)ccv_nnc_stream_context_get_workspace(stream_context, size, CCV_TENSOR_CPU_MEMORY);
+	roi_align_coeffs_t* coeffs = (roi_align_coeffs_t*)(tables + b_n);
+	for (n = 0; n < b_n; n++)
+	{
+		const float* const bp = parallel->bp + n * parallel->bninc;
+		_ccv_nnc_roi_align_bin_size(bp[3] * h, bp[2] * w, pool_h, pool_w, &bin_h, &bin_w);
+		tables[n].bin_h = bin_h;
+		tables[n].bin_w = bin_w;
+		tables[n].y_coeffs = coeffs;
+		tables[n].x_coeffs = coeffs + bin_h * pool_h;
+		tables[n].bin_h_at_y = (int*)(tables[n].x_coeffs + bin_w * pool_w);
+		tables[n].bin_w_at_x = tables[n].bin_h_at_y + pool_h;
+		coeffs = (roi_align_coeffs_t*)(tables[n].bin_w_at_x + pool_w);
+	}
+	parallel->tables = tables;
+	ccv_nnc_parallel_for(b_n, 0, _ccv_nnc_roi_align_coeffs_parallel, parallel);
+}
+
+static void _ccv_nnc_roi_align_forw_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_roi_align_parallel_t* const parallel = (ccv_nnc_roi_align_parallel_t*)context;
+	const int pool_h = parallel->pool_h;
+	const int pool_w = parallel->pool_w;
+	const int ch = parallel->ch;
+	const int* const ainc = parallel->ainc;
+	const int* const cinc = parallel->cinc;
+	const int n = idx / pool_h;
+	const int i = idx % pool_h;
+	const ccv_nnc_roi_align_table_t* const table = parallel->tables + (n % parallel->b_n);
+	const int bin_h = table->bin_h;
+	const int bin_w = table->bin_w;
+	const roi_align_coeffs_t* const y_coeffs = table->y_coeffs;
+	const roi_align_coeffs_t* const x_coeffs = table->x_coeffs;
+	const float* const apn = parallel->ap + (n % parallel->a_n) * parallel->aninc;
+	float* const cpn = parallel->cp + n * parallel->cninc + i * cinc[CCV_NNC_MAX_DIM - 1] * cinc[CCV_NNC_MAX_DIM];
+	const int pi = i * bin_h;
+	const int bin_hz = table->bin_h_at_y[i];
+	int j, x, y, k;
+	for (j = 0; j < pool_w; j++)
+	{
+		float* const cpz = cpn + j * cinc[CCV_NNC_MAX_DIM];
+		memset(cpz, 0, sizeof(float) * ch);
+		const int pj = j * bin_w;
+		const int bin_wz = table->bin_w_at_x[j];
+		if (bin_hz == 0 || bin_wz == 0)
+			continue;
+		const float inv = 1.0 / (bin_hz * bin_wz);
+		for (y = 0; y < bin_h; y++)
+		{
+			if (y_coeffs[pi + y].mute)
+				continue;
+			const float ry = y_coeffs[pi + y].r;
+			const int iy0 = y_coeffs[pi + y].i0;
+			const int iy1 = y_coeffs[pi + y].i1;
+			for (x = 0; x < bin_w; x++)
+			{
+				if (x_coeffs[pj + x].mute)
+					continue;
+				const float rx = x_coeffs[pj + x].r;
+				const int ix0 = x_coeffs[pj + x].i0;
+				const int ix1 = x_coeffs[pj + x].i1;
+				const float c00 = (1 - ry) * (1 - rx);
+				const float c01 = (1 - ry) * rx;
+				const float c10 = ry * (1 - rx);
+				const float c11 = ry * rx;
+				const float* const ap00 = apn + (iy0 * ainc[CCV_NNC_MAX_DIM - 1] + ix0) * ainc[CCV_NNC_MAX_DIM];
+				const float* const ap01 = apn + (iy0 * ainc[CCV_NNC_MAX_DIM - 1] + ix1) * ainc[CCV_NNC_MAX_DIM];
+				const float* const ap10 = apn + (iy1 * ainc[CCV_NNC_MAX_DIM - 1] + ix0) * ainc[CCV_NNC_MAX_DIM];
+				const float* const ap11 = apn + (iy1 * ainc[CCV_NNC_MAX_DIM - 1] + ix1) * ainc[CCV_NNC_MAX_DIM];
+				k = 0;
+#if defined(HAVE_SSE2)
+				const __m128 c00v = _mm_set1_ps(c00);
+				const __m128 c01v = _mm_set1_ps(c01);
+				const __m128 c10v = _mm_set1_ps(c10);
+				const __m128 c11v = _mm_set1_ps(c11);
+				for (; k < ch - 3; k += 4)
+				{
+					const __m128 v0 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(ap00 + k), c00v), _mm_mul_ps(_mm_loadu_ps(ap01 + k), c01v));
+					const __m128 v1 = _mm_add_ps(_mm_add_ps(v0, _mm_mul_ps(_mm_loadu_ps(ap10 + k), c10v)), _mm_mul_ps(_mm_loadu_ps(ap11 + k), c11v));
+					_mm_storeu_ps(cpz + k, _mm_add_ps(_mm_loadu_ps(cpz + k), v1));
+				}
+#endif
+				for (; k < ch; k++)
+					cpz[k] += ap00[k] * c00 + ap01[k] * c01 + ap10[k] * c10 + ap11[k] * c11;
+			}
+		}
+		for (k = 0; k < ch; k++)
+			cpz[k] *= inv;
+	}
+}
+
+static int _ccv_nnc_roi_align_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 2);
+	const ccv_nnc_tensor_view_t* a = (ccv_nnc_tensor_view_t*)inputs[0];
+	assert(output_size == 1);
+	const ccv_nnc_tensor_view_t* b = (ccv_nnc_tensor_view_t*)inputs[1];
+	ccv_nnc_tensor_view_t* c = (ccv_nnc_tensor_view_t*)outputs[0];
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int c_nd = ccv_nnc_tensor_nd(c->info.dim);
+	assert(c_nd == CCV_NNC_MAX_DIM + 1 || c_nd == CCV_NNC_MAX_DIM + 2);
+	const int* cdim = (c_nd == CCV_NNC_MAX_DIM + 1) ? c->info.dim : c->info.dim + 1;
+	assert(cdim[2] == adim[2]);
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == CCV_NNC_MAX_DIM + 1) ?  a->inc : a->inc + 1) : adim;
+	const int* cinc = CCV_IS_TENSOR_VIEW(c) ? ((c_nd == CCV_NNC_MAX_DIM + 1) ?  c->inc : c->inc + 1) : cdim;
+	const int a_n = ccv_nnc_tensor_get_n(a->info);
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	assert(b_nd == 1 || b_nd == 2);
+	const int b_n = b_nd == 1 ? 1 : b->info.dim[0];
+	const int c_n = ccv_nnc_tensor_get_n(c->info);
+	assert(c_n == ccv_max(a_n, b_n));
+	const int* binc = CCV_IS_TENSOR_VIEW(b) ? b->inc : b->info.dim;
+	ccv_nnc_roi_align_parallel_t parallel = {
+		.ap = a->data.f32,
+		.bp = b->data.f32,
+		.cp = c->data.f32,
+		.h = adim[0],
+		.w = adim[1],
+		.ch = cdim[2],
+		.pool_h = cdim[0],
+		.pool_w = cdim[1],
+		.a_n = a_n,
+		.b_n = b_n,
+		.c_n = c_n,
+		.aninc = a_nd == CCV_NNC_MAX_DIM + 1 ? 0 : ainc[0] * ainc[1] * ainc[2],
+		.bninc = b_nd == 1 ? 0 : binc[1],
+		.cninc = c_nd == CCV_NNC_MAX_DIM + 1 ? 0 : cinc[0] * cinc[1] * cinc[2],
+	};
+	memcpy(parallel.ainc, ainc, sizeof(parallel.ainc));
+	memcpy(parallel.cinc, cinc, sizeof(parallel.cinc));
+	_ccv_nnc_roi_align_tables(&parallel, stream_context);
+	ccv_nnc_parallel_for(c_n * parallel.pool_h, 0, _ccv_nnc_roi_align_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static void _ccv_nnc_roi_align_back_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_roi_align_parallel_t* const parallel = (ccv_nnc_roi_align_parallel_t*)context;
+	const int h = parallel->h;
+	const int w = parallel->w;
+	const int pool_h = parallel->pool_h;
+	const int pool_w = parallel->pool_w;
+	const int o_n = parallel->a_n;
+	const int* const oinc = parallel->ainc;
+	const int* const ginc = parallel->cinc;
+	const int ch_blocks = (parallel->ch + CCV_NNC_ROI_ALIGN_CH_BLOCK - 1) / CCV_NNC_ROI_ALIGN_CH_BLOCK;
+	const int on = idx / ch_blocks;
+	const int ch_start = (idx % ch_blocks) * CCV_NNC_ROI_ALIGN_CH_BLOCK;
+	const int ch = ccv_min(parallel->ch - ch_start, CCV_NNC_ROI_ALIGN_CH_BLOCK);
+	float* const opn = parallel->op + on * parallel->aninc + ch_start;
+	int n, i, j, x, y, k;
+	for (y = 0; y < h; y++)
+		for (x = 0; x < w; x++)
+			memset(opn + (y * oinc[CCV_NNC_MAX_DIM - 1] + x) * oinc[CCV_NNC_MAX_DIM], 0, sizeof(float) * ch);
+	// Every ROI that maps to this image, in the same order as the reference implementation.
+	for (n = on; n < parallel->c_n; n += o_n)
+	{
+		const ccv_nnc_roi_align_table_t* const table = parallel->tables + (n % parallel->b_n);
+		const int bin_h = table->bin_h;
+		const int bin_w = table->bin_w;
+		const roi_align_coeffs_t* const y_coeffs = table->y_coeffs;
+		const roi_align_coeffs_t* const x_coeffs = table->x_coeffs;
+		const float* gpn = parallel->gp + n * parallel->cninc + ch_start;
+		for (i = 0; i < pool_h; i++)
+		{
+			const int pi = i * bin_h;
+			const int bin_hz = table->bin_h_at_y[i];
+			for (j = 0; j < pool_w; j++)
+			{
+				const int pj = j * bin_w;
+				const int bin_wz = table->bin_w_at_x[j];
+				if (bin_hz == 0 || bin_wz == 0)
+					continue;
+				const float inv = 1.0 / (bin_hz * bin_wz);
+				const float* const gpz = gpn + j * ginc[CCV_NNC_MAX_DIM];
+				for (y = 0; y < bin_h; y++)
+				{
+					if (y_coeffs[pi + y].mute)
+						continue;
+					const float ry = y_coeffs[pi + y].r;
+					const int iy0 = y_coeffs[pi + y].i0;
+					const int iy1 = y_coeffs[pi + y].i1;
+					for (x = 0; x < bin_w; x++)
+					{
+						if (x_coeffs[pj + x].mute)
+							continue;
+						const float rx = x_coeffs[pj + x].r;
+						const int ix0 = x_coeffs[pj + x].i0;
+						const int ix1 = x_coeffs[pj + x].i1;
+						const float c00 = (1 - ry) * (1 - rx);
+						const float c01 = (1 - ry) * rx;
+						const float c10 = ry * (1 - rx);
+						const float c11 = ry * rx;
+						float* const op00 = opn + (iy0 * oinc[CCV_NNC_MAX_DIM - 1] + ix0) * oinc[CCV_NNC_MAX_DIM];
+						float* const op01 = opn + (iy0 * oinc[CCV_NNC_MAX_DIM - 1] + ix1) * oinc[CCV_NNC_MAX_DIM];
+						float* const op10 = opn + (iy1 * oinc[CCV_NNC_MAX_DIM - 1] + ix0) * oinc[CCV_NNC_MAX_DIM];
+						float* const op11 = opn + (iy1 * oinc[CCV_NNC_MAX_DIM - 1] + ix1) * oinc[CCV_NNC_MAX_DIM];
+						k = 0;
+#if defined(HAVE_SSE2)
+						const __m128 c00v = _mm_set1_ps(c00);
+						const __m128 c01v = _mm_set1_ps(c01);
+						const __m128 c10v = _mm_set1_ps(c10);
+						const __m128 c11v = _mm_set1_ps(c11);
+						const __m128 invv = _mm_set1_ps(inv);
+						for (; k < ch - 3; k += 4)
+						{
+							const __m128 g = _mm_loadu_ps(gpz + k);
+							_mm_storeu_ps(op00 + k, _mm_add_ps(_mm_loadu_ps(op00 + k), _mm_mul_ps(_mm_mul_ps(g, c00v), invv)));
+							_mm_storeu_ps(op01 + k, _mm_add_ps(_mm_loadu_ps(op01 + k), _mm_mul_ps(_mm_mul_ps(g, c01v), invv)));
+							_mm_storeu_ps(op10 + k, _mm_add_ps(_mm_loadu_ps(op10 + k), _mm_mul_ps(_mm_mul_ps(g, c10v), invv)));
+							_mm_storeu_ps(op11 + k, _mm_add_ps(_mm_loadu_ps(op11 + k), _mm_mul_ps(_mm_mul_ps(g, c11v), invv)));
+						}
+#endif
+						for (; k < ch; k++)
+						{
+							op00[k] += gpz[k] * c00 * inv;
+							op01[k] += gpz[k] * c01 * inv;
+							op10[k] += gpz[k] * c10 * inv;
+							op11[k] += gpz[k] * c11 * inv;
+						}
+					}
+				}
+			}
+			gpn += ginc[CCV_NNC_MAX_DIM - 1] * ginc[CCV_NNC_MAX_DIM];
+		}
+	}
+}
+
+static int _ccv_nnc_roi_align_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size >= 3);
+	const ccv_nnc_tensor_view_t* g = (ccv_nnc_tensor_view_t*)inputs[0];
+	assert(output_size == 1);
+	ccv_nnc_tensor_view_t* o = (ccv_nnc_tensor_view_t*)outputs[0];
+	const int g_nd = ccv_nnc_tensor_nd(g->info.dim);
+	assert(g_nd == CCV_NNC_MAX_DIM + 1 || g_nd == CCV_NNC_MAX_DIM + 2);
+	const int* gdim = (g_nd == CCV_NNC_MAX_DIM + 1) ? g->info.dim : g->info.dim + 1;
+	const int o_nd = ccv_nnc_tensor_nd(o->info.dim);
+	assert(o_nd == CCV_NNC_MAX_DIM + 1 || o_nd == CCV_NNC_MAX_DIM + 2);
+	const int* odim = (o_nd == CCV_NNC_MAX_DIM + 1) ? o->info.dim : o->info.dim + 1;
+	assert(gdim[2] == odim[2]);
+	const int* ginc = CCV_IS_TENSOR_VIEW(g) ? ((g_nd == CCV_NNC_MAX_DIM + 1) ? g->inc : g->inc + 1) : gdim;
+	const int* oinc = CCV_IS_TENSOR_VIEW(o) ? ((o_nd == CCV_NNC_MAX_DIM + 1) ? o->inc : o->inc + 1) : odim;
+	const ccv_nnc_tensor_view_t* b = (ccv_nnc_tensor_view_t*)inputs[2];
+	const int o_n = ccv_nnc_tensor_get_n(o->info);
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	assert(b_nd == 1 || b_nd == 2);
+	const int b_n = b_nd == 1 ? 1 : b->info.dim[0];
+	const int g_n = ccv_nnc_tensor_get_n(g->info);
+	assert(g_n == ccv_max(o_n, b_n));
+	const int* binc = CCV_IS_TENSOR_VIEW(b) ? b->inc : b->info.dim;
+	ccv_nnc_roi_align_parallel_t parallel = {
+		.op = o->data.f32,
+		.bp = b->data.f32,
+		.gp = g->data.f32,
+		.h = odim[0],
+		.w = odim[1],
+		.ch = gdim[2],
+		.pool_h = gdim[0],
+		.pool_w = gdim[1],
+		.a_n = o_n,
+		.b_n = b_n,
+		.c_n = g_n,
+		.aninc = o_nd == CCV_NNC_MAX_DIM + 1 ? 0 : oinc[0] * oinc[1] * oinc[2],
+		.bninc = b_nd == 1 ? 0 : binc[1],
+		.cninc = g_nd == CCV_NNC_MAX_DIM + 1 ? 0 : ginc[0] * ginc[1] * ginc[2],
+	};
+	memcpy(parallel.ainc, oinc, sizeof(parallel.ainc));
+	memcpy(parallel.cinc, ginc, sizeof(parallel.cinc));
+	_ccv_nnc_roi_align_tables(&parallel, stream_context);
+	const int ch_blocks = (parallel.ch + CCV_NNC_ROI_ALIGN_CH_BLOCK - 1) / CCV_NNC_ROI_ALIGN_CH_BLOCK;
+	ccv_nnc_parallel_for(o_n * ch_blocks, 0, _ccv_nnc_roi_align_back_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_ROI_ALIGN_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_roi_align_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_ROI_ALIGN_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_roi_align_back;
+}
@@ -6,14 +6,22 @@ static int _ccv_nnc_sgd_forw_bitmask(const int input_size, const int output_size
 {
 	// 3 inputs (gradient, x, momentum)
 	// 2 outputs (y, new momentum)
-	if (input_bitmasks[0] == 7u && output_bitmasks[0] == 3u)
-		return 1;
-	return 0;
+	// These can be repeated to update multiple parameters with one command.
+	if (input_size < 3 || input_size % 3 != 0 || output_size != input_size / 3 * 2)
+		return 0;
+	int i;
+	for (i = 0; i < input_size; i++)
+		if (!(input_bitmasks[i >> 6] & ((uint64_t)1 << (i & 63))))
+			return 0;
+	for (i = 0; i < output_size; i++)
+		if (!(output_bitmasks[i >> 6] & ((uint64_t)1 << (i & 63))))
+			return 0;
+	return 1;
 }
 
 static int _ccv_nnc_sgd_allow_inplace(const int input_idx, const int input_size, const int output_idx, const int output_size)
 {
-	if (input_idx == output_idx + 1)
+	if (input_idx % 3 == output_idx % 2 + 1 && input_idx / 3 == output_idx / 2)
 		return 1;
 	return 0;
 }
@@ -28,7 +36,7 @@ static void _ccv_nnc_sgd_tensor_auto_forw(const ccv_nnc_cmd_param_t cmd, const c
 {
 	int i;
 	for (i = 0; i < output_size; i++)
-		outputs[i] = inputs[0];
+		outputs[i] = inputs[i / 2 * 3];
 }
 
 static void _ccv_nnc_sgd_tensor_auto_back(const ccv_nnc_cmd_param_t cmd, const ccv_nnc_tensor_param_t* const inputs, const int input_size, const ccv_nnc_hint_t hint, ccv_nnc_tensor_param_t* const outputs, const int output_size)
@@ -37,7 +45,7 @@ static void _ccv_nnc_sgd_tensor_auto_back(const ccv_nnc_cmd_param_t cmd, const c
 }
 
 REGISTER_COMMAND(CCV_NNC_SGD_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_sgd_cpu_ref.c, gpu/ccv_nnc_sgd_gpu_ref.cu)
+	FIND_BACKEND(ccv_nnc_sgd_cpu_ref.c, ccv_nnc_sgd_cpu_opt.c, gpu/ccv_nnc_sgd_gpu_ref.cu)
 {
 	registry->bitmask = _ccv_nnc_sgd_forw_bitmask;
 	registry->tensor_auto = _ccv_nnc_sgd_tensor_auto_forw;
@@ -0,0 +1,125 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+
+// Shared methods.
+#include "../_ccv_nnc_cpu_opt.h"
+
+typedef struct {
+	const ccv_nnc_multi_tensor_chunk_t* chunks;
+	ccv_nnc_tensor_t* const* inputs;
+	ccv_nnc_tensor_t* const* outputs;
+	int nesterov;
+	float rate;
+	float scale;
+	float decay;
+	float momentum;
+	float inv_dampening;
+} ccv_nnc_sgd_parallel_t;
+
+static void _ccv_nnc_sgd_forw_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_sgd_parallel_t* const parallel = (ccv_nnc_sgd_parallel_t*)context;
+	const ccv_nnc_multi_tensor_chunk_t chunk = parallel->chunks[idx];
+	ccv_nnc_tensor_t* const* const inputs = parallel->inputs + chunk.group * 3;
+	ccv_nnc_tensor_t* const* const outputs = parallel->outputs + chunk.group * 2;
+	const float* const gp = inputs[0]->data.f32 + chunk.offset;
+	const float* const ap = inputs[1]->data.f32 + chunk.offset;
+	const float* const mp = inputs[2]->data.f32 + chunk.offset;
+	float* const bp = outputs[0]->data.f32 + chunk.offset;
+	float* const np = outputs[1]->data.f32 + chunk.offset;
+	const float rate = parallel->rate;
+	const float scale = parallel->scale;
+	const float decay = parallel->decay;
+	const float momentum = parallel->momentum;
+	const float inv_dampening = parallel->inv_dampening;
+	const int count = chunk.count;
+	int x = 0;
+#if defined(HAVE_SSE2)
+	const __m128 rate4 = _mm_set1_ps(rate);
+	const __m128 scale4 = _mm_set1_ps(scale);
+	const __m128 decay4 = _mm_set1_ps(decay);
+	const __m128 momentum4 = _mm_set1_ps(momentum);
+	const __m128 inv_dampening4 = _mm_set1_ps(inv_dampening);
+#endif
+	if (parallel->nesterov)
+	{
+#if defined(HAVE_SSE2)
+		for (; x < count - 3; x += 4)
+		{
+			const __m128 a = _mm_loadu_ps(ap + x);
+			__m128 grad = _mm_mul_ps(scale4, _mm_loadu_ps(gp + x));
+			const __m128 mom = _mm_add_ps(_mm_add_ps(_mm_mul_ps(momentum4, _mm_loadu_ps(mp + x)), grad), _mm_mul_ps(decay4, a));
+			grad = _mm_add_ps(grad, _mm_mul_ps(momentum4, mom));
+			_mm_storeu_ps(np + x, mom);
+			_mm_storeu_ps(bp + x, _mm_sub_ps(a, _mm_mul_ps(rate4, grad)));
+		}
+#endif
+		for (; x < count; x++)
+		{
+			float grad = scale * gp[x];
+			const float mom = np[x] = momentum * mp[x] + grad + decay * ap[x];
+			grad += momentum * mom;
+			bp[x] = ap[x] - rate * grad;
+		}
+	} else {
+#if defined(HAVE_SSE2)
+		for (; x < count - 3; x += 4)
+		{
+			const __m128 a = _mm_loadu_ps(ap + x);
+			const __m128 mom = _mm_add_ps(_mm_mul_ps(momentum4, _mm_loadu_ps(mp + x)), _mm_mul_ps(inv_dampening4, _mm_add_ps(_mm_mul_ps(scale4, _mm_loadu_ps(gp + x)), _mm_mul_ps(decay4, a))));
+			_mm_storeu_ps(np + x, mom);
+			_mm_storeu_ps(bp + x, _mm_sub_ps(a, _mm_mul_ps(rate4, mom)));
+		}
+#endif
+		for (; x < count; x++)
+		{
+			const float mom = np[x] = momentum * mp[x] + inv_dampening * (scale * gp[x] + decay * ap[x]);
+			bp[x] = ap[x] - rate * mom;
+		}
+	}
+}
+
+static int _ccv_nnc_sgd_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	// Multiple parameters can be updated in one command, 3 inputs and 2 outputs each.
+	assert(input_size % 3 == 0);
+	assert(output_size == input_size / 3 * 2);
+	int i;
+	for (i = 0; i < input_size; i++)
+		if (CCV_IS_TENSOR_VIEW(inputs[i]))
+			return CCV_NNC_EXEC_INVALID;
+	for (i = 0; i < output_size; i++)
+		if (CCV_IS_TENSOR_VIEW(outputs[i]))
+			return CCV_NNC_EXEC_INVALID;
+	if (cmd.info.sgd.nesterov)
+		{ assert(cmd.info.sgd.dampening == 0); }
+	const int chunk_count = _ccv_nnc_multi_tensor_chunks(inputs, input_size, 3, 0);
+	double* const sums = (double*)ccv_nnc_stream_context_get_workspace(stream_context, (sizeof(double) + sizeof(ccv_nnc_multi_tensor_chunk_t)) * chunk_count, CCV_TENSOR_CPU_MEMORY);
+	ccv_nnc_multi_tensor_chunk_t* const chunks = (ccv_nnc_multi_tensor_chunk_t*)(sums + chunk_count);
+	_ccv_nnc_multi_tensor_chunks(inputs, input_size, 3, chunks);
+	ccv_nnc_sgd_parallel_t parallel = {
+		.chunks = chunks,
+		.inputs = inputs,
+		.outputs = outputs,
+		.nesterov = cmd.info.sgd.nesterov,
+		.rate = cmd.info.sgd.rate,
+		.scale = cmd.info.sgd.scale * _ccv_nnc_multi_tensor_clip(cmd.info.sgd.max_norm, cmd.info.sgd.scale, inputs, 3, chunks, chunk_count, sums),
+		.decay = cmd.info.sgd.decay,
+		.momentum = cmd.info.sgd.momentum,
+		.inv_dampening = 1 - cmd.info.sgd.dampening,
+	};
+	ccv_nnc_parallel_for(chunk_count, 0, _ccv_nnc_sgd_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_SGD_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_sgd_forw;
+}
@@ -13,10 +13,8 @@
 // Shared methods.
 #include "../_ccv_nnc_cpu_ref.h"
 
-static int _ccv_nnc_sgd_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+static void _ccv_nnc_sgd_forw_cpu_ref(const ccv_nnc_cmd_t cmd, const float clip, ccv_nnc_tensor_t* const* const inputs, ccv_nnc_tensor_t* const* const outputs, ccv_nnc_stream_context_t* const stream_context)
 {
-	assert(input_size == 3);
-	assert(output_size == 2);
 	ccv_nnc_tensor_view_t* const g = (ccv_nnc_tensor_view_t*)inputs[0];
 	ccv_nnc_tensor_view_t* const a = (ccv_nnc_tensor_view_t*)inputs[1];
 	ccv_nnc_tensor_view_t* const m = (ccv_nnc_tensor_view_t*)inputs[2];
@@ -43,7 +41,7 @@ static int _ccv_nnc_sgd_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint,
 	ccv_nnc_tensor_view_get_inc(b, binc);
 	ccv_nnc_tensor_view_get_inc(n, ninc);
 	const float rate = cmd.info.sgd.rate;
-	const float scale = cmd.info.sgd.scale;
+	const float scale = cmd.info.sgd.scale * clip;
 	const float decay = cmd.info.sgd.decay;
 	const float momentum = cmd.info.sgd.momentum;
 	const float dampening = cmd.info.sgd.dampening;
@@ -122,6 +120,17 @@ static int _ccv_nnc_sgd_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint,
 			np += (ninc[1] - adim[1]) * ninc[2] * ninc[3];
 		}
 	}
+}
+
+static int _ccv_nnc_sgd_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	// Multiple parameters can be updated in one command, 3 inputs and 2 outputs each.
+	assert(input_size % 3 == 0);
+	assert(output_size == input_size / 3 * 2);
+	const float clip = _ccv_nnc_gradient_clip_cpu_ref(cmd.info.sgd.max_norm, cmd.info.sgd.scale, inputs, input_size, 3);
+	int i;
+	for (i = 0; i < input_size / 3; i++)
+		_ccv_nnc_sgd_forw_cpu_ref(cmd, clip, inputs + i * 3, outputs + i * 2, stream_context);
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
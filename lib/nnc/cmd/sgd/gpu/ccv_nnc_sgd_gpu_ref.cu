@@ -31,10 +31,8 @@ __global__ void _ccv_nnc_sgd_kernel(const size_t tensor_count, const float rate,
 	}
 }
 
-static int _ccv_nnc_sgd_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+static void _ccv_nnc_sgd_forw_gpu_ref(const ccv_nnc_cmd_t cmd, ccv_nnc_tensor_t* const* const inputs, ccv_nnc_tensor_t* const* const outputs, ccv_nnc_stream_context_t* const stream_context)
 {
-	assert(input_size == 3);
-	assert(output_size == 2);
 	cudaStream_t stream = ccv_nnc_stream_context_get_stream(stream_context);
 	const int nesterov = cmd.info.sgd.nesterov;
 	const float rate = cmd.info.sgd.rate;
@@ -91,6 +89,19 @@ static int _ccv_nnc_sgd_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint,
 				_ccv_nnc_sgd_kernel<<<CUDA_GET_BLOCKS(tensor_count), CUDA_NUM_THREADS, 0, stream>>>(tensor_count, rate, decay, scale, momentum, inv_dampening, g->data.f32, a->data.f32, m->data.f32, b->data.f32, n->data.f32);
 		}
 	}
+}
+
+static int _ccv_nnc_sgd_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	// Multiple parameters can be updated in one command, 3 inputs and 2 outputs each.
+	assert(input_size % 3 == 0);
+	assert(output_size == input_size / 3 * 2);
+	// Clipping to the gradient norm across all parameters is not implemented on GPU.
+	if (cmd.info.sgd.max_norm > 0)
+		return CCV_NNC_EXEC_INVALID;
+	int i;
+	for (i = 0; i < input_size / 3; i++)
+		_ccv_nnc_sgd_forw_gpu_ref(cmd, inputs + i * 3, outputs + i * 2, stream_context);
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
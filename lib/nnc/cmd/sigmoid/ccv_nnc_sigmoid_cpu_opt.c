@@ -0,0 +1,134 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+
+// Shared methods.
+#include "../_ccv_nnc_cpu_opt.h"
+
+// Each thread takes this many elements at a time.
+#define CCV_NNC_SIGMOID_CHUNK (8192)
+
+typedef struct {
+	int count;
+	const float* g;
+	const float* a; // For backward, this is the output of the forward pass.
+	float* b; // For backward, this is the gradient of the input.
+} ccv_nnc_sigmoid_parallel_t;
+
+static void _ccv_nnc_sigmoid_forw_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_sigmoid_parallel_t* const parallel = (ccv_nnc_sigmoid_parallel_t*)context;
+	const int offset = idx * CCV_NNC_SIGMOID_CHUNK;
+	const int count = ccv_min(parallel->count - offset, CCV_NNC_SIGMOID_CHUNK);
+	const float* const ap = parallel->a + offset;
+	float* const bp = parallel->b + offset;
+	int i = 0;
+#if defined(HAVE_SSE2)
+	for (; i < count - 3; i += 4)
+		_mm_storeu_ps(bp + i, _ccv_nnc_sigmoid_ps(_mm_loadu_ps(ap + i)));
+#endif
+	for (; i < count; i++)
+		bp[i] = 1. / (1. + expf(-ap[i]));
+}
+
+static int _ccv_nnc_sigmoid_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 1);
+	const ccv_nnc_tensor_t* a = inputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	assert(output_size == 1);
+	ccv_nnc_tensor_t* b = outputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	const int count = ccv_nnc_tensor_count(a->info);
+	int i;
+	for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
+		{ assert(a->info.dim[i] == b->info.dim[i]); }
+	ccv_nnc_sigmoid_parallel_t parallel = {
+		.count = count,
+		.a = a->data.f32,
+		.b = b->data.f32,
+	};
+	ccv_nnc_parallel_for((count + CCV_NNC_SIGMOID_CHUNK - 1) / CCV_NNC_SIGMOID_CHUNK, 0, _ccv_nnc_sigmoid_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static void _ccv_nnc_sigmoid_back_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_sigmoid_parallel_t* const parallel = (ccv_nnc_sigmoid_parallel_t*)context;
+	const int offset = idx * CCV_NNC_SIGMOID_CHUNK;
+	const int count = ccv_min(parallel->count - offset, CCV_NNC_SIGMOID_CHUNK);
+	const float* const gp = parallel->g ? parallel->g + offset : 0;
+	const float* const bp = parallel->a + offset;
+	float* const hp = parallel->b + offset;
+	int i = 0;
+#if defined(HAVE_SSE2)
+	const __m128 one = _mm_set1_ps(1);
+	if (gp)
+		for (; i < count - 3; i += 4)
+		{
+			const __m128 b4 = _mm_loadu_ps(bp + i);
+			_mm_storeu_ps(hp + i, _mm_mul_ps(_mm_loadu_ps(gp + i), _mm_mul_ps(b4, _mm_sub_ps(one, b4))));
+		}
+	else
+		for (; i < count - 3; i += 4)
+		{
+			const __m128 b4 = _mm_loadu_ps(bp + i);
+			_mm_storeu_ps(hp + i, _mm_mul_ps(b4, _mm_sub_ps(one, b4)));
+		}
+#endif
+	if (gp)
+		for (; i < count; i++)
+			hp[i] = gp[i] * bp[i] * (1 - bp[i]);
+	else
+		for (; i < count; i++)
+			hp[i] = bp[i] * (1 - bp[i]);
+}
+
+static int _ccv_nnc_sigmoid_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 3);
+	assert(output_size == 1);
+	const ccv_nnc_tensor_t* g = inputs[0];
+	const ccv_nnc_tensor_t* b = inputs[2];
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	ccv_nnc_tensor_t* h = outputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(h));
+	const int count = ccv_nnc_tensor_count(b->info);
+	int i;
+	for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && b->info.dim[i] > 0; i++)
+		{ assert(h->info.dim[i] == b->info.dim[i]); }
+	if (g)
+	{
+		assert(!CCV_IS_TENSOR_VIEW(g));
+		for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && g->info.dim[i] > 0; i++)
+			{ assert(g->info.dim[i] == h->info.dim[i]); }
+	}
+	ccv_nnc_sigmoid_parallel_t parallel = {
+		.count = count,
+		.g = g ? g->data.f32 : 0,
+		.a = b->data.f32,
+		.b = h->data.f32,
+	};
+	ccv_nnc_parallel_for((count + CCV_NNC_SIGMOID_CHUNK - 1) / CCV_NNC_SIGMOID_CHUNK, 0, _ccv_nnc_sigmoid_back_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_SIGMOID_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_sigmoid_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_SIGMOID_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_sigmoid_back;
+}
@@ -3,12 +3,90 @@
 #include "nnc/ccv_nnc.h"
 #include "nnc/ccv_nnc_easy.h"
 #include "nnc/ccv_nnc_internal.h"
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif
-#ifdef USE_DISPATCH
-#include <dispatch/dispatch.h>
-#endif
+
+typedef struct {
+	const ccv_nnc_tensor_view_t* g;
+	const ccv_nnc_tensor_view_t* a;
+	const ccv_nnc_tensor_view_t* b;
+	ccv_nnc_tensor_view_t* c;
+	ccv_nnc_tensor_view_t* d;
+	ccv_nnc_tensor_view_t* h;
+	int count;
+	int astep;
+	int bstep;
+	int cstep;
+	int dstep;
+	int gstep;
+	int hstep;
+	float pos_weight;
+	float pos_weight_1;
+} ccv_nnc_sigmoid_binary_crossentropy_parallel_t;
+
+static void _ccv_nnc_sigmoid_binary_crossentropy_forw_parallel(void* const context, const int i)
+{
+	const ccv_nnc_sigmoid_binary_crossentropy_parallel_t* const parallel = (ccv_nnc_sigmoid_binary_crossentropy_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	const ccv_nnc_tensor_view_t* const b = parallel->b;
+	ccv_nnc_tensor_view_t* const c = parallel->c;
+	ccv_nnc_tensor_view_t* const d = parallel->d;
+	const int count = parallel->count;
+	const int astep = parallel->astep;
+	const int bstep = parallel->bstep;
+	const int cstep = parallel->cstep;
+	const int dstep = parallel->dstep;
+	int j;
+	const float* const ap = a->data.f32 + i * astep;
+	const float* const bp = b->data.f32 + i * bstep;
+	float* const dp = d->data.f32 + i * dstep;
+	float cp = 0;
+	for (j = 0; j < count; j++)
+	{
+		cp += (1 - bp[j]) * ap[j] + log(1. + exp(-ap[j]));
+		dp[j] = 1. / (1. + exp(-ap[j]));
+	}
+	c->data.f32[i * cstep] = cp;
+}
+
+static void _ccv_nnc_sigmoid_binary_crossentropy_forw_pos_weight_parallel(void* const context, const int i)
+{
+	const ccv_nnc_sigmoid_binary_crossentropy_parallel_t* const parallel = (ccv_nnc_sigmoid_binary_crossentropy_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	const ccv_nnc_tensor_view_t* const b = parallel->b;
+	ccv_nnc_tensor_view_t* const c = parallel->c;
+	ccv_nnc_tensor_view_t* const d = parallel->d;
+	const int count = parallel->count;
+	const int astep = parallel->astep;
+	const int bstep = parallel->bstep;
+	const int cstep = parallel->cstep;
+	const int dstep = parallel->dstep;
+	const float pos_weight_1 = parallel->pos_weight_1;
+	int j;
+	const float* const ap = a->data.f32 + i * astep;
+	const float* const bp = b->data.f32 + i * bstep;
+	float* const dp = d->data.f32 + i * dstep;
+	float cp = 0;
+	for (j = 0; j < count; j++)
+	{
+		cp += (1 - bp[j]) * ap[j] + (1 + bp[j] * pos_weight_1) * log(1. + exp(-ap[j]));
+		dp[j] = 1. / (1. + exp(-ap[j]));
+	}
+	c->data.f32[i * cstep] = cp;
+}
+
+static void _ccv_nnc_sigmoid_binary_crossentropy_forw_no_c_parallel(void* const context, const int i)
+{
+	const ccv_nnc_sigmoid_binary_crossentropy_parallel_t* const parallel = (ccv_nnc_sigmoid_binary_crossentropy_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	ccv_nnc_tensor_view_t* const d = parallel->d;
+	const int count = parallel->count;
+	const int astep = parallel->astep;
+	const int dstep = parallel->dstep;
+	int j;
+	const float* const ap = a->data.f32 + i * astep;
+	float* const dp = d->data.f32 + i * dstep;
+	for (j = 0; j < count; j++)
+		dp[j] = 1. / (1. + exp(-ap[j]));
+}
 
 static int _ccv_nnc_sigmoid_binary_crossentropy_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
@@ -44,47 +122,127 @@ static int _ccv_nnc_sigmoid_binary_crossentropy_forw(const ccv_nnc_cmd_t cmd, co
 		const float pos_weight = cmd.info.binary_crossentropy.pos_weight;
 		if (pos_weight == 1)
 		{
-			parallel_for(i, batch_size) {
-				int j;
-				const float* const ap = a->data.f32 + i * astep;
-				const float* const bp = b->data.f32 + i * bstep;
-				float* const dp = d->data.f32 + i * dstep;
-				float cp = 0;
-				for (j = 0; j < count; j++)
-				{
-					cp += (1 - bp[j]) * ap[j] + log(1. + exp(-ap[j]));
-					dp[j] = 1. / (1. + exp(-ap[j]));
-				}
-				c->data.f32[i * cstep] = cp;
-			} parallel_endfor
+			ccv_nnc_sigmoid_binary_crossentropy_parallel_t parallel = {
+				.a = a,
+				.b = b,
+				.c = c,
+				.d = d,
+				.count = count,
+				.astep = astep,
+				.bstep = bstep,
+				.cstep = cstep,
+				.dstep = dstep,
+			};
+			ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_sigmoid_binary_crossentropy_forw_parallel, &parallel);
 		} else {
 			const float pos_weight_1 = pos_weight - 1;
-			parallel_for(i, batch_size) {
-				int j;
-				const float* const ap = a->data.f32 + i * astep;
-				const float* const bp = b->data.f32 + i * bstep;
-				float* const dp = d->data.f32 + i * dstep;
-				float cp = 0;
-				for (j = 0; j < count; j++)
-				{
-					cp += (1 - bp[j]) * ap[j] + (1 + bp[j] * pos_weight_1) * log(1. + exp(-ap[j]));
-					dp[j] = 1. / (1. + exp(-ap[j]));
-				}
-				c->data.f32[i * cstep] = cp;
-			} parallel_endfor
+			ccv_nnc_sigmoid_binary_crossentropy_parallel_t parallel = {
+				.a = a,
+				.b = b,
+				.c = c,
+				.d = d,
+				.count = count,
+				.astep = astep,
+				.bstep = bstep,
+				.cstep = cstep,
+				.dstep = dstep,
+				.pos_weight_1 = pos_weight_1,
+			};
+			ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_sigmoid_binary_crossentropy_forw_pos_weight_parallel, &parallel);
 		}
 	} else {
-		parallel_for(i, batch_size) {
-			int j;
-			const float* const ap = a->data.f32 + i * astep;
-			float* const dp = d->data.f32 + i * dstep;
-			for (j = 0; j < count; j++)
-				dp[j] = 1. / (1. + exp(-ap[j]));
-		} parallel_endfor
+		ccv_nnc_sigmoid_binary_crossentropy_parallel_t parallel = {
+			.a = a,
+			.d = d,
+			.count = count,
+			.astep = astep,
+			.dstep = dstep,
+		};
+		ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_sigmoid_binary_crossentropy_forw_no_c_parallel, &parallel);
 	}
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
+static void _ccv_nnc_sigmoid_binary_crossentropy_back_parallel(void* const context, const int i)
+{
+	const ccv_nnc_sigmoid_binary_crossentropy_parallel_t* const parallel = (ccv_nnc_sigmoid_binary_crossentropy_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const g = parallel->g;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	const ccv_nnc_tensor_view_t* const b = parallel->b;
+	ccv_nnc_tensor_view_t* const h = parallel->h;
+	const int count = parallel->count;
+	const int astep = parallel->astep;
+	const int bstep = parallel->bstep;
+	const int gstep = parallel->gstep;
+	const int hstep = parallel->hstep;
+	int j;
+	const float gp = g->data.f32[i * gstep];
+	const float* const ap = a->data.f32 + i * astep;
+	const float* const bp = b->data.f32 + i * bstep;
+	float* const hp = h->data.f32 + i * hstep;
+	for (j = 0; j < count; j++)
+		hp[j] = gp * (ap[j] - bp[j]);
+}
+
+static void _ccv_nnc_sigmoid_binary_crossentropy_back_no_g_parallel(void* const context, const int i)
+{
+	const ccv_nnc_sigmoid_binary_crossentropy_parallel_t* const parallel = (ccv_nnc_sigmoid_binary_crossentropy_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	const ccv_nnc_tensor_view_t* const b = parallel->b;
+	ccv_nnc_tensor_view_t* const h = parallel->h;
+	const int count = parallel->count;
+	const int astep = parallel->astep;
+	const int bstep = parallel->bstep;
+	const int hstep = parallel->hstep;
+	int j;
+	const float* const ap = a->data.f32 + i * astep;
+	const float* const bp = b->data.f32 + i * bstep;
+	float* const hp = h->data.f32 + i * hstep;
+	for (j = 0; j < count; j++)
+		hp[j] = ap[j] - bp[j];
+}
+
+static void _ccv_nnc_sigmoid_binary_crossentropy_back_pos_weight_parallel(void* const context, const int i)
+{
+	const ccv_nnc_sigmoid_binary_crossentropy_parallel_t* const parallel = (ccv_nnc_sigmoid_binary_crossentropy_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const g = parallel->g;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	const ccv_nnc_tensor_view_t* const b = parallel->b;
+	ccv_nnc_tensor_view_t* const h = parallel->h;
+	const int count = parallel->count;
+	const int astep = parallel->astep;
+	const int bstep = parallel->bstep;
+	const int gstep = parallel->gstep;
+	const int hstep = parallel->hstep;
+	const float pos_weight = parallel->pos_weight;
+	int j;
+	const float gp = g->data.f32[i * gstep];
+	const float* const ap = a->data.f32 + i * astep;
+	const float* const bp = b->data.f32 + i * bstep;
+	float* const hp = h->data.f32 + i * hstep;
+	for (j = 0; j < count; j++)
+		hp[j] = gp * ((ap[j] - 1) * bp[j] * pos_weight + ap[j] * (1 - bp[j]));
+}
+
+static void _ccv_nnc_sigmoid_binary_crossentropy_back_pos_weight_no_g_parallel(void* const context, const int i)
+{
+	const ccv_nnc_sigmoid_binary_crossentropy_parallel_t* const parallel = (ccv_nnc_sigmoid_binary_crossentropy_parallel_t*)context;
+	const ccv_nnc_tensor_view_t* const a = parallel->a;
+	const ccv_nnc_tensor_view_t* const b = parallel->b;
+	ccv_nnc_tensor_view_t* const h = parallel->h;
+	const int count = parallel->count;
+	const int astep = parallel->astep;
+	const int bstep = parallel->bstep;
+	const int hstep = parallel->hstep;
+	const float pos_weight = parallel->pos_weight;
+	int j;
+	const float* const ap = a->data.f32 + i * astep;
+	const float* const bp = b->data.f32 + i * bstep;
+	float* const hp = h->data.f32 + i * hstep;
+	for (j = 0; j < count; j++)
+		hp[j] = (ap[j] - 1) * bp[j] * pos_weight + ap[j] * (1 - bp[j]);
+}
+
 static int _ccv_nnc_sigmoid_binary_crossentropy_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
 	assert(input_size >= 6);
@@ -119,24 +277,29 @@ static int _ccv_nnc_sigmoid_binary_crossentropy_back(const ccv_nnc_cmd_t cmd, co
 			ccv_nnc_tensor_view_get_inc(g, ginc);
 			assert(ccv_nnc_tensor_count(g->info) == batch_size);
 			const int gstep = ccv_nnc_tensor_nd(g->info.dim) == 1 ? 1 : ginc[CCV_NNC_MAX_DIM + 1];
-			parallel_for(i, batch_size) {
-				int j;
-				const float gp = g->data.f32[i * gstep];
-				const float* const ap = a->data.f32 + i * astep;
-				const float* const bp = b->data.f32 + i * bstep;
-				float* const hp = h->data.f32 + i * hstep;
-				for (j = 0; j < count; j++)
-					hp[j] = gp * (ap[j] - bp[j]);
-			} parallel_endfor
+			ccv_nnc_sigmoid_binary_crossentropy_parallel_t parallel = {
+				.g = g,
+				.a = a,
+				.b = b,
+				.h = h,
+				.count = count,
+				.astep = astep,
+				.bstep = bstep,
+				.gstep = gstep,
+				.hstep = hstep,
+			};
+			ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_sigmoid_binary_crossentropy_back_parallel, &parallel);
 		} else {
-			parallel_for(i, batch_size) {
-				int j;
-				const float* const ap = a->data.f32 + i * astep;
-				const float* const bp = b->data.f32 + i * bstep;
-				float* const hp = h->data.f32 + i * hstep;
-				for (j = 0; j < count; j++)
-					hp[j] = ap[j] - bp[j];
-			} parallel_endfor
+			ccv_nnc_sigmoid_binary_crossentropy_parallel_t parallel = {
+				.a = a,
+				.b = b,
+				.h = h,
+				.count = count,
+				.astep = astep,
+				.bstep = bstep,
+				.hstep = hstep,
+			};
+			ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_sigmoid_binary_crossentropy_back_no_g_parallel, &parallel);
 		}
 	} else {
 		if (g)
@@ -145,24 +308,31 @@ static int _ccv_nnc_sigmoid_binary_crossentropy_back(const ccv_nnc_cmd_t cmd, co
 			ccv_nnc_tensor_view_get_inc(g, ginc);
 			assert(ccv_nnc_tensor_count(g->info) == batch_size);
 			const int gstep = ccv_nnc_tensor_nd(g->info.dim) == 1 ? 1 : ginc[CCV_NNC_MAX_DIM + 1];
-			parallel_for(i, batch_size) {
-				int j;
-				const float gp = g->data.f32[i * gstep];
-				const float* const ap = a->data.f32 + i * astep;
-				const float* const bp = b->data.f32 + i * bstep;
-				float* const hp = h->data.f32 + i * hstep;
-				for (j = 0; j < count; j++)
-					hp[j] = gp * ((ap[j] - 1) * bp[j] * pos_weight + ap[j] * (1 - bp[j]));
-			} parallel_endfor
+			ccv_nnc_sigmoid_binary_crossentropy_parallel_t parallel = {
+				.g = g,
+				.a = a,
+				.b = b,
+				.h = h,
+				.count = count,
+				.astep = astep,
+				.bstep = bstep,
+				.gstep = gstep,
+				.hstep = hstep,
+				.pos_weight = pos_weight,
+			};
+			ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_sigmoid_binary_crossentropy_back_pos_weight_parallel, &parallel);
 		} else {
-			parallel_for(i, batch_size) {
-				int j;
-				const float* const ap = a->data.f32 + i * astep;
-				const float* const bp = b->data.f32 + i * bstep;
-				float* const hp = h->data.f32 + i * hstep;
-				for (j = 0; j < count; j++)
-					hp[j] = (ap[j] - 1) * bp[j] * pos_weight + ap[j] * (1 - bp[j]);
-			} parallel_endfor
+			ccv_nnc_sigmoid_binary_crossentropy_parallel_t parallel = {
+				.a = a,
+				.b = b,
+				.h = h,
+				.count = count,
+				.astep = astep,
+				.bstep = bstep,
+				.hstep = hstep,
+				.pos_weight = pos_weight,
+			};
+			ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_sigmoid_binary_crossentropy_back_pos_weight_no_g_parallel, &parallel);
 		}
 	}
 	return CCV_NNC_EXEC_SUCCESS;
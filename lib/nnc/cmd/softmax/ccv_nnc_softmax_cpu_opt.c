@@ -0,0 +1,162 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+
+// Shared methods.
+#include "../_ccv_nnc_cpu_opt.h"
+
+typedef struct {
+	const float* a;
+	const float* b;
+	float* h;
+	int count;
+} ccv_nnc_softmax_parallel_t;
+
+static void _ccv_nnc_softmax_forw_parallel(void* const context, const int i)
+{
+	const ccv_nnc_softmax_parallel_t* const parallel = (ccv_nnc_softmax_parallel_t*)context;
+	const int count = parallel->count;
+	const float* const ap = parallel->a + (size_t)i * count;
+	float* const bp = parallel->h + (size_t)i * count;
+	int j = 0;
+	float maxval = ap[0];
+	float sumval = 0;
+#if defined(HAVE_SSE2)
+	if (count >= 4)
+	{
+		__m128 max4 = _mm_loadu_ps(ap);
+		for (j = 4; j < count - 3; j += 4)
+			max4 = _mm_max_ps(max4, _mm_loadu_ps(ap + j));
+		max4 = _mm_max_ps(max4, _mm_shuffle_ps(max4, max4, _MM_SHUFFLE(1, 0, 3, 2)));
+		max4 = _mm_max_ps(max4, _mm_shuffle_ps(max4, max4, _MM_SHUFFLE(2, 3, 0, 1)));
+		_mm_store_ss(&maxval, max4);
+	}
+#endif
+	for (; j < count; j++)
+		if (ap[j] > maxval)
+			maxval = ap[j];
+	j = 0;
+#if defined(HAVE_SSE2)
+	// Subtract the max, exponentiate and sum in one pass.
+	const __m128 max4 = _mm_set1_ps(maxval);
+	__m128 sum4 = _mm_setzero_ps();
+	for (; j < count - 3; j += 4)
+	{
+		const __m128 b4 = _ccv_nnc_exp_ps(_mm_sub_ps(_mm_loadu_ps(ap + j), max4));
+		_mm_storeu_ps(bp + j, b4);
+		sum4 = _mm_add_ps(sum4, b4);
+	}
+	sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+	sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+	_mm_store_ss(&sumval, sum4);
+#endif
+	for (; j < count; j++)
+		sumval += (bp[j] = expf(ap[j] - maxval));
+	const float inv = 1.0 / sumval;
+	j = 0;
+#if defined(HAVE_SSE2)
+	const __m128 inv4 = _mm_set1_ps(inv);
+	for (; j < count - 3; j += 4)
+		_mm_storeu_ps(bp + j, _mm_mul_ps(_mm_loadu_ps(bp + j), inv4));
+#endif
+	for (; j < count; j++)
+		bp[j] *= inv;
+}
+
+static int _ccv_nnc_softmax_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 1);
+	const ccv_nnc_tensor_t* a = inputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	assert(output_size == 1);
+	ccv_nnc_tensor_t* b = outputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	const int axis_count = ccv_nnc_tensor_nd(a->info.dim);
+	const int batch_size = axis_count < 2 ? 1 : a->info.dim[0];
+	const int count = ccv_nnc_tensor_count(a->info) / batch_size;
+	int i;
+	for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
+		{ assert(a->info.dim[i] == b->info.dim[i]); }
+	ccv_nnc_softmax_parallel_t parallel = {
+		.a = a->data.f32,
+		.h = b->data.f32,
+		.count = count,
+	};
+	ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_softmax_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static void _ccv_nnc_softmax_back_parallel(void* const context, const int i)
+{
+	const ccv_nnc_softmax_parallel_t* const parallel = (ccv_nnc_softmax_parallel_t*)context;
+	const int count = parallel->count;
+	const float* const gp = parallel->a + (size_t)i * count;
+	const float* const bp = parallel->b + (size_t)i * count;
+	float* const hp = parallel->h + (size_t)i * count;
+	int j = 0;
+	float sumval = 0;
+#if defined(HAVE_SSE2)
+	__m128 sum4 = _mm_setzero_ps();
+	for (; j < count - 3; j += 4)
+		sum4 = _mm_add_ps(sum4, _mm_mul_ps(_mm_loadu_ps(gp + j), _mm_loadu_ps(bp + j)));
+	sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+	sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+	_mm_store_ss(&sumval, sum4);
+#endif
+	for (; j < count; j++)
+		sumval += gp[j] * bp[j];
+	j = 0;
+#if defined(HAVE_SSE2)
+	const __m128 s4 = _mm_set1_ps(sumval);
+	for (; j < count - 3; j += 4)
+		_mm_storeu_ps(hp + j, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(gp + j), s4), _mm_loadu_ps(bp + j)));
+#endif
+	for (; j < count; j++)
+		hp[j] = (gp[j] - sumval) * bp[j];
+}
+
+static int _ccv_nnc_softmax_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 3);
+	assert(output_size == 1);
+	const ccv_nnc_tensor_t* g = inputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(g));
+	const ccv_nnc_tensor_t* b = inputs[2];
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	ccv_nnc_tensor_t* h = outputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(h));
+	const int axis_count = ccv_nnc_tensor_nd(g->info.dim);
+	const int batch_size = axis_count < 2 ? 1 : g->info.dim[0];
+	const int count = ccv_nnc_tensor_count(g->info) / batch_size;
+	int i;
+	for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && g->info.dim[i] > 0; i++)
+		{ assert(g->info.dim[i] == h->info.dim[i] && h->info.dim[i] == b->info.dim[i]); }
+	ccv_nnc_softmax_parallel_t parallel = {
+		.a = g->data.f32,
+		.b = b->data.f32,
+		.h = h->data.f32,
+		.count = count,
+	};
+	ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_softmax_back_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_SOFTMAX_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_softmax_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_SOFTMAX_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_softmax_back;
+}
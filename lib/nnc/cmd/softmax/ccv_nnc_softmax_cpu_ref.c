@@ -3,12 +3,32 @@
 #include "nnc/ccv_nnc.h"
 #include "nnc/ccv_nnc_easy.h"
 #include "nnc/ccv_nnc_internal.h"
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif
-#ifdef USE_DISPATCH
-#include <dispatch/dispatch.h>
-#endif
+
+typedef struct {
+	const ccv_nnc_tensor_t* a;
+	const ccv_nnc_tensor_t* b;
+	ccv_nnc_tensor_t* h;
+	int count;
+} ccv_nnc_softmax_parallel_t;
+
+static void _ccv_nnc_softmax_forw_parallel(void* const context, const int i)
+{
+	const ccv_nnc_softmax_parallel_t* const parallel = (ccv_nnc_softmax_parallel_t*)context;
+	const int count = parallel->count;
+	int j;
+	float* const ap = parallel->a->data.f32 + i * count;
+	float* const bp = parallel->h->data.f32 + i * count;
+	double maxval = ap[0];
+	for (j = 1; j < count; j++)
+		if (ap[j] > maxval)
+			maxval = ap[j];
+	double sumval = 0;
+	for (j = 0; j < count; j++)
+		sumval += (bp[j] = expf(ap[j] - maxval));
+	sumval = 1.0 / sumval;
+	for (j = 0; j < count; j++)
+		bp[j] *= sumval;
+}
 
 static int _ccv_nnc_softmax_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
@@ -24,24 +44,30 @@ static int _ccv_nnc_softmax_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t h
 	int i;
 	for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
 		{ assert(a->info.dim[i] == b->info.dim[i]); }
-	parallel_for(i, batch_size) {
-		int j;
-		float* const ap = a->data.f32 + i * count;
-		float* const bp = b->data.f32 + i * count;
-		double maxval = ap[0];
-		for (j = 1; j < count; j++)
-			if (ap[j] > maxval)
-				maxval = ap[j];
-		double sumval = 0;
-		for (j = 0; j < count; j++)
-			sumval += (bp[j] = expf(ap[j] - maxval));
-		sumval = 1.0 / sumval;
-		for (j = 0; j < count; j++)
-			bp[j] *= sumval;
-	} parallel_endfor
+	ccv_nnc_softmax_parallel_t parallel = {
+		.a = a,
+		.h = b,
+		.count = count,
+	};
+	ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_softmax_forw_parallel, &parallel);
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
+static void _ccv_nnc_softmax_back_parallel(void* const context, const int i)
+{
+	const ccv_nnc_softmax_parallel_t* const parallel = (ccv_nnc_softmax_parallel_t*)context;
+	const int count = parallel->count;
+	int j;
+	float* const gp = parallel->a->data.f32 + i * count;
+	float* const bp = parallel->b->data.f32 + i * count;
+	float* const hp = parallel->h->data.f32 + i * count;
+	float sumval = 0;
+	for (j = 0; j < count; j++)
+		sumval += gp[j] * bp[j];
+	for (j = 0; j < count; j++)
+		hp[j] = (gp[j] - sumval) * bp[j];
+}
+
 static int _ccv_nnc_softmax_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
 	assert(input_size == 3);
@@ -58,17 +84,13 @@ static int _ccv_nnc_softmax_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t h
 	int i;
 	for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && g->info.dim[i] > 0; i++)
 		{ assert(g->info.dim[i] == h->info.dim[i] && h->info.dim[i] == b->info.dim[i]); }
-	parallel_for(i, batch_size) {
-		int j;
-		float* const gp = g->data.f32 + i * count;
-		float* const bp = b->data.f32 + i * count;
-		float* const hp = h->data.f32 + i * count;
-		float sumval = 0;
-		for (j = 0; j < count; j++)
-			sumval += gp[j] * bp[j];
-		for (j = 0; j < count; j++)
-			hp[j] = (gp[j] - sumval) * bp[j];
-	} parallel_endfor
+	ccv_nnc_softmax_parallel_t parallel = {
+		.a = g,
+		.b = b,
+		.h = h,
+		.count = count,
+	};
+	ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_softmax_back_parallel, &parallel);
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
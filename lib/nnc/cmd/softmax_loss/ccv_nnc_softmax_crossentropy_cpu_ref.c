@@ -3,12 +3,83 @@
 #include "nnc/ccv_nnc.h"
 #include "nnc/ccv_nnc_easy.h"
 #include "nnc/ccv_nnc_internal.h"
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif
-#ifdef USE_DISPATCH
-#include <dispatch/dispatch.h>
-#endif
+
+typedef struct {
+	const ccv_nnc_tensor_t* g;
+	const ccv_nnc_tensor_t* a;
+	const ccv_nnc_tensor_t* b;
+	ccv_nnc_tensor_t* c;
+	const ccv_nnc_tensor_t* d;
+	ccv_nnc_tensor_t* h;
+	int count;
+	int range; // 1 if b is the label, otherwise b is the probability distribution.
+	float trim0;
+	float trim1;
+} ccv_nnc_softmax_crossentropy_parallel_t;
+
+static inline int _ccv_nnc_softmax_crossentropy_label(const ccv_nnc_tensor_t* const b, const int i)
+{
+	return b->info.datatype == CCV_32F ? (int)(b->data.f32[i] + 0.5) : b->data.i32[i];
+}
+
+// If has more than 1 axis, then the range is the channel count. Otherwise, if our batch size is 1, then the range is
+// the channel count. Otherwise, the range is 1 (and the only axis is the batch size).
+static int _ccv_nnc_softmax_crossentropy_range(const ccv_nnc_tensor_t* const b, const int batch_size)
+{
+	if (b->info.datatype == CCV_32S)
+		return 1;
+	assert(b->info.datatype == CCV_32F);
+	return ccv_nnc_tensor_nd(b->info.dim) > 1 ? ccv_nnc_tensor_get_c(b->info) : (batch_size == 1 ? b->info.dim[0] : 1);
+}
+
+static void _ccv_nnc_softmax_crossentropy_forw_parallel(void* const context, const int i)
+{
+	const ccv_nnc_softmax_crossentropy_parallel_t* const parallel = (ccv_nnc_softmax_crossentropy_parallel_t*)context;
+	const ccv_nnc_tensor_t* const b = parallel->b;
+	ccv_nnc_tensor_t* const c = parallel->c;
+	const int count = parallel->count;
+	const float trim0 = parallel->trim0;
+	const float trim1 = parallel->trim1;
+	int j;
+	float* const ap = parallel->a->data.f32 + i * count;
+	float* const dp = parallel->d->data.f32 + i * count;
+	double maxval = ap[0];
+	for (j = 1; j < count; j++)
+		if (ap[j] > maxval)
+			maxval = ap[j];
+	// Assign the loss before we do expf so that we can avoid the logf later to preserve numeric accuracy.
+	if (c)
+	{
+		if (parallel->range == 1)
+		{
+			const int label = _ccv_nnc_softmax_crossentropy_label(b, i);
+			assert(label >= 0 && label < count);
+			if (trim0 == 0 && trim1 == 1)
+				c->data.f32[i] = maxval - ap[label];
+			else {
+				float p = 0;
+				for (j = 0; j < label; j++)
+					p += trim0 * (maxval - ap[j]);
+				p += trim1 * (maxval - ap[label]);
+				for (j = label + 1; j < count; j++)
+					p += trim0 * (maxval - ap[j]);
+				c->data.f32[i] = p;
+			}
+		} else {
+			float* const bp = b->data.f32 + i * count;
+			float p = 0;
+			for (j = 0; j < count; j++)
+				p += bp[j] * (maxval - ap[j]);
+			c->data.f32[i] = p;
+		}
+	}
+	double sumval = 0;
+	for (j = 0; j < count; j++)
+		sumval += (dp[j] = expf(ap[j] - maxval));
+	sumval = 1.0 / sumval;
+	for (j = 0; j < count; j++)
+		dp[j] *= sumval;
+}
 
 static int _ccv_nnc_softmax_crossentropy_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
@@ -26,160 +97,62 @@ static int _ccv_nnc_softmax_crossentropy_forw(const ccv_nnc_cmd_t cmd, const ccv
 	const int batch_size = axis_count < 2 ? 1 : a->info.dim[0];
 	const int count = ccv_nnc_tensor_count(a->info) / batch_size;
 	int i;
-	if (c)
+	ccv_nnc_softmax_crossentropy_parallel_t parallel = {
+		.a = a,
+		.b = b,
+		.c = c,
+		.d = d,
+		.count = count,
+		.trim0 = cmd.info.label_smoothing.trim0,
+		.trim1 = cmd.info.label_smoothing.trim1,
+	};
+	if (c) // Otherwise, no loss calculation, just vanilla softmax.
 	{
 		assert(ccv_nnc_tensor_count(c->info) == batch_size);
-		if (b->info.datatype == CCV_32F)
+		parallel.range = _ccv_nnc_softmax_crossentropy_range(b, batch_size);
+		if (parallel.range == 1)
 		{
-			// If has more than 1 axis, then the range is the channel count. Otherwise, if our batch size is 1, then the range is
-			// the channel count. Otherwise, the range is 1 (and the only axis is the batch size).
-			const int range = ccv_nnc_tensor_nd(b->info.dim) > 1 ? ccv_nnc_tensor_get_c(b->info) : (batch_size == 1 ? b->info.dim[0] : 1);
-			if (range == 1)
-			{
-				for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
-					{ assert(a->info.dim[i] == d->info.dim[i]); }
-				const float trim0 = cmd.info.label_smoothing.trim0;
-				const float trim1 = cmd.info.label_smoothing.trim1;
-				if (trim0 == 0 && trim1 == 1)
-				{
-					parallel_for(i, batch_size) {
-						int j;
-						float* const ap = a->data.f32 + i * count;
-						float* const dp = d->data.f32 + i * count;
-						double maxval = ap[0];
-						for (j = 1; j < count; j++)
-							if (ap[j] > maxval)
-								maxval = ap[j];
-						const int label = (int)(b->data.f32[i] + 0.5);
-						assert(label >= 0 && label < count);
-						c->data.f32[i] = maxval - ap[label]; // Assign the loss before we do expf so that we can avoid the logf later to preserve numeric accuracy.
-						double sumval = 0;
-						for (j = 0; j < count; j++)
-							sumval += (dp[j] = expf(ap[j] - maxval));
-						sumval = 1.0 / sumval;
-						for (j = 0; j < count; j++)
-							dp[j] *= sumval;
-					} parallel_endfor
-				} else {
-					parallel_for(i, batch_size) {
-						int j;
-						float* const ap = a->data.f32 + i * count;
-						float* const dp = d->data.f32 + i * count;
-						double maxval = ap[0];
-						for (j = 1; j < count; j++)
-							if (ap[j] > maxval)
-								maxval = ap[j];
-						const int label = (int)(b->data.f32[i] + 0.5);
-						assert(label >= 0 && label < count);
-						float p = 0;
-						for (j = 0; j < label; j++)
-							p += trim0 * (maxval - ap[j]);
-						p += trim1 * (maxval - ap[label]);
-						for (j = label + 1; j < count; j++)
-							p += trim0 * (maxval - ap[j]);
-						c->data.f32[i] = p; // Assign the loss before we do expf so that we can avoid the logf later to preserve numeric accuracy.
-						double sumval = 0;
-						for (j = 0; j < count; j++)
-							sumval += (dp[j] = expf(ap[j] - maxval));
-						sumval = 1.0 / sumval;
-						for (j = 0; j < count; j++)
-							dp[j] *= sumval;
-					} parallel_endfor
-				}
-			} else {
-				assert(range == count);
-				parallel_for(i, batch_size) {
-					int j;
-					float* const ap = a->data.f32 + i * count;
-					float* const bp = b->data.f32 + i * count;
-					float* const dp = d->data.f32 + i * count;
-					double maxval = ap[0];
-					for (j = 1; j < count; j++)
-						if (ap[j] > maxval)
-							maxval = ap[j];
-					float p = 0;
-					for (j = 0; j < count; j++)
-						p += bp[j] * (maxval - ap[j]);
-					c->data.f32[i] = p; // Assign the loss before we do expf so that we can avoid the logf later to preserve numeric accuracy.
-					double sumval = 0;
-					for (j = 0; j < count; j++)
-						sumval += (dp[j] = expf(ap[j] - maxval));
-					sumval = 1.0 / sumval;
-					for (j = 0; j < count; j++)
-						dp[j] *= sumval;
-				} parallel_endfor
-			}
-		} else if (b->info.datatype == CCV_32S) {
 			for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
 				{ assert(a->info.dim[i] == d->info.dim[i]); }
-			const float trim0 = cmd.info.label_smoothing.trim0;
-			const float trim1 = cmd.info.label_smoothing.trim1;
-			if (trim0 == 0 && trim1 == 1)
-			{
-				parallel_for(i, batch_size) {
-					int j;
-					float* const ap = a->data.f32 + i * count;
-					float* const dp = d->data.f32 + i * count;
-					double maxval = ap[0];
-					for (j = 1; j < count; j++)
-						if (ap[j] > maxval)
-							maxval = ap[j];
-					const int label = b->data.i32[i];
-					assert(label >= 0 && label < count);
-					c->data.f32[i] = maxval - ap[label]; // Assign the loss before we do expf so that we can avoid the logf later to preserve numeric accuracy.
-					double sumval = 0;
-					for (j = 0; j < count; j++)
-						sumval += (dp[j] = expf(ap[j] - maxval));
-					sumval = 1.0 / sumval;
-					for (j = 0; j < count; j++)
-						dp[j] *= sumval;
-				} parallel_endfor
-			} else {
-				parallel_for(i, batch_size) {
-					int j;
-					float* const ap = a->data.f32 + i * count;
-					float* const dp = d->data.f32 + i * count;
-					double maxval = ap[0];
-					for (j = 1; j < count; j++)
-						if (ap[j] > maxval)
-							maxval = ap[j];
-					const int label = b->data.i32[i];
-					assert(label >= 0 && label < count);
-					float p = 0;
-					for (j = 0; j < label; j++)
-						p += trim0 * (maxval - ap[j]);
-					p += trim1 * (maxval - ap[label]);
-					for (j = label + 1; j < count; j++)
-						p += trim0 * (maxval - ap[j]);
-					c->data.f32[i] = p; // Assign the loss before we do expf so that we can avoid the logf later to preserve numeric accuracy.
-					double sumval = 0;
-					for (j = 0; j < count; j++)
-						sumval += (dp[j] = expf(ap[j] - maxval));
-					sumval = 1.0 / sumval;
-					for (j = 0; j < count; j++)
-						dp[j] *= sumval;
-				} parallel_endfor
-			}
+		} else
+			{ assert(parallel.range == count); }
+	}
+	ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_softmax_crossentropy_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static void _ccv_nnc_softmax_crossentropy_back_parallel(void* const context, const int i)
+{
+	const ccv_nnc_softmax_crossentropy_parallel_t* const parallel = (ccv_nnc_softmax_crossentropy_parallel_t*)context;
+	const ccv_nnc_tensor_t* const b = parallel->b;
+	const int count = parallel->count;
+	const float trim0 = parallel->trim0;
+	const float trim1 = parallel->trim1;
+	// Without g, it is the same as g is 1.
+	const float gp = parallel->g ? parallel->g->data.f32[i] : 1;
+	int j;
+	float* const dp = parallel->d->data.f32 + i * count;
+	float* const hp = parallel->h->data.f32 + i * count;
+	if (parallel->range == 1)
+	{
+		const int label = _ccv_nnc_softmax_crossentropy_label(b, i);
+		if (trim0 == 0 && trim1 == 1)
+		{
+			for (j = 0; j < count; j++)
+				hp[j] = gp * dp[j];
+			hp[label] -= gp;
+		} else {
+			for (j = 0; j < label; j++)
+				hp[j] = gp * (dp[j] - trim0);
+			hp[label] = gp * (dp[label] - trim1);
+			for (j = label + 1; j < count; j++)
+				hp[j] = gp * (dp[j] - trim0);
 		}
 	} else {
-		// No loss calculation, just vanilla softmax.
-		parallel_for(i, batch_size) {
-			int j;
-			float* const ap = a->data.f32 + i * count;
-			float* const dp = d->data.f32 + i * count;
-			double maxval = ap[0];
-			for (j = 1; j < count; j++)
-				if (ap[j] > maxval)
-					maxval = ap[j];
-			double sumval = 0;
-			for (j = 0; j < count; j++)
-				sumval += (dp[j] = expf(ap[j] - maxval));
-			sumval = 1.0 / sumval;
-			for (j = 0; j < count; j++)
-				dp[j] *= sumval;
-		} parallel_endfor
+		float* const bp = b->data.f32 + i * count;
+		for (j = 0; j < count; j++)
+			hp[j] = gp * (dp[j] - bp[j]);
 	}
-	return CCV_NNC_EXEC_SUCCESS;
 }
 
 static int _ccv_nnc_softmax_crossentropy_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
@@ -198,160 +171,24 @@ static int _ccv_nnc_softmax_crossentropy_back(const ccv_nnc_cmd_t cmd, const ccv
 	const int batch_size = axis_count < 2 ? 1 : d->info.dim[0];
 	const int count = ccv_nnc_tensor_count(d->info) / batch_size;
 	int i;
-	if (g)
+	const int range = _ccv_nnc_softmax_crossentropy_range(b, batch_size);
+	if (range == 1)
 	{
-		if (b->info.datatype == CCV_32F)
-		{
-			// If has more than 1 axis, then the range is the channel count. Otherwise, if our batch size is 1, then the range is
-			// the channel count. Otherwise, the range is 1 (and the only axis is the batch size).
-			const int range = ccv_nnc_tensor_nd(b->info.dim) > 1 ? ccv_nnc_tensor_get_c(b->info) : (batch_size == 1 ? b->info.dim[0] : 1);
-			if (range == 1)
-			{
-				for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && d->info.dim[i] > 0; i++)
-					{ assert(d->info.dim[i] == h->info.dim[i]); }
-				const float trim0 = cmd.info.label_smoothing.trim0;
-				const float trim1 = cmd.info.label_smoothing.trim1;
-				if (trim0 == 0 && trim1 == 1)
-				{
-					parallel_for(i, batch_size) {
-						int j;
-						const float gp = g->data.f32[i];
-						const int label = (int)(b->data.f32[i] + 0.5);
-						float* const dp = d->data.f32 + i * count;
-						float* const hp = h->data.f32 + i * count;
-						for (j = 0; j < count; j++)
-							hp[j] = gp * dp[j];
-						hp[label] -= gp;
-					} parallel_endfor
-				} else {
-					parallel_for(i, batch_size) {
-						int j;
-						const float gp = g->data.f32[i];
-						const int label = (int)(b->data.f32[i] + 0.5);
-						float* const dp = d->data.f32 + i * count;
-						float* const hp = h->data.f32 + i * count;
-						for (j = 0; j < label; j++)
-							hp[j] = gp * (dp[j] - trim0);
-						hp[label] = gp * (dp[label] - trim1);
-						for (j = label + 1; j < count; j++)
-							hp[j] = gp * (dp[j] - trim0);
-					} parallel_endfor
-				}
-			} else {
-				assert(range == count);
-				parallel_for(i, batch_size) {
-					int j;
-					const float gp = g->data.f32[i];
-					float* const dp = d->data.f32 + i * count;
-					float* const hp = h->data.f32 + i * count;
-					float* const bp = b->data.f32 + i * count;
-					for (j = 0; j < count; j++)
-						hp[j] = gp * (dp[j] - bp[j]);
-				} parallel_endfor
-			}
-		} else if (b->info.datatype == CCV_32S) {
-			for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && d->info.dim[i] > 0; i++)
-				{ assert(d->info.dim[i] == h->info.dim[i]); }
-			const float trim0 = cmd.info.label_smoothing.trim0;
-			const float trim1 = cmd.info.label_smoothing.trim1;
-			if (trim0 == 0 && trim1 == 1)
-			{
-				parallel_for(i, batch_size) {
-					int j;
-					const float gp = g->data.f32[i];
-					const int label = b->data.i32[i];
-					float* const dp = d->data.f32 + i * count;
-					float* const hp = h->data.f32 + i * count;
-					for (j = 0; j < count; j++)
-						hp[j] = gp * dp[j];
-					hp[label] -= gp;
-				} parallel_endfor
-			} else {
-				parallel_for(i, batch_size) {
-					int j;
-					const float gp = g->data.f32[i];
-					const int label = b->data.i32[i];
-					float* const dp = d->data.f32 + i * count;
-					float* const hp = h->data.f32 + i * count;
-					for (j = 0; j < label; j++)
-						hp[j] = gp * (dp[j] - trim0);
-					hp[label] = gp * (dp[label] - trim1);
-					for (j = label + 1; j < count; j++)
-						hp[j] = gp * (dp[j] - trim0);
-				} parallel_endfor
-			}
-		}
-	} else {
-		if (h->data.f32 != d->data.f32) // If not inplace replacement.
-			memcpy(h->data.f32, d->data.f32, sizeof(float) * count * batch_size);
-		if (b->info.datatype == CCV_32F)
-		{
-			// If has more than 1 axis, then the range is the channel count. Otherwise, if our batch size is 1, then the range is
-			// the channel count. Otherwise, the range is 1 (and the only axis is the batch size).
-			const int range = ccv_nnc_tensor_nd(b->info.dim) > 1 ? ccv_nnc_tensor_get_c(b->info) : (batch_size == 1 ? b->info.dim[0] : 1);
-			if (range == 1)
-			{
-				const float trim0 = cmd.info.label_smoothing.trim0;
-				const float trim1 = cmd.info.label_smoothing.trim1;
-				if (trim0 == 0 && trim1 == 1)
-				{
-					for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && d->info.dim[i] > 0; i++)
-						{ assert(d->info.dim[i] == h->info.dim[i]); }
-					parallel_for(i, batch_size) {
-						const int label = (int)(b->data.f32[i] + 0.5);
-						float* const hp = h->data.f32 + i * count;
-						hp[label] -= 1.;
-					} parallel_endfor
-				} else {
-					for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && d->info.dim[i] > 0; i++)
-						{ assert(d->info.dim[i] == h->info.dim[i]); }
-					parallel_for(i, batch_size) {
-						int j;
-						const int label = (int)(b->data.f32[i] + 0.5);
-						float* const hp = h->data.f32 + i * count;
-						for (j = 0; j < label; j++)
-							hp[j] -= trim0;
-						hp[label] -= trim1;
-						for (j = label + 1; j < count; j++)
-							hp[j] -= trim0;
-					} parallel_endfor
-				}
-			} else {
-				assert(range == count);
-				parallel_for(i, batch_size) {
-					int j;
-					float* const hp = h->data.f32 + i * count;
-					float* const bp = b->data.f32 + i * count;
-					for (j = 0; j < count; j++)
-						hp[j] -= bp[j];
-				} parallel_endfor
-			}
-		} else if (b->info.datatype == CCV_32S) {
-			for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && d->info.dim[i] > 0; i++)
-				{ assert(d->info.dim[i] == h->info.dim[i]); }
-			const float trim0 = cmd.info.label_smoothing.trim0;
-			const float trim1 = cmd.info.label_smoothing.trim1;
-			if (trim0 == 0 && trim1 == 1)
-			{
-				parallel_for(i, batch_size) {
-					const int label = b->data.i32[i];
-					float* const hp = h->data.f32 + i * count;
-					hp[label] -= 1.;
-				} parallel_endfor
-			} else {
-				parallel_for(i, batch_size) {
-					int j;
-					const int label = b->data.i32[i];
-					float* const hp = h->data.f32 + i * count;
-					for (j = 0; j < label; j++)
-						hp[j] -= trim0;
-					hp[label] -= trim1;
-					for (j = label + 1; j < count; j++)
-						hp[j] -= trim0;
-				} parallel_endfor
-			}
-		}
-	}
+		for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && d->info.dim[i] > 0; i++)
+			{ assert(d->info.dim[i] == h->info.dim[i]); }
+	} else
+		{ assert(range == count); }
+	ccv_nnc_softmax_crossentropy_parallel_t parallel = {
+		.g = g,
+		.b = b,
+		.d = d,
+		.h = h,
+		.count = count,
+		.range = range,
+		.trim0 = cmd.info.label_smoothing.trim0,
+		.trim1 = cmd.info.label_smoothing.trim1,
+	};
+	ccv_nnc_parallel_for(batch_size, 0, _ccv_nnc_softmax_crossentropy_back_parallel, &parallel);
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
@@ -0,0 +1,127 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+
+// Shared methods.
+#include "../_ccv_nnc_cpu_opt.h"
+
+// Each thread takes this many elements at a time.
+#define CCV_NNC_SWISH_CHUNK (8192)
+
+typedef struct {
+	int count;
+	const float* g;
+	const float* a;
+	float* b; // For backward, this is the gradient of the input.
+} ccv_nnc_swish_parallel_t;
+
+static void _ccv_nnc_swish_forw_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_swish_parallel_t* const parallel = (ccv_nnc_swish_parallel_t*)context;
+	const int offset = idx * CCV_NNC_SWISH_CHUNK;
+	const int count = ccv_min(parallel->count - offset, CCV_NNC_SWISH_CHUNK);
+	const float* const ap = parallel->a + offset;
+	float* const bp = parallel->b + offset;
+	int i = 0;
+#if defined(HAVE_SSE2)
+	for (; i < count - 3; i += 4)
+	{
+		const __m128 a4 = _mm_loadu_ps(ap + i);
+		_mm_storeu_ps(bp + i, _mm_mul_ps(a4, _ccv_nnc_sigmoid_ps(a4)));
+	}
+#endif
+	for (; i < count; i++)
+		bp[i] = ap[i] / (1. + expf(-ap[i]));
+}
+
+static int _ccv_nnc_swish_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 1);
+	const ccv_nnc_tensor_t* a = inputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	assert(output_size == 1);
+	ccv_nnc_tensor_t* b = outputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	const int count = ccv_nnc_tensor_count(a->info);
+	int i;
+	for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
+		{ assert(a->info.dim[i] == b->info.dim[i]); }
+	ccv_nnc_swish_parallel_t parallel = {
+		.count = count,
+		.a = a->data.f32,
+		.b = b->data.f32,
+	};
+	ccv_nnc_parallel_for((count + CCV_NNC_SWISH_CHUNK - 1) / CCV_NNC_SWISH_CHUNK, 0, _ccv_nnc_swish_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static void _ccv_nnc_swish_back_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_swish_parallel_t* const parallel = (ccv_nnc_swish_parallel_t*)context;
+	const int offset = idx * CCV_NNC_SWISH_CHUNK;
+	const int count = ccv_min(parallel->count - offset, CCV_NNC_SWISH_CHUNK);
+	const float* const gp = parallel->g + offset;
+	const float* const ap = parallel->a + offset;
+	float* const hp = parallel->b + offset;
+	int i = 0;
+	// See the reference implementation, the derivative is x * (y - y^2) + y with y = sigmoid(x).
+#if defined(HAVE_SSE2)
+	for (; i < count - 3; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(ap + i);
+		const __m128 y = _ccv_nnc_sigmoid_ps(x);
+		const __m128 d = _mm_add_ps(_mm_mul_ps(x, _mm_sub_ps(y, _mm_mul_ps(y, y))), y);
+		_mm_storeu_ps(hp + i, _mm_mul_ps(_mm_loadu_ps(gp + i), d));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		const float x = ap[i];
+		const float y = 1. / (1. + expf(-x));
+		hp[i] = gp[i] * (x * (y - y * y) + y);
+	}
+}
+
+static int _ccv_nnc_swish_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 3);
+	const ccv_nnc_tensor_t* g = inputs[0]; // gradient
+	assert(!CCV_IS_TENSOR_VIEW(g));
+	const ccv_nnc_tensor_t* a = inputs[1];
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	assert(output_size == 1);
+	ccv_nnc_tensor_t* h = outputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(h));
+	const int count = ccv_nnc_tensor_count(g->info);
+	int i;
+	for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && g->info.dim[i] > 0; i++)
+		{ assert(a->info.dim[i] == g->info.dim[i] && g->info.dim[i] == h->info.dim[i]); }
+	ccv_nnc_swish_parallel_t parallel = {
+		.count = count,
+		.g = g->data.f32,
+		.a = a->data.f32,
+		.b = h->data.f32,
+	};
+	ccv_nnc_parallel_for((count + CCV_NNC_SWISH_CHUNK - 1) / CCV_NNC_SWISH_CHUNK, 0, _ccv_nnc_swish_back_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_SWISH_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_swish_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_SWISH_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_swish_back;
+}
@@ -0,0 +1,235 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#endif
+
+typedef struct {
+	int si[2];
+	float sc[2];
+} ccv_nnc_bi_coeffs_t;
+
+// Identical to the reference implementation, thus, the tables match bit-by-bit.
+static void _ccv_nnc_init_bi_coeffs(const int ss, const int sz, const float s, ccv_nnc_bi_coeffs_t* const coeff)
+{
+	int i;
+	for (i = 0; i < sz; i++)
+	{
+		const float xs = (i + 0.5) * s - 0.5;
+		coeff[i].si[0] = (int)xs;
+		coeff[i].si[1] = ccv_min(coeff[i].si[0] + 1, ss - 1);
+		coeff[i].sc[1] = xs - coeff[i].si[0];
+		coeff[i].sc[0] = 1.0 - coeff[i].sc[1];
+	}
+}
+
+typedef struct {
+	float* ap;
+	float* bp;
+	const ccv_nnc_bi_coeffs_t* ycoeff;
+	const ccv_nnc_bi_coeffs_t* xcoeff;
+	const int* ystart; // For backward, the first output row that uses input row y as its top row.
+	int adim[CCV_NNC_MAX_DIM_ALLOC];
+	int bdim[CCV_NNC_MAX_DIM_ALLOC];
+	int ainc[CCV_NNC_MAX_DIM_ALLOC];
+	int binc[CCV_NNC_MAX_DIM_ALLOC];
+} ccv_nnc_upsample_parallel_t;
+
+// Four taps weighted along the channel dimension: bp = ap00 * c00 + ap01 * c01 + ap10 * c10 + ap11 * c11.
+static inline void _ccv_nnc_bilinear_taps(const float* const ap00, const float* const ap01, const float* const ap10, const float* const ap11, const float c00, const float c01, const float c10, const float c11, float* const bp, const int ch)
+{
+	int cd = 0;
+#if defined(HAVE_SSE2)
+	const __m128 c00v = _mm_set1_ps(c00);
+	const __m128 c01v = _mm_set1_ps(c01);
+	const __m128 c10v = _mm_set1_ps(c10);
+	const __m128 c11v = _mm_set1_ps(c11);
+	for (; cd < ch - 3; cd += 4)
+	{
+		const __m128 b0 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(ap00 + cd), c00v), _mm_mul_ps(_mm_loadu_ps(ap01 + cd), c01v));
+		const __m128 b1 = _mm_add_ps(b0, _mm_mul_ps(_mm_loadu_ps(ap10 + cd), c10v));
+		_mm_storeu_ps(bp + cd, _mm_add_ps(b1, _mm_mul_ps(_mm_loadu_ps(ap11 + cd), c11v)));
+	}
+#endif
+	for (; cd < ch; cd++)
+		bp[cd] = ap00[cd] * c00 + ap01[cd] * c01 + ap10[cd] * c10 + ap11[cd] * c11;
+}
+
+// ap += bp * c along the channel dimension.
+static inline void _ccv_nnc_bilinear_scatter(float* const ap, const float* const bp, const float c, const int ch)
+{
+	int cd = 0;
+#if defined(HAVE_SSE2)
+	const __m128 cv = _mm_set1_ps(c);
+	for (; cd < ch - 3; cd += 4)
+		_mm_storeu_ps(ap + cd, _mm_add_ps(_mm_loadu_ps(ap + cd), _mm_mul_ps(_mm_loadu_ps(bp + cd), cv)));
+#endif
+	for (; cd < ch; cd++)
+		ap[cd] += bp[cd] * c;
+}
+
+static void _ccv_nnc_upsample_bilinear_forw_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_upsample_parallel_t* const parallel = (ccv_nnc_upsample_parallel_t*)context;
+	const int* const adim = parallel->adim;
+	const int* const bdim = parallel->bdim;
+	const int* const ainc = parallel->ainc;
+	const int* const binc = parallel->binc;
+	const int n = idx / bdim[1];
+	const int yd = idx % bdim[1];
+	const ccv_nnc_bi_coeffs_t* const xcoeff = parallel->xcoeff;
+	const int ysi0 = parallel->ycoeff[yd].si[0];
+	const int ysi1 = (ysi0 + 1 < adim[1]) ? 1 : 0;
+	const float ysc0 = parallel->ycoeff[yd].sc[0];
+	const float ysc1 = parallel->ycoeff[yd].sc[1];
+	const float* const ap0 = parallel->ap + (n * ainc[1] + ysi0) * ainc[2] * ainc[3];
+	float* bp = parallel->bp + (n * binc[1] + yd) * binc[2] * binc[3];
+	int xd;
+	for (xd = 0; xd < bdim[2]; xd++)
+	{
+		const ccv_nnc_bi_coeffs_t cof = xcoeff[xd];
+		_ccv_nnc_bilinear_taps(ap0 + cof.si[0] * ainc[3], ap0 + cof.si[1] * ainc[3],
+			ap0 + (cof.si[0] + ysi1 * ainc[2]) * ainc[3], ap0 + (cof.si[1] + ysi1 * ainc[2]) * ainc[3],
+			cof.sc[0] * ysc0, cof.sc[1] * ysc0, cof.sc[0] * ysc1, cof.sc[1] * ysc1, bp, bdim[3]);
+		bp += binc[3];
+	}
+}
+
+static void _ccv_nnc_upsample_bilinear_back_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_upsample_parallel_t* const parallel = (ccv_nnc_upsample_parallel_t*)context;
+	const int* const adim = parallel->adim;
+	const int* const bdim = parallel->bdim;
+	const int* const ainc = parallel->ainc;
+	const int* const binc = parallel->binc;
+	const int n = idx / adim[1];
+	const int y = idx % adim[1];
+	const ccv_nnc_bi_coeffs_t* const xcoeff = parallel->xcoeff;
+	float* const ap0 = parallel->ap + (n * ainc[1] + y) * ainc[2] * ainc[3];
+	int xd, yd;
+	for (xd = 0; xd < adim[2]; xd++)
+		memset(ap0 + xd * ainc[3], 0, sizeof(float) * adim[3]);
+	// Gather from the output rows that sample input row y, either as the top row or the bottom row.
+	// Each input row is owned by exactly one task, thus, no atomics are needed.
+	const int yend = parallel->ystart[y + 1];
+	for (yd = parallel->ystart[ccv_max(y - 1, 0)]; yd < yend; yd++)
+	{
+		const int ysi0 = parallel->ycoeff[yd].si[0];
+		const int ysi1 = (ysi0 + 1 < adim[1]) ? ysi0 + 1 : ysi0;
+		if (ysi0 != y && ysi1 != y)
+			continue;
+		const float ysc0 = parallel->ycoeff[yd].sc[0];
+		const float ysc1 = parallel->ycoeff[yd].sc[1];
+		const float* bp = parallel->bp + (n * binc[1] + yd) * binc[2] * binc[3];
+		for (xd = 0; xd < bdim[2]; xd++)
+		{
+			const ccv_nnc_bi_coeffs_t cof = xcoeff[xd];
+			if (ysi0 == y)
+			{
+				_ccv_nnc_bilinear_scatter(ap0 + cof.si[0] * ainc[3], bp, cof.sc[0] * ysc0, bdim[3]);
+				_ccv_nnc_bilinear_scatter(ap0 + cof.si[1] * ainc[3], bp, cof.sc[1] * ysc0, bdim[3]);
+			}
+			if (ysi1 == y)
+			{
+				_ccv_nnc_bilinear_scatter(ap0 + cof.si[0] * ainc[3], bp, cof.sc[0] * ysc1, bdim[3]);
+				_ccv_nnc_bilinear_scatter(ap0 + cof.si[1] * ainc[3], bp, cof.sc[1] * ysc1, bdim[3]);
+			}
+			bp += binc[3];
+		}
+	}
+}
+
+static int _ccv_nnc_upsample_bilinear_parallel_init(ccv_nnc_tensor_view_t* const a, ccv_nnc_tensor_view_t* const b, ccv_nnc_upsample_parallel_t* const parallel, const int backward, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(ccv_nnc_tensor_nd(a->info.dim) <= CCV_NNC_MAX_DIM + 2);
+	assert(ccv_nnc_tensor_nd(b->info.dim) <= CCV_NNC_MAX_DIM + 2);
+	assert(a->info.format == b->info.format);
+	if (a->info.format != CCV_TENSOR_FORMAT_NHWC) // Only vectorize along the channel dimension.
+		return CCV_NNC_EXEC_INVALID;
+	assert(CCV_NNC_MAX_DIM == 2); // Need to change this logic for CCV_NNC_MAX_DIM == other number.
+	ccv_nnc_tensor_view_get_dim(a, parallel->adim);
+	ccv_nnc_tensor_view_get_dim(b, parallel->bdim);
+	ccv_nnc_tensor_view_get_inc(a, parallel->ainc);
+	ccv_nnc_tensor_view_get_inc(b, parallel->binc);
+	const int* const adim = parallel->adim;
+	const int* const bdim = parallel->bdim;
+	assert(adim[0] == bdim[0]);
+	assert(adim[3] == bdim[3]);
+	const float rheight = (float)adim[1] / bdim[1];
+	const float rwidth = (float)adim[2] / bdim[2];
+	assert(rheight <= 1);
+	assert(rwidth <= 1);
+	// The tables are computed once per call and shared by all tasks.
+	ccv_nnc_bi_coeffs_t* const ycoeff = (ccv_nnc_bi_coeffs_t*)ccv_nnc_stream_context_get_workspace(stream_context, sizeof(ccv_nnc_bi_coeffs_t) * (bdim[1] + bdim[2]) + (backward ? sizeof(int) * (adim[1] + 1) : 0), CCV_TENSOR_CPU_MEMORY);
+	ccv_nnc_bi_coeffs_t* const xcoeff = ycoeff + bdim[1];
+	_ccv_nnc_init_bi_coeffs(adim[1], bdim[1], rheight, ycoeff);
+	_ccv_nnc_init_bi_coeffs(adim[2], bdim[2], rwidth, xcoeff);
+	parallel->ycoeff = ycoeff;
+	parallel->xcoeff = xcoeff;
+	parallel->ystart = 0;
+	if (backward)
+	{
+		// si[0] is monotonic, ystart[y] is the first output row with si[0] >= y.
+		int* const ystart = (int*)(xcoeff + bdim[2]);
+		int y, yd = 0;
+		for (y = 0; y <= adim[1]; y++)
+		{
+			while (yd < bdim[1] && ycoeff[yd].si[0] < y)
+				++yd;
+			ystart[y] = yd;
+		}
+		parallel->ystart = ystart;
+	}
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_upsample_bilinear_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size >= 1);
+	assert(output_size >= 1);
+	ccv_nnc_tensor_view_t* const a = (ccv_nnc_tensor_view_t*)inputs[0];
+	ccv_nnc_tensor_view_t* const b = (ccv_nnc_tensor_view_t*)outputs[0];
+	ccv_nnc_upsample_parallel_t parallel;
+	if (_ccv_nnc_upsample_bilinear_parallel_init(a, b, &parallel, 0, stream_context) != CCV_NNC_EXEC_SUCCESS)
+		return CCV_NNC_EXEC_INVALID;
+	parallel.ap = a->data.f32;
+	parallel.bp = b->data.f32;
+	ccv_nnc_parallel_for(parallel.bdim[0] * parallel.bdim[1], 0, _ccv_nnc_upsample_bilinear_forw_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_upsample_bilinear_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size >= 1);
+	assert(output_size >= 1);
+	ccv_nnc_tensor_view_t* const b = (ccv_nnc_tensor_view_t*)inputs[0];
+	ccv_nnc_tensor_view_t* const a = (ccv_nnc_tensor_view_t*)outputs[0];
+	ccv_nnc_upsample_parallel_t parallel;
+	if (_ccv_nnc_upsample_bilinear_parallel_init(a, b, &parallel, 1, stream_context) != CCV_NNC_EXEC_SUCCESS)
+		return CCV_NNC_EXEC_INVALID;
+	parallel.ap = a->data.f32;
+	parallel.bp = b->data.f32;
+	ccv_nnc_parallel_for(parallel.adim[0] * parallel.adim[1], 0, _ccv_nnc_upsample_bilinear_back_parallel, &parallel);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_UPSAMPLE_BILINEAR_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_upsample_bilinear_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_UPSAMPLE_BILINEAR_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_upsample_bilinear_back;
+}
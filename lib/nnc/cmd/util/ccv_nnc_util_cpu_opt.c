@@ -0,0 +1,323 @@
+#include "ccv.h"
+#include "ccv_internal.h"
+#include "nnc/ccv_nnc.h"
+#include "nnc/ccv_nnc_easy.h"
+#include "nnc/ccv_nnc_internal.h"
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#endif
+
+// The 2D transposes are done in square tiles of this size, such that both the reads and the writes stay in L1.
+#define CCV_NNC_TRANSPOSE_TILE (32)
+
+typedef struct {
+	const float* ap;
+	float* bp;
+	int rows; // Rows of a, thus, columns of b.
+	int cols;
+	size_t lda;
+	size_t ldb;
+	int row_tiles;
+	int batch[2];
+	size_t astride[2];
+	size_t bstride[2];
+} ccv_nnc_transpose_2d_parallel_t;
+
+// b[j * ldb + i] = a[i * lda + j], 4x4 blocks are transposed in registers.
+static void _ccv_nnc_transpose_tile(const float* const a, const size_t lda, float* const b, const size_t ldb, const int rows, const int cols)
+{
+	int i = 0, j;
+#if defined(HAVE_SSE2)
+	for (; i < rows - 3; i += 4)
+	{
+		const float* const a0 = a + i * lda;
+		for (j = 0; j < cols - 3; j += 4)
+		{
+			__m128 r0 = _mm_loadu_ps(a0 + j);
+			__m128 r1 = _mm_loadu_ps(a0 + lda + j);
+			__m128 r2 = _mm_loadu_ps(a0 + lda * 2 + j);
+			__m128 r3 = _mm_loadu_ps(a0 + lda * 3 + j);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(b + j * ldb + i, r0);
+			_mm_storeu_ps(b + (j + 1) * ldb + i, r1);
+			_mm_storeu_ps(b + (j + 2) * ldb + i, r2);
+			_mm_storeu_ps(b + (j + 3) * ldb + i, r3);
+		}
+		for (; j < cols; j++)
+		{
+			b[j * ldb + i] = a0[j];
+			b[j * ldb + i + 1] = a0[lda + j];
+			b[j * ldb + i + 2] = a0[lda * 2 + j];
+			b[j * ldb + i + 3] = a0[lda * 3 + j];
+		}
+	}
+#endif
+	for (; i < rows; i++)
+		for (j = 0; j < cols; j++)
+			b[j * ldb + i] = a[i * lda + j];
+}
+
+static void _ccv_nnc_transpose_2d_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_transpose_2d_parallel_t* const parallel = (ccv_nnc_transpose_2d_parallel_t*)context;
+	const int tile = idx % parallel->row_tiles;
+	const int batch = idx / parallel->row_tiles;
+	const int b1 = batch % parallel->batch[1];
+	const int b0 = batch / parallel->batch[1];
+	const float* const ap = parallel->ap + b0 * parallel->astride[0] + b1 * parallel->astride[1];
+	float* const bp = parallel->bp + b0 * parallel->bstride[0] + b1 * parallel->bstride[1];
+	const size_t lda = parallel->lda;
+	const size_t ldb = parallel->ldb;
+	const int row_start = tile * CCV_NNC_TRANSPOSE_TILE;
+	const int rows = ccv_min(parallel->rows - row_start, CCV_NNC_TRANSPOSE_TILE);
+	const int cols = parallel->cols;
+	int j;
+	for (j = 0; j < cols; j += CCV_NNC_TRANSPOSE_TILE)
+		_ccv_nnc_transpose_tile(ap + row_start * lda + j, lda, bp + j * ldb + row_start, ldb, rows, ccv_min(cols - j, CCV_NNC_TRANSPOSE_TILE));
+}
+
+static void _ccv_nnc_transpose_2d(ccv_nnc_transpose_2d_parallel_t* const parallel)
+{
+	parallel->row_tiles = (parallel->rows + CCV_NNC_TRANSPOSE_TILE - 1) / CCV_NNC_TRANSPOSE_TILE;
+	ccv_nnc_parallel_for(parallel->batch[0] * parallel->batch[1] * parallel->row_tiles, 0, _ccv_nnc_transpose_2d_parallel, parallel);
+}
+
+static int _ccv_nnc_format_transform(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(output_size <= input_size);
+	int i, k;
+	// Only the swaps between NHWC and NCHW, which are batches of 2D transposes.
+	for (i = 0; i < output_size; i++)
+		if (!((inputs[i]->info.format == CCV_TENSOR_FORMAT_NHWC && outputs[i]->info.format == CCV_TENSOR_FORMAT_NCHW) ||
+			(inputs[i]->info.format == CCV_TENSOR_FORMAT_NCHW && outputs[i]->info.format == CCV_TENSOR_FORMAT_NHWC)))
+			return CCV_NNC_EXEC_INVALID;
+	for (i = 0; i < output_size; i++)
+	{
+		const ccv_nnc_tensor_view_t* a = (ccv_nnc_tensor_view_t*)inputs[i];
+		ccv_nnc_tensor_view_t* b = (ccv_nnc_tensor_view_t*)outputs[i];
+		assert(a != b); // Cannot do inplace transform.
+		int ainc[CCV_NNC_MAX_DIM_ALLOC];
+		int binc[CCV_NNC_MAX_DIM_ALLOC];
+		const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+		const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+		const int a_offset = CCV_NNC_MAX_DIM + 2 - a_nd;
+		assert(a_offset == 0 || a_offset == 1);
+		const int b_offset = CCV_NNC_MAX_DIM + 2 - b_nd;
+		assert(b_offset == 0 || b_offset == 1);
+		assert(CCV_NNC_MAX_DIM == 2); // Need to change this logic for CCV_NNC_MAX_DIM == other number.
+		ccv_nnc_tensor_view_get_inc(a, ainc);
+		ccv_nnc_tensor_view_get_inc(b, binc);
+		assert((a_offset == 0 ? a->info.dim[0] : 1) == (b_offset == 0 ? b->info.dim[0] : 1));
+		const int n = (a_offset == 0 ? a->info.dim[0] : 1);
+		ccv_nnc_transpose_2d_parallel_t parallel = {
+			.ap = a->data.f32,
+			.bp = b->data.f32,
+		};
+		int hw[CCV_NNC_MAX_DIM];
+		if (a->info.format == CCV_TENSOR_FORMAT_NHWC)
+		{
+			assert(a->info.dim[a_nd - 1] == b->info.dim[1 - b_offset]);
+			const int c = a->info.dim[a_nd - 1];
+			for (k = 0; k < CCV_NNC_MAX_DIM; k++)
+			{
+				assert(a->info.dim[k + 1 - a_offset] == b->info.dim[k + 2 - b_offset]);
+				hw[k] = a->info.dim[k + 1 - a_offset];
+			}
+			// For each image, transpose HW x C to C x HW. If a row of pixels is not contiguous, do it for each row.
+			parallel.cols = c;
+			parallel.lda = ainc[3];
+			parallel.ldb = (size_t)binc[2] * binc[3];
+			parallel.batch[0] = n;
+			parallel.astride[0] = (size_t)ainc[1] * ainc[2] * ainc[3];
+			parallel.bstride[0] = (size_t)binc[1] * binc[2] * binc[3];
+			if (ainc[2] == hw[1] && binc[3] == hw[1])
+			{
+				parallel.rows = hw[0] * hw[1];
+				parallel.batch[1] = 1;
+				parallel.astride[1] = parallel.bstride[1] = 0;
+			} else {
+				parallel.rows = hw[1];
+				parallel.batch[1] = hw[0];
+				parallel.astride[1] = (size_t)ainc[2] * ainc[3];
+				parallel.bstride[1] = binc[3];
+			}
+		} else {
+			assert(a->info.dim[1 - a_offset] == b->info.dim[b_nd - 1]);
+			const int c = a->info.dim[1 - a_offset];
+			for (k = 0; k < CCV_NNC_MAX_DIM; k++)
+			{
+				assert(a->info.dim[k + 2 - a_offset] == b->info.dim[k + 1 - b_offset]);
+				hw[k] = a->info.dim[k + 2 - a_offset];
+			}
+			// For each image, transpose C x HW to HW x C.
+			parallel.rows = c;
+			parallel.lda = (size_t)ainc[2] * ainc[3];
+			parallel.ldb = binc[3];
+			parallel.batch[0] = n;
+			parallel.astride[0] = (size_t)ainc[1] * ainc[2] * ainc[3];
+			parallel.bstride[0] = (size_t)binc[1] * binc[2] * binc[3];
+			if (ainc[3] == hw[1] && binc[2] == hw[1])
+			{
+				parallel.cols = hw[0] * hw[1];
+				parallel.batch[1] = 1;
+				parallel.astride[1] = parallel.bstride[1] = 0;
+			} else {
+				parallel.cols = hw[1];
+				parallel.batch[1] = hw[0];
+				parallel.astride[1] = ainc[3];
+				parallel.bstride[1] = (size_t)binc[2] * binc[3];
+			}
+		}
+		_ccv_nnc_transpose_2d(&parallel);
+	}
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_FORMAT_TRANSFORM_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F | CCV_32S;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_format_transform;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_FORMAT_TRANSFORM_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F | CCV_32S;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_format_transform;
+}
+
+typedef struct {
+	const float* ap;
+	float* bp;
+	int p, q;
+	int dim[CCV_NNC_MAX_DIM + 2];
+	size_t astride[CCV_NNC_MAX_DIM + 2];
+	size_t bstride[CCV_NNC_MAX_DIM + 2];
+} ccv_nnc_transpose_copy_parallel_t;
+
+// The last axis is not swapped, thus, copy it as a whole.
+static void _ccv_nnc_transpose_copy_parallel(void* const context, const int idx)
+{
+	const ccv_nnc_transpose_copy_parallel_t* const parallel = (ccv_nnc_transpose_copy_parallel_t*)context;
+	const int* const dim = parallel->dim;
+	const size_t* const astride = parallel->astride;
+	const size_t* const bstride = parallel->bstride;
+	int i[CCV_NNC_MAX_DIM + 2];
+	i[0] = idx / dim[1];
+	i[1] = idx % dim[1];
+	i[3] = 0;
+	for (i[2] = 0; i[2] < dim[2]; i[2]++)
+	{
+		int j[CCV_NNC_MAX_DIM + 2] = {
+			i[0], i[1], i[2], i[3]
+		};
+		j[parallel->p] = i[parallel->q];
+		j[parallel->q] = i[parallel->p];
+		memcpy(parallel->bp + i[0] * bstride[0] + i[1] * bstride[1] + i[2] * bstride[2],
+			parallel->ap + j[0] * astride[0] + j[1] * astride[1] + j[2] * astride[2],
+			sizeof(float) * dim[3]);
+	}
+}
+
+static int _ccv_nnc_transpose(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(output_size <= input_size);
+	int k;
+	for (k = 0; k < output_size; k++)
+	{
+		const ccv_nnc_tensor_view_t* const a = (ccv_nnc_tensor_view_t*)inputs[k];
+		ccv_nnc_tensor_view_t* const b = (ccv_nnc_tensor_view_t*)outputs[k];
+		const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+		const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+		assert(a_nd == b_nd);
+		assert(a_nd <= CCV_NNC_MAX_DIM + 2); // I can only handle maximum 4.
+		assert(a_nd >= 2 && b_nd >= 2); // You cannot transpose if it is less than 2.
+		assert(a->info.dim[cmd.info.transpose.axis[0]] == b->info.dim[cmd.info.transpose.axis[1]]);
+		assert(a->info.dim[cmd.info.transpose.axis[1]] == b->info.dim[cmd.info.transpose.axis[0]]);
+		int x;
+		for (x = 0; x < a_nd; x++)
+			if (x != cmd.info.transpose.axis[0] && x != cmd.info.transpose.axis[1])
+				{ assert(a->info.dim[x] == b->info.dim[x]); }
+		// Unlike the reference implementation, pad the leading axes to 1 such that the last axis is always 3.
+		const int offset = CCV_NNC_MAX_DIM + 2 - a_nd;
+		const int* const ainc = CCV_IS_TENSOR_VIEW(a) ? a->inc : a->info.dim;
+		const int* const binc = CCV_IS_TENSOR_VIEW(b) ? b->inc : b->info.dim;
+		ccv_nnc_transpose_copy_parallel_t parallel = {
+			.ap = a->data.f32,
+			.bp = b->data.f32,
+			.p = ccv_min(cmd.info.transpose.axis[0], cmd.info.transpose.axis[1]) + offset,
+			.q = ccv_max(cmd.info.transpose.axis[0], cmd.info.transpose.axis[1]) + offset,
+		};
+		for (x = 0; x < offset; x++)
+			parallel.dim[x] = 1, parallel.astride[x] = parallel.bstride[x] = 0;
+		for (x = 0; x < b_nd; x++)
+			parallel.dim[x + offset] = b->info.dim[x];
+		parallel.astride[CCV_NNC_MAX_DIM + 1] = parallel.bstride[CCV_NNC_MAX_DIM + 1] = 1;
+		for (x = a_nd - 2; x >= 0; x--)
+		{
+			parallel.astride[x + offset] = parallel.astride[x + offset + 1] * ainc[x + 1];
+			parallel.bstride[x + offset] = parallel.bstride[x + offset + 1] * binc[x + 1];
+		}
+		const int p = parallel.p;
+		const int q = parallel.q;
+		if (p == q)
+		{
+			// Nothing is swapped, copy by rows.
+			parallel.p = parallel.q = 0;
+			ccv_nnc_parallel_for(parallel.dim[0] * parallel.dim[1], 0, _ccv_nnc_transpose_copy_parallel, &parallel);
+		} else if (q == CCV_NNC_MAX_DIM + 1) {
+			// Swapping with the last axis, such as the last two axes for attention, is a batch of 2D transposes.
+			ccv_nnc_transpose_2d_parallel_t transpose = {
+				.ap = a->data.f32,
+				.bp = b->data.f32,
+				.rows = parallel.dim[q],
+				.cols = parallel.dim[p],
+				.lda = parallel.astride[p],
+				.ldb = parallel.bstride[p],
+			};
+			int batch_size = 0;
+			for (x = 0; x < CCV_NNC_MAX_DIM + 1; x++)
+				if (x != p)
+				{
+					if (parallel.dim[x] == 1)
+						continue;
+					assert(batch_size < 2);
+					transpose.batch[batch_size] = parallel.dim[x];
+					transpose.astride[batch_size] = parallel.astride[x];
+					transpose.bstride[batch_size] = parallel.bstride[x];
+					++batch_size;
+				}
+			for (; batch_size < 2; batch_size++)
+			{
+				transpose.batch[batch_size] = 1;
+				transpose.astride[batch_size] = transpose.bstride[batch_size] = 0;
+			}
+			_ccv_nnc_transpose_2d(&transpose);
+		} else
+			ccv_nnc_parallel_for(parallel.dim[0] * parallel.dim[1], 0, _ccv_nnc_transpose_copy_parallel, &parallel);
+	}
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_TRANSPOSE_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_transpose;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_TRANSPOSE_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_transpose;
+}
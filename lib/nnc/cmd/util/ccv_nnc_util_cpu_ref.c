@@ -67,6 +67,62 @@ void _ccv_nnc_tensor_transfer_cpu_ref_f16(const ccv_nnc_tensor_view_t* const a,
 	}
 }
 
+void _ccv_nnc_tensor_transfer_cpu_ref_u8(const ccv_nnc_tensor_view_t* const a, ccv_nnc_tensor_view_t* const b)
+{
+	// Assuming this is 8-bit.
+	assert(a->info.datatype == b->info.datatype);
+	if (!CCV_IS_TENSOR_VIEW(a) && !CCV_IS_TENSOR_VIEW(b))
+	{
+		// Super optimal case, just do memcpy.
+		memcpy(b->data.u8, a->data.u8, ccv_nnc_tensor_count(a->info) * CCV_GET_DATA_TYPE_SIZE(a->info.datatype));
+		return;
+	}
+	int dim[CCV_NNC_MAX_DIM_ALLOC];
+	int ainc[CCV_NNC_MAX_DIM_ALLOC];
+	int binc[CCV_NNC_MAX_DIM_ALLOC];
+	ccv_nnc_tensor_view_get_dim(a, dim);
+	assert(ccv_nnc_tensor_view_check_dim(b, dim));
+	ccv_nnc_tensor_view_get_inc(a, ainc);
+	ccv_nnc_tensor_view_get_inc(b, binc);
+	assert(CCV_NNC_MAX_DIM == 2); // Need to change this logic for CCV_NNC_MAX_DIM == other number.
+	int i[CCV_NNC_MAX_DIM + 2];
+	unsigned char* ap = a->data.u8;
+	unsigned char* bp = b->data.u8;
+	if (ainc[3] == dim[3] && binc[3] == dim[3])
+	{
+		// Special casing if the ainc[3] is the same as dim[3] (do memcpy for the last two dim)
+		for (i[0] = 0; i[0] < dim[0]; i[0]++)
+		{
+			for (i[1] = 0; i[1] < dim[1]; i[1]++)
+			{
+				memcpy(bp, ap, dim[2] * dim[3] * sizeof(unsigned char));
+				ap += ainc[2] * ainc[3];
+				bp += binc[2] * binc[3];
+			}
+			ap += (ainc[1] - dim[1]) * ainc[2] * ainc[3];
+			bp += (binc[1] - dim[1]) * binc[2] * binc[3];
+		}
+		return;
+	}
+	// Non-optimal case, need to do skip copy.
+	for (i[0] = 0; i[0] < dim[0]; i[0]++)
+	{
+		for (i[1] = 0; i[1] < dim[1]; i[1]++)
+		{
+			for (i[2] = 0; i[2] < dim[2]; i[2]++)
+			{
+				memcpy(bp, ap, dim[3] * sizeof(unsigned char));
+				ap += ainc[3];
+				bp += binc[3];
+			}
+			ap += (ainc[2] - dim[2]) * ainc[3];
+			bp += (binc[2] - dim[2]) * binc[3];
+		}
+		ap += (ainc[1] - dim[1]) * ainc[2] * ainc[3];
+		bp += (binc[1] - dim[1]) * binc[2] * binc[3];
+	}
+}
+
 void _ccv_nnc_tensor_transfer_cpu_ref_f32(const ccv_nnc_tensor_view_t* const a, ccv_nnc_tensor_view_t* const b)
 {
 	// Assuming this is float 32.
@@ -231,6 +287,42 @@ void _ccv_nnc_tensor_set_cpu_ref(ccv_nnc_tensor_view_t* const a, const float b)
 	}
 }
 
+float _ccv_nnc_gradient_clip_cpu_ref(const float max_norm, const float scale, ccv_nnc_tensor_t* const* const inputs, const int input_size, const int stride)
+{
+	if (max_norm <= 0)
+		return 1;
+	double sum = 0;
+	int k, x;
+	for (k = 0; k < input_size; k += stride)
+	{
+		// The gradient is the first input of each group.
+		const ccv_nnc_tensor_view_t* const g = (ccv_nnc_tensor_view_t*)inputs[k];
+		int dim[CCV_NNC_MAX_DIM_ALLOC];
+		int ginc[CCV_NNC_MAX_DIM_ALLOC];
+		assert(CCV_NNC_MAX_DIM == 2); // Need to change this logic for CCV_NNC_MAX_DIM == other number.
+		ccv_nnc_tensor_view_get_dim(g, dim);
+		ccv_nnc_tensor_view_get_inc(g, ginc);
+		int i[CCV_NNC_MAX_DIM + 1];
+		const float* gp = g->data.f32;
+		for (i[0] = 0; i[0] < dim[0]; i[0]++)
+		{
+			for (i[1] = 0; i[1] < dim[1]; i[1]++)
+			{
+				for (i[2] = 0; i[2] < dim[2]; i[2]++)
+				{
+					for (x = 0; x < dim[3]; x++)
+						sum += (double)gp[x] * gp[x];
+					gp += ginc[3];
+				}
+				gp += (ginc[2] - dim[2]) * ginc[3];
+			}
+			gp += (ginc[1] - dim[1]) * ginc[2] * ginc[3];
+		}
+	}
+	const double norm = sqrt(sum) * fabsf(scale);
+	return norm > max_norm ? (float)(max_norm / (norm + 1e-6)) : 1;
+}
+
 static int _ccv_nnc_data_transfer(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
 {
 	int i;
@@ -247,6 +339,8 @@ static int _ccv_nnc_data_transfer(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t
 				_ccv_nnc_tensor_transfer_cpu_ref_f32(a, b);
 			else if (a->info.datatype == CCV_64F)
 				_ccv_nnc_tensor_transfer_cpu_ref_f64(a, b);
+			else if (a->info.datatype == CCV_8S || a->info.datatype == CCV_8U)
+				_ccv_nnc_tensor_transfer_cpu_ref_u8(a, b);
 		}
 	}
 	return CCV_NNC_EXEC_SUCCESS;
@@ -255,7 +349,7 @@ static int _ccv_nnc_data_transfer(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t
 REGISTER_COMMAND_BACKEND(CCV_NNC_DATA_TRANSFER_FORWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
 {
 	registry->tensor_formats = CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_CHWN;
-	registry->tensor_datatypes = CCV_64F | CCV_32F | CCV_16F | CCV_32S;
+	registry->tensor_datatypes = CCV_64F | CCV_32F | CCV_16F | CCV_32S | CCV_8S | CCV_8U;
 	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
 	registry->algorithms = 1;
 	registry->exec = _ccv_nnc_data_transfer;
@@ -264,7 +358,7 @@ REGISTER_COMMAND_BACKEND(CCV_NNC_DATA_TRANSFER_FORWARD, CCV_NNC_BACKEND_CPU_REF)
 REGISTER_COMMAND_BACKEND(CCV_NNC_DATA_TRANSFER_BACKWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
 {
 	registry->tensor_formats = CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_CHWN;
-	registry->tensor_datatypes = CCV_64F | CCV_32F | CCV_16F | CCV_32S;
+	registry->tensor_datatypes = CCV_64F | CCV_32F | CCV_16F | CCV_32S | CCV_8S | CCV_8U;
 	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
 	registry->algorithms = 1;
 	registry->exec = _ccv_nnc_data_transfer;
@@ -1,31 +1,54 @@
 #include <assert.h>
 #include "co.h"
 
-static void _co_append_task(co_scheduler_t* const scheduler, co_routine_t* const task)
+static void _co_list_append(co_routine_t** const head, co_routine_t** const tail, co_routine_t* const task)
 {
-	if (scheduler->tail)
+	if (*tail)
 	{
-		scheduler->tail->next = task;
-		task->prev = scheduler->tail;
+		(*tail)->next = task;
+		task->prev = *tail;
 	} else {
-		scheduler->head = task;
+		*head = task;
 		task->prev = 0;
 	}
-	scheduler->tail = task;
+	*tail = task;
 	task->next = 0;
 }
 
-static void _co_delete_task(co_scheduler_t* const scheduler, co_routine_t* const task)
+static void _co_list_prepend(co_routine_t** const head, co_routine_t** const tail, co_routine_t* const task)
+{
+	if (*head)
+	{
+		(*head)->prev = task;
+		task->next = *head;
+	} else {
+		*tail = task;
+		task->next = 0;
+	}
+	*head = task;
+	task->prev = 0;
+}
+
+static void _co_list_delete(co_routine_t** const head, co_routine_t** const tail, co_routine_t* const task)
 {
 	if (task->prev)
 		task->prev->next = task->next;
 	else
-		scheduler->head = task->next;
+		*head = task->next;
 	if (task->next)
 		task->next->prev = task->prev;
 	else
-		scheduler->tail = task->prev;
+		*tail = task->prev;
+}
 
+static void _co_append_task(co_scheduler_t* const scheduler, co_routine_t* const task)
+{
+	_co_list_append(&scheduler->head, &scheduler->tail, task);
+}
+
+static void _co_delete_task(co_scheduler_t* const scheduler, co_routine_t* const task)
+{
+	_co_list_delete(&scheduler->head, &scheduler->tail, task);
 }
 
 static co_routine_t* _co_done(co_routine_t* const task)
@@ -51,16 +74,18 @@ static co_routine_t* _co_done(co_routine_t* const task)
 
 void _co_prepend_task(co_scheduler_t* const scheduler, co_routine_t* const task)
 {
-	if (scheduler->head)
+	if (scheduler->worker_count > 0)
 	{
-		scheduler->head->prev = task;
-		task->next = scheduler->head;
-	} else {
-		scheduler->tail = task;
-		task->next = 0;
+		// The task may still be running on a worker (it just returned from waiting), in that case,
+		// the worker will put it back.
+		if (!task->suspend)
+		{
+			task->wakeup = 1;
+			return;
+		}
+		task->suspend = 0;
 	}
-	scheduler->head = task;
-	task->prev = 0;
+	_co_list_prepend(&scheduler->head, &scheduler->tail, task);
 }
 
 void _co_resume(co_routine_t* const self, co_routine_t* const task)
@@ -80,7 +105,21 @@ void _co_apply(co_routine_t* const self, co_routine_t* const task)
 	_co_await_any(self, &task, 1);
 }
 
+static int _co_await_any_locked(co_routine_t* const self, co_routine_t* const* const tasks, const int task_size);
+
 int _co_await_any(co_routine_t* const self, co_routine_t* const* const tasks, const int task_size)
+{
+	co_scheduler_t* const scheduler = self->scheduler;
+	if (!scheduler || scheduler->worker_count == 0)
+		return _co_await_any_locked(self, tasks, task_size);
+	// The tasks we wait may be finishing on other workers.
+	pthread_mutex_lock(&scheduler->mutex);
+	const int done = _co_await_any_locked(self, tasks, task_size);
+	pthread_mutex_unlock(&scheduler->mutex);
+	return done;
+}
+
+static int _co_await_any_locked(co_routine_t* const self, co_routine_t* const* const tasks, const int task_size)
 {
 	assert(task_size > 0);
 	if (task_size == 1) // Special casing this, no need to add to others list, which has life-cycle requirement for this list.
@@ -118,7 +157,13 @@ void co_free(co_routine_t* const task)
 
 int co_is_done(const co_routine_t* const task)
 {
-	return task->done;
+	co_scheduler_t* const scheduler = task->scheduler;
+	if (!scheduler || scheduler->worker_count == 0)
+		return task->done;
+	pthread_mutex_lock(&scheduler->mutex);
+	const int done = task->done;
+	pthread_mutex_unlock(&scheduler->mutex);
+	return done;
 }
 
 static __thread co_scheduler_t* scheduler_per_thread = 0;
@@ -250,10 +295,169 @@ static void _co_try(co_scheduler_t* const scheduler)
 	scheduler_per_thread = previous_scheduler;
 }
 
+static __thread co_worker_t* worker_per_thread = 0;
+
+static void _co_worker_push(co_scheduler_t* const scheduler, co_worker_t* const worker, co_routine_t* const task)
+{
+	// Push to the head of our own deque, if this is not from a worker, push to the shared queue.
+	if (worker)
+		_co_list_prepend(&worker->head, &worker->tail, task);
+	else
+		_co_list_append(&scheduler->head, &scheduler->tail, task);
+	pthread_cond_signal(&scheduler->wait);
+}
+
+static co_routine_t* _co_worker_pop(co_scheduler_t* const scheduler, co_worker_t* const worker)
+{
+	co_routine_t* task = worker->head;
+	if (task)
+	{
+		_co_list_delete(&worker->head, &worker->tail, task);
+		return task;
+	}
+	task = scheduler->head;
+	if (task)
+	{
+		_co_delete_task(scheduler, task);
+		return task;
+	}
+	// Steal from the tail of other workers' deque.
+	int i;
+	const int worker_count = scheduler->worker_count;
+	const int worker_idx = (int)(worker - scheduler->workers);
+	for (i = 1; i < worker_count; i++)
+	{
+		co_worker_t* const victim = scheduler->workers + (worker_idx + i) % worker_count;
+		task = victim->tail;
+		if (task)
+		{
+			_co_list_delete(&victim->head, &victim->tail, task);
+			return task;
+		}
+	}
+	return 0;
+}
+
+static void _co_worker_run(co_scheduler_t* const scheduler, co_worker_t* const worker, co_routine_t* task)
+{
+	while (task) {
+		const co_state_t state = task->fn(task, task + 1);
+		co_routine_t* next;
+		co_routine_t* freeable = 0;
+		pthread_mutex_lock(&scheduler->mutex);
+		task->line = state.line;
+		if (task->callee)
+		{
+			// Only resumes when the callee returns.
+			task->suspend = 1;
+			next = task->callee;
+		} else {
+			next = task->caller;
+			task->caller = 0;
+			co_routine_t* notify_any = 0;
+			if (state.done)
+			{
+				notify_any = _co_done(task);
+				if (task->root) // Free the task scheduled from co_schedule.
+				{
+					freeable = task;
+					// Start the next root task if there is any.
+					co_routine_t* const root = scheduler->root_head;
+					if (root)
+					{
+						_co_list_delete(&scheduler->root_head, &scheduler->root_tail, root);
+						_co_worker_push(scheduler, worker, root);
+					} else {
+						scheduler->active = 0;
+						pthread_cond_broadcast(&scheduler->notify);
+					}
+				}
+				// Once done is marked, the task can be freed by others.
+				task->done = 1;
+			} else if (task->wakeup) {
+				task->wakeup = 0;
+				_co_worker_push(scheduler, worker, task);
+			} else
+				task->suspend = 1;
+			if (next)
+				next->suspend = 0;
+			if (notify_any)
+			{
+				// It is possible the task we need to notify hasn't returned yet.
+				if (!notify_any->suspend)
+					notify_any->wakeup = 1;
+				else {
+					notify_any->suspend = 0;
+					if (!next)
+						next = notify_any;
+					else
+						_co_worker_push(scheduler, worker, notify_any);
+				}
+			}
+		}
+		pthread_mutex_unlock(&scheduler->mutex);
+		if (freeable)
+			co_free(freeable);
+		task = next;
+	}
+}
+
+void _co_spawn(co_routine_t* const self, co_routine_t* const task)
+{
+	assert(!task->done);
+	co_scheduler_t* const scheduler = self->scheduler;
+	task->scheduler = scheduler;
+	task->caller = 0;
+	pthread_mutex_lock(&scheduler->mutex);
+	if (scheduler->worker_count > 0)
+		_co_worker_push(scheduler, worker_per_thread && worker_per_thread->scheduler == scheduler ? worker_per_thread : 0, task);
+	else // Runs once the current task returns to the scheduler.
+		_co_append_task(scheduler, task);
+	pthread_mutex_unlock(&scheduler->mutex);
+}
+
+static void* _co_worker_main(void* userdata)
+{
+	co_worker_t* const worker = (co_worker_t*)userdata;
+	co_scheduler_t* const scheduler = worker->scheduler;
+	scheduler_per_thread = scheduler;
+	worker_per_thread = worker;
+	pthread_mutex_lock(&scheduler->mutex);
+	for (;;)
+	{
+		co_routine_t* const task = _co_worker_pop(scheduler, worker);
+		if (!task)
+		{
+			if (scheduler->quit)
+				break;
+			pthread_cond_wait(&scheduler->wait, &scheduler->mutex);
+			continue;
+		}
+		pthread_mutex_unlock(&scheduler->mutex);
+		_co_worker_run(scheduler, worker, task);
+		pthread_mutex_lock(&scheduler->mutex);
+	}
+	pthread_mutex_unlock(&scheduler->mutex);
+	return 0;
+}
+
 void co_schedule(co_scheduler_t* const scheduler, co_routine_t* const task)
 {
 	task->scheduler = scheduler;
 	task->root = 1; // If this is the root, we will free it ourselves.
+	if (scheduler->worker_count > 0)
+	{
+		pthread_mutex_lock(&scheduler->mutex);
+		// Root tasks on the same scheduler are executed one after another.
+		if (scheduler->active)
+			_co_list_append(&scheduler->root_head, &scheduler->root_tail, task);
+		else {
+			scheduler->active = 1;
+			_co_worker_push(scheduler, worker_per_thread && worker_per_thread->scheduler == scheduler ? worker_per_thread : 0, task);
+		}
+		pthread_mutex_unlock(&scheduler->mutex);
+		return;
+	}
 	int activate_scheduler = 0;
 	pthread_mutex_lock(&scheduler->mutex);
 	_co_append_task(scheduler, task);
@@ -271,6 +475,11 @@ int co_is_on_scheduler(co_scheduler_t* const scheduler)
 	return scheduler_per_thread == scheduler;
 }
 
+int co_scheduler_worker_count(const co_scheduler_t* const scheduler)
+{
+	return scheduler->worker_count;
+}
+
 int co_scheduler_is_active(co_scheduler_t* const scheduler)
 {
 	pthread_mutex_lock(&scheduler->mutex);
@@ -279,17 +488,39 @@ int co_scheduler_is_active(co_scheduler_t* const scheduler)
 	return active;
 }
 
-co_scheduler_t* co_scheduler_new(void)
+co_scheduler_t* co_scheduler_new(const int worker_count)
 {
 	co_scheduler_t* const scheduler = cccalloc(1, sizeof(co_scheduler_t));
 	pthread_mutex_init(&scheduler->mutex, 0);
 	pthread_cond_init(&scheduler->notify, 0);
 	pthread_cond_init(&scheduler->wait, 0);
+	if (worker_count > 0)
+	{
+		scheduler->worker_count = worker_count;
+		scheduler->workers = (co_worker_t*)cccalloc(worker_count, sizeof(co_worker_t));
+		int i;
+		for (i = 0; i < worker_count; i++)
+		{
+			scheduler->workers[i].scheduler = scheduler;
+			pthread_create(&scheduler->workers[i].thread, 0, _co_worker_main, scheduler->workers + i);
+		}
+	}
 	return scheduler;
 }
 
 void co_scheduler_free(co_scheduler_t* const scheduler)
 {
+	if (scheduler->worker_count > 0)
+	{
+		pthread_mutex_lock(&scheduler->mutex);
+		scheduler->quit = 1;
+		pthread_cond_broadcast(&scheduler->wait);
+		pthread_mutex_unlock(&scheduler->mutex);
+		int i;
+		for (i = 0; i < scheduler->worker_count; i++)
+			pthread_join(scheduler->workers[i].thread, 0);
+		ccfree(scheduler->workers);
+	}
 	pthread_mutex_destroy(&scheduler->mutex);
 	pthread_cond_destroy(&scheduler->notify);
 	pthread_cond_destroy(&scheduler->wait);
@@ -9,7 +9,16 @@
 
 typedef struct co_routine_s co_routine_t;
 
+typedef struct co_scheduler_s co_scheduler_t;
+
 typedef struct {
+	co_routine_t* head;
+	co_routine_t* tail;
+	co_scheduler_t* scheduler;
+	pthread_t thread;
+} co_worker_t;
+
+struct co_scheduler_s {
 	int active;
 	int stream_await_count;
 	co_routine_t* head;
@@ -18,7 +27,13 @@ typedef struct {
 	pthread_cond_t notify;
 	pthread_cond_t wait;
 	pthread_mutex_t mutex;
-} co_scheduler_t;
+	// If there are workers, tasks run on these threads with per worker deques, and idle workers steal from others.
+	int worker_count;
+	int quit;
+	co_routine_t* root_head; // Root tasks wait here until the previous root task is done.
+	co_routine_t* root_tail;
+	co_worker_t* workers;
+};
 
 typedef struct {
 	int line;
@@ -32,6 +47,8 @@ struct co_routine_s {
 	int done;
 	int root;
 	int other_size;
+	int suspend; // Whether the task returned and waits to be resumed, only used by the scheduler with workers.
+	int wakeup; // Whether the task has been resumed before it returned, only used by the scheduler with workers.
 	co_scheduler_t* scheduler;
 	co_routine_t* prev;
 	co_routine_t* next;
@@ -145,6 +162,9 @@ struct co_routine_s {
 	_task->done = 0; \
 	_task->root = 0; \
 	_task->other_size = 0; \
+	_task->suspend = 0; \
+	_task->wakeup = 0; \
+	_task->scheduler = 0; \
 	_task->notify_any = 0; \
 	_task->others = 0; \
 	_task->caller = 0; \
@@ -225,17 +245,25 @@ struct co_routine_s {
 
 #define co_resume(_task, ...) co_resume_sel(_0, ## __VA_ARGS__, co_resume_1, co_resume_0)(_task, ## __VA_ARGS__)
 
+// Queue the task to run on its own, in parallel on another worker if there are any. It doesn't resume
+// the current task when done, use co_await / co_await_any on it, and co_free it afterwards.
+#define co_spawn(_task) _co_spawn(_self_, _task)
+
 void _co_prepend_task(co_scheduler_t* const scheduler, co_routine_t* const task);
 void _co_apply(co_routine_t* const self, co_routine_t* const task);
 void _co_resume(co_routine_t* const self, co_routine_t* const task);
+void _co_spawn(co_routine_t* const self, co_routine_t* const task);
 int _co_await_any(co_routine_t* const self, co_routine_t* const* const tasks, const int task_size);
 
 void co_free(co_routine_t* const task);
 int co_is_done(const co_routine_t* const task);
-co_scheduler_t* co_scheduler_new(void);
+// If worker_count is 0, tasks run on the thread calls co_schedule until they need to wait for a stream,
+// and then a helper thread takes over. Otherwise, ready tasks run in parallel on worker_count threads.
+co_scheduler_t* co_scheduler_new(const int worker_count);
 void co_scheduler_free(co_scheduler_t* const scheduler);
 void co_schedule(co_scheduler_t* const scheduler, co_routine_t* const task);
 int co_is_on_scheduler(co_scheduler_t* const scheduler);
+int co_scheduler_worker_count(const co_scheduler_t* const scheduler);
 int co_scheduler_is_active(co_scheduler_t* const scheduler);
 
 #endif
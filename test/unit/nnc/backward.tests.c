@@ -222,4 +222,289 @@ TEST_CASE("full connect back propagation with batch = 2")
 	ccv_nnc_tensor_free(gbias);
 }
 
+TEST_CASE("convolution backward of 3x3 on 28x28 with CPU_OPT")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_CONVOLUTION_BACKWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 28, 28, 16), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 28, 28, 24), 0);
+	ccv_nnc_cmd_t back_cmd = CMD_CONVOLUTION_BACKWARD(1, 24, 3, 3, 16);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(back_cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 24, 3, 3, 16), 0);
+	ccv_nnc_tensor_t* const g = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 28, 28, 24), 0);
+	int i;
+	for (i = 0; i < 24 * 3 * 3 * 16; i++)
+		w->data.f32[i] = sinf(i * 0.37) * 0.5;
+	for (i = 0; i < 28 * 28 * 16; i++)
+		a->data.f32[i] = cosf(i * 0.11);
+	for (i = 0; i < 28 * 28 * 24; i++)
+		g->data.f32[i] = sinf(i * 0.23);
+	ccv_nnc_tensor_t* const h = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 28, 28, 16), 0);
+	ccv_nnc_tensor_t* const gw = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 24, 3, 3, 16), 0);
+	ccv_nnc_tensor_t* const gbias = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 24), 0);
+	ccv_nnc_tensor_t* const rh = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 28, 28, 16), 0);
+	ccv_nnc_tensor_t* const rgw = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 24, 3, 3, 16), 0);
+	ccv_nnc_tensor_t* const rgbias = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 24), 0);
+	back_cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	REQUIRE_EQ(ccv_nnc_cmd_exec(back_cmd, hint, 0, TENSOR_LIST(g, a, w), TENSOR_LIST(rh, rgw, rgbias), 0), CCV_NNC_EXEC_SUCCESS, "reference should run");
+	back_cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	// Default picks Winograd for the propagated error.
+	back_cmd.algorithm = -1;
+	REQUIRE_EQ(ccv_nnc_cmd_exec(back_cmd, hint, 0, TENSOR_LIST(g, a, w), TENSOR_LIST(h, gw, gbias), 0), CCV_NNC_EXEC_SUCCESS, "Winograd should run");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, h->data.f32, rh->data.f32, 28 * 28 * 16, 1e-3, "Winograd propagated error should match the reference");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, gw->data.f32, rgw->data.f32, 24 * 3 * 3 * 16, 1e-3, "Winograd weight gradient should match the reference");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, gbias->data.f32, rgbias->data.f32, 24, 1e-3, "Winograd bias gradient should match the reference");
+	back_cmd.algorithm = 1;
+	REQUIRE_EQ(ccv_nnc_cmd_exec(back_cmd, hint, 0, TENSOR_LIST(g, a, w), TENSOR_LIST(h, gw, gbias), 0), CCV_NNC_EXEC_SUCCESS, "GEMM should run");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, h->data.f32, rh->data.f32, 28 * 28 * 16, 1e-3, "GEMM propagated error should match the reference");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, gw->data.f32, rgw->data.f32, 24 * 3 * 3 * 16, 1e-3, "GEMM weight gradient should match the reference");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, gbias->data.f32, rgbias->data.f32, 24, 1e-3, "GEMM bias gradient should match the reference");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(g);
+	ccv_nnc_tensor_free(h);
+	ccv_nnc_tensor_free(gw);
+	ccv_nnc_tensor_free(gbias);
+	ccv_nnc_tensor_free(rh);
+	ccv_nnc_tensor_free(rgw);
+	ccv_nnc_tensor_free(rgbias);
+}
+
+TEST_CASE("convolution backward of 5x3 with stride 2 on 31x21 with CPU_OPT")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_CONVOLUTION_BACKWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 31, 21, 3), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 16, 11, 32), 0);
+	ccv_nnc_cmd_t back_cmd = CMD_CONVOLUTION_BACKWARD(1, 32, 5, 3, 3);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(back_cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 32, 5, 3, 3), 0);
+	ccv_nnc_tensor_t* const g = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 16, 11, 32), 0);
+	int i;
+	for (i = 0; i < 32 * 5 * 3 * 3; i++)
+		w->data.f32[i] = sinf(i * 0.37) * 0.5;
+	for (i = 0; i < 31 * 21 * 3; i++)
+		a->data.f32[i] = cosf(i * 0.11);
+	for (i = 0; i < 16 * 11 * 32; i++)
+		g->data.f32[i] = sinf(i * 0.23);
+	ccv_nnc_tensor_t* const h = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 31, 21, 3), 0);
+	ccv_nnc_tensor_t* const gw = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 32, 5, 3, 3), 0);
+	ccv_nnc_tensor_t* const gbias = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 32), 0);
+	ccv_nnc_tensor_t* const rh = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 31, 21, 3), 0);
+	ccv_nnc_tensor_t* const rgw = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 32, 5, 3, 3), 0);
+	ccv_nnc_tensor_t* const rgbias = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 32), 0);
+	back_cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	REQUIRE_EQ(ccv_nnc_cmd_exec(back_cmd, hint, 0, TENSOR_LIST(g, a, w), TENSOR_LIST(rh, rgw, rgbias), 0), CCV_NNC_EXEC_SUCCESS, "reference should run");
+	back_cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	REQUIRE_EQ(ccv_nnc_cmd_exec(back_cmd, hint, 0, TENSOR_LIST(g, a, w), TENSOR_LIST(h, gw, gbias), 0), CCV_NNC_EXEC_SUCCESS, "CPU_OPT should run");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, h->data.f32, rh->data.f32, 31 * 21 * 3, 1e-3, "propagated error should match the reference");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, gw->data.f32, rgw->data.f32, 32 * 5 * 3 * 3, 1e-3, "weight gradient should match the reference");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, gbias->data.f32, rgbias->data.f32, 32, 1e-3, "bias gradient should match the reference");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(g);
+	ccv_nnc_tensor_free(h);
+	ccv_nnc_tensor_free(gw);
+	ccv_nnc_tensor_free(gbias);
+	ccv_nnc_tensor_free(rh);
+	ccv_nnc_tensor_free(rgw);
+	ccv_nnc_tensor_free(rgbias);
+}
+
+TEST_CASE("packed gemm forward and backward with CPU_OPT")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_GEMM_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_GEMM_BACKWARD, CCV_NNC_BACKEND_CPU_OPT));
+	// Sizes are not multiples of the register blocks, and cover more than one block along k and n.
+	static const int shapes[][3] = {
+		{ 37, 301, 131 },
+		{ 263, 45, 3101 },
+	};
+	int i, j;
+	for (i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++)
+	{
+		const int batch_size = shapes[i][0], ic = shapes[i][1], oc = shapes[i][2];
+		ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, batch_size, ic), 0);
+		ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, oc, ic), 0);
+		ccv_nnc_tensor_t* const bias = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, oc), 0);
+		ccv_nnc_tensor_t* const g = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, batch_size, oc), 0);
+		for (j = 0; j < batch_size * ic; j++)
+			a->data.f32[j] = cosf(j * 0.11);
+		for (j = 0; j < oc * ic; j++)
+			w->data.f32[j] = sinf(j * 0.37) * 0.5;
+		for (j = 0; j < oc; j++)
+			bias->data.f32[j] = j * 0.01;
+		for (j = 0; j < batch_size * oc; j++)
+			g->data.f32[j] = sinf(j * 0.23);
+		ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, batch_size, oc), 0);
+		ccv_nnc_tensor_t* const h = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, batch_size, ic), 0);
+		ccv_nnc_tensor_t* const gw = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, oc, ic), 0);
+		ccv_nnc_tensor_t* const gbias = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, oc), 0);
+		ccv_nnc_tensor_t* const rb = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, batch_size, oc), 0);
+		ccv_nnc_tensor_t* const rh = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, batch_size, ic), 0);
+		ccv_nnc_tensor_t* const rgw = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, oc, ic), 0);
+		ccv_nnc_tensor_t* const rgbias = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, oc), 0);
+		ccv_nnc_cmd_t forw_cmd = CMD_GEMM_FORWARD(NO_TRANSPOSE, TRANSPOSE(0, 1));
+		ccv_nnc_cmd_t back_cmd = CMD_GEMM_BACKWARD(NO_TRANSPOSE, TRANSPOSE(0, 1));
+		forw_cmd.backend = back_cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		REQUIRE_EQ(ccv_nnc_cmd_exec(forw_cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(rb), 0), CCV_NNC_EXEC_SUCCESS, "reference forward should run");
+		REQUIRE_EQ(ccv_nnc_cmd_exec(back_cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(g, a, w), TENSOR_LIST(rh, rgw, rgbias), 0), CCV_NNC_EXEC_SUCCESS, "reference backward should run");
+		forw_cmd.backend = back_cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		forw_cmd.algorithm = back_cmd.algorithm = 0; // CCV_NNC_CMD_OPT_GEMM_ALGO_DIRECT
+		REQUIRE_EQ(ccv_nnc_cmd_exec(forw_cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(b), 0), CCV_NNC_EXEC_SUCCESS, "packed forward should run");
+		REQUIRE_EQ(ccv_nnc_cmd_exec(back_cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(g, a, w), TENSOR_LIST(h, gw, gbias), 0), CCV_NNC_EXEC_SUCCESS, "packed backward should run");
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, rb->data.f32, batch_size * oc, 1e-3, "%dx%dx%d gemm output should match the reference", batch_size, ic, oc);
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, h->data.f32, rh->data.f32, batch_size * ic, 1e-3, "%dx%dx%d gemm propagated error should match the reference", batch_size, ic, oc);
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, gw->data.f32, rgw->data.f32, oc * ic, 1e-3, "%dx%dx%d gemm weight gradient should match the reference", batch_size, ic, oc);
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, gbias->data.f32, rgbias->data.f32, oc, 1e-3, "%dx%dx%d gemm bias gradient should match the reference", batch_size, ic, oc);
+		ccv_nnc_tensor_free(a);
+		ccv_nnc_tensor_free(w);
+		ccv_nnc_tensor_free(bias);
+		ccv_nnc_tensor_free(g);
+		ccv_nnc_tensor_free(b);
+		ccv_nnc_tensor_free(h);
+		ccv_nnc_tensor_free(gw);
+		ccv_nnc_tensor_free(gbias);
+		ccv_nnc_tensor_free(rb);
+		ccv_nnc_tensor_free(rh);
+		ccv_nnc_tensor_free(rgw);
+		ccv_nnc_tensor_free(rgbias);
+	}
+}
+
+TEST_CASE("max pool forward and backward with CPU_OPT")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_MAX_POOL_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_MAX_POOL_BACKWARD, CCV_NNC_BACKEND_CPU_OPT));
+	// Input height, width, channels, output height, width and the window.
+	static const int shapes[][7] = {
+		{ 28, 28, 16, 14, 14, 2, 2 },
+		{ 28, 28, 19, 14, 14, 3, 3 },
+		{ 55, 31, 7, 27, 15, 3, 3 },
+		{ 23, 17, 5, 8, 6, 5, 4 },
+	};
+	int i, j;
+	for (i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++)
+	{
+		const int ih = shapes[i][0], iw = shapes[i][1], c = shapes[i][2], oh = shapes[i][3], ow = shapes[i][4], kh = shapes[i][5], kw = shapes[i][6];
+		ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, ih, iw, c), 0);
+		ccv_nnc_tensor_t* const g = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, oh, ow, c), 0);
+		for (j = 0; j < ih * iw * c; j++)
+			a->data.f32[j] = sinf(j * 0.37);
+		for (j = 0; j < oh * ow * c; j++)
+			g->data.f32[j] = cosf(j * 0.11);
+		ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, oh, ow, c), 0);
+		ccv_nnc_tensor_t* const h = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, ih, iw, c), 0);
+		ccv_nnc_tensor_t* const rb = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, oh, ow, c), 0);
+		ccv_nnc_tensor_t* const rh = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, ih, iw, c), 0);
+		ccv_nnc_cmd_t forw_cmd = CMD_MAX_POOL_FORWARD(kh, kw);
+		ccv_nnc_cmd_t back_cmd = CMD_MAX_POOL_BACKWARD(kh, kw);
+		ccv_nnc_hint_t hint = ccv_nnc_hint_auto(forw_cmd.info, a->info, b->info);
+		forw_cmd.backend = back_cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		REQUIRE_EQ(ccv_nnc_cmd_exec(forw_cmd, hint, 0, TENSOR_LIST(a), TENSOR_LIST(rb), 0), CCV_NNC_EXEC_SUCCESS, "reference forward should run");
+		REQUIRE_EQ(ccv_nnc_cmd_exec(back_cmd, hint, 0, TENSOR_LIST(g, a, rb), TENSOR_LIST(rh), 0), CCV_NNC_EXEC_SUCCESS, "reference backward should run");
+		forw_cmd.backend = back_cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		REQUIRE_EQ(ccv_nnc_cmd_exec(forw_cmd, hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), 0), CCV_NNC_EXEC_SUCCESS, "CPU_OPT forward should run");
+		REQUIRE_EQ(ccv_nnc_cmd_exec(back_cmd, hint, 0, TENSOR_LIST(g, a, b), TENSOR_LIST(h), 0), CCV_NNC_EXEC_SUCCESS, "CPU_OPT backward should run");
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, rb->data.f32, oh * ow * c, 1e-5, "%dx%d max pool on %dx%dx%d should match the reference", kh, kw, ih, iw, c);
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, h->data.f32, rh->data.f32, ih * iw * c, 1e-5, "%dx%d max pool gradient on %dx%dx%d should match the reference", kh, kw, ih, iw, c);
+		ccv_nnc_tensor_free(a);
+		ccv_nnc_tensor_free(g);
+		ccv_nnc_tensor_free(b);
+		ccv_nnc_tensor_free(h);
+		ccv_nnc_tensor_free(rb);
+		ccv_nnc_tensor_free(rh);
+	}
+}
+
+TEST_CASE("average pool forward and backward with CPU_OPT")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_AVERAGE_POOL_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_AVERAGE_POOL_BACKWARD, CCV_NNC_BACKEND_CPU_OPT));
+	// Same shapes as the max pool, plus a global average pool over 7x7.
+	static const int shapes[][7] = {
+		{ 28, 28, 16, 14, 14, 2, 2 },
+		{ 28, 28, 19, 14, 14, 3, 3 },
+		{ 55, 31, 7, 27, 15, 3, 3 },
+		{ 23, 17, 5, 8, 6, 5, 4 },
+		{ 7, 7, 131, 1, 1, 7, 7 },
+	};
+	int i, j;
+	for (i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++)
+	{
+		const int ih = shapes[i][0], iw = shapes[i][1], c = shapes[i][2], oh = shapes[i][3], ow = shapes[i][4], kh = shapes[i][5], kw = shapes[i][6];
+		ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, ih, iw, c), 0);
+		ccv_nnc_tensor_t* const g = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, oh, ow, c), 0);
+		for (j = 0; j < ih * iw * c; j++)
+			a->data.f32[j] = sinf(j * 0.37);
+		for (j = 0; j < oh * ow * c; j++)
+			g->data.f32[j] = cosf(j * 0.11);
+		ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, oh, ow, c), 0);
+		ccv_nnc_tensor_t* const h = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, ih, iw, c), 0);
+		ccv_nnc_tensor_t* const rb = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, oh, ow, c), 0);
+		ccv_nnc_tensor_t* const rh = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, ih, iw, c), 0);
+		ccv_nnc_cmd_t forw_cmd = CMD_AVERAGE_POOL_FORWARD(kh, kw);
+		ccv_nnc_cmd_t back_cmd = CMD_AVERAGE_POOL_BACKWARD(kh, kw);
+		ccv_nnc_hint_t hint = ccv_nnc_hint_auto(forw_cmd.info, a->info, b->info);
+		forw_cmd.backend = back_cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		REQUIRE_EQ(ccv_nnc_cmd_exec(forw_cmd, hint, 0, TENSOR_LIST(a), TENSOR_LIST(rb), 0), CCV_NNC_EXEC_SUCCESS, "reference forward should run");
+		REQUIRE_EQ(ccv_nnc_cmd_exec(back_cmd, hint, 0, TENSOR_LIST(g, a, rb), TENSOR_LIST(rh), 0), CCV_NNC_EXEC_SUCCESS, "reference backward should run");
+		forw_cmd.backend = back_cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		REQUIRE_EQ(ccv_nnc_cmd_exec(forw_cmd, hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), 0), CCV_NNC_EXEC_SUCCESS, "CPU_OPT forward should run");
+		REQUIRE_EQ(ccv_nnc_cmd_exec(back_cmd, hint, 0, TENSOR_LIST(g, a, b), TENSOR_LIST(h), 0), CCV_NNC_EXEC_SUCCESS, "CPU_OPT backward should run");
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, rb->data.f32, oh * ow * c, 1e-5, "%dx%d average pool on %dx%dx%d should match the reference", kh, kw, ih, iw, c);
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, h->data.f32, rh->data.f32, ih * iw * c, 1e-5, "%dx%d average pool gradient on %dx%dx%d should match the reference", kh, kw, ih, iw, c);
+		ccv_nnc_tensor_free(a);
+		ccv_nnc_tensor_free(g);
+		ccv_nnc_tensor_free(b);
+		ccv_nnc_tensor_free(h);
+		ccv_nnc_tensor_free(rb);
+		ccv_nnc_tensor_free(rh);
+	}
+}
+
+TEST_CASE("sigmoid, tanh and softmax forward and backward with CPU_OPT")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_SIGMOID_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_SIGMOID_BACKWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_TANH_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_TANH_BACKWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_SOFTMAX_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_SOFTMAX_BACKWARD, CCV_NNC_BACKEND_CPU_OPT));
+	// Rows of odd length, spanning more than one chunk, to exercise both the vector and the scalar paths.
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 5, 2003), 0);
+	ccv_nnc_tensor_t* const g = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 5, 2003), 0);
+	int i;
+	for (i = 0; i < 5 * 2003; i++)
+		a->data.f32[i] = sinf(i * 0.37) * 10, g->data.f32[i] = cosf(i * 0.11);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 5, 2003), 0);
+	ccv_nnc_tensor_t* const h = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 5, 2003), 0);
+	ccv_nnc_tensor_t* const rb = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 5, 2003), 0);
+	ccv_nnc_tensor_t* const rh = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 5, 2003), 0);
+	const ccv_nnc_cmd_t cmds[][2] = {
+		{ CMD_SIGMOID_FORWARD(), CMD_SIGMOID_BACKWARD() },
+		{ CMD_TANH_FORWARD(), CMD_TANH_BACKWARD() },
+		{ CMD_SOFTMAX_FORWARD(), CMD_SOFTMAX_BACKWARD() },
+	};
+	for (i = 0; i < sizeof(cmds) / sizeof(cmds[0]); i++)
+	{
+		ccv_nnc_cmd_t forw_cmd = cmds[i][0];
+		ccv_nnc_cmd_t back_cmd = cmds[i][1];
+		forw_cmd.backend = back_cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		REQUIRE_EQ(ccv_nnc_cmd_exec(forw_cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(rb), 0), CCV_NNC_EXEC_SUCCESS, "reference forward should run");
+		REQUIRE_EQ(ccv_nnc_cmd_exec(back_cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(g, a, rb), TENSOR_LIST(rh), 0), CCV_NNC_EXEC_SUCCESS, "reference backward should run");
+		forw_cmd.backend = back_cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		REQUIRE_EQ(ccv_nnc_cmd_exec(forw_cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), 0), CCV_NNC_EXEC_SUCCESS, "CPU_OPT forward should run");
+		REQUIRE_EQ(ccv_nnc_cmd_exec(back_cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(g, a, b), TENSOR_LIST(h), 0), CCV_NNC_EXEC_SUCCESS, "CPU_OPT backward should run");
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, rb->data.f32, 5 * 2003, 1e-5, "%s should match the reference", ccv_nnc_cmd_name(forw_cmd.cmd));
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, h->data.f32, rh->data.f32, 5 * 2003, 1e-5, "%s should match the reference", ccv_nnc_cmd_name(back_cmd.cmd));
+	}
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(g);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(h);
+	ccv_nnc_tensor_free(rb);
+	ccv_nnc_tensor_free(rh);
+}
+
 #include "case_main.h"
@@ -152,4 +152,60 @@ TEST_CASE("broadcasting semantics for mul [[1], [2], [3], [4]] * [5, 6]")
 	ccv_nnc_tensor_free(c);
 }
 
+TEST_CASE("broadcasting add and mul with CPU_OPT should match CPU_REF")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_ADD_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_MUL_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 1, 33, 64), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 16, 1, 64), 0);
+	ccv_nnc_tensor_t* const c = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 16, 33, 64), 0);
+	ccv_nnc_tensor_t* const ct = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 16, 33, 64), 0);
+	int i;
+	for (i = 0; i < 8 * 33 * 64; i++)
+		a->data.f32[i] = (i % 29) * 0.25 - 3;
+	for (i = 0; i < 16 * 64; i++)
+		b->data.f32[i] = (i % 13) * 0.5 - 2;
+	ccv_nnc_cmd_t cmd = CMD_ADD_FORWARD(0.5, 2);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, b), TENSOR_LIST(ct), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, b), TENSOR_LIST(c), 0);
+	REQUIRE_TENSOR_EQ(c, ct, "add result should be equal");
+	cmd = CMD_MUL_FORWARD(0.5);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(b, a), TENSOR_LIST(ct), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(b, a), TENSOR_LIST(c), 0);
+	REQUIRE_TENSOR_EQ(c, ct, "mul result should be equal");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(ct);
+}
+
+TEST_CASE("elementwise sum of tensor views with CPU_OPT should match CPU_REF")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_EWSUM_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 10, 10), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 6, 7), 0);
+	int i;
+	for (i = 0; i < 4 * 10 * 10; i++)
+		a->data.f32[i] = i;
+	for (i = 0; i < 4 * 6 * 7; i++)
+		b->data.f32[i] = -i * 0.5;
+	ccv_nnc_tensor_view_t av = ccv_nnc_tensor_view(a, CPU_TENSOR_NHWC(32F, 4, 6, 7), DIM_ALLOC(0, 2, 3), DIM_ALLOC(4, 10, 10));
+	ccv_nnc_tensor_t* const c = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 6, 7), 0);
+	ccv_nnc_tensor_t* const ct = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 6, 7), 0);
+	ccv_nnc_cmd_t cmd = CMD_EWSUM_FORWARD();
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST((ccv_nnc_tensor_t*)&av, b, b), TENSOR_LIST(ct), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST((ccv_nnc_tensor_t*)&av, b, b), TENSOR_LIST(c), 0);
+	REQUIRE_TENSOR_EQ(c, ct, "sum of tensor views should be equal");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(ct);
+}
+
 #include "case_main.h"
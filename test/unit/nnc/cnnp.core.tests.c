@@ -981,6 +981,100 @@ TEST_CASE("learn 2 * x + y = 12, first learn x, and then learn y, evaluate learn
 	ccv_cnnp_model_free(final);
 }
 
+static int _count_in_concrete_graph(const ccv_cnnp_model_t* const model, const char* const name)
+{
+	FILE* outs[2] = {
+		tmpfile(), tmpfile()
+	};
+	ccv_cnnp_model_dot(model, CCV_NNC_LONG_DOT_GRAPH, outs, 2);
+	fclose(outs[0]);
+	rewind(outs[1]);
+	char buf[1024];
+	int count = 0;
+	while (fgets(buf, sizeof(buf), outs[1]))
+	{
+		const char* p = buf;
+		while ((p = strstr(p, name)))
+			++count, p += strlen(name);
+	}
+	fclose(outs[1]);
+	return count;
+}
+
+TEST_CASE("parameters sharing the same minimizer are updated with one command")
+{
+	ccv_cnnp_model_t* const multi_layer = ccv_cnnp_sequential_new(MODEL_LIST(
+		ccv_cnnp_dense(2, 0, 0),
+		ccv_cnnp_dense(1, 0, 0)
+	), "multi_layer");
+	ccv_cnnp_model_io_t input = ccv_cnnp_input();
+	ccv_cnnp_model_io_t output = ccv_cnnp_model_apply(multi_layer, MODEL_IO_LIST(input));
+	ccv_cnnp_model_t* const final = ccv_cnnp_model_new(MODEL_IO_LIST(input), MODEL_IO_LIST(output), 0);
+	const ccv_nnc_tensor_param_t x = CPU_TENSOR_NHWC(32F, 1, 2);
+	ccv_cnnp_model_compile(final, TENSOR_PARAM_LIST(x), CMD_SGD_FORWARD(0, 0.01, 1, 0, 0, 0), CMD_SMOOTH_L1_FORWARD(1));
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, x, 0);
+	ccv_nnc_tensor_t* const f_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 1), 0);
+	ccv_nnc_tensor_t* const y_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 1), 0);
+	x_tensor->data.f32[0] = 1;
+	x_tensor->data.f32[1] = -1;
+	f_tensor->data.f32[0] = 2;
+	int i;
+	for (i = 0; i < 1000; i++)
+		ccv_cnnp_model_fit(final, TENSOR_LIST(x_tensor), TENSOR_LIST(f_tensor), TENSOR_LIST(y_tensor), 0, 0);
+	REQUIRE_EQ(_count_in_concrete_graph(final, "SGD_FORWARD"), 1, "all 4 parameters should be updated with one command");
+	REQUIRE_EQ_WITH_TOLERANCE(y_tensor->data.f32[0], 2, 1e-3, "should fit to the target");
+	// Once the minimizers diverge, each parameter is updated with its own command.
+	ccv_cnnp_model_set_minimizer(final, CMD_SGD_FORWARD(0, 0.005, 1, 0, 0, 0), 0, MODEL_IO_LIST(ccv_cnnp_model_parameters(multi_layer, CCV_CNNP_PARAMETER_SELECT_WEIGHT, ALL_PARAMETERS)));
+	REQUIRE_EQ(_count_in_concrete_graph(final, "SGD_FORWARD"), 4, "each parameter should be updated with its own command");
+	f_tensor->data.f32[0] = 1;
+	for (i = 0; i < 2000; i++)
+		ccv_cnnp_model_fit(final, TENSOR_LIST(x_tensor), TENSOR_LIST(f_tensor), TENSOR_LIST(y_tensor), 0, 0);
+	REQUIRE_EQ_WITH_TOLERANCE(y_tensor->data.f32[0], 1, 1e-3, "should fit to the new target");
+	// Back to the same minimizer, these are updated with one command again.
+	ccv_cnnp_model_set_minimizer(final, CMD_SGD_FORWARD(0, 0.01, 1, 0, 0, 0), 1, 0, 0);
+	REQUIRE_EQ(_count_in_concrete_graph(final, "SGD_FORWARD"), 1, "all 4 parameters should be updated with one command again");
+	f_tensor->data.f32[0] = 2;
+	for (i = 0; i < 1000; i++)
+		ccv_cnnp_model_fit(final, TENSOR_LIST(x_tensor), TENSOR_LIST(f_tensor), TENSOR_LIST(y_tensor), 0, 0);
+	REQUIRE_EQ_WITH_TOLERANCE(y_tensor->data.f32[0], 2, 1e-3, "should fit to the target again");
+	ccv_nnc_tensor_free(x_tensor);
+	ccv_nnc_tensor_free(f_tensor);
+	ccv_nnc_tensor_free(y_tensor);
+	ccv_cnnp_model_free(final);
+}
+
+TEST_CASE("copy a model that reuses a sub-model with many layers")
+{
+	ccv_cnnp_model_t* layers[16];
+	int i;
+	for (i = 0; i < 16; i++)
+		layers[i] = ccv_cnnp_dense(2, 0, 0);
+	// Copying the sub-model puts all its layers into the copy's model map and resizes it.
+	ccv_cnnp_model_t* const deep = ccv_cnnp_sequential_new(layers, 16, "deep");
+	ccv_cnnp_model_io_t input = ccv_cnnp_input();
+	ccv_cnnp_model_io_t output = ccv_cnnp_model_apply(deep, MODEL_IO_LIST(input));
+	output = ccv_cnnp_model_apply(deep, MODEL_IO_LIST(output));
+	ccv_cnnp_model_t* const final = ccv_cnnp_model_new(MODEL_IO_LIST(input), MODEL_IO_LIST(output), 0);
+	const ccv_nnc_tensor_param_t x = CPU_TENSOR_NHWC(32F, 1, 2);
+	ccv_cnnp_model_compile(final, TENSOR_PARAM_LIST(x), CMD_NOOP(), CMD_NOOP());
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, x, 0);
+	ccv_nnc_tensor_t* const y_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 2), 0);
+	ccv_nnc_tensor_t* const z_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 2), 0);
+	x_tensor->data.f32[0] = 1;
+	x_tensor->data.f32[1] = -1;
+	ccv_cnnp_model_evaluate(final, (ccv_cnnp_evaluate_param_t){}, TENSOR_LIST(x_tensor), TENSOR_LIST(y_tensor), 0, 0);
+	ccv_cnnp_model_t* const copy = ccv_cnnp_model_copy(final);
+	ccv_cnnp_model_compile(copy, TENSOR_PARAM_LIST(x), CMD_NOOP(), CMD_NOOP());
+	ccv_cnnp_model_set_parameters(copy, ccv_cnnp_model_parameters(copy, ALL_PARAMETERS, ALL_PARAMETERS), final, ccv_cnnp_model_parameters(final, ALL_PARAMETERS, ALL_PARAMETERS));
+	ccv_cnnp_model_evaluate(copy, (ccv_cnnp_evaluate_param_t){}, TENSOR_LIST(x_tensor), TENSOR_LIST(z_tensor), 0, 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, z_tensor->data.f32, y_tensor->data.f32, 2, 1e-5, "the copy should share the weights the same way");
+	ccv_nnc_tensor_free(x_tensor);
+	ccv_nnc_tensor_free(y_tensor);
+	ccv_nnc_tensor_free(z_tensor);
+	ccv_cnnp_model_free(final);
+	ccv_cnnp_model_free(copy);
+}
+
 TEST_CASE("a compiled model absorbs a new model with slightly different configuration")
 {
 	ccv_cnnp_model_t* const multi_layer = ccv_cnnp_sequential_new(MODEL_LIST(
@@ -1157,6 +1251,58 @@ TEST_CASE("index select can generate vector embedding")
 	ccv_cnnp_model_free(index_select);
 }
 
+static void _ccv_cnnp_tensor_enum(const int column_idx, const int* const row_idxs, const int row_size, void** const data, void* const context, ccv_nnc_stream_context_t* const stream_context)
+{
+	ccv_nnc_tensor_t** const tensors = (ccv_nnc_tensor_t**)context;
+	int i;
+	for (i = 0; i < row_size; i++)
+		data[i] = tensors[row_idxs[i]];
+}
+
+TEST_CASE("quantize convolution and dense layers of a model with calibration")
+{
+	ccv_cnnp_model_t* const model = ccv_cnnp_sequential_new(MODEL_LIST(
+		ccv_cnnp_convolution(1, 8, DIM_ALLOC(3, 3), 0, HINT((1, 1), (1, 1)), "conv"),
+		ccv_cnnp_relu("relu"),
+		ccv_cnnp_flatten("flatten"),
+		ccv_cnnp_dense(4, 0, "dense")
+	), "quantized");
+	const ccv_nnc_tensor_param_t x_params = CPU_TENSOR_NHWC(32F, 1, 8, 8, 3);
+	ccv_cnnp_model_compile(model, TENSOR_PARAM_LIST(x_params), CMD_NOOP(), CMD_NOOP());
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	ccv_nnc_tensor_t* xs[3];
+	int i, j;
+	for (i = 0; i < 3; i++)
+	{
+		xs[i] = ccv_nnc_tensor_new(0, x_params, 0);
+		for (j = 0; j < 8 * 8 * 3; j++)
+			xs[i]->data.f32[j] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	}
+	ccv_nnc_tensor_t* const y = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 4), 0);
+	ccv_cnnp_model_evaluate(model, (ccv_cnnp_evaluate_param_t){
+		.is_test = 1
+	}, TENSOR_LIST(xs[0]), TENSOR_LIST(y), 0, 0);
+	ccv_cnnp_column_data_t column_data = {
+		.data_enum = _ccv_cnnp_tensor_enum,
+		.context = xs,
+	};
+	ccv_cnnp_dataframe_t* const dataframe = ccv_cnnp_dataframe_new(&column_data, 1, 3);
+	const int column_idx = 0;
+	ccv_cnnp_model_quantize(model, dataframe, &column_idx, 1, 0);
+	ccv_cnnp_dataframe_free(dataframe);
+	ccv_nnc_tensor_t* const yq = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 4), 0);
+	ccv_cnnp_model_evaluate(model, (ccv_cnnp_evaluate_param_t){
+		.is_test = 1
+	}, TENSOR_LIST(xs[0]), TENSOR_LIST(yq), 0, 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, yq->data.f32, y->data.f32, 4, 5e-2, "quantized model should match single precision result");
+	for (i = 0; i < 3; i++)
+		ccv_nnc_tensor_free(xs[i]);
+	ccv_nnc_tensor_free(y);
+	ccv_nnc_tensor_free(yq);
+	ccv_cnnp_model_free(model);
+}
+
 static ccv_cnnp_model_t* _resnet_block_new(const int filters, const int expansion, const int strides, const int projection_shortcut)
 {
 	ccv_cnnp_model_io_t input = ccv_cnnp_input();
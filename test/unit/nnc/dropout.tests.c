@@ -126,4 +126,89 @@ TEST_CASE("dropout gradient entire matrix with 20% chance")
 	ccv_nnc_tensor_free(d);
 }
 
+TEST_CASE("dropout with optimized implementation doesn't depend on thread count")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_DROPOUT_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_DROPOUT_BACKWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 200, 501), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 200, 501), 0);
+	ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 200, 501), 0);
+	int i;
+	for (i = 0; i < 200 * 501; i++)
+		a->data.f32[i] = (i + 1) * 0.01;
+	ccv_nnc_tensor_param_t output_info[2];
+	ccv_nnc_hint_tensor_auto(CMD_DROPOUT_FORWARD(0.4), &a->info, 1, ccv_nnc_no_hint, output_info, 2);
+	ccv_nnc_tensor_t* const c = ccv_nnc_tensor_new(0, output_info[1], 0);
+	ccv_nnc_tensor_t* const ct = ccv_nnc_tensor_new(0, output_info[1], 0);
+	ccv_nnc_thread_pool_param_t params = ccv_nnc_default_thread_pool_params;
+	params.thread_count = 1;
+	ccv_nnc_thread_pool_configure(params);
+	ccv_nnc_cmd_t cmd = CMD_DROPOUT_FORWARD(0.4);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(bt, ct), 0);
+	params.thread_count = 4;
+	ccv_nnc_thread_pool_configure(params);
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b, c), 0);
+	ccv_nnc_thread_pool_configure(ccv_nnc_default_thread_pool_params);
+	REQUIRE_ARRAY_EQ(float, b->data.f32, bt->data.f32, 200 * 501, "dropout should be the same with 1 or 4 threads");
+	REQUIRE_ARRAY_EQ(uint8_t, c->data.u8, ct->data.u8, 200 * 501, "dropout mask should be the same with 1 or 4 threads");
+	int zero_count = 0;
+	for (i = 0; i < 200 * 501; i++)
+		if (b->data.f32[i] == 0)
+			++zero_count;
+		else {
+			REQUIRE_EQ_WITH_TOLERANCE(a->data.f32[i] / 0.6, b->data.f32[i], 1e-3, "should be scaled up by 1 / 0.6");
+		}
+	REQUIRE_EQ_WITH_TOLERANCE((float)zero_count / (200 * 501), 0.4, 1e-2, "should be within 1%% of error");
+	// The gradient with the mask should match the reference implementation.
+	cmd = CMD_DROPOUT_BACKWARD(0.4);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, 0, 0, 0, c), TENSOR_LIST(bt), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, 0, 0, 0, c), TENSOR_LIST(b), 0);
+	REQUIRE_ARRAY_EQ(float, b->data.f32, bt->data.f32, 200 * 501, "dropout gradient should match the reference implementation");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(bt);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(ct);
+}
+
+TEST_CASE("dropout with optimized implementation is reproducible for a given seed and offset")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_DROPOUT_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 20, 50), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 20, 50), 0);
+	int i;
+	for (i = 0; i < 20 * 50; i++)
+		a->data.f32[i] = (i + 1) * 0.01;
+	ccv_nnc_tensor_param_t output_info[2];
+	ccv_nnc_hint_tensor_auto(CMD_DROPOUT_FORWARD(0.4), &a->info, 1, ccv_nnc_no_hint, output_info, 2);
+	ccv_nnc_tensor_t* const c = ccv_nnc_tensor_new(0, output_info[1], 0);
+	ccv_nnc_tensor_t* const ct = ccv_nnc_tensor_new(0, output_info[1], 0);
+	ccv_nnc_cmd_t cmd = CMD_DROPOUT_FORWARD(0.4);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	cmd.info.rand.seed = 0x1234;
+	cmd.info.rand.offset = 0;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b, ct), 0);
+	// Dropout in place, the first input word changes but the mask doesn't.
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(b), TENSOR_LIST(b, c), 0);
+	REQUIRE_ARRAY_EQ(uint8_t, c->data.u8, ct->data.u8, 20 * 50, "dropout mask should be the same for the same seed and offset");
+	// Advance the offset as a training loop would for the next step.
+	cmd.info.rand.offset = 20 * 50;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b, c), 0);
+	int diff = 0, zero_count = 0;
+	for (i = 0; i < 20 * 50; i++)
+	{
+		diff += (c->data.u8[i] != ct->data.u8[i]);
+		zero_count += (b->data.f32[i] == 0);
+	}
+	REQUIRE(diff > 0, "dropout mask should be different for a different offset");
+	REQUIRE_EQ_WITH_TOLERANCE((float)zero_count / (20 * 50), 0.4, 5e-2, "should still drop about 40%%");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(ct);
+}
+
 #include "case_main.h"
@@ -331,6 +331,202 @@ TEST_CASE("convolution with no bias")
 	ccv_nnc_tensor_free(bias);
 }
 
+TEST_CASE("depthwise convolution of 3x3 on 28x28 with CPU_OPT")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_CONVOLUTION_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 28, 28, 30), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 28, 28, 30), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(30, 30, 3, 3, 1);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 30, 3, 3, 1), 0);
+	ccv_nnc_tensor_t* const bias = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 30), 0);
+	dsfmt_t dsfmt;
+	int i;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 28 * 28 * 30; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	for (i = 0; i < 30 * 3 * 3; i++)
+		w->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	for (i = 0; i < 30; i++)
+		bias->data.f32[i] = i;
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(b), 0);
+	ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 28, 28, 30), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(bt), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, bt->data.f32, b->data.f32, 28 * 28 * 30, 1e-4, "depthwise convolution should match the reference");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(bt);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(bias);
+}
+
+TEST_CASE("grouped convolution of 3x3 with stride 2 on 27x27 with CPU_OPT")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_CONVOLUTION_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 27, 27, 16), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 14, 14, 24), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(4, 24, 3, 3, 4);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 24, 3, 3, 4), 0);
+	dsfmt_t dsfmt;
+	int i;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 27 * 27 * 16; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	for (i = 0; i < 24 * 3 * 3 * 4; i++)
+		w->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(b), 0);
+	ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 14, 14, 24), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(bt), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, bt->data.f32, b->data.f32, 14 * 14 * 24, 1e-4, "grouped convolution should match the reference");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(bt);
+	ccv_nnc_tensor_free(w);
+}
+
+TEST_CASE("half precision convolution")
+{
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 27, 27, 3), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 27, 27, 4), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(1, 4, 3, 5, 3);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 3, 5, 3), 0);
+	ccv_nnc_tensor_t* const bias = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	int i;
+	// These values can be represented exactly in half precision.
+	for (i = 0; i < 27 * 27 * 3; i++)
+		a->data.f32[i] = (i % 17) * 0.125 - 1;
+	for (i = 0; i < 4 * 3 * 5 * 3; i++)
+		w->data.f32[i] = (i % 7) * 0.25 - 0.75;
+	for (i = 0; i < 4; i++)
+		bias->data.f32[i] = i;
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(b), 0);
+	ccv_nnc_tensor_t* const a16 = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(16F, 27, 27, 3), 0);
+	ccv_nnc_tensor_t* const w16 = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(16F, 4, 3, 5, 3), 0);
+	ccv_nnc_tensor_t* const bias16 = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(16F, 4), 0);
+	ccv_nnc_tensor_t* const b16 = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(16F, 27, 27, 4), 0);
+	ccv_nnc_cmd_exec(CMD_DATATYPE_CONVERSION_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(a16, w16, bias16), 0);
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a16, w16, bias16), TENSOR_LIST(b16), 0);
+	ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 27, 27, 4), 0);
+	ccv_nnc_cmd_exec(CMD_DATATYPE_CONVERSION_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(b16), TENSOR_LIST(bt), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, bt->data.f32, b->data.f32, 27 * 27 * 4, 2e-2, "half precision convolution should match single precision result");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(a16);
+	ccv_nnc_tensor_free(w16);
+	ccv_nnc_tensor_free(bias16);
+	ccv_nnc_tensor_free(b16);
+	ccv_nnc_tensor_free(bt);
+}
+
+TEST_CASE("quantize and dequantize a tensor")
+{
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 50), 0);
+	int i;
+	for (i = 0; i < 4 * 50; i++)
+		a->data.f32[i] = ((i % 23) - 11) * (i / 50 + 1) * 0.1;
+	ccv_nnc_tensor_t* const q = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(8S, 4, 50), 0);
+	ccv_nnc_tensor_t* const scale = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 50), 0);
+	// One scale per row.
+	ccv_nnc_cmd_exec(CMD_QUANTIZE_FORWARD(0), ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(q, scale), 0);
+	for (i = 0; i < 4; i++)
+		REQUIRE_EQ_WITH_TOLERANCE(scale->data.f32[i], 1.1 * (i + 1) / 127, 1e-6, "the scale should map the maximum to 127");
+	ccv_nnc_cmd_exec(CMD_DEQUANTIZE_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(q, scale), TENSOR_LIST(b), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, a->data.f32, 4 * 50, 4 * 1.1 / 127 / 2 + 1e-6, "dequantized tensor should be within half a step");
+	// One scale for the whole tensor, with a static scale.
+	ccv_nnc_tensor_t* const scale1 = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1), 0);
+	ccv_nnc_cmd_exec(CMD_QUANTIZE_FORWARD(0.01), ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(q, scale1), 0);
+	REQUIRE_EQ_WITH_TOLERANCE(scale1->data.f32[0], 0.01, 1e-6, "the static scale should be used");
+	REQUIRE_EQ(q->data.i8[0], -110, "-1.1 should be quantized to -110");
+	REQUIRE_EQ(q->data.i8[153], 127, "values out of range should be clamped");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(q);
+	ccv_nnc_tensor_free(scale);
+	ccv_nnc_tensor_free(scale1);
+	ccv_nnc_tensor_free(b);
+}
+
+TEST_CASE("int8 convolution")
+{
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 27, 27, 3), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 27, 27, 4), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(1, 4, 3, 5, 3);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 3, 5, 3), 0);
+	ccv_nnc_tensor_t* const bias = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	dsfmt_t dsfmt;
+	int i;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 27 * 27 * 3; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 4 * 3 * 5 * 3; i++)
+		w->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+	for (i = 0; i < 4; i++)
+		bias->data.f32[i] = i;
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(b), 0);
+	ccv_nnc_tensor_t* const qa = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(8S, 27, 27, 3), 0);
+	ccv_nnc_tensor_t* const a_scale = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1), 0);
+	ccv_nnc_tensor_t* const qw = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(8S, 4, 3, 5, 3), 0);
+	ccv_nnc_tensor_t* const w_scale = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	ccv_nnc_cmd_exec(CMD_QUANTIZE_FORWARD(0), ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(qa, a_scale), 0);
+	ccv_nnc_cmd_exec(CMD_QUANTIZE_FORWARD(0), ccv_nnc_no_hint, 0, TENSOR_LIST(w), TENSOR_LIST(qw, w_scale), 0);
+	ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 27, 27, 4), 0);
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(qa, qw, bias, a_scale, w_scale), TENSOR_LIST(bt), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, bt->data.f32, b->data.f32, 27 * 27 * 4, 5e-2, "int8 convolution should match single precision result");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(qa);
+	ccv_nnc_tensor_free(a_scale);
+	ccv_nnc_tensor_free(qw);
+	ccv_nnc_tensor_free(w_scale);
+	ccv_nnc_tensor_free(bt);
+}
+
+TEST_CASE("elementwise exp, log, sqrt and div with CPU_OPT")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_EWEXP_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_EWLOG_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_EWSQRT_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_EWDIV_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10, 4001), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10, 4001), 0);
+	ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10, 4001), 0);
+	int i;
+	for (i = 0; i < 10 * 4001; i++)
+		a->data.f32[i] = (i % 97) * 0.05 + 0.01;
+	const uint32_t cmds[] = {
+		CCV_NNC_EWEXP_FORWARD, CCV_NNC_EWLOG_FORWARD, CCV_NNC_EWSQRT_FORWARD
+	};
+	for (i = 0; i < sizeof(cmds) / sizeof(cmds[0]); i++)
+	{
+		ccv_nnc_cmd_t cmd = ccv_nnc_cmd(cmds[i], 0, ccv_nnc_cmd_auto, 0);
+		cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(bt), 0);
+		cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), 0);
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, bt->data.f32, 10 * 4001, 1e-4, "%s result should be equal", ccv_nnc_cmd_name(cmds[i]));
+	}
+	ccv_nnc_cmd_t cmd = CMD_EWDIV_FORWARD();
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(0, a), TENSOR_LIST(bt), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(0, a), TENSOR_LIST(b), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, bt->data.f32, 10 * 4001, 1e-4, "reciprocal should be equal");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(bt);
+}
+
 TEST_CASE("maximum pool network of 55x55 with window of 3x3 and stride of 2")
 {
 	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 55, 55, 1), 0);
@@ -839,4 +839,75 @@ TEST_CASE("backward gemm with transpose a and b batch 2, same b")
 	ccv_nnc_tensor_free(dbias);
 }
 
+TEST_CASE("half precision gemm with transpose b")
+{
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 70), 0);
+	ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 33, 70), 0);
+	ccv_nnc_tensor_t* const bias = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 33), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 33), 0);
+	int i;
+	// These values can be represented exactly in half precision.
+	for (i = 0; i < 2 * 70; i++)
+		a->data.f32[i] = (i % 11) * 0.25 - 1;
+	for (i = 0; i < 33 * 70; i++)
+		w->data.f32[i] = (i % 13) * 0.125 - 0.75;
+	for (i = 0; i < 33; i++)
+		bias->data.f32[i] = i * 0.5;
+	ccv_nnc_cmd_exec(CMD_GEMM_FORWARD(NO_TRANSPOSE, TRANSPOSE(0, 1)), ccv_nnc_no_hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(b), 0);
+	ccv_nnc_tensor_t* const a16 = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(16F, 2, 70), 0);
+	ccv_nnc_tensor_t* const w16 = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(16F, 33, 70), 0);
+	ccv_nnc_tensor_t* const bias16 = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(16F, 33), 0);
+	ccv_nnc_cmd_exec(CMD_DATATYPE_CONVERSION_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(a16, w16, bias16), 0);
+	ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 33), 0);
+	ccv_nnc_cmd_exec(CMD_GEMM_FORWARD(NO_TRANSPOSE, TRANSPOSE(0, 1)), ccv_nnc_no_hint, 0, TENSOR_LIST(a, w16, bias), TENSOR_LIST(bt), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, bt->data.f32, b->data.f32, 2 * 33, 1e-3, "half precision weights should match single precision result");
+	ccv_nnc_tensor_t* const b16 = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(16F, 2, 33), 0);
+	ccv_nnc_cmd_exec(CMD_GEMM_FORWARD(NO_TRANSPOSE, TRANSPOSE(0, 1)), ccv_nnc_no_hint, 0, TENSOR_LIST(a16, w16, bias16), TENSOR_LIST(b16), 0);
+	ccv_nnc_cmd_exec(CMD_DATATYPE_CONVERSION_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(b16), TENSOR_LIST(bt), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, bt->data.f32, b->data.f32, 2 * 33, 5e-2, "half precision gemm should match single precision result");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(a16);
+	ccv_nnc_tensor_free(w16);
+	ccv_nnc_tensor_free(bias16);
+	ccv_nnc_tensor_free(b16);
+	ccv_nnc_tensor_free(bt);
+}
+
+TEST_CASE("int8 gemm with transpose b")
+{
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 70), 0);
+	ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 33, 70), 0);
+	ccv_nnc_tensor_t* const bias = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 33), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 33), 0);
+	int i;
+	for (i = 0; i < 2 * 70; i++)
+		a->data.f32[i] = (i % 11) * 0.2 - 1;
+	for (i = 0; i < 33 * 70; i++)
+		w->data.f32[i] = (i % 13) * 0.1 - 0.6;
+	for (i = 0; i < 33; i++)
+		bias->data.f32[i] = i * 0.5;
+	ccv_nnc_cmd_exec(CMD_GEMM_FORWARD(NO_TRANSPOSE, TRANSPOSE(0, 1)), ccv_nnc_no_hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(b), 0);
+	ccv_nnc_tensor_t* const qa = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(8S, 2, 70), 0);
+	ccv_nnc_tensor_t* const a_scale = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1), 0);
+	ccv_nnc_tensor_t* const qw = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(8S, 33, 70), 0);
+	ccv_nnc_tensor_t* const w_scale = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 33), 0);
+	ccv_nnc_cmd_exec(CMD_QUANTIZE_FORWARD(0), ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(qa, a_scale), 0);
+	ccv_nnc_cmd_exec(CMD_QUANTIZE_FORWARD(0), ccv_nnc_no_hint, 0, TENSOR_LIST(w), TENSOR_LIST(qw, w_scale), 0);
+	ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 33), 0);
+	ccv_nnc_cmd_exec(CMD_GEMM_FORWARD(NO_TRANSPOSE, TRANSPOSE(0, 1)), ccv_nnc_no_hint, 0, TENSOR_LIST(qa, qw, bias, a_scale, w_scale), TENSOR_LIST(bt), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, bt->data.f32, b->data.f32, 2 * 33, 1e-1, "int8 gemm should match single precision result");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(qa);
+	ccv_nnc_tensor_free(a_scale);
+	ccv_nnc_tensor_free(qw);
+	ccv_nnc_tensor_free(w_scale);
+	ccv_nnc_tensor_free(bt);
+}
+
 #include "case_main.h"
@@ -53,4 +53,45 @@ TEST_CASE("write graph (x + y) * (x + y) and read")
 	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
 }
 
+TEST_CASE("write graph x * c with a constant c and read")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 2), "x");
+	ccv_nnc_tensor_t* const c_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2), 0);
+	c_tensor->data.f32[0] = 3;
+	c_tensor->data.f32[1] = 5;
+	const ccv_nnc_tensor_symbol_t c = ccv_nnc_tensor_symbol_constant_new(symbolic_graph, c_tensor, "c");
+	ccv_nnc_tensor_free(c_tensor);
+	ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 2), "y");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWPROD_FORWARD(), TENSOR_SYMBOL_LIST(x, c), TENSOR_SYMBOL_LIST(y), "prod");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	static char fn[] = "gen/write_graph_x___c_with_a_constant_c_and_read.graph";
+	remove(fn);
+	ccv_nnc_symbolic_graph_write(symbolic_graph, TENSOR_BIND_MAP(KV(x, 0), KV(y, 0)), fn);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_symbolic_graph_t* symbolic_graph_2 = 0;
+	ccv_nnc_tensor_bind_t* tensor_binds = 0;
+	int tensor_bind_size = 0;
+	ccv_nnc_symbolic_graph_read(fn, &symbolic_graph_2, &tensor_binds, &tensor_bind_size);
+	x = tensor_binds[0].symbol;
+	y = tensor_binds[1].symbol;
+	ccfree(tensor_binds);
+	ccv_nnc_graph_t* graph = 0;
+	ccv_nnc_tensor_arena_t* tensor_arena = 0;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena = 0;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph_2, ccv_nnc_default_compile_params, 0, 0, 0, 0, SYMBOLIC_GRAPH_SOURCES(symbolic_graph_2), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph_2), &graph, &tensor_arena, &graph_exec_arena);
+	// The compiled graph holds its own copy of the constant.
+	ccv_nnc_symbolic_graph_free(symbolic_graph_2);
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, x);
+	x_tensor->data.f32[0] = 2;
+	x_tensor->data.f32[1] = 7;
+	ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+	ccv_nnc_tensor_t* const y_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, y);
+	REQUIRE_EQ_WITH_TOLERANCE(y_tensor->data.f32[0], 2 * 3, 1e-5, "result should be equal");
+	REQUIRE_EQ_WITH_TOLERANCE(y_tensor->data.f32[1], 7 * 5, 1e-5, "result should be equal");
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+}
+
 #include "case_main.h"
@@ -165,4 +165,60 @@ TEST_CASE("compare layer norm gradient with other symbolic graph")
 	ccv_nnc_graph_free(layer_norm_graph);
 }
 
+TEST_CASE("layer norm forward and backward with CPU_OPT should match CPU_REF")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_LAYER_NORM_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_LAYER_NORM_BACKWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const x = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 4, 4, 10), 0);
+	ccv_nnc_tensor_t* const g = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 4, 4, 10), 0);
+	ccv_nnc_tensor_t* const scale = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 4, 4, 10), 0);
+	ccv_nnc_tensor_t* const bias = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 4, 4, 10), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	int i;
+	for (i = 0; i < 8 * 4 * 4 * 10; i++)
+		x->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 4 + i / 160, g->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 4 * 4 * 10; i++)
+		scale->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) + 0.5, bias->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+	ccv_nnc_tensor_t* y[2];
+	ccv_nnc_tensor_t* saved_mean[2];
+	ccv_nnc_tensor_t* saved_inv_std[2];
+	ccv_nnc_tensor_t* h[2];
+	ccv_nnc_tensor_t* dscale[2];
+	ccv_nnc_tensor_t* dbias[2];
+	for (i = 0; i < 2; i++)
+	{
+		y[i] = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 4, 4, 10), 0);
+		saved_mean[i] = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 1, 1, 1), 0);
+		saved_inv_std[i] = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 1, 1, 1), 0);
+		h[i] = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 4, 4, 10), 0);
+		dscale[i] = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 4, 4, 10), 0);
+		dbias[i] = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 4, 4, 10), 0);
+		ccv_nnc_cmd_t forw_cmd = CMD_LAYER_NORM_FORWARD(1e-4, 1, 2, 3);
+		ccv_nnc_cmd_t back_cmd = CMD_LAYER_NORM_BACKWARD(1e-4, 1, 2, 3);
+		forw_cmd.backend = back_cmd.backend = i == 0 ? CCV_NNC_BACKEND_CPU_REF : CCV_NNC_BACKEND_CPU_OPT;
+		ccv_nnc_cmd_exec(forw_cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(x, scale, bias), TENSOR_LIST(y[i], saved_mean[i], saved_inv_std[i]), 0);
+		ccv_nnc_cmd_exec(back_cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(g, 0, 0, x, scale, 0, 0, saved_mean[i], saved_inv_std[i]), TENSOR_LIST(h[i], dscale[i], dbias[i]), 0);
+	}
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, y[1]->data.f32, y[0]->data.f32, 8 * 4 * 4 * 10, 1e-4, "normalized output should match");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, saved_mean[1]->data.f32, saved_mean[0]->data.f32, 8, 1e-4, "saved mean should match");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, saved_inv_std[1]->data.f32, saved_inv_std[0]->data.f32, 8, 1e-4, "saved inverse std should match");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, h[1]->data.f32, h[0]->data.f32, 8 * 4 * 4 * 10, 1e-4, "propagated error should match");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, dscale[1]->data.f32, dscale[0]->data.f32, 4 * 4 * 10, 1e-3, "scale gradient should match");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, dbias[1]->data.f32, dbias[0]->data.f32, 4 * 4 * 10, 1e-3, "bias gradient should match");
+	ccv_nnc_tensor_free(x);
+	ccv_nnc_tensor_free(g);
+	ccv_nnc_tensor_free(scale);
+	ccv_nnc_tensor_free(bias);
+	for (i = 0; i < 2; i++)
+	{
+		ccv_nnc_tensor_free(y[i]);
+		ccv_nnc_tensor_free(saved_mean[i]);
+		ccv_nnc_tensor_free(saved_inv_std[i]);
+		ccv_nnc_tensor_free(h[i]);
+		ccv_nnc_tensor_free(dscale[i]);
+		ccv_nnc_tensor_free(dbias[i]);
+	}
+}
+
 #include "case_main.h"
@@ -311,4 +311,164 @@ TEST_CASE("represent matrix multiplication with micro ops")
 	ccv_nnc_micro_combine_free(combine);
 }
 
+TEST_CASE("compile convolution with micro ops into native code")
+{
+	ccv_nnc_micro_io_t x = ccv_nnc_micro_input(4);
+	ccv_nnc_micro_io_t xx = ccv_nnc_micro_reindex((const char*[]){
+		"dA0",
+		"dA1 - $kh + 1",
+		"dA2 - $kw + 1",
+		"$kh",
+		"$kw",
+		"dA3",
+		"$kc"
+	}, 7, &x, 1, (const char*[]){
+		"i0",
+		"i1 + i3",
+		"i2 + i4",
+		"i5"
+	}, 4, x);
+	ccv_nnc_micro_io_t w = ccv_nnc_micro_input(4);
+	ccv_nnc_micro_io_t ww = ccv_nnc_micro_reindex((const char*[]){
+		"dA0",
+		"dA1 - $kh + 1",
+		"dA2 - $kw + 1",
+		"$kh",
+		"$kw",
+		"dA3",
+		"$kc"
+	}, 7, &x, 1, (const char*[]){
+		"i6",
+		"i3",
+		"i4",
+		"i5"
+	}, 4, w);
+	ccv_nnc_micro_io_t yy = ccv_nnc_micro_binary(CCV_NNC_MICRO_BINARY_OP_MUL, xx, ww);
+	ccv_nnc_micro_io_t y = ccv_nnc_micro_reduce(CCV_NNC_MICRO_REDUCE_OP_SUM, (const int[]){
+		3,
+		4,
+		5
+	}, 3, yy);
+	ccv_nnc_micro_io_t dy = ccv_nnc_micro_grad(y);
+	ccv_nnc_micro_io_t dx = ccv_nnc_micro_grad(x);
+	ccv_nnc_micro_io_t dw = ccv_nnc_micro_grad(w);
+	ccv_nnc_micro_combine_t* combine = ccv_nnc_micro_combine_new((ccv_nnc_micro_io_t[]){
+		x,
+		w
+	}, 2, (const char*[]){
+		"$kh",
+		"$kw",
+		"$kc"
+	}, 3, &y, 1, (ccv_nnc_micro_io_t[]){
+		dy,
+		x,
+		w
+	}, 3, (ccv_nnc_micro_io_t[]){
+		dx,
+		dw
+	}, 2);
+	REQUIRE_EQ(ccv_nnc_micro_combine_compile(combine), 0, "should compile with the system C compiler");
+	const ccv_nnc_micro_scalar_t values[] = {
+		{
+			.type = CCV_32S,
+			.i32 = 3,
+		},
+		{
+			.type = CCV_32S,
+			.i32 = 3,
+		},
+		{
+			.type = CCV_32S,
+			.i32 = 2,
+		}
+	};
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 9, 9, 5), 0);
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 3, 3, 5), 0);
+	ccv_nnc_tensor_t* const y_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 7, 7, 2), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	int i;
+	for (i = 0; i < 9 * 9 * 5; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	for (i = 0; i < 2 * 3 * 3 * 5; i++)
+		w_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	ccv_nnc_micro_combine_exec(combine, CCV_NNC_CUSTOM_FORWARD, TENSOR_LIST(x_tensor, w_tensor), values, 3, TENSOR_LIST(y_tensor));
+	ccv_nnc_tensor_t* const gty_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 7, 7, 2), 0);
+	ccv_nnc_cmd_exec(CMD_CONVOLUTION_FORWARD(1, 2, 3, 3, 5), HINT((1, 1)), 0, TENSOR_LIST(x_tensor, w_tensor), TENSOR_LIST(gty_tensor), 0);
+	REQUIRE_TENSOR_EQ(y_tensor, gty_tensor, "compiled micro op convolution should match the existing convolution");
+	ccv_nnc_tensor_t* const dx_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 9, 9, 5), 0);
+	ccv_nnc_tensor_t* const dw_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 3, 3, 5), 0);
+	ccv_nnc_tensor_t* const dy_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 7, 7, 2), 0);
+	for (i = 0; i < 7 * 7 * 2; i++)
+		dy_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	ccv_nnc_tensor_t dy_tensor_t = ccv_nnc_tensor(dy_tensor->data.f32, CPU_TENSOR_NHWC(32F, 1, 7, 7, 1, 1, 1, 2), 0);
+	ccv_nnc_micro_combine_exec(combine, CCV_NNC_CUSTOM_BACKWARD, TENSOR_LIST(&dy_tensor_t, x_tensor, w_tensor), values, 3, TENSOR_LIST(dx_tensor, dw_tensor));
+	ccv_nnc_tensor_t* const idx_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 9, 9, 5), 0);
+	ccv_nnc_tensor_t* const idw_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 3, 3, 5), 0);
+	ccv_nnc_micro_combine_interpret(combine, CCV_NNC_CUSTOM_BACKWARD, TENSOR_LIST(&dy_tensor_t, x_tensor, w_tensor), values, 3, TENSOR_LIST(idx_tensor, idw_tensor));
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, dx_tensor->data.f32, idx_tensor->data.f32, 9 * 9 * 5, 1e-5, "compiled micro op convolution should match the interpreted one");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, dw_tensor->data.f32, idw_tensor->data.f32, 2 * 3 * 3 * 5, 1e-5, "compiled micro op convolution should match the interpreted one");
+	ccv_nnc_tensor_free(idx_tensor);
+	ccv_nnc_tensor_free(idw_tensor);
+	ccv_nnc_tensor_free(dx_tensor);
+	ccv_nnc_tensor_free(dw_tensor);
+	ccv_nnc_tensor_free(dy_tensor);
+	ccv_nnc_tensor_free(x_tensor);
+	ccv_nnc_tensor_free(w_tensor);
+	ccv_nnc_tensor_free(y_tensor);
+	ccv_nnc_tensor_free(gty_tensor);
+	ccv_nnc_micro_combine_free(combine);
+}
+
+TEST_CASE("schedule transpose with micro ops into tiles, parallel tasks and SIMD loops")
+{
+	ccv_nnc_micro_io_t x = ccv_nnc_micro_input(2);
+	ccv_nnc_micro_io_t y = ccv_nnc_micro_reindex((const char*[]){
+		"dA1",
+		"dA0"
+	}, 2, &x, 1, (const char*[]){
+		"i1",
+		"i0"
+	}, 2, x);
+	ccv_nnc_micro_io_t dy = ccv_nnc_micro_grad(y);
+	ccv_nnc_micro_io_t dx = ccv_nnc_micro_grad(x);
+	ccv_nnc_micro_combine_t* combine = ccv_nnc_micro_combine_new(&x, 1, 0, 0, &y, 1, (ccv_nnc_micro_io_t[]){
+		dy,
+		x
+	}, 2, &dx, 1);
+	char* const code = ccv_nnc_micro_combine_c(combine);
+	REQUIRE(strstr(code, "parallel_for(task_count") != 0, "the outer loop should be split into parallel tasks");
+	REQUIRE(strstr(code, "#pragma omp simd") != 0, "unit-stride innermost loops should be vectorized");
+	REQUIRE(strstr(code, "t0 += ") != 0, "strided transpose should be tiled");
+	ccfree(code);
+	REQUIRE_EQ(ccv_nnc_micro_combine_compile(combine), 0, "should compile with the system C compiler");
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 123, 257), 0);
+	ccv_nnc_tensor_t* const y_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 257, 123), 0);
+	ccv_nnc_tensor_t* const iy_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 257, 123), 0);
+	ccv_nnc_tensor_t* const gty_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 257, 123), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	int i;
+	for (i = 0; i < 123 * 257; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	ccv_nnc_micro_combine_exec(combine, CCV_NNC_CUSTOM_FORWARD, TENSOR_LIST(x_tensor), 0, 0, TENSOR_LIST(y_tensor));
+	ccv_nnc_micro_combine_interpret(combine, CCV_NNC_CUSTOM_FORWARD, TENSOR_LIST(x_tensor), 0, 0, TENSOR_LIST(iy_tensor));
+	ccv_nnc_cmd_exec(CMD_TRANSPOSE_FORWARD(0, 1), ccv_nnc_no_hint, 0, TENSOR_LIST(x_tensor), TENSOR_LIST(gty_tensor), 0);
+	REQUIRE_TENSOR_EQ(y_tensor, gty_tensor, "compiled micro op transpose should match the existing transpose");
+	REQUIRE_TENSOR_EQ(iy_tensor, gty_tensor, "interpreted micro op transpose should match the existing transpose");
+	ccv_nnc_tensor_t* const dx_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 123, 257), 0);
+	ccv_nnc_tensor_t* const idx_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 123, 257), 0);
+	ccv_nnc_micro_combine_exec(combine, CCV_NNC_CUSTOM_BACKWARD, TENSOR_LIST(gty_tensor, x_tensor), 0, 0, TENSOR_LIST(dx_tensor));
+	ccv_nnc_micro_combine_interpret(combine, CCV_NNC_CUSTOM_BACKWARD, TENSOR_LIST(gty_tensor, x_tensor), 0, 0, TENSOR_LIST(idx_tensor));
+	REQUIRE_TENSOR_EQ(dx_tensor, x_tensor, "compiled micro op transpose gradient should transpose back");
+	REQUIRE_TENSOR_EQ(idx_tensor, x_tensor, "interpreted micro op transpose gradient should transpose back");
+	ccv_nnc_tensor_free(x_tensor);
+	ccv_nnc_tensor_free(y_tensor);
+	ccv_nnc_tensor_free(iy_tensor);
+	ccv_nnc_tensor_free(gty_tensor);
+	ccv_nnc_tensor_free(dx_tensor);
+	ccv_nnc_tensor_free(idx_tensor);
+	ccv_nnc_micro_combine_free(combine);
+}
+
 #include "case_main.h"
@@ -277,4 +277,110 @@ TEST_CASE("solve least square sum with rmsprop on symbolic graph")
 	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
 }
 
+TEST_CASE("update multiple parameters with one optimizer command, with and without gradient clipping")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_SGD_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_ADAM_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_LAMB_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_RMSPROP_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	// Each optimizer runs once per parameter on the reference, then once over all parameters, with max_norm set when clipping.
+	struct {
+		ccv_nnc_cmd_t cmd;
+		ccv_nnc_cmd_t clip_cmd;
+		float max_norm;
+		float scale;
+		int aux_size;
+	} optimizers[9];
+	optimizers[0].cmd = optimizers[0].clip_cmd = CMD_SGD_FORWARD(0, 0.01, 0.5, 0.001, 0.9, 0.9);
+	optimizers[0].max_norm = 0, optimizers[0].scale = 0.5, optimizers[0].aux_size = 1;
+	optimizers[1] = optimizers[0];
+	optimizers[1].clip_cmd.info.sgd.max_norm = optimizers[1].max_norm = 10;
+	optimizers[2].cmd = optimizers[2].clip_cmd = CMD_SGD_FORWARD(1, 0.01, 1, 0.001, 0.9, 0);
+	optimizers[2].clip_cmd.info.sgd.max_norm = optimizers[2].max_norm = 10;
+	optimizers[2].scale = 1, optimizers[2].aux_size = 1;
+	optimizers[3].cmd = optimizers[3].clip_cmd = CMD_ADAM_FORWARD(3, 0.002, 0.9, 0.98, 0.001, 1e-8);
+	optimizers[3].max_norm = 0, optimizers[3].scale = 1, optimizers[3].aux_size = 2;
+	optimizers[4] = optimizers[3];
+	optimizers[4].clip_cmd.info.adam.max_norm = optimizers[4].max_norm = 10;
+	optimizers[5].cmd = optimizers[5].clip_cmd = CMD_LAMB_FORWARD(3, 0.002, 0.9, 0.98, 0.001, 1e-6);
+	optimizers[5].max_norm = 0, optimizers[5].scale = 1, optimizers[5].aux_size = 2;
+	optimizers[6] = optimizers[5];
+	optimizers[6].clip_cmd.info.lamb.max_norm = optimizers[6].max_norm = 10;
+	optimizers[7].cmd = optimizers[7].clip_cmd = CMD_RMSPROP_FORWARD(0.001, 0.001, 0.9, 0.9, 1e-8);
+	optimizers[7].max_norm = 0, optimizers[7].scale = 1, optimizers[7].aux_size = 2;
+	optimizers[8] = optimizers[7];
+	optimizers[8].clip_cmd.info.rmsprop.max_norm = optimizers[8].max_norm = 10;
+	// Parameters of different sizes, the larger one is split across threads.
+	static const int sizes[] = {7, 40001, 33};
+	const int group_count = sizeof(sizes) / sizeof(sizes[0]);
+	int i, j, k, l;
+	for (l = 0; l < sizeof(optimizers) / sizeof(optimizers[0]); l++)
+	{
+		const int aux_size = optimizers[l].aux_size;
+		const int input_stride = aux_size + 2;
+		const int output_stride = aux_size + 1;
+		ccv_nnc_tensor_t* inputs[group_count * input_stride];
+		ccv_nnc_tensor_t* ref_outputs[group_count * output_stride];
+		ccv_nnc_tensor_t* multi_ref_outputs[group_count * output_stride];
+		ccv_nnc_tensor_t* opt_outputs[group_count * output_stride];
+		dsfmt_t dsfmt;
+		dsfmt_init_gen_rand(&dsfmt, 1);
+		double sum = 0;
+		for (i = 0; i < group_count; i++)
+		{
+			for (j = 0; j < input_stride; j++)
+			{
+				ccv_nnc_tensor_t* const tensor = inputs[i * input_stride + j] = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, sizes[i]), 0);
+				for (k = 0; k < sizes[i]; k++)
+					tensor->data.f32[k] = j == input_stride - 1 && aux_size > 1 ? dsfmt_genrand_open_close(&dsfmt) : dsfmt_genrand_open_close(&dsfmt) * 2 - 1; // The velocity needs to be positive.
+			}
+			for (k = 0; k < sizes[i]; k++)
+				sum += inputs[i * input_stride]->data.f32[k] * inputs[i * input_stride]->data.f32[k];
+			for (j = 0; j < output_stride; j++)
+			{
+				ref_outputs[i * output_stride + j] = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, sizes[i]), 0);
+				multi_ref_outputs[i * output_stride + j] = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, sizes[i]), 0);
+				opt_outputs[i * output_stride + j] = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, sizes[i]), 0);
+			}
+		}
+		// The norm is taken after the gradients are scaled.
+		const float max_norm = optimizers[l].max_norm;
+		const float norm = sqrt(sum) * fabsf(optimizers[l].scale);
+		const float clip = max_norm > 0 && norm > max_norm ? max_norm / (norm + 1e-6) : 1;
+		// The reference updates one parameter at a time, with gradients clipped beforehand.
+		ccv_nnc_cmd_t ref_cmd = optimizers[l].cmd;
+		ref_cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		for (i = 0; i < group_count; i++)
+		{
+			ccv_nnc_tensor_t* clipped_inputs[input_stride];
+			memcpy(clipped_inputs, inputs + i * input_stride, sizeof(clipped_inputs));
+			ccv_nnc_tensor_t* const clipped = clipped_inputs[0] = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, sizes[i]), 0);
+			for (k = 0; k < sizes[i]; k++)
+				clipped->data.f32[k] = clip * inputs[i * input_stride]->data.f32[k];
+			const int status = ccv_nnc_cmd_exec(ref_cmd, ccv_nnc_no_hint, 0, clipped_inputs, input_stride, ref_outputs + i * output_stride, output_stride, 0);
+			ccv_nnc_tensor_free(clipped);
+			REQUIRE_EQ(status, CCV_NNC_EXEC_SUCCESS, "%s on a single parameter should run", ccv_nnc_cmd_name(ref_cmd.cmd));
+		}
+		ccv_nnc_cmd_t multi_ref_cmd = optimizers[l].clip_cmd;
+		multi_ref_cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		REQUIRE_EQ(ccv_nnc_cmd_exec(multi_ref_cmd, ccv_nnc_no_hint, 0, inputs, group_count * input_stride, multi_ref_outputs, group_count * output_stride, 0), CCV_NNC_EXEC_SUCCESS, "%s on multiple parameters should run on the reference", ccv_nnc_cmd_name(ref_cmd.cmd));
+		ccv_nnc_cmd_t opt_cmd = optimizers[l].clip_cmd;
+		opt_cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		REQUIRE_EQ(ccv_nnc_cmd_exec(opt_cmd, ccv_nnc_no_hint, 0, inputs, group_count * input_stride, opt_outputs, group_count * output_stride, 0), CCV_NNC_EXEC_SUCCESS, "%s on multiple parameters should run on CPU_OPT", ccv_nnc_cmd_name(ref_cmd.cmd));
+		for (i = 0; i < group_count * output_stride; i++)
+		{
+			REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, multi_ref_outputs[i]->data.f32, ref_outputs[i]->data.f32, ccv_nnc_tensor_count(ref_outputs[i]->info), 1e-4, "%s with max_norm %g on the reference should match the per parameter update", ccv_nnc_cmd_name(ref_cmd.cmd), max_norm);
+			REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, opt_outputs[i]->data.f32, ref_outputs[i]->data.f32, ccv_nnc_tensor_count(ref_outputs[i]->info), 1e-4, "%s with max_norm %g on CPU_OPT should match the per parameter update", ccv_nnc_cmd_name(ref_cmd.cmd), max_norm);
+		}
+		for (i = 0; i < group_count * input_stride; i++)
+			ccv_nnc_tensor_free(inputs[i]);
+		for (i = 0; i < group_count * output_stride; i++)
+		{
+			ccv_nnc_tensor_free(ref_outputs[i]);
+			ccv_nnc_tensor_free(multi_ref_outputs[i]);
+			ccv_nnc_tensor_free(opt_outputs[i]);
+		}
+	}
+}
+
 #include "case_main.h"
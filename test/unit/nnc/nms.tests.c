@@ -4,6 +4,7 @@
 #include <ccv.h>
 #include <nnc/ccv_nnc.h>
 #include <nnc/ccv_nnc_easy.h>
+#include "3rdparty/dsfmt/dSFMT.h"
 
 TEST_SETUP()
 {
@@ -169,4 +170,74 @@ TEST_CASE("non-maximal suppression backward with some value suppressed")
 	ccv_nnc_tensor_free(dat);
 }
 
+TEST_CASE("non-maximal suppression forward with top k")
+{
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10, 5), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10, 5), 0);
+	ccv_nnc_tensor_t* const c = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32S, 10), 0);
+	int i;
+	for (i = 0; i < 10; i++)
+	{
+		a->data.f32[i * 5] = i;
+		a->data.f32[i * 5 + 1] = i;
+		a->data.f32[i * 5 + 2] = 0;
+		a->data.f32[i * 5 + 3] = 2;
+		a->data.f32[i * 5 + 4] = 1;
+	}
+	ccv_nnc_cmd_t cmd = CMD_NMS_FORWARD(0.3);
+	cmd.info.nms.top_k = 4;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b, c), 0);
+	float bt[2 * 5] = {
+		9, 9, 0, 2, 1,
+		7, 7, 0, 2, 1,
+	};
+	REQUIRE_ARRAY_EQ(float, b->data.f32, bt, 2 * 5, "should be equal");
+	int ct[10] = {9, 7, -1, -1, -1, -1, -1, -1, -1, -1};
+	REQUIRE_ARRAY_EQ(int, c->data.i32, ct, 10, "only the top 4 should be considered");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(c);
+}
+
+TEST_CASE("compare non-maximal suppression forward between reference and optimized implementation")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_NMS_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 3, 2000, 5), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 3, 2000, 5), 0);
+	ccv_nnc_tensor_t* const c = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32S, 3, 2000), 0);
+	ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 3, 2000, 5), 0);
+	ccv_nnc_tensor_t* const ct = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32S, 3, 2000), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	int i, j, k;
+	for (i = 0; i < 3 * 2000; i++)
+	{
+		a->data.f32[i * 5] = i; // Distinct scores so the order is unambiguous.
+		a->data.f32[i * 5 + 1] = dsfmt_genrand_open_close(&dsfmt) * 100;
+		a->data.f32[i * 5 + 2] = dsfmt_genrand_open_close(&dsfmt) * 100;
+		a->data.f32[i * 5 + 3] = dsfmt_genrand_open_close(&dsfmt) * 20 + 1;
+		a->data.f32[i * 5 + 4] = dsfmt_genrand_open_close(&dsfmt) * 20 + 1;
+	}
+	for (k = 0; k < 2; k++)
+	{
+		ccv_nnc_cmd_t cmd = CMD_NMS_FORWARD(0.5);
+		cmd.info.nms.top_k = k == 0 ? 0 : 500;
+		cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(bt, ct), 0);
+		cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b, c), 0);
+		REQUIRE_ARRAY_EQ(int, c->data.i32, ct->data.i32, 3 * 2000, "suppressed boxes should match");
+		for (i = 0; i < 3; i++)
+		{
+			for (j = 0; j < 2000 && ct->data.i32[i * 2000 + j] >= 0; j++);
+			REQUIRE_ARRAY_EQ(float, b->data.f32 + i * 2000 * 5, bt->data.f32 + i * 2000 * 5, j * 5, "kept boxes should match");
+		}
+	}
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(bt);
+	ccv_nnc_tensor_free(ct);
+}
+
 #include "case_main.h"
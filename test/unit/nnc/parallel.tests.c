@@ -4,6 +4,9 @@
 #include <ccv.h>
 #include <nnc/ccv_nnc.h>
 #include <nnc/ccv_nnc_easy.h>
+#include <nnc/_ccv_nnc_stream.h>
+#include <pthread.h>
+#include <sys/time.h>
 
 TEST_SETUP()
 {
@@ -59,6 +62,294 @@ TEST_CASE("schedule a simple graph for parallel execution")
 	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
 }
 
+TEST_CASE("run a simple graph on a CPU stream context")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	const ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1), "x");
+	const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1), "y");
+	const ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1), "z");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWPROD_FORWARD(), TENSOR_SYMBOL_LIST(x, y), TENSOR_SYMBOL_LIST(z), "mul");
+	const ccv_nnc_tensor_symbol_t a = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1), "a");
+	const ccv_nnc_tensor_symbol_t b = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1), "b");
+	const ccv_nnc_tensor_symbol_t c = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1), "c");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWSUM_FORWARD(), TENSOR_SYMBOL_LIST(a, b), TENSOR_SYMBOL_LIST(c), "sum");
+	const ccv_nnc_tensor_symbol_t d = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1), "d");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWDIV_FORWARD(), TENSOR_SYMBOL_LIST(z, c), TENSOR_SYMBOL_LIST(d), "div");
+	const ccv_nnc_tensor_symbol_t d0 = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1), "d0");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWLOG_FORWARD(), TENSOR_SYMBOL_LIST(d), TENSOR_SYMBOL_LIST(d0), "log");
+	const ccv_nnc_tensor_symbol_t d1 = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1), "d1");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWEXP_FORWARD(), TENSOR_SYMBOL_LIST(d), TENSOR_SYMBOL_LIST(d1), "exp");
+	const ccv_nnc_tensor_symbol_t d2 = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1), "d2");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWSUM_FORWARD(), TENSOR_SYMBOL_LIST(d0, d1), TENSOR_SYMBOL_LIST(d2), "sum1");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params,
+		0, 0,
+		TENSOR_SYMBOL_LIST(d2),
+		SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph),
+		&graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_graph_set_default_static_schedule(graph, CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, x);
+	ccv_nnc_tensor_t* const y_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, y);
+	ccv_nnc_tensor_t* const a_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, a);
+	ccv_nnc_tensor_t* const b_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, b);
+	ccv_nnc_tensor_t* const d2_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, d2);
+	ccv_nnc_stream_context_t* const stream = ccv_nnc_stream_context_new(CCV_STREAM_CONTEXT_CPU);
+	int i;
+	for (i = 0; i < 10; i++)
+	{
+		x_tensor->data.f32[0] = 2 + i;
+		y_tensor->data.f32[0] = 0.21;
+		a_tensor->data.f32[0] = 2.2;
+		b_tensor->data.f32[0] = 3.2;
+		ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, stream);
+		ccv_nnc_stream_context_wait(stream);
+		const float dv = (2 + i) * 0.21 / (2.2 + 3.2);
+		REQUIRE_EQ_WITH_TOLERANCE(d2_tensor->data.f32[0], logf(dv) + expf(dv), 1e-5, "result should be equal");
+	}
+	ccv_nnc_stream_context_free(stream);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+}
+
+TEST_CASE("synchronize commands on two CPU stream contexts with signal")
+{
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1000), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1000), 0);
+	ccv_nnc_tensor_t* const c = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1000), 0);
+	int i;
+	for (i = 0; i < 1000; i++)
+		a->data.f32[i] = i;
+	ccv_nnc_stream_context_t* const stream_0 = ccv_nnc_stream_context_new(CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_stream_context_t* const stream_1 = ccv_nnc_stream_context_new(CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_stream_signal_t* const signal = ccv_nnc_stream_signal_new(CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_cmd_exec(CMD_EWSUM_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(a, a), TENSOR_LIST(b), stream_0);
+	ccv_nnc_cmd_exec(CMD_EWPROD_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(b, b), TENSOR_LIST(b), stream_0);
+	ccv_nnc_stream_context_emit_signal(stream_0, signal);
+	ccv_nnc_stream_context_wait_signal(stream_1, signal);
+	ccv_nnc_cmd_exec(CMD_EWSUM_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(b, a), TENSOR_LIST(c), stream_1);
+	ccv_nnc_stream_context_wait(stream_1);
+	for (i = 0; i < 1000; i++)
+		REQUIRE_EQ_WITH_TOLERANCE(c->data.f32[i], 4.0 * i * i + i, 1e-3, "should wait for stream_0 before execute");
+	ccv_nnc_stream_context_free(stream_0);
+	ccv_nnc_stream_context_free(stream_1);
+	ccv_nnc_stream_signal_free(signal);
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(c);
+}
+
+TEST_CASE("run a graph with independent branches on a multi-threaded scheduler")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_symbol_t x[4], y[4];
+	int i, j;
+	for (i = 0; i < 4; i++)
+	{
+		x[i] = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 128), 0);
+		const ccv_nnc_tensor_symbol_t t = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 128), 0);
+		ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWEXP_FORWARD(), TENSOR_SYMBOL_LIST(x[i]), TENSOR_SYMBOL_LIST(t), "exp");
+		y[i] = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 128), 0);
+		ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWLOG_FORWARD(), TENSOR_SYMBOL_LIST(t), TENSOR_SYMBOL_LIST(y[i]), "log");
+	}
+	const ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 128), "z");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWSUM_FORWARD(), TENSOR_SYMBOL_LIST(y[0], y[1], y[2], y[3]), TENSOR_SYMBOL_LIST(z), "sum");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params,
+		0, 0,
+		TENSOR_SYMBOL_LIST(z),
+		SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph),
+		&graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_graph_set_default_static_schedule(graph, CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_stream_context_t* const stream = ccv_nnc_stream_context_new(CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_stream_context_set_scheduler_worker_count(stream, 4);
+	ccv_nnc_tensor_t* const z_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, z);
+	int k;
+	for (k = 0; k < 10; k++)
+	{
+		for (i = 0; i < 4; i++)
+		{
+			ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, x[i]);
+			for (j = 0; j < 128; j++)
+				x_tensor->data.f32[j] = (i + 1) * 0.01 * j + k;
+		}
+		ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, stream);
+		ccv_nnc_stream_context_wait(stream);
+		for (j = 0; j < 128; j++)
+			REQUIRE_EQ_WITH_TOLERANCE(z_tensor->data.f32[j], 0.1 * j + 4 * k, 1e-3, "sum of the branches should match");
+	}
+	ccv_nnc_stream_context_free(stream);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+}
+
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	co_scheduler_t* scheduler;
+	int arrived;
+	int met;
+	int on_scheduler;
+} rendezvous_t;
+
+static rendezvous_t rendezvous = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+static int _rendezvous_exec(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_stream_context_t* const stream_context)
+{
+	pthread_mutex_lock(&rendezvous.mutex);
+	if (!co_is_on_scheduler(rendezvous.scheduler))
+		rendezvous.on_scheduler = 0;
+	++rendezvous.arrived;
+	pthread_cond_broadcast(&rendezvous.cond);
+	// Wait for the other branch to arrive, give up after a few seconds if it never runs at the same time.
+	struct timeval now;
+	gettimeofday(&now, 0);
+	struct timespec timeout = {
+		.tv_sec = now.tv_sec + 5,
+		.tv_nsec = now.tv_usec * 1000,
+	};
+	while (rendezvous.arrived < 2)
+		if (pthread_cond_timedwait(&rendezvous.cond, &rendezvous.mutex, &timeout) != 0)
+			break;
+	if (rendezvous.arrived >= 2)
+		++rendezvous.met;
+	pthread_mutex_unlock(&rendezvous.mutex);
+	int i;
+	for (i = 0; i < ccv_nnc_tensor_count(inputs[0]->info); i++)
+		outputs[0]->data.f32[i] = inputs[0]->data.f32[i] * 2;
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static ccv_nnc_cmd_vtab_t _rendezvous_isa = {
+	.exec = _rendezvous_exec,
+};
+
+TEST_CASE("independent branches on a multi-threaded scheduler run at the same time")
+{
+	const ccv_nnc_cmd_t cmd = ccv_nnc_cmd(CCV_NNC_CUSTOM_FORWARD, &_rendezvous_isa, (ccv_nnc_cmd_param_t){}, 0);
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_symbol_t x[2], y[2];
+	int i, j;
+	for (i = 0; i < 2; i++)
+	{
+		x[i] = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), 0);
+		y[i] = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), 0);
+		ccv_nnc_graph_exec_symbol_new(symbolic_graph, cmd, TENSOR_SYMBOL_LIST(x[i]), TENSOR_SYMBOL_LIST(y[i]), "rendezvous");
+	}
+	const ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "z");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWSUM_FORWARD(), TENSOR_SYMBOL_LIST(y[0], y[1]), TENSOR_SYMBOL_LIST(z), "sum");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params,
+		0, 0,
+		TENSOR_SYMBOL_LIST(z),
+		SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph),
+		&graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_graph_set_default_static_schedule(graph, CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_stream_context_t* const stream = ccv_nnc_stream_context_new(CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_stream_context_set_scheduler_worker_count(stream, 4);
+	rendezvous.scheduler = ccv_nnc_stream_context_get_scheduler(stream);
+	rendezvous.met = 0;
+	rendezvous.on_scheduler = 1;
+	ccv_nnc_tensor_t* const z_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, z);
+	int k;
+	for (k = 0; k < 4; k++)
+	{
+		for (i = 0; i < 2; i++)
+		{
+			ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, x[i]);
+			for (j = 0; j < 4; j++)
+				x_tensor->data.f32[j] = i + j + k;
+		}
+		rendezvous.arrived = 0;
+		ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, stream);
+		ccv_nnc_stream_context_wait(stream);
+		for (j = 0; j < 4; j++)
+			REQUIRE_EQ_WITH_TOLERANCE(z_tensor->data.f32[j], 2 * (1 + 2 * j + 2 * k), 1e-5, "sum of the branches should match");
+	}
+	REQUIRE_EQ(rendezvous.on_scheduler, 1, "commands should run on the scheduler workers");
+	REQUIRE_EQ(rendezvous.met, 8, "both branches should be running at the same time");
+	ccv_nnc_stream_context_free(stream);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+}
+
+static void _parallel_for_square(void* const context, const int i)
+{
+	int* const x = (int*)context;
+	x[i] = i * i;
+}
+
+typedef struct {
+	int* x;
+	int n;
+} nested_parallel_for_t;
+
+static void _nested_parallel_for_row(void* const context, const int i)
+{
+	const nested_parallel_for_t* const nested = (nested_parallel_for_t*)context;
+	ccv_nnc_parallel_for(nested->n, 1, _parallel_for_square, nested->x + i * nested->n);
+}
+
+TEST_CASE("run a parallel for on the thread pool")
+{
+	int x[1000];
+	int i;
+	memset(x, 0, sizeof(x));
+	ccv_nnc_parallel_for(1000, 0, _parallel_for_square, x);
+	for (i = 0; i < 1000; i++)
+		REQUIRE_EQ(x[i], i * i, "every iteration should be executed once");
+	ccv_nnc_thread_pool_param_t params = ccv_nnc_default_thread_pool_params;
+	params.thread_count = 4;
+	params.caller_participates = 0;
+	ccv_nnc_thread_pool_configure(params);
+	REQUIRE_EQ(ccv_nnc_thread_pool_size(), 4, "should have 4 threads in the pool");
+	memset(x, 0, sizeof(x));
+	ccv_nnc_parallel_for(1000, 7, _parallel_for_square, x);
+	for (i = 0; i < 1000; i++)
+		REQUIRE_EQ(x[i], i * i, "every iteration should be executed once when caller doesn't participate");
+	ccv_nnc_thread_pool_configure(ccv_nnc_default_thread_pool_params);
+}
+
+TEST_CASE("run nested parallel for on the thread pool")
+{
+	int x[32 * 32];
+	int i, j, k;
+	ccv_nnc_thread_pool_param_t params = ccv_nnc_default_thread_pool_params;
+	params.thread_count = 4;
+	for (k = 0; k < 2; k++)
+	{
+		params.nested = k == 0 ? CCV_NNC_THREAD_POOL_NESTED_SERIAL : CCV_NNC_THREAD_POOL_NESTED_PARALLEL;
+		ccv_nnc_thread_pool_configure(params);
+		memset(x, 0, sizeof(x));
+		nested_parallel_for_t nested = {
+			.x = x,
+			.n = 32,
+		};
+		ccv_nnc_parallel_for(32, 1, _nested_parallel_for_row, &nested);
+		for (i = 0; i < 32; i++)
+			for (j = 0; j < 32; j++)
+				REQUIRE_EQ(x[i * 32 + j], j * j, "nested parallel for should cover every row");
+	}
+	ccv_nnc_thread_pool_configure(ccv_nnc_default_thread_pool_params);
+}
+
 TEST_CASE("schedule symbolic graph to data parallel")
 {
 	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
@@ -94,4 +385,169 @@ TEST_CASE("schedule symbolic graph to data parallel")
 	ccv_nnc_symbolic_graph_free(symbolic_graph);
 }
 
+TEST_CASE("allreduce, broadcast and reduce across CPU replicas")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_COMM_ALLREDUCE_FORWARD, CCV_NNC_BACKEND_CPU_REF));
+	// Large enough that each segment spans multiple chunks, and not divisible by the replica count.
+	const int count = 50001;
+	ccv_nnc_tensor_t* a[5];
+	ccv_nnc_tensor_t* b[5];
+	int i, j, k, n;
+	for (i = 0; i < 5; i++)
+	{
+		a[i] = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, count), 0);
+		b[i] = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, count), 0);
+		for (j = 0; j < count; j++)
+			a[i]->data.f32[j] = (i + 1) * (j % 7);
+	}
+	// Ring and tree allreduce, with the output in-place or not, for power of 2 and non-power of 2 replicas.
+	for (n = 2; n <= 5; n++)
+		for (k = 0; k < 4; k++)
+		{
+			ccv_nnc_cmd_t cmd = CMD_COMM_ALLREDUCE_FORWARD();
+			cmd.algorithm = k % 2;
+			ccv_nnc_tensor_t** const outputs = k < 2 ? b : a;
+			for (i = 0; i < n; i++)
+				for (j = 0; j < count; j++)
+					a[i]->data.f32[j] = (i + 1) * (j % 7);
+			ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, a, n, outputs, n, 0);
+			int correct = 1;
+			for (i = 0; i < n && correct; i++)
+				for (j = 0; j < count && correct; j++)
+					if (outputs[i]->data.f32[j] != n * (n + 1) / 2 * (j % 7))
+						correct = 0;
+			REQUIRE(correct, "every replica should have the sum for %d replicas with algorithm %d", n, cmd.algorithm);
+		}
+	for (i = 0; i < 3; i++)
+		for (j = 0; j < count; j++)
+			a[i]->data.f32[j] = (i + 1) * (j % 7);
+	ccv_nnc_cmd_exec(CMD_COMM_REDUCE_FORWARD(), ccv_nnc_no_hint, 0, a, 3, b, 3, 0);
+	for (j = 0; j < count; j++)
+		REQUIRE_EQ_WITH_TOLERANCE(b[0]->data.f32[j], 6 * (j % 7), 1e-5, "reduce should sum into the first output");
+	ccv_nnc_cmd_exec(CMD_COMM_BROADCAST_FORWARD(), ccv_nnc_no_hint, 0, b, 1, a, 4, 0);
+	for (i = 0; i < 4; i++)
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, a[i]->data.f32, b[0]->data.f32, count, 1e-5, "broadcast should copy to every replica");
+	for (i = 0; i < 5; i++)
+	{
+		ccv_nnc_tensor_free(a[i]);
+		ccv_nnc_tensor_free(b[i]);
+	}
+}
+
+TEST_CASE("schedule symbolic graph to data parallel on CPU")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_COMM_ALLREDUCE_FORWARD, CCV_NNC_BACKEND_CPU_REF));
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	const ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "x");
+	const ccv_nnc_tensor_symbol_t w = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "w");
+	const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "y");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWPROD_FORWARD(), TENSOR_SYMBOL_LIST(x, w), TENSOR_SYMBOL_LIST(y), "prod");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_data_parallel(symbolic_graph, 2, TENSOR_SYMBOL_LIST(w), TENSOR_SYMBOL_LIST(y), 0, 0, 0, 0, CCV_NNC_PARALLEL_REDUCE_OP_SUM, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	const ccv_nnc_tensor_symbol_t x1 = ccv_nnc_tensor_symbol_copy(symbolic_graph, x, 1);
+	const ccv_nnc_tensor_symbol_t y1 = ccv_nnc_tensor_symbol_copy(symbolic_graph, y, 1);
+	REQUIRE(x1.d >= 0 && y1.d >= 0, "x and y should be duplicated for the second replica");
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	ccv_nnc_tensor_t* const x1_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	int i;
+	for (i = 0; i < 4; i++)
+		x_tensor->data.f32[i] = i + 1, x1_tensor->data.f32[i] = 2 * (i + 1), w_tensor->data.f32[i] = 0.5;
+	ccv_nnc_graph_t* graph = 0;
+	ccv_nnc_tensor_arena_t* tensor_arena = 0;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena = 0;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params, TENSOR_BIND_MAP(KV(x, x_tensor), KV(x1, x1_tensor), KV(w, w_tensor)), 0, 0, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+	ccv_nnc_tensor_t* const y_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, y);
+	ccv_nnc_tensor_t* const y1_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, y1);
+	float yv[] = {1.5, 3, 4.5, 6};
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, y_tensor->data.f32, yv, 4, 1e-5, "y should be allreduced on the first replica");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, y1_tensor->data.f32, yv, 4, 1e-5, "y should be allreduced on the second replica");
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	ccv_nnc_tensor_free(x_tensor);
+	ccv_nnc_tensor_free(x1_tensor);
+	ccv_nnc_tensor_free(w_tensor);
+}
+
+TEST_CASE("failure of a command on a CPU stream context is returned when wait")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_NMS_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10, 5), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10, 5), 0);
+	ccv_nnc_tensor_t* const c = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32S, 10), 0);
+	int i;
+	for (i = 0; i < 10 * 5; i++)
+		a->data.f32[i] = i;
+	ccv_nnc_stream_context_t* const stream = ccv_nnc_stream_context_new(CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_cmd_t cmd = CMD_NMS_FORWARD(0.5);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	// The optimized implementation cannot run in place.
+	REQUIRE_EQ(ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(a, c), stream), CCV_NNC_EXEC_SUCCESS, "submitted to the stream");
+	ccv_nnc_cmd_exec(CMD_EWSUM_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(a, a), TENSOR_LIST(b), stream);
+	REQUIRE_EQ(ccv_nnc_stream_context_wait(stream), CCV_NNC_EXEC_INVALID, "the failure should be returned");
+	for (i = 0; i < 10 * 5; i++)
+		REQUIRE_EQ_WITH_TOLERANCE(b->data.f32[i], i * 2, 1e-5, "the commands after should still execute");
+	ccv_nnc_cmd_exec(CMD_EWSUM_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(a, a), TENSOR_LIST(b), stream);
+	REQUIRE_EQ(ccv_nnc_stream_context_wait(stream), CCV_NNC_EXEC_SUCCESS, "the failure is cleared after wait");
+	ccv_nnc_stream_context_free(stream);
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(c);
+}
+
+typedef struct {
+	ccv_nnc_stream_context_t* stream;
+	int freed;
+	pthread_mutex_t mutex;
+	pthread_cond_t notify;
+} free_on_stream_t;
+
+static void _free_on_stream(void* const context)
+{
+	free_on_stream_t* const free_on_stream = (free_on_stream_t*)context;
+	ccv_nnc_stream_context_free(free_on_stream->stream);
+}
+
+static void _stream_freed(const ccv_nnc_stream_context_t* const stream, void* const context)
+{
+	free_on_stream_t* const free_on_stream = (free_on_stream_t*)context;
+	pthread_mutex_lock(&free_on_stream->mutex);
+	free_on_stream->freed = 1;
+	pthread_cond_signal(&free_on_stream->notify);
+	pthread_mutex_unlock(&free_on_stream->mutex);
+}
+
+TEST_CASE("free a CPU stream context from its own thread")
+{
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1000), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1000), 0);
+	int i;
+	for (i = 0; i < 1000; i++)
+		a->data.f32[i] = i;
+	free_on_stream_t free_on_stream = {
+		.stream = ccv_nnc_stream_context_new(CCV_STREAM_CONTEXT_CPU),
+		.freed = 0,
+	};
+	pthread_mutex_init(&free_on_stream.mutex, 0);
+	pthread_cond_init(&free_on_stream.notify, 0);
+	ccv_nnc_stream_context_add_destructor_hook(free_on_stream.stream, _stream_freed, &free_on_stream);
+	ccv_nnc_stream_context_add_callback(free_on_stream.stream, _free_on_stream, &free_on_stream);
+	// Submitted before the free executes, thus, still executed.
+	ccv_nnc_cmd_exec(CMD_EWSUM_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(a, a), TENSOR_LIST(b), free_on_stream.stream);
+	pthread_mutex_lock(&free_on_stream.mutex);
+	while (!free_on_stream.freed)
+		pthread_cond_wait(&free_on_stream.notify, &free_on_stream.mutex);
+	pthread_mutex_unlock(&free_on_stream.mutex);
+	for (i = 0; i < 1000; i++)
+		REQUIRE_EQ_WITH_TOLERANCE(b->data.f32[i], i * 2, 1e-5, "should execute before the stream is freed");
+	pthread_mutex_destroy(&free_on_stream.mutex);
+	pthread_cond_destroy(&free_on_stream.notify);
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+}
+
 #include "case_main.h"
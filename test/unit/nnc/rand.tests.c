@@ -75,4 +75,100 @@ TEST_CASE("random normal distribution")
 	ccv_nnc_symbolic_graph_free(symbolic_graph);
 }
 
+TEST_CASE("random uniform and normal distribution with optimized implementation don't depend on thread count")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_RANDOM_UNIFORM_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_RANDOM_NORMAL_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const x = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 100001), 0);
+	ccv_nnc_tensor_t* const y = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 100001), 0);
+	ccv_nnc_thread_pool_param_t params = ccv_nnc_default_thread_pool_params;
+	params.thread_count = 1;
+	ccv_nnc_thread_pool_configure(params);
+	ccv_nnc_cmd_t cmd = CMD_RANDOM_UNIFORM_FORWARD(-8, 4);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(), TENSOR_LIST(x), 0);
+	memcpy(y->data.f32, x->data.f32, sizeof(float) * 100001);
+	params.thread_count = 4;
+	ccv_nnc_thread_pool_configure(params);
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(), TENSOR_LIST(x), 0);
+	REQUIRE_ARRAY_EQ(float, x->data.f32, y->data.f32, 100001, "random uniform should generate the same numbers with 1 or 4 threads");
+	int i;
+	int h[4 + 8] = {};
+	for (i = 0; i < 100001; i++)
+	{
+		REQUIRE(x->data.f32[i] > -8 - 1e-5, "it must be bigger than lower bound");
+		REQUIRE(x->data.f32[i] < 4 + 1e-5, "and smaller than upper bound");
+		int b = (int)roundf(x->data.f32[i] - 0.5) + 8;
+		b = ccv_max(ccv_min(b, 11), 0);
+		++h[b];
+	}
+	const int count = (int)roundf(100001. / (4 + 8));
+	for (i = 0; i < 12; i++)
+		{ REQUIRE(h[i] >= count - 1000 && h[i] <= count + 1000, "uniform distribution"); }
+	cmd = CMD_RANDOM_NORMAL_FORWARD(2, 1);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(), TENSOR_LIST(x), 0);
+	memcpy(y->data.f32, x->data.f32, sizeof(float) * 100001);
+	params.thread_count = 1;
+	ccv_nnc_thread_pool_configure(params);
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(), TENSOR_LIST(x), 0);
+	ccv_nnc_thread_pool_configure(ccv_nnc_default_thread_pool_params);
+	REQUIRE_ARRAY_EQ(float, x->data.f32, y->data.f32, 100001, "random normal should generate the same numbers with 1 or 4 threads");
+	double mean = 0;
+	for (i = 0; i < 100001; i++)
+		mean += x->data.f32[i];
+	mean = mean / 100001.0;
+	double std = 0;
+	for (i = 0; i < 100001; i++)
+		std += (x->data.f32[i] - mean) * (x->data.f32[i] - mean);
+	std = sqrt(std / 100001.0);
+	REQUIRE_EQ_WITH_TOLERANCE(std, 2, 2e-2, "std should be 2");
+	REQUIRE_EQ_WITH_TOLERANCE(mean, 1, 2e-2, "mean should be 1");
+	ccv_nnc_tensor_free(x);
+	ccv_nnc_tensor_free(y);
+}
+
+TEST_CASE("random uniform and normal distribution with optimized implementation are reproducible for a given seed and offset")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_RANDOM_UNIFORM_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_RANDOM_NORMAL_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const x = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10001), 0);
+	ccv_nnc_tensor_t* const y = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10001), 0);
+	ccv_nnc_tensor_t* const z = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10001), 0);
+	ccv_nnc_cmd_t cmd = CMD_RANDOM_UNIFORM_FORWARD(-8, 4);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	cmd.info.rand.seed = 0x1234;
+	cmd.info.rand.offset = 100;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(), TENSOR_LIST(x), 0);
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(), TENSOR_LIST(y), 0);
+	REQUIRE_ARRAY_EQ(float, x->data.f32, y->data.f32, 10001, "random uniform should generate the same numbers for the same seed and offset into different tensors");
+	cmd.info.rand.offset = 105;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(), TENSOR_LIST(z), 0);
+	REQUIRE_ARRAY_EQ(float, x->data.f32 + 5, z->data.f32, 10001 - 5, "random uniform with a different offset should continue the same stream");
+	REQUIRE(x->data.f32[0] != z->data.f32[0], "random uniform with a different offset should generate different numbers");
+	cmd.info.rand.offset = 100;
+	cmd.info.rand.seed = 0x1235;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(), TENSOR_LIST(z), 0);
+	int i, diff = 0;
+	for (i = 0; i < 10001; i++)
+		diff += (x->data.f32[i] != z->data.f32[i]);
+	REQUIRE(diff > 10000 - 100, "random uniform with a different seed should generate different numbers");
+	cmd = CMD_RANDOM_NORMAL_FORWARD(2, 1);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	cmd.info.rand.seed = 0x1234;
+	cmd.info.rand.offset = 100;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(), TENSOR_LIST(x), 0);
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(), TENSOR_LIST(y), 0);
+	REQUIRE_ARRAY_EQ(float, x->data.f32, y->data.f32, 10001, "random normal should generate the same numbers for the same seed and offset into different tensors");
+	cmd.info.rand.offset = 100 + 10002;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(), TENSOR_LIST(z), 0);
+	diff = 0;
+	for (i = 0; i < 10001; i++)
+		diff += (x->data.f32[i] != z->data.f32[i]);
+	REQUIRE(diff > 10000 - 100, "random normal with a different offset should generate different numbers");
+	ccv_nnc_tensor_free(x);
+	ccv_nnc_tensor_free(y);
+	ccv_nnc_tensor_free(z);
+}
+
 #include "case_main.h"
@@ -251,4 +251,139 @@ TEST_CASE("argmax for [[1, 2, 7], [5, 6, 4]] on axis 1")
 	ccv_nnc_tensor_free(b);
 }
 
+TEST_CASE("reduce sum and reduce max with optimized implementation on different axes")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_REDUCE_SUM_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_REDUCE_MAX_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 3, 17, 129, 33), 0);
+	int i, j;
+	for (i = 0; i < 3 * 17 * 129 * 33; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	// Inner axes, outer axes, both, and everything.
+	const int axes[][5] = {
+		{1, 3}, {1, 2}, {2, 1, 2}, {1, 0}, {2, 0, 3}, {2, 0, 2}, {3, 0, 1, 2}, {4, 0, 1, 2, 3}
+	};
+	for (i = 0; i < sizeof(axes) / sizeof(axes[0]); i++)
+	{
+		ccv_nnc_tensor_param_t params = a->info;
+		int reduce_count = 1;
+		for (j = 0; j < axes[i][0]; j++)
+			reduce_count *= params.dim[axes[i][j + 1]], params.dim[axes[i][j + 1]] = 1;
+		ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, params, 0);
+		ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, params, 0);
+		const int count = ccv_nnc_tensor_count(params);
+		ccv_nnc_cmd_t cmd = CMD_REDUCE_SUM_FORWARD(0);
+		cmd.info.reduce.count = axes[i][0];
+		for (j = 0; j < axes[i][0]; j++)
+			cmd.info.reduce.axis[j] = axes[i][j + 1];
+		cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(bt), 0);
+		cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), 0);
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, bt->data.f32, count, 1e-5 * reduce_count, "reduce sum should match the reference implementation");
+		cmd.algorithm = 1; // This is deterministic.
+		ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), 0);
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, bt->data.f32, count, 1e-5 * reduce_count, "deterministic reduce sum should match the reference implementation");
+		cmd.cmd = CCV_NNC_REDUCE_MAX_FORWARD;
+		cmd.algorithm = -1;
+		cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(bt), 0);
+		cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), 0);
+		REQUIRE_ARRAY_EQ(float, b->data.f32, bt->data.f32, count, "reduce max should be exactly the same as the reference implementation");
+		ccv_nnc_tensor_free(b);
+		ccv_nnc_tensor_free(bt);
+	}
+	ccv_nnc_tensor_free(a);
+}
+
+TEST_CASE("reduce sum with deterministic algorithm doesn't depend on thread count")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_REDUCE_SUM_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1000, 3, 127), 0);
+	int i;
+	for (i = 0; i < 1000 * 3 * 127; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 3, 1), 0);
+	ccv_nnc_tensor_t* const c = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 3, 1), 0);
+	ccv_nnc_cmd_t cmd = CMD_REDUCE_SUM_FORWARD(0, 2);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	cmd.algorithm = 1; // This is deterministic.
+	ccv_nnc_thread_pool_param_t params = ccv_nnc_default_thread_pool_params;
+	params.thread_count = 1;
+	ccv_nnc_thread_pool_configure(params);
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), 0);
+	params.thread_count = 4;
+	ccv_nnc_thread_pool_configure(params);
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(c), 0);
+	ccv_nnc_thread_pool_configure(ccv_nnc_default_thread_pool_params);
+	REQUIRE_ARRAY_EQ(float, b->data.f32, c->data.f32, 3, "deterministic reduce sum should be the same with 1 or 4 threads");
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(c), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, c->data.f32, 3, 1e-2, "deterministic reduce sum should match the reference implementation");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(c);
+}
+
+TEST_CASE("argmax with optimized implementation")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_ARGMAX_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 7, 129, 67), 0);
+	int i;
+	// Only a few distinct values, thus, there are plenty of ties and the first maximum has to be picked.
+	for (i = 0; i < 7 * 129 * 67; i++)
+		a->data.f32[i] = (int)(dsfmt_genrand_open_close(&dsfmt) * 8);
+	for (i = 0; i < 3; i++)
+	{
+		ccv_nnc_tensor_param_t params = a->info;
+		params.dim[i] = 1;
+		params.datatype = CCV_32S;
+		ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, params, 0);
+		ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, params, 0);
+		ccv_nnc_cmd_t cmd = CMD_ARGMAX_FORWARD(i);
+		cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(bt), 0);
+		cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), 0);
+		REQUIRE_TENSOR_EQ(b, bt, "argmax should be exactly the same as the reference implementation");
+		ccv_nnc_tensor_free(b);
+		ccv_nnc_tensor_free(bt);
+	}
+	ccv_nnc_tensor_free(a);
+}
+
+TEST_CASE("add backward with broadcast with optimized implementation")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_ADD_BACKWARD, CCV_NNC_BACKEND_CPU_OPT));
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	ccv_nnc_tensor_t* const g = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 33, 65), 0);
+	int i;
+	for (i = 0; i < 8 * 33 * 65; i++)
+		g->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	ccv_nnc_tensor_t* const da = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 33, 1), 0);
+	ccv_nnc_tensor_t* const db = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 1, 65), 0);
+	ccv_nnc_tensor_t* const dat = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 33, 1), 0);
+	ccv_nnc_tensor_t* const dbt = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 1, 65), 0);
+	ccv_nnc_cmd_t cmd = CMD_ADD_BACKWARD(0.5, -2);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(g), TENSOR_LIST(dat, dbt), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(g), TENSOR_LIST(da, db), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, da->data.f32, dat->data.f32, 33, 1e-4, "gradient of the first input should match the reference implementation");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, db->data.f32, dbt->data.f32, 8 * 65, 1e-4, "gradient of the second input should match the reference implementation");
+	ccv_nnc_tensor_free(g);
+	ccv_nnc_tensor_free(da);
+	ccv_nnc_tensor_free(db);
+	ccv_nnc_tensor_free(dat);
+	ccv_nnc_tensor_free(dbt);
+}
+
 #include "case_main.h"
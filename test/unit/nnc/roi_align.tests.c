@@ -4,6 +4,7 @@
 #include <ccv.h>
 #include <nnc/ccv_nnc.h>
 #include <nnc/ccv_nnc_easy.h>
+#include <3rdparty/dsfmt/dSFMT.h>
 
 TEST_SETUP()
 {
@@ -161,4 +162,46 @@ TEST_CASE("compare ROI align backward with average pool, batch of 2")
 	ccv_nnc_tensor_free(at);
 }
 
+TEST_CASE("compare ROI align forward and backward between reference and optimized implementation")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_ROI_ALIGN_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_ROI_ALIGN_BACKWARD, CCV_NNC_BACKEND_CPU_OPT));
+	// One feature map shared by 3 ROIs, the last one partially outside of it.
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 12, 24, 37), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 3, 4), 0);
+	ccv_nnc_tensor_t* const c = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 3, 5, 4, 37), 0);
+	ccv_nnc_tensor_t* const ct = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 3, 5, 4, 37), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	int i;
+	for (i = 0; i < 12 * 24 * 37; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	const float rois[] = {
+		0.1, 0.2, 0.5, 0.6,
+		0.33, 0, 0.41, 0.77,
+		-0.2, 0.7, 0.5, 0.5,
+	};
+	memcpy(b->data.f32, rois, sizeof(rois));
+	ccv_nnc_cmd_t cmd = CMD_ROI_ALIGN_FORWARD(5, 4);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, b), TENSOR_LIST(ct), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, b), TENSOR_LIST(c), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, c->data.f32, ct->data.f32, 3 * 5 * 4 * 37, 1e-5, "the forward of ROI align should be equal");
+	ccv_nnc_tensor_t* const at = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 12, 24, 37), 0);
+	for (i = 0; i < 3 * 5 * 4 * 37; i++)
+		c->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	cmd = CMD_ROI_ALIGN_BACKWARD(5, 4);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(c, 0, b), TENSOR_LIST(at), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(c, 0, b), TENSOR_LIST(a), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, a->data.f32, at->data.f32, 12 * 24 * 37, 1e-5, "the backward of ROI align should be equal");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(ct);
+	ccv_nnc_tensor_free(at);
+}
+
 #include "case_main.h"
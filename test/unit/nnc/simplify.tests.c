@@ -4,6 +4,7 @@
 #include <ccv.h>
 #include <nnc/ccv_nnc.h>
 #include <nnc/ccv_nnc_easy.h>
+#include "3rdparty/dsfmt/dSFMT.h"
 
 TEST_SETUP()
 {
@@ -375,4 +376,736 @@ TEST_CASE("simplify graph with while, variant 3")
 	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
 }
 
+TEST_CASE("simplify graph with convolution + batch norm folding")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	const ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 8, 8, 3), "x");
+	const ccv_nnc_tensor_symbol_t w = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4, 3, 3, 3), "w");
+	const ccv_nnc_tensor_symbol_t bias = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "bias");
+	const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 6, 6, 4), "y");
+	const ccv_nnc_cmd_t conv_cmd = CMD_CONVOLUTION_FORWARD(1, 4, 3, 3, 3);
+	const ccv_nnc_hint_t conv_hint = ccv_nnc_hint_auto(conv_cmd.info, CPU_TENSOR_NHWC(32F, 8, 8, 3), CPU_TENSOR_NHWC(32F, 6, 6, 4));
+	const ccv_nnc_graph_exec_symbol_t conv = ccv_nnc_graph_exec_symbol_new(symbolic_graph, conv_cmd, TENSOR_SYMBOL_LIST(x, w, bias), TENSOR_SYMBOL_LIST(y), "convolution");
+	ccv_nnc_graph_exec_symbol_set_hint(symbolic_graph, conv, conv_hint);
+	const ccv_nnc_tensor_symbol_t scale = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "scale");
+	const ccv_nnc_tensor_symbol_t beta = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "beta");
+	const ccv_nnc_tensor_symbol_t mean = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "mean");
+	const ccv_nnc_tensor_symbol_t var = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "var");
+	const ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 6, 6, 4), "z");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_BATCH_NORM_FORWARD(1e-4, 1, 0.9, 0, 1), TENSOR_SYMBOL_LIST(y, scale, beta, mean, var), TENSOR_SYMBOL_LIST(z), "batch norm");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_BATCH_NORM_FOLDING),
+		0, 0,
+		TENSOR_SYMBOL_LIST(z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+	int i;
+	const int exec_symbol_count = ccv_nnc_graph_exec_symbol_count(symbolic_graph);
+	for (i = 0; i < exec_symbol_count; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_t exec_symbol = {
+			.d = i,
+			.graph = symbolic_graph
+		};
+		REQUIRE(ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, exec_symbol).cmd != CCV_NNC_BATCH_NORM_FORWARD, "batch norm should be folded into convolution");
+	}
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 8, 3), 0);
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 3, 3, 3), 0);
+	ccv_nnc_tensor_t* const bias_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	ccv_nnc_tensor_t* const scale_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	ccv_nnc_tensor_t* const beta_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	ccv_nnc_tensor_t* const mean_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	ccv_nnc_tensor_t* const var_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 8 * 8 * 3; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 4 * 3 * 3 * 3; i++)
+		w_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+	for (i = 0; i < 4; i++)
+	{
+		bias_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+		scale_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) + 0.5;
+		beta_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+		mean_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+		var_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) + 0.1;
+	}
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params,
+		TENSOR_BIND_MAP(KV(x, x_tensor), KV(w, w_tensor), KV(bias, bias_tensor), KV(scale, scale_tensor), KV(beta, beta_tensor), KV(mean, mean_tensor), KV(var, var_tensor)),
+		0, 0, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	// Run twice, the folding should not modify the bound parameters.
+	ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+	ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+	ccv_nnc_tensor_t* const y0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 6, 6, 4), 0);
+	ccv_nnc_tensor_t* const z0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 6, 6, 4), 0);
+	ccv_nnc_cmd_exec(conv_cmd, conv_hint, 0, TENSOR_LIST(x_tensor, w_tensor, bias_tensor), TENSOR_LIST(y0_tensor), 0);
+	ccv_nnc_cmd_exec(CMD_BATCH_NORM_FORWARD(1e-4, 1, 0.9, 0, 1), ccv_nnc_no_hint, 0, TENSOR_LIST(y0_tensor, scale_tensor, beta_tensor, mean_tensor, var_tensor), TENSOR_LIST(z0_tensor), 0);
+	ccv_nnc_tensor_t* const z_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, z);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, z_tensor->data.f32, z0_tensor->data.f32, 6 * 6 * 4, 1e-4, "folded convolution should match convolution followed by batch norm");
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_tensor_free(x_tensor);
+	ccv_nnc_tensor_free(w_tensor);
+	ccv_nnc_tensor_free(bias_tensor);
+	ccv_nnc_tensor_free(scale_tensor);
+	ccv_nnc_tensor_free(beta_tensor);
+	ccv_nnc_tensor_free(mean_tensor);
+	ccv_nnc_tensor_free(var_tensor);
+	ccv_nnc_tensor_free(y0_tensor);
+	ccv_nnc_tensor_free(z0_tensor);
+}
+
+TEST_CASE("simplify graph with convolution + relu + batch norm does not fold the batch norm")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	const ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1, 4, 4, 3), "x");
+	const ccv_nnc_tensor_symbol_t w = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4, 3, 3, 3), "w");
+	const ccv_nnc_tensor_symbol_t bias = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "bias");
+	const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1, 2, 2, 4), "y");
+	const ccv_nnc_cmd_t conv_cmd = CMD_CONVOLUTION_FORWARD(1, 4, 3, 3, 3);
+	const ccv_nnc_hint_t conv_hint = ccv_nnc_hint_auto(conv_cmd.info, CPU_TENSOR_NHWC(32F, 1, 4, 4, 3), CPU_TENSOR_NHWC(32F, 1, 2, 2, 4));
+	const ccv_nnc_graph_exec_symbol_t conv = ccv_nnc_graph_exec_symbol_new(symbolic_graph, conv_cmd, TENSOR_SYMBOL_LIST(x, w, bias), TENSOR_SYMBOL_LIST(y), "convolution");
+	ccv_nnc_graph_exec_symbol_set_hint(symbolic_graph, conv, conv_hint);
+	const ccv_nnc_tensor_symbol_t r = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1, 2, 2, 4), "r");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_RELU_FORWARD(), TENSOR_SYMBOL_LIST(y), TENSOR_SYMBOL_LIST(r), "relu");
+	const ccv_nnc_tensor_symbol_t scale = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "scale");
+	const ccv_nnc_tensor_symbol_t beta = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "beta");
+	const ccv_nnc_tensor_symbol_t mean = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "mean");
+	const ccv_nnc_tensor_symbol_t var = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "var");
+	const ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 1, 2, 2, 4), "z");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_BATCH_NORM_FORWARD(1e-4, 1, 0.9, 0, 1, 2), TENSOR_SYMBOL_LIST(r, scale, beta, mean, var), TENSOR_SYMBOL_LIST(z), "batch norm");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_OPS_FUSION,
+			CCV_NNC_SIMPLIFY_BATCH_NORM_FOLDING),
+		0, 0,
+		TENSOR_SYMBOL_LIST(z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+	const ccv_nnc_cmd_t conv_fused_cmd = ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, conv);
+	REQUIRE(conv_fused_cmd.cmd == CCV_NNC_CONVOLUTION_FORWARD && conv_fused_cmd.info.activation.type == CCV_NNC_ACTIVATION_RELU, "relu should be fused into convolution");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_active_symbol_count(symbolic_graph, CCV_NNC_SYMBOL_GRAPH_EXEC), 2, "batch norm after the fused relu should stay");
+	int i;
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 4, 4, 3), 0);
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 3, 3, 3), 0);
+	ccv_nnc_tensor_t* const bias_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	ccv_nnc_tensor_t* const scale_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	ccv_nnc_tensor_t* const beta_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	ccv_nnc_tensor_t* const mean_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	ccv_nnc_tensor_t* const var_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 4 * 4 * 3; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 4 * 3 * 3 * 3; i++)
+		w_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+	for (i = 0; i < 4; i++)
+	{
+		bias_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+		scale_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) + 0.5;
+		beta_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+		mean_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+		var_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) + 0.1;
+	}
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params,
+		TENSOR_BIND_MAP(KV(x, x_tensor), KV(w, w_tensor), KV(bias, bias_tensor), KV(scale, scale_tensor), KV(beta, beta_tensor), KV(mean, mean_tensor), KV(var, var_tensor)),
+		0, 0, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+	ccv_nnc_tensor_t* const y0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 2, 2, 4), 0);
+	ccv_nnc_tensor_t* const r0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 2, 2, 4), 0);
+	ccv_nnc_tensor_t* const z0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 1, 2, 2, 4), 0);
+	ccv_nnc_cmd_exec(conv_cmd, conv_hint, 0, TENSOR_LIST(x_tensor, w_tensor, bias_tensor), TENSOR_LIST(y0_tensor), 0);
+	ccv_nnc_cmd_exec(CMD_RELU_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(y0_tensor), TENSOR_LIST(r0_tensor), 0);
+	ccv_nnc_cmd_exec(CMD_BATCH_NORM_FORWARD(1e-4, 1, 0.9, 0, 1, 2), ccv_nnc_no_hint, 0, TENSOR_LIST(r0_tensor, scale_tensor, beta_tensor, mean_tensor, var_tensor), TENSOR_LIST(z0_tensor), 0);
+	ccv_nnc_tensor_t* const z_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, z);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, z_tensor->data.f32, z0_tensor->data.f32, 2 * 2 * 4, 1e-4, "should match convolution followed by relu and batch norm");
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_tensor_free(x_tensor);
+	ccv_nnc_tensor_free(w_tensor);
+	ccv_nnc_tensor_free(bias_tensor);
+	ccv_nnc_tensor_free(scale_tensor);
+	ccv_nnc_tensor_free(beta_tensor);
+	ccv_nnc_tensor_free(mean_tensor);
+	ccv_nnc_tensor_free(var_tensor);
+	ccv_nnc_tensor_free(y0_tensor);
+	ccv_nnc_tensor_free(r0_tensor);
+	ccv_nnc_tensor_free(z0_tensor);
+}
+
+TEST_CASE("simplify graph with convolution + bias + relu fusion")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	const ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 10, 10, 3), "x");
+	const ccv_nnc_tensor_symbol_t w = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 8, 3, 3, 3), "w");
+	const ccv_nnc_tensor_symbol_t bias = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 8), "bias");
+	const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 8, 8, 8), "y");
+	const ccv_nnc_cmd_t conv_cmd = CMD_CONVOLUTION_FORWARD(1, 8, 3, 3, 3);
+	const ccv_nnc_hint_t conv_hint = ccv_nnc_hint_auto(conv_cmd.info, CPU_TENSOR_NHWC(32F, 10, 10, 3), CPU_TENSOR_NHWC(32F, 8, 8, 8));
+	const ccv_nnc_graph_exec_symbol_t conv = ccv_nnc_graph_exec_symbol_new(symbolic_graph, conv_cmd, TENSOR_SYMBOL_LIST(x, w), TENSOR_SYMBOL_LIST(y), "convolution");
+	ccv_nnc_graph_exec_symbol_set_hint(symbolic_graph, conv, conv_hint);
+	const ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 8, 8, 8), "z");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_ADD_FORWARD(1, 1), TENSOR_SYMBOL_LIST(y, bias), TENSOR_SYMBOL_LIST(z), "add");
+	const ccv_nnc_tensor_symbol_t r = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 8, 8, 8), "r");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_RELU_FORWARD(), TENSOR_SYMBOL_LIST(z), TENSOR_SYMBOL_LIST(r), "relu");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_OPS_FUSION),
+		0, 0,
+		TENSOR_SYMBOL_LIST(r), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_active_symbol_count(symbolic_graph, CCV_NNC_SYMBOL_GRAPH_EXEC), 1, "bias and relu should be fused into convolution");
+	const ccv_nnc_cmd_t fused_cmd = ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, ccv_nnc_symbolic_graph_destinations(symbolic_graph)[0]);
+	REQUIRE(fused_cmd.cmd == CCV_NNC_CONVOLUTION_FORWARD && fused_cmd.info.activation.type == CCV_NNC_ACTIVATION_RELU, "it should be a convolution with relu");
+	int i;
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10, 10, 3), 0);
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 3, 3, 3), 0);
+	ccv_nnc_tensor_t* const bias_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 10 * 10 * 3; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 8 * 3 * 3 * 3; i++)
+		w_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+	for (i = 0; i < 8; i++)
+		bias_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params,
+		TENSOR_BIND_MAP(KV(x, x_tensor), KV(w, w_tensor), KV(bias, bias_tensor)),
+		0, 0, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+	ccv_nnc_tensor_t* const y0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 8, 8), 0);
+	ccv_nnc_tensor_t* const z0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 8, 8), 0);
+	ccv_nnc_tensor_t* const r0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 8, 8, 8), 0);
+	ccv_nnc_cmd_exec(conv_cmd, conv_hint, 0, TENSOR_LIST(x_tensor, w_tensor), TENSOR_LIST(y0_tensor), 0);
+	ccv_nnc_cmd_exec(CMD_ADD_FORWARD(1, 1), ccv_nnc_no_hint, 0, TENSOR_LIST(y0_tensor, bias_tensor), TENSOR_LIST(z0_tensor), 0);
+	ccv_nnc_cmd_exec(CMD_RELU_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(z0_tensor), TENSOR_LIST(r0_tensor), 0);
+	ccv_nnc_tensor_t* const r_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, r);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, r_tensor->data.f32, r0_tensor->data.f32, 8 * 8 * 8, 1e-4, "fused convolution should match convolution followed by bias and relu");
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_tensor_free(x_tensor);
+	ccv_nnc_tensor_free(w_tensor);
+	ccv_nnc_tensor_free(bias_tensor);
+	ccv_nnc_tensor_free(y0_tensor);
+	ccv_nnc_tensor_free(z0_tensor);
+	ccv_nnc_tensor_free(r0_tensor);
+}
+
+TEST_CASE("simplify graph with gemm + bias + sigmoid fusion")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	const ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4, 16), "x");
+	const ccv_nnc_tensor_symbol_t w = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 12, 16), "w");
+	const ccv_nnc_tensor_symbol_t bias = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 12), "bias");
+	const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4, 12), "y");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_GEMM_FORWARD(NO_TRANSPOSE, TRANSPOSE(0, 1)), TENSOR_SYMBOL_LIST(x, w), TENSOR_SYMBOL_LIST(y), "gemm");
+	const ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4, 12), "z");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_ADD_FORWARD(1, 1), TENSOR_SYMBOL_LIST(bias, y), TENSOR_SYMBOL_LIST(z), "add");
+	const ccv_nnc_tensor_symbol_t s = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4, 12), "s");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_SIGMOID_FORWARD(), TENSOR_SYMBOL_LIST(z), TENSOR_SYMBOL_LIST(s), "sigmoid");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_OPS_FUSION),
+		0, 0,
+		TENSOR_SYMBOL_LIST(s), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_active_symbol_count(symbolic_graph, CCV_NNC_SYMBOL_GRAPH_EXEC), 1, "bias and sigmoid should be fused into gemm");
+	const ccv_nnc_cmd_t fused_cmd = ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, ccv_nnc_symbolic_graph_destinations(symbolic_graph)[0]);
+	REQUIRE(fused_cmd.cmd == CCV_NNC_GEMM_FORWARD && fused_cmd.info.activation.type == CCV_NNC_ACTIVATION_SIGMOID, "it should be a gemm with sigmoid");
+	int i;
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 16), 0);
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 12, 16), 0);
+	ccv_nnc_tensor_t* const bias_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 12), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 4 * 16; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 12 * 16; i++)
+		w_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+	for (i = 0; i < 12; i++)
+		bias_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params,
+		TENSOR_BIND_MAP(KV(x, x_tensor), KV(w, w_tensor), KV(bias, bias_tensor)),
+		0, 0, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+	ccv_nnc_tensor_t* const y0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 12), 0);
+	ccv_nnc_tensor_t* const s0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 12), 0);
+	ccv_nnc_cmd_exec(CMD_GEMM_FORWARD(NO_TRANSPOSE, TRANSPOSE(0, 1)), ccv_nnc_no_hint, 0, TENSOR_LIST(x_tensor, w_tensor, bias_tensor), TENSOR_LIST(y0_tensor), 0);
+	ccv_nnc_cmd_exec(CMD_SIGMOID_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(y0_tensor), TENSOR_LIST(s0_tensor), 0);
+	ccv_nnc_tensor_t* const s_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, s);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, s_tensor->data.f32, s0_tensor->data.f32, 4 * 12, 1e-5, "fused gemm should match gemm followed by sigmoid");
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_tensor_free(x_tensor);
+	ccv_nnc_tensor_free(w_tensor);
+	ccv_nnc_tensor_free(bias_tensor);
+	ccv_nnc_tensor_free(y0_tensor);
+	ccv_nnc_tensor_free(s0_tensor);
+}
+
+TEST_CASE("backward of a graph with gemm + sigmoid fusion keeps the explicit destinations")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	const ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4, 16), "x");
+	const ccv_nnc_tensor_symbol_t x1 = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4, 16), "x1");
+	const ccv_nnc_graph_exec_symbol_t scale = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_SCALAR_MUL_FORWARD(1), TENSOR_SYMBOL_LIST(x), TENSOR_SYMBOL_LIST(x1), "scale");
+	const ccv_nnc_tensor_symbol_t w = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 12, 16), "w");
+	const ccv_nnc_tensor_symbol_t bias = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 12), "bias");
+	const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4, 12), "y");
+	const ccv_nnc_graph_exec_symbol_t gemm = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_GEMM_FORWARD(NO_TRANSPOSE, TRANSPOSE(0, 1)), TENSOR_SYMBOL_LIST(x1, w, bias), TENSOR_SYMBOL_LIST(y), "gemm");
+	const ccv_nnc_tensor_symbol_t s = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4, 12), "s");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_SIGMOID_FORWARD(), TENSOR_SYMBOL_LIST(y), TENSOR_SYMBOL_LIST(s), "sigmoid");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_OPS_FUSION),
+		0, 0,
+		TENSOR_SYMBOL_LIST(s), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	REQUIRE_EQ(ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, gemm).info.activation.type, CCV_NNC_ACTIVATION_SIGMOID, "sigmoid should be fused into gemm");
+	ccv_nnc_symbolic_graph_backward(symbolic_graph, TENSOR_SYMBOL_LIST(s), TENSOR_SYMBOL_LIST(x), GRAPH_EXEC_SYMBOL_LIST(scale), GRAPH_EXEC_SYMBOL_LIST(gemm));
+	SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+	const ccv_nnc_tensor_symbol_t ds = ccv_nnc_tensor_symbol_for_backward(symbolic_graph, s);
+	const ccv_nnc_tensor_symbol_t dx = ccv_nnc_tensor_symbol_for_backward(symbolic_graph, x);
+	const ccv_nnc_graph_exec_symbol_t dx_exec = ccv_nnc_graph_exec_symbol_for_backward(symbolic_graph, dx);
+	int i;
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 16), 0);
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 12, 16), 0);
+	ccv_nnc_tensor_t* const bias_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 12), 0);
+	ccv_nnc_tensor_t* const ds_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 12), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 4 * 16; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 12 * 16; i++)
+		w_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+	for (i = 0; i < 12; i++)
+		bias_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+	for (i = 0; i < 4 * 12; i++)
+		ds_tensor->data.f32[i] = 1;
+	ccv_nnc_tensor_t* const y0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 12), 0);
+	ccv_nnc_tensor_t* const s0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 12), 0);
+	ccv_nnc_tensor_t* const dy0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 12), 0);
+	ccv_nnc_tensor_t* const dx0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 16), 0);
+	ccv_nnc_tensor_t* const dw0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 12, 16), 0);
+	ccv_nnc_tensor_t* const dbias0_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 12), 0);
+	ccv_nnc_cmd_exec(CMD_GEMM_FORWARD(NO_TRANSPOSE, TRANSPOSE(0, 1)), ccv_nnc_no_hint, 0, TENSOR_LIST(x_tensor, w_tensor, bias_tensor), TENSOR_LIST(y0_tensor), 0);
+	ccv_nnc_cmd_exec(CMD_SIGMOID_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(y0_tensor), TENSOR_LIST(s0_tensor), 0);
+	ccv_nnc_cmd_exec(CMD_SIGMOID_BACKWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(ds_tensor, 0, s0_tensor), TENSOR_LIST(dy0_tensor), 0);
+	ccv_nnc_cmd_exec(CMD_GEMM_BACKWARD(NO_TRANSPOSE, TRANSPOSE(0, 1)), ccv_nnc_no_hint, 0, TENSOR_LIST(dy0_tensor, x_tensor, w_tensor), TENSOR_LIST(dx0_tensor, dw0_tensor, dbias0_tensor), 0);
+	// The forward part alone, from the same sources to the same destinations, still ends with the sigmoid.
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params,
+		TENSOR_BIND_MAP(KV(x, x_tensor), KV(w, w_tensor), KV(bias, bias_tensor)),
+		TENSOR_SYMBOL_LIST(s), GRAPH_EXEC_SYMBOL_LIST(scale), GRAPH_EXEC_SYMBOL_LIST(gemm), &graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+	ccv_nnc_tensor_t* const s_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, s);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, s_tensor->data.f32, s0_tensor->data.f32, 4 * 12, 1e-5, "forward should match gemm followed by sigmoid");
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params,
+		TENSOR_BIND_MAP(KV(x, x_tensor), KV(w, w_tensor), KV(bias, bias_tensor), KV(ds, ds_tensor)),
+		TENSOR_SYMBOL_LIST(dx), GRAPH_EXEC_SYMBOL_LIST(scale), GRAPH_EXEC_SYMBOL_LIST(dx_exec), &graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+	ccv_nnc_tensor_t* const dx_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, dx);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, dx_tensor->data.f32, dx0_tensor->data.f32, 4 * 16, 1e-5, "gradient should match the one through gemm and sigmoid");
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_tensor_free(x_tensor);
+	ccv_nnc_tensor_free(w_tensor);
+	ccv_nnc_tensor_free(bias_tensor);
+	ccv_nnc_tensor_free(ds_tensor);
+	ccv_nnc_tensor_free(y0_tensor);
+	ccv_nnc_tensor_free(s0_tensor);
+	ccv_nnc_tensor_free(dy0_tensor);
+	ccv_nnc_tensor_free(dx0_tensor);
+	ccv_nnc_tensor_free(dw0_tensor);
+	ccv_nnc_tensor_free(dbias0_tensor);
+}
+
+TEST_CASE("simplify graph with a chain of elementwise additions and relu")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	const ccv_nnc_tensor_symbol_t a = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 3, 5), "a");
+	const ccv_nnc_tensor_symbol_t b = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 3, 5), "b");
+	const ccv_nnc_tensor_symbol_t c = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 3, 5), "c");
+	const ccv_nnc_tensor_symbol_t d = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 3, 5), "d");
+	const ccv_nnc_tensor_symbol_t ab = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 3, 5), "ab");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_ADD_FORWARD(1, 1), TENSOR_SYMBOL_LIST(a, b), TENSOR_SYMBOL_LIST(ab), "add1");
+	const ccv_nnc_tensor_symbol_t abc = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 3, 5), "abc");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_ADD_FORWARD(1, 1), TENSOR_SYMBOL_LIST(c, ab), TENSOR_SYMBOL_LIST(abc), "add2");
+	const ccv_nnc_tensor_symbol_t abcd = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 3, 5), "abcd");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWSUM_FORWARD(), TENSOR_SYMBOL_LIST(abc, d), TENSOR_SYMBOL_LIST(abcd), "sum");
+	const ccv_nnc_tensor_symbol_t r = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 3, 5), "r");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_RELU_FORWARD(), TENSOR_SYMBOL_LIST(abcd), TENSOR_SYMBOL_LIST(r), "relu");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_OPS_FUSION),
+		0, 0,
+		TENSOR_SYMBOL_LIST(r), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_active_symbol_count(symbolic_graph, CCV_NNC_SYMBOL_GRAPH_EXEC), 1, "all additions and relu should be one sum");
+	const ccv_nnc_graph_exec_symbol_t fused = ccv_nnc_symbolic_graph_destinations(symbolic_graph)[0];
+	const ccv_nnc_cmd_t fused_cmd = ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, fused);
+	REQUIRE(fused_cmd.cmd == CCV_NNC_EWSUM_FORWARD && fused_cmd.info.activation.type == CCV_NNC_ACTIVATION_RELU, "it should be a sum with relu");
+	int input_size;
+	ccv_nnc_graph_exec_symbol_io(symbolic_graph, fused, 0, &input_size, 0, 0);
+	REQUIRE_EQ(input_size, 4, "the sum should take all 4 inputs");
+	int i;
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params, 0, 0, 0, 0, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_tensor_t* const a_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, a);
+	ccv_nnc_tensor_t* const b_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, b);
+	ccv_nnc_tensor_t* const c_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, c);
+	ccv_nnc_tensor_t* const d_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, d);
+	float rt[3 * 5];
+	for (i = 0; i < 3 * 5; i++)
+	{
+		a_tensor->data.f32[i] = i - 7;
+		b_tensor->data.f32[i] = 0.5 * i - 3;
+		c_tensor->data.f32[i] = 1 - 0.25 * i;
+		d_tensor->data.f32[i] = (i % 3) - 1;
+		rt[i] = ccv_max(a_tensor->data.f32[i] + b_tensor->data.f32[i] + c_tensor->data.f32[i] + d_tensor->data.f32[i], 0);
+	}
+	ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+	ccv_nnc_tensor_t* const r_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, r);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, r_tensor->data.f32, rt, 3 * 5, 1e-5, "fused sum should match the additions followed by relu");
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+}
+
+static int _exp_log_fusion(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_t* const execs, const int exec_size, ccv_nnc_cmd_t* const cmd, ccv_nnc_hint_t* const hint, ccv_nnc_tensor_symbol_t* const inputs, int* const input_size, ccv_nnc_tensor_symbol_t* const outputs, int* const output_size)
+{
+	const int* exp_inputs;
+	const int* log_outputs;
+	ccv_nnc_graph_exec_symbol_io(graph, execs[0], &exp_inputs, 0, 0, 0);
+	ccv_nnc_graph_exec_symbol_io(graph, execs[1], 0, 0, &log_outputs, 0);
+	*cmd = CMD_DATA_TRANSFER_FORWARD();
+	inputs[0] = (ccv_nnc_tensor_symbol_t){
+		.d = exp_inputs[0],
+		.graph = graph
+	};
+	*input_size = 1;
+	outputs[0] = (ccv_nnc_tensor_symbol_t){
+		.d = log_outputs[0],
+		.graph = graph
+	};
+	*output_size = 1;
+	return 1;
+}
+
+TEST_CASE("simplify graph with registered ops fusion")
+{
+	const uint32_t ops_seq[] = {
+		CCV_NNC_EWEXP_FORWARD, CCV_NNC_EWLOG_FORWARD
+	};
+	ccv_nnc_ops_fusion_register(ops_seq, 2, _exp_log_fusion);
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	const ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "x");
+	const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "y");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWEXP_FORWARD(), TENSOR_SYMBOL_LIST(x), TENSOR_SYMBOL_LIST(y), "exp");
+	const ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "z");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWLOG_FORWARD(), TENSOR_SYMBOL_LIST(y), TENSOR_SYMBOL_LIST(z), "log");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_OPS_FUSION),
+		0, 0,
+		TENSOR_SYMBOL_LIST(z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_active_symbol_count(symbolic_graph, CCV_NNC_SYMBOL_GRAPH_EXEC), 1, "exp and log should be fused");
+	int i;
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params, 0, 0, 0, 0, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, x);
+	for (i = 0; i < 4; i++)
+		x_tensor->data.f32[i] = i * 100 - 150;
+	ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+	ccv_nnc_tensor_t* const z_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, z);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, z_tensor->data.f32, x_tensor->data.f32, 4, 1e-5, "log(exp(x)) should be x, even when exp(x) overflows");
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+}
+
+TEST_CASE("simplify graph with constant folding")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 24), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	int i;
+	for (i = 0; i < 24; i++)
+		w_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	const ccv_nnc_tensor_symbol_t w = ccv_nnc_tensor_symbol_constant_new(symbolic_graph, w_tensor, "w");
+	const ccv_nnc_tensor_symbol_t w46 = ccv_nnc_tensor_symbol_alias_new(symbolic_graph, w, ccv_nnc_no_ofs, DIM_ALLOC(4, 6), CPU_TENSOR_NHWC(32F, 4, 6), "w46");
+	const ccv_nnc_tensor_symbol_t wt = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 6, 4), "wt");
+	const ccv_nnc_tensor_symbol_t ws = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 6, 4), "ws");
+	const ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 2, 6), "x");
+	const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 2, 4), "y");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_TRANSPOSE_FORWARD(0, 1), TENSOR_SYMBOL_LIST(w46), TENSOR_SYMBOL_LIST(wt), "transpose");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_SCALAR_MUL_FORWARD(0.5), TENSOR_SYMBOL_LIST(wt), TENSOR_SYMBOL_LIST(ws), "scale");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_GEMM_FORWARD(NO_TRANSPOSE, NO_TRANSPOSE), TENSOR_SYMBOL_LIST(x, ws), TENSOR_SYMBOL_LIST(y), "gemm");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_CONSTANT_FOLDING,
+			CCV_NNC_SIMPLIFY_GRAPH_PRUNING),
+		0, 0,
+		TENSOR_SYMBOL_LIST(y), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+	const int exec_symbol_count = ccv_nnc_graph_exec_symbol_count(symbolic_graph);
+	int live_exec_count = 0;
+	for (i = 0; i < exec_symbol_count; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_t exec_symbol = {
+			.d = i,
+			.graph = symbolic_graph
+		};
+		int output_size = 0;
+		ccv_nnc_graph_exec_symbol_io(symbolic_graph, exec_symbol, 0, 0, 0, &output_size);
+		if (!output_size) // Freed.
+			continue;
+		++live_exec_count;
+		REQUIRE_EQ(ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, exec_symbol).cmd, CCV_NNC_GEMM_FORWARD, "transpose and scale should be folded");
+	}
+	REQUIRE_EQ(live_exec_count, 1, "only the gemm should be left");
+	ccv_nnc_tensor_t* const ws_tensor = ccv_nnc_tensor_symbol_constant(symbolic_graph, ws);
+	REQUIRE(ws_tensor, "the scaled weight should be a constant");
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 6), 0);
+	for (i = 0; i < 2 * 6; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params,
+		TENSOR_BIND_MAP(KV(x, x_tensor)),
+		0, 0, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_tensor_t* const ws_bound = ccv_nnc_tensor_from_symbol(tensor_arena, ws);
+	REQUIRE(ws_bound->data.f32 != ws_tensor->data.f32, "the tensor arena should hold its own copy of the constant");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, ws_bound->data.f32, ws_tensor->data.f32, 6 * 4, 1e-5, "the constant should be copied when compiled");
+	// The compiled graph doesn't depend on the symbolic graph any more.
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+	float y0[2 * 4];
+	int j, k;
+	for (i = 0; i < 2; i++)
+		for (j = 0; j < 4; j++)
+		{
+			y0[i * 4 + j] = 0;
+			for (k = 0; k < 6; k++)
+				y0[i * 4 + j] += x_tensor->data.f32[i * 6 + k] * w_tensor->data.f32[j * 6 + k] * 0.5;
+		}
+	ccv_nnc_tensor_t* const y_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, y);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, y_tensor->data.f32, y0, 2 * 4, 1e-5, "folded graph should match the computation with the scaled and transposed weight");
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	ccv_nnc_tensor_free(w_tensor);
+	ccv_nnc_tensor_free(x_tensor);
+}
+
+TEST_CASE("simplify graph with constant folding does not fold what is updated in place")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2), 0);
+	x_tensor->data.f32[0] = 1;
+	x_tensor->data.f32[1] = 2;
+	ccv_nnc_tensor_t* const z_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2), 0);
+	z_tensor->data.f32[0] = 10;
+	z_tensor->data.f32[1] = 10;
+	const ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_constant_new(symbolic_graph, x_tensor, "x");
+	const ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_constant_new(symbolic_graph, z_tensor, "z");
+	const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 2), "y");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_SCALAR_MUL_FORWARD(2), TENSOR_SYMBOL_LIST(x), TENSOR_SYMBOL_LIST(y), "scale");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWSUM_FORWARD(), TENSOR_SYMBOL_LIST(y, z), TENSOR_SYMBOL_LIST(y), "sum");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_CONSTANT_FOLDING),
+		0, 0,
+		TENSOR_SYMBOL_LIST(y), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+	REQUIRE(!ccv_nnc_tensor_symbol_constant(symbolic_graph, y), "y is written twice, it cannot be a constant");
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params,
+		0, 0, 0, 0, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_tensor_t* const y_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, y);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	int i;
+	for (i = 0; i < 3; i++)
+	{
+		ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+		REQUIRE_EQ_WITH_TOLERANCE(y_tensor->data.f32[0], 12, 1e-5, "every run should start from the constants");
+		REQUIRE_EQ_WITH_TOLERANCE(y_tensor->data.f32[1], 14, 1e-5, "every run should start from the constants");
+	}
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	ccv_nnc_tensor_free(x_tensor);
+	ccv_nnc_tensor_free(z_tensor);
+}
+
+TEST_CASE("simplify graph with layout propagation")
+{
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NCHW(32F, 3, 8, 8), 0);
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 3, 3, 3), 0);
+	ccv_nnc_tensor_t* const bias_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	int i, k;
+	for (i = 0; i < 3 * 8 * 8; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 4 * 3 * 3 * 3; i++)
+		w_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 4; i++)
+		bias_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	float out[2][4 * 3 * 3];
+	// Run the graph as is, and with the layout propagated, the results should be the same.
+	for (k = 0; k < 2; k++)
+	{
+		ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+		const ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NCHW(32F, 3, 8, 8), "x");
+		const ccv_nnc_tensor_symbol_t xt = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 8, 8, 3), "xt");
+		const ccv_nnc_tensor_symbol_t w = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4, 3, 3, 3), "w");
+		const ccv_nnc_tensor_symbol_t bias = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 4), "bias");
+		const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 6, 6, 4), "y");
+		const ccv_nnc_tensor_symbol_t yt = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NCHW(32F, 4, 6, 6), "yt");
+		const ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NCHW(32F, 4, 6, 6), "z");
+		const ccv_nnc_tensor_symbol_t zt = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 6, 6, 4), "zt");
+		const ccv_nnc_tensor_symbol_t p = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 3, 3, 4), "p");
+		const ccv_nnc_tensor_symbol_t pt = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NCHW(32F, 4, 3, 3), "pt");
+		ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_FORMAT_TRANSFORM_FORWARD(), TENSOR_SYMBOL_LIST(x), TENSOR_SYMBOL_LIST(xt), "transform x");
+		const ccv_nnc_cmd_t conv_cmd = CMD_CONVOLUTION_FORWARD(1, 4, 3, 3, 3);
+		const ccv_nnc_graph_exec_symbol_t conv = ccv_nnc_graph_exec_symbol_new(symbolic_graph, conv_cmd, TENSOR_SYMBOL_LIST(xt, w, bias), TENSOR_SYMBOL_LIST(y), "convolution");
+		ccv_nnc_graph_exec_symbol_set_hint(symbolic_graph, conv, ccv_nnc_hint_auto(conv_cmd.info, CPU_TENSOR_NHWC(32F, 8, 8, 3), CPU_TENSOR_NHWC(32F, 6, 6, 4)));
+		ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_FORMAT_TRANSFORM_FORWARD(), TENSOR_SYMBOL_LIST(y), TENSOR_SYMBOL_LIST(yt), "transform y");
+		ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_RELU_FORWARD(), TENSOR_SYMBOL_LIST(yt), TENSOR_SYMBOL_LIST(z), "relu");
+		ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_FORMAT_TRANSFORM_FORWARD(), TENSOR_SYMBOL_LIST(z), TENSOR_SYMBOL_LIST(zt), "transform z");
+		const ccv_nnc_cmd_t pool_cmd = CMD_MAX_POOL_FORWARD(2, 2);
+		const ccv_nnc_graph_exec_symbol_t pool = ccv_nnc_graph_exec_symbol_new(symbolic_graph, pool_cmd, TENSOR_SYMBOL_LIST(zt), TENSOR_SYMBOL_LIST(p), "pool");
+		ccv_nnc_graph_exec_symbol_set_hint(symbolic_graph, pool, ccv_nnc_hint_auto(pool_cmd.info, CPU_TENSOR_NHWC(32F, 6, 6, 4), CPU_TENSOR_NHWC(32F, 3, 3, 4)));
+		ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_FORMAT_TRANSFORM_FORWARD(), TENSOR_SYMBOL_LIST(p), TENSOR_SYMBOL_LIST(pt), "transform p");
+		ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+		if (k)
+		{
+			ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+				SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_LAYOUT_PROPAGATION),
+				TENSOR_SYMBOL_LIST(x, w, bias),
+				TENSOR_SYMBOL_LIST(pt), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+			SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+			const int exec_symbol_count = ccv_nnc_graph_exec_symbol_count(symbolic_graph);
+			int transform_count = 0;
+			for (i = 0; i < exec_symbol_count; i++)
+			{
+				const ccv_nnc_graph_exec_symbol_t exec_symbol = {
+					.d = i,
+					.graph = symbolic_graph
+				};
+				int output_size = 0;
+				ccv_nnc_graph_exec_symbol_io(symbolic_graph, exec_symbol, 0, 0, 0, &output_size);
+				if (output_size && ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, exec_symbol).cmd == CCV_NNC_FORMAT_TRANSFORM_FORWARD)
+					++transform_count;
+			}
+			REQUIRE_EQ(transform_count, 2, "only the transforms for the input and the output should be left");
+		}
+		ccv_nnc_graph_t* graph;
+		ccv_nnc_tensor_arena_t* tensor_arena;
+		ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+		ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params,
+			TENSOR_BIND_MAP(KV(x, x_tensor), KV(w, w_tensor), KV(bias, bias_tensor)),
+			TENSOR_SYMBOL_LIST(pt), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+		ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+		memcpy(out[k], ccv_nnc_tensor_from_symbol(tensor_arena, pt)->data.f32, sizeof(float) * 4 * 3 * 3);
+		ccv_nnc_graph_free(graph);
+		ccv_nnc_tensor_arena_free(tensor_arena);
+		ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+		ccv_nnc_symbolic_graph_free(symbolic_graph);
+	}
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, out[1], out[0], 4 * 3 * 3, 1e-5, "graph with the layout propagated should match the original");
+	ccv_nnc_tensor_free(x_tensor);
+	ccv_nnc_tensor_free(w_tensor);
+	ccv_nnc_tensor_free(bias_tensor);
+}
+
+TEST_CASE("simplify graph with layout propagation keeps the explicit sources and destinations")
+{
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 4, 4, 3), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	int i, k;
+	for (i = 0; i < 2 * 4 * 4 * 3; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	float out[2][2][2 * 3 * 4 * 4];
+	for (k = 0; k < 2; k++)
+	{
+		ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+		const ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 2, 4, 4, 3), "x");
+		const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 2, 4, 4, 3), "y");
+		const ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 2, 4, 4, 3), "z");
+		const ccv_nnc_tensor_symbol_t a = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NCHW(32F, 2, 3, 4, 4), "a");
+		const ccv_nnc_tensor_symbol_t b = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NCHW(32F, 2, 3, 4, 4), "b");
+		const ccv_nnc_graph_exec_symbol_t relu = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_RELU_FORWARD(), TENSOR_SYMBOL_LIST(x), TENSOR_SYMBOL_LIST(y), "relu");
+		ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_SCALAR_MUL_FORWARD(0.5), TENSOR_SYMBOL_LIST(y), TENSOR_SYMBOL_LIST(z), "scale");
+		const ccv_nnc_graph_exec_symbol_t ta = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_FORMAT_TRANSFORM_FORWARD(), TENSOR_SYMBOL_LIST(z), TENSOR_SYMBOL_LIST(a), "transform a");
+		const ccv_nnc_graph_exec_symbol_t tb = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_FORMAT_TRANSFORM_FORWARD(), TENSOR_SYMBOL_LIST(z), TENSOR_SYMBOL_LIST(b), "transform b");
+		ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+		if (k)
+		{
+			ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+				SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_LAYOUT_PROPAGATION),
+				TENSOR_SYMBOL_LIST(x),
+				TENSOR_SYMBOL_LIST(a, b), GRAPH_EXEC_SYMBOL_LIST(relu), GRAPH_EXEC_SYMBOL_LIST(ta, tb));
+			SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+			int output_size = 0;
+			ccv_nnc_graph_exec_symbol_io(symbolic_graph, ta, 0, 0, 0, &output_size);
+			REQUIRE_EQ(output_size, 1, "the destination transform should be kept");
+			ccv_nnc_graph_exec_symbol_io(symbolic_graph, tb, 0, 0, 0, &output_size);
+			REQUIRE_EQ(output_size, 1, "the destination transform should be kept");
+			REQUIRE_EQ(ccv_nnc_tensor_symbol_params(symbolic_graph, z).format, CCV_TENSOR_FORMAT_NCHW, "the scale should run in NCHW");
+		}
+		ccv_nnc_graph_t* graph;
+		ccv_nnc_tensor_arena_t* tensor_arena;
+		ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+		ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params,
+			TENSOR_BIND_MAP(KV(x, x_tensor)),
+			TENSOR_SYMBOL_LIST(a, b), GRAPH_EXEC_SYMBOL_LIST(relu), GRAPH_EXEC_SYMBOL_LIST(ta, tb), &graph, &tensor_arena, &graph_exec_arena);
+		ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+		memcpy(out[k][0], ccv_nnc_tensor_from_symbol(tensor_arena, a)->data.f32, sizeof(float) * 2 * 3 * 4 * 4);
+		memcpy(out[k][1], ccv_nnc_tensor_from_symbol(tensor_arena, b)->data.f32, sizeof(float) * 2 * 3 * 4 * 4);
+		ccv_nnc_graph_free(graph);
+		ccv_nnc_tensor_arena_free(tensor_arena);
+		ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+		ccv_nnc_symbolic_graph_free(symbolic_graph);
+	}
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, out[1][0], out[0][0], 2 * 3 * 4 * 4, 1e-5, "graph with the layout propagated should match the original");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, out[1][1], out[0][1], 2 * 3 * 4 * 4, 1e-5, "graph with the layout propagated should match the original");
+	ccv_nnc_tensor_free(x_tensor);
+}
+
 #include "case_main.h"
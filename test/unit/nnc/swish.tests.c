@@ -80,4 +80,37 @@ TEST_CASE("compare swish gradient with fine-grained symbolic graph")
 	ccv_nnc_graph_free(swish_graph);
 }
 
+TEST_CASE("compare swish forward and backward between reference and optimized implementation")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_SWISH_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_SWISH_BACKWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const x = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10007), 0);
+	ccv_nnc_tensor_t* const y = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10007), 0);
+	ccv_nnc_tensor_t* const ty = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10007), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	int i;
+	for (i = 0; i < 10007; i++)
+		x->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 20 - 10;
+	ccv_nnc_cmd_t cmd = CMD_SWISH_FORWARD();
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(x), TENSOR_LIST(ty), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(x), TENSOR_LIST(y), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, y->data.f32, ty->data.f32, 10007, 1e-5, "the forward of swish should be equal");
+	ccv_nnc_tensor_t* const g = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 10007), 0);
+	for (i = 0; i < 10007; i++)
+		g->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	cmd = CMD_SWISH_BACKWARD();
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(g, x, ty), TENSOR_LIST(ty), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(g, x, y), TENSOR_LIST(y), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, y->data.f32, ty->data.f32, 10007, 1e-5, "the backward of swish should be equal");
+	ccv_nnc_tensor_free(x);
+	ccv_nnc_tensor_free(y);
+	ccv_nnc_tensor_free(ty);
+	ccv_nnc_tensor_free(g);
+}
+
 #include "case_main.h"
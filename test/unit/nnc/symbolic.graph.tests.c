@@ -158,4 +158,62 @@ TEST_CASE("query connectivity from one exec symbol to another")
 	ccv_nnc_symbolic_graph_free(symbolic_graph);
 }
 
+TEST_CASE("quantize a gemm with constant weights only quantizes the activations when running")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4, 8), 0);
+	ccv_nnc_tensor_t* const bias_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 4), 0);
+	ccv_nnc_tensor_t* const a_tensor = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 8), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	int i, j, k;
+	for (i = 0; i < 4 * 8; i++)
+		w_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 4; i++)
+		bias_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 2 * 8; i++)
+		a_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	const ccv_nnc_tensor_symbol_t a = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 2, 8), "a");
+	const ccv_nnc_tensor_symbol_t w = ccv_nnc_tensor_symbol_constant_new(symbolic_graph, w_tensor, "w");
+	const ccv_nnc_tensor_symbol_t bias = ccv_nnc_tensor_symbol_constant_new(symbolic_graph, bias_tensor, "bias");
+	const ccv_nnc_tensor_symbol_t b = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32F, 2, 4), "b");
+	const ccv_nnc_graph_exec_symbol_t gemm = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_GEMM_FORWARD(NO_TRANSPOSE, TRANSPOSE(0, 1)), TENSOR_SYMBOL_LIST(a, w, bias), TENSOR_SYMBOL_LIST(b), "gemm");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_quantize(symbolic_graph, &gemm, 0, 1, 0, 0);
+	const int exec_symbol_count = ccv_nnc_graph_exec_symbol_count(symbolic_graph);
+	int quantize_count = 0;
+	for (i = 0; i < exec_symbol_count; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_t exec_symbol = {
+			.d = i,
+			.graph = symbolic_graph
+		};
+		if (ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, exec_symbol).cmd == CCV_NNC_QUANTIZE_FORWARD)
+			++quantize_count;
+	}
+	REQUIRE_EQ(quantize_count, 1, "the weights should be quantized already, only the activations are left");
+	ccv_nnc_graph_t* graph = 0;
+	ccv_nnc_tensor_arena_t* tensor_arena = 0;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena = 0;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, ccv_nnc_default_compile_params, TENSOR_BIND_MAP(KV(a, a_tensor)), TENSOR_SYMBOL_LIST(b), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_graph_run(graph, 0, TRAVERSE_FULL, 0, 0);
+	float bt[2 * 4];
+	for (i = 0; i < 2; i++)
+		for (j = 0; j < 4; j++)
+		{
+			bt[i * 4 + j] = bias_tensor->data.f32[j];
+			for (k = 0; k < 8; k++)
+				bt[i * 4 + j] += a_tensor->data.f32[i * 8 + k] * w_tensor->data.f32[j * 8 + k];
+		}
+	ccv_nnc_tensor_t* const b_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, b);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b_tensor->data.f32, bt, 2 * 4, 5e-2, "quantized gemm should match single precision result");
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_tensor_free(w_tensor);
+	ccv_nnc_tensor_free(bias_tensor);
+	ccv_nnc_tensor_free(a_tensor);
+}
+
 #include "case_main.h"
@@ -222,6 +222,93 @@ TEST_CASE("transpose two 3d tensor views")
 	ccv_nnc_tensor_free(d);
 }
 
+TEST_CASE("format transform between NHWC and NCHW with optimized implementation")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_FORMAT_TRANSFORM_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 37, 41, 67), 0);
+	int i;
+	for (i = 0; i < 2 * 37 * 41 * 67; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NCHW(32F, 2, 67, 37, 41), 0);
+	ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, CPU_TENSOR_NCHW(32F, 2, 67, 37, 41), 0);
+	ccv_nnc_cmd_t cmd = CMD_FORMAT_TRANSFORM_FORWARD();
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(bt), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), 0);
+	REQUIRE_TENSOR_EQ(b, bt, "NCHW tensor should be exactly the same as the reference implementation");
+	ccv_nnc_tensor_t* const c = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 37, 41, 67), 0);
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(b), TENSOR_LIST(c), 0);
+	REQUIRE_TENSOR_EQ(a, c, "NHWC tensor should be exactly the same after round trip");
+	// Views that are not contiguous by rows.
+	ccv_nnc_tensor_view_t a_view = ccv_nnc_tensor_view(a, CPU_TENSOR_NHWC(32F, 2, 30, 33, 50), DIM_ALLOC(0, 3, 5, 7), a->info.dim);
+	ccv_nnc_tensor_view_t b_view = ccv_nnc_tensor_view(b, CPU_TENSOR_NCHW(32F, 2, 50, 30, 33), DIM_ALLOC(0, 11, 2, 3), b->info.dim);
+	ccv_nnc_tensor_view_t bt_view = ccv_nnc_tensor_view(bt, CPU_TENSOR_NCHW(32F, 2, 50, 30, 33), DIM_ALLOC(0, 11, 2, 3), bt->info.dim);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST((ccv_nnc_tensor_t*)&a_view), TENSOR_LIST((ccv_nnc_tensor_t*)&bt_view), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST((ccv_nnc_tensor_t*)&a_view), TENSOR_LIST((ccv_nnc_tensor_t*)&b_view), 0);
+	REQUIRE_TENSOR_EQ(b, bt, "NCHW tensor view should be exactly the same as the reference implementation");
+	ccv_nnc_tensor_view_t c_view = ccv_nnc_tensor_view(c, CPU_TENSOR_NHWC(32F, 2, 30, 33, 50), DIM_ALLOC(0, 1, 2, 3), c->info.dim);
+	ccv_nnc_tensor_t* const ct = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 37, 41, 67), 0);
+	memcpy(ct->data.f32, c->data.f32, sizeof(float) * 2 * 37 * 41 * 67);
+	ccv_nnc_tensor_view_t ct_view = ccv_nnc_tensor_view(ct, CPU_TENSOR_NHWC(32F, 2, 30, 33, 50), DIM_ALLOC(0, 1, 2, 3), ct->info.dim);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST((ccv_nnc_tensor_t*)&b_view), TENSOR_LIST((ccv_nnc_tensor_t*)&ct_view), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST((ccv_nnc_tensor_t*)&b_view), TENSOR_LIST((ccv_nnc_tensor_t*)&c_view), 0);
+	REQUIRE_TENSOR_EQ(c, ct, "NHWC tensor view should be exactly the same as the reference implementation");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(bt);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(ct);
+}
+
+TEST_CASE("transpose with optimized implementation")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_TRANSPOSE_FORWARD, CCV_NNC_BACKEND_CPU_OPT));
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 3, 5, 37, 45), 0);
+	int i, j, k;
+	for (i = 0; i < 3 * 5 * 37 * 45; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	ccv_nnc_tensor_view_t a_view = ccv_nnc_tensor_view(a, CPU_TENSOR_NHWC(32F, 2, 4, 35, 43), DIM_ALLOC(1, 1, 1, 1), a->info.dim);
+	ccv_nnc_tensor_t* const a3 = ccv_nnc_tensor_new(a->data.f32, CPU_TENSOR_NHWC(32F, 3 * 5, 37, 45), 0);
+	ccv_nnc_tensor_view_t a3_view = ccv_nnc_tensor_view(a3, CPU_TENSOR_NHWC(32F, 13, 35, 43), DIM_ALLOC(1, 1, 1), a3->info.dim);
+	ccv_nnc_tensor_t* const xs[] = {
+		a, (ccv_nnc_tensor_t*)&a_view, a3, (ccv_nnc_tensor_t*)&a3_view
+	};
+	// Both the tensor and the tensor view, in 4d and 3d, for every pair of axes.
+	for (k = 0; k < 4; k++)
+	{
+		ccv_nnc_tensor_t* const x = xs[k];
+		const int nd = ccv_nnc_tensor_nd(x->info.dim);
+		for (i = 0; i < nd; i++)
+			for (j = i + 1; j < nd; j++)
+			{
+				ccv_nnc_tensor_param_t bparams = x->info;
+				int t;
+				CCV_SWAP(bparams.dim[i], bparams.dim[j], t);
+				ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, bparams, 0);
+				ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, bparams, 0);
+				ccv_nnc_cmd_t cmd = CMD_TRANSPOSE_FORWARD(i, j);
+				cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+				ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(x), TENSOR_LIST(bt), 0);
+				cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+				ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(x), TENSOR_LIST(b), 0);
+				REQUIRE_TENSOR_EQ(b, bt, "transposed tensor should be exactly the same as the reference implementation");
+				ccv_nnc_tensor_free(b);
+				ccv_nnc_tensor_free(bt);
+			}
+	}
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(a3);
+}
+
 TEST_CASE("masked fill forward a 3d tensor")
 {
 	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 6, 5, 4), 0);
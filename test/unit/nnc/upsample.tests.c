@@ -3,6 +3,7 @@
 #include "nnc/ccv_nnc_easy.h"
 #include "case.h"
 #include "ccv_case.h"
+#include "3rdparty/dsfmt/dSFMT.h"
 
 TEST_SETUP()
 {
@@ -79,4 +80,37 @@ TEST_CASE("downsample chessbox in NCHW")
 	ccv_nnc_tensor_free(bt);
 }
 
+TEST_CASE("compare bilinear upsample forward and backward between reference and optimized implementation")
+{
+	GUARD_ELSE_RETURN(ccv_nnc_cmd_ok(CCV_NNC_UPSAMPLE_BILINEAR_FORWARD, CCV_NNC_BACKEND_CPU_OPT) &&
+		ccv_nnc_cmd_ok(CCV_NNC_UPSAMPLE_BILINEAR_BACKWARD, CCV_NNC_BACKEND_CPU_OPT));
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 11, 13, 7), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 22, 26, 7), 0);
+	ccv_nnc_tensor_t* const bt = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 22, 26, 7), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	int i;
+	for (i = 0; i < 2 * 11 * 13 * 7; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	ccv_nnc_cmd_t cmd = CMD_UPSAMPLE_BILINEAR_FORWARD(2, 2);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(bt), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, bt->data.f32, 2 * 22 * 26 * 7, 1e-5, "the forward of upsample should be equal");
+	ccv_nnc_tensor_t* const at = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(32F, 2, 11, 13, 7), 0);
+	for (i = 0; i < 2 * 22 * 26 * 7; i++)
+		b->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	cmd = CMD_UPSAMPLE_BILINEAR_BACKWARD(2, 2);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(b), TENSOR_LIST(at), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(b), TENSOR_LIST(a), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, a->data.f32, at->data.f32, 2 * 11 * 13 * 7, 1e-4, "the backward of upsample should be equal");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(at);
+	ccv_nnc_tensor_free(bt);
+}
+
 #include "case_main.h"